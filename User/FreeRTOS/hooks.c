@@ -1,5 +1,7 @@
 
 #include "hooks.h"
+#include "ui/persist.h"
+#include "code/debug.h"
 
 void vApplicationIdleHook( void )
 {
@@ -12,6 +14,11 @@ void vApplicationIdleHook( void )
     important that vApplicationIdleHook() is permitted to return to its calling
     function, because it is the responsibility of the idle task to clean up
     memory allocated by the kernel to any task that has since been deleted. */
+
+    /* 没有其它任务要运行时检查是否该保存脏数据（只提交请求，不阻塞） */
+    Persist_Poll();
+    /* 提交各任务控制台通道里停留太久、还没有换行的输出 */
+    Debug_ConsolePoll();
 }
 void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName )
 {
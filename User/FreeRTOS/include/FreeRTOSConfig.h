@@ -64,6 +64,7 @@
 #define configUSE_RECURSIVE_MUTEXES		1
 #define configUSE_MALLOC_FAILED_HOOK	1
 #define configUSE_APPLICATION_TASK_TAG	0
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS	1	/* debug.c: per-task console channel */
 #define configUSE_COUNTING_SEMAPHORES	1
 #define configGENERATE_RUN_TIME_STATS	0
 
@@ -145,7 +145,7 @@ void MPU_NimingReport(u8 fun,u8*data,u8 len)
 	send_buf[2]=len;	//ݳ
 	for(i=0;i<len;i++)send_buf[3+i]=data[i];			//
 	for(i=0;i<len+3;i++)send_buf[len+3]+=send_buf[i];	//У	
-	for(i=0;i<len+4;i++) MUP_uart_send_bytes(&send_buf[i],1);//ݵ 
+	MUP_uart_send_bytes(send_buf,len+4);						//ݵ 
 }
 //ͨϱ̬ݸ
 //aacx,aacy,aacz:x,y,zļٶֵ
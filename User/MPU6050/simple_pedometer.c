@@ -1,7 +1,11 @@
+#define LOG_MODULE  step
+#include "code/binlog.h"
 #include "simple_pedometer.h"
 #include "math.h"
 #include <stdlib.h>
 #include "ui/step.h"  // 包含步数存储函数
+#include "ui/persist.h"
+#include "code/shell.h"
 
 // 全局步数变量
 unsigned long g_step_count = 0;
@@ -34,10 +38,10 @@ void simple_pedometer_init(void)
     pedometer.last_step_time = 0;
     pedometer.step_state = 0;             // 初始状态：等待波峰
     
-    printf("Simple pedometer initialized with high sensitivity\r\n");
+    LOG_INFO("Simple pedometer initialized with high sensitivity");
     
     // 加载保存的步数数据
-    // Steps_Load();
+    Steps_LoadSync();
 }
 
 /**
@@ -115,12 +119,10 @@ unsigned long simple_pedometer_update(short ax, short ay, short az)
                 // 计为一步
                 g_step_count++;
                 pedometer.last_step_time = current_time;
-                printf("Step detected! Total steps: %lu\r\n", g_step_count);
+                LOG_INFO("Step detected! Total steps: %lu", g_step_count);
                 
-                // 每100步或达到特定步数时保存一次
-                if (g_step_count % 100 == 0) {
-                    // Steps_Save();
-                }
+                // 只标记为已修改，由 persist.c 在停止走动后或最长延迟到期时合并保存
+                Persist_MarkDirty(PERSIST_OBJ_STEPS);
             }
             pedometer.step_state = 0; // 回到等待波峰状态
         }
@@ -150,8 +152,37 @@ void simple_pedometer_reset(void)
     pedometer.last_acceleration = 0;
     pedometer.last_step_time = 0;
     pedometer.step_state = 0;
-    printf("Simple pedometer reset\r\n");
+    LOG_INFO("Simple pedometer reset");
     
-    // 重置后立即保存
-    // Steps_Save();
+    // 重置后尽快保存（下一个空闲期）
+    Persist_MarkDirty(PERSIST_OBJ_STEPS);
+}
+
+static int cmd_step(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    (void)argv;
+    printf("steps %lu\r\n", g_step_count);
+    return SHELL_OK;
+}
+
+static int cmd_step_reset(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    (void)argv;
+    simple_pedometer_reset();
+    return SHELL_OK;
+}
+
+static const Shell_Cmd step_cmds[] = {
+    { "step",       "", cmd_step,       "show step count" },
+    { "step_reset", "", cmd_step_reset, "reset step count" },
+};
+
+/**
+ * @brief 登记串口命令
+ */
+void simple_pedometer_register_commands(void)
+{
+    Shell_Register(step_cmds, sizeof(step_cmds) / sizeof(step_cmds[0]));
 }
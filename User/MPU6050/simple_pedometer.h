@@ -11,5 +11,6 @@ void simple_pedometer_init(void);
 unsigned long simple_pedometer_update(short ax, short ay, short az);
 void simple_pedometer_reset(void);
 unsigned long simple_pedometer_get_steps(void);
+void simple_pedometer_register_commands(void);  // 串口命令 step/step_reset
 
 #endif
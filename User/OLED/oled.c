@@ -5,6 +5,7 @@
 static uint8_t OLED_GRAM[144][8];
 static uint8_t dirty_flag = 0;
 static uint8_t dirty_x1 = 127, dirty_y1 = 63, dirty_x2 = 0, dirty_y2 = 0;
+static OLED_RefreshHook refresh_hook = 0;
 
 // һֽ
 // mode:/־ 0,ʾ;1,ʾ;
@@ -83,6 +84,10 @@ void OLED_Refresh(void)
 		OLED_WR_Byte(0x10, OLED_CMD);	  // øʼַ
 		OLED_Send_Bytes(0x3c, 0x40, 128, data);
 	}
+	if (refresh_hook)
+	{
+		refresh_hook(0, 0, 127, 7);
+	}
 }
 
 // ֲˢºֻˢָ (x1,y1)  (x2,y2)
@@ -128,6 +133,10 @@ void OLED_Refresh_Area(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
 		// 
 		OLED_Send_Bytes(0x3c, 0x40, end_col - start_col + 1, data);
 	}
+	if (refresh_hook)
+	{
+		refresh_hook(start_col, start_page, end_col, end_page);
+	}
 }
 
 // Զֲˢ
@@ -178,6 +187,20 @@ void OLED_Clear(void)
 	OLED_Refresh(); // ʾ
 }
 
+// Դ׵ַǰ 128 ţÿ 8 ֽڣ 0~7 ҳ 1024 ֽڡ
+// ԴеͼƬͬ˳ţ DMA ֱӶ루 asset_view.c
+uint8_t *OLED_GetGRAM(void)
+{
+	return &OLED_GRAM[0][0];
+}
+
+// ˢ»صÿ OLED_Refresh / OLED_Refresh_Area дĻãΪˢµкҳΧ
+// ڵˢºִСڰѻ澵񵽴ڣ ui/screen_mirror.c0-ȡ
+void OLED_SetRefreshHook(OLED_RefreshHook hook)
+{
+	refresh_hook = hook;
+}
+
 // 
 // x:0~127
 // y:0~63
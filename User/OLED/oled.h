@@ -11,6 +11,7 @@
 /****************************************end********************************************** */
 #define OLED_CMD 0  // д
 #define OLED_DATA 1 // д
+typedef void (*OLED_RefreshHook)(uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2);
 void OLED_ClearPoint(uint8_t x, uint8_t y);
 void OLED_ColorTurn(uint8_t i);
 void OLED_DisplayTurn(uint8_t i);
@@ -22,6 +23,8 @@ void OLED_Refresh_Area(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
 void OLED_Set_Dirty_Area(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
 void OLED_Refresh_Dirty(void);
 void OLED_Clear(void);
+uint8_t *OLED_GetGRAM(void);
+void OLED_SetRefreshHook(OLED_RefreshHook hook);
 void OLED_DrawPoint(uint8_t x, uint8_t y, uint8_t t);
 void OLED_DrawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t mode);
 void OLED_DrawCircle(uint8_t x, uint8_t y, uint8_t r);
@@ -0,0 +1,343 @@
+// oled_remote.c - 远程模式：实时显示设备的 OLED 画面（设备端见 ui/screen_mirror.c，帧格式见 code/oled_mirror.h）
+//
+// 用法:
+//   oled_remote [--baud N] [--record out.rpl] <串口|->
+//       打开串口（发送 "mirror on" 让设备开始镜像），或从标准输入读取抓到的串口数据；
+//       --record 同时把镜像帧录成回放文件
+//   oled_remote --replay in.rpl [--speed X]
+//       按录制时的时间间隔重放（X 倍速，0 为尽快）
+//
+// 设备的其它串口输出（printf 文本）原样写到标准输出。画面丢帧后过期时以灰色显示，
+// 直到设备整屏重发；窗口标题显示帧率、串口字节率和丢帧数。
+// 按键：P 保存当前画面为 oled_remote.pbm，空格暂停重放，X 退出。
+// 回放文件的统计和刷新热点用 User/code/simulator 的 oled_replay 工具。
+#define _DEFAULT_SOURCE
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "telem_decode.h"
+#include "oled_replay.h"
+
+// OLED显示屏参数
+#define SCALE 4
+#define WIDTH 128
+#define HEIGHT 64
+#define MIRROR_CH 3             // 与 SCREEN_MIRROR_CH 相同，收到描述帧后按名字 "oled" 识别
+
+static SDL_Window *window = NULL;
+static SDL_Renderer *renderer = NULL;
+static OledScreen screen;
+static TelemReceiver rx;
+static FILE *record = NULL;
+static uint8_t changed = 1;
+
+// 标题栏统计（每秒更新）
+static uint32_t rate_at, rate_frames, rate_bytes;
+
+static void on_frame(void *ctx, const TelemRxChannel *ch, uint8_t seq, uint32_t t_ms,
+                     const uint8_t *payload, uint32_t len)
+{
+    (void)ctx;
+    if (ch->known ? strcmp(ch->name, "oled") != 0 : ch->id != MIRROR_CH) {
+        return;
+    }
+    OledScreen_Frame(&screen, seq, t_ms, payload, len);
+    if (record != NULL) {
+        OledReplay_Write(record, t_ms, seq, payload, len);
+    }
+    rate_frames++;
+    rate_bytes += len + OLED_REPLAY_WIRE_EXTRA;
+    changed = 1;
+}
+
+static void on_other(void *ctx, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    fwrite(data, 1, len, stdout);
+    fflush(stdout);
+}
+
+static speed_t baud_constant(long baud)
+{
+    switch (baud) {
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return 0;
+    }
+}
+
+static int serial_open(const char *path, long baud)
+{
+    struct termios tio;
+    speed_t speed = baud_constant(baud);
+    int fd;
+
+    if (speed == 0) {
+        fprintf(stderr, "unsupported baud rate %ld\n", baud);
+        return -1;
+    }
+    fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+static int display_init(void)
+{
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        printf("SDL初始化失败: %s\n", SDL_GetError());
+        return -1;
+    }
+    window = SDL_CreateWindow("OLED remote", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                              WIDTH * SCALE, HEIGHT * SCALE, SDL_WINDOW_SHOWN);
+    if (!window) {
+        printf("窗口创建失败: %s\n", SDL_GetError());
+        return -1;
+    }
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    if (!renderer) {
+        printf("渲染器创建失败: %s\n", SDL_GetError());
+        return -1;
+    }
+    SDL_RenderSetScale(renderer, SCALE, SCALE);
+    return 0;
+}
+
+// 画面过期（丢帧后尚未收到整屏）时用灰色
+static void display_update(void)
+{
+    uint8_t level = screen.stale ? 96 : 255;
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, level, level, level, 255);
+    for (int x = 0; x < WIDTH; x++) {
+        for (int y = 0; y < HEIGHT; y++) {
+            if (OledScreen_Pixel(&screen, (uint32_t)x, (uint32_t)y)) {
+                SDL_RenderDrawPoint(renderer, x, y);
+            }
+        }
+    }
+    SDL_RenderPresent(renderer);
+    changed = 0;
+}
+
+static void title_update(uint32_t now)
+{
+    char title[128];
+    uint32_t ms = now - rate_at;
+
+    if (ms < 1000) {
+        return;
+    }
+    snprintf(title, sizeof(title), "OLED remote - %.1f frames/s, %u B/s, %u lost%s",
+             rate_frames * 1000.0 / ms, (unsigned)((uint64_t)rate_bytes * 1000 / ms),
+             (unsigned)screen.stats.lost, screen.stale ? ", STALE" : "");
+    SDL_SetWindowTitle(window, title);
+    rate_at = now;
+    rate_frames = rate_bytes = 0;
+}
+
+// 处理窗口事件，返回 0 表示退出
+static int handle_events(int *paused)
+{
+    SDL_Event event;
+
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_QUIT || (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_x)) {
+            return 0;
+        }
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_p) {
+            if (OledScreen_WritePbm(&screen, "oled_remote.pbm") == 0) {
+                printf("画面已保存到 oled_remote.pbm\n");
+            }
+        }
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE) {
+            *paused = !*paused;
+        }
+        if (event.type == SDL_WINDOWEVENT) {
+            changed = 1;
+        }
+    }
+    return 1;
+}
+
+static int run_live(int fd)
+{
+    int paused = 0;
+
+    while (handle_events(&paused)) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        uint8_t buf[4096];
+        ssize_t n;
+
+        if (poll(&pfd, 1, 10) > 0) {
+            n = read(fd, buf, sizeof(buf));
+            if (n > 0) {
+                TelemRx_Feed(&rx, buf, (size_t)n);
+            } else if (n == 0 && fd == STDIN_FILENO) {
+                break;          // 输入结束，窗口保留最后的画面直到关闭
+            }
+        }
+        if (changed && !paused) {
+            display_update();
+        }
+        title_update(SDL_GetTicks());
+    }
+    TelemRx_Flush(&rx);
+    while (fd == STDIN_FILENO && handle_events(&paused)) {
+        if (changed) {
+            display_update();
+        }
+        SDL_Delay(16);
+    }
+    return 0;
+}
+
+static int run_replay(const char *path, double speed)
+{
+    uint8_t frame[OLED_MIRROR_PAYLOAD];
+    uint32_t t, t0 = 0, start = SDL_GetTicks(), paused_at = 0;
+    uint8_t seq;
+    int len, paused = 0, first = 1;
+    FILE *in = fopen(path, "rb");
+
+    if (in == NULL || OledReplay_ReadHeader(in) != 0) {
+        fprintf(stderr, "%s is not a replay file\n", path);
+        return 1;
+    }
+    while ((len = OledReplay_Read(in, &t, &seq, frame, sizeof(frame))) >= 0) {
+        if (first) {
+            t0 = t;
+            first = 0;
+        }
+        // 等到该帧在录制时的时刻（按倍速），期间照常响应窗口
+        while (1) {
+            uint32_t now = SDL_GetTicks();
+
+            if (!handle_events(&paused)) {
+                fclose(in);
+                return 0;
+            }
+            if (paused) {
+                if (paused_at == 0) {
+                    paused_at = now;
+                }
+                SDL_Delay(16);
+                continue;
+            }
+            if (paused_at != 0) {
+                start += now - paused_at;
+                paused_at = 0;
+            }
+            if (speed <= 0 || (now - start) * speed >= (double)(t - t0)) {
+                break;
+            }
+            if (changed) {
+                display_update();
+            }
+            title_update(now);
+            SDL_Delay(1);
+        }
+        OledScreen_Frame(&screen, seq, t, frame, (uint32_t)len);
+        rate_frames++;
+        rate_bytes += (uint32_t)len + OLED_REPLAY_WIRE_EXTRA;
+        changed = 1;
+    }
+    fclose(in);
+    printf("重放结束：%u 帧，%u ms，%u 次整屏，%u 帧丢失\n", (unsigned)screen.stats.frames,
+           (unsigned)(screen.stats.t_last - screen.stats.t_first), (unsigned)screen.stats.keyframes,
+           (unsigned)screen.stats.lost);
+    while (handle_events(&paused)) {
+        if (changed) {
+            display_update();
+        }
+        SDL_Delay(16);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const TelemRxSink sink = { NULL, NULL, on_other, NULL, on_frame };
+    const char *replay = NULL, *record_path = NULL;
+    double speed = 1.0;
+    long baud = 921600;
+    int argi = 1, fd = -1, ret;
+
+    while (argi + 1 < argc && strncmp(argv[argi], "--", 2) == 0) {
+        if (strcmp(argv[argi], "--replay") == 0) {
+            replay = argv[argi + 1];
+        } else if (strcmp(argv[argi], "--speed") == 0) {
+            speed = atof(argv[argi + 1]);
+        } else if (strcmp(argv[argi], "--record") == 0) {
+            record_path = argv[argi + 1];
+        } else if (strcmp(argv[argi], "--baud") == 0) {
+            baud = strtol(argv[argi + 1], NULL, 10);
+        } else {
+            break;
+        }
+        argi += 2;
+    }
+    if (replay == NULL && argc - argi != 1) {
+        fprintf(stderr, "usage: %s [--baud N] [--record out.rpl] <serial device|->\n"
+                        "       %s --replay in.rpl [--speed X]\n", argv[0], argv[0]);
+        return 2;
+    }
+    if (replay == NULL) {
+        if (strcmp(argv[argi], "-") == 0) {
+            fd = STDIN_FILENO;
+        } else if ((fd = serial_open(argv[argi], baud)) < 0) {
+            return 1;
+        } else {
+            static const char cmd[] = "\rmirror on\r";
+
+            if (write(fd, cmd, sizeof(cmd) - 1) < 0) {
+                perror("write");
+            }
+        }
+        if (record_path != NULL) {
+            record = fopen(record_path, "wb");
+            if (record == NULL || OledReplay_WriteHeader(record) != 0) {
+                fprintf(stderr, "cannot create %s\n", record_path);
+                return 1;
+            }
+        }
+    }
+    if (display_init() != 0) {
+        return 1;
+    }
+    OledScreen_Init(&screen);
+    TelemRx_Init(&rx, &sink);
+    rate_at = SDL_GetTicks();
+
+    ret = replay != NULL ? run_replay(replay, speed) : run_live(fd);
+
+    if (record != NULL) {
+        fclose(record);
+    }
+    if (renderer) {
+        SDL_DestroyRenderer(renderer);
+    }
+    if (window) {
+        SDL_DestroyWindow(window);
+    }
+    SDL_Quit();
+    return ret;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file ab_record.c
+ * @brief 双扇区日志式定长记录实现
+ */
+
+#include "ab_record.h"
+#include "spi.h"
+#include "crc.h"
+#include <string.h>
+
+#define AB_SECTORS          2
+#define AB_MIN_SLOT         16
+#define AB_SEQ_BLANK        0xFFFFFFFFUL
+
+typedef struct {
+    uint32_t seq;
+    uint16_t len;
+    uint16_t reserved;      // 保持 0xFFFF
+    uint32_t crc;
+} AB_SlotHeader;
+
+// 一个槽的读写缓冲区
+static uint8_t ab_buf[256] __attribute__((aligned(4)));
+
+// CRC 覆盖 seq、len 和数据（crc.c，标准 CRC-32）
+static uint32_t slot_crc(const AB_SlotHeader *h, const uint8_t *data)
+{
+    uint32_t crc = CRC32_Update(0, h, 6);
+    return CRC32_Update(crc, data, h->len);
+}
+
+// =============================================================================
+// 内部函数
+// =============================================================================
+
+static uint32_t slot_addr(const AB_Region *r, uint8_t sector, uint16_t slot)
+{
+    return r->base + (uint32_t)sector * W25Q128_SECTOR_SIZE + (uint32_t)slot * r->slot_size;
+}
+
+static uint16_t slots_per_sector(const AB_Region *r)
+{
+    return W25Q128_SECTOR_SIZE / r->slot_size;
+}
+
+static uint8_t is_blank(const uint8_t *p, uint32_t len)
+{
+    while (len--) {
+        if (*p++ != 0xFF) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// 读出一个槽到 ab_buf 并校验
+static uint8_t slot_valid(const AB_Region *r, uint8_t sector, uint16_t slot)
+{
+    const AB_SlotHeader *h = (const AB_SlotHeader *)ab_buf;
+
+    W25Q128_ReadData(ab_buf, slot_addr(r, sector, slot), r->slot_size);
+    return h->seq != AB_SEQ_BLANK && h->len == r->record_len &&
+           h->crc == slot_crc(h, ab_buf + AB_HDR_SIZE);
+}
+
+/**
+ * @brief 扫描两个扇区，找出序号最大的有效槽和活动扇区的写入位置
+ */
+static void ab_scan(AB_Region *r)
+{
+    uint16_t used[AB_SECTORS] = {0, 0};
+
+    r->slot_size = AB_MIN_SLOT;
+    while (r->slot_size < AB_HDR_SIZE + r->record_len) {
+        r->slot_size <<= 1;
+    }
+    r->seq = 0;
+    r->active = 0;
+    r->cur = 0;
+
+    for (uint8_t sec = 0; sec < AB_SECTORS; sec++) {
+        for (uint16_t i = 0; i < slots_per_sector(r); i++) {
+            uint8_t valid = slot_valid(r, sec, i);
+            const AB_SlotHeader *h = (const AB_SlotHeader *)ab_buf;
+
+            if (!valid && is_blank(ab_buf, r->slot_size)) {
+                break;      // 扇区内的槽按顺序写入，第一个空槽之后都是空的
+            }
+            used[sec] = i + 1;
+            if (valid && h->seq > r->seq) {
+                r->seq = h->seq;
+                r->active = sec;
+                r->cur = i;
+            }
+        }
+    }
+    r->next = used[r->active];
+    r->ready = 1;
+}
+
+// =============================================================================
+// 接口
+// =============================================================================
+
+/**
+ * @brief 读取最新有效记录
+ * @param buf 输出缓冲区，大小为 record_len
+ * @return AB_OK / AB_ERR_NOT_FOUND
+ */
+int AB_Load(AB_Region *r, void *buf)
+{
+    if (r->record_len == 0 || r->record_len > AB_MAX_RECORD) {
+        return AB_ERR_PARAM;
+    }
+    if (!r->ready) {
+        ab_scan(r);
+    }
+    if (r->seq == 0) {
+        return AB_ERR_NOT_FOUND;
+    }
+    if (!slot_valid(r, r->active, r->cur)) {
+        // 扫描后被外部改写，重新扫描
+        ab_scan(r);
+        if (r->seq == 0) {
+            return AB_ERR_NOT_FOUND;
+        }
+        slot_valid(r, r->active, r->cur);
+    }
+    memcpy(buf, ab_buf + AB_HDR_SIZE, r->record_len);
+    return AB_OK;
+}
+
+/**
+ * @brief 保存记录到下一个空槽（活动扇区满时先擦除另一扇区）
+ */
+int AB_Save(AB_Region *r, const void *buf)
+{
+    AB_SlotHeader *h = (AB_SlotHeader *)ab_buf;
+    uint16_t size = AB_HDR_SIZE + r->record_len;
+    uint8_t verify[32];
+
+    if (r->record_len == 0 || r->record_len > AB_MAX_RECORD || buf == NULL) {
+        return AB_ERR_PARAM;
+    }
+    if (!r->ready) {
+        ab_scan(r);
+    }
+
+    if (r->next >= slots_per_sector(r)) {
+        uint8_t other = r->active ^ 1;
+        r->erases++;
+        if (W25Q128_SectorErase(slot_addr(r, other, 0)) != W25Q128_RESULT_OK) {
+            return AB_ERR_FLASH;
+        }
+        r->active = other;
+        r->next = 0;
+    }
+
+    h->seq = r->seq + 1;
+    h->len = r->record_len;
+    h->reserved = 0xFFFF;
+    memcpy(ab_buf + AB_HDR_SIZE, buf, r->record_len);
+    h->crc = slot_crc(h, ab_buf + AB_HDR_SIZE);
+
+    if (W25Q128_BufferWrite(ab_buf, slot_addr(r, r->active, r->next), size) != W25Q128_RESULT_OK) {
+        r->next++;      // 该槽状态未知，不再使用
+        return AB_ERR_FLASH;
+    }
+    for (uint32_t done = 0; done < size; done += sizeof(verify)) {
+        uint32_t n = size - done < sizeof(verify) ? size - done : sizeof(verify);
+        W25Q128_ReadData(verify, slot_addr(r, r->active, r->next) + done, (uint16_t)n);
+        if (memcmp(verify, ab_buf + done, n) != 0) {
+            r->next++;
+            return AB_ERR_FLASH;
+        }
+    }
+
+    r->seq = h->seq;
+    r->cur = r->next++;
+    r->saves++;
+    return AB_OK;
+}
+
+/**
+ * @brief 丢弃扫描结果，下次访问时重新扫描（复位/掉电恢复后调用）
+ */
+void AB_Reset(AB_Region *r)
+{
+    r->ready = 0;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file ab_record.h
+ * @brief 双扇区（A/B）日志式定长记录，掉电安全
+ * @details 每种记录独占两个 4KB 扇区，扇区内按槽追加：
+ *          [seq 4B][len 2B][0xFFFF 2B][crc32 4B][数据]，槽大小取 2 的幂，不跨页
+ *          - 保存只写当前有效记录之后的空槽，一次页编程，不擦除
+ *          - 活动扇区写满时擦除另一扇区并写入其第一个槽；
+ *            被擦除的扇区里只有更旧的记录，最新有效记录始终不受影响
+ *          - 加载取 CRC32 正确且序号最大的槽，掉电写了一半的槽被跳过
+ *
+ *          一个 AB_Region 描述一种记录（步数、闹钟、设置……），用 AB_REGION_INIT 静态定义。
+ *          与 KV 一样共用 SPI1，存储服务运行时只能在存储任务中调用。
+ */
+
+#ifndef AB_RECORD_H
+#define AB_RECORD_H
+
+#include <stdint.h>
+
+#define AB_HDR_SIZE         12      ///< 槽头大小
+#define AB_MAX_RECORD       (256 - AB_HDR_SIZE)   ///< 槽不能超过一页
+
+// 返回值
+#define AB_OK               0
+#define AB_ERR_NOT_FOUND    1       ///< 没有有效记录
+#define AB_ERR_FLASH        2       ///< 编程/擦除失败或回读不一致
+#define AB_ERR_PARAM        3
+
+/**
+ * @brief 记录区域描述（前两项为配置，其余为运行状态）
+ */
+typedef struct {
+    uint32_t base;          ///< 区域起始地址（4KB 对齐，占 2 个扇区）
+    uint16_t record_len;    ///< 记录长度，不超过 AB_MAX_RECORD
+
+    uint8_t  ready;         ///< 已扫描
+    uint8_t  active;        ///< 最新有效记录所在扇区（0/1）
+    uint16_t slot_size;     ///< 槽大小
+    uint16_t cur;           ///< 最新有效记录所在槽
+    uint16_t next;          ///< 活动扇区中下一个空槽
+    uint32_t seq;           ///< 最新有效记录的序号，0 表示没有
+    uint32_t saves;         ///< 保存次数
+    uint32_t erases;        ///< 切换扇区时的擦除次数
+} AB_Region;
+
+#define AB_REGION_INIT(base, len)   { (base), (len), 0, 0, 0, 0, 0, 0, 0, 0 }
+
+int AB_Load(AB_Region *r, void *buf);
+int AB_Save(AB_Region *r, const void *buf);
+void AB_Reset(AB_Region *r);
+
+#endif
@@ -0,0 +1,353 @@
+/**
+ * @file asset.c
+ * @brief W25Q128 资源包访问实现
+ * @details 映像格式见 asset_pack.h。校验分三级：
+ *          映像头和哈希表在 Asset_Init 时校验（失败则整个包不可用），
+ *          资源数据的 CRC 只在安装后和 Asset_Verify 时检查，正常读取不重复计算。
+ */
+
+#include "asset.h"
+#include "flash_layout.h"
+#include "crc.h"
+#include "../ff16/ff.h"
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+#define ASSET_STATE_UNKNOWN 0       // 还没读过分区
+#define ASSET_STATE_READY   1
+#define ASSET_STATE_NONE    2       // 分区中没有有效映像，不再重复检查
+
+static AssetPackHeader asset_hdr;
+static uint8_t asset_state = ASSET_STATE_UNKNOWN;
+static Asset_Stats asset_stats;
+
+// 校验和安装用的页缓冲区
+static uint8_t asset_buf[W25Q128_PAGE_SIZE] __attribute__((aligned(4)));
+
+static uint32_t entry_addr(uint16_t slot)
+{
+    return FLASH_ASSET_BASE + sizeof(AssetPackHeader) + (uint32_t)slot * sizeof(AssetEntry);
+}
+
+// 映像头自身的一致性（不读 Flash）
+static int header_valid(const AssetPackHeader *h)
+{
+    uint32_t table_end;
+
+    if (h->magic != ASSET_PACK_MAGIC || h->version != ASSET_PACK_VERSION ||
+        h->entry_size != sizeof(AssetEntry)) {
+        return 0;
+    }
+    if (CRC32_Calc(h, offsetof(AssetPackHeader, header_crc)) != h->header_crc) {
+        return 0;
+    }
+    table_end = sizeof(AssetPackHeader) + (uint32_t)h->buckets * sizeof(AssetEntry);
+    return h->buckets != 0 && (h->buckets & (h->buckets - 1)) == 0 && h->count <= h->buckets &&
+           h->data_offset >= table_end && h->image_size >= h->data_offset &&
+           h->image_size <= FLASH_ASSET_SIZE;
+}
+
+// 分区 [addr, addr+len) 的 CRC32
+static uint32_t flash_crc(uint32_t addr, uint32_t len)
+{
+    uint32_t crc = 0;
+
+    while (len > 0) {
+        uint32_t n = len < sizeof(asset_buf) ? len : sizeof(asset_buf);
+        W25Q128_ReadData(asset_buf, addr, (uint16_t)n);
+        crc = CRC32_Update(crc, asset_buf, n);
+        addr += n;
+        len -= n;
+    }
+    return crc;
+}
+
+/**
+ * @brief 读取并校验映像头和哈希表（首次调用 Asset_Find 时自动执行）
+ * @return ASSET_OK / ASSET_ERR_NO_PACK / ASSET_ERR_CRC
+ */
+int Asset_Init(void)
+{
+    SPI1_Init();
+    memset(&asset_stats, 0, sizeof(asset_stats));
+    asset_state = ASSET_STATE_NONE;
+
+    W25Q128_ReadData((uint8_t *)&asset_hdr, FLASH_ASSET_BASE, sizeof(asset_hdr));
+    if (asset_hdr.magic != ASSET_PACK_MAGIC) {
+        return ASSET_ERR_NO_PACK;
+    }
+    if (!header_valid(&asset_hdr) ||
+        flash_crc(entry_addr(0), (uint32_t)asset_hdr.buckets * sizeof(AssetEntry)) != asset_hdr.table_crc) {
+        asset_stats.crc_errors++;
+        return ASSET_ERR_CRC;
+    }
+
+    asset_stats.count = asset_hdr.count;
+    asset_stats.image_size = asset_hdr.image_size;
+    asset_state = ASSET_STATE_READY;
+    return ASSET_OK;
+}
+
+static int asset_ensure_ready(void)
+{
+    if (asset_state == ASSET_STATE_UNKNOWN) {
+        Asset_Init();
+    }
+    return asset_state == ASSET_STATE_READY ? ASSET_OK : ASSET_ERR_NO_PACK;
+}
+
+/**
+ * @brief 分区中是否有有效的资源包
+ */
+uint8_t Asset_Available(void)
+{
+    return asset_ensure_ready() == ASSET_OK;
+}
+
+static void entry_to_info(const AssetEntry *e, AssetInfo *info)
+{
+    info->addr = FLASH_ASSET_BASE + e->offset;
+    info->length = e->length;
+    info->crc = e->crc;
+    info->type = e->type;
+    info->count = e->count;
+    info->w = e->w;
+    info->h = e->h;
+}
+
+/**
+ * @brief 按名字查找资源
+ * @param info 输出位置和参数（可为 NULL，只判断是否存在）
+ */
+int Asset_Find(const char *name, AssetInfo *info)
+{
+    AssetEntry e;
+    uint32_t hash;
+    uint16_t mask, slot;
+    int rc;
+
+    if (name == NULL) {
+        return ASSET_ERR_PARAM;
+    }
+    rc = asset_ensure_ready();
+    if (rc != ASSET_OK) {
+        return rc;
+    }
+
+    asset_stats.lookups++;
+    hash = Asset_Hash(name);
+    mask = asset_hdr.buckets - 1;
+    slot = hash & mask;
+    for (uint16_t n = 0; n < asset_hdr.buckets; n++, slot = (slot + 1) & mask) {
+        W25Q128_ReadData((uint8_t *)&e, entry_addr(slot), sizeof(e));
+        asset_stats.probes++;
+        if (e.hash == 0) {
+            break;
+        }
+        if (e.hash == hash && strncmp(e.name, name, ASSET_NAME_MAX) == 0) {
+            if (e.offset < asset_hdr.data_offset || e.length > asset_hdr.image_size - e.offset) {
+                asset_stats.crc_errors++;
+                return ASSET_ERR_CRC;
+            }
+            if (info != NULL) {
+                entry_to_info(&e, info);
+            }
+            return ASSET_OK;
+        }
+    }
+    return ASSET_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief 读取资源数据 [offset, offset+len) 到 dst
+ * @details 64 字节以上走 DMA，直接写入 dst；dst 可以是显存等最终目标。
+ */
+int Asset_Read(const AssetInfo *info, uint32_t offset, void *dst, uint32_t len)
+{
+    if (info == NULL || dst == NULL || offset > info->length || len > info->length - offset) {
+        return ASSET_ERR_PARAM;
+    }
+    if (len == 0) {
+        return ASSET_OK;
+    }
+    if (W25Q128_ReadData_DMA((uint8_t *)dst, info->addr + offset, len) != W25Q128_RESULT_OK) {
+        return ASSET_ERR_FLASH;
+    }
+    asset_stats.reads++;
+    asset_stats.bytes_read += len;
+    return ASSET_OK;
+}
+
+/**
+ * @brief 校验一个资源的数据 CRC
+ */
+int Asset_Verify(const AssetInfo *info)
+{
+    if (info == NULL) {
+        return ASSET_ERR_PARAM;
+    }
+    if (flash_crc(info->addr, info->length) != info->crc) {
+        asset_stats.crc_errors++;
+        return ASSET_ERR_CRC;
+    }
+    return ASSET_OK;
+}
+
+/**
+ * @brief 校验映像中全部资源
+ * @return ASSET_OK，或第一个失败资源的错误码
+ */
+int Asset_VerifyAll(void)
+{
+    AssetEntry e;
+    AssetInfo info;
+    uint16_t found = 0;
+    int rc = asset_ensure_ready();
+
+    for (uint16_t slot = 0; rc == ASSET_OK && slot < asset_hdr.buckets; slot++) {
+        W25Q128_ReadData((uint8_t *)&e, entry_addr(slot), sizeof(e));
+        if (e.hash == 0) {
+            continue;
+        }
+        found++;
+        if (e.offset < asset_hdr.data_offset || e.length > asset_hdr.image_size - e.offset) {
+            asset_stats.crc_errors++;
+            return ASSET_ERR_CRC;
+        }
+        entry_to_info(&e, &info);
+        rc = Asset_Verify(&info);
+    }
+    if (rc == ASSET_OK && found != asset_hdr.count) {
+        rc = ASSET_ERR_CRC;
+    }
+    return rc;
+}
+
+// 编程一页，全 0xFF 的页（对齐填充）跳过
+static int program_page(uint32_t addr, uint16_t len)
+{
+    uint16_t i;
+
+    for (i = 0; i < len && asset_buf[i] == 0xFF; i++) {
+    }
+    if (i == len) {
+        return ASSET_OK;
+    }
+    return W25Q128_WritePage(asset_buf, addr, len) == W25Q128_RESULT_OK ? ASSET_OK : ASSET_ERR_FLASH;
+}
+
+static int read_file(FIL *fil, FSIZE_t ofs, uint16_t len)
+{
+    UINT br;
+
+    if (f_lseek(fil, ofs) != FR_OK || f_read(fil, asset_buf, len, &br) != FR_OK || br != len) {
+        return ASSET_ERR_FILE;
+    }
+    return ASSET_OK;
+}
+
+/**
+ * @brief 把 FatFs 上的映像文件（asset_pack 的输出）写入资源包分区
+ * @details 先检查文件的映像头，再擦除所需的扇区，从第二页开始编程，映像头所在的第一页最后编程，
+ *          最后重新读取映像头、哈希表并校验全部资源。存储任务中执行，耗时约 擦除 + 页数 x 0.7ms。
+ *          分区中已经是同一映像时直接返回 ASSET_OK，不擦写。
+ */
+int Asset_Install(const char *path)
+{
+    FIL fil;
+    AssetPackHeader h;
+    uint32_t size, addr;
+    int rc;
+
+    if (f_open(&fil, path, FA_READ) != FR_OK) {
+        return ASSET_ERR_FILE;
+    }
+    rc = read_file(&fil, 0, sizeof(h));
+    memcpy(&h, asset_buf, sizeof(h));
+    if (rc == ASSET_OK && (!header_valid(&h) || f_size(&fil) != h.image_size)) {
+        rc = ASSET_ERR_CRC;
+    }
+    if (rc != ASSET_OK) {
+        f_close(&fil);
+        return rc;
+    }
+    // 分区中已是同一映像且数据完好时不重写（重新读取分区，不用缓存的映像头）
+    if (Asset_Init() == ASSET_OK && memcmp(&asset_hdr, &h, sizeof(h)) == 0 && Asset_VerifyAll() == ASSET_OK) {
+        f_close(&fil);
+        return ASSET_OK;
+    }
+
+    // 从这里开始旧映像不再可用
+    asset_state = ASSET_STATE_NONE;
+    size = h.image_size;
+    for (addr = 0; rc == ASSET_OK && addr < size; addr += W25Q128_SECTOR_SIZE) {
+        if (W25Q128_SectorErase(FLASH_ASSET_BASE + addr) != W25Q128_RESULT_OK) {
+            rc = ASSET_ERR_FLASH;
+        }
+    }
+    for (addr = W25Q128_PAGE_SIZE; rc == ASSET_OK && addr < size; addr += W25Q128_PAGE_SIZE) {
+        uint16_t n = (size - addr) < W25Q128_PAGE_SIZE ? (uint16_t)(size - addr) : W25Q128_PAGE_SIZE;
+
+        rc = read_file(&fil, addr, n);
+        if (rc == ASSET_OK) {
+            rc = program_page(FLASH_ASSET_BASE + addr, n);
+        }
+    }
+    if (rc == ASSET_OK) {
+        uint16_t n = size < W25Q128_PAGE_SIZE ? (uint16_t)size : W25Q128_PAGE_SIZE;
+
+        rc = read_file(&fil, 0, n);
+        if (rc == ASSET_OK) {
+            rc = program_page(FLASH_ASSET_BASE, n);
+        }
+    }
+    f_close(&fil);
+
+    if (rc == ASSET_OK) {
+        rc = Asset_Init();
+    }
+    if (rc == ASSET_OK) {
+        rc = Asset_VerifyAll();
+        if (rc != ASSET_OK) {
+            asset_state = ASSET_STATE_NONE;
+        }
+    }
+    printf("asset: install %s -> %d (%lu bytes, %u assets)\r\n", path, rc,
+           (unsigned long)size, h.count);
+    return rc;
+}
+
+void Asset_GetStats(Asset_Stats *stats)
+{
+    if (stats != NULL) {
+        *stats = asset_stats;
+    }
+}
+
+/**
+ * @brief 打印资源列表（按哈希表槽顺序）
+ */
+void Asset_PrintList(void)
+{
+    static const char *const type_names[] = {"raw", "bitmap", "frame", "font", "melody"};
+    AssetEntry e;
+
+    if (asset_ensure_ready() != ASSET_OK) {
+        printf("asset: no pack at 0x%06lX\r\n", (unsigned long)FLASH_ASSET_BASE);
+        return;
+    }
+    printf("asset: %u assets, %lu bytes, %u buckets\r\n", asset_hdr.count,
+           (unsigned long)asset_hdr.image_size, asset_hdr.buckets);
+    for (uint16_t slot = 0; slot < asset_hdr.buckets; slot++) {
+        W25Q128_ReadData((uint8_t *)&e, entry_addr(slot), sizeof(e));
+        if (e.hash == 0) {
+            continue;
+        }
+        e.name[ASSET_NAME_MAX - 1] = '\0';
+        printf("  %-20s %-6s %6lu B  %3ux%-3u x%-4u @0x%06lX\r\n", e.name,
+               e.type < sizeof(type_names) / sizeof(type_names[0]) ? type_names[e.type] : "?",
+               (unsigned long)e.length, e.w, e.h, e.count,
+               (unsigned long)(FLASH_ASSET_BASE + e.offset));
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file asset.h
+ * @brief W25Q128 资源包：按名字查找图标、字模、整屏图片和旋律，数据直接读到目标缓冲区
+ * @details 资源包由主机工具 asset_pack（simulator/examples/asset_pack.c）根据清单生成，
+ *          格式见 asset_pack.h，整体写入 FLASH_ASSET_BASE 分区。更换图片或旋律只需重写分区，
+ *          不用重新烧写 MCU：
+ *          - 首次使用时读映像头并校验头和哈希表的 CRC，之后 RAM 中只保留 32 字节的头
+ *          - Asset_Find 按名字哈希读取哈希表槽（通常一次 48 字节读取）
+ *          - Asset_Read 用 W25Q128_ReadData_DMA 直接读到调用方的缓冲区（例如 OLED 显存），
+ *            资源不在 RAM 中另存副本
+ *          - Asset_Install 从 FatFs 文件写入分区，映像头所在的页最后编程，
+ *            中途掉电时分区没有有效的头，使用方退回编译进固件的数据
+ *
+ *          资源包与 FatFs 共用 SPI1。存储服务运行时，Asset_* 只能在存储任务中调用
+ *          （Storage_Call 或 STORAGE_OP_CALL 的 job），UI 使用 asset_view.h 中的封装。
+ */
+
+#ifndef ASSET_H
+#define ASSET_H
+
+#include "asset_pack.h"
+#include <stdint.h>
+
+// 返回值
+#define ASSET_OK            0
+#define ASSET_ERR_NOT_FOUND 1
+#define ASSET_ERR_NO_PACK   2   ///< 分区中没有有效映像
+#define ASSET_ERR_CRC       3   ///< 映像头、哈希表或资源数据校验失败
+#define ASSET_ERR_FLASH     4   ///< 读取、编程或擦除失败
+#define ASSET_ERR_PARAM     5   ///< 越界、类型不符或缓冲区太小
+#define ASSET_ERR_FILE      6   ///< 安装时读取文件失败
+
+/**
+ * @brief 查找结果
+ */
+typedef struct {
+    uint32_t addr;          ///< 数据在 W25Q128 中的绝对地址
+    uint32_t length;        ///< 数据字节数
+    uint32_t crc;           ///< 数据 CRC32
+    uint8_t  type;          ///< AssetType
+    uint16_t count;         ///< 字符数 / 音符数
+    uint16_t w;             ///< 见 AssetType
+    uint16_t h;
+} AssetInfo;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t lookups;       ///< Asset_Find 调用次数
+    uint32_t probes;        ///< 读取的哈希表槽数
+    uint32_t reads;         ///< Asset_Read 调用次数
+    uint32_t bytes_read;    ///< Asset_Read 读出的字节数
+    uint32_t crc_errors;    ///< 校验失败次数
+    uint16_t count;         ///< 映像中的资源数
+    uint32_t image_size;    ///< 映像字节数
+} Asset_Stats;
+
+int Asset_Init(void);
+uint8_t Asset_Available(void);
+int Asset_Find(const char *name, AssetInfo *info);
+int Asset_Read(const AssetInfo *info, uint32_t offset, void *dst, uint32_t len);
+int Asset_Verify(const AssetInfo *info);
+int Asset_VerifyAll(void);
+int Asset_Install(const char *path);
+
+void Asset_GetStats(Asset_Stats *stats);
+void Asset_PrintList(void);
+
+#endif
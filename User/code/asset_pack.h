@@ -0,0 +1,84 @@
+/**
+ * @file asset_pack.h
+ * @brief 资源包映像格式（主机打包工具 asset_pack 与固件 asset.c 共用）
+ * @details 映像写入 W25Q128 的 FLASH_ASSET_BASE 分区，布局：
+ *
+ *          0x0000  AssetPackHeader (32B)
+ *          0x0020  哈希表 buckets x AssetEntry (48B)，开放寻址，线性探测
+ *          ...     资源数据，每个资源从 256B 页边界开始
+ *
+ *          按名字查找：hash = Asset_Hash(name)，从 hash & (buckets-1) 开始逐槽读取，
+ *          hash 为 0 的槽表示空槽（查找结束）。buckets 取不小于 2 倍资源数的 2 的幂，
+ *          一次查找通常只读一个 48B 槽。
+ *
+ *          所有多字节字段为小端（与 Cortex-M4 相同），CRC 为标准 CRC-32（crc.h 的 CRC32_Calc）。
+ */
+
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <stdint.h>
+
+#define ASSET_PACK_MAGIC        0x4B505341UL    ///< "ASPK"
+#define ASSET_PACK_VERSION      1
+#define ASSET_PACK_ALIGN        256             ///< 资源数据对齐（W25Q128 页大小）
+#define ASSET_NAME_MAX          24              ///< 名字长度上限（含结尾 0）
+
+/**
+ * @brief 资源类型
+ */
+typedef enum {
+    ASSET_TYPE_RAW = 0,     ///< 原始字节
+    ASSET_TYPE_BITMAP,      ///< OLED_ShowPicture 格式（逐页行优先，每字节 8 个纵向像素，低位在上），w/h 为像素
+    ASSET_TYPE_FRAME,       ///< 整屏 128x64，按 OLED_GRAM 列优先排列（每列 8 字节），可直接读入显存
+    ASSET_TYPE_FONT,        ///< oledfont.h 格式字模表，w/h 为字符像素，count 为字符数
+    ASSET_TYPE_MELODY       ///< NumberedNote 数组（每个 6 字节），w 为 TimeSignature，h 为 BPM，count 为音符数
+} AssetType;
+
+/**
+ * @brief 映像头
+ */
+typedef struct {
+    uint32_t magic;         ///< ASSET_PACK_MAGIC
+    uint16_t version;       ///< ASSET_PACK_VERSION
+    uint16_t entry_size;    ///< sizeof(AssetEntry)
+    uint16_t buckets;       ///< 哈希表槽数（2 的幂）
+    uint16_t count;         ///< 资源数
+    uint32_t image_size;    ///< 映像总字节数
+    uint32_t data_offset;   ///< 第一个资源的偏移
+    uint32_t table_crc;     ///< 哈希表 CRC32
+    uint32_t reserved;
+    uint32_t header_crc;    ///< 以上字段的 CRC32
+} AssetPackHeader;
+
+/**
+ * @brief 哈希表槽
+ */
+typedef struct {
+    uint32_t hash;          ///< Asset_Hash(name)，0 为空槽
+    uint32_t offset;        ///< 数据偏移（相对映像起始，ASSET_PACK_ALIGN 对齐）
+    uint32_t length;        ///< 数据字节数
+    uint32_t crc;           ///< 数据 CRC32
+    uint8_t  type;          ///< AssetType
+    uint8_t  flags;         ///< 保留，写 0
+    uint16_t count;         ///< 字符数 / 音符数，其它类型为 1
+    uint16_t w;             ///< 见 AssetType
+    uint16_t h;
+    char     name[ASSET_NAME_MAX];
+} AssetEntry;
+
+/**
+ * @brief 名字哈希（FNV-1a），结果 0 让给空槽
+ */
+static inline uint32_t Asset_Hash(const char *name)
+{
+    uint32_t h = 2166136261UL;
+
+    while (*name) {
+        h ^= (uint8_t)*name++;
+        h *= 16777619UL;
+    }
+    return h ? h : 1;
+}
+
+#endif
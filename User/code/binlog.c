@@ -0,0 +1,72 @@
+/**
+ * @file binlog.c
+ * @brief 二进制日志实现
+ */
+
+#include "binlog.h"
+
+// logstr 段的起始地址：编号 = 格式串地址 - 段首
+#if defined(__ARMCC_VERSION)
+extern const char logstr$$Base[];
+#define LOGSTR_BASE     logstr$$Base
+#else
+extern const char __start_logstr[] __attribute__((weak));   // 没有任何 LOG_* 时段不存在
+#define LOGSTR_BASE     __start_logstr
+#endif
+
+static LogOutput log_output = 0;
+static LogClock log_clock = 0;
+static Log_Stats log_stats;
+
+/**
+ * @brief 设置输出函数和时间戳来源（毫秒）；未设置输出时记录直接丢弃
+ */
+void Log_Init(LogOutput output, LogClock clock)
+{
+    log_output = output;
+    log_clock = clock;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * @brief 编码一条记录并整条输出（由 LOG_* 宏调用）
+ * @param fmt logstr 段中的格式串
+ */
+void Log_Write(const char *fmt, const uint32_t *args, uint32_t nargs)
+{
+    uint8_t rec[LOG_RECORD_MAX];
+    uint32_t id = (uint32_t)(fmt - LOGSTR_BASE);
+    uint32_t len;
+
+    if (nargs > LOG_MAX_ARGS) {
+        nargs = LOG_MAX_ARGS;
+    }
+    rec[0] = (uint8_t)(LOG_SYNC | nargs);
+    rec[1] = (uint8_t)id;
+    rec[2] = (uint8_t)(id >> 8);
+    put32(&rec[3], log_clock != 0 ? log_clock() : 0);
+    for (uint32_t i = 0; i < nargs; i++) {
+        put32(&rec[7 + 4 * i], args[i]);
+    }
+    len = 7 + 4 * nargs;
+
+    // 统计只是近似值（多个任务同时写时可能少计），不为它加锁
+    if (log_output != 0 && log_output(rec, len) != 0) {
+        log_stats.records++;
+        log_stats.bytes += len;
+    } else {
+        log_stats.dropped++;
+    }
+}
+
+void Log_GetStats(Log_Stats *stats)
+{
+    *stats = log_stats;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file binlog.h
+ * @brief 二进制日志：格式串不在目标板上格式化，只发送编号、时间戳和原始参数
+ * @details 每条 LOG_* 的格式串放在 logstr 段里，编号是它在段内的偏移（编译/链接时确定）。
+ *          运行时不调用 vsnprintf，只把一条记录写入串口发送缓冲区：
+ *
+ *            0xF8|参数个数  编号(2 字节)  时间戳 ms(4 字节)  参数(每个 4 字节)   小端
+ *
+ *          首字节 0xF8~0xFF 不会出现在 ASCII/UTF-8 文本中，二进制记录和普通 printf 可以混在同一个串口上。
+ *          主机工具 log_decode（simulator/examples）从固件映像（.axf/.elf）取出 logstr 段
+ *          （GCC 的 __start_logstr/__stop_logstr，armlink 的 logstr$$Base/logstr$$Limit）生成字符串表，
+ *          再按表把抓到的串口数据还原成文本。
+ *
+ *          段内每个字符串为 "级别|模块|格式串"。参数一律按 32 位整数传递：
+ *          %d %i %u %x %X %o %c（可带 l/h 修饰和宽度）直接使用；浮点数用 LOG_F(x) 传位模式，
+ *          格式串中写 %f/%g/%e；不支持 %s（字符串在发送时可能已经不存在）。最多 LOG_MAX_ARGS 个参数。
+ *
+ *          级别在编译时裁剪：每个源文件在包含本头文件前可定义 LOG_MODULE（模块名，标识符）和
+ *          LOG_LEVEL（本模块输出到哪一级，默认 LOG_DEFAULT_LEVEL）；高于 LOG_LEVEL 或全局上限
+ *          LOG_MAX_LEVEL 的调用由预处理器展开为空语句，格式串和参数计算都不进映像。
+ *          LOG_BINARY 定义为 0 时退回 printf 文本输出（没有解码工具时使用）。
+ */
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stdint.h>
+#include <string.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#define LOG_LEVEL_NONE      0
+#define LOG_LEVEL_ERROR     1
+#define LOG_LEVEL_WARN      2
+#define LOG_LEVEL_INFO      3
+#define LOG_LEVEL_DEBUG     4
+
+#ifndef LOG_BINARY
+#define LOG_BINARY          1       ///< 0: LOG_* 退回 printf 文本
+#endif
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL       LOG_LEVEL_DEBUG     ///< 全局上限，发布版本可在编译选项中调低
+#endif
+#ifndef LOG_DEFAULT_LEVEL
+#define LOG_DEFAULT_LEVEL   LOG_LEVEL_INFO      ///< 没有定义 LOG_LEVEL 的模块
+#endif
+#define LOG_MAX_ARGS        7       ///< 首字节低 3 位
+#define LOG_RECORD_MAX      (7 + 4 * LOG_MAX_ARGS)
+#define LOG_SYNC            0xF8    ///< 记录首字节的高 5 位
+
+#ifndef LOG_MODULE
+#define LOG_MODULE          app
+#endif
+#ifndef LOG_LEVEL
+#define LOG_LEVEL           LOG_DEFAULT_LEVEL
+#endif
+
+/**
+ * @brief 输出一条编码好的记录，返回 0 表示丢弃（由 Log_Init 设置，固件为 Debug_WriteRecord）
+ */
+typedef uint32_t (*LogOutput)(const uint8_t *record, uint32_t len);
+typedef uint32_t (*LogClock)(void);
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t records;       ///< 输出的记录数
+    uint32_t bytes;         ///< 输出的字节数
+    uint32_t dropped;       ///< 输出函数丢弃的记录数
+} Log_Stats;
+
+void Log_Init(LogOutput output, LogClock clock);
+void Log_Write(const char *fmt, const uint32_t *args, uint32_t nargs);
+void Log_GetStats(Log_Stats *stats);
+
+// 浮点参数按位模式传递
+static inline uint32_t LOG_F(float x)
+{
+    uint32_t u;
+
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+// =============================================================================
+// 记录宏
+// =============================================================================
+#define LOG_STR_(x)         #x
+#define LOG_STR(x)          LOG_STR_(x)
+
+#if LOG_BINARY
+// 格式串放进 logstr 段，编号是它相对段首的偏移
+#define LOG_EMIT(tag, fmt, ...)                                                         \
+    do {                                                                                \
+        static const char log_fmt_[] __attribute__((section("logstr"), aligned(1))) =  \
+            tag "|" LOG_STR(LOG_MODULE) "|" fmt;                                        \
+        const uint32_t log_args_[] = { 0, ##__VA_ARGS__ };                              \
+        Log_Write(log_fmt_, &log_args_[1], sizeof(log_args_) / sizeof(uint32_t) - 1);   \
+    } while (0)
+#else
+#include <stdio.h>
+#define LOG_EMIT(tag, fmt, ...) printf(tag " " LOG_STR(LOG_MODULE) ": " fmt "\r\n", ##__VA_ARGS__)
+#endif
+
+// 本模块没有打开的级别展开为空语句：参数不求值，格式串不进映像（与优化等级无关）
+#define LOG_NOP(fmt, ...)   do { } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR && LOG_MAX_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) LOG_EMIT("E", fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR           LOG_NOP
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN && LOG_MAX_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...)  LOG_EMIT("W", fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN            LOG_NOP
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO && LOG_MAX_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...)  LOG_EMIT("I", fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO            LOG_NOP
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG && LOG_MAX_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) LOG_EMIT("D", fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG           LOG_NOP
+#endif
+#endif
@@ -0,0 +1,81 @@
+/**
+ * @file console_chan.c
+ * @brief 控制台通道实现
+ */
+
+#include "console_chan.h"
+#include <stddef.h>
+
+void ConsoleChan_Init(ConsoleChan *ch, uint8_t *buf, uint16_t size, ConsoleChan_Commit commit)
+{
+    ch->buf = buf;
+    ch->size = size;
+    ch->len = 0;
+    ch->busy = 0;
+    ch->since = 0;
+    ch->commit = commit;
+    ch->owner = NULL;
+    ch->stats.records = 0;
+    ch->stats.full = 0;
+    ch->stats.stale = 0;
+    ch->stats.dropped = 0;
+}
+
+static void chan_commit(ConsoleChan *ch, ConsoleChan_Commit commit)
+{
+    if (commit(ch->buf, ch->len) == 0) {
+        ch->stats.dropped++;
+    }
+    ch->stats.records++;
+    ch->len = 0;
+}
+
+/**
+ * @brief 写一个字节，遇到 '\n' 或缓冲区满时整段提交（只由所属任务调用）
+ * @param now 当前时刻，缓冲区为空时记下，ConsoleChan_FlushStale 按它判断等了多久
+ */
+void ConsoleChan_Putc(ConsoleChan *ch, uint8_t c, uint32_t now)
+{
+    ch->busy = 1;
+    if (ch->len == 0) {
+        ch->since = now;
+    }
+    ch->buf[ch->len++] = c;
+    if (c == '\n') {
+        chan_commit(ch, ch->commit);
+    } else if (ch->len >= ch->size) {
+        ch->stats.full++;
+        chan_commit(ch, ch->commit);
+    }
+    ch->busy = 0;
+}
+
+/**
+ * @brief 提交没有换行的部分（只由所属任务调用，例如输出提示符之后）
+ */
+void ConsoleChan_Flush(ConsoleChan *ch)
+{
+    ch->busy = 1;
+    if (ch->len > 0) {
+        chan_commit(ch, ch->commit);
+    }
+    ch->busy = 0;
+}
+
+/**
+ * @brief 由别的上下文提交等了 age 以上还没有换行的部分
+ * @details 调用期间所属任务不能运行（见 console_chan.h）；所属任务写到一半时（busy）不提交。
+ * @param commit 提交函数，可以与通道的不同（固件在空闲任务中调用，用不等待的版本）
+ * @return 提交的字节数
+ */
+uint32_t ConsoleChan_FlushStale(ConsoleChan *ch, uint32_t now, uint32_t age, ConsoleChan_Commit commit)
+{
+    uint32_t len = ch->len;
+
+    if (ch->busy || len == 0 || now - ch->since < age) {
+        return 0;
+    }
+    ch->stats.stale++;
+    chan_commit(ch, commit);
+    return len;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file console_chan.h
+ * @brief 控制台通道：每个任务的 printf 先拼在自己的行缓冲区里，整行一次提交到共享的发送缓冲区
+ * @details 以前 fputc 每个字节单独写发送缓冲区，几个任务同时 printf 时各自的字节交错在一起。
+ *          现在每个任务有一个通道（debug.c 按任务分配），格式化期间只写自己的缓冲区，不加锁；
+ *          遇到 '\n' 或缓冲区满时调用 commit 整段写入（固件为 TX_WHOLE：整段写入或整段丢弃/等待），
+ *          一行不会被别的任务插进来，也不会有任务拿着全局锁做格式化。
+ *
+ *          通道只由所属任务写入（ConsoleChan_Putc / ConsoleChan_Flush）。没有换行的尾部
+ *          （提示符、进度点）由别的上下文用 ConsoleChan_FlushStale 提交：调用方要保证这期间所属任务
+ *          不会运行（固件在空闲任务的临界区内调用），busy 标志表示所属任务正在写，此时不动它。
+ *          本模块不依赖 FreeRTOS，主机模拟器（uart_tx_bench.c）用多个线程验证同一份代码。
+ */
+
+#ifndef CONSOLE_CHAN_H
+#define CONSOLE_CHAN_H
+
+#include <stdint.h>
+
+/**
+ * @brief 整段提交：返回写入的字节数，0 表示丢弃
+ */
+typedef uint32_t (*ConsoleChan_Commit)(const uint8_t *data, uint32_t len);
+
+typedef struct {
+    uint32_t records;       ///< 提交的段数
+    uint32_t full;          ///< 缓冲区满而提交（一行超过缓冲区，被拆开）
+    uint32_t stale;         ///< 没有换行、由 ConsoleChan_FlushStale 提交
+    uint32_t dropped;       ///< commit 返回 0 而丢弃的段
+} ConsoleChan_Stats;
+
+typedef struct {
+    uint8_t           *buf;
+    uint16_t           size;
+    volatile uint16_t  len;
+    volatile uint8_t   busy;    ///< 所属任务正在写（ConsoleChan_FlushStale 跳过）
+    uint32_t           since;   ///< 缓冲区里第一个字节的时刻（调用方的时钟，固件为节拍）
+    ConsoleChan_Commit commit;
+    void              *owner;   ///< 分配给哪个任务（由调用方管理），NULL 表示空闲
+    ConsoleChan_Stats  stats;
+} ConsoleChan;
+
+void ConsoleChan_Init(ConsoleChan *ch, uint8_t *buf, uint16_t size, ConsoleChan_Commit commit);
+void ConsoleChan_Putc(ConsoleChan *ch, uint8_t c, uint32_t now);
+void ConsoleChan_Flush(ConsoleChan *ch);
+uint32_t ConsoleChan_FlushStale(ConsoleChan *ch, uint32_t now, uint32_t age, ConsoleChan_Commit commit);
+
+#endif
@@ -0,0 +1,378 @@
+/**
+ * @file crc.c
+ * @brief CRC-32 校验库实现
+ */
+
+#include "crc.h"
+#include <string.h>
+
+#define CRC32_POLY_REFLECTED    0xEDB88320UL    // 标准 CRC-32（LSB 先行）
+#define CRC32_POLY              0x04C11DB7UL    // CRC 外设（MSB 先行）
+
+// 外设访问：固件直接读写 CRC 寄存器；主机校验程序（CRC_HW_MODEL）由 crc_check.c 的寄存器模型代替
+#if defined(CRC_HW_MODEL)
+#define CRC_USE_HW      1
+void CRC_Model_Reset(void);
+void CRC_Model_Write(uint32_t word);
+uint32_t CRC_Model_Read(void);
+void CRC_Model_Dma(const uint32_t *words, uint32_t count);
+#define HW_RESET()          CRC_Model_Reset()
+#define HW_WRITE(w)         CRC_Model_Write(w)
+#define HW_READ()           CRC_Model_Read()
+#define HW_LOCK()           uint32_t primask_ = 0
+#define HW_UNLOCK()         (void)primask_
+#elif !defined(FLASH_SIMULATOR)
+#define CRC_USE_HW      1
+#include "stm32f4xx.h"
+#define HW_RESET()          (CRC->CR = CRC_CR_RESET)
+#define HW_WRITE(w)         (CRC->DR = (w))
+#define HW_READ()           (CRC->DR)
+#define HW_LOCK()           uint32_t primask_ = __get_PRIMASK(); __disable_irq()
+#define HW_UNLOCK()         __set_PRIMASK(primask_)
+#define CRC_DMA_STREAM      DMA2_Stream1
+#define CRC_DMA_FLAGS       (DMA_FLAG_TCIF1 | DMA_FLAG_HTIF1 | DMA_FLAG_TEIF1 | DMA_FLAG_DMEIF1 | DMA_FLAG_FEIF1)
+#else
+#define CRC_USE_HW      0
+#endif
+
+static CRC_Stats crc_stats;
+
+// =============================================================================
+// 软件实现
+// =============================================================================
+
+#if CRC_USE_HW && !defined(CRC_HW_MODEL)
+
+// 固件：软件只处理头尾字节和外设被占用的情况，用半字节表（128 字节 Flash，不占 RAM）
+static const uint32_t nibble_reflected[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static const uint32_t nibble_msb[16] = {
+    0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9,
+    0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+    0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61,
+    0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
+};
+
+// s 为未取反的寄存器值
+static uint32_t soft_reflected(uint32_t s, const uint8_t *p, uint32_t len)
+{
+    crc_stats.sw_bytes += len;
+    while (len--) {
+        s ^= *p++;
+        s = (s >> 4) ^ nibble_reflected[s & 0x0F];
+        s = (s >> 4) ^ nibble_reflected[s & 0x0F];
+    }
+    return s;
+}
+
+static uint32_t soft_words(uint32_t r, const uint32_t *w, uint32_t count)
+{
+    crc_stats.sw_bytes += count * 4;
+    while (count--) {
+        r ^= *w++;
+        for (uint8_t i = 0; i < 8; i++) {
+            r = (r << 4) ^ nibble_msb[r >> 28];
+        }
+    }
+    return r;
+}
+
+#else
+
+// 主机：slicing-by-4，每次查 4 张表处理 4 字节；表在第一次使用时生成
+static uint32_t tab_reflected[4][256];
+static uint32_t tab_msb[4][256];
+static uint8_t tab_ready = 0;
+
+static void tables_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t r = i, m = i << 24;
+        for (uint8_t b = 0; b < 8; b++) {
+            r = (r & 1) ? (r >> 1) ^ CRC32_POLY_REFLECTED : r >> 1;
+            m = (m & 0x80000000UL) ? (m << 1) ^ CRC32_POLY : m << 1;
+        }
+        tab_reflected[0][i] = r;
+        tab_msb[0][i] = m;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (uint8_t k = 1; k < 4; k++) {
+            uint32_t r = tab_reflected[k - 1][i];
+            uint32_t m = tab_msb[k - 1][i];
+            tab_reflected[k][i] = (r >> 8) ^ tab_reflected[0][r & 0xFF];
+            tab_msb[k][i] = (m << 8) ^ tab_msb[0][m >> 24];
+        }
+    }
+    tab_ready = 1;
+}
+
+static uint32_t soft_reflected(uint32_t s, const uint8_t *p, uint32_t len)
+{
+    if (!tab_ready) {
+        tables_init();
+    }
+    crc_stats.sw_bytes += len;
+    while (len >= 4) {
+        s ^= (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        s = tab_reflected[3][s & 0xFF] ^ tab_reflected[2][(s >> 8) & 0xFF] ^
+            tab_reflected[1][(s >> 16) & 0xFF] ^ tab_reflected[0][s >> 24];
+        p += 4;
+        len -= 4;
+    }
+    while (len--) {
+        s = (s >> 8) ^ tab_reflected[0][(s ^ *p++) & 0xFF];
+    }
+    return s;
+}
+
+// 寄存器异或一个字后左移 32 位：tab_msb[k] 是第 k 个字节（从低到高）移出后对寄存器的贡献
+static uint32_t soft_words(uint32_t r, const uint32_t *w, uint32_t count)
+{
+    if (!tab_ready) {
+        tables_init();
+    }
+    crc_stats.sw_bytes += count * 4;
+    while (count--) {
+        r ^= *w++;
+        r = tab_msb[0][r & 0xFF] ^ tab_msb[1][(r >> 8) & 0xFF] ^
+            tab_msb[2][(r >> 16) & 0xFF] ^ tab_msb[3][r >> 24];
+    }
+    return r;
+}
+
+#endif
+
+// =============================================================================
+// 外设
+// =============================================================================
+
+#if CRC_USE_HW
+
+static volatile uint8_t hw_busy = 0;
+static uint8_t hw_clock = 0;
+
+// 外设同时只能有一个使用者：任务与中断都可能调用，关中断检查并占用
+static uint8_t hw_acquire(void)
+{
+    uint8_t ok;
+    HW_LOCK();
+    ok = !hw_busy;
+    hw_busy = 1;
+    HW_UNLOCK();
+    if (!ok) {
+        crc_stats.contended++;
+        return 0;
+    }
+#if !defined(CRC_HW_MODEL)
+    if (!hw_clock) {
+        RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_CRC, ENABLE);
+        hw_clock = 1;
+    }
+#else
+    (void)hw_clock;
+#endif
+    return 1;
+}
+
+static void hw_release(void)
+{
+    hw_busy = 0;
+}
+
+static uint32_t rbit(uint32_t x)
+{
+#if !defined(CRC_HW_MODEL)
+    return __RBIT(x);
+#else
+    x = ((x >> 1) & 0x55555555UL) | ((x & 0x55555555UL) << 1);
+    x = ((x >> 2) & 0x33333333UL) | ((x & 0x33333333UL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0FUL) | ((x & 0x0F0F0F0FUL) << 4);
+    x = ((x >> 8) & 0x00FF00FFUL) | ((x & 0x00FF00FFUL) << 8);
+    return (x >> 16) | (x << 16);
+#endif
+}
+
+/**
+ * @brief 复位外设并把寄存器置为 r
+ * @details 复位值 0xFFFFFFFF；写入字 W 后寄存器 = M(0xFFFFFFFF ^ W)，M 为左移 32 位取模。
+ *          M 可逆（多项式最低位为 1），把 r 逆向移 32 位即得 W
+ */
+static void hw_seed(uint32_t r)
+{
+    HW_RESET();
+    if (r == 0xFFFFFFFFUL) {
+        return;
+    }
+    for (uint8_t i = 0; i < 32; i++) {
+        r = (r & 1) ? ((r ^ CRC32_POLY) >> 1) | 0x80000000UL : r >> 1;
+    }
+    HW_WRITE(r ^ 0xFFFFFFFFUL);
+}
+
+#if CRC_USE_DMA
+/**
+ * @brief 用 DMA2 Stream1 把字数组写入 CRC->DR（存储器到存储器模式，源地址在 PAR）
+ * @details DMA 不能访问 CCM RAM（0x10000000 起的 64KB），这类缓冲区由调用方改用 CPU 写入
+ */
+static void hw_dma(const uint32_t *words, uint32_t count)
+{
+#if defined(CRC_HW_MODEL)
+    CRC_Model_Dma(words, count);
+#else
+    DMA_InitTypeDef dma;
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2, ENABLE);
+    while (count > 0) {
+        uint32_t n = count > 0xFFFF ? 0xFFFF : count;
+
+        DMA_Cmd(CRC_DMA_STREAM, DISABLE);
+        while (DMA_GetCmdStatus(CRC_DMA_STREAM) != DISABLE) {
+        }
+        DMA_ClearFlag(CRC_DMA_STREAM, CRC_DMA_FLAGS);
+
+        DMA_StructInit(&dma);
+        dma.DMA_Channel = DMA_Channel_0;
+        dma.DMA_PeripheralBaseAddr = (uint32_t)words;
+        dma.DMA_Memory0BaseAddr = (uint32_t)&CRC->DR;
+        dma.DMA_DIR = DMA_DIR_MemoryToMemory;
+        dma.DMA_BufferSize = n;
+        dma.DMA_PeripheralInc = DMA_PeripheralInc_Enable;
+        dma.DMA_MemoryInc = DMA_MemoryInc_Disable;
+        dma.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+        dma.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+        dma.DMA_Mode = DMA_Mode_Normal;
+        dma.DMA_Priority = DMA_Priority_Low;
+        dma.DMA_FIFOMode = DMA_FIFOMode_Enable;     // 存储器到存储器模式必须使用 FIFO
+        dma.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+        DMA_Init(CRC_DMA_STREAM, &dma);
+        DMA_Cmd(CRC_DMA_STREAM, ENABLE);
+
+        while (DMA_GetFlagStatus(CRC_DMA_STREAM, DMA_FLAG_TCIF1 | DMA_FLAG_TEIF1) == RESET) {
+        }
+        DMA_ClearFlag(CRC_DMA_STREAM, CRC_DMA_FLAGS);
+        words += n;
+        count -= n;
+    }
+#endif
+}
+
+static uint8_t dma_capable(const void *p, uint32_t bytes)
+{
+    uintptr_t a = (uintptr_t)p;
+
+    if (bytes < CRC_DMA_THRESHOLD || (a & 3)) {
+        return 0;
+    }
+#if !defined(CRC_HW_MODEL)
+    if (a >= 0x10000000UL && a < 0x10010000UL) {
+        return 0;       // CCM RAM
+    }
+#endif
+    return 1;
+}
+#endif
+
+#endif  // CRC_USE_HW
+
+// =============================================================================
+// 接口
+// =============================================================================
+
+/**
+ * @brief 标准 CRC-32 续算
+ * @param crc 上一段的结果，第一段传 0
+ * @return 到本段为止的 CRC
+ */
+uint32_t CRC32_Update(uint32_t crc, const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t s = ~crc;
+
+#if CRC_USE_HW
+    if (len >= CRC_HW_MIN_BYTES) {
+        uint32_t head = (4 - ((uintptr_t)p & 3)) & 3;
+
+        // 头部不对齐的字节查表，之后按字送外设
+        s = soft_reflected(s, p, head);
+        p += head;
+        len -= head;
+        if (hw_acquire()) {
+            uint32_t words = len / 4;
+            const uint32_t *w = (const uint32_t *)p;
+
+            hw_seed(rbit(s));
+            for (uint32_t i = 0; i < words; i++) {
+                HW_WRITE(rbit(w[i]));
+            }
+            s = rbit(HW_READ());
+            hw_release();
+            crc_stats.hw_words += words;
+            p += words * 4;
+            len -= words * 4;
+        }
+    }
+#endif
+    return ~soft_reflected(s, p, len);
+}
+
+uint32_t CRC32_Calc(const void *data, uint32_t len)
+{
+    return CRC32_Update(0, data, len);
+}
+
+/**
+ * @brief 只用查表计算的标准 CRC-32（与 CRC32_Update 结果相同，用于校验或中断中避免等待）
+ */
+uint32_t CRC32_UpdateSoft(uint32_t crc, const void *data, uint32_t len)
+{
+    return ~soft_reflected(~crc, (const uint8_t *)data, len);
+}
+
+/**
+ * @brief 外设原生 CRC-32/MPEG-2（初值 0xFFFFFFFF，按字 MSB 先行，不取反）
+ * @param words 字数组，使用 DMA 时需 4 字节对齐且不在 CCM RAM
+ */
+uint32_t CRC32_Block(const uint32_t *words, uint32_t count)
+{
+#if CRC_USE_HW
+    if (hw_acquire()) {
+        uint32_t r;
+
+        HW_RESET();
+#if CRC_USE_DMA
+        if (dma_capable(words, count * 4)) {
+            hw_dma(words, count);
+            crc_stats.dma_words += count;
+        } else
+#endif
+        {
+            for (uint32_t i = 0; i < count; i++) {
+                HW_WRITE(words[i]);
+            }
+            crc_stats.hw_words += count;
+        }
+        r = HW_READ();
+        hw_release();
+        return r;
+    }
+#endif
+    return soft_words(0xFFFFFFFFUL, words, count);
+}
+
+/**
+ * @brief 只用查表计算的 CRC32_Block
+ */
+uint32_t CRC32_BlockSoft(const uint32_t *words, uint32_t count)
+{
+    return soft_words(0xFFFFFFFFUL, words, count);
+}
+
+void CRC_GetStats(CRC_Stats *stats)
+{
+    *stats = crc_stats;
+}
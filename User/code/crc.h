@@ -0,0 +1,53 @@
+/**
+ * @file crc.h
+ * @brief CRC-32 校验库：固件用 STM32F4 CRC 外设，主机用 slicing-by-4 查表
+ * @details 提供两种 CRC-32，两条实现路径结果逐位相同（simulator/examples/crc_check.c 校验）：
+ *
+ *          CRC32_Update / CRC32_Calc —— 标准 CRC-32（IEEE 802.3 / zlib，反射多项式 0xEDB88320，
+ *          初值与结果取反），任意字节长度，可分段续算。KV、A/B 记录、时序存储和
+ *          主机工具使用的都是这一种，与原来的半字节查表实现结果相同，Flash 上的数据不需要迁移。
+ *          F4 的 CRC 外设只会不反射的 CRC-32/MPEG-2，固件按字写入 RBIT(字)、
+ *          读出后再 RBIT 得到反射结果；续算时先写入一个字把寄存器置成上一段的中间值。
+ *
+ *          CRC32_Block —— 外设原生的 CRC-32/MPEG-2（多项式 0x04C11DB7，初值 0xFFFFFFFF，
+ *          不反射、不取反），输入为 32 位字数组。不需要位反转，CRC_DMA_THRESHOLD 字节以上的
+ *          对齐缓冲区由 DMA2 Stream1（存储器到存储器）直接送入 CRC->DR，用于整块资源等大数据。
+ *
+ *          外设同时只能算一个 CRC：被其它任务或中断占用时退回软件查表，结果相同。
+ *          固件的软件路径（头尾字节、外设被占用时）用半字节表，不占 RAM。
+ */
+
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#define CRC_HW_MIN_BYTES    16      ///< 少于这么多字节时直接查表（置位寄存器的开销不划算）
+#define CRC_USE_DMA         1       ///< CRC32_Block 大块数据使用 DMA
+#define CRC_DMA_THRESHOLD   1024    ///< 使用 DMA 的最小字节数
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t hw_words;      ///< CPU 写入外设的字数
+    uint32_t dma_words;     ///< DMA 写入外设的字数
+    uint32_t sw_bytes;      ///< 软件查表处理的字节数
+    uint32_t contended;     ///< 外设被占用而退回软件的次数
+} CRC_Stats;
+
+// 标准 CRC-32，crc 为上一段的结果（第一段传 0）
+uint32_t CRC32_Update(uint32_t crc, const void *data, uint32_t len);
+uint32_t CRC32_Calc(const void *data, uint32_t len);
+uint32_t CRC32_UpdateSoft(uint32_t crc, const void *data, uint32_t len);
+
+// 外设原生 CRC-32/MPEG-2，按字计算
+uint32_t CRC32_Block(const uint32_t *words, uint32_t count);
+uint32_t CRC32_BlockSoft(const uint32_t *words, uint32_t count);
+
+void CRC_GetStats(CRC_Stats *stats);
+
+#endif
@@ -2,23 +2,529 @@
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "task.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "uart_rx_ring.h"
+#include "uart_tx_ring.h"
+#include "console_chan.h"
+#include <string.h>
 
-extern QueueHandle_t xDataQueue;
-extern QueueHandle_t xSendQueue;
-// 7USARTжϷʵݽպͷ͡
+// գDMA2 Stream5 ͨ4 ѭд rx_dma_bufIDLE/HT/TC жϰ
+static uint8_t rx_dma_buf[DEBUG_RX_DMA_SIZE];
+static UartRxRing rx_ring;
+static StreamBufferHandle_t rx_stream = NULL;
+static BaseType_t rx_woken;
+
+// USART1  DMA2_Stream5 жȼͬǶףֻһд뷽
+static uint32_t rx_sink(const uint8_t *data, uint32_t len, void *ctx)
+{
+    (void)ctx;
+    if (rx_stream == NULL)
+    {
+        return 0;
+    }
+    return xStreamBufferSendFromISR(rx_stream, data, len, &rx_woken);
+}
+
+static void rx_dma_start(void)
+{
+    DMA_Cmd(DMA2_Stream5, DISABLE);
+    while (DMA2_Stream5->CR & DMA_SxCR_EN);
+    DMA_ClearFlag(DMA2_Stream5, DMA_FLAG_HTIF5 | DMA_FLAG_TCIF5 | DMA_FLAG_TEIF5 | DMA_FLAG_DMEIF5 | DMA_FLAG_FEIF5);
+    DMA_SetCurrDataCounter(DMA2_Stream5, DEBUG_RX_DMA_SIZE);
+    rx_ring.last = 0;
+    DMA_Cmd(DMA2_Stream5, ENABLE);
+}
+
+// һ֡߿һֽʱ䣩ȡȦβ
 void USART1_IRQHandler(void)
 {
-    uint16_t temp = 0;
-    BaseType_t xHigherPriorityTaskWoken;
-    // жϽձ־λǷ1
-    if (USART_GetITStatus(USART1, USART_IT_RXNE) == SET)
+    uint16_t sr = USART1->SR;
+
+    rx_woken = pdFALSE;
+    if (sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_NE | USART_SR_FE))
+    {
+        (void)USART1->DR; // ȶ SR ٶ DR IDLE ʹ־
+        if (sr & USART_SR_ORE)
+        {
+            rx_ring.stats.overrun++;
+        }
+        if (sr & (USART_SR_NE | USART_SR_FE))
+        {
+            rx_ring.stats.errors++;
+        }
+        if (sr & USART_SR_IDLE)
+        {
+            rx_ring.stats.idle++;
+            UartRxRing_Poll(&rx_ring, DMA_GetCurrDataCounter(DMA2_Stream5));
+        }
+    }
+    portYIELD_FROM_ISR(rx_woken);
+}
+
+// ʱÿȦȡһ
+void DMA2_Stream5_IRQHandler(void)
+{
+    rx_woken = pdFALSE;
+    if (DMA_GetITStatus(DMA2_Stream5, DMA_IT_HTIF5) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA2_Stream5, DMA_IT_HTIF5);
+        rx_ring.stats.half++;
+        UartRxRing_Poll(&rx_ring, DMA_GetCurrDataCounter(DMA2_Stream5));
+    }
+    if (DMA_GetITStatus(DMA2_Stream5, DMA_IT_TCIF5) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA2_Stream5, DMA_IT_TCIF5);
+        rx_ring.stats.full++;
+        UartRxRing_Poll(&rx_ring, DMA_GetCurrDataCounter(DMA2_Stream5));
+    }
+    if (DMA_GetITStatus(DMA2_Stream5, DMA_IT_TEIF5) != RESET)
+    {
+        // ʱӲرȡյݺͷ¿ʼ
+        DMA_ClearITPendingBit(DMA2_Stream5, DMA_IT_TEIF5);
+        rx_ring.stats.errors++;
+        UartRxRing_Poll(&rx_ring, DMA_GetCurrDataCounter(DMA2_Stream5));
+        rx_dma_start();
+    }
+    portYIELD_FROM_ISR(rx_woken);
+}
+
+static void debug_rx_dma_init(void)
+{
+    DMA_InitTypeDef DMA_InitStruct;
+    NVIC_InitTypeDef NVIC_InitStruct;
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2, ENABLE);
+    //  main ͷǰãԴ FreeRTOS ѷ
+    rx_stream = xStreamBufferCreate(DEBUG_RX_STREAM_SIZE, 1);
+    UartRxRing_Init(&rx_ring, rx_dma_buf, DEBUG_RX_DMA_SIZE, rx_sink, NULL);
+
+    DMA_DeInit(DMA2_Stream5);
+    DMA_StructInit(&DMA_InitStruct);
+    DMA_InitStruct.DMA_Channel = DMA_Channel_4;                       // USART1_RXDMA2 Stream5 ͨ4
+    DMA_InitStruct.DMA_PeripheralBaseAddr = (uint32_t)&USART1->DR;
+    DMA_InitStruct.DMA_Memory0BaseAddr = (uint32_t)rx_dma_buf;
+    DMA_InitStruct.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStruct.DMA_BufferSize = DEBUG_RX_DMA_SIZE;
+    DMA_InitStruct.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStruct.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStruct.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStruct.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStruct.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStruct.DMA_Priority = DMA_Priority_High;                  // 921600bps ÿ 10.8us һֽ
+    DMA_InitStruct.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_Init(DMA2_Stream5, &DMA_InitStruct);
+    DMA_ITConfig(DMA2_Stream5, DMA_IT_HT | DMA_IT_TC | DMA_IT_TE, ENABLE);
+
+    //  USART1 жͬһȼɵ FromISR ӿڣ߲ụϣ
+    NVIC_InitStruct.NVIC_IRQChannel = DMA2_Stream5_IRQn;
+    NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 6;
+    NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStruct);
+
+    rx_dma_start();
+    USART_DMACmd(USART1, USART_DMAReq_Rx, ENABLE);
+}
+
+// ͣprintf д tx_bufSRAMDMA ܷ CCMDMA2 Stream7 ͨ4 ֱӴӻλһ
+static uint8_t tx_buf[DEBUG_TX_RING_SIZE];
+static UartTxRing tx_ring;
+static volatile uint32_t tx_dma_len = 0;     // ڷ͵ĳȣ0-DMA 
+static volatile uint8_t tx_policy = DEBUG_TX_FULL_POLICY;
+
+// tx_write  flags
+#define TX_WHOLE    0x01
+#define TX_NOWAIT   0x02
+#define TX_BYTE     0x04    // fputc ֱ̨ͨд루 unbuffered
+static volatile uint8_t tx_waiters = 0;
+static SemaphoreHandle_t tx_space = NULL;   // ʱͷţд뷽ڴ˵ȴ
+static Debug_TxStats tx_stats;
+
+// ⲿ÷ĻSRAM DMA ֱӷͣλ֡
+static const uint8_t *tx_ext_buf[DEBUG_TX_EXT_SLOTS];
+static uint32_t tx_ext_len[DEBUG_TX_EXT_SLOTS];
+static volatile uint32_t tx_ext_head = 0;   // ɼDebug_SendBuffer 
+static volatile uint32_t tx_ext_tail = 0;   // ɼһⲿʱ DMA же
+static volatile uint8_t tx_dma_ext = 0;     // ڷ͵ⲿ
+static uint8_t tx_ext_turn = 0;             // ߶ʱͣprintf ᱻ
+
+//  tail ʼһΣ÷ٽ DMA жУ
+static void tx_kick(void)
+{
+    const uint8_t *data;
+    uint32_t len;
+    uint8_t ext;
+
+    if (tx_dma_len != 0)
+    {
+        return;
+    }
+    ext = tx_ext_head != tx_ext_tail;
+    len = UartTxRing_Span(&tx_ring, &data);
+    if (ext && (len == 0 || tx_ext_turn))
+    {
+        data = tx_ext_buf[tx_ext_tail % DEBUG_TX_EXT_SLOTS];
+        len = tx_ext_len[tx_ext_tail % DEBUG_TX_EXT_SLOTS];
+        tx_dma_ext = 1;
+        tx_ext_turn = 0;
+    }
+    else if (len == 0)
+    {
+        return;
+    }
+    else
+    {
+        tx_dma_ext = 0;
+        tx_ext_turn = 1;
+    }
+    DMA_ClearFlag(DMA2_Stream7, DMA_FLAG_TCIF7 | DMA_FLAG_TEIF7 | DMA_FLAG_FEIF7 | DMA_FLAG_DMEIF7 | DMA_FLAG_HTIF7);
+    DMA2_Stream7->M0AR = (uint32_t)data;
+    DMA_SetCurrDataCounter(DMA2_Stream7, (uint16_t)len);
+    tx_dma_len = len;
+    tx_stats.dma_starts++;
+    DMA_Cmd(DMA2_Stream7, ENABLE);
+}
+
+// һη꣺ͷοռ䣬ŷһΣƺĲֻڼдݣ
+void DMA2_Stream7_IRQHandler(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (DMA_GetITStatus(DMA2_Stream7, DMA_IT_TCIF7) != RESET ||
+        DMA_GetITStatus(DMA2_Stream7, DMA_IT_TEIF7) != RESET)
+    {
+        if (DMA_GetITStatus(DMA2_Stream7, DMA_IT_TEIF7) != RESET)
+        {
+            tx_stats.errors++; // һϣط
+        }
+        DMA_ClearITPendingBit(DMA2_Stream7, DMA_IT_TCIF7 | DMA_IT_TEIF7);
+        if (tx_dma_ext)
+        {
+            tx_ext_tail++;
+        }
+        else
+        {
+            UartTxRing_Consume(&tx_ring, tx_dma_len);
+        }
+        tx_dma_len = 0;
+        tx_kick();
+        if (tx_waiters > 0)
+        {
+            xSemaphoreGiveFromISR(tx_space, &woken);
+        }
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void debug_tx_dma_init(void)
+{
+    DMA_InitTypeDef DMA_InitStruct;
+    NVIC_InitTypeDef NVIC_InitStruct;
+
+    UartTxRing_Init(&tx_ring, tx_buf, DEBUG_TX_RING_SIZE);
+    tx_space = xSemaphoreCreateBinary();
+
+    DMA_DeInit(DMA2_Stream7);
+    DMA_StructInit(&DMA_InitStruct);
+    DMA_InitStruct.DMA_Channel = DMA_Channel_4;                       // USART1_TXDMA2 Stream7 ͨ4
+    DMA_InitStruct.DMA_PeripheralBaseAddr = (uint32_t)&USART1->DR;
+    DMA_InitStruct.DMA_Memory0BaseAddr = (uint32_t)tx_buf;            // ÿηǰΪöεַ
+    DMA_InitStruct.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    DMA_InitStruct.DMA_BufferSize = 1;
+    DMA_InitStruct.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStruct.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStruct.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStruct.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStruct.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStruct.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStruct.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_Init(DMA2_Stream7, &DMA_InitStruct);
+    DMA_ITConfig(DMA2_Stream7, DMA_IT_TC | DMA_IT_TE, ENABLE);
+
+    NVIC_InitStruct.NVIC_IRQChannel = DMA2_Stream7_IRQn;
+    NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 6;
+    NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStruct);
+
+    USART_DMACmd(USART1, USART_DMAReq_Tx, ENABLE);
+}
+
+/**
+ * @brief д뷢ͻ DMAȴ
+ * @details 񶼻 printf߲Ψһдλʱٽֻ memcpy ͼĴ
+ *          ʱ tx_policy жСδлʱǶ
+ *          ǰ DMA жϱΣǰȴڻ
+ * @param flags TX_WHOLE-дζ/ȴд뷽ݽ־¼ң֡
+ *              TX_NOWAIT-ŲʱǶ tx_policy ȴ
+ * @return дֽ
+ */
+static uint32_t tx_write(const uint8_t *data, uint32_t len, uint8_t flags)
+{
+    uint8_t whole = (flags & TX_WHOLE) != 0;
+    uint8_t in_isr = __get_IPSR() != 0;
+    uint32_t total = 0;
+
+    while (len > 0)
+    {
+        UBaseType_t saved = 0;
+        uint8_t wait;
+        uint32_t n, used;
+
+        if (in_isr)
+        {
+            saved = taskENTER_CRITICAL_FROM_ISR();
+        }
+        else
+        {
+            taskENTER_CRITICAL();
+        }
+        if (whole && UartTxRing_Free(&tx_ring) < len)
+        {
+            n = 0;
+        }
+        else
+        {
+            n = UartTxRing_Write(&tx_ring, data, len);
+        }
+        tx_kick();
+        used = UartTxRing_Used(&tx_ring);
+        if (used > tx_stats.max_used)
+        {
+            tx_stats.max_used = used;
+        }
+        tx_stats.bytes += n;
+        if (flags & TX_BYTE)
+        {
+            tx_stats.unbuffered += n;
+        }
+        wait = n < len && tx_policy == DEBUG_TX_BLOCK && !in_isr && !(flags & TX_NOWAIT) &&
+               xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+        if (n < len && !wait)
+        {
+            tx_stats.dropped += len - n;
+        }
+        if (wait)
+        {
+            tx_waiters++;
+            tx_stats.blocked++;
+        }
+        if (in_isr)
+        {
+            taskEXIT_CRITICAL_FROM_ISR(saved);
+        }
+        else
+        {
+            taskEXIT_CRITICAL();
+        }
+        total += n;
+        if (!wait)
+        {
+            return total;
+        }
+        data += n;
+        len -= n;
+        // һηɣʱ 1 ĺԣд뷽ֻһźѣ
+        xSemaphoreTake(tx_space, 1);
+        taskENTER_CRITICAL();
+        tx_waiters--;
+        taskEXIT_CRITICAL();
+    }
+    return total;
+}
+
+/**
+ * @brief дһ־¼binlog.c 
+ * @return дֽ0-
+ */
+uint32_t Debug_WriteRecord(const uint8_t *record, uint32_t len)
+{
+    return tx_write(record, len, TX_WHOLE);
+}
+
+/**
+ * @brief д룬Ųʱң֡ѭܱס
+ * @return дֽ0-
+ */
+uint32_t Debug_TryWriteRecord(const uint8_t *record, uint32_t len)
+{
+    return tx_write(record, len, TX_WHOLE | TX_NOWAIT);
+}
+
+/**
+ * @brief  DMA ֱӷ͵÷Ļ뻷λ
+ * @details buf  SRAMCCM ܱ DMA ʣɣDebug_BuffersDone ӣ֮ǰ޸ġ
+ *          ⲿύ˳꣬ͬʱŶ DEBUG_TX_EXT_SLOTS 
+ * @return 1-Ŷӣ0-򳤶Ч
+ */
+uint32_t Debug_SendBuffer(const uint8_t *buf, uint32_t len)
+{
+    uint32_t queued = 0;
+
+    if (len == 0 || len > 0xFFFF)
+    {
+        return 0;
+    }
+    taskENTER_CRITICAL();
+    if (tx_ext_head - tx_ext_tail < DEBUG_TX_EXT_SLOTS)
+    {
+        tx_ext_buf[tx_ext_head % DEBUG_TX_EXT_SLOTS] = buf;
+        tx_ext_len[tx_ext_head % DEBUG_TX_EXT_SLOTS] = len;
+        tx_ext_head++;
+        tx_stats.ext_bytes += len;
+        tx_kick();
+        queued = 1;
+    }
+    taskEXIT_CRITICAL();
+    return queued;
+}
+
+/**
+ * @brief ѷɵⲿɼ
+ */
+uint32_t Debug_BuffersDone(void)
+{
+    return tx_ext_tail;
+}
+
+/**
+ * @brief ʱĴʽDEBUG_TX_DROP  DEBUG_TX_BLOCK
+ */
+void Debug_SetTxPolicy(uint8_t policy)
+{
+    tx_policy = policy;
+}
+
+void Debug_GetTxStats(Debug_TxStats *stats)
+{
+    taskENTER_CRITICAL();
+    memcpy(stats, &tx_stats, sizeof(*stats));
+    taskEXIT_CRITICAL();
+}
+
+// ̨ͨÿ printf ƴԼͨһд뷢ͻconsole_chan.h
+// лֻ CPU ʣ CCM RAMֲָͨ߳̾洢
+__attribute__((section(".ccmram")))
+static uint8_t con_buf[DEBUG_CONSOLE_CHANNELS][DEBUG_CONSOLE_LINE];
+static ConsoleChan con_chan[DEBUG_CONSOLE_CHANNELS];
+static uint8_t con_none;    // ֲ߳̾洢ָͨ꣬ٲ
+
+// д룬ʱ tx_policy ȴͬ Debug_WriteRecord
+static uint32_t con_commit(const uint8_t *data, uint32_t len)
+{
+    return tx_write(data, len, TX_WHOLE);
+}
+
+//  Debug_ConsoleRelease ύܵȴ
+static uint32_t con_commit_nowait(const uint8_t *data, uint32_t len)
+{
+    return tx_write(data, len, TX_WHOLE | TX_NOWAIT);
+}
+
+static void con_init(void)
+{
+    for (uint32_t i = 0; i < DEBUG_CONSOLE_CHANNELS; i++)
+    {
+        ConsoleChan_Init(&con_chan[i], con_buf[i], DEBUG_CONSOLE_LINE, con_commit);
+    }
+}
+
+// ǰѷͨûʱΪ NULL䣩
+static ConsoleChan *con_current(void)
+{
+    void *p;
+
+    if (__get_IPSR() != 0 || xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
     {
-        USART_ClearITPendingBit(USART1, USART_IT_RXNE); // ձ־λ
+        return NULL;
+    }
+    p = pvTaskGetThreadLocalStoragePointer(NULL, DEBUG_CONSOLE_TLS);
+    return p == &con_none ? NULL : (ConsoleChan *)p;
+}
 
-        temp = USART_ReceiveData(USART1); // ȡݣһֽڣ
-        xQueueSendFromISR(xDataQueue, (uint8_t*)&temp, &xHigherPriorityTaskWoken);
-        // printf("debug:%p\n",xDataQueue);
-        portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+/**
+ * @brief ǰͨһ printf ʱ
+ * @return NULL-жСǰֽͨ꣬д뷢ͻ
+ */
+static ConsoleChan *con_get(void)
+{
+    TaskHandle_t self;
+    void *p;
+
+    if (__get_IPSR() != 0 || xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+    {
+        return NULL;
+    }
+    p = pvTaskGetThreadLocalStoragePointer(NULL, DEBUG_CONSOLE_TLS);
+    if (p == NULL)
+    {
+        self = xTaskGetCurrentTaskHandle();
+        p = &con_none;
+        taskENTER_CRITICAL();
+        for (uint32_t i = 0; i < DEBUG_CONSOLE_CHANNELS; i++)
+        {
+            if (con_chan[i].owner == NULL)
+            {
+                con_chan[i].owner = self;
+                p = &con_chan[i];
+                break;
+            }
+        }
+        taskEXIT_CRITICAL();
+        vTaskSetThreadLocalStoragePointer(NULL, DEBUG_CONSOLE_TLS, p);
+    }
+    return p == &con_none ? NULL : (ConsoleChan *)p;
+}
+
+/**
+ * @brief ύǰͨûлеĲ֣ʾ֮ʾ
+ */
+void Debug_ConsoleFlush(void)
+{
+    ConsoleChan *ch = con_current();
+
+    if (ch != NULL)
+    {
+        ConsoleChan_Flush(ch);
+    }
+}
+
+/**
+ * @brief ɾ֮ǰãύʣȴͨ
+ */
+void Debug_ConsoleRelease(void)
+{
+    ConsoleChan *ch = con_current();
+
+    if (ch == NULL)
+    {
+        return;
+    }
+    taskENTER_CRITICAL();
+    ConsoleChan_FlushStale(ch, ch->since, 0, con_commit_nowait);
+    ch->owner = NULL;
+    taskEXIT_CRITICAL();
+    vTaskSetThreadLocalStoragePointer(NULL, DEBUG_CONSOLE_TLS, NULL);
+}
+
+/**
+ * @brief ύͣ DEBUG_CONSOLE_STALE ġûле
+ * @details  vApplicationIdleHook ãʱ񶼲У
+ *          ٽڼ飬дȼ ConsoleChan_Putc м䣩ʱ
+ */
+void Debug_ConsolePoll(void)
+{
+    uint32_t now = xTaskGetTickCount();
+
+    for (uint32_t i = 0; i < DEBUG_CONSOLE_CHANNELS; i++)
+    {
+        if (con_chan[i].owner != NULL && con_chan[i].len > 0)
+        {
+            taskENTER_CRITICAL();
+            ConsoleChan_FlushStale(&con_chan[i], now, DEBUG_CONSOLE_STALE, con_commit_nowait);
+            taskEXIT_CRITICAL();
+        }
     }
 }
 
@@ -45,7 +551,7 @@ void debug_init(void)
     GPIO_PinAFConfig(GPIOA, GPIO_PinSource10, GPIO_AF_USART1);
 
     // 3USART
-    USART_InitStruct.USART_BaudRate = 115200;                                    // 
+    USART_InitStruct.USART_BaudRate = DEBUG_BAUDRATE;                             // 
     USART_InitStruct.USART_WordLength = USART_WordLength_8b;                     // 8λЧλ
     USART_InitStruct.USART_StopBits = USART_StopBits_1;                          // 1λֹͣλ
     USART_InitStruct.USART_Parity = USART_Parity_No;                             // У
@@ -54,7 +560,9 @@ void debug_init(void)
     USART_Init(USART1, &USART_InitStruct);
 
     // 4жϿʹUSARTж
-    USART_ITConfig(USART1, USART_IT_RXNE, ENABLE);
+    //  DMA ɣֻ򿪿ߺʹжϣORE/NE/FEDMA ģʽ EIE 
+    USART_ITConfig(USART1, USART_IT_IDLE, ENABLE);
+    USART_ITConfig(USART1, USART_IT_ERR, ENABLE);
 
     // 5жȼҪжϲҪ裩
     NVIC_InitStruct.NVIC_IRQChannel = USART1_IRQn; // жͨ(жԴ)
@@ -64,36 +572,99 @@ void debug_init(void)
     NVIC_Init(&NVIC_InitStruct);
 
     // 6ʹUSART
+    debug_rx_dma_init();
+    debug_tx_dma_init();
+    con_init();
     USART_Cmd(USART1, ENABLE);
 }
 
-// 1ַͨУ
-void Usart1_Send_Sring(char *string)
+/**
+ * @brief ȡյݣdata_task еãֻһȡ
+ * @param ticks ûʱȴĽ
+ * @return ֽ 1 ֽڼأʱΪ 0
+ */
+uint32_t Debug_Receive(uint8_t *buf, uint32_t len, uint32_t ticks)
 {
-    while (*string != '\0')
+    if (rx_stream == NULL)
     {
-        // ַ뷢Ͷ
-        xQueueSend(xSendQueue, (uint8_t*)string++, portMAX_DELAY);
+        return 0;
     }
-    // ע⣺ﲻٵȴɣΪɷ
-    // Ҫȷݶɣһͬ
+    return xStreamBufferReceive(rx_stream, buf, len, (TickType_t)ticks);
 }
 
-// 1ֽݣͨУ
-void Usart1_send_bytes(uint8_t *buf, uint32_t len)
+void Debug_GetRxStats(UartRx_Stats *stats)
 {
-    while (len--)
+    taskENTER_CRITICAL();
+    memcpy(stats, &rx_ring.stats, sizeof(*stats));
+    taskEXIT_CRITICAL();
+}
+
+void Debug_PrintStats(void)
+{
+    UartRx_Stats st;
+    Debug_TxStats tx;
+
+    Debug_GetRxStats(&st);
+    Debug_GetTxStats(&tx);
+    printf("uart rx: %lu bytes in %lu chunks (idle %lu, half %lu, full %lu), "
+           "dropped %lu, overrun %lu, errors %lu\r\n",
+           (unsigned long)st.bytes, (unsigned long)st.chunks, (unsigned long)st.idle,
+           (unsigned long)st.half, (unsigned long)st.full, (unsigned long)st.dropped,
+           (unsigned long)st.overrun, (unsigned long)st.errors);
+    printf("uart tx: %lu bytes in %lu DMA spans, max used %lu/%u, dropped %lu, blocked %lu, errors %lu\r\n",
+           (unsigned long)tx.bytes, (unsigned long)tx.dma_starts, (unsigned long)tx.max_used,
+           DEBUG_TX_RING_SIZE, (unsigned long)tx.dropped, (unsigned long)tx.blocked,
+           (unsigned long)tx.errors);
+    printf("uart tx: %lu bytes sent from caller buffers\r\n", (unsigned long)tx.ext_bytes);
+
     {
-        // ֽڷ뷢Ͷ
-        xQueueSend(xSendQueue, buf++, portMAX_DELAY);
+        ConsoleChan_Stats cs = { 0, 0, 0, 0 };
+        uint32_t used = 0;
+
+        for (uint32_t i = 0; i < DEBUG_CONSOLE_CHANNELS; i++)
+        {
+            used += con_chan[i].owner != NULL;
+            cs.records += con_chan[i].stats.records;
+            cs.full += con_chan[i].stats.full;
+            cs.stale += con_chan[i].stats.stale;
+            cs.dropped += con_chan[i].stats.dropped;
+        }
+        printf("console: %lu/%u channels, %lu records (%lu split, %lu without newline, %lu dropped), "
+               "%lu bytes unbuffered\r\n",
+               (unsigned long)used, DEBUG_CONSOLE_CHANNELS, (unsigned long)cs.records, (unsigned long)cs.full,
+               (unsigned long)cs.stale, (unsigned long)cs.dropped, (unsigned long)tx.unbuffered);
     }
-    // ע⣺ﲻٵȴɣΪɷ
+}
+
+// 1ַд뷢ͻ DMA ͣύͨȺ˳
+void Usart1_Send_Sring(char *string)
+{
+    Debug_ConsoleFlush();
+    tx_write((const uint8_t *)string, strlen(string), 0);
+}
+
+// 1ֽݣд뷢ͻ DMA ͣ
+void Usart1_send_bytes(uint8_t *buf, uint32_t len)
+{
+    Debug_ConsoleFlush();
+    tx_write(buf, len, 0);
 }
 
 // ضc⺯printfڣضʹprintf
+// дĿ̨ͨύжк͵ǰֽд
 int fputc(int ch, FILE *f)
 {
-    /* ַ뷢Ͷ */
-    xQueueSend(xSendQueue, (uint8_t*)&ch, portMAX_DELAY);
+    ConsoleChan *con = con_get();
+    uint8_t c = (uint8_t)ch;
+
+    (void)f;
+    if (con != NULL)
+    {
+        ConsoleChan_Putc(con, c, xTaskGetTickCount());
+    }
+    else
+    {
+        tx_write(&c, 1, TX_BYTE);
+    }
     return (ch);
 }
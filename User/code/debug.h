@@ -2,9 +2,56 @@
 #define DEBUG_H
 
 #include "stm32f4xx.h"
+#include "uart_rx_ring.h"
 #include <stdio.h>
 
+#define DEBUG_BAUDRATE          921600  ///< USART1 波特率（APB2 84MHz，误差 0.16%）
+#define DEBUG_RX_DMA_SIZE       256     ///< DMA 循环接收区，半圈 128 字节（921600bps 下 1.39ms）
+#define DEBUG_RX_STREAM_SIZE    1024    ///< 交给 data_task 的流缓冲区，消费者停顿 11ms 内不丢数据
+#define DEBUG_TX_RING_SIZE      1024    ///< printf 发送环形缓冲区（2 的幂），921600bps 下 11ms 发完
+#define DEBUG_TX_EXT_SLOTS      2       ///< Debug_SendBuffer 最多同时排队的外部缓冲区
+
+// 控制台通道（console_chan.h）：每个 printf 的任务一个，整行提交
+#define DEBUG_CONSOLE_CHANNELS  8       ///< 通道数，用完后新的任务逐字节写入
+#define DEBUG_CONSOLE_LINE      128     ///< 每个通道的行缓冲区，更长的行分段提交
+#define DEBUG_CONSOLE_STALE     20      ///< 没有换行的输出在通道里最多停留的节拍数（之后由空闲任务提交）
+#define DEBUG_CONSOLE_TLS       0       ///< 通道指针所在的线程局部存储下标
+
+// 发送缓冲区满时的处理
+#define DEBUG_TX_DROP           0       ///< 丢弃放不下的部分，printf 从不等待
+#define DEBUG_TX_BLOCK          1       ///< 等待 DMA 发出一段后继续写（中断中和调度器启动前仍丢弃）
+#ifndef DEBUG_TX_FULL_POLICY
+#define DEBUG_TX_FULL_POLICY    DEBUG_TX_BLOCK
+#endif
+
+/**
+ * @brief 发送统计
+ */
+typedef struct {
+    uint32_t bytes;         ///< 写入缓冲区的字节数
+    uint32_t dma_starts;    ///< DMA 发送的段数
+    uint32_t max_used;      ///< 缓冲区最高占用
+    uint32_t dropped;       ///< 缓冲区满丢弃的字节
+    uint32_t blocked;       ///< 缓冲区满等待的次数
+    uint32_t errors;        ///< DMA 传输错误
+    uint32_t ext_bytes;     ///< 从外部缓冲区直接发送的字节（Debug_SendBuffer）
+    uint32_t unbuffered;    ///< 不经控制台通道逐字节写入的 printf 字节（中断中、调度器启动前、通道用完）
+} Debug_TxStats;
+
 void debug_init(void);
 void Usart1_Send_Sring(char *string);
 void Usart1_send_bytes(uint8_t *buf, uint32_t len);
+
+uint32_t Debug_Receive(uint8_t *buf, uint32_t len, uint32_t ticks);
+void Debug_GetRxStats(UartRx_Stats *stats);
+void Debug_SetTxPolicy(uint8_t policy);
+uint32_t Debug_WriteRecord(const uint8_t *record, uint32_t len);
+uint32_t Debug_TryWriteRecord(const uint8_t *record, uint32_t len);
+uint32_t Debug_SendBuffer(const uint8_t *buf, uint32_t len);
+uint32_t Debug_BuffersDone(void);
+void Debug_GetTxStats(Debug_TxStats *stats);
+void Debug_PrintStats(void);
+void Debug_ConsoleFlush(void);
+void Debug_ConsoleRelease(void);
+void Debug_ConsolePoll(void);
 #endif
@@ -0,0 +1,69 @@
+/**
+ * @file flash_layout.h
+ * @brief W25Q128 分区表
+ * @details 低 12MB 给 FatFs，高 4MB 留给不经过文件系统的原始分区。
+ *          原始分区的起始地址和大小都按 4KB 擦除块对齐。
+ *
+ *          0x000000 ┌──────────────────────┐
+ *                   │ FatFs 卷 (12MB)       │
+ *          0xC00000 ├──────────────────────┤
+ *                   │ KV 存储 (2 x 4KB)     │
+ *          0xC02000 ├──────────────────────┤
+ *                   │ 时序 分钟数据 (2MB)   │
+ *          0xE02000 ├──────────────────────┤
+ *                   │ 时序 小时汇总 (384KB) │
+ *          0xE62000 ├──────────────────────┤
+ *                   │ 时序 日汇总 (32KB)    │
+ *          0xE6A000 ├──────────────────────┤
+ *                   │ 步数 A/B 记录 (2x4KB) │
+ *          0xE6C000 ├──────────────────────┤
+ *                   │ 资源包 (1MB)          │
+ *          0xF6C000 ├──────────────────────┤
+ *                   │ 卡片登记表 (2x64KB)   │
+ *          0xF8C000 ├──────────────────────┤
+ *                   │ 保留                  │
+ *          0x1000000└──────────────────────┘
+ */
+
+#ifndef FLASH_LAYOUT_H
+#define FLASH_LAYOUT_H
+
+#include "spi.h"
+
+// FatFs 卷（diskio.c 只在此范围内读写）
+#define FLASH_FATFS_BASE        0x000000
+#define FLASH_FATFS_SIZE        0xC00000
+
+// 日志结构 KV 存储（kv_store.c），两个扇区轮流作为活动区
+#define FLASH_KV_BASE           (FLASH_FATFS_BASE + FLASH_FATFS_SIZE)
+#define FLASH_KV_SECTORS        2
+#define FLASH_KV_SIZE           (FLASH_KV_SECTORS * W25Q128_SECTOR_SIZE)
+
+// 时序存储（ts_store.c），每级是一个 4KB 段组成的环
+#define FLASH_TS_RAW_BASE       (FLASH_KV_BASE + FLASH_KV_SIZE)
+#define FLASH_TS_RAW_SEGMENTS   512     // 约 179 天分钟数据
+#define FLASH_TS_HOUR_BASE      (FLASH_TS_RAW_BASE + FLASH_TS_RAW_SEGMENTS * W25Q128_SECTOR_SIZE)
+#define FLASH_TS_HOUR_SEGMENTS  96      // 约 443 天小时汇总
+#define FLASH_TS_DAY_BASE       (FLASH_TS_HOUR_BASE + FLASH_TS_HOUR_SEGMENTS * W25Q128_SECTOR_SIZE)
+#define FLASH_TS_DAY_SEGMENTS   8       // 约 784 天日汇总
+
+// 双扇区定长记录（ab_record.c），每种记录 2 个扇区
+#define FLASH_AB_SIZE           (2 * W25Q128_SECTOR_SIZE)
+#define FLASH_AB_STEPS_BASE     (FLASH_TS_DAY_BASE + FLASH_TS_DAY_SEGMENTS * W25Q128_SECTOR_SIZE)
+
+// 资源包映像（asset.c，格式见 asset_pack.h），由 Asset_Install 或主机工具整体写入
+#define FLASH_ASSET_BASE        (FLASH_AB_STEPS_BASE + FLASH_AB_SIZE)
+#define FLASH_ASSET_SIZE        0x100000
+
+// 卡片登记表（rfid/tag_db.c），两个区轮流作为日志区，压缩时整表写入另一区
+#define FLASH_TAG_BASE          (FLASH_ASSET_BASE + FLASH_ASSET_SIZE)
+#define FLASH_TAG_AREA_SIZE     (16 * W25Q128_SECTOR_SIZE)
+#define FLASH_TAG_SIZE          (2 * FLASH_TAG_AREA_SIZE)
+
+#define FLASH_RESERVED_BASE     (FLASH_TAG_BASE + FLASH_TAG_SIZE)
+
+#if FLASH_RESERVED_BASE > W25Q128_CAPACITY
+#error "flash_layout.h: partitions exceed W25Q128 capacity"
+#endif
+
+#endif
@@ -0,0 +1,473 @@
+/**
+ * @file kv_store.c
+ * @brief 日志结构键值存储实现
+ * @details 扇区布局：
+ *          [扇区头 8B: magic, generation][记录][记录]...[0xFF...]
+ *          记录布局：
+ *          [key 2B][type 1B][len 1B][crc32 4B][数据，补齐到 4 字节]
+ *          CRC32 覆盖 key/type/len 和数据。全 0xFF 的记录头表示日志结尾。
+ */
+
+#include "kv_store.h"
+#include "flash_layout.h"
+#include "crc.h"
+#include <string.h>
+#include <stdio.h>
+
+#define KV_MAGIC            0x3153564BUL    // "KVS1"
+#define KV_KEY_EMPTY        0xFFFF          // 索引空槽 / 擦除后的记录头
+#define KV_KEY_TOMB         0xFFFE          // 索引中已删除的槽
+#define KV_ALIGN(n)         (((n) + 3u) & ~3u)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t generation;    // 每次压缩加 1，较大者为活动扇区
+} KV_SectorHeader;
+
+typedef struct {
+    uint16_t key;
+    uint8_t  type;
+    uint8_t  len;
+    uint32_t crc;
+} KV_RecordHeader;
+
+typedef struct {
+    uint16_t key;
+    uint16_t ofs;           // 记录在活动扇区内的偏移
+} KV_Slot;
+
+static KV_Slot kv_index[KV_INDEX_SIZE];
+static uint8_t kv_ready = 0;
+static uint8_t kv_active = 0;           // 活动扇区号
+static uint32_t kv_generation = 0;
+static uint16_t kv_write_ofs = 0;       // 下一条记录的偏移
+static KV_Stats kv_stats;
+
+// 记录读写缓冲区（头 + 最大值）
+static uint8_t kv_buf[sizeof(KV_RecordHeader) + KV_MAX_VALUE] __attribute__((aligned(4)));
+
+// CRC32 覆盖 key/type/len 和数据（crc.c，标准 CRC-32）
+static uint32_t record_crc(const KV_RecordHeader *h, const uint8_t *data)
+{
+    uint32_t crc = CRC32_Update(0, h, 4);     // key/type/len
+    return CRC32_Update(crc, data, h->len);
+}
+
+// =============================================================================
+// Flash 访问
+// =============================================================================
+
+static uint32_t kv_addr(uint8_t sector, uint16_t ofs)
+{
+    return FLASH_KV_BASE + (uint32_t)sector * W25Q128_SECTOR_SIZE + ofs;
+}
+
+// 编程后回读比较，发现位没有写进去（坏块或目标区域未擦除）时返回错误
+static int flash_write(uint32_t addr, const uint8_t *data, uint16_t len)
+{
+    uint8_t verify[32];
+
+    if (W25Q128_BufferWrite((uint8_t *)data, addr, len) != W25Q128_RESULT_OK) {
+        return KV_ERR_FLASH;
+    }
+    kv_stats.bytes_written += len;
+
+    for (uint32_t done = 0; done < len; done += sizeof(verify)) {
+        uint32_t n = len - done < sizeof(verify) ? len - done : sizeof(verify);
+        W25Q128_ReadData(verify, addr + done, (uint16_t)n);
+        if (memcmp(verify, data + done, n) != 0) {
+            return KV_ERR_FLASH;
+        }
+    }
+    return KV_OK;
+}
+
+static int sector_erase(uint8_t sector)
+{
+    return W25Q128_SectorErase(kv_addr(sector, 0)) == W25Q128_RESULT_OK ? KV_OK : KV_ERR_FLASH;
+}
+
+/**
+ * @brief 读出一条记录到 kv_buf 并校验
+ * @return KV_OK / KV_ERR_CRC
+ */
+static int record_read(uint8_t sector, uint16_t ofs, KV_RecordHeader **out)
+{
+    KV_RecordHeader *h = (KV_RecordHeader *)kv_buf;
+
+    W25Q128_ReadData(kv_buf, kv_addr(sector, ofs), sizeof(KV_RecordHeader));
+    if (h->len > KV_MAX_VALUE || ofs + sizeof(KV_RecordHeader) + KV_ALIGN(h->len) > W25Q128_SECTOR_SIZE) {
+        return KV_ERR_CRC;
+    }
+    if (h->len > 0) {
+        W25Q128_ReadData(kv_buf + sizeof(KV_RecordHeader), kv_addr(sector, ofs + sizeof(KV_RecordHeader)), h->len);
+    }
+    if (record_crc(h, kv_buf + sizeof(KV_RecordHeader)) != h->crc) {
+        kv_stats.crc_errors++;
+        return KV_ERR_CRC;
+    }
+    *out = h;
+    return KV_OK;
+}
+
+// =============================================================================
+// 哈希索引（开放寻址，线性探测）
+// =============================================================================
+
+static uint32_t index_hash(uint16_t key)
+{
+    return ((uint32_t)key * 2654435761UL) >> 16;
+}
+
+static KV_Slot *index_find(uint16_t key)
+{
+    uint32_t h = index_hash(key);
+
+    for (uint32_t i = 0; i < KV_INDEX_SIZE; i++) {
+        KV_Slot *s = &kv_index[(h + i) & (KV_INDEX_SIZE - 1)];
+        if (s->key == key) {
+            return s;
+        }
+        if (s->key == KV_KEY_EMPTY) {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static int index_put(uint16_t key, uint16_t ofs)
+{
+    uint32_t h = index_hash(key);
+    KV_Slot *free_slot = NULL;
+
+    for (uint32_t i = 0; i < KV_INDEX_SIZE; i++) {
+        KV_Slot *s = &kv_index[(h + i) & (KV_INDEX_SIZE - 1)];
+        if (s->key == key) {
+            s->ofs = ofs;
+            return KV_OK;
+        }
+        if (s->key == KV_KEY_TOMB && free_slot == NULL) {
+            free_slot = s;
+        }
+        if (s->key == KV_KEY_EMPTY) {
+            if (free_slot == NULL) {
+                free_slot = s;
+            }
+            break;
+        }
+    }
+    if (free_slot == NULL) {
+        return KV_ERR_FULL;
+    }
+    free_slot->key = key;
+    free_slot->ofs = ofs;
+    kv_stats.keys++;
+    return KV_OK;
+}
+
+static void index_remove(uint16_t key)
+{
+    KV_Slot *s = index_find(key);
+
+    if (s != NULL) {
+        s->key = KV_KEY_TOMB;
+        kv_stats.keys--;
+    }
+}
+
+static void index_clear(void)
+{
+    memset(kv_index, 0xFF, sizeof(kv_index));
+    kv_stats.keys = 0;
+}
+
+// =============================================================================
+// 扫描与压缩
+// =============================================================================
+
+/**
+ * @brief 扫描活动扇区，重建索引并定位写指针
+ * @details 遇到坏记录（掉电时写了一半）就停止，写指针置为扇区末尾，
+ *          下次写入时先压缩，坏记录之后的区域不会再被编程
+ */
+static void sector_scan(void)
+{
+    uint16_t ofs = sizeof(KV_SectorHeader);
+    KV_RecordHeader *h;
+
+    index_clear();
+    while (ofs + sizeof(KV_RecordHeader) <= W25Q128_SECTOR_SIZE) {
+        KV_RecordHeader raw;
+        W25Q128_ReadData((uint8_t *)&raw, kv_addr(kv_active, ofs), sizeof(raw));
+        if (raw.key == KV_KEY_EMPTY && raw.type == 0xFF && raw.len == 0xFF && raw.crc == 0xFFFFFFFFUL) {
+            break;      // 日志结尾
+        }
+        if (record_read(kv_active, ofs, &h) != KV_OK) {
+            ofs = W25Q128_SECTOR_SIZE;
+            break;
+        }
+        if (h->type == KV_TYPE_DELETED) {
+            index_remove(h->key);
+        } else if (index_put(h->key, ofs) != KV_OK) {
+            kv_stats.crc_errors++;
+        }
+        ofs += sizeof(KV_RecordHeader) + KV_ALIGN(h->len);
+    }
+    kv_write_ofs = ofs;
+}
+
+static int sector_format(uint8_t sector, uint32_t generation)
+{
+    KV_SectorHeader sh;
+
+    if (sector_erase(sector) != KV_OK) {
+        return KV_ERR_FLASH;
+    }
+    sh.magic = KV_MAGIC;
+    sh.generation = generation;
+    return flash_write(kv_addr(sector, 0), (const uint8_t *)&sh, sizeof(sh));
+}
+
+/**
+ * @brief 把每个键的最新记录复制到另一扇区
+ * @details 顺序：擦除备用扇区 → 复制记录 → 写扇区头（提交点）→ 擦除旧扇区。
+ *          提交点之前掉电，旧扇区仍完整；之后掉电，启动时取 generation 较大者。
+ */
+int KV_Compact(void)
+{
+    uint8_t spare = kv_active ^ 1;
+    uint16_t wofs = sizeof(KV_SectorHeader);
+    KV_SectorHeader sh;
+    KV_RecordHeader *h;
+
+    if (sector_erase(spare) != KV_OK) {
+        return KV_ERR_FLASH;
+    }
+
+    for (uint32_t i = 0; i < KV_INDEX_SIZE; i++) {
+        KV_Slot *s = &kv_index[i];
+        uint16_t size;
+
+        if (s->key == KV_KEY_EMPTY || s->key == KV_KEY_TOMB) {
+            continue;
+        }
+        if (record_read(kv_active, s->ofs, &h) != KV_OK) {
+            s->key = KV_KEY_TOMB;       // 旧扇区里已损坏的值不再复制
+            kv_stats.keys--;
+            continue;
+        }
+        size = sizeof(KV_RecordHeader) + KV_ALIGN(h->len);
+        memset(kv_buf + sizeof(KV_RecordHeader) + h->len, 0xFF, KV_ALIGN(h->len) - h->len);
+        if (flash_write(kv_addr(spare, wofs), kv_buf, size) != KV_OK) {
+            return KV_ERR_FLASH;
+        }
+        s->ofs = wofs;
+        wofs += size;
+    }
+
+    sh.magic = KV_MAGIC;
+    sh.generation = kv_generation + 1;
+    if (flash_write(kv_addr(spare, 0), (const uint8_t *)&sh, sizeof(sh)) != KV_OK) {
+        return KV_ERR_FLASH;
+    }
+
+    kv_active = spare;
+    kv_generation = sh.generation;
+    kv_write_ofs = wofs;
+    kv_stats.compactions++;
+
+    return sector_erase(spare ^ 1);
+}
+
+// =============================================================================
+// 接口
+// =============================================================================
+
+/**
+ * @brief 选择活动扇区并建立索引（首次调用 KV_Get/KV_Set 时自动执行）
+ */
+int KV_Init(void)
+{
+    KV_SectorHeader sh[FLASH_KV_SECTORS];
+    uint8_t valid[FLASH_KV_SECTORS];
+
+    SPI1_Init();
+    memset(&kv_stats, 0, sizeof(kv_stats));
+    for (uint8_t i = 0; i < FLASH_KV_SECTORS; i++) {
+        W25Q128_ReadData((uint8_t *)&sh[i], kv_addr(i, 0), sizeof(sh[i]));
+        valid[i] = sh[i].magic == KV_MAGIC && sh[i].generation != 0xFFFFFFFFUL;
+    }
+
+    if (!valid[0] && !valid[1]) {
+        // 全新分区
+        kv_active = 0;
+        kv_generation = 1;
+        if (sector_format(0, kv_generation) != KV_OK) {
+            return KV_ERR_FLASH;
+        }
+    } else {
+        kv_active = (valid[1] && (!valid[0] || sh[1].generation > sh[0].generation)) ? 1 : 0;
+        kv_generation = sh[kv_active].generation;
+    }
+
+    sector_scan();
+    kv_ready = 1;
+    return KV_OK;
+}
+
+static int kv_ensure_ready(void)
+{
+    return kv_ready ? KV_OK : KV_Init();
+}
+
+/**
+ * @brief 读取键值
+ * @param type 期望的类型
+ * @param buf  输出缓冲区
+ * @param size 缓冲区大小，值更长时截断
+ * @param len  输出实际值长度（可为 NULL）
+ */
+int KV_Get(uint16_t key, uint8_t type, void *buf, uint16_t size, uint16_t *len)
+{
+    KV_Slot *s;
+    KV_RecordHeader *h;
+    int ret = kv_ensure_ready();
+
+    if (ret != KV_OK) {
+        return ret;
+    }
+    s = index_find(key);
+    if (s == NULL) {
+        return KV_ERR_NOT_FOUND;
+    }
+    ret = record_read(kv_active, s->ofs, &h);
+    if (ret != KV_OK) {
+        return ret;
+    }
+    if (h->type != type) {
+        return KV_ERR_TYPE;
+    }
+    memcpy(buf, kv_buf + sizeof(KV_RecordHeader), h->len < size ? h->len : size);
+    if (len != NULL) {
+        *len = h->len;
+    }
+    return KV_OK;
+}
+
+// 追加一条记录；空间不够时先压缩
+static int kv_append(uint16_t key, uint8_t type, const void *data, uint16_t len)
+{
+    KV_RecordHeader *h = (KV_RecordHeader *)kv_buf;
+    uint16_t size = sizeof(KV_RecordHeader) + KV_ALIGN(len);
+    int ret;
+
+    if (kv_write_ofs + size > W25Q128_SECTOR_SIZE) {
+        ret = KV_Compact();
+        if (ret != KV_OK) {
+            return ret;
+        }
+        if (kv_write_ofs + size > W25Q128_SECTOR_SIZE) {
+            return KV_ERR_FULL;
+        }
+    }
+
+    // 新键先占索引槽，索引满时不写 Flash
+    if (type != KV_TYPE_DELETED && index_find(key) == NULL && kv_stats.keys >= KV_INDEX_SIZE * 3 / 4) {
+        return KV_ERR_FULL;
+    }
+
+    h->key = key;
+    h->type = type;
+    h->len = (uint8_t)len;
+    memcpy(kv_buf + sizeof(KV_RecordHeader), data, len);
+    memset(kv_buf + sizeof(KV_RecordHeader) + len, 0xFF, KV_ALIGN(len) - len);
+    h->crc = record_crc(h, kv_buf + sizeof(KV_RecordHeader));
+
+    ret = flash_write(kv_addr(kv_active, kv_write_ofs), kv_buf, size);
+    if (ret != KV_OK) {
+        kv_write_ofs = W25Q128_SECTOR_SIZE;     // 该位置状态未知，下次写入前压缩
+        return ret;
+    }
+
+    if (type == KV_TYPE_DELETED) {
+        index_remove(key);
+    } else {
+        index_put(key, kv_write_ofs);
+    }
+    kv_write_ofs += size;
+    kv_stats.sets++;
+    return KV_OK;
+}
+
+/**
+ * @brief 写入键值；值与当前记录相同时不写 Flash
+ */
+int KV_Set(uint16_t key, uint8_t type, const void *data, uint16_t len)
+{
+    KV_Slot *s;
+    KV_RecordHeader *h;
+    int ret;
+
+    if (key >= KV_KEY_TOMB || len > KV_MAX_VALUE || type == KV_TYPE_DELETED || (len > 0 && data == NULL)) {
+        return KV_ERR_PARAM;
+    }
+    ret = kv_ensure_ready();
+    if (ret != KV_OK) {
+        return ret;
+    }
+
+    s = index_find(key);
+    if (s != NULL && record_read(kv_active, s->ofs, &h) == KV_OK &&
+        h->type == type && h->len == len &&
+        memcmp(kv_buf + sizeof(KV_RecordHeader), data, len) == 0) {
+        kv_stats.unchanged++;
+        return KV_OK;
+    }
+    return kv_append(key, type, data, len);
+}
+
+int KV_Delete(uint16_t key)
+{
+    int ret = kv_ensure_ready();
+
+    if (ret != KV_OK) {
+        return ret;
+    }
+    if (index_find(key) == NULL) {
+        return KV_OK;
+    }
+    return kv_append(key, KV_TYPE_DELETED, NULL, 0);
+}
+
+int KV_GetU32(uint16_t key, uint32_t *value)
+{
+    uint16_t len;
+    int ret = KV_Get(key, KV_TYPE_U32, value, sizeof(*value), &len);
+
+    if (ret == KV_OK && len != sizeof(*value)) {
+        return KV_ERR_TYPE;
+    }
+    return ret;
+}
+
+int KV_SetU32(uint16_t key, uint32_t value)
+{
+    return KV_Set(key, KV_TYPE_U32, &value, sizeof(value));
+}
+
+void KV_GetStats(KV_Stats *stats)
+{
+    *stats = kv_stats;
+    stats->used = kv_write_ofs;
+}
+
+void KV_PrintStats(void)
+{
+    printf("kv: sector %u gen %lu, %u keys, used %u/%u, sets %lu, unchanged %lu, "
+           "compactions %lu, written %lu B, crc errors %lu\r\n",
+           kv_active, (unsigned long)kv_generation, kv_stats.keys,
+           kv_write_ofs, W25Q128_SECTOR_SIZE,
+           (unsigned long)kv_stats.sets, (unsigned long)kv_stats.unchanged,
+           (unsigned long)kv_stats.compactions, (unsigned long)kv_stats.bytes_written,
+           (unsigned long)kv_stats.crc_errors);
+}
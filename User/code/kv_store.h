@@ -0,0 +1,77 @@
+/**
+ * @file kv_store.h
+ * @brief W25Q128 原始分区上的日志结构键值存储
+ * @details 用于步数、闹钟、设置等小数据，不经过 FatFs：
+ *          - 每次写入在活动扇区末尾追加一条记录（类型 + 长度 + CRC32），
+ *            通常只需一次页编程，不擦除
+ *          - 启动时扫描活动扇区，在 RAM 中建立 键 → 偏移 的哈希索引
+ *          - 活动扇区写满时把每个键的最新记录复制到另一扇区（压缩），
+ *            新扇区头写入后才擦除旧扇区，掉电时总有一个完整扇区可用
+ *
+ *          KV 与 FatFs 共用 SPI1。存储服务运行时，KV_* 只能在存储任务中调用
+ *          （Storage_Call 或 STORAGE_OP_CALL 的 job）。
+ */
+
+#ifndef KV_STORE_H
+#define KV_STORE_H
+
+#include <stdint.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#define KV_INDEX_SIZE       32      ///< 哈希索引槽数（2 的幂），最多约 24 个键
+#define KV_MAX_VALUE        248     ///< 单个值最大字节数
+
+// =============================================================================
+// 键分配（集中在这里避免冲突；0xFFFE/0xFFFF 保留）
+// =============================================================================
+#define KV_KEY_ALARMS       0x0201  ///< 闹钟表 (BLOB: 数量 + Alarm_TypeDef[])
+#define KV_KEY_RTC_SETTINGS 0x0301  ///< 最后保存的日期时间 (BLOB: RTC_Settings_TypeDef)
+
+/**
+ * @brief 值类型
+ */
+typedef enum {
+    KV_TYPE_U32     = 0x01,
+    KV_TYPE_I32     = 0x02,
+    KV_TYPE_BLOB    = 0x03,
+    KV_TYPE_STRING  = 0x04,
+    KV_TYPE_DELETED = 0x7F      ///< 删除标记
+} KV_Type;
+
+// 返回值
+#define KV_OK               0
+#define KV_ERR_NOT_FOUND    1
+#define KV_ERR_TYPE         2   ///< 存储的类型与请求的不符
+#define KV_ERR_FULL         3   ///< 压缩后仍放不下，或索引已满
+#define KV_ERR_FLASH        4   ///< 编程/擦除失败或回读不一致
+#define KV_ERR_CRC          5   ///< 记录校验失败
+#define KV_ERR_PARAM        6
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t sets;          ///< 写入的记录数
+    uint32_t unchanged;     ///< 值未变化而跳过的写入
+    uint32_t compactions;   ///< 压缩次数
+    uint32_t bytes_written; ///< 写入 Flash 的字节数
+    uint32_t crc_errors;    ///< 扫描或读取时发现的坏记录
+    uint16_t keys;          ///< 当前键数
+    uint16_t used;          ///< 活动扇区已用字节
+} KV_Stats;
+
+int KV_Init(void);
+int KV_Get(uint16_t key, uint8_t type, void *buf, uint16_t size, uint16_t *len);
+int KV_Set(uint16_t key, uint8_t type, const void *data, uint16_t len);
+int KV_Delete(uint16_t key);
+int KV_Compact(void);
+
+int KV_GetU32(uint16_t key, uint32_t *value);
+int KV_SetU32(uint16_t key, uint32_t value);
+
+void KV_GetStats(KV_Stats *stats);
+void KV_PrintStats(void);
+
+#endif
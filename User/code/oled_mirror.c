@@ -0,0 +1,210 @@
+/**
+ * @file oled_mirror.c
+ * @brief OLED 显存镜像实现（见 oled_mirror.h）
+ */
+
+#include "oled_mirror.h"
+#include <string.h>
+
+#define REC_HEADER      3
+#define REC_MAX(n)      (REC_HEADER + (n) + ((n) + 127) / 128)     // 全部为原样字节时的最大长度
+
+void OledMirror_Init(OledMirror *m, OledMirrorSend send, void *ctx)
+{
+    memset(m, 0, sizeof(*m));
+    m->send = send;
+    m->ctx = ctx;
+    m->need_key = 1;            // 上位机的画面未知，第一次刷新发整屏
+}
+
+/**
+ * @brief RLE 压缩 n 个字节（输入相隔 stride 字节，显存的一行）
+ * @return 输出字节数，不超过 n + (n + 127) / 128
+ */
+uint32_t OledMirror_RleEncode(const uint8_t *in, uint32_t stride, uint32_t n, uint8_t *out)
+{
+    uint32_t i = 0, o = 0, lit = 0, lit_at = 0;
+
+    while (i < n) {
+        uint8_t v = in[i * stride];
+        uint32_t r = 1;
+
+        while (i + r < n && r < 129 && in[(i + r) * stride] == v) {
+            r++;
+        }
+        if (r >= 3) {
+            if (lit > 0) {
+                out[lit_at] = (uint8_t)(lit - 1);
+                lit = 0;
+            }
+            out[o++] = (uint8_t)(0x80 + r - 2);
+            out[o++] = v;
+            i += r;
+            continue;
+        }
+        if (lit == 0) {
+            lit_at = o++;
+        }
+        out[o++] = v;
+        i++;
+        if (++lit == 128) {
+            out[lit_at] = 127;
+            lit = 0;
+        }
+    }
+    if (lit > 0) {
+        out[lit_at] = (uint8_t)(lit - 1);
+    }
+    return o;
+}
+
+static void flush(OledMirror *m)
+{
+    if (m->len == 0) {
+        return;
+    }
+    if (m->send(m->ctx, m->buf, m->len) != 0) {
+        m->stats.frames++;
+        m->stats.bytes += m->len;
+    } else {
+        m->stats.dropped++;
+        m->need_key = 1;        // 上位机少了这些段，下一次刷新整屏重发
+    }
+    m->len = 0;
+}
+
+// 一条记录：第 page 页 x 起 n 列，写入帧缓冲区（放不下时先发出已有的记录）并更新副本
+static void put_span(OledMirror *m, const uint8_t *gram, uint8_t page, uint8_t x, uint8_t n, uint8_t flags)
+{
+    uint8_t *rec;
+
+    if (m->len + REC_MAX(n) > OLED_MIRROR_PAYLOAD) {
+        flush(m);
+    }
+    rec = &m->buf[m->len];
+    rec[0] = (uint8_t)(page | flags);
+    rec[1] = x;
+    rec[2] = n;
+    m->len += REC_HEADER + OledMirror_RleEncode(&gram[x * OLED_MIRROR_STRIDE + page], OLED_MIRROR_STRIDE, n,
+                                                &rec[REC_HEADER]);
+    for (uint32_t i = x; i < (uint32_t)x + n; i++) {
+        m->shadow[i * OLED_MIRROR_STRIDE + page] = gram[i * OLED_MIRROR_STRIDE + page];
+    }
+    m->stats.spans++;
+}
+
+/**
+ * @brief 整屏发送（8 页，带关键帧标志），上位机收齐后与设备同步
+ */
+void OledMirror_Key(OledMirror *m, const uint8_t *gram)
+{
+    m->need_key = 0;
+    m->stats.keyframes++;
+    for (uint8_t page = 0; page < OLED_MIRROR_PAGES; page++) {
+        put_span(m, gram, page, 0, OLED_MIRROR_COLS, OLED_MIRROR_KEY);
+    }
+    flush(m);
+}
+
+/**
+ * @brief 显存的一个区域刷新到屏幕之后调用，发送其中与上位机画面不同的列段
+ * @param x1,x2 列范围（含）
+ * @param page1,page2 页范围（含）
+ */
+void OledMirror_Update(OledMirror *m, const uint8_t *gram, uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2)
+{
+    uint32_t sent = m->stats.spans;
+
+    m->stats.refreshes++;
+    if (m->need_key) {
+        OledMirror_Key(m, gram);
+        return;
+    }
+    if (x2 >= OLED_MIRROR_COLS) {
+        x2 = OLED_MIRROR_COLS - 1;
+    }
+    if (page2 >= OLED_MIRROR_PAGES) {
+        page2 = OLED_MIRROR_PAGES - 1;
+    }
+    if (x1 > x2 || page1 > page2) {
+        return;
+    }
+    m->stats.raw_bytes += (uint32_t)(x2 - x1 + 1) * (page2 - page1 + 1);
+
+    for (uint32_t page = page1; page <= page2; page++) {
+        const uint8_t *g = &gram[page], *s = &m->shadow[page];
+        int32_t start = -1, last = -1;
+
+        for (uint32_t x = x1; x <= x2; x++) {
+            if (g[x * OLED_MIRROR_STRIDE] == s[x * OLED_MIRROR_STRIDE]) {
+                continue;
+            }
+            // 与上一段只隔几列时合并（省一个记录头），否则先发出上一段
+            if (start >= 0 && (int32_t)x - last > OLED_MIRROR_GAP) {
+                put_span(m, gram, (uint8_t)page, (uint8_t)start, (uint8_t)(last - start + 1), 0);
+                start = -1;
+            }
+            if (start < 0) {
+                start = (int32_t)x;
+            }
+            last = (int32_t)x;
+        }
+        if (start >= 0) {
+            put_span(m, gram, (uint8_t)page, (uint8_t)start, (uint8_t)(last - start + 1), 0);
+        }
+    }
+    if (m->stats.spans == sent) {
+        m->stats.unchanged++;
+    }
+    flush(m);
+}
+
+/**
+ * @brief 上位机：把一帧的记录写入显存（布局与设备相同）
+ * @param key_pages 收到关键帧记录的页按位置 1（可为 NULL）
+ * @return 记录数，-1 表示内容不合法（之前的记录已写入）
+ */
+int OledMirror_Apply(uint8_t *gram, const uint8_t *data, uint32_t len, uint8_t *key_pages)
+{
+    uint32_t pos = 0;
+    int records = 0;
+
+    while (pos < len) {
+        uint8_t page, x, n;
+        uint32_t col;
+
+        if (len - pos < REC_HEADER) {
+            return -1;
+        }
+        page = data[pos] & 0x07;
+        x = data[pos + 1];
+        n = data[pos + 2];
+        if ((data[pos] & ~(OLED_MIRROR_KEY | 0x07)) != 0 || n == 0 || (uint32_t)x + n > OLED_MIRROR_COLS) {
+            return -1;
+        }
+        if ((data[pos] & OLED_MIRROR_KEY) && key_pages != NULL) {
+            *key_pages |= (uint8_t)(1u << page);
+        }
+        pos += REC_HEADER;
+        col = x;
+        while (col < (uint32_t)x + n) {
+            uint8_t c;
+            uint32_t cnt;
+
+            if (pos >= len) {
+                return -1;
+            }
+            c = data[pos++];
+            cnt = c < 0x80 ? c + 1u : c - 0x80u + 2;
+            if (col + cnt > (uint32_t)x + n || pos + (c < 0x80 ? cnt : 1) > len) {
+                return -1;
+            }
+            for (uint32_t i = 0; i < cnt; i++, col++) {
+                gram[col * OLED_MIRROR_STRIDE + page] = c < 0x80 ? data[pos + i] : data[pos];
+            }
+            pos += c < 0x80 ? cnt : 1;
+        }
+        records++;
+    }
+    return records;
+}
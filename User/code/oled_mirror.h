@@ -0,0 +1,75 @@
+/**
+ * @file oled_mirror.h
+ * @brief OLED 显存镜像：每次刷新时把变化的显存段 RLE 压缩后发给上位机
+ * @details 设备保留一份上位机已有画面的副本（shadow），刷新某个区域时逐页比较 GRAM 与副本，
+ *          只发送变化的列段（相邻段间隔不足 OLED_MIRROR_GAP 列时合并）。每段一条记录：
+ *
+ *            页号(1，bit7 为关键帧标志) 起始列(1) 列数(1) RLE 数据
+ *
+ *          RLE：控制字节 c < 0x80 时后跟 c+1 个原样字节，c >= 0x80 时下一个字节重复 c-0x80+2 次。
+ *          一段最多 128 列，压缩后不超过 3 + 129 字节，多条记录装进一帧（不超过 OLED_MIRROR_PAYLOAD），
+ *          由发送函数整帧发出（固件为遥测通道，见 ui/screen_mirror.c）。
+ *
+ *          帧被丢弃（串口缓冲区满、超出遥测预算）后上位机的画面不再可信：下一次刷新改为关键帧，
+ *          整屏 8 页全部重发（带关键帧标志），上位机收齐 8 页关键帧记录后恢复同步。
+ *          显存按 oled.c 的顺序存放：列优先，每列 8 字节（第 0~7 页）。
+ *          本模块不依赖 FreeRTOS，上位机（simulator/examples/oled_replay、OLED/simulator 的 oled_remote）
+ *          用同一份 OledMirror_Apply 还原画面。
+ */
+
+#ifndef OLED_MIRROR_H
+#define OLED_MIRROR_H
+
+#include <stdint.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#define OLED_MIRROR_COLS        128
+#define OLED_MIRROR_PAGES       8
+#define OLED_MIRROR_STRIDE      8       ///< GRAM 中相邻两列的距离（字节）
+#define OLED_MIRROR_GRAM_SIZE   (OLED_MIRROR_COLS * OLED_MIRROR_STRIDE)
+#ifndef OLED_MIRROR_PAYLOAD
+#define OLED_MIRROR_PAYLOAD     240     ///< 每帧最多字节数（与 TELEM_MAX_PAYLOAD 相同）
+#endif
+#define OLED_MIRROR_GAP         4       ///< 未变化的列不足这么多时并入同一段（一条记录头 3 字节）
+#define OLED_MIRROR_KEY         0x80    ///< 记录页号字节中的关键帧标志
+#define OLED_MIRROR_ALL_PAGES   0xFF
+
+/**
+ * @brief 整帧发出，返回 0 表示被丢弃
+ */
+typedef uint32_t (*OledMirrorSend)(void *ctx, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief 设备端统计
+ */
+typedef struct {
+    uint32_t refreshes;     ///< OledMirror_Update 调用次数
+    uint32_t unchanged;     ///< 刷新区域内没有变化的次数
+    uint32_t spans;         ///< 发送的记录数
+    uint32_t frames;        ///< 发出的帧数
+    uint32_t bytes;         ///< 发出的记录字节数（不含帧头）
+    uint32_t raw_bytes;     ///< 同样的刷新按整个区域不压缩发送需要的字节数
+    uint32_t dropped;       ///< 被丢弃的帧
+    uint32_t keyframes;     ///< 整屏重发次数
+} OledMirror_Stats;
+
+typedef struct {
+    uint8_t          shadow[OLED_MIRROR_GRAM_SIZE];     ///< 上位机已有的画面
+    uint8_t          buf[OLED_MIRROR_PAYLOAD];
+    uint32_t         len;
+    uint8_t          need_key;
+    OledMirrorSend   send;
+    void            *ctx;
+    OledMirror_Stats stats;
+} OledMirror;
+
+void OledMirror_Init(OledMirror *m, OledMirrorSend send, void *ctx);
+void OledMirror_Update(OledMirror *m, const uint8_t *gram, uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2);
+void OledMirror_Key(OledMirror *m, const uint8_t *gram);
+
+int OledMirror_Apply(uint8_t *gram, const uint8_t *data, uint32_t len, uint8_t *key_pages);
+uint32_t OledMirror_RleEncode(const uint8_t *in, uint32_t stride, uint32_t n, uint8_t *out);
+
+#endif
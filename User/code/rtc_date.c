@@ -1,4 +1,7 @@
 #include "rtc_date.h"
+#include "kv_store.h"
+#include "shell.h"
+#include "ui/persist.h"
 #include <stdio.h>
 
 #define RTC_BKP_DR0_DATA ((uint32_t)0x32F3) // 标记RTC已初始化的标志
@@ -41,20 +44,41 @@ void RTC_Date_Init(void)
         RTC_InitStructure.RTC_SynchPrediv = 255;              // 同步分频，256分频
         RTC_Init(&RTC_InitStructure);
 
-        // 7）设置时间
+        // 7）设置时间：有保存过的时间设置时从 KV 恢复，否则用出厂时间
+        RTC_Settings_TypeDef saved;
+        uint16_t len;
+        if (KV_Get(KV_KEY_RTC_SETTINGS, KV_TYPE_BLOB, &saved, sizeof(saved), &len) != KV_OK ||
+            len != sizeof(saved) || saved.year > 99 || saved.month < 1 || saved.month > 12 ||
+            saved.day < 1 || saved.day > 31 || saved.weekday < 1 || saved.weekday > 7 ||
+            saved.hours > 23 || saved.minutes > 59 || saved.seconds > 59)
+        {
+            saved.year = 25;
+            saved.month = 11;
+            saved.day = 17;
+            saved.weekday = RTC_Weekday_Sunday;
+            saved.hours = 10;
+            saved.minutes = 59;
+            saved.seconds = 30;
+        }
+        else
+        {
+            printf("RTC restored from flash: %04d-%02d-%02d %02d:%02d:%02d\n", saved.year + 2000,
+                   saved.month, saved.day, saved.hours, saved.minutes, saved.seconds);
+        }
+
         RTC_TimeTypeDef RTC_TimeStruct;
         RTC_TimeStruct.RTC_H12 = RTC_H12_PM;          // 下午 24小时制可以不写这个参数
-        RTC_TimeStruct.RTC_Hours = 10;                // 时
-        RTC_TimeStruct.RTC_Minutes = 59;              // 分
-        RTC_TimeStruct.RTC_Seconds = 30;              // 秒
+        RTC_TimeStruct.RTC_Hours = saved.hours;       // 时
+        RTC_TimeStruct.RTC_Minutes = saved.minutes;   // 分
+        RTC_TimeStruct.RTC_Seconds = saved.seconds;   // 秒
         RTC_SetTime(RTC_Format_BIN, &RTC_TimeStruct); // RTC_Format_BIN表示二进制格式
 
         // 8）设置日期
         RTC_DateTypeDef RTC_DateStruct;
-        RTC_DateStruct.RTC_Year = 25;                    // 年
-        RTC_DateStruct.RTC_Month = 11;                   // 月
-        RTC_DateStruct.RTC_Date = 17;                    // 日
-        RTC_DateStruct.RTC_WeekDay = RTC_Weekday_Sunday; // 星期
+        RTC_DateStruct.RTC_Year = saved.year;            // 年
+        RTC_DateStruct.RTC_Month = saved.month;          // 月
+        RTC_DateStruct.RTC_Date = saved.day;             // 日
+        RTC_DateStruct.RTC_WeekDay = saved.weekday;      // 星期
         RTC_SetDate(RTC_Format_BIN, &RTC_DateStruct);    // RTC_Format_BIN表示二进制格式
 
         // 9）标记RTC已初始化
@@ -158,3 +182,75 @@ void RTC_SetDateTime_Manual(uint8_t year, uint8_t month, uint8_t day, uint8_t we
     
     printf("RTC DateTime set complete!\n");
 }
+
+/**
+ * @brief 把当前日期时间写入 KV
+ * @details 手动设置时间/日期后由 persist.c 在存储任务中调用。RTC 本身由备份域供电，
+ *          这份记录只在备份域掉电（RTC_BKP_DR0 标志丢失）后由 RTC_Date_Init 用来恢复
+ * @return KV_OK-成功，其他-失败
+ */
+int RTC_Settings_Save(void)
+{
+    RTC_Settings_TypeDef rec;
+    RTC_TimeTypeDef time;
+    RTC_DateTypeDef date;
+
+    RTC_GetTime(RTC_Format_BIN, &time);
+    RTC_GetDate(RTC_Format_BIN, &date);
+    rec.year = date.RTC_Year;
+    rec.month = date.RTC_Month;
+    rec.day = date.RTC_Date;
+    rec.weekday = date.RTC_WeekDay;
+    rec.hours = time.RTC_Hours;
+    rec.minutes = time.RTC_Minutes;
+    rec.seconds = time.RTC_Seconds;
+    return KV_Set(KV_KEY_RTC_SETTINGS, KV_TYPE_BLOB, &rec, sizeof(rec));
+}
+
+// =============================================================================
+// 串口命令
+// =============================================================================
+
+static int cmd_rtc(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    (void)argv;
+    RTC_Date_Get();
+    printf("%04d-%02d-%02d %02d:%02d:%02d weekday %d\r\n", g_RTC_Date.RTC_Year + 2000, g_RTC_Date.RTC_Month,
+           g_RTC_Date.RTC_Date, g_RTC_Time.RTC_Hours, g_RTC_Time.RTC_Minutes, g_RTC_Time.RTC_Seconds,
+           g_RTC_Date.RTC_WeekDay);
+    return SHELL_OK;
+}
+
+// 修改后与菜单设置一样标记脏，由 persist.c 合并保存
+static int cmd_rtc_set(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    RTC_SetTime_Manual(SHELL_TIME_H(argv[0].u), SHELL_TIME_M(argv[0].u), SHELL_TIME_S(argv[0].u));
+    Persist_MarkDirty(PERSIST_OBJ_RTC);
+    return SHELL_OK;
+}
+
+// date_set <year 2000-2099> <month> <day> <weekday 1-7>
+static int cmd_date_set(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    if (argv[0].u < 2000 || argv[0].u > 2099 || argv[1].u < 1 || argv[1].u > 12 ||
+        argv[2].u < 1 || argv[2].u > 31 || argv[3].u < 1 || argv[3].u > 7) {
+        return SHELL_ERR_USAGE;
+    }
+    RTC_SetDate_Manual((uint8_t)(argv[0].u - 2000), (uint8_t)argv[1].u, (uint8_t)argv[2].u, (uint8_t)argv[3].u);
+    Persist_MarkDirty(PERSIST_OBJ_RTC);
+    return SHELL_OK;
+}
+
+static const Shell_Cmd rtc_cmds[] = {
+    { "rtc",      "",     cmd_rtc,      "show date and time" },
+    { "rtc_set",  "t",    cmd_rtc_set,  "rtc_set hh:mm[:ss]" },
+    { "date_set", "uuuu", cmd_date_set, "date_set <yyyy> <mm> <dd> <weekday 1-7>" },
+};
+
+void RTC_RegisterCommands(void)
+{
+    Shell_Register(rtc_cmds, sizeof(rtc_cmds) / sizeof(rtc_cmds[0]));
+}
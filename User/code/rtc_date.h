@@ -12,6 +12,18 @@ typedef struct
   
 }RTC_Data_TypeDef;
 
+// KV 中保存的日期时间（备份域掉电后用于恢复，代替固定的出厂时间）
+typedef struct
+{
+  u8 year;
+  u8 month;
+  u8 day;
+  u8 weekday;
+  u8 hours;
+  u8 minutes;
+  u8 seconds;
+}RTC_Settings_TypeDef;
+
 // 全局RTC时间结构体
 extern RTC_TimeTypeDef g_RTC_Time;
 extern RTC_DateTypeDef g_RTC_Date;
@@ -25,4 +37,10 @@ void RTC_SetDate_Manual(uint8_t year, uint8_t month, uint8_t day, uint8_t weekda
 void RTC_SetDateTime_Manual(uint8_t year, uint8_t month, uint8_t day, uint8_t weekday,
                            uint8_t hours, uint8_t minutes, uint8_t seconds);
 
+// 时间设置持久化（经 persist.c 在存储任务中调用）
+int RTC_Settings_Save(void);
+
+// 串口命令 rtc/rtc_set/date_set
+void RTC_RegisterCommands(void);
+
 #endif
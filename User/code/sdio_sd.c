@@ -0,0 +1,712 @@
+/**
+ * @file sdio_sd.c
+ * @brief SD 卡驱动实现：命令协议（与硬件无关）+ SDIO/DMA 硬件接口（仅固件）
+ */
+
+#include "sdio_sd.h"
+#include <string.h>
+
+// 命令索引（ACMD 前须先发 CMD55）
+#define CMD0_GO_IDLE_STATE          0
+#define CMD2_ALL_SEND_CID           2
+#define CMD3_SEND_RELATIVE_ADDR     3
+#define ACMD6_SET_BUS_WIDTH         6
+#define CMD7_SELECT_CARD            7
+#define CMD8_SEND_IF_COND           8
+#define CMD9_SEND_CSD               9
+#define CMD12_STOP_TRANSMISSION     12
+#define CMD13_SEND_STATUS           13
+#define CMD16_SET_BLOCKLEN          16
+#define CMD17_READ_SINGLE_BLOCK     17
+#define CMD18_READ_MULTIPLE_BLOCK   18
+#define ACMD23_SET_WR_BLK_ERASE     23
+#define CMD24_WRITE_BLOCK           24
+#define CMD25_WRITE_MULTIPLE_BLOCK  25
+#define ACMD41_SD_SEND_OP_COND      41
+#define CMD55_APP_CMD               55
+
+// 卡状态（R1）
+#define SD_R1_ERRORS            0xFDFFE008UL
+#define SD_R1_OUT_OF_RANGE      (1UL << 31)
+#define SD_R1_READY_FOR_DATA    (1UL << 8)
+#define SD_R1_STATE(r)          (((r) >> 9) & 0x0F)
+#define SD_STATE_TRAN           4
+#define SD_STATE_DATA           5
+#define SD_STATE_RCV            6
+#define SD_R6_ERRORS            0xE000UL    // R6 低 16 位中的 bit23/22/19
+
+// OCR（R3）与 CMD8 参数
+#define SD_OCR_POWER_UP         (1UL << 31)
+#define SD_OCR_CCS              (1UL << 30) // 响应中：SDHC/SDXC；请求中为 HCS
+#define SD_OCR_VOLTAGE          0x00FF8000UL    // 2.7~3.6V
+#define SD_CMD8_PATTERN         0x1AAUL         // 2.7~3.6V + 检查模式 0xAA
+
+#define SD_MAX_BLOCKS           0xFFFF  // SDIO_DLEN 25 位
+#define SD_BUSY_SPIN            8       // 写后先连续查询的 CMD13 次数，之后每次等待 1ms
+
+static SD_CardInfo sd_info;
+static SD_Stats sd_stats;
+static uint8_t sd_ready;
+static uint8_t sd_busy;     // 上一条写命令之后卡可能仍在内部编程
+static uint8_t sd_bounce[SD_BLOCK_SIZE] __attribute__((aligned(4)));
+
+static int sd_cmd(uint8_t cmd, uint32_t arg, uint8_t resp, uint32_t r[4])
+{
+    sd_stats.commands++;
+    return SD_HW_Command(cmd, arg, resp, r);
+}
+
+/**
+ * @brief 发送 R1/R1b 命令并检查卡状态中的错误位
+ */
+static int sd_cmd_r1(uint8_t cmd, uint32_t arg, uint32_t ignore, uint32_t *status)
+{
+    uint32_t r[4];
+    int rc = sd_cmd(cmd, arg, SD_HW_RESP_SHORT, r);
+
+    if (rc != SD_OK) {
+        return rc;
+    }
+    if (status != NULL) {
+        *status = r[0];
+    }
+    return (r[0] & SD_R1_ERRORS & ~ignore) ? SD_ERR_CARD : SD_OK;
+}
+
+static int sd_app_cmd_r1(uint8_t acmd, uint32_t arg)
+{
+    int rc = sd_cmd_r1(CMD55_APP_CMD, (uint32_t)sd_info.rca << 16, 0, NULL);
+
+    return rc == SD_OK ? sd_cmd_r1(acmd, arg, 0, NULL) : rc;
+}
+
+/**
+ * @brief 取 CID/CSD 中的位段 [msb:lsb]（csd[0] 为 bit127~96）
+ */
+static uint32_t sd_bits(const uint32_t *reg, uint8_t msb, uint8_t lsb)
+{
+    uint32_t v = 0;
+
+    for (int b = msb; b >= lsb; b--) {
+        v = (v << 1) | ((reg[3 - b / 32] >> (b % 32)) & 1);
+    }
+    return v;
+}
+
+static void sd_parse_csd(void)
+{
+    const uint32_t *csd = sd_info.csd;
+
+    if (sd_bits(csd, 127, 126) == 1) {
+        // CSD 2.0：容量 = (C_SIZE + 1) * 512KB
+        uint64_t n = ((uint64_t)sd_bits(csd, 69, 48) + 1) * 1024;
+        sd_info.sector_count = n > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)n;
+    } else {
+        // CSD 1.0：容量 = (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) * 2^READ_BL_LEN
+        uint32_t shift = sd_bits(csd, 49, 47) + 2 + sd_bits(csd, 83, 80);
+        sd_info.sector_count = (sd_bits(csd, 73, 62) + 1) << (shift - 9);
+    }
+
+    // 擦除单元：SECTOR_SIZE + 1 个写块（ERASE_BLK_EN = 1 时卡也支持按扇区擦除）
+    sd_info.erase_sectors = (sd_bits(csd, 45, 39) + 1) << (sd_bits(csd, 25, 22) - 9);
+}
+
+static int sd_init(void)
+{
+    uint32_t r[4];
+    uint32_t arg;
+    uint8_t v2;
+    int rc;
+
+    SD_HW_Init();
+    sd_info.clock_hz = SD_INIT_CLOCK_HZ;
+    sd_info.bus_width = 1;
+
+    sd_cmd(CMD0_GO_IDLE_STATE, 0, SD_HW_RESP_NONE, r);
+
+    // CMD8 只有 2.0 以上的卡响应，回显电压范围和检查模式
+    rc = sd_cmd(CMD8_SEND_IF_COND, SD_CMD8_PATTERN, SD_HW_RESP_SHORT, r);
+    if (rc == SD_OK) {
+        if ((r[0] & 0xFFF) != SD_CMD8_PATTERN) {
+            return SD_ERR_UNSUPPORTED;
+        }
+        v2 = 1;
+    } else if (rc == SD_ERR_TIMEOUT) {
+        v2 = 0;
+    } else {
+        return rc;
+    }
+
+    // ACMD41 轮询到上电完成；1.x 卡上一条 CMD8 是非法命令，这里的 CMD55 只看是否有响应
+    arg = SD_OCR_VOLTAGE | (v2 ? SD_OCR_CCS : 0);
+    for (uint32_t waited = 0; ; waited++) {
+        rc = sd_cmd(CMD55_APP_CMD, 0, SD_HW_RESP_SHORT, r);
+        if (rc == SD_OK) {
+            rc = sd_cmd(ACMD41_SD_SEND_OP_COND, arg, SD_HW_RESP_SHORT_NOCRC, r);
+        }
+        if (rc != SD_OK) {
+            return rc == SD_ERR_TIMEOUT ? SD_ERR_NO_CARD : rc;     // 无卡或 MMC 卡
+        }
+        if (r[0] & SD_OCR_POWER_UP) {
+            break;
+        }
+        if (waited >= SD_INIT_TIMEOUT_MS) {
+            return SD_ERR_TIMEOUT;
+        }
+        SD_HW_Delay(1);
+    }
+    if ((r[0] & SD_OCR_VOLTAGE) == 0) {
+        return SD_ERR_UNSUPPORTED;
+    }
+    sd_info.type = (r[0] & SD_OCR_CCS) ? SD_CARD_SDHC : v2 ? SD_CARD_SDSC_V2 : SD_CARD_SDSC_V1;
+
+    rc = sd_cmd(CMD2_ALL_SEND_CID, 0, SD_HW_RESP_LONG, sd_info.cid);
+    if (rc != SD_OK) {
+        return rc;
+    }
+    rc = sd_cmd(CMD3_SEND_RELATIVE_ADDR, 0, SD_HW_RESP_SHORT, r);
+    if (rc != SD_OK) {
+        return rc;
+    }
+    if (r[0] & SD_R6_ERRORS) {
+        return SD_ERR_CARD;
+    }
+    sd_info.rca = (uint16_t)(r[0] >> 16);
+
+    rc = sd_cmd(CMD9_SEND_CSD, (uint32_t)sd_info.rca << 16, SD_HW_RESP_LONG, sd_info.csd);
+    if (rc != SD_OK) {
+        return rc;
+    }
+    sd_parse_csd();
+
+    // 选中后进入传输状态，之后才能提高时钟
+    rc = sd_cmd_r1(CMD7_SELECT_CARD, (uint32_t)sd_info.rca << 16, 0, NULL);
+    if (rc != SD_OK) {
+        return rc;
+    }
+    SD_HW_SetBus(SD_XFER_CLOCK_HZ, 1);
+    sd_info.clock_hz = SD_XFER_CLOCK_HZ;
+
+    // 卡先切换到 4 位，主机再切换
+    rc = sd_app_cmd_r1(ACMD6_SET_BUS_WIDTH, 2);
+    if (rc != SD_OK) {
+        return rc;
+    }
+    SD_HW_SetBus(SD_XFER_CLOCK_HZ, 4);
+    sd_info.bus_width = 4;
+
+    // SDHC 块长固定 512；SDSC 显式设置
+    if (sd_info.type != SD_CARD_SDHC) {
+        rc = sd_cmd_r1(CMD16_SET_BLOCKLEN, SD_BLOCK_SIZE, 0, NULL);
+    }
+    return rc;
+}
+
+/**
+ * @brief 初始化 SD 卡（无卡时快速返回 SD_ERR_NO_CARD）
+ */
+int SD_Init(void)
+{
+    int rc;
+
+    sd_ready = 0;
+    sd_busy = 0;
+    memset(&sd_info, 0, sizeof(sd_info));
+
+    rc = sd_init();
+    if (rc != SD_OK) {
+        sd_info.type = SD_CARD_NONE;
+        return rc;
+    }
+    sd_ready = 1;
+    return SD_OK;
+}
+
+uint8_t SD_IsReady(void)
+{
+    return sd_ready;
+}
+
+/**
+ * @brief 等待上一次写入的内部编程完成（CMD13 直到 READY_FOR_DATA 且处于传输状态）
+ */
+static int sd_wait_ready(void)
+{
+    uint32_t status;
+    uint32_t waited = 0;
+    int rc;
+
+    for (uint32_t polls = 0; sd_busy; polls++) {
+        sd_stats.busy_polls++;
+        rc = sd_cmd_r1(CMD13_SEND_STATUS, (uint32_t)sd_info.rca << 16, 0, &status);
+        if (rc != SD_OK) {
+            return rc;      // 写保护等错误在这里报告
+        }
+        if ((status & SD_R1_READY_FOR_DATA) && SD_R1_STATE(status) == SD_STATE_TRAN) {
+            sd_busy = 0;
+            break;
+        }
+        if (polls >= SD_BUSY_SPIN) {
+            if (waited++ >= SD_WRITE_TIMEOUT_MS) {
+                return SD_ERR_TIMEOUT;
+            }
+            SD_HW_Delay(1);
+        }
+    }
+    return SD_OK;
+}
+
+/**
+ * @brief 单块传输出错后，卡仍在发送或接收数据时用 CMD12 让它回到传输状态
+ */
+static void sd_recover(void)
+{
+    uint32_t status;
+
+    if (sd_cmd_r1(CMD13_SEND_STATUS, (uint32_t)sd_info.rca << 16, 0xFFFFFFFFUL, &status) == SD_OK &&
+        (SD_R1_STATE(status) == SD_STATE_DATA || SD_R1_STATE(status) == SD_STATE_RCV)) {
+        sd_cmd_r1(CMD12_STOP_TRANSMISSION, 0, 0xFFFFFFFFUL, NULL);
+    }
+}
+
+static uint32_t sd_addr(uint32_t sector)
+{
+    return sd_info.type == SD_CARD_SDHC ? sector : sector * SD_BLOCK_SIZE;
+}
+
+static int sd_read(uint8_t *buf, uint32_t sector, uint32_t count)
+{
+    uint8_t multi = count > 1;
+    int rc, stop;
+
+    rc = sd_wait_ready();
+    if (rc != SD_OK) {
+        return rc;
+    }
+
+    // 读：先使能数据通道，卡在命令响应后立即开始发送数据
+    rc = SD_HW_DataStart(buf, count, SD_HW_READ);
+    if (rc != SD_OK) {
+        return rc;
+    }
+    sd_stats.read_cmds++;
+    sd_stats.multi_cmds += multi;
+    rc = sd_cmd_r1(multi ? CMD18_READ_MULTIPLE_BLOCK : CMD17_READ_SINGLE_BLOCK, sd_addr(sector), 0, NULL);
+    if (rc != SD_OK) {
+        SD_HW_DataAbort();
+        return rc;
+    }
+    rc = SD_HW_DataWait();
+
+    // 读到最后一个扇区时卡在 CMD12 的响应中报告 OUT_OF_RANGE，不算错误
+    if (multi) {
+        stop = sd_cmd_r1(CMD12_STOP_TRANSMISSION, 0, SD_R1_OUT_OF_RANGE, NULL);
+        if (rc == SD_OK) {
+            rc = stop;
+        }
+    } else if (rc != SD_OK) {
+        sd_recover();
+    }
+    return rc;
+}
+
+static int sd_write(const uint8_t *buf, uint32_t sector, uint32_t count)
+{
+    uint8_t multi = count > 1;
+    int rc, stop;
+
+    rc = sd_wait_ready();
+    if (rc != SD_OK) {
+        return rc;
+    }
+
+    // 预先告诉卡要写的块数，卡可以提前擦除
+    if (multi) {
+        rc = sd_app_cmd_r1(ACMD23_SET_WR_BLK_ERASE, count);
+        if (rc != SD_OK) {
+            return rc;
+        }
+    }
+
+    // 写：命令响应之后才使能数据通道
+    sd_stats.write_cmds++;
+    sd_stats.multi_cmds += multi;
+    rc = sd_cmd_r1(multi ? CMD25_WRITE_MULTIPLE_BLOCK : CMD24_WRITE_BLOCK, sd_addr(sector), 0, NULL);
+    if (rc != SD_OK) {
+        return rc;
+    }
+    rc = SD_HW_DataStart((void *)buf, count, SD_HW_WRITE);
+    if (rc == SD_OK) {
+        rc = SD_HW_DataWait();
+    } else {
+        SD_HW_DataAbort();
+    }
+
+    // CMD12 之后卡进入编程状态，下一条读写命令前再等待
+    if (multi) {
+        stop = sd_cmd_r1(CMD12_STOP_TRANSMISSION, 0, 0, NULL);
+        if (rc == SD_OK) {
+            rc = stop;
+        }
+    } else if (rc != SD_OK) {
+        sd_recover();
+    }
+    sd_busy = 1;
+    return rc;
+}
+
+/**
+ * @brief 一次传输，CRC/数据通道错误或超时时重试一次
+ */
+static int sd_xfer(uint8_t *buf, uint32_t sector, uint32_t count, uint8_t dir)
+{
+    int rc = dir == SD_HW_READ ? sd_read(buf, sector, count) : sd_write(buf, sector, count);
+
+    if (rc == SD_ERR_CRC || rc == SD_ERR_DATA || rc == SD_ERR_TIMEOUT) {
+        sd_stats.retries++;
+        rc = dir == SD_HW_READ ? sd_read(buf, sector, count) : sd_write(buf, sector, count);
+    }
+    if (rc != SD_OK) {
+        sd_stats.errors++;
+    } else if (dir == SD_HW_READ) {
+        sd_stats.blocks_read += count;
+    } else {
+        sd_stats.blocks_written += count;
+    }
+    return rc;
+}
+
+static int sd_transfer(uint8_t *buf, uint32_t sector, uint32_t count, uint8_t dir)
+{
+    int rc = SD_OK;
+
+    if (!sd_ready) {
+        return SD_ERR_NOT_READY;
+    }
+    if (buf == NULL || count == 0 || sector >= sd_info.sector_count || count > sd_info.sector_count - sector) {
+        return SD_ERR_PARAM;
+    }
+
+    // DMA 不能访问的缓冲区（CCM RAM）逐扇区中转
+    if (!SD_HW_DmaCapable(buf)) {
+        for (uint32_t n = 0; n < count && rc == SD_OK; n++, buf += SD_BLOCK_SIZE) {
+            if (dir == SD_HW_WRITE) {
+                memcpy(sd_bounce, buf, SD_BLOCK_SIZE);
+            }
+            rc = sd_xfer(sd_bounce, sector + n, 1, dir);
+            if (rc == SD_OK && dir == SD_HW_READ) {
+                memcpy(buf, sd_bounce, SD_BLOCK_SIZE);
+            }
+            sd_stats.bounce_blocks++;
+        }
+        return rc;
+    }
+
+    while (count > 0 && rc == SD_OK) {
+        uint32_t n = count > SD_MAX_BLOCKS ? SD_MAX_BLOCKS : count;
+
+        rc = sd_xfer(buf, sector, n, dir);
+        buf += n * SD_BLOCK_SIZE;
+        sector += n;
+        count -= n;
+    }
+    return rc;
+}
+
+/**
+ * @brief 读扇区（count > 1 时用 CMD18 一次传输）
+ */
+int SD_ReadBlocks(uint8_t *buf, uint32_t sector, uint32_t count)
+{
+    return sd_transfer(buf, sector, count, SD_HW_READ);
+}
+
+/**
+ * @brief 写扇区（count > 1 时用 ACMD23 + CMD25 一次传输），返回时卡可能仍在编程
+ */
+int SD_WriteBlocks(const uint8_t *buf, uint32_t sector, uint32_t count)
+{
+    return sd_transfer((uint8_t *)buf, sector, count, SD_HW_WRITE);
+}
+
+/**
+ * @brief 等待已写入的数据在卡内编程完成（FatFs CTRL_SYNC）
+ */
+int SD_Sync(void)
+{
+    return sd_ready ? sd_wait_ready() : SD_ERR_NOT_READY;
+}
+
+void SD_GetCardInfo(SD_CardInfo *info)
+{
+    if (info != NULL) {
+        *info = sd_info;
+    }
+}
+
+void SD_GetStats(SD_Stats *stats)
+{
+    if (stats != NULL) {
+        *stats = sd_stats;
+    }
+}
+
+void SD_ResetStats(void)
+{
+    memset(&sd_stats, 0, sizeof(sd_stats));
+}
+
+// =============================================================================
+// SDIO 外设（主机模拟器中由 sd_card_sim.c 提供）
+// =============================================================================
+
+#if !defined(FLASH_SIMULATOR)
+
+#include "stm32f4xx.h"
+#include "delay.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define SDIO_CLK_HZ         48000000UL
+#define SDIO_STATIC_FLAGS   0x000005FFUL    // SDIO_ICR 中可清除的静态标志
+#define SDIO_DATA_FLAGS     (SDIO_FLAG_DATAEND | SDIO_FLAG_DCRCFAIL | SDIO_FLAG_DTIMEOUT | \
+                             SDIO_FLAG_RXOVERR | SDIO_FLAG_TXUNDERR | SDIO_FLAG_STBITERR)
+#define SDIO_POLL_LIMIT     0x01000000UL    // 软件超时，只在硬件超时失效时起作用
+
+#define SD_DMA_STREAM       DMA2_Stream6
+#define SD_DMA_CHANNEL      DMA_Channel_4
+#define SD_DMA_FLAGS        (DMA_FLAG_TCIF6 | DMA_FLAG_HTIF6 | DMA_FLAG_TEIF6 | DMA_FLAG_DMEIF6 | DMA_FLAG_FEIF6)
+
+static uint32_t sdio_clock_hz = SD_INIT_CLOCK_HZ;
+static uint8_t sdio_dir;
+
+/**
+ * @brief 引脚、时钟和 SDIO 上电，1 位总线 400kHz
+ */
+void SD_HW_Init(void)
+{
+    GPIO_InitTypeDef gpio;
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOC | RCC_AHB1Periph_GPIOD | RCC_AHB1Periph_DMA2, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_SDIO, ENABLE);
+    RCC_APB2PeriphResetCmd(RCC_APB2Periph_SDIO, ENABLE);
+    RCC_APB2PeriphResetCmd(RCC_APB2Periph_SDIO, DISABLE);
+
+    GPIO_PinAFConfig(GPIOC, GPIO_PinSource8, GPIO_AF_SDIO);
+    GPIO_PinAFConfig(GPIOC, GPIO_PinSource9, GPIO_AF_SDIO);
+    GPIO_PinAFConfig(GPIOC, GPIO_PinSource10, GPIO_AF_SDIO);
+    GPIO_PinAFConfig(GPIOC, GPIO_PinSource11, GPIO_AF_SDIO);
+    GPIO_PinAFConfig(GPIOC, GPIO_PinSource12, GPIO_AF_SDIO);
+    GPIO_PinAFConfig(GPIOD, GPIO_PinSource2, GPIO_AF_SDIO);
+
+    gpio.GPIO_Mode = GPIO_Mode_AF;
+    gpio.GPIO_OType = GPIO_OType_PP;
+    gpio.GPIO_Speed = GPIO_Speed_50MHz;
+    gpio.GPIO_PuPd = GPIO_PuPd_UP;
+    gpio.GPIO_Pin = GPIO_Pin_8 | GPIO_Pin_9 | GPIO_Pin_10 | GPIO_Pin_11;
+    GPIO_Init(GPIOC, &gpio);
+    gpio.GPIO_Pin = GPIO_Pin_2;
+    GPIO_Init(GPIOD, &gpio);
+    gpio.GPIO_PuPd = GPIO_PuPd_NOPULL;
+    gpio.GPIO_Pin = GPIO_Pin_12;
+    GPIO_Init(GPIOC, &gpio);
+
+    SDIO_SetPowerState(SDIO_PowerState_OFF);
+    SD_HW_SetBus(SD_INIT_CLOCK_HZ, 1);
+    SDIO_SetPowerState(SDIO_PowerState_ON);
+    SDIO_ClockCmd(ENABLE);
+    SD_HW_Delay(2);     // 上电后至少 74 个时钟再发 CMD0
+}
+
+/**
+ * @brief 设置总线时钟与位宽：SDIO_CK = 48MHz / (CLKDIV + 2)，24MHz 时 CLKDIV = 0
+ * @details 不开硬件流控（F40x 勘误：HW flow control 会使 SDIO_CK 产生毛刺），
+ *          由 DMA 最高优先级保证 FIFO 不溢出。
+ */
+void SD_HW_SetBus(uint32_t clock_hz, uint8_t width)
+{
+    SDIO_InitTypeDef sdio;
+    uint32_t div = (SDIO_CLK_HZ + clock_hz - 1) / clock_hz;
+
+    div = div < 2 ? 0 : div - 2;
+    SDIO_StructInit(&sdio);
+    sdio.SDIO_ClockDiv = (uint8_t)div;
+    sdio.SDIO_ClockEdge = SDIO_ClockEdge_Rising;
+    sdio.SDIO_ClockBypass = SDIO_ClockBypass_Disable;
+    sdio.SDIO_ClockPowerSave = SDIO_ClockPowerSave_Disable;
+    sdio.SDIO_BusWide = width == 4 ? SDIO_BusWide_4b : SDIO_BusWide_1b;
+    sdio.SDIO_HardwareFlowControl = SDIO_HardwareFlowControl_Disable;
+    SDIO_Init(&sdio);
+    sdio_clock_hz = SDIO_CLK_HZ / (div + 2);
+}
+
+int SD_HW_Command(uint8_t cmd, uint32_t arg, uint8_t resp, uint32_t resp_out[4])
+{
+    SDIO_CmdInitTypeDef c;
+    uint32_t done = resp == SD_HW_RESP_NONE ? SDIO_FLAG_CMDSENT
+                                           : (SDIO_FLAG_CMDREND | SDIO_FLAG_CCRCFAIL | SDIO_FLAG_CTIMEOUT);
+    uint32_t timeout = SDIO_POLL_LIMIT;
+    uint32_t sta;
+
+    SDIO_ClearFlag(SDIO_FLAG_CMDSENT | SDIO_FLAG_CMDREND | SDIO_FLAG_CCRCFAIL | SDIO_FLAG_CTIMEOUT);
+    c.SDIO_Argument = arg;
+    c.SDIO_CmdIndex = cmd;
+    c.SDIO_Response = resp == SD_HW_RESP_NONE ? SDIO_Response_No
+                    : resp == SD_HW_RESP_LONG ? SDIO_Response_Long : SDIO_Response_Short;
+    c.SDIO_Wait = SDIO_Wait_No;
+    c.SDIO_CPSM = SDIO_CPSM_Enable;
+    SDIO_SendCommand(&c);
+
+    // 无响应时 64 个时钟后 CTIMEOUT，由硬件保证结束
+    while (((sta = SDIO->STA) & done) == 0) {
+        if (--timeout == 0) {
+            return SD_ERR_TIMEOUT;
+        }
+    }
+    SDIO_ClearFlag(SDIO_FLAG_CMDSENT | SDIO_FLAG_CMDREND | SDIO_FLAG_CCRCFAIL | SDIO_FLAG_CTIMEOUT);
+
+    if (resp == SD_HW_RESP_NONE) {
+        return SD_OK;
+    }
+    if (sta & SDIO_FLAG_CTIMEOUT) {
+        return SD_ERR_TIMEOUT;
+    }
+    if (resp == SD_HW_RESP_SHORT_NOCRC) {
+        // R3 的 CRC 与命令索引位固定为 1，CCRCFAIL 是正常的
+        resp_out[0] = SDIO_GetResponse(SDIO_RESP1);
+        return SD_OK;
+    }
+    if (sta & SDIO_FLAG_CCRCFAIL) {
+        return SD_ERR_CRC;
+    }
+    if (resp == SD_HW_RESP_SHORT && SDIO_GetCommandResponse() != cmd) {
+        return SD_ERR_CRC;
+    }
+    resp_out[0] = SDIO_GetResponse(SDIO_RESP1);
+    if (resp == SD_HW_RESP_LONG) {
+        resp_out[1] = SDIO_GetResponse(SDIO_RESP2);
+        resp_out[2] = SDIO_GetResponse(SDIO_RESP3);
+        resp_out[3] = SDIO_GetResponse(SDIO_RESP4);
+    }
+    return SD_OK;
+}
+
+/**
+ * @brief 配置 DMA2 Stream6 与数据通道（由 SDIO 控制传输长度）
+ * @details 非 4 字节对齐的缓冲区用字节宽度访问内存，由 DMA FIFO 打包成字。
+ */
+int SD_HW_DataStart(void *buf, uint32_t blocks, uint8_t dir)
+{
+    DMA_InitTypeDef dma;
+    SDIO_DataInitTypeDef data;
+    uint32_t timeout_ms = dir == SD_HW_READ ? SD_READ_TIMEOUT_MS : SD_WRITE_TIMEOUT_MS;
+
+    SDIO->DCTRL = 0;
+    SDIO_ClearFlag(SDIO_STATIC_FLAGS);
+
+    DMA_Cmd(SD_DMA_STREAM, DISABLE);
+    while (DMA_GetCmdStatus(SD_DMA_STREAM) != DISABLE) {
+    }
+    DMA_ClearFlag(SD_DMA_STREAM, SD_DMA_FLAGS);
+
+    DMA_StructInit(&dma);
+    dma.DMA_Channel = SD_DMA_CHANNEL;
+    dma.DMA_PeripheralBaseAddr = (uint32_t)&SDIO->FIFO;
+    dma.DMA_Memory0BaseAddr = (uint32_t)buf;
+    dma.DMA_DIR = dir == SD_HW_READ ? DMA_DIR_PeripheralToMemory : DMA_DIR_MemoryToPeripheral;
+    dma.DMA_BufferSize = 1;     // 外设流控时忽略
+    dma.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    dma.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    dma.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    dma.DMA_MemoryDataSize = ((uint32_t)buf & 3) ? DMA_MemoryDataSize_Byte : DMA_MemoryDataSize_Word;
+    dma.DMA_Mode = DMA_Mode_Normal;
+    dma.DMA_Priority = DMA_Priority_VeryHigh;
+    dma.DMA_FIFOMode = DMA_FIFOMode_Enable;
+    dma.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+    dma.DMA_MemoryBurst = DMA_MemoryBurst_INC4;
+    dma.DMA_PeripheralBurst = DMA_PeripheralBurst_INC4;
+    DMA_Init(SD_DMA_STREAM, &dma);
+    DMA_FlowControllerConfig(SD_DMA_STREAM, DMA_FlowCtrl_Peripheral);
+    DMA_Cmd(SD_DMA_STREAM, ENABLE);
+    SDIO_DMACmd(ENABLE);
+
+    data.SDIO_DataTimeOut = timeout_ms * (sdio_clock_hz / 1000);
+    data.SDIO_DataLength = blocks * SD_BLOCK_SIZE;
+    data.SDIO_DataBlockSize = SDIO_DataBlockSize_512b;
+    data.SDIO_TransferDir = dir == SD_HW_READ ? SDIO_TransferDir_ToSDIO : SDIO_TransferDir_ToCard;
+    data.SDIO_TransferMode = SDIO_TransferMode_Block;
+    data.SDIO_DPSM = SDIO_DPSM_Enable;
+    SDIO_DataConfig(&data);
+    sdio_dir = dir;
+    return SD_OK;
+}
+
+/**
+ * @brief 等待数据块全部传完（轮询，24MHz 4 位总线 512 字节约 45us）
+ */
+int SD_HW_DataWait(void)
+{
+    uint32_t timeout = SDIO_POLL_LIMIT;
+    uint32_t sta;
+    int rc = SD_OK;
+
+    while (((sta = SDIO->STA) & SDIO_DATA_FLAGS) == 0) {
+        if (--timeout == 0) {
+            sta = SDIO_FLAG_DTIMEOUT;
+            break;
+        }
+    }
+    if (sta & SDIO_FLAG_DCRCFAIL) {
+        rc = SD_ERR_CRC;
+    } else if (sta & SDIO_FLAG_DTIMEOUT) {
+        rc = SD_ERR_TIMEOUT;
+    } else if (sta & (SDIO_FLAG_RXOVERR | SDIO_FLAG_TXUNDERR | SDIO_FLAG_STBITERR)) {
+        rc = SD_ERR_DATA;
+    } else if (sdio_dir == SD_HW_READ) {
+        // DATAEND 之后 DMA FIFO 中可能还有数据，等数据流自行结束
+        timeout = SDIO_POLL_LIMIT;
+        while (DMA_GetCmdStatus(SD_DMA_STREAM) != DISABLE) {
+            if (--timeout == 0) {
+                rc = SD_ERR_DATA;
+                break;
+            }
+        }
+    }
+
+    if (rc != SD_OK) {
+        SD_HW_DataAbort();
+    }
+    SDIO_DMACmd(DISABLE);
+    SDIO_ClearFlag(SDIO_STATIC_FLAGS);
+    return rc;
+}
+
+void SD_HW_DataAbort(void)
+{
+    SDIO->DCTRL = 0;
+    SDIO_DMACmd(DISABLE);
+    DMA_Cmd(SD_DMA_STREAM, DISABLE);
+    while (DMA_GetCmdStatus(SD_DMA_STREAM) != DISABLE) {
+    }
+    DMA_ClearFlag(SD_DMA_STREAM, SD_DMA_FLAGS);
+    SDIO_ClearFlag(SDIO_STATIC_FLAGS);
+}
+
+/**
+ * @brief DMA2 不能访问 CCM RAM（0x10000000 起 64KB）
+ */
+uint8_t SD_HW_DmaCapable(const void *buf)
+{
+    return ((uint32_t)buf & 0xFFFF0000UL) != 0x10000000UL;
+}
+
+void SD_HW_Delay(uint32_t ms)
+{
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        vTaskDelay(pdMS_TO_TICKS(ms) ? pdMS_TO_TICKS(ms) : 1);
+    } else {
+        delay_ms(ms);
+    }
+}
+
+#endif /* !FLASH_SIMULATOR */
@@ -0,0 +1,116 @@
+/**
+ * @file sdio_sd.h
+ * @brief SD 卡驱动：SDIO 4 位总线 + DMA，作为 FatFs 物理驱动器 DEV_MMC（diskio.c）
+ * @details 硬件连接（STM32F407 SDIO，AF12）：
+ *          - PC8~PC11 = D0~D3，PC12 = CK，PD2 = CMD（D0~D3、CMD 上拉）
+ *          - DMA2 Stream6 通道4（SDIO 也可映射到 Stream3 通道4，但 Stream3 已用于 SPI1_TX）
+ *          - SDIOCLK = PLL48CK = 48MHz（PLL_Q = 7）；识别阶段 400kHz，初始化完成后 24MHz
+ *
+ *          初始化流程：CMD0 → CMD8（区分 v1/v2）→ ACMD41 轮询（HCS）→ CMD2 → CMD3 → CMD9
+ *          （由 CSD 计算扇区数）→ CMD7 选中 → 切换 24MHz → ACMD6 切换 4 位总线 → CMD16（仅 SDSC）。
+ *          多扇区读写使用 CMD18/CMD25（写前 ACMD23 预擦除）+ CMD12，单扇区用 CMD17/CMD24。
+ *          写命令结束后卡仍在内部编程，驱动不原地等待，下一条读写命令或 SD_Sync 之前
+ *          才用 CMD13 查询，期间调用方可以继续准备下一批数据。
+ *
+ *          DMA 不能访问 CCM RAM，目标缓冲区在 CCM 中时逐扇区经内部缓冲区中转；
+ *          非 4 字节对齐的缓冲区由 DMA FIFO 按字节打包，不需要中转。
+ *          只支持 SD 卡（SDSC v1/v2、SDHC/SDXC），不支持 MMC。
+ *
+ *          与 W25Q128 一样，存储服务运行时 SD_* 只能在存储任务中调用（经 FatFs 或 Storage_Call）。
+ *          协议部分与硬件无关，主机模拟器用 sd_card_sim.c（SD 卡命令协议模型）实现 SD_HW_* 接口。
+ */
+
+#ifndef SDIO_SD_H
+#define SDIO_SD_H
+
+#include <stdint.h>
+
+#define SD_BLOCK_SIZE       512
+#define SD_INIT_CLOCK_HZ    400000      ///< 识别阶段时钟上限
+#define SD_XFER_CLOCK_HZ    24000000    ///< 数据传输时钟（默认速度模式上限 25MHz）
+#define SD_READ_TIMEOUT_MS  100         ///< 读数据超时（SD 规范 SDHC 上限）
+#define SD_WRITE_TIMEOUT_MS 250         ///< 写数据/编程超时（SD 规范 SDHC 上限）
+#define SD_INIT_TIMEOUT_MS  1000        ///< ACMD41 上电完成超时
+
+// 返回值
+#define SD_OK               0
+#define SD_ERR_NO_CARD      1   ///< 无卡或卡不响应
+#define SD_ERR_TIMEOUT      2   ///< 命令/数据超时
+#define SD_ERR_CRC          3   ///< 命令响应或数据 CRC 错误
+#define SD_ERR_UNSUPPORTED  4   ///< 电压范围不符、MMC 卡等
+#define SD_ERR_CARD         5   ///< 卡状态（R1）报告错误：越界、地址错误、写保护等
+#define SD_ERR_DATA         6   ///< FIFO 上溢/下溢等数据通道错误
+#define SD_ERR_PARAM        7   ///< 参数错误
+#define SD_ERR_NOT_READY    8   ///< 未初始化
+
+/**
+ * @brief 卡类型
+ */
+typedef enum {
+    SD_CARD_NONE = 0,
+    SD_CARD_SDSC_V1,        ///< SD 1.x 标准容量（字节地址）
+    SD_CARD_SDSC_V2,        ///< SD 2.0 标准容量（字节地址）
+    SD_CARD_SDHC            ///< SDHC/SDXC（扇区地址）
+} SD_CardType;
+
+/**
+ * @brief 卡信息
+ */
+typedef struct {
+    uint8_t  type;          ///< SD_CardType
+    uint8_t  bus_width;     ///< 1 或 4
+    uint16_t rca;           ///< 相对卡地址
+    uint32_t clock_hz;      ///< 当前总线时钟
+    uint32_t sector_count;  ///< 512 字节扇区数
+    uint32_t erase_sectors; ///< 擦除单元（扇区），用于 f_mkfs 对齐
+    uint32_t cid[4];
+    uint32_t csd[4];
+} SD_CardInfo;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t commands;      ///< 发出的命令数（含 CMD55）
+    uint32_t read_cmds;     ///< CMD17/CMD18 次数
+    uint32_t write_cmds;    ///< CMD24/CMD25 次数
+    uint32_t multi_cmds;    ///< 其中 CMD18/CMD25 次数
+    uint32_t blocks_read;
+    uint32_t blocks_written;
+    uint32_t bounce_blocks; ///< 经内部缓冲区中转的扇区数
+    uint32_t busy_polls;    ///< 等待卡编程完成时发出的 CMD13 次数
+    uint32_t errors;        ///< 失败的传输次数
+    uint32_t retries;       ///< 重试次数
+} SD_Stats;
+
+int SD_Init(void);
+uint8_t SD_IsReady(void);
+int SD_ReadBlocks(uint8_t *buf, uint32_t sector, uint32_t count);
+int SD_WriteBlocks(const uint8_t *buf, uint32_t sector, uint32_t count);
+int SD_Sync(void);
+void SD_GetCardInfo(SD_CardInfo *info);
+void SD_GetStats(SD_Stats *stats);
+void SD_ResetStats(void);
+
+// =============================================================================
+// 硬件接口：固件在 sdio_sd.c 中用 SDIO 外设实现，主机模拟器由 sd_card_sim.c 实现
+// =============================================================================
+
+#define SD_HW_RESP_NONE         0
+#define SD_HW_RESP_SHORT        1   ///< R1/R1b/R6/R7，检查 CRC 和命令索引
+#define SD_HW_RESP_SHORT_NOCRC  2   ///< R3（OCR）没有 CRC
+#define SD_HW_RESP_LONG         3   ///< R2（CID/CSD），resp[0] 为 bit127~96
+
+#define SD_HW_READ              0
+#define SD_HW_WRITE             1
+
+void SD_HW_Init(void);
+void SD_HW_SetBus(uint32_t clock_hz, uint8_t width);
+int SD_HW_Command(uint8_t cmd, uint32_t arg, uint8_t resp, uint32_t resp_out[4]);
+int SD_HW_DataStart(void *buf, uint32_t blocks, uint8_t dir);
+int SD_HW_DataWait(void);
+void SD_HW_DataAbort(void);
+uint8_t SD_HW_DmaCapable(const void *buf);
+void SD_HW_Delay(uint32_t ms);
+
+#endif
@@ -0,0 +1,354 @@
+/**
+ * @file shell.c
+ * @brief 串口命令解释器实现（见 shell.h）
+ */
+
+#include "shell.h"
+#include <stdio.h>
+#include <string.h>
+
+static const Shell_Cmd *cmd_table[SHELL_MAX_CMDS];     // 按名字升序
+static uint32_t cmd_count = 0;
+static Shell_Stats shell_stats;
+
+static int shell_help(uint32_t argc, const Shell_Arg *argv);
+
+static const Shell_Cmd builtin_cmds[] = {
+    { "help", "", shell_help, "list commands" },
+};
+
+/**
+ * @brief 清空命令表，登记内置的 help
+ */
+void Shell_Init(void)
+{
+    cmd_count = 0;
+    memset(&shell_stats, 0, sizeof(shell_stats));
+    Shell_Register(builtin_cmds, sizeof(builtin_cmds) / sizeof(builtin_cmds[0]));
+}
+
+// 二分查找：返回 name 应在的位置，*found 表示该位置就是它
+static uint32_t find_slot(const char *name, int *found)
+{
+    uint32_t lo = 0, hi = cmd_count;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        int c = strcmp(name, cmd_table[mid]->name);
+
+        if (c == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (c < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    *found = 0;
+    return lo;
+}
+
+/**
+ * @brief 登记一组命令（数组须一直有效，通常是 static const）
+ * @return SHELL_OK，SHELL_ERR_FULL-命令表已满，SHELL_ERR_EXIST-名字重复（该命令跳过，其余照常登记）
+ */
+int Shell_Register(const Shell_Cmd *cmds, uint32_t count)
+{
+    int ret = SHELL_OK;
+
+    for (uint32_t i = 0; i < count; i++) {
+        int found;
+        uint32_t pos = find_slot(cmds[i].name, &found);
+
+        if (found) {
+            ret = SHELL_ERR_EXIST;
+            continue;
+        }
+        if (cmd_count >= SHELL_MAX_CMDS) {
+            return SHELL_ERR_FULL;
+        }
+        memmove(&cmd_table[pos + 1], &cmd_table[pos], (cmd_count - pos) * sizeof(cmd_table[0]));
+        cmd_table[pos] = &cmds[i];
+        cmd_count++;
+    }
+    return ret;
+}
+
+const Shell_Cmd *Shell_Find(const char *name)
+{
+    int found;
+    uint32_t pos = find_slot(name, &found);
+
+    return found ? cmd_table[pos] : NULL;
+}
+
+static int shell_help(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    (void)argv;
+    for (uint32_t i = 0; i < cmd_count; i++) {
+        printf("  %-14s %-8s %s\r\n", cmd_table[i]->name, cmd_table[i]->args, cmd_table[i]->help);
+    }
+    return SHELL_OK;
+}
+
+// =============================================================================
+// 切分与参数解析
+// =============================================================================
+
+/**
+ * @brief 就地切分，tok 中的指针指向 line 内部
+ * @return 记号个数，-1-引号不成对，-2-记号超过 max 个
+ */
+static int tokenize(char *line, char **tok, int max)
+{
+    int n = 0;
+    char *p = line;
+
+    while (1) {
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '\0') {
+            return n;
+        }
+        if (n == max) {
+            return -2;
+        }
+        if (*p == '"') {
+            tok[n++] = ++p;
+            p = strchr(p, '"');
+            if (p == NULL) {
+                return -1;
+            }
+        } else {
+            tok[n++] = p;
+            while (*p != '\0' && *p != ' ' && *p != '\t') {
+                p++;
+            }
+            if (*p == '\0') {
+                return n;
+            }
+        }
+        *p++ = '\0';
+    }
+}
+
+static int parse_uint(const char *s, uint32_t *out)
+{
+    uint32_t v = 0, base = 10;
+
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        base = 16;
+        s += 2;
+    }
+    if (*s == '\0') {
+        return -1;
+    }
+    for (; *s != '\0'; s++) {
+        uint32_t d;
+        char c = (char)(*s | 0x20);
+
+        if (*s >= '0' && *s <= '9') {
+            d = (uint32_t)(*s - '0');
+        } else if (base == 16 && c >= 'a' && c <= 'f') {
+            d = (uint32_t)(c - 'a' + 10);
+        } else {
+            return -1;
+        }
+        if (v > (0xFFFFFFFFu - d) / base) {
+            return -1;      // 溢出
+        }
+        v = v * base + d;
+    }
+    *out = v;
+    return 0;
+}
+
+static int parse_int(const char *s, int32_t *out)
+{
+    uint32_t v;
+    int neg = *s == '-';
+
+    if (*s == '-' || *s == '+') {
+        s++;
+    }
+    if (parse_uint(s, &v) != 0 || v > (neg ? 0x80000000u : 0x7FFFFFFFu)) {
+        return -1;
+    }
+    *out = neg ? (int32_t)(0u - v) : (int32_t)v;
+    return 0;
+}
+
+// 一到两位十进制数，不大于 max
+static const char *parse_field(const char *s, uint32_t max, uint32_t *out)
+{
+    uint32_t v = 0, n = 0;
+
+    while (*s >= '0' && *s <= '9' && n < 2) {
+        v = v * 10 + (uint32_t)(*s++ - '0');
+        n++;
+    }
+    if (n == 0 || v > max) {
+        return NULL;
+    }
+    *out = v;
+    return s;
+}
+
+static int parse_time(const char *s, uint32_t *out)
+{
+    uint32_t h, m, sec = 0;
+
+    if ((s = parse_field(s, 23, &h)) == NULL || *s++ != ':' || (s = parse_field(s, 59, &m)) == NULL) {
+        return -1;
+    }
+    if (*s == ':' && (s = parse_field(s + 1, 59, &sec)) == NULL) {
+        return -1;
+    }
+    if (*s != '\0') {
+        return -1;
+    }
+    *out = (h << 16) | (m << 8) | sec;
+    return 0;
+}
+
+static int parse_bool(const char *s, uint32_t *out)
+{
+    if (strcmp(s, "on") == 0 || strcmp(s, "1") == 0) {
+        *out = 1;
+    } else if (strcmp(s, "off") == 0 || strcmp(s, "0") == 0) {
+        *out = 0;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 按类型串解析参数
+ * @return 参数个数，-1-个数或类型不对
+ */
+static int parse_args(const char *spec, char **tok, int ntok, Shell_Arg *argv)
+{
+    int n = 0, optional = 0;
+
+    for (; *spec != '\0'; spec++) {
+        int bad;
+
+        if (*spec == '|') {
+            optional = 1;
+            continue;
+        }
+        if (n == ntok) {
+            return optional ? n : -1;
+        }
+        switch (*spec) {
+        case 'u': bad = parse_uint(tok[n], &argv[n].u); break;
+        case 'i': bad = parse_int(tok[n], &argv[n].i); break;
+        case 'b': bad = parse_bool(tok[n], &argv[n].u); break;
+        case 't': bad = parse_time(tok[n], &argv[n].u); break;
+        case 's': argv[n].s = tok[n]; bad = 0; break;
+        default:  bad = -1; break;
+        }
+        if (bad) {
+            return -1;
+        }
+        n++;
+    }
+    return n == ntok ? n : -1;
+}
+
+// =============================================================================
+// 执行
+// =============================================================================
+
+/**
+ * @brief 执行一行命令（line 会被就地切分），输出 OK 或 ERR
+ * @return SHELL_OK 或 SHELL_ERR_*；空行不输出，返回 SHELL_OK
+ */
+int Shell_Execute(char *line)
+{
+    char *tok[SHELL_MAX_ARGS + 1];
+    Shell_Arg argv[SHELL_MAX_ARGS];
+    const Shell_Cmd *cmd;
+    int ntok = tokenize(line, tok, SHELL_MAX_ARGS + 1);
+    int argc, ret;
+
+    if (ntok == 0) {
+        return SHELL_OK;
+    }
+    shell_stats.lines++;
+    if (ntok == -1) {
+        shell_stats.usage++;
+        printf("ERR unbalanced quote\r\n");
+        return SHELL_ERR_LINE;
+    }
+    cmd = Shell_Find(tok[0]);
+    if (cmd == NULL) {
+        shell_stats.unknown++;
+        printf("ERR unknown command '%s' (try help)\r\n", tok[0]);
+        return SHELL_ERR_UNKNOWN;
+    }
+    argc = ntok < 0 ? -1 : parse_args(cmd->args, &tok[1], ntok - 1, argv);
+    if (argc < 0) {
+        shell_stats.usage++;
+        printf("ERR usage: %s %s\r\n", cmd->name, cmd->args);
+        return SHELL_ERR_USAGE;
+    }
+    ret = cmd->handler((uint32_t)argc, argv);
+    if (ret == SHELL_OK) {
+        shell_stats.ok++;
+        printf("OK\r\n");
+    } else if (ret == SHELL_ERR_USAGE) {
+        shell_stats.usage++;
+        printf("ERR usage: %s %s\r\n", cmd->name, cmd->args);
+    } else {
+        shell_stats.failed++;
+        printf("ERR %s failed (%d)\r\n", cmd->name, ret);
+    }
+    return ret;
+}
+
+void Shell_LineInit(Shell_Line *line)
+{
+    line->len = 0;
+    line->overflow = 0;
+}
+
+/**
+ * @brief 输入收到的数据块：按 \r 或 \n 分行执行，退格删除前一个字符
+ */
+void Shell_Input(Shell_Line *line, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        char ch = (char)data[i];
+
+        if (ch == '\r' || ch == '\n') {
+            if (line->overflow) {
+                shell_stats.lines++;
+                shell_stats.overflow++;
+                printf("ERR line too long (max %d)\r\n", SHELL_LINE_MAX - 1);
+            } else if (line->len > 0) {
+                line->buf[line->len] = '\0';
+                Shell_Execute(line->buf);
+            }
+            Shell_LineInit(line);
+        } else if (ch == '\b' || ch == 0x7F) {
+            if (line->len > 0 && !line->overflow) {
+                line->len--;
+            }
+        } else if (line->len < SHELL_LINE_MAX - 1) {
+            line->buf[line->len++] = ch;
+        } else {
+            line->overflow = 1;
+        }
+    }
+}
+
+void Shell_GetStats(Shell_Stats *stats)
+{
+    *stats = shell_stats;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file shell.h
+ * @brief 串口命令解释器：按名字排序的命令表 + 带类型的参数解析
+ * @details 各模块用 Shell_Register 登记自己的命令表（const 数组，放在 Flash 中），
+ *          登记时按名字插入排序好的指针表，执行时二分查找，命令数增加不再多一遍整行扫描。
+ *
+ *          一行命令在行缓冲区内就地切分：空白分隔，双引号括起的参数可以含空格，
+ *          切分只写入结束符并记录指针，不拷贝参数。参数按命令表中的类型串逐个解析：
+ *
+ *            u 无符号整数（十进制或 0x 十六进制）   i 有符号整数
+ *            b 开关（on/off/1/0）                  t 时间 hh:mm[:ss]，结果见 SHELL_TIME_*
+ *            s 字符串（指向行缓冲区）
+ *
+ *          类型串中 '|' 之后的参数可以省略（argc 为实际个数）。
+ *          每条命令执行后输出一行 "OK" 或 "ERR <原因>"，上位机脚本据此判断结果。
+ *          本模块不依赖 FreeRTOS，主机模拟器（shell_bench.c）编译同一份代码。
+ */
+
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <stdint.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#ifndef SHELL_LINE_MAX
+#define SHELL_LINE_MAX      128     ///< 一行最长字节数（含结束符）
+#endif
+#ifndef SHELL_MAX_ARGS
+#define SHELL_MAX_ARGS      8       ///< 命令名之外的参数个数上限
+#endif
+#ifndef SHELL_MAX_CMDS
+#define SHELL_MAX_CMDS      48      ///< 可登记的命令总数
+#endif
+
+// =============================================================================
+// 返回值
+// =============================================================================
+#define SHELL_OK            0
+#define SHELL_ERR_UNKNOWN   -1      ///< 没有这个命令
+#define SHELL_ERR_USAGE     -2      ///< 参数个数或类型不对
+#define SHELL_ERR_FAIL      -3      ///< 命令执行失败
+#define SHELL_ERR_FULL      -4      ///< 命令表已满
+#define SHELL_ERR_EXIST     -5      ///< 命令名重复
+#define SHELL_ERR_LINE      -6      ///< 行太长或引号不成对
+
+// 't' 类型参数的拆分
+#define SHELL_TIME_H(v)     ((uint8_t)((v) >> 16))
+#define SHELL_TIME_M(v)     ((uint8_t)((v) >> 8))
+#define SHELL_TIME_S(v)     ((uint8_t)(v))
+
+/**
+ * @brief 解析后的参数
+ */
+typedef union {
+    uint32_t    u;      ///< u b t
+    int32_t     i;      ///< i
+    const char *s;      ///< s
+} Shell_Arg;
+
+/**
+ * @brief 命令处理函数，返回 SHELL_OK 或 SHELL_ERR_*（输出 ERR 之前可以先打印原因）
+ */
+typedef int (*Shell_Handler)(uint32_t argc, const Shell_Arg *argv);
+
+typedef struct {
+    const char   *name;
+    const char   *args;     ///< 参数类型串，如 "u|b"，无参数为 ""
+    Shell_Handler handler;
+    const char   *help;
+} Shell_Cmd;
+
+/**
+ * @brief 行缓冲区：把串口收到的数据块拼成行
+ */
+typedef struct {
+    char     buf[SHELL_LINE_MAX];
+    uint32_t len;
+    uint8_t  overflow;      ///< 本行已超长，丢弃到行尾
+} Shell_Line;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t lines;         ///< 执行的命令行数（空行不算）
+    uint32_t ok;
+    uint32_t unknown;
+    uint32_t usage;
+    uint32_t failed;
+    uint32_t overflow;      ///< 超长被丢弃的行
+} Shell_Stats;
+
+void Shell_Init(void);
+int Shell_Register(const Shell_Cmd *cmds, uint32_t count);
+const Shell_Cmd *Shell_Find(const char *name);
+int Shell_Execute(char *line);
+void Shell_LineInit(Shell_Line *line);
+void Shell_Input(Shell_Line *line, const uint8_t *data, uint32_t len);
+void Shell_GetStats(Shell_Stats *stats);
+
+#endif
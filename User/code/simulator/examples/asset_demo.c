@@ -0,0 +1,323 @@
+// asset_demo.c - 资源包演示：安装 asset_pack 生成的映像，按名字读取并与编译进固件的数组逐字节比较
+//
+// 用法：asset_demo <assets.bin>
+//   1. 映像文件复制到 FatFs（固件上由 0:/assets.bin 提供），Asset_Install 写入资源包分区
+//   2. 图标、字模与 logo.c / oledfont.h 中的数组比较，整屏图片与 OLED_ShowPicture 画出的显存比较，
+//      旋律与 nnnn_examples.c 中的音符比较
+//   3. 查找与整屏读取开销（模拟时间）
+//   4. 安装过程中每个编程/擦除步骤处掉电：重新上电后分区要么没有有效映像，要么是完整映像
+//   5. 资源数据损坏由 Asset_VerifyAll 发现
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ff.h"
+#include "diskio_cache.h"
+#include "w25q128_sim.h"
+#include "flash_layout.h"
+#include "asset.h"
+#include "logo.h"
+#include "oledfont.h"
+
+#define PACK_PATH   "0:/assets.bin"
+
+static FATFS fs;
+static BYTE work[FF_MAX_SS];
+static uint8_t buf[8192];
+static uint8_t gram[144][8];    // 与 oled.c 的 OLED_GRAM 相同
+static uint8_t *pack;
+static uint32_t pack_size;
+
+typedef struct {
+    const char    *name;
+    const uint8_t *data;
+    uint32_t       len;
+} RefAsset;
+
+#define REF(a, n)   {#a, (const uint8_t *)(a), (n)}
+static const RefAsset refs[] = {
+    REF(gImage_1, 464), REF(gImage_bg, 512), REF(gImage_bgg, 512), REF(gImage_xbg, 128),
+    REF(gImage_calendar, 128), REF(gImage_clock, 128), REF(gImage_flashlight, 128),
+    REF(gImage_stopwatch, 128), REF(gImage_setting, 128), REF(gImage_TandH, 128),
+    REF(gImage_sun, 128), REF(gImage_moon, 128), REF(gImage_bell, 128), REF(gImage_list, 128),
+    REF(gImage_new, 128), REF(gImage_add, 128), REF(gImage_step, 128), REF(gImage_test, 128),
+    REF(asc2_0806, sizeof(asc2_0806)), REF(asc2_1206, sizeof(asc2_1206)),
+    REF(asc2_1608, sizeof(asc2_1608)), REF(asc2_2412, sizeof(asc2_2412)),
+    REF(Hzk1, sizeof(Hzk1)), REF(Hzk2, sizeof(Hzk2)), REF(Hzk3, sizeof(Hzk3)), REF(Hzk4, sizeof(Hzk4)),
+};
+#define REF_COUNT   (sizeof(refs) / sizeof(refs[0]))
+
+// nnnn_examples.c 的 haruhi_correct（依赖 music.c 的播放函数，这里不链接）
+static const uint8_t haruhi_ref[8][6] = {
+    {3, 5, 0, 0, 0, 0}, {2, 3, 1, 1, 0, 0}, {1, 4, 0, 0, 0, 0}, {2, 3, 1, 1, 0, 0},
+    {3, 5, 0, 0, 0, 1}, {4, 4, 1, 0, 0, 0}, {3, 5, 0, 0, 0, 0}, {2, 5, 0, 0, 0, 1}
+};
+
+static FRESULT mount_or_format(void)
+{
+    FRESULT fr = f_mount(&fs, "0:", 1);
+
+    if (fr == FR_NO_FILESYSTEM) {
+        // 与固件 storage_service.c 相同的格式化参数
+        MKFS_PARM opt = {0};
+        opt.fmt = FM_ANY | FM_SFD;
+        opt.au_size = W25Q128_SECTOR_SIZE;
+        opt.n_fat = 1;
+        opt.n_root = 128;
+        fr = f_mkfs("0:", &opt, work, sizeof(work));
+        if (fr != FR_OK) {
+            return fr;
+        }
+        fr = f_mount(&fs, "0:", 1);
+    }
+    if (fr == FR_OK) {
+        disk_cache_pin_fat(&fs);
+    }
+    return fr;
+}
+
+static int write_file(const char *path, const void *data, UINT len)
+{
+    FIL fil;
+    UINT bw;
+    int ok;
+
+    if (f_open(&fil, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) {
+        return 0;
+    }
+    ok = f_write(&fil, data, len, &bw) == FR_OK && bw == len;
+    return f_close(&fil) == FR_OK && ok;
+}
+
+static uint8_t *load_host_file(const char *path, uint32_t *size)
+{
+    FILE *fp = fopen(path, "rb");
+    uint8_t *data;
+    long n;
+
+    if (fp == NULL) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    n = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data = (uint8_t *)malloc((size_t)n);
+    if (data == NULL || fread(data, 1, (size_t)n, fp) != (size_t)n) {
+        fclose(fp);
+        free(data);
+        return NULL;
+    }
+    fclose(fp);
+    *size = (uint32_t)n;
+    return data;
+}
+
+// 与 oled.c 中 OLED_ShowPicture(x, y, sizex, sizey, BMP, 1) 相同的画法
+static void show_picture(uint8_t x, uint8_t y, uint8_t sizex, uint8_t sizey, const uint8_t *bmp)
+{
+    uint16_t j = 0;
+
+    for (uint8_t n = 0; n < (sizey + 7) / 8; n++) {
+        for (uint8_t i = 0; i < sizex; i++) {
+            uint8_t temp = bmp[j++];
+            for (uint8_t m = 0; m < 8; m++) {
+                uint8_t px = x + i, py = y + n * 8 + m;
+                if (temp & 0x01) {
+                    gram[px][py / 8] |= 1 << (py % 8);
+                } else {
+                    gram[px][py / 8] &= ~(1 << (py % 8));
+                }
+                temp >>= 1;
+            }
+        }
+    }
+}
+
+static int check_contents(void)
+{
+    AssetInfo info;
+    int ok = 1;
+
+    // 整屏：DMA 读入显存的结果应与用 OLED_ShowPicture 画 logo 相同
+    memset(gram, 0, sizeof(gram));
+    show_picture(0, 0, 128, 64, logo);
+    memset(buf, 0, 1024);
+    if (Asset_Find("logo", &info) != ASSET_OK || info.type != ASSET_TYPE_FRAME ||
+        Asset_Read(&info, 0, buf, info.length) != ASSET_OK || info.length != 1024 ||
+        memcmp(buf, gram, 1024) != 0) {
+        printf("  logo frame mismatch\n");
+        ok = 0;
+    }
+
+    for (uint32_t i = 0; i < REF_COUNT; i++) {
+        if (Asset_Find(refs[i].name, &info) != ASSET_OK || info.length != refs[i].len ||
+            Asset_Read(&info, 0, buf, info.length) != ASSET_OK || memcmp(buf, refs[i].data, refs[i].len) != 0) {
+            printf("  %s mismatch\n", refs[i].name);
+            ok = 0;
+        }
+    }
+    if (Asset_Find("asc2_1608", &info) != ASSET_OK || info.count != 95 || info.w != 8 || info.h != 16) {
+        printf("  asc2_1608 parameters wrong\n");
+        ok = 0;
+    }
+
+    // 旋律：按音符分段读取（与 asset_view.c 的播放方式相同）
+    if (Asset_Find("haruhi_correct", &info) != ASSET_OK || info.type != ASSET_TYPE_MELODY ||
+        info.count != 8 || info.w != 1 || info.h != 97) {
+        printf("  haruhi_correct parameters wrong\n");
+        ok = 0;
+    } else {
+        for (uint32_t n = 0; n < info.count; n += 3) {
+            uint32_t k = info.count - n < 3 ? info.count - n : 3;
+            if (Asset_Read(&info, n * 6, buf, k * 6) != ASSET_OK || memcmp(buf, haruhi_ref[n], k * 6) != 0) {
+                printf("  haruhi_correct note %lu mismatch\n", (unsigned long)n);
+                ok = 0;
+            }
+        }
+    }
+
+    if (Asset_Find("no_such_asset", NULL) != ASSET_ERR_NOT_FOUND) {
+        printf("  missing name not reported\n");
+        ok = 0;
+    }
+    printf("contents: %u images/fonts + logo frame + melody match the compiled arrays: %s\n",
+           (unsigned)REF_COUNT, ok ? "yes" : "NO");
+    return ok;
+}
+
+// 查找开销与整屏图片读取时间
+static void measure_cost(void)
+{
+    Asset_Stats before, after;
+    AssetInfo info;
+    uint64_t t0, t_find, t_frame;
+
+    Asset_GetStats(&before);
+    t0 = W25Q128_Sim_Time_us();
+    for (uint32_t i = 0; i < REF_COUNT; i++) {
+        Asset_Find(refs[i].name, &info);
+    }
+    t_find = W25Q128_Sim_Time_us() - t0;
+    Asset_GetStats(&after);
+
+    t0 = W25Q128_Sim_Time_us();
+    Asset_Find("logo", &info);
+    Asset_Read(&info, 0, buf, info.length);
+    t_frame = W25Q128_Sim_Time_us() - t0;
+
+    printf("lookup: %.2f slots read per lookup, %.0f us per lookup\n",
+           (double)(after.probes - before.probes) / REF_COUNT, (double)t_find / REF_COUNT);
+    printf("full-screen frame: %lu us to find and read 1 KB straight into the frame buffer\n",
+           (unsigned long)t_frame);
+}
+
+// 空白分区上安装，第 k 次编程/擦除时掉电
+static int check_power_fail(void)
+{
+    W25Q128_Sim_Stats st;
+    uint32_t ops, rejected = 0, complete = 0, bad = 0;
+
+    memset(W25Q128_Sim_Memory() + FLASH_ASSET_BASE, 0xFF, FLASH_ASSET_SIZE);
+    W25Q128_Sim_ResetStats();
+    Asset_Install(PACK_PATH);
+    W25Q128_Sim_GetStats(&st);
+    ops = st.page_programs + st.sector_erases;
+
+    for (uint32_t k = 1; k <= ops + 1; k++) {
+        int rc;
+
+        memset(W25Q128_Sim_Memory() + FLASH_ASSET_BASE, 0xFF, FLASH_ASSET_SIZE);
+        Asset_Init();
+        W25Q128_Sim_FailAfter(k);
+        Asset_Install(PACK_PATH);
+        W25Q128_Sim_PowerCycle();
+
+        rc = Asset_Init();
+        if (rc == ASSET_OK && Asset_VerifyAll() == ASSET_OK) {
+            complete++;
+        } else if (rc == ASSET_ERR_NO_PACK || rc == ASSET_ERR_CRC) {
+            rejected++;
+        } else {
+            printf("  cut %lu: partial image accepted (rc %d)\n", (unsigned long)k, rc);
+            bad++;
+        }
+    }
+    printf("power cut during install at each of %lu steps: %lu rejected, %lu complete, %lu corrupt accepted\n",
+           (unsigned long)ops + 1, (unsigned long)rejected, (unsigned long)complete, (unsigned long)bad);
+    return bad == 0 && complete >= 1;
+}
+
+static int check_corruption(void)
+{
+    AssetInfo info;
+    int ok;
+
+    if (Asset_Install(PACK_PATH) != ASSET_OK || Asset_Find("gImage_bell", &info) != ASSET_OK) {
+        return 0;
+    }
+    W25Q128_Sim_Memory()[info.addr + 5] ^= 0x10;
+    ok = Asset_VerifyAll() == ASSET_ERR_CRC;
+    W25Q128_Sim_Memory()[info.addr + 5] ^= 0x10;
+    ok = ok && Asset_VerifyAll() == ASSET_OK;
+    printf("corruption: flipped bit in gImage_bell detected by Asset_VerifyAll: %s\n", ok ? "yes" : "NO");
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    W25Q128_Sim_Stats st;
+    Asset_Stats as;
+    uint64_t t0;
+    int ok = 1, rc;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <assets.bin>\n", argv[0]);
+        return 2;
+    }
+    pack = load_host_file(argv[1], &pack_size);
+    if (pack == NULL) {
+        fprintf(stderr, "cannot read %s (run asset_pack first)\n", argv[1]);
+        return 1;
+    }
+
+    W25Q128_Sim_Open(NULL);
+    if (mount_or_format() != FR_OK || !write_file(PACK_PATH, pack, pack_size)) {
+        printf("FatFs setup failed\n");
+        return 1;
+    }
+
+    rc = Asset_Init();
+    printf("blank partition: Asset_Init -> %d (ASSET_ERR_NO_PACK expected)\n", rc);
+    ok = rc == ASSET_ERR_NO_PACK && ok;
+
+    W25Q128_Sim_ResetStats();
+    t0 = W25Q128_Sim_Time_us();
+    rc = Asset_Install(PACK_PATH);
+    W25Q128_Sim_GetStats(&st);
+    Asset_GetStats(&as);
+    printf("install: %d, %lu assets, %lu B in %.0f ms (%lu erases, %lu page programs)\n", rc,
+           (unsigned long)as.count, (unsigned long)as.image_size, (W25Q128_Sim_Time_us() - t0) / 1000.0,
+           (unsigned long)st.sector_erases, (unsigned long)st.page_programs);
+    ok = rc == ASSET_OK && ok;
+
+    W25Q128_Sim_ResetStats();
+    rc = Asset_Install(PACK_PATH);
+    W25Q128_Sim_GetStats(&st);
+    printf("reinstall same image: %d, %lu erases, %lu page programs (0 expected)\n", rc,
+           (unsigned long)st.sector_erases, (unsigned long)st.page_programs);
+    ok = rc == ASSET_OK && st.sector_erases == 0 && st.page_programs == 0 && ok;
+
+    ok = check_contents() && ok;
+    measure_cost();
+    ok = check_power_fail() && ok;
+    ok = check_corruption() && ok;
+
+    printf("\n");
+    Asset_PrintList();
+
+    free(pack);
+    f_mount(NULL, "0:", 0);
+    W25Q128_Sim_Close();
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
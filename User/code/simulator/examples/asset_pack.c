@@ -0,0 +1,514 @@
+// asset_pack.c - 资源包打包工具：按清单从 C 源文件提取数组，生成 W25Q128 资源包映像（格式见 asset_pack.h）
+//
+// 用法：asset_pack <清单> <输出映像> [W25Q128 镜像文件]
+//   清单每行一个资源：名字 类型 源文件 数组名 [参数]，# 开始注释，源文件路径相对清单所在目录
+//     bitmap  WxH              OLED_ShowPicture 格式位图，长度必须是 W * ceil(H/8)
+//     frame   page|gram        128x64 整屏；page 表示源数组是 OLED_ShowPicture 格式，打包时转成显存列顺序
+//     font    WxH              字模表（二维数组），每个字符的字节数取第二维
+//     melody  4/4|6/8|3/4 BPM  NumberedNote 数组（6 个 uint8_t 字段）
+//     raw                      原样打包
+//   数组按 C 初始化规则展开：维度必须是数字（第一维可省略），内层大括号按子数组对齐并补 0。
+//   给出 W25Q128 镜像文件（模拟器使用的 16MB 文件，不存在则新建）时，同时把映像写到 FLASH_ASSET_BASE，
+//   相当于用编程器直接烧写分区。
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stddef.h>
+#include "asset_pack.h"
+#include "flash_layout.h"
+#include "crc.h"
+#include "w25q128_sim.h"
+
+#define MAX_ASSETS      256
+#define MAX_DIMS        4
+
+typedef struct {
+    AssetEntry e;
+    uint8_t   *data;
+} PackItem;
+
+static PackItem items[MAX_ASSETS];
+static uint16_t item_count;
+static const char *manifest_path;
+static int manifest_line;
+
+static void die(const char *fmt, const char *arg)
+{
+    fprintf(stderr, "asset_pack: %s:%d: ", manifest_path, manifest_line);
+    fprintf(stderr, fmt, arg);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+static char *read_text(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    long n;
+    char *buf;
+
+    if (fp == NULL) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    n = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    buf = (char *)malloc((size_t)n + 1);
+    if (buf == NULL || fread(buf, 1, (size_t)n, fp) != (size_t)n) {
+        fclose(fp);
+        free(buf);
+        return NULL;
+    }
+    buf[n] = '\0';
+    fclose(fp);
+    return buf;
+}
+
+// 注释替换为空格（字符串和字符常量内的注释符号不算），其余原样保留
+static void strip_comments(char *s)
+{
+    char quote = 0;
+
+    for (; *s; s++) {
+        if (quote) {
+            if (*s == '\\' && s[1]) {
+                s++;
+            } else if (*s == quote) {
+                quote = 0;
+            }
+        } else if (*s == '"' || *s == '\'') {
+            quote = *s;
+        } else if (s[0] == '/' && s[1] == '/') {
+            while (*s && *s != '\n') {
+                *s++ = ' ';
+            }
+            s--;
+        } else if (s[0] == '/' && s[1] == '*') {
+            *s++ = ' ';
+            *s = ' ';
+            while (s[1] && !(s[1] == '*' && s[2] == '/')) {
+                s++;
+                if (*s != '\n') {
+                    *s = ' ';
+                }
+            }
+            if (s[1]) {
+                s[1] = ' ';
+                s[2] = ' ';
+                s += 2;
+            }
+        }
+    }
+}
+
+static const char *skip_ws(const char *p)
+{
+    while (isspace((unsigned char)*p)) {
+        p++;
+    }
+    return p;
+}
+
+static int is_ident(char c)
+{
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+// 查找 "symbol [d0][d1].. = {"，返回 '{' 的位置，dims 中未给出的维度为 0
+static const char *find_array(const char *text, const char *symbol, uint32_t *dims, int *ndims)
+{
+    size_t len = strlen(symbol);
+
+    for (const char *p = strstr(text, symbol); p != NULL; p = strstr(p + 1, symbol)) {
+        const char *q = p + len;
+
+        if ((p > text && is_ident(p[-1])) || is_ident(*q)) {
+            continue;
+        }
+        *ndims = 0;
+        q = skip_ws(q);
+        while (*q == '[' && *ndims < MAX_DIMS) {
+            char *end;
+            q = skip_ws(q + 1);
+            if (*q == ']') {
+                dims[*ndims] = 0;
+            } else {
+                dims[*ndims] = (uint32_t)strtoul(q, &end, 0);
+                if (end == q || *skip_ws(end) != ']') {
+                    die("array %s: dimension is not a number", symbol);
+                }
+                q = skip_ws(end);
+            }
+            (*ndims)++;
+            q = skip_ws(q + 1);
+        }
+        if (*q != '=') {
+            continue;   // 声明或使用，不是定义
+        }
+        q = skip_ws(q + 1);
+        if (*q == '{') {
+            return q;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 展开一层大括号：sub[level] 为这一层元素的字节数（0 表示未知），
+ * 内层大括号对齐到 sub[level+1] 并补 0。返回这一层写入的字节数。
+ */
+static uint32_t parse_brace(const char **pp, uint8_t *out, uint32_t cap, uint32_t base,
+                            const uint32_t *sub, int level, int nlev, const char *symbol)
+{
+    const char *p = *pp + 1;
+    uint32_t pos = 0;
+
+    for (;;) {
+        p = skip_ws(p);
+        if (*p == ',') {
+            p++;
+            continue;
+        }
+        if (*p == '}') {
+            p++;
+            break;
+        }
+        if (*p == '{') {
+            uint32_t esz;
+            if (level + 1 >= nlev) {
+                die("array %s: too many braces", symbol);
+            }
+            esz = sub[level + 1];
+            pos = (pos + esz - 1) / esz * esz;
+            if (base + pos + esz > cap) {
+                die("array %s: too large", symbol);
+            }
+            parse_brace(&p, out, cap, base + pos, sub, level + 1, nlev, symbol);
+            pos += esz;
+        } else {
+            char *end;
+            unsigned long v = strtoul(p, &end, 0);
+            if (end == p || v > 0xFF) {
+                die("array %s: element is not a byte constant", symbol);
+            }
+            if (base + pos >= cap) {
+                die("array %s: too large", symbol);
+            }
+            out[base + pos++] = (uint8_t)v;
+            p = end;
+        }
+        if (sub[level] != 0 && pos > sub[level]) {
+            die("array %s: too many initializers", symbol);
+        }
+    }
+    *pp = p;
+    return sub[level] != 0 ? sub[level] : pos;
+}
+
+// 取出数组的全部字节；elem_size > 1 时把最内层看作该大小的结构体（NumberedNote）
+static uint8_t *extract(const char *src_path, const char *symbol, uint32_t elem_size,
+                        uint32_t *len, uint32_t *inner)
+{
+    static uint8_t scratch[FLASH_ASSET_SIZE];
+    uint32_t dims[MAX_DIMS + 1], sub[MAX_DIMS + 2];
+    const char *p;
+    uint8_t *data;
+    char *text;
+    int ndims, nlev;
+
+    text = read_text(src_path);
+    if (text == NULL) {
+        die("cannot read %s", src_path);
+    }
+    strip_comments(text);
+    p = find_array(text, symbol, dims, &ndims);
+    if (p == NULL) {
+        die("array %s not found", symbol);
+    }
+    if (elem_size > 1) {
+        dims[ndims++] = elem_size;
+    }
+    for (int i = 1; i < ndims; i++) {
+        if (dims[i] == 0) {
+            die("array %s: only the first dimension may be omitted", symbol);
+        }
+    }
+
+    // sub[k]：第 k 层大括号对应的字节数
+    nlev = ndims;
+    sub[nlev] = 1;
+    for (int i = nlev - 1; i >= 0; i--) {
+        sub[i] = dims[i] == 0 ? 0 : dims[i] * sub[i + 1];
+    }
+    memset(scratch, 0, sizeof(scratch));
+    *len = parse_brace(&p, scratch, sizeof(scratch), 0, sub, 0, nlev, symbol);
+    *inner = nlev > 1 ? sub[1] : 1;
+    *len = (*len + *inner - 1) / *inner * *inner;   // 第一维未给出时补齐最后一个元素
+
+    data = (uint8_t *)malloc(*len ? *len : 1);
+    memcpy(data, scratch, *len);
+    free(text);
+    return data;
+}
+
+static void parse_wh(const char *s, uint16_t *w, uint16_t *h)
+{
+    unsigned a, b;
+
+    if (s == NULL || sscanf(s, "%ux%u", &a, &b) != 2 || a == 0 || b == 0 || a > 255 || b > 255) {
+        die("expected WxH, got '%s'", s ? s : "");
+    }
+    *w = (uint16_t)a;
+    *h = (uint16_t)b;
+}
+
+static void add_asset(const char *dir, char **tok, int ntok)
+{
+    char path[1024];
+    PackItem *it;
+    uint32_t len, inner;
+    const char *type = tok[1];
+
+    if (ntok < 4) {
+        die("expected: name type source symbol [params]%s", "");
+    }
+    if (strlen(tok[0]) >= ASSET_NAME_MAX) {
+        die("name %s too long", tok[0]);
+    }
+    for (uint16_t i = 0; i < item_count; i++) {
+        if (strcmp(items[i].e.name, tok[0]) == 0) {
+            die("duplicate name %s", tok[0]);
+        }
+    }
+    if (item_count >= MAX_ASSETS) {
+        die("too many assets%s", "");
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, tok[2]);
+
+    it = &items[item_count++];
+    memset(it, 0, sizeof(*it));
+    strcpy(it->e.name, tok[0]);
+    it->e.count = 1;
+    it->data = extract(path, tok[3], strcmp(type, "melody") == 0 ? 6 : 1, &len, &inner);
+    it->e.length = len;
+
+    if (strcmp(type, "bitmap") == 0) {
+        it->e.type = ASSET_TYPE_BITMAP;
+        parse_wh(ntok > 4 ? tok[4] : NULL, &it->e.w, &it->e.h);
+        if (len != (uint32_t)it->e.w * ((it->e.h + 7) / 8)) {
+            die("bitmap %s: size does not match WxH", tok[0]);
+        }
+    } else if (strcmp(type, "frame") == 0) {
+        it->e.type = ASSET_TYPE_FRAME;
+        it->e.w = 128;
+        it->e.h = 64;
+        if (len != 1024) {
+            die("frame %s: must be 1024 bytes", tok[0]);
+        }
+        if (ntok > 4 && strcmp(tok[4], "page") == 0) {
+            // OLED_ShowPicture 顺序（逐页，每页 128 列）-> OLED_GRAM[列][页]
+            uint8_t gram[1024];
+            for (int pg = 0; pg < 8; pg++) {
+                for (int col = 0; col < 128; col++) {
+                    gram[col * 8 + pg] = it->data[pg * 128 + col];
+                }
+            }
+            memcpy(it->data, gram, sizeof(gram));
+        } else if (ntok <= 4 || strcmp(tok[4], "gram") != 0) {
+            die("frame %s: expected 'page' or 'gram'", tok[0]);
+        }
+    } else if (strcmp(type, "font") == 0) {
+        it->e.type = ASSET_TYPE_FONT;
+        parse_wh(ntok > 4 ? tok[4] : NULL, &it->e.w, &it->e.h);
+        if (inner < 2) {
+            die("font %s: expected a two-dimensional array", tok[0]);
+        }
+        it->e.count = (uint16_t)(len / inner);
+    } else if (strcmp(type, "melody") == 0) {
+        unsigned bpm;
+        it->e.type = ASSET_TYPE_MELODY;
+        if (ntok < 6 || sscanf(tok[5], "%u", &bpm) != 1 || bpm == 0 || bpm > 255) {
+            die("melody %s: expected time signature and BPM", tok[0]);
+        }
+        if (strcmp(tok[4], "4/4") == 0) {
+            it->e.w = 0;    // TIME_SIGNATURE_4_4
+        } else if (strcmp(tok[4], "6/8") == 0) {
+            it->e.w = 1;    // TIME_SIGNATURE_6_8
+        } else if (strcmp(tok[4], "3/4") == 0) {
+            it->e.w = 2;    // TIME_SIGNATURE_3_4
+        } else {
+            die("melody: unknown time signature %s", tok[4]);
+        }
+        it->e.h = (uint16_t)bpm;
+        it->e.count = (uint16_t)(len / 6);
+    } else if (strcmp(type, "raw") == 0) {
+        it->e.type = ASSET_TYPE_RAW;
+    } else {
+        die("unknown type %s", type);
+    }
+    it->e.crc = CRC32_Calc(it->data, len);
+    it->e.hash = Asset_Hash(it->e.name);
+}
+
+static void read_manifest(const char *path)
+{
+    char dir[1024], line[1024];
+    char *tok[8], *slash;
+    FILE *fp;
+
+    manifest_path = path;
+    snprintf(dir, sizeof(dir), "%s", path);
+    slash = strrchr(dir, '/');
+    if (slash != NULL) {
+        *slash = '\0';
+    } else {
+        strcpy(dir, ".");
+    }
+
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "asset_pack: cannot open %s\n", path);
+        exit(1);
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        int n = 0;
+        manifest_line++;
+        if (strchr(line, '#') != NULL) {
+            *strchr(line, '#') = '\0';
+        }
+        for (char *t = strtok(line, " \t\r\n"); t != NULL && n < 8; t = strtok(NULL, " \t\r\n")) {
+            tok[n++] = t;
+        }
+        if (n > 0) {
+            add_asset(dir, tok, n);
+        }
+    }
+    fclose(fp);
+}
+
+// 建哈希表、排数据、填映像头，返回映像（调用方释放）
+static uint8_t *build_image(uint32_t *image_size, AssetPackHeader *hdr)
+{
+    uint16_t buckets = 1;
+    uint32_t ofs, table_size;
+    AssetEntry *table;
+    uint8_t *img;
+
+    while (buckets < 2 * item_count || buckets < 4) {
+        buckets <<= 1;
+    }
+    table_size = buckets * sizeof(AssetEntry);
+    ofs = (sizeof(AssetPackHeader) + table_size + ASSET_PACK_ALIGN - 1) / ASSET_PACK_ALIGN * ASSET_PACK_ALIGN;
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = ASSET_PACK_MAGIC;
+    hdr->version = ASSET_PACK_VERSION;
+    hdr->entry_size = sizeof(AssetEntry);
+    hdr->buckets = buckets;
+    hdr->count = item_count;
+    hdr->data_offset = ofs;
+
+    for (uint16_t i = 0; i < item_count; i++) {
+        items[i].e.offset = ofs;
+        ofs += (items[i].e.length + ASSET_PACK_ALIGN - 1) / ASSET_PACK_ALIGN * ASSET_PACK_ALIGN;
+    }
+    if (ofs > FLASH_ASSET_SIZE) {
+        fprintf(stderr, "asset_pack: image %lu bytes exceeds partition (%lu)\n", (unsigned long)ofs,
+                (unsigned long)FLASH_ASSET_SIZE);
+        exit(1);
+    }
+    hdr->image_size = ofs;
+
+    // 未使用的空间保持擦除状态 0xFF，写入分区时这些页不需要编程
+    img = (uint8_t *)malloc(ofs);
+    memset(img, 0xFF, ofs);
+    table = (AssetEntry *)(img + sizeof(AssetPackHeader));
+    memset(table, 0, table_size);
+    for (uint16_t i = 0; i < item_count; i++) {
+        uint16_t slot = items[i].e.hash & (buckets - 1);
+        while (table[slot].hash != 0) {
+            slot = (slot + 1) & (buckets - 1);
+        }
+        table[slot] = items[i].e;
+        memcpy(img + items[i].e.offset, items[i].data, items[i].e.length);
+    }
+    hdr->table_crc = CRC32_Calc(table, table_size);
+    hdr->header_crc = CRC32_Calc(hdr, offsetof(AssetPackHeader, header_crc));
+    memcpy(img, hdr, sizeof(*hdr));
+    *image_size = ofs;
+    return img;
+}
+
+// 平均/最长探测次数（每次探测读一个槽）
+static void probe_stats(const uint8_t *img, const AssetPackHeader *hdr, double *avg, int *worst)
+{
+    const AssetEntry *table = (const AssetEntry *)(img + sizeof(AssetPackHeader));
+    uint32_t total = 0;
+
+    *worst = 0;
+    for (uint16_t i = 0; i < item_count; i++) {
+        uint16_t slot = items[i].e.hash & (hdr->buckets - 1);
+        int n = 1;
+        while (strcmp(table[slot].name, items[i].e.name) != 0) {
+            slot = (slot + 1) & (hdr->buckets - 1);
+            n++;
+        }
+        total += n;
+        if (n > *worst) {
+            *worst = n;
+        }
+    }
+    *avg = item_count ? (double)total / item_count : 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *const type_names[] = {"raw", "bitmap", "frame", "font", "melody"};
+    AssetPackHeader hdr;
+    uint32_t size, payload = 0;
+    uint8_t *img;
+    double avg;
+    int worst;
+    FILE *fp;
+
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <manifest> <out.bin> [w25q128.img]\n", argv[0]);
+        return 2;
+    }
+    read_manifest(argv[1]);
+    img = build_image(&size, &hdr);
+
+    fp = fopen(argv[2], "wb");
+    if (fp == NULL || fwrite(img, 1, size, fp) != size) {
+        fprintf(stderr, "asset_pack: cannot write %s\n", argv[2]);
+        return 1;
+    }
+    fclose(fp);
+
+    for (uint16_t i = 0; i < item_count; i++) {
+        printf("  %-20s %-6s %6lu B  %3ux%-3u x%u\n", items[i].e.name, type_names[items[i].e.type],
+               (unsigned long)items[i].e.length, items[i].e.w, items[i].e.h, items[i].e.count);
+        payload += items[i].e.length;
+    }
+    probe_stats(img, &hdr, &avg, &worst);
+    printf("%s: %u assets, %lu B data, %lu B image (%u buckets, %.2f probes/lookup, worst %d)\n",
+           argv[2], item_count, (unsigned long)payload, (unsigned long)size, hdr.buckets, avg, worst);
+
+    if (argc > 3) {
+        uint8_t *mem;
+        uint32_t span = (size + W25Q128_SECTOR_SIZE - 1) / W25Q128_SECTOR_SIZE * W25Q128_SECTOR_SIZE;
+
+        if (W25Q128_Sim_Open(argv[3]) != 0) {
+            fprintf(stderr, "asset_pack: cannot open %s\n", argv[3]);
+            return 1;
+        }
+        mem = W25Q128_Sim_Memory();
+        memset(mem + FLASH_ASSET_BASE, 0xFF, span);
+        memcpy(mem + FLASH_ASSET_BASE, img, size);
+        W25Q128_Sim_Close();
+        printf("%s: written at 0x%06lX\n", argv[3], (unsigned long)FLASH_ASSET_BASE);
+    }
+    free(img);
+    return 0;
+}
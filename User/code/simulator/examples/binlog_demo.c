@@ -0,0 +1,275 @@
+// binlog_demo.c - 二进制日志：编码、字符串表提取、解码的一致性检查与开销对比
+//
+// 同一组日志调用按两种方式输出：
+// - 文本：与原来的 printf 相同，在调用方 snprintf 格式化成一行文本（含 \r\n）
+// - 二进制：binlog.h 的 LOG_* 宏，只编码编号、时间戳和 32 位原始参数（与固件同一份 binlog.c）
+// 然后从本程序自己的映像（/proc/self/exe）取出 logstr 段生成字符串表，解码二进制输出，
+// 检查还原的文本与文本路径逐字节一致；再检查 LOG_DEBUG 在编译时被裁掉（格式串不在段中、参数不求值）、
+// 字符串表文件往返、与普通文本混合的数据流和损坏字节后的重新同步。
+#define LOG_MODULE  demo
+#define LOG_LEVEL   LOG_LEVEL_INFO
+#include "binlog.h"
+#include "binlog_decode.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define VERIFY_ROUNDS   2000
+#define BENCH_ROUNDS    200000
+#define OUT_SIZE        (1024 * 1024)
+#define BYTE_US         (10.0 * 1e6 / 921600)      // 921600bps 下每字节的发送时间
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// =============================================================================
+// 输出缓冲区（代替串口发送环形缓冲区）
+// =============================================================================
+
+static uint8_t out_buf[OUT_SIZE];
+static uint32_t out_len;
+static uint32_t out_total;
+static int out_wrap;            // 基准测试时回绕，只统计字节数
+static uint32_t now_ms;
+
+static uint32_t out_write(const uint8_t *data, uint32_t len)
+{
+    if (out_len + len > OUT_SIZE) {
+        if (!out_wrap) {
+            return 0;
+        }
+        out_len = 0;
+    }
+    memcpy(out_buf + out_len, data, len);
+    out_len += len;
+    out_total += len;
+    return len;
+}
+
+static uint32_t demo_clock(void)
+{
+    return now_ms;
+}
+
+static void text_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void text_printf(const char *fmt, ...)
+{
+    char line[128];
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    out_write((const uint8_t *)line, (uint32_t)n);
+}
+
+// =============================================================================
+// 日志负载：计步、闹钟、传感器、存储、RFID 各一行，另有一行调试输出
+// =============================================================================
+
+static uint32_t debug_evals = 0;
+
+__attribute__((unused)) static int debug_sample(void)   // 只出现在被裁掉的 LOG_DEBUG 中
+{
+    debug_evals++;
+    return 42;
+}
+
+static void emit(int binary, uint32_t i)
+{
+    unsigned long steps = 1000 + i;
+    int h = (int)(i / 3600 % 24), m = (int)(i / 60 % 60), s = (int)(i % 60);
+    float temp = 25.0f + (float)(i % 200) / 16.0f;
+    int az = -16384 + (int)(i % 97) * 37;
+    unsigned st = 0x80000000u | i;
+    char c = (char)('A' + i % 26);
+
+    now_ms = i * 5;
+    if (binary) {
+        LOG_INFO("Step detected! Total steps: %lu", steps);
+        LOG_INFO("Alarm triggered! Time: %02d:%02d:%02d, Index: %d", h, m, s, (int)(i % 5));
+        LOG_INFO("MPU temp %.2f C, accel z %d", LOG_F(temp), az);
+        LOG_WARN("storage: write retry %u, status 0x%08X", i % 3, st);
+        LOG_ERROR("rfid: frame error '%c' len %5u, 100%% of %x", c, i % 1000, i);
+        LOG_DEBUG("raw sample %d", debug_sample());
+    } else {
+        text_printf("Step detected! Total steps: %lu\r\n", steps);
+        text_printf("Alarm triggered! Time: %02d:%02d:%02d, Index: %d\r\n", h, m, s, (int)(i % 5));
+        text_printf("MPU temp %.2f C, accel z %d\r\n", temp, az);
+        text_printf("storage: write retry %u, status 0x%08X\r\n", i % 3, st);
+        text_printf("rfid: frame error '%c' len %5u, 100%% of %x\r\n", c, i % 1000, i);
+    }
+}
+
+// =============================================================================
+// 解码
+// =============================================================================
+
+static char dec_text[OUT_SIZE * 4];
+static uint32_t dec_len;
+static uint32_t dec_bad_meta;
+
+static void on_text(void *ctx, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    memcpy(dec_text + dec_len, data, len);
+    dec_len += (uint32_t)len;
+}
+
+// 还原成与文本路径相同的行，便于逐字节比较
+static void on_record(void *ctx, const BinlogRecord *rec)
+{
+    (void)ctx;
+    if (strcmp(rec->entry->module, "demo") != 0 || strchr("EWI", rec->entry->level) == NULL ||
+        rec->timestamp % 5 != 0) {
+        dec_bad_meta++;
+    }
+    dec_len += (uint32_t)sprintf(dec_text + dec_len, "%s\r\n", rec->message);
+}
+
+static void decode(const BinlogTable *t, const uint8_t *data, uint32_t len, uint32_t chunk, BinlogDecode_Stats *stats)
+{
+    BinlogDecoder dec;
+    BinlogSink sink = { on_text, on_record, NULL };
+
+    dec_len = 0;
+    BinlogDecode_Init(&dec, t, &sink);
+    for (uint32_t off = 0; off < len; off += chunk) {
+        BinlogDecode_Feed(&dec, data + off, len - off < chunk ? len - off : chunk);
+    }
+    BinlogDecode_Flush(&dec);
+    *stats = dec.stats;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main(void)
+{
+    static uint8_t text[OUT_SIZE], bin[OUT_SIZE];
+    uint32_t text_len, bin_len;
+    BinlogTable table, loaded;
+    BinlogDecode_Stats st;
+    Log_Stats ls;
+    int has_debug = 0;
+
+    Log_Init(out_write, demo_clock);
+
+    // 1. 两种输出
+    out_len = 0;
+    for (uint32_t i = 0; i < VERIFY_ROUNDS; i++) {
+        emit(0, i);
+    }
+    memcpy(text, out_buf, out_len);
+    text_len = out_len;
+    out_len = 0;
+    for (uint32_t i = 0; i < VERIFY_ROUNDS; i++) {
+        emit(1, i);
+    }
+    memcpy(bin, out_buf, out_len);
+    bin_len = out_len;
+    Log_GetStats(&ls);
+    printf("%u rounds x 5 lines: text %u B, binary %u B (%.1f%%), %u records\n",
+           VERIFY_ROUNDS, (unsigned)text_len, (unsigned)bin_len, 100.0 * bin_len / text_len, (unsigned)ls.records);
+    check(ls.records == VERIFY_ROUNDS * 5 && ls.dropped == 0, "every record written");
+
+    // 2. 字符串表
+    check(BinlogTable_LoadElf(&table, "/proc/self/exe") == 0, "logstr section found in own image");
+    printf("string table: %u entries\n", (unsigned)table.count);
+    for (uint32_t i = 0; i < table.count; i++) {
+        printf("  %4u  %c|%s|%s\n", (unsigned)table.entries[i].id, table.entries[i].level,
+               table.entries[i].module, table.entries[i].fmt);
+        has_debug |= table.entries[i].level == 'D';
+    }
+    check(table.count == 5, "five enabled call sites in the table");
+    check(!has_debug && debug_evals == 0, "LOG_DEBUG compiled out: no string, argument not evaluated");
+
+    // 3. 解码与文本路径一致（整块输入和逐字节输入）
+    decode(&table, bin, bin_len, bin_len, &st);
+    check(st.records == VERIFY_ROUNDS * 5 && st.skipped == 0 && dec_bad_meta == 0, "all records decoded");
+    check(dec_len == text_len && memcmp(dec_text, text, text_len) == 0, "decoded text matches printf text");
+    decode(&table, bin, bin_len, 1, &st);
+    check(dec_len == text_len && memcmp(dec_text, text, text_len) == 0, "byte-by-byte feed gives the same text");
+
+    // 4. 字符串表文件往返
+    check(BinlogTable_Save(&table, "binlog_table.txt") == 0 && BinlogTable_Load(&loaded, "binlog_table.txt") == 0,
+          "table saved and loaded");
+    decode(&loaded, bin, bin_len, 7, &st);
+    check(dec_len == text_len && memcmp(dec_text, text, text_len) == 0, "decoding with the saved table");
+    BinlogTable_Free(&loaded);
+
+    // 5. 混合文本和损坏的字节
+    {
+        static const char plain[] = "plain printf text\r\n";
+        static uint8_t mixed[256];
+        uint32_t one = 7 + 4;              // 第一条记录（计步，1 个参数）
+        uint32_t n = 0;
+
+        memcpy(mixed + n, plain, sizeof(plain) - 1);
+        n += sizeof(plain) - 1;
+        memcpy(mixed + n, bin, one);
+        n += one;
+        mixed[n++] = 0xFB;                 // 半条记录：传输中丢了后面的字节
+        mixed[n++] = 0x12;
+        memcpy(mixed + n, bin, one);
+        n += one;
+        decode(&table, mixed, n, 3, &st);
+        dec_text[dec_len] = '\0';
+        printf("mixed stream: %u records, %u text bytes, %u bytes skipped\n",
+               (unsigned)st.records, (unsigned)st.text_bytes, (unsigned)st.skipped);
+        check(st.records == 2 && st.skipped >= 1, "resync after a damaged record");
+        check(strncmp(dec_text, plain, sizeof(plain) - 1) == 0, "plain text passed through");
+        check(strstr(dec_text, "Step detected! Total steps: 1000\r\n") != NULL, "record after text decoded");
+    }
+    BinlogTable_Free(&table);
+
+    // 6. 开销：调用方耗时（主机上测量，只用于比较）和串口时间
+    {
+        double t0, t_text, t_bin;
+        uint32_t text_bytes, bin_bytes;
+
+        out_wrap = 1;
+        out_total = 0;
+        t0 = now_us();
+        for (uint32_t i = 0; i < BENCH_ROUNDS; i++) {
+            emit(0, i);
+        }
+        t_text = now_us() - t0;
+        text_bytes = out_total;
+        out_total = 0;
+        t0 = now_us();
+        for (uint32_t i = 0; i < BENCH_ROUNDS; i++) {
+            emit(1, i);
+        }
+        t_bin = now_us() - t0;
+        bin_bytes = out_total;
+
+        printf("\n%u lines per path\n", BENCH_ROUNDS * 5);
+        printf("  %-26s %12s %14s %18s\n", "", "ns per line", "bytes per line", "UART us per line");
+        printf("  %-26s %12.1f %14.1f %18.1f\n", "printf text", t_text * 1000 / (BENCH_ROUNDS * 5),
+               (double)text_bytes / (BENCH_ROUNDS * 5), BYTE_US * text_bytes / (BENCH_ROUNDS * 5));
+        printf("  %-26s %12.1f %14.1f %18.1f\n", "binary record", t_bin * 1000 / (BENCH_ROUNDS * 5),
+               (double)bin_bytes / (BENCH_ROUNDS * 5), BYTE_US * bin_bytes / (BENCH_ROUNDS * 5));
+        check(bin_bytes * 2 < text_bytes, "binary records less than half the bytes");
+        check(t_bin < t_text, "binary records cheaper to produce than formatted text");
+    }
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
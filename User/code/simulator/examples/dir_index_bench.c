@@ -0,0 +1,343 @@
+// dir_index_bench.c - 文件浏览翻页：每页 f_readdir 重扫与 dir_index.c 排序索引的对比
+//
+// 在空白模拟 W25Q128 上建 0:/LOGS，按打乱的顺序写入 FILES 个日志文件（再放几个非 .CSV 文件），然后：
+//   1. 每页 f_opendir + 跳过前面的项 + 读 3 项（file_browser 若不用索引就是这样翻页，且顺序是物理顺序）
+//   2. 建索引（f_findfirst/f_findnext + 排序）一次，之后翻页只读 RAM 表
+//   3. 追加一个文件、新建一个、删除一个后，增量刷新与整目录重扫的开销
+// 统计 disk_read 次数（含读缓存命中）、实际读 Flash 的扇区数和模拟耗时。
+// 最后检查索引与目录内容一致（排序、大小、模式过滤、容量截断、按名查找），失败打印 FAIL。
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ff.h"
+#include "diskio_cache.h"
+#include "storage_service.h"
+#include "dir_index.h"
+#include "w25q128_sim.h"
+#include "spi.h"
+
+#define FILES           400
+#define ROWS            3       // 与 FILE_BROWSER_ROWS 相同
+#define LOG_DIR         "0:/logs"
+#define SMALL_CAPACITY  50
+
+static FATFS fs;
+static BYTE work[FF_MAX_SS];
+static DirIndexEntry entries[FILES + 16];
+static DirIndexEntry small_entries[SMALL_CAPACITY];
+static uint32_t file_size[FILES];
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+typedef struct {
+    uint32_t reads;     ///< disk_read 调用（缓存命中 + 未命中）
+    uint32_t flash;     ///< 实际读 Flash 的扇区数
+    uint64_t us;
+} Cost;
+
+static Cost cost_start;
+
+static void cost_begin(void)
+{
+    DiskCache_Stats cs;
+    W25Q128_Sim_Stats st;
+
+    disk_cache_get_stats(&cs);
+    W25Q128_Sim_GetStats(&st);
+    cost_start.reads = cs.hits + cs.misses;
+    cost_start.flash = (uint32_t)(st.bytes_read / FF_MAX_SS);
+    cost_start.us = W25Q128_Sim_Time_us();
+}
+
+static Cost cost_end(void)
+{
+    DiskCache_Stats cs;
+    W25Q128_Sim_Stats st;
+    Cost c;
+
+    disk_cache_get_stats(&cs);
+    W25Q128_Sim_GetStats(&st);
+    c.reads = cs.hits + cs.misses - cost_start.reads;
+    c.flash = (uint32_t)(st.bytes_read / FF_MAX_SS) - cost_start.flash;
+    c.us = W25Q128_Sim_Time_us() - cost_start.us;
+    return c;
+}
+
+static void log_name(uint32_t i, char *path, size_t len)
+{
+    snprintf(path, len, LOG_DIR "/log%05lu.csv", (unsigned long)i);
+}
+
+static FRESULT populate(void)
+{
+    static uint8_t data[2048];
+    uint32_t order[FILES];
+    uint32_t seed = 7;
+    char path[32];
+    FRESULT fr;
+
+    memset(data, 'x', sizeof(data));
+    for (uint32_t i = 0; i < FILES; i++) {
+        order[i] = i;
+    }
+    for (uint32_t i = FILES - 1; i > 0; i--) {
+        uint32_t j, t;
+        seed = seed * 1103515245u + 12345u;
+        j = (seed >> 8) % (i + 1);
+        t = order[i]; order[i] = order[j]; order[j] = t;
+    }
+
+    fr = f_mkdir(LOG_DIR);
+    for (uint32_t k = 0; k < FILES && fr == FR_OK; k++) {
+        uint32_t i = order[k];
+        FIL f;
+        UINT bw;
+
+        file_size[i] = (i * 37) % sizeof(data);
+        log_name(i, path, sizeof(path));
+        fr = f_open(&f, path, FA_CREATE_ALWAYS | FA_WRITE);
+        if (fr == FR_OK) {
+            fr = f_write(&f, data, file_size[i], &bw);
+            f_close(&f);
+        }
+    }
+    // 不匹配 "*.CSV" 的文件和一个子目录
+    if (fr == FR_OK) {
+        fr = f_mkdir(LOG_DIR "/old");
+    }
+    for (uint32_t k = 0; k < 4 && fr == FR_OK; k++) {
+        FIL f;
+        snprintf(path, sizeof(path), LOG_DIR "/note%lu.txt", (unsigned long)k);
+        fr = f_open(&f, path, FA_CREATE_ALWAYS | FA_WRITE);
+        if (fr == FR_OK) {
+            f_close(&f);
+        }
+    }
+    return fr;
+}
+
+// 不用索引时显示第 page 页：从头读目录，跳过前面的项
+static FRESULT readdir_page(uint32_t page, uint32_t *shown)
+{
+    DIR dir;
+    FILINFO fno;
+    FRESULT fr = f_opendir(&dir, LOG_DIR);
+    uint32_t n = 0;
+
+    *shown = 0;
+    while (fr == FR_OK) {
+        fr = f_readdir(&dir, &fno);
+        if (fr != FR_OK || fno.fname[0] == '\0') {
+            break;
+        }
+        if (n++ >= page * ROWS && ++*shown == ROWS) {
+            break;
+        }
+    }
+    f_closedir(&dir);
+    return fr;
+}
+
+static void bench_paging(DirIndex *idx)
+{
+    uint32_t pages = (FILES + 5 + ROWS - 1) / ROWS;
+    uint64_t worst = 0;
+    uint32_t shown, total_shown = 0;
+    Cost c;
+
+    cost_begin();
+    for (uint32_t p = 0; p < pages; p++) {
+        uint64_t t0 = W25Q128_Sim_Time_us();
+        check(readdir_page(p, &shown) == FR_OK, "f_readdir page");
+        total_shown += shown;
+        if (W25Q128_Sim_Time_us() - t0 > worst) {
+            worst = W25Q128_Sim_Time_us() - t0;
+        }
+    }
+    c = cost_end();
+    check(total_shown == FILES + 5, "f_readdir paging covered the directory");
+    printf("  f_readdir per page   %3lu pages  disk_read %6lu  flash reads %5lu  "
+           "%8.1f ms total  %6.2f ms/page  last page %6.2f ms  (physical order)\n",
+           (unsigned long)pages, (unsigned long)c.reads, (unsigned long)c.flash,
+           c.us / 1000.0, c.us / 1000.0 / pages, worst / 1000.0);
+
+    cost_begin();
+    check(DirIndex_Refresh(idx) == FR_OK, "index build");
+    c = cost_end();
+    printf("  index build          %3s        disk_read %6lu  flash reads %5lu  "
+           "%8.1f ms once     (%u entries x %u B = %lu B)\n",
+           "", (unsigned long)c.reads, (unsigned long)c.flash, c.us / 1000.0,
+           idx->count, (unsigned)sizeof(DirIndexEntry), (unsigned long)idx->count * sizeof(DirIndexEntry));
+
+    cost_begin();
+    total_shown = 0;
+    for (uint32_t p = 0; p < pages; p++) {
+        char name[DIR_INDEX_DISPLAY_LEN];
+        for (uint32_t r = 0; r < ROWS; r++) {
+            const DirIndexEntry *e = DirIndex_Get(idx, (uint16_t)(p * ROWS + r));
+            if (e != NULL) {
+                DirIndex_FormatName(e, name);
+                total_shown++;
+            }
+        }
+        check(!DirIndex_Stale(idx), "index stale without changes");
+    }
+    c = cost_end();
+    check(total_shown == idx->count && c.reads == 0, "index paging without storage access");
+    printf("  index per page       %3lu pages  disk_read %6lu  flash reads %5lu  "
+           "%8.1f ms total  (sorted)\n",
+           (unsigned long)pages, (unsigned long)c.reads, (unsigned long)c.flash, c.us / 1000.0);
+}
+
+// 索引与目录实际内容比较
+static int index_matches(DirIndex *idx)
+{
+    DirIndexEntry fresh_buf[FILES + 16];
+    DirIndex fresh;
+
+    DirIndex_Init(&fresh, idx->path, idx->pattern, fresh_buf, FILES + 16);
+    if (DirIndex_Rescan(&fresh) != FR_OK || fresh.count != idx->count) {
+        return 0;
+    }
+    for (uint16_t i = 0; i < idx->count; i++) {
+        if (memcmp(idx->entries[i].name, fresh.entries[i].name, DIR_INDEX_NAME_LEN) != 0 ||
+            idx->entries[i].size != fresh.entries[i].size ||
+            idx->entries[i].hash != fresh.entries[i].hash ||
+            idx->entries[i].attr != fresh.entries[i].attr) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void bench_incremental(DirIndex *idx)
+{
+    const char line[] = "12:00:00,1234,56\n";
+    char path[32];
+    UINT n;
+    FIL f;
+    Cost inc, stat, full;
+
+    // 存储服务的写请求关闭文件时登记大小；直接 f_unlink 的地方自己登记
+    log_name(123, path, sizeof(path));
+    check(Storage_Write(path, STORAGE_OFFSET_END, line, sizeof(line) - 1, &n) == FR_OK, "append");
+    check(Storage_Write(LOG_DIR "/log99999.csv", 0, line, sizeof(line) - 1, &n) == FR_OK, "create");
+    log_name(7, path, sizeof(path));
+    check(f_unlink(path) == FR_OK, "unlink");
+    DirIndex_NotifyRemoved(path);
+
+    check(DirIndex_Stale(idx), "index stale after changes");
+    cost_begin();
+    check(DirIndex_Refresh(idx) == FR_OK, "incremental refresh");
+    inc = cost_end();
+    check(idx->stats.full_scans == 1 && idx->stats.updates == 3 && idx->stats.stat_calls == 0,
+          "refresh was incremental");
+    check(index_matches(idx), "index after incremental refresh");
+    check(idx->entries[DirIndex_Find(idx, "log00123.csv")].size == file_size[123] + sizeof(line) - 1,
+          "appended size");
+    check(DirIndex_Find(idx, "LOG99999.CSV") >= 0, "created file found");
+    check(DirIndex_Find(idx, "log00007.csv") < 0, "deleted file gone");
+
+    // 只登记路径：刷新时 f_stat，从目录开头找到该文件
+    log_name(FILES - 1, path, sizeof(path));
+    check(f_open(&f, path, FA_OPEN_APPEND | FA_WRITE) == FR_OK, "open last");
+    check(f_write(&f, line, sizeof(line) - 1, &n) == FR_OK && f_close(&f) == FR_OK, "append last");
+    file_size[FILES - 1] += sizeof(line) - 1;
+    DirIndex_Notify(path);
+    cost_begin();
+    check(DirIndex_Refresh(idx) == FR_OK && idx->stats.stat_calls == 1, "refresh with f_stat");
+    stat = cost_end();
+    check(index_matches(idx), "index after f_stat refresh");
+
+    cost_begin();
+    check(DirIndex_Rescan(idx) == FR_OK, "rescan");
+    full = cost_end();
+    printf("  3 changes, size known  disk_read %4lu  flash reads %4lu  %6.2f ms\n",
+           (unsigned long)inc.reads, (unsigned long)inc.flash, inc.us / 1000.0);
+    printf("  1 change, f_stat       disk_read %4lu  flash reads %4lu  %6.2f ms\n",
+           (unsigned long)stat.reads, (unsigned long)stat.flash, stat.us / 1000.0);
+    printf("  full rescan            disk_read %4lu  flash reads %4lu  %6.2f ms\n",
+           (unsigned long)full.reads, (unsigned long)full.flash, full.us / 1000.0);
+
+    // 变更多于记录环长度时退回整目录重扫
+    for (int i = 0; i < DIR_INDEX_PENDING + 1; i++) {
+        DirIndex_Notify(LOG_DIR "/log00001.csv");
+    }
+    check(DirIndex_Refresh(idx) == FR_OK && idx->stats.full_scans == 3, "overflow falls back to rescan");
+}
+
+static void check_index(void)
+{
+    DirIndex all, csv, small;
+    char prev[DIR_INDEX_NAME_LEN];
+
+    // 模式 "*"：子目录排在最前，其余按名字排序
+    DirIndex_Init(&all, LOG_DIR, NULL, entries, FILES + 16);
+    check(DirIndex_Refresh(&all) == FR_OK && all.count == FILES + 5, "index '*'");
+    check(all.count > 0 && (all.entries[0].attr & AM_DIR) != 0, "directory first");
+    memset(prev, 0, sizeof(prev));
+    for (uint16_t i = 1; i < all.count; i++) {
+        check(memcmp(prev, all.entries[i].name, DIR_INDEX_NAME_LEN) < 0, "sorted");
+        memcpy(prev, all.entries[i].name, DIR_INDEX_NAME_LEN);
+    }
+
+    // 模式 "*.CSV"，另一个目录写法
+    DirIndex_Init(&csv, "0:LOGS/", "*.CSV", entries, FILES + 16);
+    check(DirIndex_Refresh(&csv) == FR_OK && csv.count == FILES, "index '*.CSV'");
+    for (uint32_t i = 0; i < FILES; i += 37) {
+        char name[16];
+        int k;
+        snprintf(name, sizeof(name), "log%05lu.csv", (unsigned long)i);
+        k = DirIndex_Find(&csv, name);
+        check(k >= 0 && csv.entries[k].size == file_size[i], "find + size");
+    }
+    DirIndex_Notify(LOG_DIR "/note9.txt");
+    check(DirIndex_Refresh(&csv) == FR_OK && csv.stats.updates == 0, "pattern filters changes");
+
+    // 容量不足：截断，删除后整目录重扫补上
+    DirIndex_Init(&small, LOG_DIR, "*.CSV", small_entries, SMALL_CAPACITY);
+    check(DirIndex_Refresh(&small) == FR_OK && small.count == SMALL_CAPACITY && small.truncated, "truncated");
+}
+
+int main(void)
+{
+    DirIndex idx;
+
+    W25Q128_Sim_Open(NULL);
+    {
+        MKFS_PARM opt = {0};
+        // 与固件 storage_service.c 相同的格式化参数
+        opt.fmt = FM_ANY | FM_SFD;
+        opt.au_size = W25Q128_SECTOR_SIZE;
+        opt.n_fat = 1;
+        opt.n_root = 128;
+        if (f_mkfs("0:", &opt, work, sizeof(work)) != FR_OK || f_mount(&fs, "0:", 1) != FR_OK) {
+            printf("format failed\n");
+            return 1;
+        }
+    }
+    disk_cache_pin_fat(&fs);
+    if (populate() != FR_OK) {
+        printf("populate failed\n");
+        return 1;
+    }
+
+    printf("file browser on " LOG_DIR ", %d log files + 5 others, %d rows per page\n\n", FILES, ROWS);
+    DirIndex_Init(&idx, LOG_DIR, "*", entries, FILES + 16);
+    bench_paging(&idx);
+    bench_incremental(&idx);
+    check_index();
+
+    f_mount(NULL, "0:", 0);
+    W25Q128_Sim_Close();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
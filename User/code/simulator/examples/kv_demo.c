@@ -0,0 +1,138 @@
+// kv_demo.c - KV 存储耗时/磨损演示，并与 FatFs 文件保存对比
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "ff.h"
+#include "w25q128_sim.h"
+#include "spi.h"
+#include "flash_layout.h"
+#include "kv_store.h"
+
+#define SAVE_COUNT        2000    // 模拟 2000 次步数保存
+#define KV_KEY_DEMO_STEPS 0x0F00  // 演示用的步数键（固件的步数保存在 A/B 记录中）
+#define KV_KEY_DEMO       0x0F01  // 演示用的 BLOB 键
+
+static FATFS fs;
+static BYTE work[FF_MAX_SS];
+
+static uint32_t lat_us[SAVE_COUNT];
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// 排序后打印平均值与分位数
+static void print_latency(const char *label, uint32_t *v, uint32_t n)
+{
+    uint64_t sum = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        sum += v[i];
+    }
+    qsort(v, n, sizeof(v[0]), cmp_u32);
+    printf("%-22s avg %8.3f ms  p50 %8.3f  p99 %8.3f  max %8.3f\n", label,
+           sum / 1000.0 / n, v[n / 2] / 1000.0, v[n * 99 / 100] / 1000.0, v[n - 1] / 1000.0);
+}
+
+static void bench_kv(void)
+{
+    W25Q128_Sim_Stats st;
+
+    W25Q128_Sim_ResetStats();
+    for (uint32_t i = 0; i < SAVE_COUNT; i++) {
+        uint64_t t0 = W25Q128_Sim_Time_us();
+        KV_SetU32(KV_KEY_DEMO_STEPS, 1000 + i * 10);
+        lat_us[i] = (uint32_t)(W25Q128_Sim_Time_us() - t0);
+    }
+    print_latency("KV_SetU32", lat_us, SAVE_COUNT);
+    W25Q128_Sim_GetStats(&st);
+    printf("  %u page programs, %u sector erases, KV sector erase counts %u/%u\n",
+           st.page_programs, st.sector_erases,
+           W25Q128_Sim_EraseCount(FLASH_KV_BASE / W25Q128_SECTOR_SIZE),
+           W25Q128_Sim_EraseCount(FLASH_KV_BASE / W25Q128_SECTOR_SIZE + 1));
+}
+
+// 对比：旧的 steps.dat 方式，每次 f_open/f_write/f_close
+static void bench_fatfs(void)
+{
+    W25Q128_Sim_Stats st;
+    FIL f;
+    UINT bw;
+
+    W25Q128_Sim_ResetStats();
+    for (uint32_t i = 0; i < SAVE_COUNT; i++) {
+        uint32_t v[4] = {1000 + i * 10, i, i, 0};
+        uint64_t t0 = W25Q128_Sim_Time_us();
+        if (f_open(&f, "0:kvdemo.dat", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK) {
+            f_write(&f, v, sizeof(v), &bw);
+            f_close(&f);
+        }
+        lat_us[i] = (uint32_t)(W25Q128_Sim_Time_us() - t0);
+    }
+    f_unlink("0:kvdemo.dat");
+    print_latency("FatFs steps.dat", lat_us, SAVE_COUNT);
+    W25Q128_Sim_GetStats(&st);
+    printf("  %u page programs, %u sector erases\n", st.page_programs, st.sector_erases);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *image = argc > 1 ? argv[1] : NULL;
+    uint8_t blob[64], check[64];
+    uint16_t len;
+    uint32_t value;
+    int ret;
+
+    printf("KV store demo, image: %s\n", image ? image : "(blank, in memory)");
+    W25Q128_Sim_Open(image);
+
+    ret = KV_Init();
+    printf("KV_Init: %d\n", ret);
+    KV_PrintStats();
+
+    bench_kv();
+
+    // 混合键与删除，随后强制压缩
+    for (uint32_t i = 0; i < sizeof(blob); i++) {
+        blob[i] = (uint8_t)(i * 7);
+    }
+    KV_Set(KV_KEY_DEMO, KV_TYPE_BLOB, blob, sizeof(blob));
+    KV_Set(0x0F02, KV_TYPE_STRING, "hello", 5);
+    KV_Delete(0x0F02);
+    KV_Compact();
+
+    // 重新扫描，相当于重启
+    KV_Init();
+    KV_PrintStats();
+    ret = KV_GetU32(KV_KEY_DEMO_STEPS, &value);
+    printf("after reboot: steps %lu (ret %d, expect %u)\n", (unsigned long)value, ret, 1000 + (SAVE_COUNT - 1) * 10);
+    ret = KV_Get(KV_KEY_DEMO, KV_TYPE_BLOB, check, sizeof(check), &len);
+    printf("after reboot: blob %s (ret %d, len %u)\n",
+           ret == KV_OK && len == sizeof(blob) && memcmp(blob, check, len) == 0 ? "ok" : "MISMATCH", ret, len);
+    printf("after reboot: deleted key %s\n",
+           KV_Get(0x0F02, KV_TYPE_STRING, check, sizeof(check), &len) == KV_ERR_NOT_FOUND ? "gone" : "STILL PRESENT");
+
+    // 对比 FatFs 文件保存
+    if (f_mount(&fs, "0:", 1) == FR_NO_FILESYSTEM) {
+        MKFS_PARM opt = {0};
+        opt.fmt = FM_ANY | FM_SFD;
+        opt.au_size = W25Q128_SECTOR_SIZE;
+        opt.n_fat = 1;
+        opt.n_root = 128;
+        f_mkfs("0:", &opt, work, sizeof(work));
+        f_mount(&fs, "0:", 1);
+    }
+    bench_fatfs();
+    f_mount(NULL, "0:", 0);
+
+    // FatFs 格式化与写入不能碰到 KV 分区
+    KV_Init();
+    ret = KV_GetU32(KV_KEY_DEMO_STEPS, &value);
+    printf("after FatFs: steps %lu (ret %d)\n", (unsigned long)value, ret);
+
+    W25Q128_Sim_Close();
+    return 0;
+}
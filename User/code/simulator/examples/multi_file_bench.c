@@ -0,0 +1,244 @@
+// multi_file_bench.c - 同时打开多个文件：卷窗口共用（FF_FS_TINY=1）与每文件扇区缓冲（FF_FS_TINY=0）对比
+//
+// 同一份源码编译两次：multi_file_bench 使用 ffconf.h 的默认配置（FF_FS_TINY=0），
+// multi_file_bench_tiny 整个 FatFs 栈以 -DFF_FS_TINY=1 编译。run_multi_file_bench 依次运行两者。
+//
+// 工作负载（0: W25Q128 分区，每轮每个文件各操作一次，共 ROUNDS 轮）：
+//   2 files  log.csv 追加 24 字节文本行 + cfg.bin 随机读 32 字节配置记录
+//   3 files  再加 steps.bin 追加 8 字节记录
+// 统计 disk_read 次数（含读缓存命中）、实际读 Flash 的扇区数、页编程、扇区擦除和模拟耗时。
+// 之后把 0:log.csv 边读边写复制到 SD 卡 1:log.csv（两个卷同时打开）并回读比较。
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "ff.h"
+#include "diskio_cache.h"
+#include "storage_service.h"
+#include "w25q128_sim.h"
+#include "sd_card_sim.h"
+#include "spi.h"
+
+#define ROUNDS          2000
+#define LINE_LEN        24
+#define CFG_RECORD      32
+#define CFG_SIZE        4096
+#define STEP_LEN        8
+#define SD_SECTORS      131072  // 64MB
+#define COPY_CHUNK      100
+
+static FATFS flash_fs;
+static FATFS sd_fs;
+static BYTE work[FF_MAX_SS];
+static uint8_t cfg_ref[CFG_SIZE];
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static FRESULT format_and_mount(FATFS *fs, const char *vol, DWORD au_size)
+{
+    MKFS_PARM opt = {0};
+    FRESULT fr;
+
+    // 0: 与固件 storage_service.c 相同的格式化参数；1: 按 SD 卡默认参数
+    opt.fmt = FM_ANY | (au_size != 0 ? FM_SFD : 0);
+    opt.au_size = au_size;
+    opt.n_fat = au_size != 0 ? 1 : 2;
+    opt.n_root = au_size != 0 ? 128 : 0;
+    fr = f_mkfs(vol, &opt, work, sizeof(work));
+    if (fr == FR_OK) {
+        fr = f_mount(fs, vol, 1);
+    }
+    return fr;
+}
+
+// 第 i 行日志（可复现，用于回读校验）
+static void make_line(uint32_t i, char *line)
+{
+    char tmp[48];
+
+    snprintf(tmp, sizeof(tmp), "%08lu,%05lu,%03lu,%03lu\n", (unsigned long)(i * 20),
+             (unsigned long)(i * 7 % 100000), (unsigned long)(i % 1000), (unsigned long)(i * 13 % 1000));
+    memcpy(line, tmp, LINE_LEN);
+}
+
+static void make_step(uint32_t i, uint8_t *rec)
+{
+    uint32_t t = i * 60, steps = i * 3;
+
+    memcpy(rec, &t, 4);
+    memcpy(rec + 4, &steps, 4);
+}
+
+static FRESULT create_cfg(void)
+{
+    FIL f;
+    UINT bw;
+    FRESULT fr;
+    uint32_t seed = 0x12345678;
+
+    for (uint32_t i = 0; i < CFG_SIZE; i++) {
+        seed = seed * 1103515245u + 12345u;
+        cfg_ref[i] = (uint8_t)(seed >> 16);
+    }
+    fr = f_open(&f, "0:cfg.bin", FA_CREATE_ALWAYS | FA_WRITE);
+    if (fr == FR_OK) {
+        fr = f_write(&f, cfg_ref, CFG_SIZE, &bw);
+        FRESULT fc = f_close(&f);
+        fr = fr != FR_OK ? fr : fc;
+    }
+    return fr;
+}
+
+static int verify_file(const char *path, uint32_t rounds, UINT rec_len, void (*make)(uint32_t, uint8_t *))
+{
+    FIL f;
+    UINT br;
+    uint8_t got[LINE_LEN + 1], want[LINE_LEN + 1];
+    int ok;
+
+    if (f_open(&f, path, FA_READ) != FR_OK) {
+        return 0;
+    }
+    ok = f_size(&f) == (FSIZE_t)rounds * rec_len;
+    for (uint32_t i = 0; ok && i < rounds; i++) {
+        make(i, want);
+        ok = f_read(&f, got, rec_len, &br) == FR_OK && br == rec_len && memcmp(got, want, rec_len) == 0;
+    }
+    f_close(&f);
+    return ok;
+}
+
+static void make_line_bytes(uint32_t i, uint8_t *rec)
+{
+    make_line(i, (char *)rec);
+}
+
+static void run(int files)
+{
+    FIL log, cfg, steps;
+    UINT n;
+    char line[LINE_LEN + 1];
+    uint8_t rec[CFG_RECORD];
+    uint32_t seed = 1;
+    FRESULT fr;
+    DiskCache_Stats cs;
+    W25Q128_Sim_Stats st;
+    uint64_t t0;
+
+    f_unlink("0:log.csv");
+    f_unlink("0:steps.bin");
+    disk_cache_reset_stats();
+    W25Q128_Sim_ResetStats();
+    t0 = W25Q128_Sim_Time_us();
+
+    fr = f_open(&log, "0:log.csv", FA_CREATE_ALWAYS | FA_WRITE);
+    check(fr == FR_OK, "open log.csv");
+    fr = f_open(&cfg, "0:cfg.bin", FA_READ);
+    check(fr == FR_OK, "open cfg.bin");
+    if (files >= 3) {
+        fr = f_open(&steps, "0:steps.bin", FA_CREATE_ALWAYS | FA_WRITE);
+        check(fr == FR_OK, "open steps.bin");
+    }
+
+    for (uint32_t i = 0; i < ROUNDS && failures == 0; i++) {
+        UINT off;
+
+        make_line(i, line);
+        check(f_write(&log, line, LINE_LEN, &n) == FR_OK && n == LINE_LEN, "append log.csv");
+
+        seed = seed * 1103515245u + 12345u;
+        off = (seed >> 8) % (CFG_SIZE / CFG_RECORD) * CFG_RECORD;
+        fr = f_lseek(&cfg, off);
+        if (fr == FR_OK) {
+            fr = f_read(&cfg, rec, CFG_RECORD, &n);
+        }
+        check(fr == FR_OK && n == CFG_RECORD && memcmp(rec, cfg_ref + off, CFG_RECORD) == 0, "read cfg.bin");
+
+        if (files >= 3) {
+            make_step(i, rec);
+            check(f_write(&steps, rec, STEP_LEN, &n) == FR_OK && n == STEP_LEN, "append steps.bin");
+        }
+    }
+
+    check(f_close(&log) == FR_OK, "close log.csv");
+    f_close(&cfg);
+    if (files >= 3) {
+        check(f_close(&steps) == FR_OK, "close steps.bin");
+    }
+
+    disk_cache_get_stats(&cs);
+    W25Q128_Sim_GetStats(&st);
+    printf("  %d files  disk_read %6lu  flash reads %6lu sectors  programs %6lu  erases %5lu  "
+           "%8.2f s  %6.2f ms/round\n",
+           files, (unsigned long)(cs.hits + cs.misses), (unsigned long)(st.bytes_read / FF_MAX_SS),
+           (unsigned long)st.page_programs, (unsigned long)st.sector_erases,
+           (W25Q128_Sim_Time_us() - t0) / 1e6, (W25Q128_Sim_Time_us() - t0) / 1e3 / ROUNDS);
+
+    check(verify_file("0:log.csv", ROUNDS, LINE_LEN, make_line_bytes), "log.csv contents");
+    if (files >= 3) {
+        check(verify_file("0:steps.bin", ROUNDS, STEP_LEN, make_step), "steps.bin contents");
+    }
+}
+
+// 两个卷上各开一个文件交替读写：0:log.csv → 1:log.csv
+static void copy_to_sd(void)
+{
+    FIL src, dst;
+    uint8_t buf[COPY_CHUNK];
+    UINT br, bw;
+    FRESULT fr;
+
+    SD_Sim_Insert(SD_SIM_SDHC, SD_SECTORS);
+    fr = f_mount(&sd_fs, "1:", 1);
+    if (fr == FR_NO_FILESYSTEM) {
+        fr = format_and_mount(&sd_fs, "1:", 0);
+    }
+    check(fr == FR_OK, "mount 1: (SD)");
+    if (fr != FR_OK) {
+        return;
+    }
+
+    check(f_open(&src, "0:log.csv", FA_READ) == FR_OK, "open 0:log.csv");
+    check(f_open(&dst, "1:log.csv", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK, "open 1:log.csv");
+    do {
+        fr = f_read(&src, buf, sizeof(buf), &br);
+        if (fr == FR_OK && br > 0) {
+            fr = f_write(&dst, buf, br, &bw);
+        }
+    } while (fr == FR_OK && br == sizeof(buf));
+    check(fr == FR_OK, "copy to SD");
+    f_close(&src);
+    check(f_close(&dst) == FR_OK, "close 1:log.csv");
+    check(verify_file("1:log.csv", ROUNDS, LINE_LEN, make_line_bytes), "1:log.csv contents");
+    printf("  copied 0:log.csv -> 1:log.csv (%lu bytes)\n", (unsigned long)ROUNDS * LINE_LEN);
+    f_mount(NULL, "1:", 0);
+}
+
+int main(void)
+{
+    W25Q128_Sim_Open(NULL);
+    if (format_and_mount(&flash_fs, "0:", W25Q128_SECTOR_SIZE) != FR_OK || create_cfg() != FR_OK) {
+        printf("format failed\n");
+        return 1;
+    }
+    disk_cache_pin_fat(&flash_fs);
+
+    Storage_PrintMemory();
+    printf("\nconcurrent files, %d rounds (%s)\n", ROUNDS,
+           FF_FS_TINY ? "FF_FS_TINY=1, shared volume window" : "FF_FS_TINY=0, per-file sector buffers");
+    run(2);
+    run(3);
+    copy_to_sd();
+
+    f_mount(NULL, "0:", 0);
+    W25Q128_Sim_Close();
+    SD_Sim_Eject();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,525 @@
+// oled_mirror_bench.c - OLED 镜像：压缩、增量发送、丢帧后同步的一致性检查与串口字节数对比
+//
+// 1. RLE：1~128 个字节的随机数据和长游程往返，输出长度上界；截断或越界的记录被拒绝
+// 2. 四种典型界面（时钟、菜单光标移动、整屏滚动、遥测数值），与固件同一份 oled_mirror.c、
+//    telemetry.c 和 crc.c：模拟显存按 oled.c 的布局绘制，每次 OLED_Refresh_Area 之后调用镜像
+//    （与 ui/screen_mirror.c 相同，每 5 秒整屏重发），帧经 COBS/CRC 编码后由 telem_decode.c 接收、
+//    oled_replay.c 还原。每次刷新后上位机画面与设备显存逐字节相同；
+//    打印每次刷新的串口字节数，与整屏刷新（1024 字节）和按刷新区域不压缩发送对比
+// 3. 设备端丢帧（发送缓冲区满）：下一次刷新整屏重发，上位机在此之前标记画面过期
+// 4. 链路丢帧（设备不知道）：上位机按序号发现丢帧，标记过期直到下一次定期整屏重发
+// 5. 回放文件：录制的 .rpl 离线重放后画面与设备相同
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "telemetry.h"
+#include "telem_decode.h"
+#include "oled_mirror.h"
+#include "oled_replay.h"
+
+#define KEY_MS          5000            // 与 SCREEN_MIRROR_KEY_MS 相同
+#define MIRROR_CH       3               // 与 SCREEN_MIRROR_CH 相同
+#define FULL_WIRE       (OLED_MIRROR_GRAM_SIZE + 5 * OLED_REPLAY_WIRE_EXTRA)   // 整屏不压缩，5 帧
+#define REPLAY_PATH     "oled_mirror_bench.rpl"
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static uint32_t rnd(uint32_t *s)
+{
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 8;
+}
+
+// =============================================================================
+// 设备：显存（与 oled.c 相同的列优先布局）、刷新和镜像
+// =============================================================================
+
+static uint8_t gram[OLED_MIRROR_GRAM_SIZE];
+static uint32_t now;
+static OledMirror mirror;
+static TelemChannel mirror_ch;
+static uint32_t last_key;
+
+// 链路：drop_every 模拟设备端发送缓冲区满（输出返回 0），lose_every 模拟链路丢帧（设备不知道）
+static uint32_t drop_every, lose_every, out_frames, link_lost;
+static uint8_t last_delivered;
+static TelemReceiver rx;
+static OledScreen screen;
+static FILE *replay;
+
+static void on_frame(void *ctx, const TelemRxChannel *ch, uint8_t seq, uint32_t t_ms,
+                     const uint8_t *payload, uint32_t len)
+{
+    (void)ctx;
+    if (ch->id != MIRROR_CH) {
+        return;
+    }
+    OledScreen_Frame(&screen, seq, t_ms, payload, len);
+    if (replay != NULL) {
+        OledReplay_Write(replay, t_ms, seq, payload, len);
+    }
+}
+
+static uint32_t link_out(const uint8_t *data, uint32_t len)
+{
+    out_frames++;
+    if (drop_every != 0 && out_frames % drop_every == 0) {
+        last_delivered = 0;
+        return 0;
+    }
+    if (lose_every != 0 && out_frames % lose_every == 0) {
+        link_lost++;
+        last_delivered = 0;
+        return len;
+    }
+    TelemRx_Feed(&rx, data, len);
+    last_delivered = 1;
+    return len;
+}
+
+static uint32_t mirror_send(void *ctx, const uint8_t *data, uint32_t len)
+{
+    (void)ctx;
+    return Telem_SendBlock(&mirror_ch, now, data, len);
+}
+
+// 与 screen_mirror.c 的 mirror_hook 相同
+static void mirror_hook(uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2)
+{
+    if (now - last_key >= KEY_MS) {
+        last_key = now;
+        Telem_Announce(&mirror_ch);
+        OledMirror_Key(&mirror, gram);
+    } else {
+        OledMirror_Update(&mirror, gram, x1, page1, x2, page2);
+    }
+}
+
+static void device_reset(void)
+{
+    static const TelemRxSink sink = { NULL, NULL, NULL, NULL, on_frame };
+
+    memset(gram, 0, sizeof(gram));
+    now = 0;
+    out_frames = link_lost = 0;
+    Telem_Init(link_out, 0);
+    Telem_ChannelInit(&mirror_ch, MIRROR_CH, "oled", "B", "rec", 1, 1, 0);
+    OledMirror_Init(&mirror, mirror_send, NULL);
+    last_key = now - KEY_MS;
+    TelemRx_Init(&rx, &sink);
+    OledScreen_Init(&screen);
+}
+
+static void pixel(uint32_t x, uint32_t y, int on)
+{
+    uint8_t *b = &gram[x * OLED_MIRROR_STRIDE + y / 8];
+
+    *b = (uint8_t)(on ? *b | 1u << (y % 8) : *b & ~(1u << (y % 8)));
+}
+
+// 刷新区域（像素坐标，含），与 OLED_Refresh_Area 相同按页对齐后调用镜像
+static uint32_t dirty_x1 = 127, dirty_y1 = 63, dirty_x2, dirty_y2, dirty;
+
+static void mark(uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2)
+{
+    if (!dirty) {
+        dirty_x1 = x1; dirty_y1 = y1; dirty_x2 = x2; dirty_y2 = y2;
+        dirty = 1;
+        return;
+    }
+    if (x1 < dirty_x1) dirty_x1 = x1;
+    if (y1 < dirty_y1) dirty_y1 = y1;
+    if (x2 > dirty_x2) dirty_x2 = x2;
+    if (y2 > dirty_y2) dirty_y2 = y2;
+}
+
+static void refresh_dirty(void)
+{
+    if (dirty) {
+        mirror_hook((uint8_t)dirty_x1, (uint8_t)(dirty_y1 / 8), (uint8_t)dirty_x2, (uint8_t)(dirty_y2 / 8));
+        dirty = 0;
+    }
+}
+
+// 6x8 字符：每个字符一个固定的伪随机字形，最后一列空白
+static void draw_char(uint32_t x, uint32_t y, char c)
+{
+    for (uint32_t k = 0; k < 6; k++) {
+        uint8_t col = k < 5 ? (uint8_t)(((uint8_t)c * 37u + k * 101u) % 127u) : 0;
+
+        if (c == ' ') {
+            col = 0;
+        }
+        for (uint32_t b = 0; b < 8; b++) {
+            pixel(x + k, y + b, col >> b & 1);
+        }
+    }
+}
+
+static void draw_text(uint32_t x, uint32_t y, const char *s)
+{
+    uint32_t x0 = x;
+
+    for (; *s != '\0' && x + 6 <= OLED_MIRROR_COLS; s++, x += 6) {
+        draw_char(x, y, *s);
+    }
+    if (x > x0) {
+        mark(x0, y, x - 1, y + 7);
+    }
+}
+
+static void fill_rect(uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2, int on)
+{
+    for (uint32_t x = x1; x <= x2; x++) {
+        for (uint32_t y = y1; y <= y2; y++) {
+            pixel(x, y, on);
+        }
+    }
+    mark(x1, y1, x2, y2);
+}
+
+static void invert_rect(uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2)
+{
+    for (uint32_t x = x1; x <= x2; x++) {
+        for (uint32_t y = y1; y <= y2; y++) {
+            gram[x * OLED_MIRROR_STRIDE + y / 8] ^= (uint8_t)(1u << (y % 8));
+        }
+    }
+    mark(x1, y1, x2, y2);
+}
+
+static void clear_refresh(void)
+{
+    memset(gram, 0, sizeof(gram));
+    mirror_hook(0, 0, OLED_MIRROR_COLS - 1, OLED_MIRROR_PAGES - 1);     // OLED_Clear 刷新整屏
+}
+
+// =============================================================================
+// 界面
+// =============================================================================
+
+typedef struct {
+    const char *name;
+    uint32_t    steps;
+    uint32_t    step_ms;
+    void      (*setup)(void);
+    void      (*step)(uint32_t i);
+} Scene;
+
+static void clock_setup(void)
+{
+    draw_text(0, 0, "Clock");
+    draw_text(0, 40, "Alarm 07:30");
+}
+
+// 每秒更新时间和秒进度条
+static void clock_step(uint32_t i)
+{
+    char s[16];
+
+    snprintf(s, sizeof(s), "12:%02u:%02u", (unsigned)(34 + i / 60) % 60, (unsigned)i % 60);
+    draw_text(16, 16, s);
+    fill_rect(0, 58, 127, 63, 0);
+    fill_rect(0, 58, (i % 60) * 2 + 1, 63, 1);
+}
+
+static void menu_setup(void)
+{
+    static const char *items[] = { "Steps", "Alarm", "Stopwatch", "Telemetry", "Files" };
+
+    for (uint32_t k = 0; k < 5; k++) {
+        draw_text(8, k * 12 + 2, items[k]);     // 12 像素行距，跨页
+    }
+    invert_rect(0, 0, 127, 11);
+}
+
+// 光标在 5 行之间移动：旧行和新行反色
+static void menu_step(uint32_t i)
+{
+    uint32_t from = i % 5, to = (i + 1) % 5;
+
+    invert_rect(0, from * 12, 127, from * 12 + 11);
+    invert_rect(0, to * 12, 127, to * 12 + 11);
+}
+
+static void scroll_setup(void)
+{
+    for (uint32_t row = 0; row < 8; row++) {
+        char s[24];
+
+        snprintf(s, sizeof(s), "log line %u ready", (unsigned)row);
+        draw_text(0, row * 8, s);
+    }
+}
+
+// 整屏上移 1 像素，底部补新行（最差情况：每个字节都变）
+static void scroll_step(uint32_t i)
+{
+    char s[32];
+
+    for (uint32_t x = 0; x < OLED_MIRROR_COLS; x++) {
+        uint64_t col = 0;
+
+        for (uint32_t p = 0; p < OLED_MIRROR_PAGES; p++) {
+            col |= (uint64_t)gram[x * OLED_MIRROR_STRIDE + p] << (p * 8);
+        }
+        col >>= 1;
+        for (uint32_t p = 0; p < OLED_MIRROR_PAGES; p++) {
+            gram[x * OLED_MIRROR_STRIDE + p] = (uint8_t)(col >> (p * 8));
+        }
+    }
+    if (i % 8 == 7) {
+        snprintf(s, sizeof(s), "log line %u ready", (unsigned)(i / 8 + 8));
+        draw_text(0, 56, s);
+    }
+    mark(0, 0, 127, 63);
+}
+
+static void telem_setup(void)
+{
+    draw_text(0, 0, "IMU telemetry");
+}
+
+// 与 imu_stream_show 相同：三行数值
+static void telem_step(uint32_t i)
+{
+    char s[32];
+
+    snprintf(s, sizeof(s), "F:%u D:%u T:0", (unsigned)(i * 5), (unsigned)(i / 40));
+    draw_text(0, 12, s);
+    snprintf(s, sizeof(s), "%uB/s", (unsigned)(2400 + (i * 37) % 200));
+    draw_text(0, 24, s);
+    snprintf(s, sizeof(s), "Steps:%u", (unsigned)(i / 3));
+    draw_text(0, 36, s);
+}
+
+static const Scene scenes[] = {
+    { "clock, 1/s",          120, 1000, clock_setup,  clock_step },
+    { "menu cursor, 10/s",   200, 100,  menu_setup,   menu_step },
+    { "scroll, 20/s",        100, 50,   scroll_setup, scroll_step },
+    { "telemetry screen, 5/s", 150, 200, telem_setup, telem_step },
+};
+
+typedef struct {
+    uint32_t refreshes;
+    uint32_t wire;              // 串口字节数（编码后，含描述帧之外的所有镜像帧）
+    uint32_t raw;               // 按刷新区域不压缩
+    uint32_t mismatch;          // 上位机画面未过期但与显存不同
+    uint32_t stale;             // 刷新后上位机画面过期的次数
+    uint32_t max_stale_ms;
+} SceneResult;
+
+static void run_scene(const Scene *sc, SceneResult *r)
+{
+    uint32_t stale_since = 0, was_stale = 0, wire0, raw0;
+
+    memset(r, 0, sizeof(*r));
+    clear_refresh();
+    sc->setup();
+    refresh_dirty();
+    wire0 = mirror_ch.stats.bytes;
+    raw0 = mirror.stats.raw_bytes;
+    for (uint32_t i = 0; i < sc->steps; i++) {
+        now += sc->step_ms;
+        sc->step(i);
+        refresh_dirty();
+        r->refreshes++;
+        // 最后一帧送达时，画面要么与显存相同，要么已被标记为过期
+        if (last_delivered && !screen.stale && memcmp(screen.gram, gram, sizeof(gram)) != 0) {
+            r->mismatch++;
+        }
+        if (screen.stale) {
+            r->stale++;
+            if (!was_stale) {
+                stale_since = now;
+            }
+            if (now - stale_since > r->max_stale_ms) {
+                r->max_stale_ms = now - stale_since;
+            }
+        }
+        was_stale = screen.stale;
+    }
+    r->wire = mirror_ch.stats.bytes - wire0;
+    r->raw = mirror.stats.raw_bytes - raw0;
+}
+
+// =============================================================================
+// 1. RLE
+// =============================================================================
+
+static void test_rle(void)
+{
+    uint8_t in[128], enc[OLED_MIRROR_PAYLOAD], rec[OLED_MIRROR_PAYLOAD], g[OLED_MIRROR_GRAM_SIZE];
+    uint32_t seed = 7, bad = 0, bound = 0;
+
+    for (uint32_t iter = 0; iter < 4000; iter++) {
+        uint32_t n = 1 + rnd(&seed) % 128, mode = iter % 4, len, x = rnd(&seed) % (129 - n);
+        uint8_t page = (uint8_t)(rnd(&seed) % 8), key = 0;
+
+        for (uint32_t i = 0; i < n; i++) {
+            // 随机字节 / 长游程 / 短游程与随机混合 / 全部相同
+            in[i] = mode == 0 ? (uint8_t)rnd(&seed) : mode == 1 ? (uint8_t)(i / 40) :
+                    mode == 2 ? (uint8_t)(rnd(&seed) % 3 == 0 ? rnd(&seed) : i / 3) : 0x55;
+        }
+        len = OledMirror_RleEncode(in, 1, n, enc);
+        if (len > n + (n + 127) / 128) {
+            bound++;
+        }
+        rec[0] = page;
+        rec[1] = (uint8_t)x;
+        rec[2] = (uint8_t)n;
+        memcpy(&rec[3], enc, len);
+        memset(g, 0xEE, sizeof(g));
+        if (OledMirror_Apply(g, rec, len + 3, &key) != 1 || key != 0) {
+            bad++;
+            continue;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (g[(x + i) * OLED_MIRROR_STRIDE + page] != in[i]) {
+                bad++;
+                break;
+            }
+        }
+        // 记录之外的字节不变
+        if (x > 0 && g[(x - 1) * OLED_MIRROR_STRIDE + page] != 0xEE) {
+            bad++;
+        }
+        // 截断的记录被拒绝
+        if (OledMirror_Apply(g, rec, len + 2, NULL) != -1) {
+            bad++;
+        }
+    }
+    check(bad == 0, "RLE round trip and truncation");
+    check(bound == 0, "RLE output bound");
+    {
+        uint8_t over[] = { 0, 120, 10, 9, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };      // 120 + 10 > 128
+        uint8_t flags[] = { 0x40, 0, 1, 0, 0 };                                 // 未定义的标志位
+        uint8_t run_over[] = { 0, 0, 4, 0x85, 0xAA };                           // 游程 7 > 4 列
+
+        check(OledMirror_Apply(g, over, sizeof(over), NULL) == -1 &&
+              OledMirror_Apply(g, flags, sizeof(flags), NULL) == -1 &&
+              OledMirror_Apply(g, run_over, sizeof(run_over), NULL) == -1, "malformed records rejected");
+    }
+}
+
+// =============================================================================
+// main
+// =============================================================================
+
+int main(void)
+{
+    SceneResult res[sizeof(scenes) / sizeof(scenes[0])];
+    const uint32_t nscenes = sizeof(scenes) / sizeof(scenes[0]);
+
+    printf("1. RLE\n");
+    test_rle();
+
+    // 2. 无丢帧：每次刷新后画面相同
+    printf("2. screens over a clean link\n");
+    device_reset();
+    replay = fopen(REPLAY_PATH, "wb");
+    check(replay != NULL && OledReplay_WriteHeader(replay) == 0, "replay file created");
+    for (uint32_t s = 0; s < nscenes; s++) {
+        run_scene(&scenes[s], &res[s]);
+        check(res[s].mismatch == 0 && res[s].stale == 0, scenes[s].name);
+    }
+    check(memcmp(screen.gram, gram, sizeof(gram)) == 0, "final screen identical");
+    check(rx.stats.bad_frames == 0 && rx.stats.lost == 0 && screen.stats.bad == 0, "no bad or lost frames");
+    printf("\n%-24s %9s %10s %10s %10s %8s\n", "", "refreshes", "B/refresh", "raw area", "full", "saving");
+    for (uint32_t s = 0; s < nscenes; s++) {
+        const SceneResult *r = &res[s];
+        double per = (double)r->wire / r->refreshes;
+
+        printf("%-24s %9u %10.1f %10.1f %10u %7.1fx\n", scenes[s].name, (unsigned)r->refreshes, per,
+               (double)r->raw / r->refreshes, (unsigned)FULL_WIRE, FULL_WIRE / per);
+    }
+    printf("mirror: %u refreshes (%u unchanged), %u spans, %u frames, %u keyframes\n",
+           (unsigned)mirror.stats.refreshes, (unsigned)mirror.stats.unchanged, (unsigned)mirror.stats.spans,
+           (unsigned)mirror.stats.frames, (unsigned)mirror.stats.keyframes);
+    check(res[0].wire * 10 < res[0].refreshes * (uint32_t)FULL_WIRE, "clock: 10x fewer bytes than full refresh");
+    check(res[1].wire * 4 < res[1].refreshes * (uint32_t)FULL_WIRE, "menu: 4x fewer bytes than full refresh");
+    check(res[3].wire * 10 < res[3].refreshes * (uint32_t)FULL_WIRE, "telemetry screen: 10x fewer bytes");
+    check(res[2].wire < res[2].refreshes * (uint32_t)FULL_WIRE, "scroll (worst case) still below full refresh");
+    check(res[1].wire < res[1].raw + res[1].refreshes * OLED_REPLAY_WIRE_EXTRA,
+          "menu: fewer bytes than sending the refreshed area");
+
+    // 5. 回放文件
+    if (replay != NULL) {
+        static OledScreen off;
+        uint8_t frame[OLED_MIRROR_PAYLOAD];
+        uint32_t t;
+        uint8_t seq;
+        int len;
+
+        fclose(replay);
+        replay = fopen(REPLAY_PATH, "rb");
+        check(replay != NULL && OledReplay_ReadHeader(replay) == 0, "replay header");
+        OledScreen_Init(&off);
+        while (replay != NULL && (len = OledReplay_Read(replay, &t, &seq, frame, sizeof(frame))) >= 0) {
+            OledScreen_Frame(&off, seq, t, frame, (uint32_t)len);
+        }
+        if (replay != NULL) {
+            fclose(replay);
+        }
+        check(off.stats.frames == screen.stats.frames && !off.stale &&
+              memcmp(off.gram, gram, sizeof(gram)) == 0, "replay reproduces the screen");
+        printf("5. replay: %u frames, %u bytes -> %s\n", (unsigned)off.stats.frames, (unsigned)off.stats.bytes,
+               REPLAY_PATH);
+        replay = NULL;
+    }
+
+    // 3. 设备端丢帧：下一次刷新整屏重发
+    {
+        SceneResult r;
+        uint32_t keys;
+
+        printf("3. device-side drops (every 9th frame)\n");
+        device_reset();
+        drop_every = 9;
+        run_scene(&scenes[3], &r);
+        keys = mirror.stats.keyframes;
+        drop_every = 0;
+        now += 200;
+        telem_step(1000);
+        refresh_dirty();
+        printf("   %u dropped, %u keyframes, stale after %u of %u refreshes, longest %u ms\n",
+               (unsigned)mirror.stats.dropped, (unsigned)keys, (unsigned)r.stale, (unsigned)r.refreshes,
+               (unsigned)r.max_stale_ms);
+        check(mirror.stats.dropped > 0 && r.mismatch == 0, "stale screen flagged, never shown as current");
+        check(r.max_stale_ms <= 2 * scenes[3].step_ms, "resync on the next refresh");
+        check(!screen.stale && memcmp(screen.gram, gram, sizeof(gram)) == 0, "in sync after drops stop");
+    }
+
+    // 4. 链路丢帧：定期整屏重发
+    {
+        SceneResult r;
+
+        printf("4. link loss (every 23rd frame, device unaware)\n");
+        device_reset();
+        lose_every = 23;
+        run_scene(&scenes[1], &r);
+        lose_every = 0;
+        now += KEY_MS;
+        menu_step(0);
+        refresh_dirty();
+        printf("   %u lost, %u detected, stale after %u of %u refreshes, longest %u ms\n",
+               (unsigned)link_lost, (unsigned)screen.stats.lost, (unsigned)r.stale, (unsigned)r.refreshes,
+               (unsigned)r.max_stale_ms);
+        check(link_lost > 0 && screen.stats.lost == link_lost, "every lost frame detected");
+        check(r.mismatch == 0, "stale screen flagged, never shown as current");
+        check(r.max_stale_ms <= KEY_MS, "resync within the keyframe interval");
+        check(!screen.stale && memcmp(screen.gram, gram, sizeof(gram)) == 0, "in sync after the next keyframe");
+    }
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
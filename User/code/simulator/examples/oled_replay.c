@@ -0,0 +1,205 @@
+// oled_replay.c - OLED 镜像回放文件工具（设备端见 ui/screen_mirror.c，帧格式见 code/oled_mirror.h）
+//
+// 用法：
+//   oled_replay convert [--ch N] <capture.bin|-> <out.rpl>
+//       从抓到的串口数据取出镜像通道的帧（默认通道 3，收到描述帧后按名字 "oled"），写成回放文件
+//   oled_replay stats [--until MS] [--pbm out.pbm] <in.rpl>
+//       重放并打印统计：刷新帧率、串口字节率、丢帧、关键帧，以及每页按列的刷新热点图；
+//       --until 只重放到该时刻（相对第一帧），--pbm 保存最后的画面
+//
+// 实时显示和录制回放文件用 OLED/simulator 的 oled_remote。
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "telem_decode.h"
+#include "oled_replay.h"
+
+#define LINE_BYTES_PER_S    (921600 / 10)
+#define HEAT_GROUP          4       // 热点图每个字符代表的列数
+
+typedef struct {
+    FILE    *out;
+    uint32_t ch;
+    uint32_t frames;
+} Convert;
+
+static void on_frame(void *ctx, const TelemRxChannel *ch, uint8_t seq, uint32_t t_ms,
+                     const uint8_t *payload, uint32_t len)
+{
+    Convert *c = ctx;
+
+    if (ch->known ? strcmp(ch->name, "oled") != 0 : ch->id != c->ch) {
+        return;
+    }
+    if (OledReplay_Write(c->out, t_ms, seq, payload, len) == 0) {
+        c->frames++;
+    }
+}
+
+static int convert(int argc, char **argv)
+{
+    static TelemReceiver rx;
+    Convert c = { NULL, 3, 0 };
+    TelemRxSink sink = { NULL, NULL, NULL, &c, on_frame };
+    FILE *in = stdin;
+    uint8_t buf[4096];
+    size_t n;
+    int i = 0;
+
+    if (i + 1 < argc && strcmp(argv[i], "--ch") == 0) {
+        c.ch = (uint32_t)strtoul(argv[i + 1], NULL, 10);
+        i += 2;
+    }
+    if (argc - i != 2) {
+        fprintf(stderr, "usage: oled_replay convert [--ch N] <capture.bin|-> <out.rpl>\n");
+        return 2;
+    }
+    if (strcmp(argv[i], "-") != 0 && (in = fopen(argv[i], "rb")) == NULL) {
+        fprintf(stderr, "oled_replay: cannot open %s\n", argv[i]);
+        return 1;
+    }
+    c.out = fopen(argv[i + 1], "wb");
+    if (c.out == NULL || OledReplay_WriteHeader(c.out) != 0) {
+        fprintf(stderr, "oled_replay: cannot create %s\n", argv[i + 1]);
+        return 1;
+    }
+    TelemRx_Init(&rx, &sink);
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        TelemRx_Feed(&rx, buf, n);
+    }
+    TelemRx_Flush(&rx);
+    fclose(c.out);
+    if (in != stdin) {
+        fclose(in);
+    }
+    fprintf(stderr, "oled_replay: %u mirror frames written (%u telemetry frames, %u bad)\n",
+            (unsigned)c.frames, (unsigned)(rx.stats.frames + rx.stats.unknown), (unsigned)rx.stats.bad_frames);
+    return 0;
+}
+
+static void print_heat(const OledScreen *s)
+{
+    static const char shades[] = " .:-=+*#%@";
+    uint32_t max = 1;
+
+    for (uint32_t p = 0; p < OLED_MIRROR_PAGES; p++) {
+        for (uint32_t g = 0; g < OLED_MIRROR_COLS; g += HEAT_GROUP) {
+            uint32_t sum = 0;
+
+            for (uint32_t k = 0; k < HEAT_GROUP; k++) {
+                sum += s->heat[p][g + k];
+            }
+            if (sum > max) {
+                max = sum;
+            }
+        }
+    }
+    printf("changes per page (rows) and %u-column group (columns), max %u:\n", HEAT_GROUP, (unsigned)max);
+    for (uint32_t p = 0; p < OLED_MIRROR_PAGES; p++) {
+        uint32_t total = 0;
+
+        printf("  page %u |", (unsigned)p);
+        for (uint32_t g = 0; g < OLED_MIRROR_COLS; g += HEAT_GROUP) {
+            uint32_t sum = 0;
+
+            for (uint32_t k = 0; k < HEAT_GROUP; k++) {
+                sum += s->heat[p][g + k];
+            }
+            total += sum;
+            putchar(sum == 0 ? ' ' : shades[1 + (uint64_t)(sum - 1) * (sizeof(shades) - 3) / max]);
+        }
+        printf("| %u\n", (unsigned)total);
+    }
+}
+
+static int stats(int argc, char **argv)
+{
+    static OledScreen screen;
+    uint8_t frame[OLED_MIRROR_PAYLOAD];
+    const char *pbm = NULL;
+    uint32_t until = 0xFFFFFFFFu, t, t0 = 0, sec_start = 0, sec_bytes = 0, peak_bytes = 0, ms;
+    uint8_t seq;
+    int i = 0, len;
+    FILE *in;
+    const OledScreen_Stats *st = &screen.stats;
+
+    while (i + 1 < argc && strncmp(argv[i], "--", 2) == 0) {
+        if (strcmp(argv[i], "--until") == 0) {
+            until = (uint32_t)strtoul(argv[i + 1], NULL, 10);
+        } else if (strcmp(argv[i], "--pbm") == 0) {
+            pbm = argv[i + 1];
+        } else {
+            break;
+        }
+        i += 2;
+    }
+    if (argc - i != 1) {
+        fprintf(stderr, "usage: oled_replay stats [--until MS] [--pbm out.pbm] <in.rpl>\n");
+        return 2;
+    }
+    in = fopen(argv[i], "rb");
+    if (in == NULL || OledReplay_ReadHeader(in) != 0) {
+        fprintf(stderr, "oled_replay: %s is not a replay file\n", argv[i]);
+        return 1;
+    }
+    OledScreen_Init(&screen);
+    while ((len = OledReplay_Read(in, &t, &seq, frame, sizeof(frame))) >= 0) {
+        if (st->frames == 0) {
+            t0 = sec_start = t;
+        }
+        if (t - t0 > until) {
+            break;
+        }
+        // 按 1 秒窗口统计串口字节率的峰值
+        if (t - sec_start >= 1000) {
+            sec_start = t;
+            sec_bytes = 0;
+        }
+        sec_bytes += (uint32_t)len + OLED_REPLAY_WIRE_EXTRA;
+        if (sec_bytes > peak_bytes) {
+            peak_bytes = sec_bytes;
+        }
+        OledScreen_Frame(&screen, seq, t, frame, (uint32_t)len);
+    }
+    if (len == -2) {
+        fprintf(stderr, "oled_replay: %s is truncated\n", argv[i]);
+    }
+    fclose(in);
+
+    ms = st->t_last - st->t_first;
+    printf("%u frames over %u ms (%.1f frames/s), %u records, %u keyframes, %u lost, %u bad\n",
+           (unsigned)st->frames, (unsigned)ms, ms > 0 ? st->frames * 1000.0 / ms : 0.0,
+           (unsigned)st->records, (unsigned)st->keyframes, (unsigned)st->lost, (unsigned)st->bad);
+    {
+        uint32_t wire = st->bytes + st->frames * OLED_REPLAY_WIRE_EXTRA;
+        double avg = ms > 0 ? wire * 1000.0 / ms : 0.0;
+
+        printf("%u payload bytes, %u on the wire: average %.0f B/s (%.1f%% of 921600bps), "
+               "peak %u B in 1 s (%.1f%%)\n", (unsigned)st->bytes, (unsigned)wire, avg,
+               avg * 100.0 / LINE_BYTES_PER_S, (unsigned)peak_bytes, peak_bytes * 100.0 / LINE_BYTES_PER_S);
+        printf("%u display bytes changed, %.2f wire bytes per changed byte%s\n", (unsigned)st->changed,
+               st->changed > 0 ? (double)wire / st->changed : 0.0, screen.stale ? ", screen is stale at the end" : "");
+    }
+    print_heat(&screen);
+    if (pbm != NULL) {
+        if (OledScreen_WritePbm(&screen, pbm) != 0) {
+            fprintf(stderr, "oled_replay: cannot write %s\n", pbm);
+            return 1;
+        }
+        printf("screen saved to %s\n", pbm);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "convert") == 0) {
+        return convert(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "stats") == 0) {
+        return stats(argc - 2, argv + 2);
+    }
+    fprintf(stderr, "usage: %s convert [--ch N] <capture.bin|-> <out.rpl>\n"
+                    "       %s stats [--until MS] [--pbm out.pbm] <in.rpl>\n", argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,188 @@
+// persist_demo.c - 延迟合并保存：同一段活动分别按三种策略保存，比较 Flash 写入量与未保存时长
+//
+// 活动（模拟时间，每 100ms 一个节拍）：走路 30 分钟 → 休息 10 分钟 → 菜单里连改 4 次闹钟 →
+// 设置时间 → 再走 200 秒 → 停下 1.5 秒后看门狗复位（停止喂狗前保存）
+//   every step  每走一步、每次修改都立即保存
+//   every 100   旧逻辑：每 100 步保存步数，闹钟/时间修改立即保存
+//   persist     persist.c：标记脏对象，空闲 2s / 最长 60s / 看门狗前批量保存
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "w25q128_sim.h"
+#include "spi.h"
+#include "flash_layout.h"
+#include "kv_store.h"
+#include "ui/step_file.h"
+#include "ui/alarm_file.h"
+#include "ui/persist.h"
+
+#define TICK_MS         100
+#define KV_KEY_DEMO_RTC 0x0F20      // 替代固件中 RTC_Settings_Save 写的键
+
+// 固件中由 simple_pedometer.c / alarm_all.c 提供的全局变量
+unsigned long g_step_count = 0;
+Alarm_TypeDef g_alarms[MAX_ALARMS];
+uint8_t g_alarm_count = 0;
+
+enum { POLICY_EVERY_STEP = 0, POLICY_EVERY_100, POLICY_PERSIST };
+
+// 每个对象从第一次未保存的修改到保存的时长
+static uint32_t unsaved_since[PERSIST_OBJ_COUNT];
+static uint8_t unsaved[PERSIST_OBJ_COUNT];
+static uint32_t unsaved_max_ms;
+static uint32_t saves;
+static unsigned long saved_steps;   // 最后一次保存时的步数
+
+static void changed(uint8_t obj)
+{
+    if (!unsaved[obj]) {
+        unsaved[obj] = 1;
+        unsaved_since[obj] = get_systick();
+    }
+}
+
+static void saved(uint8_t obj)
+{
+    if (unsaved[obj] && get_systick() - unsaved_since[obj] > unsaved_max_ms) {
+        unsaved_max_ms = get_systick() - unsaved_since[obj];
+    }
+    unsaved[obj] = 0;
+    saves++;
+}
+
+// 登记给 persist.c 的保存函数，同时记录未保存时长
+static int demo_steps_save(void)
+{
+    saved(PERSIST_OBJ_STEPS);
+    saved_steps = g_step_count;
+    return Steps_Save();
+}
+
+static int demo_alarms_save(void)
+{
+    saved(PERSIST_OBJ_ALARMS);
+    return Alarms_Save();
+}
+
+static int demo_rtc_save(void)
+{
+    uint8_t rec[7] = {25, 11, 17, 1, 8, 30, 0};
+
+    saved(PERSIST_OBJ_RTC);
+    return KV_Set(KV_KEY_DEMO_RTC, KV_TYPE_BLOB, rec, sizeof(rec));
+}
+
+static void change(uint8_t policy, uint8_t obj)
+{
+    changed(obj);
+    if (policy == POLICY_PERSIST) {
+        Persist_MarkDirty(obj);
+        return;
+    }
+    if (obj == PERSIST_OBJ_STEPS && policy == POLICY_EVERY_100 && g_step_count % 100 != 0) {
+        return;
+    }
+    if (obj == PERSIST_OBJ_STEPS) {
+        demo_steps_save();
+    } else if (obj == PERSIST_OBJ_ALARMS) {
+        demo_alarms_save();
+    } else {
+        demo_rtc_save();
+    }
+}
+
+// 推进一个节拍；persist 策略下相当于空闲钩子里的检查
+static void tick(uint8_t policy)
+{
+    W25Q128_Sim_Advance_us(TICK_MS * 1000u);
+    if (policy == POLICY_PERSIST) {
+        Persist_Poll();
+    }
+}
+
+// 以 600ms 一步走 ms 毫秒
+static void walk(uint8_t policy, uint32_t ms)
+{
+    for (uint32_t t = 0; t < ms; t += TICK_MS) {
+        if (t % 600 == 0) {
+            g_step_count++;
+            change(policy, PERSIST_OBJ_STEPS);
+        }
+        tick(policy);
+    }
+}
+
+static void idle(uint8_t policy, uint32_t ms)
+{
+    for (uint32_t t = 0; t < ms; t += TICK_MS) {
+        tick(policy);
+    }
+}
+
+static void run(uint8_t policy, const char *label)
+{
+    W25Q128_Sim_Stats fs;
+    unsigned long steps_at_risk;
+
+    memset(W25Q128_Sim_Memory() + FLASH_KV_BASE, 0xFF, FLASH_KV_SIZE);
+    memset(W25Q128_Sim_Memory() + FLASH_AB_STEPS_BASE, 0xFF, FLASH_AB_SIZE);
+    KV_Init();
+    g_step_count = 0;
+    saved_steps = 0;
+    g_alarm_count = 0;
+    memset(unsaved, 0, sizeof(unsaved));
+    unsaved_max_ms = 0;
+    saves = 0;
+    Persist_ResetStats();
+    W25Q128_Sim_ResetStats();
+
+    walk(policy, 30 * 60 * 1000);
+    idle(policy, 10 * 60 * 1000);
+    for (uint8_t i = 0; i < 4; i++) {
+        Alarm_TypeDef a = {7, (uint8_t)(10 * i), 0, 1, 1, 0x7F};
+        g_alarms[g_alarm_count++] = a;
+        change(policy, PERSIST_OBJ_ALARMS);
+        idle(policy, 1200);
+    }
+    change(policy, PERSIST_OBJ_RTC);
+    idle(policy, 5000);
+    walk(policy, 200 * 1000);
+    idle(policy, 1500);
+
+    // 看门狗复位时会丢失的步数（persist 策略在停止喂狗前先保存）
+    if (policy == POLICY_PERSIST) {
+        Persist_Flush(PERSIST_REASON_WATCHDOG);
+    }
+    steps_at_risk = g_step_count - saved_steps;
+    for (uint8_t i = 0; i < PERSIST_OBJ_COUNT; i++) {
+        if (unsaved[i] && get_systick() - unsaved_since[i] > unsaved_max_ms) {
+            unsaved_max_ms = get_systick() - unsaved_since[i];
+        }
+    }
+
+    W25Q128_Sim_GetStats(&fs);
+    printf("%-11s saves %5lu  programs %5lu  erases %3lu  flash busy %8.1f ms  "
+           "max unsaved %6.1f s  steps lost on reset %lu\n",
+           label, (unsigned long)saves, (unsigned long)fs.page_programs,
+           (unsigned long)fs.sector_erases, fs.busy_us / 1000.0, unsaved_max_ms / 1000.0,
+           steps_at_risk);
+    if (policy == POLICY_PERSIST) {
+        Persist_PrintStats();
+    }
+}
+
+int main(void)
+{
+    W25Q128_Sim_Open(NULL);
+    Persist_Register(PERSIST_OBJ_STEPS, "steps", demo_steps_save);
+    Persist_Register(PERSIST_OBJ_ALARMS, "alarms", demo_alarms_save);
+    Persist_Register(PERSIST_OBJ_RTC, "rtc", demo_rtc_save);
+
+    printf("deferred persistence, walk 30 min / rest 10 min / 4 alarm edits / set time / walk 200 s\n\n");
+    run(POLICY_EVERY_STEP, "every step");
+    run(POLICY_EVERY_100, "every 100");
+    run(POLICY_PERSIST, "persist");
+
+    W25Q128_Sim_Close();
+    return 0;
+}
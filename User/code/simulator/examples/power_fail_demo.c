@@ -0,0 +1,212 @@
+// power_fail_demo.c - 掉电注入：在保存序列的每一次编程/擦除处断电，检查重启后的数据
+//
+// 对每个切断点 k：从空白分区开始执行同一保存序列，第 k 次 Flash 写操作执行到一半时掉电，
+// 重新上电后重新扫描，加载到的值必须是最后一次成功保存的值或正在保存的值，
+// 并且之后的保存必须能正常完成。
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "w25q128_sim.h"
+#include "spi.h"
+#include "flash_layout.h"
+#include "ab_record.h"
+#include "kv_store.h"
+
+#define AB_SAVES        300     // 跨过两次扇区切换（每扇区 128 个槽）
+#define KV_SETS         600     // 跨过两次压缩（每扇区约 255 条记录）
+#define KV_KEY_A        0x0F10
+#define KV_KEY_B        0x0F11  // 只写一次，检查压缩时不丢失
+#define KV_B_VALUE      0xB0B0B0B0UL
+
+typedef struct {
+    uint32_t value;
+    uint32_t pad[2];
+} TestRecord;
+
+static AB_Region region = AB_REGION_INIT(FLASH_AB_STEPS_BASE, sizeof(TestRecord));
+
+static void blank(uint32_t base, uint32_t size)
+{
+    memset(W25Q128_Sim_Memory() + base, 0xFF, size);
+}
+
+static uint32_t write_ops(void)
+{
+    W25Q128_Sim_Stats st;
+
+    W25Q128_Sim_GetStats(&st);
+    return st.page_programs + st.sector_erases;
+}
+
+// =============================================================================
+// A/B 记录
+// =============================================================================
+
+/**
+ * @brief 保存 1..AB_SAVES，掉电后停止
+ * @param committed 输出：最后一次返回成功的值（0 表示没有）
+ * @param inflight  输出：掉电时正在保存的值（0 表示没有掉电）
+ */
+static void ab_sequence(uint32_t *committed, uint32_t *inflight)
+{
+    TestRecord rec = {0, {0x11111111, 0x22222222}};
+
+    *committed = 0;
+    *inflight = 0;
+    for (uint32_t v = 1; v <= AB_SAVES; v++) {
+        rec.value = v;
+        if (AB_Save(&region, &rec) == AB_OK && !W25Q128_Sim_PowerLost()) {
+            *committed = v;
+        }
+        if (W25Q128_Sim_PowerLost()) {
+            *inflight = v;
+            return;
+        }
+    }
+}
+
+static int ab_test(void)
+{
+    uint32_t ops, committed, inflight, pass = 0, fail = 0;
+    TestRecord rec;
+
+    blank(FLASH_AB_STEPS_BASE, FLASH_AB_SIZE);
+    AB_Reset(&region);
+    W25Q128_Sim_ResetStats();
+    ab_sequence(&committed, &inflight);
+    ops = write_ops();
+    printf("A/B record: %u saves = %lu flash write ops\n", AB_SAVES, (unsigned long)ops);
+
+    for (uint32_t k = 1; k <= ops; k++) {
+        int ret;
+
+        blank(FLASH_AB_STEPS_BASE, FLASH_AB_SIZE);
+        AB_Reset(&region);
+        W25Q128_Sim_FailAfter(k);
+        ab_sequence(&committed, &inflight);
+
+        // 重新上电
+        W25Q128_Sim_PowerCycle();
+        AB_Reset(&region);
+        ret = AB_Load(&region, &rec);
+        if (committed == 0 && inflight <= 1 && ret == AB_ERR_NOT_FOUND) {
+            rec.value = 0;      // 第一次保存就掉电
+        } else if (ret != AB_OK || (rec.value != committed && rec.value != inflight) ||
+                   rec.pad[0] != 0x11111111 || rec.pad[1] != 0x22222222) {
+            printf("  cut %lu: loaded %lu (ret %d), expected %lu or %lu\n", (unsigned long)k,
+                   (unsigned long)rec.value, ret, (unsigned long)committed, (unsigned long)inflight);
+            fail++;
+            continue;
+        }
+
+        // 恢复后继续保存
+        rec.value = 100000 + k;
+        if (AB_Save(&region, &rec) != AB_OK) {
+            printf("  cut %lu: save after recovery failed\n", (unsigned long)k);
+            fail++;
+            continue;
+        }
+        AB_Reset(&region);
+        if (AB_Load(&region, &rec) != AB_OK || rec.value != 100000 + k) {
+            printf("  cut %lu: reload after recovery failed\n", (unsigned long)k);
+            fail++;
+            continue;
+        }
+        pass++;
+    }
+    printf("  %lu cut points, %lu passed, %lu failed\n",
+           (unsigned long)ops, (unsigned long)pass, (unsigned long)fail);
+    return fail == 0;
+}
+
+// =============================================================================
+// KV 存储
+// =============================================================================
+
+static void kv_sequence(uint32_t *committed, uint32_t *inflight)
+{
+    *committed = 0;
+    *inflight = 0;
+    for (uint32_t v = 1; v <= KV_SETS; v++) {
+        if (KV_SetU32(KV_KEY_A, v) == KV_OK && !W25Q128_Sim_PowerLost()) {
+            *committed = v;
+        }
+        if (W25Q128_Sim_PowerLost()) {
+            *inflight = v;
+            return;
+        }
+    }
+}
+
+// 空白分区上初始化并写入 B，之后才开始注入
+static void kv_prepare(void)
+{
+    blank(FLASH_KV_BASE, FLASH_KV_SIZE);
+    KV_Init();
+    KV_SetU32(KV_KEY_B, KV_B_VALUE);
+}
+
+static int kv_test(void)
+{
+    uint32_t ops, committed, inflight, a, b, pass = 0, fail = 0;
+
+    kv_prepare();
+    W25Q128_Sim_ResetStats();
+    kv_sequence(&committed, &inflight);
+    ops = write_ops();
+    printf("KV store: %u sets = %lu flash write ops\n", KV_SETS, (unsigned long)ops);
+
+    for (uint32_t k = 1; k <= ops; k++) {
+        int ra, rb;
+
+        kv_prepare();
+        W25Q128_Sim_FailAfter(k);
+        kv_sequence(&committed, &inflight);
+
+        W25Q128_Sim_PowerCycle();
+        KV_Init();
+        ra = KV_GetU32(KV_KEY_A, &a);
+        rb = KV_GetU32(KV_KEY_B, &b);
+        if (rb != KV_OK || b != KV_B_VALUE) {
+            printf("  cut %lu: key B lost (ret %d)\n", (unsigned long)k, rb);
+            fail++;
+            continue;
+        }
+        if (!(committed == 0 && ra == KV_ERR_NOT_FOUND) &&
+            (ra != KV_OK || (a != committed && a != inflight))) {
+            printf("  cut %lu: loaded %lu (ret %d), expected %lu or %lu\n", (unsigned long)k,
+                   (unsigned long)a, ra, (unsigned long)committed, (unsigned long)inflight);
+            fail++;
+            continue;
+        }
+
+        if (KV_SetU32(KV_KEY_A, 100000 + k) != KV_OK) {
+            printf("  cut %lu: set after recovery failed\n", (unsigned long)k);
+            fail++;
+            continue;
+        }
+        KV_Init();
+        if (KV_GetU32(KV_KEY_A, &a) != KV_OK || a != 100000 + k) {
+            printf("  cut %lu: reload after recovery failed\n", (unsigned long)k);
+            fail++;
+            continue;
+        }
+        pass++;
+    }
+    printf("  %lu cut points, %lu passed, %lu failed\n",
+           (unsigned long)ops, (unsigned long)pass, (unsigned long)fail);
+    return fail == 0;
+}
+
+int main(void)
+{
+    int ok;
+
+    W25Q128_Sim_Open(NULL);
+    ok = ab_test();
+    ok = kv_test() && ok;
+    W25Q128_Sim_Close();
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
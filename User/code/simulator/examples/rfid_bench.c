@@ -0,0 +1,429 @@
+// rfid_bench.c - 读卡协议引擎检查（与固件同一份 rfid/rfid.c），读卡模块为 rfid_reader_sim
+//
+// 1. 解析器：2000 个随机帧与乱码字节交错、每 10 帧损坏一帧，按随机长度切块输入：
+//    完好的帧全部按序解出，损坏的帧丢弃；逐字节输入时最后一个字节到达才交出整帧，
+//    信息长度不对的帧在第 4 个字节就被拒绝
+// 2. 请求引擎：9600bps 线路，读卡模块每条命令处理 3ms，认证、读块交替连续提交：
+//    - 每 5 个应答丢一个：每个请求恰好完成一次，成功的数据都正确，失败的都是超时或应答丢失
+//    - 流水线（同时 2 个在途）与一问一答的吞吐量对比
+// 3. 寻卡：40 次刷卡（每次 400ms，间隔 500ms，每 5 次中有一次是上一张卡重新放上），
+//    RFID 任务每毫秒运行一次：每次刷卡恰好上报一次且 UID 正确，统计刷卡到上报的延迟；
+//    流水线、一问一答、有故障的线路（丢应答、误码、乱码）各跑一遍
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rfid.h"
+#include "rfid_reader_sim.h"
+
+#define BAUD            9600
+#define PROCESS_US      3000            // 读卡模块处理一条命令的时间
+#define STEP_US         100
+#define CARD_UID        0x5A3C9E21u
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static uint32_t rnd(uint32_t *s)
+{
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 8;
+}
+
+// =============================================================================
+// 1. 解析器
+// =============================================================================
+
+#define P_FRAMES        2000
+
+static uint8_t p_sent[P_FRAMES][RFID_FRAME_MAX];
+static uint8_t p_sent_len[P_FRAMES];
+static uint8_t p_good[P_FRAMES];
+static uint32_t p_next, p_count, p_wrong;
+
+static void p_on_frame(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    (void)ctx;
+    while (p_next < P_FRAMES && !p_good[p_next]) {
+        p_next++;           // 损坏的帧不会出现
+    }
+    if (p_next >= P_FRAMES || len != p_sent_len[p_next] || memcmp(frame, p_sent[p_next], len) != 0) {
+        p_wrong++;
+    }
+    p_next++;
+    p_count++;
+}
+
+static void test_parser(void)
+{
+    static uint8_t stream[P_FRAMES * (RFID_FRAME_MAX + 8)];
+    RfidParser p;
+    uint32_t seed = 1, len = 0, good = 0, noise = 0;
+
+    printf("parser:\n");
+    for (uint32_t i = 0; i < P_FRAMES; i++) {
+        uint8_t info[RFID_INFO_MAX];
+        uint32_t n = rnd(&seed) % (RFID_INFO_MAX + 1), k = rnd(&seed) % 5;
+
+        for (uint32_t j = 0; j < n; j++) {
+            info[j] = (uint8_t)rnd(&seed);
+        }
+        p_sent_len[i] = (uint8_t)Rfid_Build(p_sent[i], RFID_TYPE_ISO14443A, (uint8_t)(0x41 + rnd(&seed) % 8), info, n);
+        memcpy(&stream[len], p_sent[i], p_sent_len[i]);
+        p_good[i] = i % 10 != 9;
+        if (!p_good[i]) {
+            stream[len + rnd(&seed) % p_sent_len[i]] ^= (uint8_t)(1u << (rnd(&seed) % 8));
+        } else {
+            good++;
+        }
+        len += p_sent_len[i];
+        // 帧之间的乱码，一半是看起来像帧长的字节
+        for (uint32_t j = 0; j < k; j++) {
+            stream[len++] = (uint8_t)(j % 2 ? RFID_FRAME_MIN + rnd(&seed) % RFID_INFO_MAX : rnd(&seed));
+            noise++;
+        }
+    }
+    RfidParser_Init(&p, p_on_frame, NULL);
+    for (uint32_t off = 0; off < len;) {
+        uint32_t n = 1 + rnd(&seed) % 40;
+
+        if (n > len - off) {
+            n = len - off;
+        }
+        RfidParser_Feed(&p, &stream[off], n);
+        off += n;
+    }
+    printf("  %u frames (%u corrupted) with %u noise bytes: %u decoded, %u wrong; "
+           "rejected %u bad length, %u bad BCC, %u bad ETX, %u bytes skipped\n",
+           P_FRAMES, P_FRAMES - (unsigned)good, (unsigned)noise, (unsigned)p_count, (unsigned)p_wrong,
+           (unsigned)p.stats.bad_len, (unsigned)p.stats.bad_bcc, (unsigned)p.stats.bad_etx,
+           (unsigned)p.stats.skipped);
+    check(p_count == good && p_wrong == 0, "every intact frame decoded in order, corrupted frames dropped");
+
+    // 逐字节输入：最后一个字节到达时交出；信息长度与帧长不符在第 4 个字节拒绝
+    {
+        static const uint8_t req = RFID_REQ_ALL;
+        uint8_t f[RFID_FRAME_MAX];
+        uint32_t flen = Rfid_Build(f, RFID_TYPE_ISO14443A, RFID_CMD_REQUEST, &req, 1), early = 0;
+
+        p_next = 0;
+        p_count = 0;
+        p_wrong = 0;
+        memcpy(p_sent[0], f, flen);
+        p_sent_len[0] = (uint8_t)flen;
+        p_good[0] = 1;
+        RfidParser_Init(&p, p_on_frame, NULL);
+        for (uint32_t i = 0; i < flen; i++) {
+            RfidParser_Feed(&p, &f[i], 1);
+            if (i + 1 < flen && p_count != 0) {
+                early++;
+            }
+        }
+        check(early == 0 && p_count == 1 && p_wrong == 0, "frame delivered on its last byte");
+        f[3] = 5;
+        RfidParser_Init(&p, p_on_frame, NULL);
+        RfidParser_Feed(&p, f, 4);
+        check(p.stats.bad_len == 1 && p.n == 0, "bad info length rejected at the 4th byte");
+    }
+}
+
+// =============================================================================
+// 模拟：USART2 两个方向的线路、读卡模块、固件的 RFID 任务
+// =============================================================================
+
+typedef struct {
+    RfidSimLine   h2r;          // 单片机到读卡模块
+    RfidSimLine   r2h;
+    RfidReaderSim sim;
+    RfidEngine    engine;
+    RfidScan      scan;
+    uint8_t       scanning;
+    uint32_t      now_us;
+} Rig;
+
+// RFID_Uart2_Send：上一帧还在发送时返回 0
+static uint32_t rig_send(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    Rig *r = (Rig *)ctx;
+
+    if (RfidSimLine_Pending(&r->h2r) != 0) {
+        return 0;
+    }
+    return RfidSimLine_Put(&r->h2r, r->now_us, frame, len);
+}
+
+static void rig_init(Rig *r, uint8_t pipeline, uint32_t seed)
+{
+    RfidPort port = { rig_send, r };
+
+    memset(r, 0, sizeof(*r));
+    RfidSimLine_Init(&r->h2r, BAUD);
+    RfidSimLine_Init(&r->r2h, BAUD);
+    RfidSim_Init(&r->sim, &r->r2h, PROCESS_US, seed);
+    RfidEngine_Init(&r->engine, &port, 0);
+    r->engine.pipeline = pipeline;
+}
+
+// 线路和读卡模块每 100us 推进一次；RFID 任务每个节拍（1ms）取出收到的字节、检查超时、推进寻卡
+static void rig_step(Rig *r)
+{
+    uint8_t buf[64];
+    uint32_t n;
+
+    r->now_us += STEP_US;
+    n = RfidSimLine_Take(&r->h2r, r->now_us, buf, sizeof(buf));
+    if (n > 0) {
+        RfidSim_Input(&r->sim, buf, n, r->now_us);
+    } else {
+        RfidSim_Run(&r->sim, r->now_us);
+    }
+    if (r->now_us % 1000 == 0) {
+        uint32_t ms = r->now_us / 1000;
+
+        n = RfidSimLine_Take(&r->r2h, r->now_us, buf, sizeof(buf));
+        if (n > 0) {
+            RfidEngine_Input(&r->engine, buf, n, ms);
+        }
+        RfidEngine_Poll(&r->engine, ms);
+        if (r->scanning) {
+            RfidScan_Poll(&r->scan, ms);
+        }
+    }
+}
+
+// =============================================================================
+// 2. 请求引擎
+// =============================================================================
+
+#define E_REQUESTS      200
+
+typedef struct {
+    uint32_t done;
+    uint32_t ok;
+    uint32_t bad_data;
+    uint32_t timeouts;
+    uint32_t lost;
+    uint32_t twice;
+    uint8_t  seen[E_REQUESTS];
+    uint32_t ms;
+} EngineRun;
+
+static void e_done(void *ctx, uint8_t cmd, int status, const uint8_t *info, uint32_t len);
+
+static EngineRun *e_run;
+
+static void e_done(void *ctx, uint8_t cmd, int status, const uint8_t *info, uint32_t len)
+{
+    uint32_t i = (uint32_t)(uintptr_t)ctx;
+    uint8_t want[16];
+
+    if (e_run->seen[i]++) {
+        e_run->twice++;
+    }
+    e_run->done++;
+    if (status == RFID_OK) {
+        e_run->ok++;
+        if (i % 2 == 0) {
+            if (cmd != RFID_CMD_AUTH || len != 1 || info[0] != 0) {
+                e_run->bad_data++;
+            }
+        } else {
+            RfidSim_BlockData(CARD_UID, (uint8_t)(i / 2 % 64), want);
+            if (cmd != RFID_CMD_READ || len != 16 || memcmp(info, want, 16) != 0) {
+                e_run->bad_data++;
+            }
+        }
+    } else if (status == RFID_ERR_TIMEOUT) {
+        e_run->timeouts++;
+    } else {
+        e_run->lost++;
+    }
+}
+
+static void engine_run(EngineRun *run, uint8_t pipeline, uint32_t drop_every, Rig *r)
+{
+    uint32_t submitted = 0;
+
+    memset(run, 0, sizeof(*run));
+    e_run = run;
+    rig_init(r, pipeline, 7);
+    RfidSim_AddCard(&r->sim, CARD_UID, 0, 0xFFFFFFFFu);
+    r->sim.drop_every = drop_every;
+    while (run->done < E_REQUESTS && r->now_us < 60u * 1000000) {
+        // 每块先认证再读：密钥类型(1) UID(4) 密钥(6) 块号(1)
+        while (submitted < E_REQUESTS && RfidEngine_Pending(&r->engine) < RFID_QUEUE) {
+            uint8_t auth[12] = { 0x60, (uint8_t)CARD_UID, (uint8_t)(CARD_UID >> 8), (uint8_t)(CARD_UID >> 16),
+                                 (uint8_t)(CARD_UID >> 24), 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0 };
+            uint8_t block = (uint8_t)(submitted / 2 % 64);
+            void *ctx = (void *)(uintptr_t)submitted;
+
+            auth[11] = block;
+            if (submitted % 2 == 0) {
+                RfidEngine_Submit(&r->engine, RFID_CMD_AUTH, auth, sizeof(auth), e_done, ctx);
+            } else {
+                RfidEngine_Submit(&r->engine, RFID_CMD_READ, &block, 1, e_done, ctx);
+            }
+            submitted++;
+        }
+        rig_step(r);
+    }
+    run->ms = r->now_us / 1000;
+}
+
+static void test_engine(void)
+{
+    static Rig r;
+    EngineRun lossy, piped, saw;
+
+    printf("request engine (%u requests: authenticate + read 16 bytes, 9600 bps, reader %u ms per command):\n", E_REQUESTS,
+           PROCESS_US / 1000);
+    engine_run(&lossy, RFID_PIPELINE, 5, &r);
+    printf("  every 5th reply dropped: %u ok, %u timeouts, %u lost, %u unmatched replies, max rtt %u ms\n",
+           (unsigned)lossy.ok, (unsigned)lossy.timeouts, (unsigned)lossy.lost, (unsigned)r.engine.stats.unmatched,
+           (unsigned)r.engine.stats.max_rtt);
+    check(lossy.done == E_REQUESTS && lossy.twice == 0, "lossy: every request completed exactly once");
+    check(lossy.bad_data == 0, "lossy: every successful reply matches its request");
+    check(lossy.timeouts + lossy.lost == r.sim.stats.dropped && lossy.lost > 0,
+          "lossy: one failure per dropped reply, skipped requests fail without waiting");
+
+    engine_run(&piped, RFID_PIPELINE, 0, &r);
+    engine_run(&saw, 1, 0, &r);
+    printf("  pipelined (%u in flight) %5u ms, %.1f ms per request\n", RFID_PIPELINE, (unsigned)piped.ms,
+           (double)piped.ms / E_REQUESTS);
+    printf("  stop-and-wait            %5u ms, %.1f ms per request\n", (unsigned)saw.ms,
+           (double)saw.ms / E_REQUESTS);
+    check(piped.ok == E_REQUESTS && saw.ok == E_REQUESTS && piped.bad_data == 0 && saw.bad_data == 0,
+          "clean link: every request succeeds");
+    check(piped.ms < saw.ms, "pipelining faster than stop-and-wait");
+}
+
+// =============================================================================
+// 3. 寻卡
+// =============================================================================
+
+#define S_SWIPES        40
+#define S_FIRST_MS      200
+#define S_HOLD_MS       400
+#define S_GAP_MS        500
+
+typedef struct {
+    uint32_t reports;
+    uint32_t wrong;         ///< UID 与当时场内的卡不符
+    uint32_t missed;
+    uint32_t twice;
+    uint32_t lat_sum;
+    uint32_t lat_max;
+    uint8_t  seen[S_SWIPES];
+} ScanRun;
+
+static Rig s_rig;
+static ScanRun *s_run;
+
+static uint32_t swipe_uid(uint32_t i)
+{
+    if (i % 5 == 4) {
+        i--;                // 上一张卡重新放上
+    }
+    return 0x10000u + i * 7919u;
+}
+
+static void s_on_card(void *ctx, const RfidCard *card)
+{
+    Rig *r = (Rig *)ctx;
+    uint32_t t = card->t_ms, i = (t - S_FIRST_MS) / (S_HOLD_MS + S_GAP_MS);
+    uint32_t from = S_FIRST_MS + i * (S_HOLD_MS + S_GAP_MS), lat;
+
+    (void)r;
+    s_run->reports++;
+    if (t < S_FIRST_MS || i >= S_SWIPES || card->uid != swipe_uid(i) || card->sak != RFID_SAK_S50 ||
+        card->atq != RFID_ATQ_S50) {
+        s_run->wrong++;
+        return;
+    }
+    if (s_run->seen[i]++) {
+        s_run->twice++;
+    }
+    lat = t - from;
+    s_run->lat_sum += lat;
+    if (lat > s_run->lat_max) {
+        s_run->lat_max = lat;
+    }
+}
+
+static void scan_run(ScanRun *run, const char *name, uint8_t pipeline, uint32_t drop, uint32_t corrupt,
+                     uint32_t noise)
+{
+    Rig *r = &s_rig;
+    uint32_t end_ms = S_FIRST_MS + S_SWIPES * (S_HOLD_MS + S_GAP_MS);
+    const RfidScan_Stats *st = &r->scan.stats;
+
+    memset(run, 0, sizeof(*run));
+    s_run = run;
+    rig_init(r, pipeline, 11);
+    r->sim.drop_every = drop;
+    r->sim.corrupt_every = corrupt;
+    r->sim.noise_every = noise;
+    for (uint32_t i = 0; i < S_SWIPES; i++) {
+        uint32_t from = S_FIRST_MS + i * (S_HOLD_MS + S_GAP_MS);
+
+        RfidSim_AddCard(&r->sim, swipe_uid(i), from, from + S_HOLD_MS);
+    }
+    RfidScan_Init(&r->scan, &r->engine, s_on_card, r);
+    r->scanning = 1;
+    while (r->now_us < end_ms * 1000u) {
+        rig_step(r);
+    }
+    for (uint32_t i = 0; i < S_SWIPES; i++) {
+        run->missed += run->seen[i] == 0;
+    }
+    if (run->wrong + run->twice + run->missed != 0) {
+        printf("  %s: %u wrong, %u twice, %u missed\n", name, (unsigned)run->wrong, (unsigned)run->twice,
+               (unsigned)run->missed);
+    }
+    printf("  %-14s %3u cycles (%u empty, %u with card, %u errors), longest %3u ms; "
+           "%2u cards reported, latency avg %3u max %3u ms\n",
+           name, (unsigned)st->cycles, (unsigned)st->empty, (unsigned)st->reads, (unsigned)st->errors,
+           (unsigned)st->max_cycle, (unsigned)run->reports,
+           (unsigned)(run->reports > run->wrong ? run->lat_sum / (run->reports - run->wrong) : 0),
+           (unsigned)run->lat_max);
+}
+
+static void test_scan(void)
+{
+    ScanRun piped, saw, noisy;
+
+    printf("card scanning (%u swipes of %u ms, %u ms apart, RFID task runs every 1 ms):\n", S_SWIPES, S_HOLD_MS,
+           S_GAP_MS);
+    scan_run(&piped, "pipelined", RFID_PIPELINE, 0, 0, 0);
+    check(piped.reports == S_SWIPES && piped.missed == 0 && piped.wrong == 0 && piped.twice == 0,
+          "pipelined: every swipe reported once with the right UID");
+    scan_run(&saw, "stop-and-wait", 1, 0, 0, 0);
+    check(saw.reports == S_SWIPES && saw.missed == 0 && saw.wrong == 0 && saw.twice == 0,
+          "stop-and-wait: every swipe reported once with the right UID");
+    scan_run(&noisy, "faulty link", RFID_PIPELINE, 23, 29, 5);
+    printf("                 reader: %u replies, %u dropped, %u corrupted, %u noise bytes; "
+           "parser skipped %u bytes\n", (unsigned)s_rig.sim.stats.replies, (unsigned)s_rig.sim.stats.dropped,
+           (unsigned)s_rig.sim.stats.corrupted, (unsigned)s_rig.sim.stats.noise,
+           (unsigned)s_rig.engine.parser.stats.skipped);
+    check(noisy.reports == S_SWIPES && noisy.missed == 0 && noisy.wrong == 0 && noisy.twice == 0,
+          "faulty link: every swipe reported once with the right UID");
+    check(piped.lat_sum < saw.lat_sum, "pipelined scanning reports cards sooner");
+    printf("  old blocking driver: each command polled in 1000 ms steps, request + anticollision + select "
+           ">= 3000 ms with the calling task blocked\n");
+}
+
+int main(void)
+{
+    test_parser();
+    test_engine();
+    test_scan();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,277 @@
+// sd_demo.c - SD 卡驱动（sdio_sd.c）对照 SD 命令协议模型（sd_card_sim.c）的检查与吞吐量对比
+//
+//   1. 无卡时 disk_initialize 快速失败
+//   2. SDHC 初始化命令序列（打印每条命令）、时钟与位宽切换、GET_SECTOR_COUNT
+//   3. 各种长度、非对齐缓冲区的读写与回读校验，读到卡末尾
+//   4. 注入数据 CRC 错误后重试
+//   5. SDSC v2 / v1（字节地址）与 MMC（不支持）
+//   6. 顺序读写吞吐量：SD 卡 vs W25Q128 FatFs 分区（同一个 disk_read/disk_write 接口）
+//   任何一步失败或卡模型记录到驱动时序违例时打印 FAIL
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "ff.h"
+#include "diskio.h"
+#include "w25q128_sim.h"
+#include "sd_card_sim.h"
+#include "sdio_sd.h"
+
+#define DEV_FLASH       0
+#define DEV_MMC         1
+
+#define SDHC_SECTORS    131072  // 64MB
+#define TEST_SECTORS    2048    // 校验区 1MB
+#define BENCH_BYTES     (1024 * 1024)
+#define BENCH_CHUNK     32      // 每次 disk_write 的扇区数（16KB）
+
+static uint8_t ref[TEST_SECTORS * SD_BLOCK_SIZE];
+static uint8_t buf[TEST_SECTORS * SD_BLOCK_SIZE + 4];
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static void fill(uint8_t *p, uint32_t len, uint32_t seed)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        seed = seed * 1103515245u + 12345u;
+        p[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static void print_card(void)
+{
+    static const char *const names[] = {"none", "SDSC v1", "SDSC v2", "SDHC"};
+    SD_CardInfo info;
+
+    SD_GetCardInfo(&info);
+    printf("  card: %s, RCA 0x%04X, %lu sectors (%lu MB), erase unit %lu sectors, %u-bit @ %lu MHz\n",
+           names[info.type], info.rca, (unsigned long)info.sector_count,
+           (unsigned long)(info.sector_count / 2048), (unsigned long)info.erase_sectors,
+           info.bus_width, (unsigned long)(info.clock_hz / 1000000));
+}
+
+// 无卡：CMD8/CMD55 超时后立即返回
+static void check_no_card(void)
+{
+    uint64_t t0 = W25Q128_Sim_Time_us();
+    DSTATUS st;
+
+    SD_Sim_Eject();
+    st = disk_initialize(DEV_MMC);
+    printf("no card: disk_initialize -> 0x%02X in %.1f ms, disk_read -> %d\n", st,
+           (W25Q128_Sim_Time_us() - t0) / 1000.0, disk_read(DEV_MMC, buf, 0, 1));
+    check(st & STA_NOINIT, "no card must leave STA_NOINIT set");
+}
+
+static void check_init_sdhc(void)
+{
+    SD_Sim_Stats ss;
+    LBA_t sectors = 0;
+    DWORD block = 0;
+    WORD size = 0;
+    DSTATUS st;
+
+    SD_Sim_Insert(SD_SIM_SDHC, SDHC_SECTORS);
+    SD_Sim_ResetStats();
+    printf("SDHC 64MB init sequence:\n");
+    SD_Sim_SetTrace(1);
+    st = disk_initialize(DEV_MMC);
+    SD_Sim_SetTrace(0);
+    print_card();
+
+    disk_ioctl(DEV_MMC, GET_SECTOR_COUNT, &sectors);
+    disk_ioctl(DEV_MMC, GET_SECTOR_SIZE, &size);
+    disk_ioctl(DEV_MMC, GET_BLOCK_SIZE, &block);
+    SD_Sim_GetStats(&ss);
+    printf("  disk_initialize 0x%02X, GET_SECTOR_COUNT %lu, GET_SECTOR_SIZE %u, GET_BLOCK_SIZE %lu, "
+           "%lu commands, card bus %u-bit\n", st, (unsigned long)sectors, size, (unsigned long)block,
+           (unsigned long)ss.commands, ss.bus_width);
+    check(st == 0, "SDHC init");
+    check(sectors == SDHC_SECTORS && size == SD_BLOCK_SIZE && block == 128, "SDHC geometry");
+    check(ss.bus_width == 4, "card switched to 4-bit");
+}
+
+// 多种长度和对齐方式写入，再用不同的分段读回
+static void check_data(void)
+{
+    static const uint32_t wlen[] = {1, 8, 64, 127, 1, 3, 300, 1, 511, 1032};
+    static const uint32_t rlen[] = {1000, 7, 1, 40, 1000};
+    SD_Stats st;
+    uint32_t s = 0, i = 0;
+
+    fill(ref, sizeof(ref), 1);
+    SD_ResetStats();
+
+    // 写：交替使用对齐与非对齐（+1）的缓冲区
+    for (i = 0; s < TEST_SECTORS; i++) {
+        uint32_t n = wlen[i % (sizeof(wlen) / sizeof(wlen[0]))];
+        uint8_t *src = (i & 1) ? buf + 1 : buf;
+
+        if (n > TEST_SECTORS - s) {
+            n = TEST_SECTORS - s;
+        }
+        memcpy(src, ref + s * SD_BLOCK_SIZE, n * SD_BLOCK_SIZE);
+        check(disk_write(DEV_MMC, src, s, n) == RES_OK, "disk_write");
+        s += n;
+    }
+    check(disk_ioctl(DEV_MMC, CTRL_SYNC, NULL) == RES_OK, "CTRL_SYNC");
+    check(memcmp(SD_Sim_Memory(), ref, sizeof(ref)) == 0, "card contents after write");
+
+    memset(buf, 0, sizeof(buf));
+    for (s = 0, i = 0; s < TEST_SECTORS; i++) {
+        uint32_t n = rlen[i % (sizeof(rlen) / sizeof(rlen[0]))];
+        uint8_t *dst = (i & 1) ? buf + 3 : buf;
+
+        if (n > TEST_SECTORS - s) {
+            n = TEST_SECTORS - s;
+        }
+        check(disk_read(DEV_MMC, dst, s, n) == RES_OK, "disk_read");
+        check(memcmp(dst, ref + s * SD_BLOCK_SIZE, n * SD_BLOCK_SIZE) == 0, "read back");
+        s += n;
+    }
+
+    // 多块读到卡的最后一个扇区（卡在 CMD12 响应里报 OUT_OF_RANGE），以及越界
+    check(disk_read(DEV_MMC, buf, SDHC_SECTORS - 16, 16) == RES_OK, "multi-block read to the last sector");
+    check(disk_read(DEV_MMC, buf, SDHC_SECTORS - 1, 2) == RES_PARERR, "read past the end rejected");
+
+    SD_GetStats(&st);
+    printf("data: %lu sectors written in %lu commands, read back in %lu commands (%lu multi-block in total), "
+           "%lu CMD13 busy polls, match: %s\n",
+           (unsigned long)st.blocks_written, (unsigned long)st.write_cmds, (unsigned long)st.read_cmds,
+           (unsigned long)st.multi_cmds, (unsigned long)st.busy_polls, failures ? "no" : "yes");
+}
+
+// 注入 CRC 错误：读写各一次，驱动应重试成功
+static void check_crc_retry(void)
+{
+    SD_Stats st;
+
+    SD_ResetStats();
+    fill(ref, 16 * SD_BLOCK_SIZE, 77);
+    SD_Sim_FailNextData();
+    check(disk_write(DEV_MMC, ref, 100, 16) == RES_OK, "multi-block write after CRC error");
+    SD_Sim_FailNextData();
+    check(disk_write(DEV_MMC, ref, 200, 1) == RES_OK, "single-block write after CRC error");
+    SD_Sim_FailNextData();
+    check(disk_read(DEV_MMC, buf, 100, 16) == RES_OK && memcmp(buf, ref, 16 * SD_BLOCK_SIZE) == 0,
+          "multi-block read after CRC error");
+    SD_Sim_FailNextData();
+    check(disk_read(DEV_MMC, buf, 200, 1) == RES_OK && memcmp(buf, ref, SD_BLOCK_SIZE) == 0,
+          "single-block read after CRC error");
+    SD_GetStats(&st);
+    printf("crc errors: 4 injected, %lu retries, %lu failed transfers\n",
+           (unsigned long)st.retries, (unsigned long)st.errors);
+    check(st.retries == 4 && st.errors == 0, "each CRC error retried once");
+}
+
+// SDSC：字节地址，CSD 1.0 容量
+static void check_sdsc(SD_Sim_CardType type, uint32_t sectors, const char *label, uint32_t expect_illegal)
+{
+    SD_Sim_Stats ss;
+    LBA_t count = 0;
+    DSTATUS st;
+
+    SD_Sim_Insert(type, sectors);
+    SD_Sim_ResetStats();
+    st = disk_initialize(DEV_MMC);
+    disk_ioctl(DEV_MMC, GET_SECTOR_COUNT, &count);
+    fill(ref, 64 * SD_BLOCK_SIZE, sectors);
+    check(disk_write(DEV_MMC, ref, sectors - 64, 64) == RES_OK, "SDSC write");
+    check(disk_write(DEV_MMC, ref, 5, 1) == RES_OK, "SDSC single write");
+    check(disk_read(DEV_MMC, buf, sectors - 64, 64) == RES_OK && memcmp(buf, ref, 64 * SD_BLOCK_SIZE) == 0,
+          "SDSC read back");
+    check(memcmp(SD_Sim_Memory() + 5 * SD_BLOCK_SIZE, ref, SD_BLOCK_SIZE) == 0, "SDSC byte addressing");
+    SD_Sim_GetStats(&ss);
+    printf("%s: disk_initialize 0x%02X, %lu sectors, %lu illegal commands (%lu expected)\n", label, st,
+           (unsigned long)count, (unsigned long)ss.illegal_cmds, (unsigned long)expect_illegal);
+    print_card();
+    check(st == 0 && count == sectors, "SDSC init and capacity");
+    check(SD_Sim_Violations() == expect_illegal && ss.illegal_cmds == expect_illegal, "SDSC protocol");
+}
+
+static void check_mmc(void)
+{
+    DSTATUS st;
+
+    SD_Sim_Insert(SD_SIM_MMC, 8192);
+    st = disk_initialize(DEV_MMC);
+    printf("MMC: disk_initialize -> 0x%02X (not supported)\n", st);
+    check(st & STA_NOINIT, "MMC rejected");
+}
+
+// 顺序写/读 1MB，每次 BENCH_CHUNK 个扇区，最后 CTRL_SYNC
+static void bench(BYTE pdrv, const char *label)
+{
+    uint32_t sectors = BENCH_BYTES / SD_BLOCK_SIZE;
+    uint64_t t0, tw, tr, t1;
+
+    fill(ref, BENCH_CHUNK * SD_BLOCK_SIZE, 5);
+    t0 = W25Q128_Sim_Time_us();
+    for (uint32_t s = 0; s < sectors; s += BENCH_CHUNK) {
+        disk_write(pdrv, ref, 4096 + s, BENCH_CHUNK);
+    }
+    disk_ioctl(pdrv, CTRL_SYNC, NULL);
+    tw = W25Q128_Sim_Time_us() - t0;
+
+    t0 = W25Q128_Sim_Time_us();
+    for (uint32_t s = 0; s < sectors; s += BENCH_CHUNK) {
+        disk_read(pdrv, buf, 4096 + s, BENCH_CHUNK);
+    }
+    tr = W25Q128_Sim_Time_us() - t0;
+
+    // FatFs 更新 FAT/目录时的单扇区写
+    t0 = W25Q128_Sim_Time_us();
+    for (uint32_t s = 0; s < 64; s++) {
+        disk_write(pdrv, ref, 100 + s * 9, 1);
+    }
+    disk_ioctl(pdrv, CTRL_SYNC, NULL);
+    t1 = W25Q128_Sim_Time_us() - t0;
+
+    printf("  %-14s write %7.2f MB/s  read %7.2f MB/s  single-sector write %7.3f ms\n", label,
+           BENCH_BYTES / (double)tw, BENCH_BYTES / (double)tr, t1 / 64 / 1000.0);
+}
+
+int main(void)
+{
+    SD_Sim_Stats ss;
+
+    printf("SD card (SDIO 4-bit + DMA) driver check\n");
+    W25Q128_Sim_Open(NULL);
+
+    check_no_card();
+    check_init_sdhc();
+    check_data();
+    check_crc_retry();
+    SD_Sim_GetStats(&ss);
+    printf("SDHC protocol: %lu commands, CMD17/18 %lu/%lu, CMD24/25 %lu/%lu, CMD12 %lu, max data clock %lu MHz, "
+           "violations %lu (illegal %lu, clock %lu, width %lu, data %lu, address %lu)\n",
+           (unsigned long)ss.commands, (unsigned long)ss.single_reads, (unsigned long)ss.multi_reads,
+           (unsigned long)ss.single_writes, (unsigned long)ss.multi_writes, (unsigned long)ss.stops,
+           (unsigned long)(ss.max_clock_hz / 1000000), (unsigned long)SD_Sim_Violations(),
+           (unsigned long)ss.illegal_cmds, (unsigned long)ss.clock_violations,
+           (unsigned long)ss.width_violations, (unsigned long)ss.data_violations,
+           (unsigned long)ss.addr_errors);
+    check(SD_Sim_Violations() == 0, "SDHC protocol violations");
+    check(ss.max_clock_hz == SD_XFER_CLOCK_HZ, "data at 24MHz");
+
+    printf("sequential 1MB in %u-sector requests:\n", BENCH_CHUNK);
+    bench(DEV_MMC, "SD card");
+    check(disk_initialize(DEV_FLASH) == 0, "W25Q128 init");
+    bench(DEV_FLASH, "W25Q128 FatFs");
+
+    check_sdsc(SD_SIM_SDSC_V2, 65536, "SDSC v2 32MB", 0);
+    check_sdsc(SD_SIM_SDSC_V1, 32768, "SDSC v1 16MB", 1);   // 1.x 卡不认识 CMD8
+    check_mmc();
+
+    SD_Sim_Eject();
+    W25Q128_Sim_Close();
+    printf("%s\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
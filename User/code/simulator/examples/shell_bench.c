@@ -0,0 +1,332 @@
+// shell_bench.c - 串口命令解释器（shell.c）的检查与查找开销对比
+//
+// 1. 检查：命令表排序与重名、带类型参数（u/i/b/t/s、可选参数、引号）、错误分类、
+//    分块输入（任意切分、\r\n、退格、超长行），使用与固件同一份 shell.c。
+// 2. 开销：原 data_task 对每行依次 strstr 每个命令名，与切分 + 二分查找 + 参数解析对比，
+//    命令数分别为原来的 3 个、固件现在登记的 17 个和再多 20 个时。
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "shell.h"
+
+#define BENCH_LINES     200000
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// =============================================================================
+// 测试用命令：记录最后一次调用
+// =============================================================================
+
+static const char *last_cmd;
+static uint32_t last_argc;
+static Shell_Arg last_argv[SHELL_MAX_ARGS];
+static uint32_t calls;
+
+static int record(const char *name, uint32_t argc, const Shell_Arg *argv)
+{
+    last_cmd = name;
+    last_argc = argc;
+    memcpy(last_argv, argv, argc * sizeof(Shell_Arg));
+    calls++;
+    return SHELL_OK;
+}
+
+#define HANDLER(fn, name) \
+    static int fn(uint32_t argc, const Shell_Arg *argv) { return record(name, argc, argv); }
+
+HANDLER(h_led, "led")
+HANDLER(h_hello, "hello")
+HANDLER(h_world, "world")
+HANDLER(h_uartstat, "uartstat")
+HANDLER(h_logstat, "logstat")
+HANDLER(h_tasks, "tasks")
+HANDLER(h_alarm_add, "alarm_add")
+HANDLER(h_alarm_list, "alarm_list")
+HANDLER(h_alarm_del, "alarm_del")
+HANDLER(h_alarm_en, "alarm_en")
+HANDLER(h_rtc, "rtc")
+HANDLER(h_rtc_set, "rtc_set")
+HANDLER(h_date_set, "date_set")
+HANDLER(h_step, "step")
+HANDLER(h_step_reset, "step_reset")
+HANDLER(h_bench, "bench")
+HANDLER(h_misc, "misc")
+
+static int h_fail(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    (void)argv;
+    return SHELL_ERR_FAIL;
+}
+
+// 与固件各模块登记的命令同名同参数（main.c、alarm_all.c、rtc_date.c、simple_pedometer.c、filesystem_test.c）
+static const Shell_Cmd sys_cmds[] = {
+    { "led", "u|b", h_led, "" }, { "hello", "", h_hello, "" }, { "world", "", h_world, "" },
+    { "uartstat", "", h_uartstat, "" }, { "logstat", "", h_logstat, "" }, { "tasks", "", h_tasks, "" },
+};
+static const Shell_Cmd alarm_cmds[] = {
+    { "alarm_add", "t|b", h_alarm_add, "" }, { "alarm_list", "", h_alarm_list, "" },
+    { "alarm_del", "u", h_alarm_del, "" }, { "alarm_en", "ub", h_alarm_en, "" },
+};
+static const Shell_Cmd rtc_cmds[] = {
+    { "rtc", "", h_rtc, "" }, { "rtc_set", "t", h_rtc_set, "" }, { "date_set", "uuuu", h_date_set, "" },
+};
+static const Shell_Cmd step_cmds[] = {
+    { "step", "", h_step, "" }, { "step_reset", "", h_step_reset, "" },
+};
+static const Shell_Cmd fs_cmds[] = {
+    { "bench", "|s", h_bench, "" },
+};
+static const Shell_Cmd test_cmds[] = {
+    { "misc", "is|uu", h_misc, "" }, { "fail", "", h_fail, "" },
+};
+
+#define N(a) (sizeof(a) / sizeof(a[0]))
+
+static void register_firmware(void)
+{
+    Shell_Init();
+    Shell_Register(sys_cmds, N(sys_cmds));
+    Shell_Register(alarm_cmds, N(alarm_cmds));
+    Shell_Register(rtc_cmds, N(rtc_cmds));
+    Shell_Register(step_cmds, N(step_cmds));
+    Shell_Register(fs_cmds, N(fs_cmds));
+}
+
+// 执行一行（拷贝到可写缓冲区）
+static int run(const char *text)
+{
+    char line[SHELL_LINE_MAX];
+
+    last_cmd = NULL;
+    snprintf(line, sizeof(line), "%s", text);
+    return Shell_Execute(line);
+}
+
+// 标准输出临时指向 /dev/null（命令回应 OK/ERR 太多）
+static int quiet_fd = -1;
+
+static void quiet(int on)
+{
+    fflush(stdout);
+    if (on) {
+        int null = open("/dev/null", O_WRONLY);
+
+        quiet_fd = dup(1);
+        dup2(null, 1);
+        close(null);
+    } else {
+        dup2(quiet_fd, 1);
+        close(quiet_fd);
+    }
+}
+
+// =============================================================================
+// 1. 检查
+// =============================================================================
+
+static void unit_checks(void)
+{
+    static const Shell_Cmd dup[] = { { "led", "", h_misc, "" } };
+    static Shell_Cmd many[SHELL_MAX_CMDS];
+    static char names[SHELL_MAX_CMDS][8];
+    Shell_Stats st;
+    Shell_Line ln;
+
+    printf("unit checks (command replies follow)\n");
+    register_firmware();
+    check(Shell_Register(test_cmds, N(test_cmds)) == SHELL_OK, "register");
+    check(Shell_Register(dup, 1) == SHELL_ERR_EXIST && Shell_Find("led")->handler == h_led, "duplicate name rejected");
+    check(Shell_Find("alarm_add") != NULL && Shell_Find("alarm") == NULL && Shell_Find("zzz") == NULL, "exact lookup");
+
+    // 参数类型
+    check(run("led 2 on") == SHELL_OK && last_cmd && strcmp(last_cmd, "led") == 0 && last_argc == 2 &&
+          last_argv[0].u == 2 && last_argv[1].u == 1, "u and b");
+    check(run("  led\t3  ") == SHELL_OK && last_argc == 1 && last_argv[0].u == 3, "optional arg omitted, blanks");
+    check(run("led 0x10 off") == SHELL_OK && last_argv[0].u == 16 && last_argv[1].u == 0, "hex");
+    check(run("led x") == SHELL_ERR_USAGE && last_cmd == NULL, "bad number");
+    check(run("led 1 maybe") == SHELL_ERR_USAGE, "bad bool");
+    check(run("led 1 on 2") == SHELL_ERR_USAGE, "too many args");
+    check(run("led") == SHELL_ERR_USAGE, "missing required arg");
+    check(run("led 4294967296") == SHELL_ERR_USAGE, "u overflow");
+    check(run("alarm_add 7:05") == SHELL_OK && last_argv[0].u == ((7u << 16) | (5u << 8)), "time hh:mm");
+    check(run("alarm_add 23:59:58 off") == SHELL_OK && SHELL_TIME_H(last_argv[0].u) == 23 &&
+          SHELL_TIME_M(last_argv[0].u) == 59 && SHELL_TIME_S(last_argv[0].u) == 58 && last_argv[1].u == 0, "time hh:mm:ss");
+    check(run("alarm_add 24:00") == SHELL_ERR_USAGE && run("alarm_add 12:60") == SHELL_ERR_USAGE &&
+          run("alarm_add 12") == SHELL_ERR_USAGE && run("alarm_add 12:30:") == SHELL_ERR_USAGE, "bad time");
+    check(run("misc -2147483648 \"two words\" 7 8") == SHELL_OK && last_argc == 4 &&
+          last_argv[0].i == INT32_MIN && strcmp(last_argv[1].s, "two words") == 0 && last_argv[3].u == 8, "i, quoted s");
+    check(run("misc 2147483648 a") == SHELL_ERR_USAGE, "i overflow");
+    check(run("misc -5 \"open") == SHELL_ERR_LINE, "unbalanced quote");
+    check(run("misc 1 2 3 4 5 6 7 8 9 10") == SHELL_ERR_USAGE, "more tokens than SHELL_MAX_ARGS");
+    check(run("bench") == SHELL_OK && last_argc == 0 && run("bench 1:") == SHELL_OK &&
+          strcmp(last_argv[0].s, "1:") == 0, "optional string");
+    check(run("hello world") == SHELL_ERR_USAGE, "no substring matching any more");
+    check(run("nosuch 1") == SHELL_ERR_UNKNOWN, "unknown");
+    check(run("fail") == SHELL_ERR_FAIL, "handler failure");
+    check(run("   ") == SHELL_OK && last_cmd == NULL, "blank line ignored");
+    check(run("help") == SHELL_OK, "help");
+
+    // 分块输入：每次 1 字节
+    {
+        static const char stream[] = "led 1 on\r\nalarm_add 07:3\b30\nrtc\r\n\r\n";
+        uint32_t before = calls;
+
+        Shell_LineInit(&ln);
+        for (size_t i = 0; i < sizeof(stream) - 1; i++) {
+            Shell_Input(&ln, (const uint8_t *)&stream[i], 1);
+        }
+        check(calls - before == 3 && strcmp(last_cmd, "rtc") == 0, "byte-by-byte input, CRLF, empty lines");
+    }
+    {
+        char longline[300];
+        uint32_t before = calls;
+
+        memset(longline, 'a', sizeof(longline));
+        memcpy(longline, "led 1 ", 6);
+        longline[sizeof(longline) - 1] = '\n';
+        Shell_Input(&ln, (const uint8_t *)longline, sizeof(longline));
+        Shell_Input(&ln, (const uint8_t *)"step\n", 5);
+        Shell_GetStats(&st);
+        check(calls - before == 1 && strcmp(last_cmd, "step") == 0 && st.overflow == 1, "over-long line dropped whole");
+    }
+
+    // 命令表满
+    Shell_Init();
+    for (int i = 0; i < SHELL_MAX_CMDS; i++) {
+        snprintf(names[i], sizeof(names[i]), "c%02d", i);
+        many[i].name = names[i];
+        many[i].args = "";
+        many[i].handler = h_misc;
+        many[i].help = "";
+    }
+    check(Shell_Register(many, SHELL_MAX_CMDS) == SHELL_ERR_FULL, "table full reported");
+    check(Shell_Find("c00") != NULL && Shell_Find("help") != NULL, "entries before full kept");
+    printf("\n");
+}
+
+// =============================================================================
+// 2. 开销
+// =============================================================================
+
+static const char *const bench_lines[] = {
+    "led 1 on", "hello", "alarm_add 07:30", "rtc_set 12:00:00", "step", "uartstat",
+    "alarm_list", "bench 0:", "tasks", "date_set 2026 10 18 7",
+};
+
+static double now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// 原 data_line：对每个命令名在整行中 strstr（每个 if 都要执行）
+static double bench_strstr(const char *const *names, uint32_t n, uint32_t *hits)
+{
+    double t0 = now_us();
+    volatile uint32_t h = 0;
+
+    for (uint32_t i = 0; i < BENCH_LINES; i++) {
+        const char *line = bench_lines[i % N(bench_lines)];
+
+        for (uint32_t k = 0; k < n; k++) {
+            if (strstr(line, names[k])) {
+                h++;
+            }
+        }
+    }
+    *hits = h;
+    return (now_us() - t0) * 1000 / BENCH_LINES;
+}
+
+static double bench_table(void)
+{
+    double t0;
+
+    quiet(1);
+    t0 = now_us();
+    for (uint32_t i = 0; i < BENCH_LINES; i++) {
+        run(bench_lines[i % N(bench_lines)]);
+    }
+    t0 = (now_us() - t0) * 1000 / BENCH_LINES;
+    quiet(0);
+    return t0;
+}
+
+static void bench(void)
+{
+    static const char *names[64];
+    static char extra_names[20][12];
+    static Shell_Cmd extra[20];
+    uint32_t n = 0, hits;
+    double s, t;
+    Shell_Stats st;
+
+    printf("lookup cost per line (%d lines, %u distinct commands; table cost includes tokenizing and typed parsing)\n",
+           BENCH_LINES, (unsigned)N(bench_lines));
+    printf("  %-10s %16s %16s %14s\n", "commands", "strstr ns/line", "table ns/line", "strstr hits");
+
+    // 原来的 3 个命令
+    names[0] = "hello"; names[1] = "world"; names[2] = "uartstat";
+    s = bench_strstr(names, 3, &hits);
+    register_firmware();
+    t = bench_table();
+    printf("  %-10u %16.1f %16.1f %14.2f\n", 3u, s, t, (double)hits / BENCH_LINES);
+
+    // 固件现在的命令
+    {
+        static const struct { const Shell_Cmd *cmds; uint32_t count; } tabs[] = {
+            { sys_cmds, N(sys_cmds) }, { alarm_cmds, N(alarm_cmds) }, { rtc_cmds, N(rtc_cmds) },
+            { step_cmds, N(step_cmds) }, { fs_cmds, N(fs_cmds) },
+        };
+
+        for (uint32_t i = 0; i < N(tabs); i++) {
+            for (uint32_t k = 0; k < tabs[i].count; k++) {
+                names[n++] = tabs[i].cmds[k].name;
+            }
+        }
+    }
+    names[n++] = "help";
+    s = bench_strstr(names, n, &hits);
+    t = bench_table();
+    printf("  %-10u %16.1f %16.1f %14.2f\n", (unsigned)n, s, t, (double)hits / BENCH_LINES);
+    check(hits > BENCH_LINES, "strstr matches more than one command per line (e.g. alarm_add/rtc_set vs step, rtc)");
+    Shell_GetStats(&st);
+    check(st.unknown == 0 && st.usage == 0 && st.ok == 2 * BENCH_LINES, "every bench line executed once");
+
+    // 再多 20 个命令（命令表上限 SHELL_MAX_CMDS = 48）
+    for (uint32_t k = 0; k < 20; k++) {
+        snprintf(extra_names[k], sizeof(extra_names[k]), "x_cmd_%02u", (unsigned)k);
+        extra[k].name = extra_names[k];
+        extra[k].args = "u";
+        extra[k].handler = h_misc;
+        extra[k].help = "";
+        names[n++] = extra_names[k];
+    }
+    check(Shell_Register(extra, 20) == SHELL_OK, "register 20 more");
+    s = bench_strstr(names, n, &hits);
+    t = bench_table();
+    printf("  %-10u %16.1f %16.1f %14.2f\n", (unsigned)n, s, t, (double)hits / BENCH_LINES);
+    check(t < s, "table lookup cheaper than scanning every name once the command set grows");
+}
+
+int main(void)
+{
+    unit_checks();
+    bench();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
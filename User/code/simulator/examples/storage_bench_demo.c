@@ -0,0 +1,61 @@
+// storage_bench_demo.c - 在模拟 W25Q128 上运行 storage_bench 工作负载
+// 用法: storage_bench_demo [映像文件]   不指定映像时从空白芯片开始，结果可复现
+#include <stdio.h>
+#include <stdint.h>
+#include "ff.h"
+#include "diskio_cache.h"
+#include "w25q128_sim.h"
+#include "spi.h"
+#include "ui/storage_bench.h"
+
+static FATFS fs;
+static BYTE work[FF_MAX_SS];
+static uint8_t bench_buf[32 * 1024];   // 与固件 filesystem_test.c 的 g_buffer 同样大小
+
+static FRESULT mount_or_format(void)
+{
+    FRESULT fr = f_mount(&fs, "0:", 1);
+
+    if (fr == FR_NO_FILESYSTEM) {
+        // 与固件 filesystem_test.c 相同的格式化参数
+        MKFS_PARM opt = {0};
+        opt.fmt = FM_ANY | FM_SFD;
+        opt.au_size = W25Q128_SECTOR_SIZE;
+        opt.n_fat = 1;
+        opt.n_root = 128;
+        fr = f_mkfs("0:", &opt, work, sizeof(work));
+        if (fr != FR_OK) {
+            return fr;
+        }
+        fr = f_mount(&fs, "0:", 1);
+    }
+    if (fr == FR_OK) {
+        disk_cache_pin_fat(&fs);
+    }
+    return fr;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *image = argc > 1 ? argv[1] : NULL;
+    FRESULT fr;
+
+    printf("W25Q128 simulator storage benchmark, image: %s\n", image ? image : "(blank)");
+    W25Q128_Sim_Open(image);
+
+    fr = mount_or_format();
+    if (fr != FR_OK) {
+        printf("mount failed: %d\n", fr);
+        return 1;
+    }
+
+    disk_cache_reset_stats();
+    W25Q128_Sim_ResetStats();
+    fr = StorageBench_Run("0:", bench_buf, sizeof(bench_buf));
+
+    disk_cache_print_stats();
+    W25Q128_Sim_PrintStats("benchmark");
+    f_mount(NULL, "0:", 0);
+    W25Q128_Sim_Close();
+    return fr == FR_OK ? 0 : 1;
+}
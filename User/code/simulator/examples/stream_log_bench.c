@@ -0,0 +1,245 @@
+// stream_log_bench.c - 高速率日志：f_write 追加与 stream_log.c 预分配直写的持续追加对比
+//
+// 工作负载：500Hz 的 16 字节 IMU 原始记录（与 imu_capture.c 同格式），持续 60 秒（模拟时间）
+//   f_write     每条记录 f_write，每秒 f_sync 一次
+//   stream_log  f_expand 预分配，记录进缓冲区，按页直接编程，检查点才更新目录项
+// 每种方式统计存储侧每次调用的耗时（模拟时间）：总忙碌时间、p99/最大值，以及
+// 最大耗时期间采样任务需要缓冲的字节数。之后检查检查点之后掉电的恢复与续写。
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ff.h"
+#include "diskio_cache.h"
+#include "w25q128_sim.h"
+#include "spi.h"
+#include "stream_log.h"
+#include "ui/imu_capture.h"
+
+#define RATE_HZ         500
+#define SECONDS         60
+#define RECORDS         (RATE_HZ * SECONDS)
+#define PERIOD_US       (1000000 / RATE_HZ)
+#define CAPACITY        (1024UL * 1024)
+
+static FATFS fs;
+static BYTE work[FF_MAX_SS];
+static uint8_t ring[2048];
+static StreamLog slog;
+static uint32_t lat_us[RECORDS];
+
+static FRESULT mount_or_format(void)
+{
+    FRESULT fr = f_mount(&fs, "0:", 1);
+
+    if (fr == FR_NO_FILESYSTEM) {
+        // 与固件 storage_service.c 相同的格式化参数
+        MKFS_PARM opt = {0};
+        opt.fmt = FM_ANY | FM_SFD;
+        opt.au_size = W25Q128_SECTOR_SIZE;
+        opt.n_fat = 1;
+        opt.n_root = 128;
+        fr = f_mkfs("0:", &opt, work, sizeof(work));
+        if (fr != FR_OK) {
+            return fr;
+        }
+        fr = f_mount(&fs, "0:", 1);
+    }
+    if (fr == FR_OK) {
+        disk_cache_pin_fat(&fs);
+    }
+    return fr;
+}
+
+// 第 i 条记录的内容（可复现，用于回读校验）
+static void make_record(uint32_t i, ImuRawRecord *r)
+{
+    uint32_t x = i * 2654435761u;
+
+    r->t_ms = i * (1000 / RATE_HZ);
+    r->ax = (int16_t)(x >> 20);
+    r->ay = (int16_t)(x >> 12);
+    r->az = (int16_t)(16384 + (int16_t)(x & 0x3FF));
+    r->gx = (int16_t)(i % 2000);
+    r->gy = (int16_t)-(int32_t)(i % 1500);
+    r->gz = (int16_t)(x >> 4);
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report(const char *label, uint64_t close_us)
+{
+    W25Q128_Sim_Stats st;
+    uint64_t busy = close_us;
+
+    W25Q128_Sim_GetStats(&st);
+    for (uint32_t i = 0; i < RECORDS; i++) {
+        busy += lat_us[i];
+    }
+    qsort(lat_us, RECORDS, sizeof(lat_us[0]), cmp_u32);
+    printf("%-11s busy %7.1f ms/s  p99 %6.2f ms  max %6.1f ms  buffer %6lu B  "
+           "programs %5lu  erases %4lu  flash writes %5.2fx  max rate %6.0f rec/s\n",
+           label, busy / 1000.0 / SECONDS, lat_us[RECORDS * 99 / 100] / 1000.0,
+           lat_us[RECORDS - 1] / 1000.0,
+           (unsigned long)((lat_us[RECORDS - 1] / PERIOD_US + 1) * sizeof(ImuRawRecord)),
+           (unsigned long)st.page_programs, (unsigned long)st.sector_erases,
+           (double)st.bytes_programmed / (RECORDS * sizeof(ImuRawRecord)),
+           RECORDS / (busy / 1e6));
+}
+
+// 回读整个文件并与生成的数据比较
+static int verify(const char *path, uint32_t count)
+{
+    FIL fil;
+    ImuRawRecord r, e;
+    UINT br;
+    int ok = 1;
+
+    if (f_open(&fil, path, FA_READ) != FR_OK) {
+        return 0;
+    }
+    if (f_size(&fil) != (FSIZE_t)count * sizeof(r)) {
+        printf("  %s: size %lu, expected %lu\n", path, (unsigned long)f_size(&fil),
+               (unsigned long)(count * sizeof(r)));
+        ok = 0;
+    }
+    for (uint32_t i = 0; ok && i < count; i++) {
+        make_record(i, &e);
+        if (f_read(&fil, &r, sizeof(r), &br) != FR_OK || br != sizeof(r) || memcmp(&r, &e, sizeof(r)) != 0) {
+            printf("  %s: record %lu mismatch\n", path, (unsigned long)i);
+            ok = 0;
+        }
+    }
+    f_close(&fil);
+    return ok;
+}
+
+static int run_fwrite(void)
+{
+    FIL fil;
+    ImuRawRecord r;
+    UINT bw;
+    uint64_t t0;
+
+    f_unlink("0:/fw.bin");
+    if (f_open(&fil, "0:/fw.bin", FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) {
+        return 0;
+    }
+    W25Q128_Sim_ResetStats();
+    for (uint32_t i = 0; i < RECORDS; i++) {
+        make_record(i, &r);
+        t0 = W25Q128_Sim_Time_us();
+        f_write(&fil, &r, sizeof(r), &bw);
+        if ((i + 1) % RATE_HZ == 0) {
+            f_sync(&fil);
+        }
+        lat_us[i] = (uint32_t)(W25Q128_Sim_Time_us() - t0);
+        W25Q128_Sim_Advance_us(PERIOD_US);
+    }
+    t0 = W25Q128_Sim_Time_us();
+    f_close(&fil);
+    report("f_write", W25Q128_Sim_Time_us() - t0);
+    return verify("0:/fw.bin", RECORDS);
+}
+
+static int run_stream(void)
+{
+    ImuRawRecord r;
+    uint64_t t0;
+    FRESULT fr;
+
+    f_unlink("0:/sl.bin");
+    W25Q128_Sim_ResetStats();
+    fr = StreamLog_Open(&slog, "0:/sl.bin", CAPACITY, sizeof(r), ring, sizeof(ring));
+    if (fr != FR_OK) {
+        printf("  StreamLog_Open failed: %d\n", fr);
+        return 0;
+    }
+    for (uint32_t i = 0; i < RECORDS; i++) {
+        make_record(i, &r);
+        t0 = W25Q128_Sim_Time_us();
+        StreamLog_Write(&slog, &r, sizeof(r));   // 模拟中刷写请求在这里同步执行
+        lat_us[i] = (uint32_t)(W25Q128_Sim_Time_us() - t0);
+        W25Q128_Sim_Advance_us(PERIOD_US);
+    }
+    t0 = W25Q128_Sim_Time_us();
+    fr = StreamLog_Close(&slog);
+    report("stream_log", W25Q128_Sim_Time_us() - t0);
+    StreamLog_PrintStats(&slog);
+    return fr == FR_OK && slog.stats.dropped == 0 && verify("0:/sl.bin", RECORDS);
+}
+
+// 检查点之后掉电：重新挂载后续写，检查点之后已编程的记录应全部恢复
+static int run_recovery(void)
+{
+    const uint32_t before = 5000, after = 777, more = 100;
+    ImuRawRecord r;
+    uint32_t i;
+    FRESULT fr;
+    int ok;
+
+    f_unlink("0:/rec.bin");
+    if (StreamLog_Open(&slog, "0:/rec.bin", 256 * 1024, sizeof(r), ring, sizeof(ring)) != FR_OK) {
+        return 0;
+    }
+    for (i = 0; i < before; i++) {
+        make_record(i, &r);
+        StreamLog_Write(&slog, &r, sizeof(r));
+    }
+    StreamLog_Checkpoint(&slog);
+    for (; i < before + after; i++) {
+        make_record(i, &r);
+        StreamLog_Write(&slog, &r, sizeof(r));
+    }
+    printf("recovery: committed %lu B, programmed %lu B, %lu B still in RAM at power loss\n",
+           (unsigned long)slog.committed, (unsigned long)slog.written,
+           (unsigned long)(slog.head - slog.tail));
+
+    // 掉电：不关闭文件，缓冲区里的数据丢失
+    i = (uint32_t)(slog.written / sizeof(r));
+    f_mount(NULL, "0:", 0);
+    if (mount_or_format() != FR_OK) {
+        return 0;
+    }
+    fr = StreamLog_Open(&slog, "0:/rec.bin", CAPACITY, sizeof(r), ring, sizeof(ring));
+    printf("recovery: reopen %d, recovered %lu B, resuming at record %lu\n", fr,
+           (unsigned long)slog.stats.recovered, (unsigned long)(slog.written / sizeof(r)));
+    ok = fr == FR_OK && slog.written == (FSIZE_t)i * sizeof(r);
+    for (uint32_t k = 0; ok && k < more; k++, i++) {
+        make_record(i, &r);
+        StreamLog_Write(&slog, &r, sizeof(r));
+    }
+    ok = ok && StreamLog_Close(&slog) == FR_OK && verify("0:/rec.bin", i);
+
+    // 正常关闭后不能再续写
+    fr = StreamLog_Open(&slog, "0:/rec.bin", 4096, sizeof(r), ring, sizeof(ring));
+    printf("recovery: reopen after close -> %d (FR_EXIST expected)\n", fr);
+    return ok && fr == FR_EXIST;
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    W25Q128_Sim_Open(NULL);
+    if (mount_or_format() != FR_OK) {
+        printf("mount failed\n");
+        return 1;
+    }
+
+    printf("high-rate log, %d Hz x %u B records for %d s (%lu KB)\n\n", RATE_HZ,
+           (unsigned)sizeof(ImuRawRecord), SECONDS, (unsigned long)(RECORDS * sizeof(ImuRawRecord) / 1024));
+    ok = run_fwrite() && ok;
+    ok = run_stream() && ok;
+    printf("\n");
+    ok = run_recovery() && ok;
+
+    f_mount(NULL, "0:", 0);
+    W25Q128_Sim_Close();
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,527 @@
+// tag_db_bench.c - 卡片登记表检查（与固件同一份 rfid/tag_db.c），Flash 为 W25Q128 模拟器
+//
+// 1. 查找：4096 容量的表登记 1000/2000/4000 张卡，命中和未命中的平均/最长探测槽数，
+//    与逐条比较（RAM 中线性查找、按顺序读出 Flash 上的记录）对比；
+//    随机登记/删除 20 万次后与参照表逐条一致，删除不留标记，探测长度不变长
+// 2. 持久化往返（固件的分区和容量）：登记满 TAG_DB_MAX 张卡后随机修改、刷卡、删除 5000 次，
+//    重新载入后与参照表逐条相同；继续修改后再载入一次。统计每次修改的 Flash 耗时和启动载入耗时
+// 3. 4000 张卡的表在更大的区上往返一次
+// 4. 掉电注入：小分区上的修改序列（跨过多次压缩和扇区擦除），在每一次编程/擦除处断电，
+//    重新载入的表必须是最后一次成功修改之后或正在进行的修改之后的状态，之后的修改能正常完成
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "w25q128_sim.h"
+#include "spi.h"
+#include "flash_layout.h"
+#include "tag_db.h"
+#include "rfid_access.h"
+
+#define BIG_CAP         4096
+#define BIG_SLOTS       8192
+#define BIG_AREA        (64 * W25Q128_SECTOR_SIZE)
+#define CHURN_OPS       200000
+#define RT_OPS          5000
+#define PF_CAP          48
+#define PF_SLOTS        128
+#define PF_AREA         (2 * W25Q128_SECTOR_SIZE)
+#define PF_OPS          800
+#define PF_POOL         56      // 掉电序列使用的 UID 个数（多于容量，会遇到表满）
+#define SCRATCH_BASE    FLASH_FATFS_BASE    // 模拟器中的空白映像，3、4 借用 FatFs 区
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static uint32_t rnd(uint32_t *s)
+{
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 8;
+}
+
+static uint32_t rnd32(uint32_t *s)
+{
+    return (rnd(s) << 16) ^ rnd(s);
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void make_name(char *name, uint32_t uid)
+{
+    snprintf(name, TAG_NAME_MAX + 1, "user%08X", (unsigned)uid);
+}
+
+// =============================================================================
+// 参照表：线性查找，只用来核对
+// =============================================================================
+
+typedef struct {
+    TagEntry *e;
+    uint32_t  cap;
+    uint32_t  count;
+} RefTable;
+
+static TagEntry *ref_find(RefTable *r, uint32_t uid)
+{
+    for (uint32_t i = 0; i < r->count; i++) {
+        if (r->e[i].uid == uid) {
+            return &r->e[i];
+        }
+    }
+    return NULL;
+}
+
+static int ref_put(RefTable *r, uint32_t uid, uint16_t perm, const char *name)
+{
+    TagEntry *e = ref_find(r, uid);
+
+    if (e == NULL) {
+        if (r->count >= r->cap) {
+            return TAG_ERR_FULL;
+        }
+        e = &r->e[r->count++];
+        memset(e, 0, sizeof(*e));
+        e->uid = uid;
+    }
+    e->perm = perm;
+    strncpy(e->name, name, TAG_NAME_MAX);
+    e->name[TAG_NAME_MAX] = '\0';
+    return TAG_OK;
+}
+
+static void ref_del(RefTable *r, uint32_t uid)
+{
+    TagEntry *e = ref_find(r, uid);
+
+    if (e != NULL) {
+        *e = r->e[--r->count];
+    }
+}
+
+/**
+ * @brief 表与参照表逐条比较，同时检查哈希索引：非空槽数等于条目数，每个条目都能从起始槽找到
+ */
+static int table_equal(TagTable *t, RefTable *r, int check_seen)
+{
+    uint32_t used = 0;
+
+    if (t->count != r->count) {
+        return 0;
+    }
+    for (uint32_t i = 0; i <= t->mask; i++) {
+        if (t->slots[i] != TAG_SLOT_EMPTY) {
+            if (t->slots[i] >= t->count) {
+                return 0;
+            }
+            used++;
+        }
+    }
+    if (used != t->count) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < r->count; i++) {
+        TagEntry *e = TagTable_Find(t, r->e[i].uid);
+
+        if (e == NULL || e->perm != r->e[i].perm || strcmp(e->name, r->e[i].name) != 0 ||
+            (check_seen && e->last_seen != r->e[i].last_seen)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// =============================================================================
+// 1. 查找
+// =============================================================================
+
+static TagEntry big_entries[BIG_CAP], big_ref_entries[BIG_CAP];
+static uint16_t big_slots[BIG_SLOTS];
+static uint32_t big_uids[BIG_CAP];
+
+static void probe_stats(TagTable *t, uint32_t n, uint32_t *seed, double *hit, double *miss, uint32_t *max)
+{
+    uint32_t found = 0;
+
+    memset(&t->stats, 0, sizeof(t->stats));
+    for (uint32_t i = 0; i < n; i++) {
+        found += TagTable_Find(t, big_uids[i]) != NULL;
+    }
+    *hit = (double)t->stats.probes / t->stats.lookups;
+    *max = t->stats.max_probe;
+    check(found == n, "every registered UID found");
+
+    memset(&t->stats, 0, sizeof(t->stats));
+    found = 0;
+    for (uint32_t i = 0; i < 100000; i++) {
+        found += TagTable_Find(t, rnd32(seed) | 0x80000000u) != NULL;     // 登记的 UID 最高位为 0
+    }
+    *miss = (double)t->stats.probes / t->stats.lookups;
+    if (t->stats.max_probe > *max) {
+        *max = t->stats.max_probe;
+    }
+    check(found == 0, "unregistered UIDs not found");
+}
+
+static void test_lookup(void)
+{
+    static const uint32_t levels[] = { 1000, 2000, 4000 };
+    TagTable t;
+    RefTable ref = { big_ref_entries, BIG_CAP, 0 };
+    uint32_t seed = 7, n = 0, maxp;
+    double hit, miss, t0, hash_ns, linear_ns;
+    volatile uint32_t sink = 0;
+    char name[TAG_NAME_MAX + 1];
+    uint64_t f0;
+
+    printf("lookup (table of %u entries, %u slots):\n", BIG_CAP, BIG_SLOTS);
+    TagTable_Init(&t, big_entries, BIG_CAP, big_slots, BIG_SLOTS);
+    for (uint32_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        while (n < levels[l]) {
+            uint32_t uid = rnd32(&seed) & 0x7FFFFFFFu;
+
+            if (uid == 0 || TagTable_Find(&t, uid) != NULL) {
+                continue;
+            }
+            make_name(name, uid);
+            TagTable_Put(&t, uid, (uint16_t)uid, name);
+            big_uids[n++] = uid;
+        }
+        probe_stats(&t, n, &seed, &hit, &miss, &maxp);
+        printf("  %4u tags (load %4.2f): avg probes hit %.2f miss %.2f, longest %u\n", (unsigned)n,
+               (double)n / BIG_SLOTS, hit, miss, (unsigned)maxp);
+    }
+    check(hit < 1.5 && miss < 2.5, "average probe length stays short at load 0.49");
+
+    // 哈希查找与逐条比较（主机上的耗时，只看比例）
+    t0 = now_us();
+    for (uint32_t k = 0; k < 100; k++) {
+        for (uint32_t i = 0; i < n; i++) {
+            sink += TagTable_Find(&t, big_uids[i])->perm;
+        }
+    }
+    hash_ns = (now_us() - t0) * 1000 / (100.0 * n);
+    t0 = now_us();
+    for (uint32_t i = 0; i < n; i += 4) {
+        for (uint32_t j = 0; j < t.count; j++) {
+            if (big_entries[j].uid == big_uids[i]) {
+                sink += big_entries[j].perm;
+                break;
+            }
+        }
+    }
+    linear_ns = (now_us() - t0) * 1000 / (n / 4.0);
+    printf("  per lookup at %u tags: hash %.1f ns, linear scan in RAM %.0f ns (host)\n", (unsigned)n, hash_ns,
+           linear_ns);
+
+    // 不建索引、每次刷卡按顺序读出 Flash 上的记录：平均读一半
+    f0 = W25Q128_Sim_Time_us();
+    for (uint32_t ofs = 0; ofs < n / 2 * TAG_RECORD_SIZE; ofs += 256) {
+        uint8_t page[256];
+        W25Q128_ReadData(page, SCRATCH_BASE + ofs, sizeof(page));
+    }
+    printf("  scanning %u records on flash per card: %.1f ms on average (SPI at 21 MHz, simulated)\n",
+           (unsigned)n, (W25Q128_Sim_Time_us() - f0) / 1000.0);
+
+    // 随机登记/删除，与参照表比较（删除后移槽，不留标记）
+    for (uint32_t i = 0; i < n; i++) {
+        make_name(name, big_uids[i]);
+        ref_put(&ref, big_uids[i], (uint16_t)big_uids[i], name);
+    }
+    for (uint32_t k = 0; k < CHURN_OPS; k++) {
+        uint32_t uid = big_uids[rnd(&seed) % n];
+
+        if (rnd(&seed) % 2) {
+            check(TagTable_Remove(&t, uid) == (ref_find(&ref, uid) != NULL ? TAG_OK : TAG_ERR_NOT_FOUND),
+                  "remove result matches reference");
+            ref_del(&ref, uid);
+        } else {
+            make_name(name, uid ^ k);
+            check(TagTable_Put(&t, uid, (uint16_t)k, name) == ref_put(&ref, uid, (uint16_t)k, name),
+                  "put result matches reference");
+        }
+        if (k % 50000 == 49999) {
+            check(table_equal(&t, &ref, 0), "table matches reference during churn");
+        }
+    }
+    probe_stats(&t, 0, &seed, &hit, &miss, &maxp);
+    printf("  after %u random puts/removes: %u tags, avg probes miss %.2f, longest %u\n", CHURN_OPS,
+           (unsigned)t.count, miss, (unsigned)maxp);
+    check(table_equal(&t, &ref, 0), "table matches reference after churn");
+    (void)sink;
+}
+
+// =============================================================================
+// 2、3. 持久化往返
+// =============================================================================
+
+static TagEntry rt_entries[2][BIG_CAP], rt_ref_entries[BIG_CAP];
+static uint16_t rt_slots[2][BIG_SLOTS];
+static uint32_t lat_us[RT_OPS + BIG_CAP];
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * @brief 一次修改：先改表再追加记录，与固件 rfid_access.c 的顺序相同
+ * @param op 0-登记/修改 1-刷卡 2-删除
+ */
+static int apply(TagTable *t, TagStore *s, RefTable *r, uint32_t op, uint32_t uid, uint32_t arg)
+{
+    char name[TAG_NAME_MAX + 1];
+    TagEntry *e;
+    int ret;
+
+    switch (op) {
+    case 0:
+        make_name(name, uid ^ arg);
+        ret = TagTable_Put(t, uid, (uint16_t)arg, name);
+        if (ret != TAG_OK) {
+            return ret;
+        }
+        ref_put(r, uid, (uint16_t)arg, name);
+        return TagStore_Put(s, TagTable_Find(t, uid));
+    case 1:
+        e = TagTable_Find(t, uid);
+        if (e == NULL) {
+            return TAG_OK;
+        }
+        e->last_seen = arg;
+        ref_find(r, uid)->last_seen = arg;
+        return TagStore_Seen(s, uid, arg);
+    default:
+        if (TagTable_Remove(t, uid) != TAG_OK) {
+            return TAG_OK;
+        }
+        ref_del(r, uid);
+        return TagStore_Delete(s, uid);
+    }
+}
+
+static uint32_t flash_write_ops(void)
+{
+    W25Q128_Sim_Stats st;
+
+    W25Q128_Sim_GetStats(&st);
+    return st.page_programs + st.sector_erases;
+}
+
+/**
+ * @brief 重新载入到另一组数组，与参照表比较
+ */
+static int reload(TagStore *s, uint32_t base, uint32_t area, uint32_t cap, uint32_t nslots, int which,
+                  RefTable *ref, TagTable *t, uint64_t *load_us)
+{
+    uint64_t t0;
+
+    *s = (TagStore)TAG_STORE_INIT(base, area);
+    TagTable_Init(t, rt_entries[which], cap, rt_slots[which], nslots);
+    t0 = W25Q128_Sim_Time_us();
+    if (TagStore_Load(s, t) != TAG_OK) {
+        return 0;
+    }
+    if (load_us != NULL) {
+        *load_us = W25Q128_Sim_Time_us() - t0;
+    }
+    return table_equal(t, ref, 1);
+}
+
+static void round_trip(const char *label, uint32_t base, uint32_t area, uint32_t cap, uint32_t nslots,
+                       uint32_t ops)
+{
+    TagTable t;
+    TagStore s;
+    RefTable ref = { rt_ref_entries, cap, 0 };
+    uint32_t seed = 99, nlat = 0, errors = 0, next_uid = 1;
+    uint64_t sum = 0, load_us = 0;
+    W25Q128_Sim_Stats st;
+
+    memset(W25Q128_Sim_Memory() + base, 0xFF, 2 * area);
+    W25Q128_Sim_ResetStats();
+    reload(&s, base, area, cap, nslots, 0, &ref, &t, NULL);
+
+    // 登记满，然后随机修改：一半刷卡，四分之一改权限和名字，四分之一删除后登记一张新卡
+    for (uint32_t i = 0; i < cap + ops; i++) {
+        uint64_t t0 = W25Q128_Sim_Time_us();
+        uint32_t uid, op, r = rnd(&seed) % 4;
+        int ret;
+
+        if (i < cap) {
+            op = 0;
+            uid = next_uid++ * 2654435761u;
+        } else {
+            uid = ref.e[rnd(&seed) % ref.count].uid;
+            op = r < 2 ? 1 : (r == 2 ? 0 : 2);
+        }
+        ret = apply(&t, &s, &ref, op, uid, op == 1 ? 1000000 + i : i);
+        if (op == 2 && ret == TAG_OK) {
+            ret = apply(&t, &s, &ref, 0, next_uid++ * 2654435761u, i);
+        }
+        errors += ret != TAG_OK;
+        lat_us[nlat] = (uint32_t)(W25Q128_Sim_Time_us() - t0);
+        sum += lat_us[nlat++];
+    }
+    W25Q128_Sim_GetStats(&st);
+    qsort(lat_us, nlat, sizeof(lat_us[0]), cmp_u32);
+    printf("  %s: %u tags, %u changes: flash per change avg %.2f ms p99 %.2f max %.1f; "
+           "%u compactions, %u erases, %u page programs\n",
+           label, (unsigned)ref.count, (unsigned)nlat, sum / 1000.0 / nlat, lat_us[nlat * 99 / 100] / 1000.0,
+           lat_us[nlat - 1] / 1000.0, (unsigned)s.stats.compactions, (unsigned)st.sector_erases,
+           (unsigned)st.page_programs);
+    check(errors == 0, "every change written");
+
+    check(reload(&s, base, area, cap, nslots, 1, &ref, &t, &load_us), "reloaded table matches reference");
+    printf("  %s: reload replays %u records in %.1f ms (simulated), table identical\n", label,
+           (unsigned)s.stats.replayed, load_us / 1000.0);
+
+    // 载入后接着写，再载入一次（写指针恢复到日志结尾）
+    for (uint32_t i = 0; i < ops / 5; i++) {
+        uint32_t uid = ref.e[rnd(&seed) % ref.count].uid;
+        errors += apply(&t, &s, &ref, rnd(&seed) % 2, uid, 2000000 + i) != TAG_OK;
+    }
+    check(errors == 0 && reload(&s, base, area, cap, nslots, 0, &ref, &t, NULL),
+          "changes after a reload survive another reload");
+}
+
+static void test_persist(void)
+{
+    printf("persistence:\n");
+    round_trip("firmware partition", FLASH_TAG_BASE, FLASH_TAG_AREA_SIZE, TAG_DB_MAX, TAG_DB_SLOTS, RT_OPS);
+    round_trip("4000 tags", SCRATCH_BASE, BIG_AREA, 4000, BIG_SLOTS, RT_OPS);
+}
+
+// =============================================================================
+// 4. 掉电注入
+// =============================================================================
+
+typedef struct {
+    uint8_t  op;
+    uint32_t uid;
+    uint32_t arg;
+} PfOp;
+
+static PfOp pf_ops[PF_OPS];
+static TagEntry pf_ref_entries[2][PF_CAP];
+
+static void pf_model(RefTable *r, uint32_t n)
+{
+    char name[TAG_NAME_MAX + 1];
+
+    r->count = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        TagEntry *e = ref_find(r, pf_ops[i].uid);
+
+        if (pf_ops[i].op == 0) {
+            make_name(name, pf_ops[i].uid ^ pf_ops[i].arg);
+            ref_put(r, pf_ops[i].uid, (uint16_t)pf_ops[i].arg, name);
+        } else if (pf_ops[i].op == 1 && e != NULL) {
+            e->last_seen = pf_ops[i].arg;
+        } else if (pf_ops[i].op == 2) {
+            ref_del(r, pf_ops[i].uid);
+        }
+    }
+}
+
+/**
+ * @brief 执行修改序列直到掉电
+ * @return 掉电时正在进行的修改序号，没有掉电时为 PF_OPS
+ */
+static uint32_t pf_sequence(TagTable *t, TagStore *s)
+{
+    RefTable scratch = { pf_ref_entries[1], PF_CAP, 0 };
+
+    for (uint32_t i = 0; i < PF_OPS; i++) {
+        apply(t, s, &scratch, pf_ops[i].op, pf_ops[i].uid, pf_ops[i].arg);
+        if (W25Q128_Sim_PowerLost()) {
+            return i;
+        }
+    }
+    return PF_OPS;
+}
+
+static void test_power_fail(void)
+{
+    TagTable t;
+    TagStore s;
+    RefTable before = { pf_ref_entries[0], PF_CAP, 0 }, after = { pf_ref_entries[1], PF_CAP, 0 };
+    uint32_t seed = 5, ops, pass = 0, fail = 0;
+
+    for (uint32_t i = 0; i < PF_OPS; i++) {
+        uint32_t r = rnd(&seed) % 8;
+
+        pf_ops[i].op = r < 4 ? 0 : (r < 6 ? 1 : 2);
+        pf_ops[i].uid = 0x1000u + rnd(&seed) % PF_POOL;
+        pf_ops[i].arg = 1 + i;
+    }
+
+    memset(W25Q128_Sim_Memory() + SCRATCH_BASE, 0xFF, 2 * PF_AREA);
+    W25Q128_Sim_ResetStats();
+    reload(&s, SCRATCH_BASE, PF_AREA, PF_CAP, PF_SLOTS, 0, &after, &t, NULL);
+    pf_sequence(&t, &s);
+    ops = flash_write_ops();
+    printf("power loss (%u changes on a %u KB area, %u compactions = %u flash write ops):\n", PF_OPS,
+           PF_AREA / 1024, (unsigned)s.stats.compactions, (unsigned)ops);
+
+    for (uint32_t k = 1; k <= ops; k++) {
+        RefTable *match;
+        uint32_t cut;
+
+        memset(W25Q128_Sim_Memory() + SCRATCH_BASE, 0xFF, 2 * PF_AREA);
+        before.count = 0;
+        reload(&s, SCRATCH_BASE, PF_AREA, PF_CAP, PF_SLOTS, 0, &before, &t, NULL);
+        W25Q128_Sim_FailAfter(k);
+        cut = pf_sequence(&t, &s);
+        W25Q128_Sim_PowerCycle();
+
+        // 载入的表等于第 cut 次修改之前或之后的状态
+        pf_model(&before, cut);
+        pf_model(&after, cut < PF_OPS ? cut + 1 : cut);
+        if (reload(&s, SCRATCH_BASE, PF_AREA, PF_CAP, PF_SLOTS, 1, &before, &t, NULL)) {
+            match = &before;
+        } else if (reload(&s, SCRATCH_BASE, PF_AREA, PF_CAP, PF_SLOTS, 1, &after, &t, NULL)) {
+            match = &after;
+        } else {
+            printf("  cut %u (change %u): reloaded table matches neither state\n", (unsigned)k, (unsigned)cut);
+            fail++;
+            continue;
+        }
+
+        // 恢复后继续修改（修改已登记的卡，表满时也能写）
+        if (apply(&t, &s, match, 0, match->count ? match->e[0].uid : 0x2000u, k) != TAG_OK ||
+            !reload(&s, SCRATCH_BASE, PF_AREA, PF_CAP, PF_SLOTS, 0, match, &t, NULL)) {
+            printf("  cut %u: change after recovery lost\n", (unsigned)k);
+            fail++;
+            continue;
+        }
+        pass++;
+    }
+    printf("  %u cut points, %u passed, %u failed\n", (unsigned)ops, (unsigned)pass, (unsigned)fail);
+    check(fail == 0, "every power cut recovers to a consistent table");
+}
+
+int main(void)
+{
+    W25Q128_Sim_Open(NULL);
+    test_lookup();
+    test_persist();
+    test_power_fail();
+    W25Q128_Sim_Close();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,547 @@
+// telem_bench.c - 遥测数据流：编码、抽样、接收的一致性检查与串口带宽对比
+//
+// 1. COBS 编码：已知向量、随机数据往返、输出不含 0x00、长度上界
+// 2. 通道参数与抽样：格式串与结构体大小不符时拒绝，按间隔抽样（含抖动）的样本数和帧数
+// 3. 60 秒（模拟时间）的整机负载，与固件同一份 telemetry.c 和 crc.c：
+//    200Hz 六轴原始值（imu 通道）+ 50Hz 派生量（motion 通道），每 100ms 一行 printf 文本，
+//    每 250ms 一条二进制日志记录（含 0x00），每 5 秒重发描述帧。
+//    发送缓冲区为 1024 字节（DEBUG_TX_RING_SIZE），921600bps 每毫秒发出约 92 字节；
+//    遥测帧整帧写入、放不下丢弃，文本和日志放不下时等待（DEBUG_TX_BLOCK）。
+//    接收端（telem_decode.c）检查每个样本的时间和数值、没有丢帧，
+//    非遥测字节与文本和日志的原始字节流逐字节相同。抓到的串口数据保存为 telem_capture.bin。
+// 4. 同样负载加一次 8KB 的 printf 突发：文本照常发完，遥测丢帧且接收端统计的丢帧数与发送端一致
+// 5. 字节预算：预算低于负载时超出的帧被丢弃，实际字节率不超过预算
+// 6. 逐字节损坏后接收端不输出错误样本，丢帧被计数
+// 7. 与 MPU_NimingReport（匿名上位机协议，每帧 32 字节，无时间戳）的字节数和写入调用次数对比
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "telemetry.h"
+#include "telem_decode.h"
+
+#define SIM_MS          60000
+#define RATE_HZ         200
+#define RING_SIZE       1024            // 与 debug.h 的 DEBUG_TX_RING_SIZE 相同
+#define UART_BPS        921600
+#define WIRE_MAX        (4u * 1024 * 1024)
+#define OTHER_MAX       (1024u * 1024)
+#define BURST_AT        30020
+#define BURST_BYTES     8192
+#define NIMING_FRAME    32              // 0x88 功能字 长度 28 字节数据 校验和
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static uint32_t rnd(uint32_t *s)
+{
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 8;
+}
+
+// =============================================================================
+// 1. COBS
+// =============================================================================
+
+static void test_cobs(void)
+{
+    static const struct {
+        uint8_t in[8], in_len;
+        uint8_t out[8], out_len;
+    } vec[] = {
+        { { 0x00 }, 1, { 0x01, 0x01 }, 2 },
+        { { 0x00, 0x00 }, 2, { 0x01, 0x01, 0x01 }, 3 },
+        { { 0x11, 0x22, 0x00, 0x33 }, 4, { 0x03, 0x11, 0x22, 0x02, 0x33 }, 5 },
+        { { 0x11, 0x22, 0x33, 0x44 }, 4, { 0x05, 0x11, 0x22, 0x33, 0x44 }, 5 },
+        { { 0x11, 0x00, 0x00, 0x00 }, 4, { 0x02, 0x11, 0x01, 0x01, 0x01 }, 5 },
+    };
+    uint8_t in[600], enc[620], dec[620];
+    uint32_t seed = 7, bad = 0;
+
+    for (uint32_t v = 0; v < sizeof(vec) / sizeof(vec[0]); v++) {
+        uint32_t n = Telem_CobsEncode(vec[v].in, vec[v].in_len, enc);
+
+        check(n == vec[v].out_len && memcmp(enc, vec[v].out, n) == 0, "COBS known vector");
+    }
+    // 254 个非零字节正好填满一个块，255 个跨块
+    memset(in, 0x5A, sizeof(in));
+    check(Telem_CobsEncode(in, 254, enc) == 256 && enc[0] == 0xFF && enc[255] == 0x01, "COBS 254-byte block");
+    check(Telem_CobsEncode(in, 255, enc) == 257 && enc[255] == 0x02, "COBS block boundary");
+
+    for (uint32_t r = 0; r < 20000; r++) {
+        uint32_t len = rnd(&seed) % sizeof(in);
+        uint32_t zeros = rnd(&seed) % 4;        // 0 全随机，1 多零，2 无零，3 全零
+        uint32_t n;
+        int32_t m;
+
+        for (uint32_t i = 0; i < len; i++) {
+            uint8_t b = (uint8_t)rnd(&seed);
+
+            in[i] = zeros == 1 ? (b < 128 ? 0 : b) : zeros == 2 ? (uint8_t)(b | 1) : zeros == 3 ? 0 : b;
+        }
+        n = Telem_CobsEncode(in, len, enc);
+        m = Telem_CobsDecode(enc, n, dec);
+        if (n > len + len / 254 + 1 || memchr(enc, 0, n) != NULL || m != (int32_t)len || memcmp(in, dec, len) != 0) {
+            bad++;
+        }
+    }
+    check(bad == 0, "COBS random round trip");
+    enc[0] = 0x05;
+    check(Telem_CobsDecode(enc, 3, dec) < 0, "COBS truncated block rejected");
+    printf("COBS: 5 vectors, 20000 random round trips, %u bad\n", (unsigned)bad);
+}
+
+// =============================================================================
+// 2. 通道参数与抽样
+// =============================================================================
+
+static uint32_t null_frames;
+
+static uint32_t null_output(const uint8_t *data, uint32_t len)
+{
+    (void)data;
+    null_frames++;
+    return len;
+}
+
+static void test_channel(void)
+{
+    struct { uint8_t flag; uint32_t value; } padded;
+    TelemChannel ch;
+    uint8_t sample[12] = { 0 };
+    uint32_t seed = 3;
+
+    Telem_Init(null_output, 0);
+    check(Telem_ChannelInit(&ch, 3, "pad", "BI", "flag value", sizeof(padded), 4, 0) == TELEM_ERR_PARAM,
+          "struct padding detected by the format string");
+    check(Telem_ChannelInit(&ch, TELEM_SCHEMA_ID, "x", "h", "x", 2, 4, 0) == TELEM_ERR_PARAM, "channel 0 reserved");
+    check(Telem_ChannelInit(&ch, 4, "big", "hhhhhh", NULL, 12, 200, 0) == TELEM_OK &&
+          ch.batch == TELEM_MAX_PAYLOAD / 12, "batch limited to the payload size");
+
+    // 200Hz 输入，20ms 间隔，10 秒：500 个样本、50 帧
+    Telem_ChannelInit(&ch, 2, "motion", "hhhhhh", NULL, 12, 10, 20);
+    null_frames = 0;
+    for (uint32_t t = 0; t < 10000; t += 5) {
+        Telem_Push(&ch, t, sample);
+    }
+    check(ch.stats.offered == 2000 && ch.stats.sampled == 500 && ch.stats.frames == 50 && null_frames == 50,
+          "decimation 200Hz -> 50Hz");
+    printf("decimation: offered %u, sampled %u, frames %u\n",
+           (unsigned)ch.stats.offered, (unsigned)ch.stats.sampled, (unsigned)ch.stats.frames);
+
+    // 采样时刻 ±2ms 抖动：平均速率不变
+    Telem_ChannelInit(&ch, 2, "motion", "hhhhhh", NULL, 12, 10, 20);
+    for (uint32_t k = 0; k < 2000; k++) {
+        Telem_Push(&ch, k * 5 + rnd(&seed) % 5, sample);
+    }
+    printf("with jitter: sampled %u (expected ~500)\n", (unsigned)ch.stats.sampled);
+    check(ch.stats.sampled >= 495 && ch.stats.sampled <= 505, "decimation keeps the average rate under jitter");
+
+    // 修改间隔后立即生效
+    Telem_ChannelInit(&ch, 2, "motion", "hhhhhh", NULL, 12, 10, 20);
+    Telem_SetPeriod(&ch, 100);
+    for (uint32_t t = 0; t < 10000; t += 5) {
+        Telem_Push(&ch, t, sample);
+    }
+    check(ch.stats.sampled == 100, "period change applied");
+}
+
+// =============================================================================
+// 3~6. 整机负载
+// =============================================================================
+
+typedef struct {
+    int16_t v[6];
+} ImuSample;
+
+typedef struct {
+    uint32_t steps;
+    int16_t  pitch, roll;
+    uint16_t amag, step;
+} MotionSample;
+
+static void imu_expected(uint32_t i, ImuSample *s)
+{
+    for (uint32_t k = 0; k < 6; k++) {
+        s->v[k] = (int16_t)((i * (k + 1) * 37) ^ (k << 12));    // 低字节经常是 0x00
+    }
+}
+
+static void motion_expected(uint32_t i, MotionSample *s)
+{
+    s->steps = i / 100;
+    s->pitch = (int16_t)(i % 3000) - 1500;
+    s->roll = (int16_t)(-(int32_t)(i % 1800));
+    s->amag = (uint16_t)(16384 + i % 100);
+    s->step = i % 100 == 0;
+}
+
+// 发送缓冲区与串口
+static uint8_t ring[RING_SIZE];
+static uint32_t ring_head, ring_tail;       // 累计写入/发出的字节数
+static uint8_t *wire;
+static uint32_t wire_len;
+static uint32_t tx_calls;
+static uint32_t uart_credit;                // 千分之一字节
+
+// 等待中的文本和日志（阻塞写入的任务）
+static uint8_t *pending;
+static uint32_t pend_head, pend_tail;
+static uint32_t pend_since;                 // 最早一个未写完字节的提交时间
+static uint32_t max_wait;
+static uint8_t *other_ref;                  // 文本和日志的原始字节流
+static uint32_t other_ref_len;
+
+static uint32_t ring_free(void)
+{
+    return RING_SIZE - (ring_head - ring_tail);
+}
+
+static void ring_put(const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        ring[ring_head++ % RING_SIZE] = data[i];
+    }
+}
+
+// Debug_TryWriteRecord：整帧写入，放不下丢弃
+static uint32_t sim_try_write(const uint8_t *data, uint32_t len)
+{
+    tx_calls++;
+    if (ring_free() < len) {
+        return 0;
+    }
+    ring_put(data, len);
+    return len;
+}
+
+// printf / Debug_WriteRecord（DEBUG_TX_BLOCK）：放不下的部分等待
+static void sim_block_write(uint32_t now, const uint8_t *data, uint32_t len)
+{
+    if (pend_head == pend_tail) {
+        pend_since = now;
+    }
+    memcpy(pending + pend_head, data, len);
+    pend_head += len;
+    memcpy(other_ref + other_ref_len, data, len);
+    other_ref_len += len;
+}
+
+static void pump_pending(uint32_t now)
+{
+    uint32_t n = pend_head - pend_tail;
+
+    if (n == 0) {
+        return;
+    }
+    if (n > ring_free()) {
+        n = ring_free();
+    }
+    tx_calls++;
+    ring_put(pending + pend_tail, n);
+    pend_tail += n;
+    if (pend_head == pend_tail) {
+        if (now - pend_since > max_wait) {
+            max_wait = now - pend_since;
+        }
+        pend_head = pend_tail = 0;
+    }
+}
+
+static void uart_drain(void)
+{
+    // 921600bps、8N1：每毫秒 92.16 字节，空闲的时间不能攒下来
+    uart_credit += UART_BPS / 10;
+    while (ring_tail < ring_head && uart_credit >= 1000) {
+        wire[wire_len++] = ring[ring_tail++ % RING_SIZE];
+        uart_credit -= 1000;
+    }
+    if (ring_tail == ring_head && uart_credit > UART_BPS / 10) {
+        uart_credit = UART_BPS / 10;
+    }
+}
+
+typedef struct {
+    uint32_t budget;
+    int      burst;
+    uint32_t telem_bytes;
+    uint32_t frames, dropped, throttled;
+    uint32_t imu_sampled, motion_sampled;
+    double   push_ns;
+} SimResult;
+
+static void run_sim(SimResult *res)
+{
+    TelemChannel imu_ch, motion_ch;
+    uint32_t log_seq = 0;
+    struct timespec t0, t1;
+    double push_ns = 0;
+
+    ring_head = ring_tail = wire_len = tx_calls = uart_credit = 0;
+    pend_head = pend_tail = max_wait = other_ref_len = 0;
+
+    Telem_Init(sim_try_write, res->budget);
+    Telem_ChannelInit(&imu_ch, 1, "imu", "hhhhhh", "ax ay az gx gy gz", sizeof(ImuSample), 10, 0);
+    Telem_ChannelInit(&motion_ch, 2, "motion", "IhhHH", "steps pitch roll amag step", sizeof(MotionSample), 10, 20);
+
+    for (uint32_t now = 0; now < SIM_MS; now++) {
+        if (now % 5000 == 0) {
+            Telem_Announce(&imu_ch);
+            Telem_Announce(&motion_ch);
+        }
+        if (now % (1000 / RATE_HZ) == 0) {
+            uint32_t i = now / (1000 / RATE_HZ);
+            ImuSample imu;
+
+            imu_expected(i, &imu);
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            Telem_Push(&imu_ch, now, &imu);
+            if (Telem_Due(&motion_ch, now)) {
+                MotionSample m;
+
+                motion_expected(i, &m);
+                Telem_Push(&motion_ch, now, &m);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            push_ns += (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+        }
+        if (now % 100 == 0) {
+            char line[64];
+            int n = snprintf(line, sizeof(line), "Step detected! Total steps: %u\r\n", (unsigned)(now / 100));
+
+            sim_block_write(now, (const uint8_t *)line, (uint32_t)n);
+        }
+        if (now % 250 == 0) {
+            // 二进制日志记录：0xF8|参数个数 编号(2) 时间戳(4) 参数，编号和参数中有 0x00
+            uint8_t rec[11] = { 0xF9, 0x00, 0x00, (uint8_t)now, (uint8_t)(now >> 8), 0, 0,
+                                (uint8_t)log_seq, 0, 0, 0 };
+
+            sim_block_write(now, rec, sizeof(rec));
+            log_seq++;
+        }
+        if (res->burst && now == BURST_AT) {
+            // 例如 tasks 命令打印任务列表
+            static uint8_t burst[BURST_BYTES];
+
+            for (uint32_t i = 0; i < sizeof(burst); i++) {
+                burst[i] = (uint8_t)(i % 64 == 63 ? '\n' : 'a' + i % 26);
+            }
+            sim_block_write(now, burst, sizeof(burst));
+        }
+        pump_pending(now);
+        uart_drain();
+    }
+    Telem_Flush(&imu_ch);
+    Telem_Flush(&motion_ch);
+    if (res->budget != 0) {
+        // 预算恢复后各发一帧，接收端才能从序号看出最后几帧被丢弃
+        ImuSample imu;
+        MotionSample m;
+
+        imu_expected((SIM_MS + 2000) / (1000 / RATE_HZ), &imu);
+        motion_expected((SIM_MS + 2000) / (1000 / RATE_HZ), &m);
+        Telem_Push(&imu_ch, SIM_MS + 2000, &imu);
+        Telem_Flush(&imu_ch);
+        Telem_Push(&motion_ch, SIM_MS + 2000, &m);
+        Telem_Flush(&motion_ch);
+    }
+    for (uint32_t now = SIM_MS; ring_tail < ring_head || pend_head != pend_tail; now++) {
+        pump_pending(now);
+        uart_drain();
+    }
+
+    res->telem_bytes = imu_ch.stats.bytes + motion_ch.stats.bytes;
+    res->frames = imu_ch.stats.frames + motion_ch.stats.frames;
+    res->dropped = imu_ch.stats.dropped + motion_ch.stats.dropped;
+    res->throttled = imu_ch.stats.throttled + motion_ch.stats.throttled;
+    res->imu_sampled = imu_ch.stats.sampled;
+    res->motion_sampled = motion_ch.stats.sampled;
+    res->push_ns = push_ns / (SIM_MS / (1000 / RATE_HZ));
+}
+
+// 接收端校验
+typedef struct {
+    uint32_t imu, motion;
+    uint32_t mismatch;
+    int32_t  last_imu, last_motion;
+    uint8_t *other;
+    uint32_t other_len;
+} Verify;
+
+static void on_sample(void *ctx, const TelemRxChannel *ch, const TelemRxSample *s)
+{
+    Verify *v = ctx;
+    uint32_t i = s->t_ms / (1000 / RATE_HZ);
+
+    if (s->t_ms % (1000 / RATE_HZ) != 0) {
+        v->mismatch++;
+        return;
+    }
+    if (ch->id == 1) {
+        ImuSample e;
+
+        imu_expected(i, &e);
+        if (strcmp(ch->name, "imu") != 0 || memcmp(s->raw, &e, sizeof(e)) != 0 || s->value[2] != e.v[2] ||
+            (int32_t)i <= v->last_imu) {
+            v->mismatch++;
+        }
+        v->last_imu = (int32_t)i;
+        v->imu++;
+    } else if (ch->id == 2) {
+        MotionSample e;
+
+        motion_expected(i, &e);
+        if (s->t_ms % 20 != 0 || memcmp(s->raw, &e, sizeof(e)) != 0 || s->value[1] != e.pitch ||
+            s->value[0] != e.steps || (int32_t)i <= v->last_motion) {
+            v->mismatch++;
+        }
+        v->last_motion = (int32_t)i;
+        v->motion++;
+    } else {
+        v->mismatch++;
+    }
+}
+
+static void on_other(void *ctx, const uint8_t *data, size_t len)
+{
+    Verify *v = ctx;
+
+    if (v->other_len + len <= OTHER_MAX) {
+        memcpy(v->other + v->other_len, data, len);
+    }
+    v->other_len += (uint32_t)len;
+}
+
+static void receive(const uint8_t *data, uint32_t len, uint32_t chunk, TelemReceiver *rx, Verify *v)
+{
+    TelemRxSink sink = { NULL, on_sample, on_other, v, NULL };
+    uint8_t *other = v->other;
+
+    memset(v, 0, sizeof(*v));
+    v->other = other;
+    v->last_imu = v->last_motion = -1;
+    TelemRx_Init(rx, &sink);
+    for (uint32_t off = 0; off < len; off += chunk) {
+        TelemRx_Feed(rx, data + off, len - off < chunk ? len - off : chunk);
+    }
+    TelemRx_Flush(rx);
+}
+
+int main(void)
+{
+    static TelemReceiver rx;
+    static Verify v;
+    SimResult base = { 0 }, burst = { 0 }, budget = { 0 };
+    uint32_t base_calls, text_wait;
+    uint8_t *corrupt;
+
+    wire = malloc(WIRE_MAX);
+    pending = malloc(OTHER_MAX);
+    other_ref = malloc(OTHER_MAX);
+    v.other = malloc(OTHER_MAX);
+    corrupt = malloc(WIRE_MAX);
+
+    test_cobs();
+    test_channel();
+
+    // 3. 正常负载
+    run_sim(&base);
+    base_calls = tx_calls;
+    text_wait = max_wait;
+    receive(wire, wire_len, 4096, &rx, &v);
+    printf("\n60 s at %u Hz: imu %u samples, motion %u samples, %u frames, %u dropped\n",
+           RATE_HZ, (unsigned)base.imu_sampled, (unsigned)base.motion_sampled, (unsigned)base.frames,
+           (unsigned)base.dropped);
+    printf("  received %u imu + %u motion samples, %u frames, %u lost, %u schema frames, %u mismatches\n",
+           (unsigned)v.imu, (unsigned)v.motion, (unsigned)rx.stats.frames, (unsigned)rx.stats.lost,
+           (unsigned)rx.stats.schemas, (unsigned)v.mismatch);
+    printf("  other bytes %u (text + binlog sent %u), longest printf wait %u ms\n",
+           (unsigned)v.other_len, (unsigned)other_ref_len, (unsigned)text_wait);
+    check(base.imu_sampled == SIM_MS / 5 && base.motion_sampled == SIM_MS / 20, "sample counts");
+    check(base.dropped == 0 && v.imu == SIM_MS / 5 && v.motion == SIM_MS / 20 && v.mismatch == 0 &&
+          rx.stats.lost == 0 && rx.stats.bad_frames == 0, "every sample received with the right time and value");
+    check(rx.stats.schemas == 2 * (SIM_MS / 5000), "schema frames");
+    check(v.other_len == other_ref_len && memcmp(v.other, other_ref, other_ref_len) == 0,
+          "text and binlog bytes pass through unchanged");
+    check(text_wait <= 2, "telemetry does not hold up printf");
+    receive(wire, wire_len, 1, &rx, &v);
+    check(v.imu == SIM_MS / 5 && v.mismatch == 0 && v.other_len == other_ref_len, "byte-by-byte feed");
+    {
+        FILE *f = fopen("telem_capture.bin", "wb");     // 供 telem_recv 试用
+
+        check(f != NULL && fwrite(wire, 1, wire_len, f) == wire_len, "capture saved");
+        if (f != NULL) {
+            fclose(f);
+        }
+    }
+
+    // 4. printf 突发
+    burst.burst = 1;
+    run_sim(&burst);
+    receive(wire, wire_len, 4096, &rx, &v);
+    printf("\n8 KB printf burst at %u ms: text waited %u ms, %u telemetry frames dropped, receiver counted %u lost\n",
+           BURST_AT, (unsigned)max_wait, (unsigned)burst.dropped, (unsigned)rx.stats.lost);
+    check(burst.dropped > 0 && rx.stats.lost == burst.dropped && v.mismatch == 0, "dropped frames accounted");
+    check(v.other_len == other_ref_len && memcmp(v.other, other_ref, other_ref_len) == 0, "burst text intact");
+    check(max_wait <= BURST_BYTES / (UART_BPS / 10 / 1000) + 10, "printf burst bounded by the UART");
+
+    // 5. 字节预算
+    budget.budget = 2000;
+    run_sim(&budget);
+    receive(wire, wire_len, 4096, &rx, &v);
+    printf("\nbudget 2000 B/s: %u B/s sent, %u frames throttled, receiver counted %u lost\n",
+           (unsigned)(budget.telem_bytes / (SIM_MS / 1000)), (unsigned)budget.throttled, (unsigned)rx.stats.lost);
+    check(budget.throttled > 0 && rx.stats.lost == budget.throttled && v.mismatch == 0, "throttled frames accounted");
+    check(budget.telem_bytes <= 2000 * (SIM_MS / 1000) + TELEM_BURST + 2 * 100, "byte rate within budget");
+
+    // 6. 损坏
+    {
+        uint32_t seed = 11, flips = 0;
+
+        run_sim(&base);
+        memcpy(corrupt, wire, wire_len);
+        for (uint32_t off = rnd(&seed) % 3000; off < wire_len; off += 500 + rnd(&seed) % 3000) {
+            corrupt[off] ^= (uint8_t)(1 + rnd(&seed) % 255);
+            flips++;
+        }
+        receive(corrupt, wire_len, 4096, &rx, &v);
+        printf("\n%u corrupted bytes: %u imu samples received, %u lost frames, %u mismatches\n",
+               (unsigned)flips, (unsigned)v.imu, (unsigned)rx.stats.lost, (unsigned)v.mismatch);
+        check(v.mismatch == 0, "no corrupted sample accepted");
+        check(rx.stats.lost > 0 && v.imu > SIM_MS / 5 * 8 / 10, "stream recovers after corruption");
+    }
+
+    // 7. 与匿名协议逐帧上报对比
+    {
+        uint32_t niming_bps = NIMING_FRAME * RATE_HZ;
+        uint32_t telem_bps = base.telem_bytes / (SIM_MS / 1000);
+
+        printf("\n%-34s %10s %12s %10s %8s\n", "", "UART B/s", "writes/s", "UART %", "stamps");
+        printf("%-34s %10u %12u %9.1f%% %8s\n", "Niming 0xAF, byte by byte (old)", (unsigned)niming_bps,
+               (unsigned)niming_bps, 100.0 * niming_bps / (UART_BPS / 10), "no");
+        printf("%-34s %10u %12u %9.1f%% %8s\n", "Niming 0xAF, one write per frame", (unsigned)niming_bps,
+               (unsigned)RATE_HZ, 100.0 * niming_bps / (UART_BPS / 10), "no");
+        printf("%-34s %10u %12u %9.1f%% %8s\n", "telemetry imu + motion", (unsigned)telem_bps,
+               (unsigned)(base.frames / (SIM_MS / 1000)), 100.0 * telem_bps / (UART_BPS / 10), "yes");
+        printf("tx_write calls incl. text: %u/s; Telem_Push + motion on the host: %.0f ns per sample\n",
+               (unsigned)(base_calls / (SIM_MS / 1000)), base.push_ns);
+        check(telem_bps < niming_bps, "fewer UART bytes than the Niming frame while carrying more data");
+        check(base.frames / (SIM_MS / 1000) * 8 <= RATE_HZ, "at least 8x fewer writes than one per sample");
+    }
+
+    free(wire);
+    free(pending);
+    free(other_ref);
+    free(v.other);
+    free(corrupt);
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+// telem_recv.c - 遥测数据流接收工具
+//
+// 用法：
+//   telem_recv [--bin] [--log <table.txt|firmware.elf>] <prefix> [capture.bin|-]
+//
+// 从抓到的串口数据（默认标准输入，可以直接接串口设备）取出遥测帧，每个通道写一个文件：
+//   <prefix>_<通道名>.csv   第一列 t_ms，其余列按描述帧中的字段名
+//   <prefix>_<通道名>.bin   --bin：每个样本一条记录，4 字节 t_ms + 原始样本（小端，
+//                           imu 通道与 imu_capture 的 ImuRawRecord 格式相同）
+// 通道的文件在收到它的描述帧时创建。其余字节（printf 文本）原样写到标准输出；
+// 指定 --log 时先经二进制日志解码。结束时把统计打印到标准错误。
+#include <stdio.h>
+#include <string.h>
+#include "telem_decode.h"
+#include "binlog_decode.h"
+
+typedef struct {
+    const char    *prefix;
+    int            binary;
+    FILE          *out[256];
+    BinlogDecoder *log;         // NULL-文本直接输出
+} Recv;
+
+static void on_schema(void *ctx, const TelemRxChannel *ch)
+{
+    Recv *r = ctx;
+    char path[512];
+
+    if (r->out[ch->id] != NULL) {
+        return;                 // 描述帧定期重发，文件已经打开
+    }
+    snprintf(path, sizeof(path), "%s_%s.%s", r->prefix, ch->name, r->binary ? "bin" : "csv");
+    r->out[ch->id] = fopen(path, r->binary ? "wb" : "w");
+    if (r->out[ch->id] == NULL) {
+        fprintf(stderr, "telem_recv: cannot create %s\n", path);
+        return;
+    }
+    fprintf(stderr, "telem_recv: channel %u '%s' (%s, %u B, %u ms) -> %s\n",
+            ch->id, ch->name, ch->fmt, ch->size, ch->period_ms, path);
+    if (!r->binary) {
+        fprintf(r->out[ch->id], "t_ms");
+        for (uint32_t i = 0; i < ch->nfields; i++) {
+            fprintf(r->out[ch->id], ",%s", ch->field[i]);
+        }
+        fprintf(r->out[ch->id], "\n");
+    }
+}
+
+static void on_sample(void *ctx, const TelemRxChannel *ch, const TelemRxSample *s)
+{
+    Recv *r = ctx;
+    FILE *f = r->out[ch->id];
+
+    if (f == NULL) {
+        return;
+    }
+    if (r->binary) {
+        uint8_t t[4] = { (uint8_t)s->t_ms, (uint8_t)(s->t_ms >> 8), (uint8_t)(s->t_ms >> 16), (uint8_t)(s->t_ms >> 24) };
+
+        fwrite(t, 1, sizeof(t), f);
+        fwrite(s->raw, 1, ch->size, f);
+        return;
+    }
+    fprintf(f, "%u", (unsigned)s->t_ms);
+    for (uint32_t i = 0; i < ch->nfields; i++) {
+        fprintf(f, ",%.9g", s->value[i]);
+    }
+    fprintf(f, "\n");
+}
+
+static void on_other(void *ctx, const uint8_t *data, size_t len)
+{
+    Recv *r = ctx;
+
+    if (r->log != NULL) {
+        BinlogDecode_Feed(r->log, data, len);
+    } else {
+        fwrite(data, 1, len, stdout);
+    }
+}
+
+static void on_text(void *ctx, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    fwrite(data, 1, len, stdout);
+}
+
+static void on_record(void *ctx, const BinlogRecord *rec)
+{
+    (void)ctx;
+    BinlogRecord_Print(stdout, rec);
+}
+
+int main(int argc, char **argv)
+{
+    static TelemReceiver rx;
+    static Recv r;
+    TelemRxSink sink = { on_schema, on_sample, on_other, &r, NULL };
+    BinlogTable table;
+    BinlogDecoder dec;
+    BinlogSink log_sink = { on_text, on_record, NULL };
+    const char *table_path = NULL;
+    uint8_t buf[4096];
+    size_t n;
+    FILE *in = stdin;
+    int i = 1;
+
+    for (; i < argc && strncmp(argv[i], "--", 2) == 0; i++) {
+        if (strcmp(argv[i], "--bin") == 0) {
+            r.binary = 1;
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            table_path = argv[++i];
+        } else {
+            break;
+        }
+    }
+    if (argc - i < 1 || argc - i > 2) {
+        fprintf(stderr, "usage: %s [--bin] [--log <table.txt|firmware.elf>] <prefix> [capture.bin|-]\n", argv[0]);
+        return 2;
+    }
+    r.prefix = argv[i];
+    if (argc - i == 2 && strcmp(argv[i + 1], "-") != 0 && (in = fopen(argv[i + 1], "rb")) == NULL) {
+        fprintf(stderr, "telem_recv: cannot open %s\n", argv[i + 1]);
+        return 1;
+    }
+    if (table_path != NULL) {
+        int ret = BinlogTable_LoadElf(&table, table_path);
+
+        if (ret == -1) {
+            ret = BinlogTable_Load(&table, table_path);
+        }
+        if (ret != 0) {
+            fprintf(stderr, "telem_recv: no string table in %s\n", table_path);
+            return 1;
+        }
+        BinlogDecode_Init(&dec, &table, &log_sink);
+        r.log = &dec;
+    }
+
+    TelemRx_Init(&rx, &sink);
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        TelemRx_Feed(&rx, buf, n);
+        fflush(stdout);
+    }
+    TelemRx_Flush(&rx);
+    if (r.log != NULL) {
+        BinlogDecode_Flush(r.log);
+        BinlogTable_Free(&table);
+    }
+
+    fprintf(stderr, "telem_recv: %u frames, %u samples, %u lost frames, %u schema frames, "
+                    "%u frames before schema, %u bad frames, %u other bytes\n",
+            (unsigned)rx.stats.frames, (unsigned)rx.stats.samples, (unsigned)rx.stats.lost,
+            (unsigned)rx.stats.schemas, (unsigned)rx.stats.unknown, (unsigned)rx.stats.bad_frames,
+            (unsigned)rx.stats.other_bytes);
+    for (uint32_t c = 1; c < 256; c++) {
+        if (rx.ch[c].known) {
+            fprintf(stderr, "  %3u %-10s %8u frames %10u samples %6u lost\n", (unsigned)c, rx.ch[c].name,
+                    (unsigned)rx.ch[c].frames, (unsigned)rx.ch[c].samples, (unsigned)rx.ch[c].lost);
+        }
+        if (r.out[c] != NULL) {
+            fclose(r.out[c]);
+        }
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+    return 0;
+}
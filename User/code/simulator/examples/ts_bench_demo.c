@@ -0,0 +1,159 @@
+// ts_bench_demo.c - 时序存储基准：写入一年的分钟数据，再做典型范围查询
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "w25q128_sim.h"
+#include "spi.h"
+#include "ts_store.h"
+
+#define DAYS            365
+
+static TS_Summary q_a[400], q_b[400];
+
+// 可复现的伪随机数
+static uint32_t rng_state = 12345;
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 16;
+}
+
+// 合成一分钟的数据：白天走路、昼夜与季节温度变化、缓慢漂移的 ADC
+static void make_sample(uint32_t t, uint32_t start, TS_Sample *s)
+{
+    uint32_t minute_of_day = t % TS_MINUTES_PER_DAY;
+    double day = (t - start) / (double)TS_MINUTES_PER_DAY;
+    double daily = sin((minute_of_day / 1440.0 - 0.375) * 2 * M_PI);
+    double season = -cos(day / 365.0 * 2 * M_PI);
+
+    s->t = t;
+    s->steps = (minute_of_day >= 7 * 60 && minute_of_day < 22 * 60 && rng() % 4 == 0) ? 60 + rng() % 60 : 0;
+    s->temp = (int16_t)(200 + season * 80 + daily * 40 + (int)(rng() % 5) - 2);
+    s->humi = (uint8_t)(55 - daily * 15 + rng() % 5);
+    s->adc = (uint16_t)(2800 + season * 200 + rng() % 16);
+}
+
+// 执行一次查询并打印模拟耗时与索引使用情况
+static void run_query(const char *label, uint8_t level, uint32_t from, uint32_t span,
+                      TS_Summary *out, uint16_t n)
+{
+    TS_Stats st;
+    W25Q128_Sim_Stats fs;
+    uint64_t t0 = W25Q128_Sim_Time_us();
+
+    TS_ResetStats();
+    W25Q128_Sim_ResetStats();
+    TS_Query(level, from, span, out, n);
+    TS_GetStats(&st);
+    W25Q128_Sim_GetStats(&fs);
+    printf("%-34s %8.3f ms  read %6lu B  headers %4lu  index hits %4lu  scans %4lu  records %6lu\n",
+           label, (W25Q128_Sim_Time_us() - t0) / 1000.0, (unsigned long)fs.bytes_read,
+           (unsigned long)st.index_reads, (unsigned long)st.index_hits,
+           (unsigned long)st.seg_scans, (unsigned long)st.records_read);
+}
+
+// 比较两次查询的步数、样本数和温度极值
+static int compare(const TS_Summary *a, const TS_Summary *b, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        if (a[i].samples != b[i].samples || a[i].steps != b[i].steps ||
+            (a[i].samples && (a[i].temp_min != b[i].temp_min || a[i].temp_max != b[i].temp_max))) {
+            printf("  mismatch at bucket %u: samples %lu/%lu steps %lu/%lu\n", i,
+                   (unsigned long)a[i].samples, (unsigned long)b[i].samples,
+                   (unsigned long)a[i].steps, (unsigned long)b[i].steps);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *image = argc > 1 ? argv[1] : NULL;
+    uint32_t start = TS_MakeTime(25, 1, 1, 0, 0);
+    uint32_t end = start + DAYS * TS_MINUTES_PER_DAY;
+    uint32_t today, first, last, appends = 0, slow = 0, max_us = 0;
+    uint64_t t0, total_us = 0, steps_total = 0;
+    W25Q128_Sim_Stats fs;
+    TS_Stats st;
+    TS_Sample s;
+
+    printf("time-series store benchmark, image: %s\n", image ? image : "(blank, in memory)");
+    W25Q128_Sim_Open(image);
+    TS_Init();
+    TS_ResetStats();
+    W25Q128_Sim_ResetStats();
+
+    // 写入一年：每分钟一条，每周日夜里关机 3 小时
+    for (uint32_t t = start; t < end; t++) {
+        uint32_t lat;
+        if ((t - start) / TS_MINUTES_PER_DAY % 7 == 6 && t % TS_MINUTES_PER_DAY < 180) {
+            continue;
+        }
+        make_sample(t, start, &s);
+        t0 = W25Q128_Sim_Time_us();
+        if (TS_Append(&s) != TS_OK) {
+            printf("append failed at %lu\n", (unsigned long)t);
+            return 1;
+        }
+        lat = (uint32_t)(W25Q128_Sim_Time_us() - t0);
+        total_us += lat;
+        if (lat > max_us) max_us = lat;
+        if (lat > 1000) slow++;
+        steps_total += s.steps;
+        appends++;
+    }
+    TS_GetStats(&st);
+    W25Q128_Sim_GetStats(&fs);
+    printf("\ninsert: %lu samples, avg %.3f ms, max %.3f ms, %lu appends > 1ms (erase or rollup)\n",
+           (unsigned long)appends, total_us / 1000.0 / appends, max_us / 1000.0, (unsigned long)slow);
+    printf("        %lu page programs, %lu sector erases, %lu rollups, %lu segments dropped by retention\n",
+           (unsigned long)fs.page_programs, (unsigned long)fs.sector_erases,
+           (unsigned long)st.rollups, (unsigned long)st.dropped);
+    TS_PrintStats();
+    for (uint8_t level = TS_LEVEL_RAW; level <= TS_LEVEL_DAY; level++) {
+        TS_Range(level, &first, &last);
+        printf("  level %u keeps %.1f days\n", level, (last - first) / (double)TS_MINUTES_PER_DAY);
+    }
+
+    today = (end - 1) - (end - 1) % TS_MINUTES_PER_DAY;
+    printf("\nqueries (simulated time):\n");
+
+    run_query("steps per hour today (hour)", TS_LEVEL_AUTO, today, 60, q_a, 24);
+    run_query("steps per hour today (raw)", TS_LEVEL_RAW, today, 60, q_b, 24);
+    printf("  hour vs raw: %s\n", compare(q_a, q_b, 24) ? "match" : "MISMATCH");
+
+    run_query("temp min/max per day, 30d (day)", TS_LEVEL_AUTO, today - 29 * 1440, 1440, q_a, 30);
+    run_query("temp min/max per day, 30d (hour)", TS_LEVEL_HOUR, today - 29 * 1440, 1440, q_b, 30);
+    printf("  day vs hour: %s\n", compare(q_a, q_b, 30) ? "match" : "MISMATCH");
+    run_query("temp min/max per day, 30d (raw)", TS_LEVEL_RAW, today - 29 * 1440, 1440, q_b, 30);
+    printf("  day vs raw: %s\n", compare(q_a, q_b, 30) ? "match" : "MISMATCH");
+
+    run_query("steps per week, 52w (hour)", TS_LEVEL_HOUR, today - 51 * 7 * 1440, 7 * 1440, q_a, 52);
+    run_query("steps per week, 52w (day)", TS_LEVEL_DAY, today - 51 * 7 * 1440, 7 * 1440, q_b, 52);
+    printf("  hour vs day: %s\n", compare(q_a, q_b, 52) ? "match" : "MISMATCH");
+
+    run_query("steps per day, whole year (day)", TS_LEVEL_AUTO, start, 1440, q_a, DAYS);
+    {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < DAYS; i++) {
+            sum += q_a[i].steps;
+        }
+        printf("  year total %llu steps (inserted %llu): %s\n", (unsigned long long)sum,
+               (unsigned long long)steps_total, sum == steps_total ? "match" : "MISMATCH");
+    }
+
+    // 模拟重启：重新扫描，当前小时/当天的累加器从 Flash 恢复
+    printf("\nreboot:\n");
+    run_query("steps per hour today (before)", TS_LEVEL_AUTO, today, 60, q_b, 24);
+    t0 = W25Q128_Sim_Time_us();
+    TS_Init();
+    printf("%-34s %8.3f ms\n", "TS_Init", (W25Q128_Sim_Time_us() - t0) / 1000.0);
+    run_query("steps per hour today (after)", TS_LEVEL_AUTO, today, 60, q_a, 24);
+    printf("  before vs after: %s\n", compare(q_a, q_b, 24) ? "match" : "MISMATCH");
+
+    W25Q128_Sim_Close();
+    return 0;
+}
@@ -0,0 +1,345 @@
+// uart_rx_bench.c - USART1 接收路径对比：逐字节中断 + 队列（原 debug.c）与 DMA 循环接收 + 流缓冲区
+//
+// 按 921600bps（每字节 10.85us）逐微秒模拟：主机连续发送长短不一的命令行，行间偶尔有空闲，
+// 接收任务（data_task）每 20ms 被更高优先级的任务占用 3ms（OLED 整屏刷新、挂载文件系统等）。
+// - 原路径：每个字节进一次中断，xQueueSendFromISR 放入深度 10 的队列，队列满即丢
+// - 新路径：uart_rx_ring.c（与固件相同的代码）在 IDLE/HT/TC 时把整块写入 1024 字节的流缓冲区
+// 接收任务按字节序号检查数据，统计丢失、中断次数、任务唤醒次数和 CPU 时间。
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "uart_rx_ring.h"
+
+#define BAUD            921600
+#define TOTAL_BYTES     (256 * 1024)
+#define DMA_SIZE        256             // 与 debug.h 的 DEBUG_RX_DMA_SIZE 相同
+#define STREAM_SIZE     1024            // DEBUG_RX_STREAM_SIZE
+#define QUEUE_DEPTH     10              // 原 xDataQueue
+#define CHUNK           64              // data_task 一次取的字节数
+
+// 模拟的 CPU 开销（168MHz，微秒）
+#define COST_ISR_BYTE   1.5             // 进出中断 + xQueueSendFromISR
+#define COST_ISR_CHUNK  2.0             // 进出中断 + xStreamBufferSendFromISR 的固定部分
+#define COST_COPY_BYTE  0.02            // 流缓冲区拷贝，每字节
+#define COST_WAKE       6.0             // 阻塞的任务被唤醒（上下文切换）
+#define COST_RECV       2.0             // xQueueReceive / xStreamBufferReceive 一次调用
+#define COST_PARSE_BYTE 0.3             // data_task 处理每个字节
+#define STALL_PERIOD    20000           // 每 20ms
+#define STALL_LEN       3000            // 被高优先级任务占用 3ms
+
+typedef struct {
+    uint32_t sent;
+    uint32_t received;
+    uint32_t lost;          // 接收任务发现的序号缺口
+    uint32_t dropped;       // 接收路径上报的丢弃（队列满 / 流缓冲区满）
+    uint32_t ring_overrun;  // DMA 追上读位置（新路径）
+    uint32_t interrupts;
+    uint32_t wakeups;
+    double   cpu_us;
+    uint32_t max_fill;
+} Result;
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// 发送的数据：字节序号的低 8 位，每行结尾换行；接收方据此检查丢失
+static uint8_t tx_byte(uint32_t i)
+{
+    return (uint8_t)(i * 7 + 3);
+}
+
+// 行长 16~143 字节，每 8 行后空闲 0.5ms
+static uint32_t line_len(uint32_t line)
+{
+    return 16 + (line * 37) % 128;
+}
+
+// 字节到达时刻（微秒），模拟发送端
+typedef struct {
+    uint32_t next;          // 下一个字节序号
+    double   t_next;        // 下一个字节到达时刻
+    uint32_t line;
+    uint32_t left;          // 当前行剩余字节
+    double   idle_at;       // 最后一个字节后一个字节时间无数据：IDLE
+} Sender;
+
+static const double BYTE_US = 10.0 * 1e6 / BAUD;
+
+static void sender_init(Sender *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->left = line_len(0);
+    s->t_next = 0;
+    s->idle_at = -1;
+}
+
+static void sender_advance(Sender *s)
+{
+    s->next++;
+    s->t_next += BYTE_US;
+    if (--s->left == 0) {
+        s->line++;
+        s->left = line_len(s->line);
+        if (s->line % 8 == 0) {
+            s->idle_at = s->t_next + BYTE_US;
+            s->t_next += 500;
+        }
+    }
+}
+
+static int stalled(double t)
+{
+    return (uint32_t)t % STALL_PERIOD < STALL_LEN;
+}
+
+// 接收任务检查序号：期望收到的字节与实际不同时认为中间丢了，向后找到对得上的位置
+static void consume(Result *r, uint32_t *expect, uint8_t b)
+{
+    uint32_t k = 0;
+
+    while (tx_byte(*expect + k) != b && k < 256) {
+        k++;
+    }
+    r->lost += k;
+    *expect += k + 1;
+    r->received++;
+}
+
+// =============================================================================
+// 原路径：逐字节中断 + 队列
+// =============================================================================
+
+static void run_queue(Result *r)
+{
+    Sender s;
+    uint8_t q[QUEUE_DEPTH];
+    uint32_t head = 0, count = 0, expect = 0;
+    double busy_until = 0;
+    int waiting = 1;
+
+    memset(r, 0, sizeof(*r));
+    sender_init(&s);
+    for (double t = 0; s.next < TOTAL_BYTES || count > 0; t += 1.0) {
+        while (s.next < TOTAL_BYTES && s.t_next <= t) {
+            r->sent++;
+            r->interrupts++;
+            r->cpu_us += COST_ISR_BYTE;
+            busy_until += COST_ISR_BYTE;            // 中断占用的时间推迟接收任务
+            if (count < QUEUE_DEPTH) {
+                q[(head + count++) % QUEUE_DEPTH] = tx_byte(s.next);
+            } else {
+                r->dropped++;
+            }
+            sender_advance(&s);
+        }
+        if (count > r->max_fill) {
+            r->max_fill = count;
+        }
+        if (stalled(t) || t < busy_until || count == 0) {
+            if (count == 0) {
+                waiting = 1;
+            }
+            continue;
+        }
+        // xQueueReceive 一次取一个字节
+        double cost = COST_RECV + COST_PARSE_BYTE;
+        if (waiting) {
+            cost += COST_WAKE;
+            r->wakeups++;
+            waiting = 0;
+        }
+        consume(r, &expect, q[head]);
+        head = (head + 1) % QUEUE_DEPTH;
+        count--;
+        r->cpu_us += cost;
+        busy_until = t + cost;
+    }
+    r->lost += TOTAL_BYTES - expect;
+}
+
+// =============================================================================
+// 新路径：DMA 循环接收 + 流缓冲区
+// =============================================================================
+
+typedef struct {
+    uint8_t  buf[STREAM_SIZE];
+    uint32_t head, count;
+    Result  *r;
+} Stream;
+
+static uint32_t stream_sink(const uint8_t *data, uint32_t len, void *ctx)
+{
+    Stream *sb = (Stream *)ctx;
+    uint32_t n = 0;
+
+    while (n < len && sb->count < STREAM_SIZE) {
+        sb->buf[(sb->head + sb->count++) % STREAM_SIZE] = data[n++];
+    }
+    sb->r->cpu_us += COST_COPY_BYTE * n;
+    return n;
+}
+
+static void run_dma(Result *r)
+{
+    static uint8_t dma_buf[DMA_SIZE];
+    static Stream sb;
+    UartRxRing ring;
+    Sender s;
+    uint32_t pos = 0, unread = 0, expect = 0;
+    double busy_until = 0;
+    int waiting = 1;
+
+    memset(r, 0, sizeof(*r));
+    memset(&sb, 0, sizeof(sb));
+    sb.r = r;
+    sender_init(&s);
+    UartRxRing_Init(&ring, dma_buf, DMA_SIZE, stream_sink, &sb);
+
+    for (double t = 0; s.next < TOTAL_BYTES || sb.count > 0 || unread > 0; t += 1.0) {
+        while (s.next < TOTAL_BYTES && s.t_next <= t) {
+            int event = 0;
+
+            r->sent++;
+            dma_buf[pos++] = tx_byte(s.next);
+            if (++unread > DMA_SIZE) {
+                r->ring_overrun++;
+            }
+            if (pos == DMA_SIZE / 2) {
+                ring.stats.half++;
+                event = 1;
+            } else if (pos == DMA_SIZE) {
+                pos = 0;
+                ring.stats.full++;
+                event = 1;
+            }
+            sender_advance(&s);
+            if (event) {
+                // NDTR = size - pos，循环模式到 0 后重装为 size
+                unread -= UartRxRing_Poll(&ring, (uint16_t)(DMA_SIZE - pos));
+                r->interrupts++;
+                r->cpu_us += COST_ISR_CHUNK;
+                busy_until += COST_ISR_CHUNK;
+            }
+        }
+        if (s.idle_at >= 0 && s.idle_at <= t) {
+            s.idle_at = -1;
+            ring.stats.idle++;
+            unread -= UartRxRing_Poll(&ring, (uint16_t)(DMA_SIZE - pos));
+            r->interrupts++;
+            r->cpu_us += COST_ISR_CHUNK;
+            busy_until += COST_ISR_CHUNK;
+        }
+        if (s.next >= TOTAL_BYTES && unread > 0) {
+            // 发送结束后的空闲中断
+            ring.stats.idle++;
+            unread -= UartRxRing_Poll(&ring, (uint16_t)(DMA_SIZE - pos));
+            r->interrupts++;
+        }
+        if (sb.count > r->max_fill) {
+            r->max_fill = sb.count;
+        }
+        if (stalled(t) || t < busy_until || sb.count == 0) {
+            if (sb.count == 0) {
+                waiting = 1;
+            }
+            continue;
+        }
+        // xStreamBufferReceive 一次最多取 CHUNK 字节
+        uint32_t n = sb.count < CHUNK ? sb.count : CHUNK;
+        double cost = COST_RECV + COST_PARSE_BYTE * n;
+        if (waiting) {
+            cost += COST_WAKE;
+            r->wakeups++;
+            waiting = 0;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            consume(r, &expect, sb.buf[sb.head]);
+            sb.head = (sb.head + 1) % STREAM_SIZE;
+        }
+        sb.count -= n;
+        r->cpu_us += cost;
+        busy_until = t + cost;
+    }
+    r->lost += TOTAL_BYTES - expect;
+    r->dropped = ring.stats.dropped;
+
+    check(ring.stats.bytes == TOTAL_BYTES, "ring delivered every byte");
+    check(ring.stats.half + ring.stats.full + ring.stats.idle == r->interrupts, "event count");
+}
+
+// =============================================================================
+// UartRxRing_Poll 回绕与重复调用
+// =============================================================================
+
+static uint8_t unit_out[64];
+static uint32_t unit_len;
+
+static uint32_t unit_sink(const uint8_t *data, uint32_t len, void *ctx)
+{
+    uint32_t limit = *(uint32_t *)ctx;
+    uint32_t n = len < limit ? len : limit;
+
+    memcpy(&unit_out[unit_len], data, n);
+    unit_len += n;
+    return n;
+}
+
+static void unit_checks(void)
+{
+    uint8_t buf[16];
+    uint32_t limit = 64;
+    UartRxRing ring;
+
+    for (int i = 0; i < 16; i++) {
+        buf[i] = (uint8_t)i;
+    }
+    UartRxRing_Init(&ring, buf, 16, unit_sink, &limit);
+    unit_len = 0;
+    check(UartRxRing_Poll(&ring, 16) == 0, "nothing received");
+    check(UartRxRing_Poll(&ring, 11) == 5 && unit_len == 5 && unit_out[4] == 4, "first 5 bytes");
+    check(UartRxRing_Poll(&ring, 11) == 0, "repeat poll is empty");
+    check(UartRxRing_Poll(&ring, 16) == 11 && unit_len == 16 && unit_out[15] == 15, "up to wrap (TC)");
+    check(UartRxRing_Poll(&ring, 6) == 10, "10 more bytes");
+    unit_len = 0;
+    check(UartRxRing_Poll(&ring, 13) == 9 && ring.stats.chunks == 5, "wrapped read in two chunks");
+    check(unit_len == 9 && unit_out[0] == 10 && unit_out[5] == 15 && unit_out[6] == 0 && unit_out[8] == 2,
+          "wrapped data in order");
+    limit = 2;
+    check(UartRxRing_Poll(&ring, 8) == 5 && ring.stats.dropped == 3, "sink full counts dropped bytes");
+    check(ring.stats.bytes == 40, "byte count");
+}
+
+int main(void)
+{
+    Result q, d;
+
+    unit_checks();
+
+    printf("USART1 RX at %d bps, %d KB in lines of 16..143 bytes, data_task stalled %d ms every %d ms\n\n",
+           BAUD, TOTAL_BYTES / 1024, STALL_LEN / 1000, STALL_PERIOD / 1000);
+    run_queue(&q);
+    run_dma(&d);
+
+    printf("  %-30s %8s %8s %10s %8s %10s %8s\n", "", "lost", "dropped", "interrupts", "wakeups", "CPU ms", "max fill");
+    printf("  %-30s %8lu %8lu %10lu %8lu %10.1f %5lu/%-4d\n", "RXNE per byte + queue(10)",
+           (unsigned long)q.lost, (unsigned long)q.dropped, (unsigned long)q.interrupts,
+           (unsigned long)q.wakeups, q.cpu_us / 1000.0, (unsigned long)q.max_fill, QUEUE_DEPTH);
+    printf("  %-30s %8lu %8lu %10lu %8lu %10.1f %5lu/%-4d\n", "DMA ring + stream buffer",
+           (unsigned long)d.lost, (unsigned long)d.dropped, (unsigned long)d.interrupts,
+           (unsigned long)d.wakeups, d.cpu_us / 1000.0, (unsigned long)d.max_fill, STREAM_SIZE);
+
+    check(q.lost > 0 && q.lost == q.dropped, "queue path loses bytes during stalls");
+    check(d.lost == 0 && d.dropped == 0 && d.ring_overrun == 0, "DMA path loses nothing");
+    check(d.received == TOTAL_BYTES, "DMA path received everything");
+    check(d.interrupts * 50 < q.interrupts, "DMA path takes far fewer interrupts");
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
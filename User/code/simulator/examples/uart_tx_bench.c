@@ -0,0 +1,506 @@
+// uart_tx_bench.c - printf 发送路径：无锁环形缓冲区检查与开销对比
+//
+// 1. 两个线程分别作为生产者（printf）和消费者（DMA 发送完成中断）操作同一个 UartTxRing，
+//    生产者写入随机长度的递增序列，消费者按 UartTxRing_Span 取连续段、随机只发送一部分，
+//    检查顺序、不丢不重、Span 不跨越缓冲区末尾。与固件使用同一份 uart_tx_ring.c。
+// 2. 按 debug.c 的两种实现估算 printf 的调用方耗时和 CPU 占用：
+//    - 原路径：fputc 每字节 xQueueSend 到深度 20 的队列，send_task 逐字节写 DR 并忙等 TXE
+//    - 新路径：fputc 在短临界区内写环形缓冲区，DMA2 Stream7 按段发送，TC 中断续发下一段
+//    负载为 60 秒的计步输出（simple_pedometer_update，每 0.5s）、闹钟（Alarm_Check）、
+//    定时器回调和开机时的一串统计输出。
+// 3. 控制台通道（console_chan.c）：4 个线程同时 printf，每行带线程号、序号和可校验的内容，
+//    原来逐字节写入（每字节一次临界区）与每个任务一个通道、整行提交对比，检查收到的每一行是否完整、
+//    各线程的行是否按顺序；再检查长行分段、没有换行的尾部由别的上下文提交。
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "uart_tx_ring.h"
+#include "console_chan.h"
+
+#define RING_SIZE       1024            // 与 debug.h 的 DEBUG_TX_RING_SIZE 相同
+#define STRESS_BYTES    (32u * 1024 * 1024)
+#define QUEUE_DEPTH     20              // 原 xSendQueue
+
+// 模拟的 CPU 开销（168MHz，微秒）
+#define COST_QUEUE_BYTE 2.5             // xQueueSend + send_task 的 xQueueReceive，每字节
+#define COST_RING_BYTE  0.25            // 临界区 + 写一个字节 + 检查 DMA 是否空闲
+#define COST_TC_ISR     2.0             // TC 中断：释放一段、启动下一段
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// =============================================================================
+// 1. 双线程检查
+// =============================================================================
+
+static UartTxRing stress_ring;
+static uint8_t stress_buf[RING_SIZE];
+static volatile int stress_bad = 0;
+
+static uint32_t rnd(uint32_t *s)
+{
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 8;
+}
+
+static void *producer(void *arg)
+{
+    uint8_t chunk[200];
+    uint32_t seq = 0, seed = 1;
+
+    (void)arg;
+    while (seq < STRESS_BYTES) {
+        uint32_t len = 1 + rnd(&seed) % sizeof(chunk);
+        uint32_t done = 0;
+
+        if (len > STRESS_BYTES - seq) {
+            len = STRESS_BYTES - seq;
+        }
+        for (uint32_t i = 0; i < len; i++) {
+            chunk[i] = (uint8_t)((seq + i) * 13 + 7);
+        }
+        while (done < len) {
+            uint32_t n = UartTxRing_Write(&stress_ring, chunk + done, len - done);
+
+            if (n == 0) {
+                sched_yield();      // 满：让消费者运行（单核主机上不让出会一直空转）
+            }
+            done += n;
+        }
+        seq += len;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    uint32_t seq = 0, seed = 2;
+    uint32_t *spans = (uint32_t *)arg;
+
+    while (seq < STRESS_BYTES) {
+        const uint8_t *p;
+        uint32_t n = UartTxRing_Span(&stress_ring, &p);
+
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        if (p + n > stress_buf + RING_SIZE) {
+            stress_bad = 1;
+            break;
+        }
+        // DMA 每次发送整段；这里偶尔只发一部分，覆盖 tail 在段中间的情况
+        if (rnd(&seed) % 4 == 0) {
+            n = 1 + rnd(&seed) % n;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (p[i] != (uint8_t)((seq + i) * 13 + 7)) {
+                stress_bad = 1;
+            }
+        }
+        UartTxRing_Consume(&stress_ring, n);
+        seq += n;
+        (*spans)++;
+    }
+    return NULL;
+}
+
+static void stress(void)
+{
+    pthread_t a, b;
+    uint32_t spans = 0;
+
+    check(UartTxRing_Init(&stress_ring, stress_buf, 1000) != 0, "size must be a power of two");
+    check(UartTxRing_Init(&stress_ring, stress_buf, RING_SIZE) == 0, "init");
+    pthread_create(&a, NULL, producer, NULL);
+    pthread_create(&b, NULL, consumer, &spans);
+    pthread_join(a, NULL);
+    pthread_join(b, NULL);
+    printf("two-thread check: %u MB through a %d B ring in %lu spans, %s\n\n",
+           STRESS_BYTES >> 20, RING_SIZE, (unsigned long)spans, stress_bad ? "MISMATCH" : "in order");
+    check(!stress_bad, "consumer saw bytes in order, spans never cross the end");
+    check(UartTxRing_Used(&stress_ring) == 0 && UartTxRing_Free(&stress_ring) == RING_SIZE, "ring empty");
+}
+
+// =============================================================================
+// 2. 开销模型
+// =============================================================================
+
+typedef struct {
+    double   t;             // 调用时刻（微秒）
+    uint32_t len;
+    uint8_t  kind;          // 0-计步，1-其它
+} Call;
+
+typedef struct {
+    const char *name;
+    uint32_t    baud;
+    uint32_t    capacity;   // 队列深度或环形缓冲区大小
+    double      cost_byte;  // 调用方每字节开销
+    uint8_t     busy_wait;  // 发送期间 CPU 忙等（send_task 轮询 TXE）
+    uint8_t     block;      // 满时阻塞，否则丢弃
+} Path;
+
+typedef struct {
+    double   step_avg, step_max;    // 计步一行 printf 的调用方耗时
+    double   other_max;
+    double   cpu_ms;                // printf + 发送占用的 CPU
+    uint32_t dropped;
+} Cost;
+
+#define MAX_CALLS 512
+static Call calls[MAX_CALLS];
+static uint32_t n_calls;
+
+static void add_call(double t, const char *line, uint8_t kind)
+{
+    if (n_calls < MAX_CALLS) {
+        calls[n_calls].t = t;
+        calls[n_calls].len = (uint32_t)strlen(line);
+        calls[n_calls].kind = kind;
+        n_calls++;
+    }
+}
+
+static void build_workload(void)
+{
+    char line[96];
+
+    // 开机：存储服务 RAM 预算、挂载信息等一串输出
+    for (int i = 0; i < 14; i++) {
+        snprintf(line, sizeof(line), "storage: FATFS x2 %d B, FIL %d B, cache 8 x 512 B, task stack 3072 B\r\n", 1128, 560);
+        add_call(i * 10.0, line, 1);
+    }
+    for (uint32_t s = 0; s < 60; s++) {
+        add_call(s * 1e6 + 1000, "xTimers2 callback\r\n", 1);
+        for (uint32_t k = 0; k < 2; k++) {
+            snprintf(line, sizeof(line), "Step detected! Total steps: %lu\r\n", (unsigned long)(1000 + s * 2 + k));
+            add_call(s * 1e6 + k * 5e5 + 20000, line, 0);
+        }
+    }
+    add_call(30e6 + 40000, "Alarm triggered! Time: 07:30:00, Index: 0\n", 1);
+}
+
+// 按字节时间模拟串口：backlog_end 是已接受的数据全部发完的时刻
+static Cost run_path(const Path *p)
+{
+    const double bt = 10.0 * 1e6 / p->baud;
+    double backlog_end = 0, step_sum = 0;
+    uint32_t steps = 0, spans = 0;
+    Cost c;
+
+    memset(&c, 0, sizeof(c));
+    for (uint32_t i = 0; i < n_calls; i++) {
+        const Call *k = &calls[i];
+        double start = k->t > backlog_end ? k->t : backlog_end;
+        double occupied = backlog_end > k->t ? (backlog_end - k->t) / bt : 0;
+        uint32_t used = occupied >= p->capacity ? p->capacity : (uint32_t)(occupied + 0.999);
+        uint32_t room = p->capacity - used;
+        uint32_t accepted = k->len;
+        double latency = k->len * p->cost_byte;
+
+        if (k->len > room) {
+            if (p->block) {
+                latency += (k->len - room) * bt;    // 每发出一个字节才能再放一个
+            } else {
+                accepted = room;
+                c.dropped += k->len - room;
+            }
+        }
+        if (k->t >= backlog_end) {
+            spans++;                                // DMA 空闲，新启动一段
+        }
+        backlog_end = start + accepted * bt;
+        c.cpu_ms += k->len * p->cost_byte;
+        if (p->busy_wait) {
+            c.cpu_ms += accepted * bt;
+        }
+        if (k->kind == 0) {
+            step_sum += latency;
+            steps++;
+            if (latency > c.step_max) {
+                c.step_max = latency;
+            }
+        } else if (latency > c.other_max) {
+            c.other_max = latency;
+        }
+    }
+    if (!p->busy_wait) {
+        c.cpu_ms += spans * 2 * COST_TC_ISR;        // 回绕等情况每段按两次中断估计
+    }
+    c.step_avg = steps ? step_sum / steps : 0;
+    c.cpu_ms /= 1000.0;
+    return c;
+}
+
+static void model(void)
+{
+    static const Path paths[] = {
+        { "queue(20) + TXE busy-wait",  115200, QUEUE_DEPTH, COST_QUEUE_BYTE, 1, 1 },
+        { "queue(20) + TXE busy-wait",  921600, QUEUE_DEPTH, COST_QUEUE_BYTE, 1, 1 },
+        { "SPSC ring(1024) + DMA",      921600, RING_SIZE,   COST_RING_BYTE,  0, 1 },
+    };
+    Cost c[3];
+
+    build_workload();
+    printf("printf cost over 60 s (%lu calls: pedometer every 0.5 s, alarm, timer, startup burst)\n\n",
+           (unsigned long)n_calls);
+    printf("  %-28s %7s %12s %12s %14s %10s\n", "", "baud", "step avg us", "step max us", "burst max us", "CPU ms");
+    for (int i = 0; i < 3; i++) {
+        c[i] = run_path(&paths[i]);
+        printf("  %-28s %7lu %12.1f %12.1f %14.1f %10.1f\n", paths[i].name, (unsigned long)paths[i].baud,
+               c[i].step_avg, c[i].step_max, c[i].other_max, c[i].cpu_ms);
+    }
+    check(c[0].step_avg > 1000, "original path costs milliseconds per step line");
+    check(c[2].step_avg < 50 && c[2].step_max < 50, "ring path costs microseconds per step line");
+    check(c[2].dropped == 0, "no drops under normal load");
+
+    // 缓冲区满：一次写 3000 字节，两种策略
+    {
+        Path drop = paths[2], block = paths[2];
+        Cost d, b;
+
+        drop.block = 0;
+        n_calls = 0;
+        add_call(0, "", 1);
+        calls[0].len = 3000;
+        d = run_path(&drop);
+        b = run_path(&block);
+        printf("\n  3000 B at once into the %d B ring: DEBUG_TX_DROP drops %lu B (returns in %.0f us), "
+               "DEBUG_TX_BLOCK waits %.1f ms\n", RING_SIZE, (unsigned long)d.dropped, d.other_max, b.other_max / 1000.0);
+        check(d.dropped == 3000 - RING_SIZE && b.dropped == 0, "full-ring policies");
+    }
+}
+
+// =============================================================================
+// 3. 控制台通道
+// =============================================================================
+
+#define CON_THREADS     4
+#define CON_LINES       5000
+#define CON_LINE        128             // 与 debug.h 的 DEBUG_CONSOLE_LINE 相同
+#define CON_OUT_SIZE    (8u * 1024 * 1024)
+
+static UartTxRing con_ring;
+static uint8_t con_ring_buf[RING_SIZE];
+static pthread_mutex_t con_lock = PTHREAD_MUTEX_INITIALIZER;   // 代替 taskENTER_CRITICAL
+static uint8_t *con_out;
+static volatile uint32_t con_out_len;
+static volatile int con_done;
+static uint32_t con_locks;
+
+// debug.c 的 tx_write：临界区内写环形缓冲区，TX_WHOLE 时放不下整段就等待（DEBUG_TX_BLOCK）
+static uint32_t con_write(const uint8_t *data, uint32_t len, int whole)
+{
+    uint32_t done = 0;
+
+    while (done < len) {
+        uint32_t n = 0;
+
+        pthread_mutex_lock(&con_lock);
+        con_locks++;
+        if (!whole || UartTxRing_Free(&con_ring) >= len - done) {
+            n = UartTxRing_Write(&con_ring, data + done, len - done);
+        }
+        pthread_mutex_unlock(&con_lock);
+        if (n == 0) {
+            sched_yield();
+        }
+        done += n;
+    }
+    return len;
+}
+
+static uint32_t con_commit(const uint8_t *data, uint32_t len)
+{
+    return con_write(data, len, 1);
+}
+
+static void *con_consumer(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        const uint8_t *p;
+        uint32_t n = UartTxRing_Span(&con_ring, &p);
+
+        if (n == 0) {
+            if (con_done) {
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        if (con_out_len + n <= CON_OUT_SIZE) {
+            memcpy(con_out + con_out_len, p, n);
+        }
+        con_out_len += n;
+        UartTxRing_Consume(&con_ring, n);
+    }
+    return NULL;
+}
+
+static uint32_t con_format(char *line, uint32_t id, uint32_t seq)
+{
+    uint32_t seed = id * 100003u + seq, len = 10 + rnd(&seed) % 90;
+    uint32_t n = (uint32_t)snprintf(line, CON_LINE, "T%u %06u ", (unsigned)id, (unsigned)seq);
+
+    for (uint32_t i = 0; i < len; i++) {
+        line[n++] = (char)('a' + (id * 7 + seq + i) % 26);
+    }
+    line[n++] = '\r';
+    line[n++] = '\n';
+    return n;
+}
+
+typedef struct {
+    uint32_t id;
+    int      channel;       // 0-逐字节写入，1-控制台通道
+} ConTask;
+
+static void *con_task(void *arg)
+{
+    const ConTask *t = (const ConTask *)arg;
+    uint8_t buf[CON_LINE];
+    ConsoleChan ch;
+    char line[CON_LINE];
+
+    ConsoleChan_Init(&ch, buf, sizeof(buf), con_commit);
+    for (uint32_t seq = 0; seq < CON_LINES; seq++) {
+        uint32_t n = con_format(line, t->id, seq);
+
+        // printf 逐字节调用 fputc
+        for (uint32_t i = 0; i < n; i++) {
+            if (t->channel) {
+                ConsoleChan_Putc(&ch, (uint8_t)line[i], 0);
+            } else {
+                con_write((const uint8_t *)&line[i], 1, 0);
+            }
+        }
+        if (seq % 64 == 0) {
+            sched_yield();  // 单核主机上也让几个线程轮流运行
+        }
+    }
+    return NULL;
+}
+
+// 逐行检查：线程号、序号、内容都对，且每个线程的序号连续
+static uint32_t con_verify(uint32_t *whole)
+{
+    uint32_t next[CON_THREADS] = { 0 }, start = 0, lines = 0;
+    char expect[CON_LINE];
+
+    *whole = 0;
+    for (uint32_t i = 0; i < con_out_len && i < CON_OUT_SIZE; i++) {
+        unsigned id, seq;
+
+        if (con_out[i] != '\n') {
+            continue;
+        }
+        lines++;
+        if (sscanf((const char *)con_out + start, "T%u %u ", &id, &seq) == 2 && id < CON_THREADS &&
+            seq == next[id] && con_format(expect, id, seq) == i + 1 - start &&
+            memcmp(expect, con_out + start, i + 1 - start) == 0) {
+            next[id]++;
+            (*whole)++;
+        }
+        start = i + 1;
+    }
+    return lines;
+}
+
+static void con_run(int channel, uint32_t *lines, uint32_t *whole, uint32_t *locks)
+{
+    pthread_t th[CON_THREADS], cons;
+    ConTask tasks[CON_THREADS];
+
+    UartTxRing_Init(&con_ring, con_ring_buf, RING_SIZE);
+    con_out_len = 0;
+    con_done = 0;
+    con_locks = 0;
+    pthread_create(&cons, NULL, con_consumer, NULL);
+    for (uint32_t i = 0; i < CON_THREADS; i++) {
+        tasks[i].id = i;
+        tasks[i].channel = channel;
+        pthread_create(&th[i], NULL, con_task, &tasks[i]);
+    }
+    for (uint32_t i = 0; i < CON_THREADS; i++) {
+        pthread_join(th[i], NULL);
+    }
+    con_done = 1;
+    pthread_join(cons, NULL);
+    *lines = con_verify(whole);
+    *locks = con_locks;
+}
+
+static uint32_t rec_count;
+
+static uint32_t rec_commit(const uint8_t *data, uint32_t len)
+{
+    (void)data;
+    rec_count++;
+    return len;
+}
+
+static void console(void)
+{
+    uint32_t lines[2], whole[2], locks[2];
+    uint8_t buf[CON_LINE];
+    ConsoleChan ch;
+
+    con_out = malloc(CON_OUT_SIZE);
+    printf("\nconsole: %d threads x %d lines (10-100 B each) through a %d B ring\n\n", CON_THREADS, CON_LINES,
+           RING_SIZE);
+    for (int channel = 0; channel < 2; channel++) {
+        con_run(channel, &lines[channel], &whole[channel], &locks[channel]);
+        printf("  %-34s %6lu lines received, %6lu intact and in order, %5.1f critical sections per line\n",
+               channel ? "per-task channel, whole lines" : "fputc byte by byte (original)", (unsigned long)lines[channel],
+               (unsigned long)whole[channel], (double)locks[channel] / (CON_THREADS * CON_LINES));
+    }
+    check(lines[1] == CON_THREADS * CON_LINES && whole[1] == lines[1], "every line intact with channels");
+    check(locks[1] < (uint64_t)CON_THREADS * CON_LINES * 2, "about one critical section per line");
+    free(con_out);
+
+    // 长行分段：300 字节一行，128 字节缓冲区提交 3 段
+    ConsoleChan_Init(&ch, buf, sizeof(buf), rec_commit);
+    rec_count = 0;
+    for (uint32_t i = 0; i < 299; i++) {
+        ConsoleChan_Putc(&ch, 'x', 0);
+    }
+    ConsoleChan_Putc(&ch, '\n', 0);
+    check(rec_count == 3 && ch.stats.full == 2 && ch.len == 0, "long line split at the buffer size");
+
+    // 没有换行的提示符：所属任务写到一半时不动，停留够久后由别的上下文提交
+    rec_count = 0;
+    ConsoleChan_Putc(&ch, '>', 100);
+    ConsoleChan_Putc(&ch, ' ', 101);
+    check(ConsoleChan_FlushStale(&ch, 110, 20, rec_commit) == 0 && rec_count == 0, "fresh prompt stays buffered");
+    ch.busy = 1;
+    check(ConsoleChan_FlushStale(&ch, 130, 20, rec_commit) == 0, "channel being written is left alone");
+    ch.busy = 0;
+    check(ConsoleChan_FlushStale(&ch, 130, 20, rec_commit) == 2 && rec_count == 1 && ch.len == 0,
+          "stale prompt committed");
+    ConsoleChan_Putc(&ch, '#', 200);
+    ConsoleChan_Flush(&ch);
+    check(rec_count == 2 && ch.stats.stale == 1 && ch.stats.records == 5, "explicit flush");
+    printf("  300 B line split into %lu records; prompt without newline committed after the stale age\n",
+           (unsigned long)ch.stats.full + 1);
+}
+
+int main(void)
+{
+    stress();
+    model();
+    console();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,613 @@
+// xfer_bench.c - 串口批量传输：协议检查与吞吐量（与固件同一份 xfer.c 和 crc.c）
+//
+// 1. 解析器：数据帧与含 0xA5、伪造帧头的文本交错，按随机长度切块输入，
+//    帧全部解出、文本逐字节相同；坏帧头和 CRC 错误只丢一个字节重新同步
+// 2. 模拟链路上下载 256KB：设备端为 XferServer，发送路径按 debug.c 建模
+//    （printf 环形缓冲区与两个外部帧缓冲区轮流由 DMA 发送，921600bps 每毫秒约 92 字节），
+//    设备每毫秒运行一次（data_task 的 1 节拍等待），每 100ms 一行 printf 文本与数据帧交错；
+//    上位机每毫秒取一次到达的数据（USB 串口的批量延迟），两个方向各有 LINK_MS 的延迟。
+//    - 干净链路：文件和文本逐字节相同，有效吞吐量接近线速
+//    - 窗口为 1（停等）：每块都要等一个往返
+//    - 误码（每字节 2e-5，双向）加一次 300ms 断线：文件仍然逐字节相同，重发量与超时次数
+//    - 续传：收到 40% 时上位机退出，重新连接后从已收到的字节数续传，重发不超过一个窗口
+// 3. 与 printf 十六进制打印（每行 16 字节："%08lX: " + "%02X " x16 + "\r\n"）对比
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "xfer.h"
+#include "xfer_client.h"
+#include "uart_tx_ring.h"
+
+#define FILE_SIZE       (256u * 1024)
+#define RING_SIZE       1024            // 与 debug.h 的 DEBUG_TX_RING_SIZE 相同
+#define EXT_SLOTS       2               // 与 debug.h 的 DEBUG_TX_EXT_SLOTS 相同
+#define UART_BPS        921600
+#define LINE_BYTES_PER_S (UART_BPS / 10)
+#define LINK_MS         8               // 单向延迟（USB 串口芯片的批量定时器等）
+#define LINK_MAX        (1u << 16)      // 链路上在途字节上限
+#define TEXT_MAX        (64u * 1024)
+#define SIM_LIMIT_MS    120000
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static uint32_t rnd(uint32_t *s)
+{
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 8;
+}
+
+// =============================================================================
+// 1. 解析器
+// =============================================================================
+
+static uint8_t p_text[TEXT_MAX], p_frames_seen[64];
+static uint32_t p_text_len, p_frame_count, p_frame_bad;
+
+static void p_on_text(void *ctx, const uint8_t *data, uint32_t len)
+{
+    (void)ctx;
+    if (p_text_len + len <= sizeof(p_text)) {
+        memcpy(&p_text[p_text_len], data, len);
+    }
+    p_text_len += len;
+}
+
+static void p_on_frame(void *ctx, const XferFrame *f)
+{
+    (void)ctx;
+    // 第 k 帧：偏移 k，数据为 len 个 (k + i) 字节
+    for (uint32_t i = 0; i < f->len; i++) {
+        if (f->payload[i] != (uint8_t)(f->offset + i)) {
+            p_frame_bad++;
+            return;
+        }
+    }
+    if (f->offset < sizeof(p_frames_seen)) {
+        p_frames_seen[f->offset]++;
+    }
+    p_frame_count++;
+}
+
+static void test_parser(void)
+{
+    static uint8_t stream[256 * 1024], text[TEXT_MAX], buf[XFER_FRAME_MAX];
+    uint8_t payload[XFER_CHUNK];
+    uint32_t n = 0, text_len = 0, seed = 11, fake = 0;
+    XferParser p;
+
+    for (uint32_t k = 0; k < 64; k++) {
+        uint32_t len = k == 0 ? 0 : rnd(&seed) % XFER_CHUNK + 1;
+        uint32_t t = rnd(&seed) % 200;
+
+        // 帧之间的文本：可打印字符，偶尔是 0xA5 开头的伪帧头（一半头校验正确，只能靠 CRC 识别）
+        for (uint32_t i = 0; i < t; i++) {
+            uint8_t b = (uint8_t)(' ' + rnd(&seed) % 90);
+
+            if (rnd(&seed) % 50 == 0 && i + XFER_HEADER < t) {
+                uint8_t h[XFER_HEADER];
+
+                Xfer_Header(h, XFER_DATA, 0, k, rnd(&seed) % 64);
+                if (rnd(&seed) & 1) {
+                    h[11] ^= 0x40;
+                }
+                memcpy(&stream[n], h, XFER_HEADER);
+                memcpy(&text[text_len], h, XFER_HEADER);
+                n += XFER_HEADER;
+                text_len += XFER_HEADER;
+                i += XFER_HEADER - 1;
+                fake++;
+                continue;
+            }
+            stream[n++] = b;
+            text[text_len++] = b;
+        }
+        for (uint32_t i = 0; i < len; i++) {
+            payload[i] = (uint8_t)(k + i);
+        }
+        n += Xfer_Build(&stream[n], XFER_DATA, 1, k, payload, len);
+    }
+    // 尾部的文本把等待中的伪帧头推出去
+    for (uint32_t i = 0; i < 2 * XFER_FRAME_MAX; i++) {
+        stream[n++] = 'x';
+        text[text_len++] = 'x';
+    }
+
+    XferParser_Init(&p, buf, sizeof(buf), p_on_frame, p_on_text, NULL);
+    for (uint32_t off = 0; off < n;) {
+        uint32_t chunk = rnd(&seed) % 100 + 1;
+
+        if (chunk > n - off) {
+            chunk = n - off;
+        }
+        XferParser_Feed(&p, &stream[off], chunk);
+        off += chunk;
+    }
+    check(p_frame_count == 64 && p_frame_bad == 0, "all frames decoded");
+    check(memchr(p_frames_seen, 0, sizeof(p_frames_seen)) == NULL, "every frame seen once");
+    check(p_text_len == text_len && memcmp(p_text, text, text_len) == 0, "text between frames byte-identical");
+    printf("parser: %u bytes in random chunks, %u frames, %u fake headers in text, %u resyncs, text %s\n",
+           (unsigned)n, (unsigned)p_frame_count, (unsigned)fake, (unsigned)p.bad,
+           p_text_len == text_len && memcmp(p_text, text, text_len) == 0 ? "identical" : "DIFFERENT");
+
+    // 损坏：改数据区一个字节，该帧被丢弃，后面的帧照常解出
+    p_frame_count = p_frame_bad = p_text_len = 0;
+    for (uint32_t i = 0; i < 200; i++) {
+        payload[i] = (uint8_t)i;
+    }
+    n = Xfer_Build(stream, XFER_DATA, 1, 0, payload, 100);
+    n += Xfer_Build(&stream[n], XFER_DATA, 1, 1, &payload[1], 100);
+    stream[50] ^= 0x01;
+    XferParser_Init(&p, buf, sizeof(buf), p_on_frame, p_on_text, NULL);
+    XferParser_Feed(&p, stream, n);
+    check(p_frame_count == 1 && p_frames_seen[1] == 2 && p.bad >= 1, "corrupted frame dropped, next frame decoded");
+}
+
+// =============================================================================
+// 2. 模拟链路
+// =============================================================================
+
+/**
+ * @brief 单向链路：字节和到达时间
+ */
+typedef struct {
+    uint8_t  data[LINK_MAX];
+    uint32_t at[LINK_MAX];
+    uint32_t head, tail;
+    uint32_t error_ppb;         ///< 每字节误码概率（十亿分之一）
+    uint32_t down_from, down_to;    ///< 这段时间内发出的字节丢失（断线）
+    uint32_t seed;
+    uint32_t bytes;
+    uint32_t errors;
+} Link;
+
+static void link_put(Link *l, uint8_t b, uint32_t now)
+{
+    if (now >= l->down_from && now < l->down_to) {
+        return;
+    }
+    if (l->error_ppb != 0 && rnd(&l->seed) % 1000000u < l->error_ppb / 1000u) {
+        b ^= (uint8_t)(1u << (rnd(&l->seed) % 8));
+        l->errors++;
+    }
+    l->data[l->head % LINK_MAX] = b;
+    l->at[l->head % LINK_MAX] = now + LINK_MS;
+    l->head++;
+    l->bytes++;
+}
+
+// 取出到达时间不晚于 now 的字节
+static uint32_t link_get(Link *l, uint32_t now, uint8_t *buf, uint32_t cap)
+{
+    uint32_t n = 0;
+
+    while (l->tail != l->head && l->at[l->tail % LINK_MAX] <= now && n < cap) {
+        buf[n++] = l->data[l->tail % LINK_MAX];
+        l->tail++;
+    }
+    return n;
+}
+
+static uint8_t src_data[FILE_SIZE];
+static uint8_t dst_data[FILE_SIZE];
+
+/**
+ * @brief 设备端：发送路径按 debug.c 建模
+ */
+typedef struct {
+    XferServer  srv;
+    UartTxRing  ring;
+    uint8_t     ring_buf[RING_SIZE];
+    uint8_t     frames[EXT_SLOTS][XFER_FRAME_MAX];
+    const uint8_t *ext_buf[EXT_SLOTS];
+    uint32_t    ext_len[EXT_SLOTS];
+    uint32_t    ext_head, ext_tail, submitted;
+    const uint8_t *dma_data;    ///< 正在发送的段
+    uint32_t    dma_len, dma_pos;
+    uint8_t     dma_ext, ext_turn;
+    uint32_t    credit;         ///< 千分之一字节
+    uint32_t    text_dropped;
+    Link       *out;
+} Device;
+
+static Device dev;
+static Link d2h, h2d;
+static uint8_t text_sent[TEXT_MAX], text_recv[TEXT_MAX];
+static uint32_t text_sent_len, text_recv_len;
+
+static void dev_kick(Device *d)
+{
+    const uint8_t *data;
+    uint32_t len;
+    uint8_t ext;
+
+    if (d->dma_len != 0) {
+        return;
+    }
+    ext = d->ext_head != d->ext_tail;
+    len = UartTxRing_Span(&d->ring, &data);
+    if (ext && (len == 0 || d->ext_turn)) {
+        data = d->ext_buf[d->ext_tail % EXT_SLOTS];
+        len = d->ext_len[d->ext_tail % EXT_SLOTS];
+        d->dma_ext = 1;
+        d->ext_turn = 0;
+    } else if (len == 0) {
+        return;
+    } else {
+        d->dma_ext = 0;
+        d->ext_turn = 1;
+    }
+    d->dma_data = data;
+    d->dma_len = len;
+    d->dma_pos = 0;
+}
+
+// 921600bps 发送 1ms，段发完时相当于 DMA 完成中断：释放并接着发下一段
+static void dev_uart_ms(Device *d, uint32_t now)
+{
+    d->credit += UART_BPS / 10;
+    while (d->credit >= 1000) {
+        if (d->dma_len == 0) {
+            d->credit = 0;      // 空闲时不积累
+            return;
+        }
+        link_put(d->out, d->dma_data[d->dma_pos++], now);
+        d->credit -= 1000;
+        if (d->dma_pos == d->dma_len) {
+            if (d->dma_ext) {
+                d->ext_tail++;
+            } else {
+                UartTxRing_Consume(&d->ring, d->dma_len);
+            }
+            d->dma_len = 0;
+            dev_kick(d);
+        }
+    }
+}
+
+static void dev_write(Device *d, const uint8_t *data, uint32_t len)
+{
+    if (UartTxRing_Free(&d->ring) < len) {
+        d->text_dropped += len;
+        return;
+    }
+    UartTxRing_Write(&d->ring, data, len);
+    dev_kick(d);
+}
+
+static int port_open(void *ctx, const char *name, uint32_t *size)
+{
+    (void)ctx;
+    if (strcmp(name, "log/imu.bin") != 0) {
+        return XFER_ERR_NOENT;
+    }
+    *size = FILE_SIZE;
+    return XFER_OK;
+}
+
+static int port_read(void *ctx, uint32_t offset, uint8_t *buf, uint32_t len)
+{
+    (void)ctx;
+    memcpy(buf, &src_data[offset], len);
+    return XFER_OK;
+}
+
+static void port_close(void *ctx)
+{
+    (void)ctx;
+}
+
+static uint8_t *port_tx_buffer(void *ctx)
+{
+    Device *d = ctx;
+
+    if (d->submitted - d->ext_tail >= EXT_SLOTS) {
+        return NULL;
+    }
+    return d->frames[d->submitted % EXT_SLOTS];
+}
+
+static void port_tx_send(void *ctx, uint8_t *frame, uint32_t len)
+{
+    Device *d = ctx;
+
+    d->ext_buf[d->ext_head % EXT_SLOTS] = frame;
+    d->ext_len[d->ext_head % EXT_SLOTS] = len;
+    d->ext_head++;
+    d->submitted++;
+    dev_kick(d);
+}
+
+static void port_tx_control(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    dev_write(ctx, frame, len);
+}
+
+static void dev_init(Device *d, uint8_t window, uint32_t now)
+{
+    XferPort port = { port_open, port_read, port_close, port_tx_buffer, port_tx_send, port_tx_control, d };
+
+    memset(d, 0, sizeof(*d));
+    UartTxRing_Init(&d->ring, d->ring_buf, RING_SIZE);
+    d->out = &d2h;
+    XferServer_Init(&d->srv, &port, now);
+    d->srv.window = window;
+}
+
+// 上位机
+static void host_send(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    uint32_t now = *(const uint32_t *)ctx;
+
+    for (uint32_t i = 0; i < len; i++) {
+        link_put(&h2d, frame[i], now);
+    }
+}
+
+static int host_write(void *ctx, uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    (void)ctx;
+    if (offset + len > FILE_SIZE) {
+        return -1;
+    }
+    memcpy(&dst_data[offset], data, len);
+    return 0;
+}
+
+static void host_text(void *ctx, const uint8_t *data, uint32_t len)
+{
+    (void)ctx;
+    if (text_recv_len + len <= sizeof(text_recv)) {
+        memcpy(&text_recv[text_recv_len], data, len);
+    }
+    text_recv_len += len;
+}
+
+/**
+ * @brief 一次模拟下载
+ */
+typedef struct {
+    uint8_t  window;
+    uint32_t start;             ///< 续传起点
+    uint32_t stop_at;           ///< 收到这么多字节后上位机退出（0-不退出）
+    uint32_t error_ppb;
+    uint32_t down_from, down_to;
+} Scenario;
+
+typedef struct {
+    uint32_t ms;                ///< 从 OPEN 到收完
+    uint32_t received;          ///< 上位机收到的连续字节
+    int      state;
+    int      finished;          ///< 设备收到 CLOSE 并退出传输模式
+    XferClient_Stats cs;
+    Xfer_Stats ss;
+    uint32_t host_bad, dev_bad;
+    uint32_t errors;
+    uint32_t ack_bytes;
+} Result;
+
+static Result run(const Scenario *sc, uint16_t xid)
+{
+    static XferClient client;
+    static uint8_t chunk[LINK_MAX];
+    Result r;
+    uint32_t now = 0, done_at = 0, next_text = 50, line = 0;
+    int closed = 0;
+
+    memset(&r, 0, sizeof(r));
+    memset(&d2h, 0, sizeof(d2h));
+    memset(&h2d, 0, sizeof(h2d));
+    d2h.error_ppb = h2d.error_ppb = sc->error_ppb;
+    d2h.seed = 1234 + xid;
+    h2d.seed = 5678 + xid;
+    d2h.down_from = sc->down_from;
+    d2h.down_to = sc->down_to;
+    text_sent_len = text_recv_len = 0;
+
+    dev_init(&dev, sc->window, now);
+    XferClient_Init(&client, "log/imu.bin", sc->start, xid, host_send, host_write, host_text, &now, now);
+
+    for (now = 1; now < SIM_LIMIT_MS; now++) {
+        uint32_t n;
+        int st;
+
+        // 设备：收请求、发送窗口内的块、定时器任务的 printf、串口发送 1ms
+        n = link_get(&h2d, now, chunk, sizeof(chunk));
+        if (n > 0) {
+            XferServer_Input(&dev.srv, chunk, n, now);
+        }
+        if (XferServer_Poll(&dev.srv, now) == XFER_FINISHED) {
+            r.finished = 1;
+        }
+        if (now >= next_text) {
+            char buf[48];
+            int len = snprintf(buf, sizeof(buf), "xTimers1 callback %lu\r\n", (unsigned long)line++);
+
+            dev_write(&dev, (const uint8_t *)buf, (uint32_t)len);
+            if (text_sent_len + len <= sizeof(text_sent)) {
+                memcpy(&text_sent[text_sent_len], buf, len);
+            }
+            text_sent_len += len;
+            next_text += 100;
+        }
+        dev_uart_ms(&dev, now);
+
+        // 上位机
+        n = link_get(&d2h, now, chunk, sizeof(chunk));
+        if (sc->stop_at != 0 && client.expected >= sc->stop_at) {
+            break;              // 上位机退出，设备端的会话留给空闲超时
+        }
+        if (n > 0) {
+            XferClient_Input(&client, chunk, n, now);
+        }
+        st = XferClient_Poll(&client, now);
+        if (st == XFER_CLIENT_FAILED) {
+            break;
+        }
+        if (st == XFER_CLIENT_DONE && !closed) {
+            done_at = now;
+            XferClient_Close(&client);
+            closed = 1;
+        }
+        if (r.finished && closed && d2h.tail == d2h.head && dev.dma_len == 0) {
+            break;
+        }
+    }
+    r.ms = done_at != 0 ? done_at : now;
+    r.received = client.expected;
+    r.state = client.state;
+    r.cs = client.stats;
+    r.ss = dev.srv.stats;
+    r.host_bad = client.parser.bad;
+    r.dev_bad = dev.srv.parser.bad;
+    r.errors = d2h.errors + h2d.errors;
+    r.ack_bytes = h2d.bytes;
+    return r;
+}
+
+static uint32_t rate(uint32_t bytes, uint32_t ms)
+{
+    return ms == 0 ? 0 : (uint32_t)((uint64_t)bytes * 1000 / ms);
+}
+
+static void report(const char *what, const Result *r, uint32_t bytes)
+{
+    uint32_t bps = rate(bytes, r->ms);
+
+    printf("  %-24s %5u ms  %6u B/s (%3u%% of line rate)  frames %u, resent %u B, timeouts %u, rewinds %u, "
+           "acks %u (%u B)\n",
+           what, (unsigned)r->ms, (unsigned)bps, (unsigned)(bps * 100 / LINE_BYTES_PER_S),
+           (unsigned)r->ss.frames, (unsigned)r->ss.resent, (unsigned)r->ss.timeouts,
+           (unsigned)r->ss.rewinds, (unsigned)r->cs.acks, (unsigned)r->ack_bytes);
+}
+
+static int file_ok(void)
+{
+    return memcmp(src_data, dst_data, FILE_SIZE) == 0;
+}
+
+static void test_link(void)
+{
+    Scenario sc;
+    Result clean, saw, noisy, first, resumed;
+    uint32_t seed = 99;
+
+    for (uint32_t i = 0; i < FILE_SIZE; i++) {
+        src_data[i] = (uint8_t)rnd(&seed);
+    }
+    printf("download %u KB at %u bps, one-way latency %u ms, chunk %u B:\n",
+           (unsigned)(FILE_SIZE / 1024), (unsigned)UART_BPS, (unsigned)LINK_MS, (unsigned)XFER_CHUNK);
+
+    // 干净链路，窗口 XFER_WINDOW
+    memset(&sc, 0, sizeof(sc));
+    sc.window = XFER_WINDOW;
+    memset(dst_data, 0, sizeof(dst_data));
+    clean = run(&sc, 1);
+    report("window 8", &clean, FILE_SIZE);
+    check(clean.state == XFER_CLIENT_DONE && file_ok(), "clean link: file identical");
+    check(clean.finished, "device left transfer mode on CLOSE");
+    check(text_recv_len == text_sent_len && memcmp(text_recv, text_sent, text_sent_len) == 0,
+          "clean link: printf text interleaved intact");
+    check(clean.ss.resent == 0 && clean.ss.timeouts == 0, "clean link: nothing resent");
+    check(rate(FILE_SIZE, clean.ms) * 100 >= LINE_BYTES_PER_S * 90, "clean link: at least 90% of line rate");
+    printf("  text: %u bytes of printf interleaved, %s\n", (unsigned)text_sent_len,
+           text_recv_len == text_sent_len && memcmp(text_recv, text_sent, text_sent_len) == 0 ? "identical"
+                                                                                              : "DIFFERENT");
+
+    // 停等
+    sc.window = 1;
+    memset(dst_data, 0, sizeof(dst_data));
+    saw = run(&sc, 2);
+    report("window 1 (stop-and-wait)", &saw, FILE_SIZE);
+    check(saw.state == XFER_CLIENT_DONE && file_ok(), "stop-and-wait: file identical");
+    check(saw.ms > clean.ms, "sliding window faster than stop-and-wait");
+
+    // 误码 + 断线
+    sc.window = XFER_WINDOW;
+    sc.error_ppb = 20000;
+    sc.down_from = 1000;
+    sc.down_to = 1300;
+    memset(dst_data, 0, sizeof(dst_data));
+    noisy = run(&sc, 3);
+    report("errors + 300ms outage", &noisy, FILE_SIZE);
+    printf("  %u bit errors injected, resyncs: host %u, device %u\n",
+           (unsigned)noisy.errors, (unsigned)noisy.host_bad, (unsigned)noisy.dev_bad);
+    check(noisy.state == XFER_CLIENT_DONE && file_ok(), "noisy link: file identical");
+    check(noisy.ss.resent > 0 && noisy.ss.timeouts + noisy.ss.rewinds > 0, "noisy link: losses repaired");
+
+    // 续传
+    memset(&sc, 0, sizeof(sc));
+    sc.window = XFER_WINDOW;
+    sc.stop_at = FILE_SIZE * 2 / 5;
+    memset(dst_data, 0, sizeof(dst_data));
+    first = run(&sc, 4);
+    check(first.received >= sc.stop_at && first.received < FILE_SIZE, "resume: first session interrupted");
+    sc.stop_at = 0;
+    sc.start = first.received;
+    resumed = run(&sc, 5);
+    report("resume", &resumed, FILE_SIZE - first.received);
+    printf("  first session stopped at %u B, resumed session sent %u B for %u B remaining\n",
+           (unsigned)first.received, (unsigned)(resumed.ss.bytes + resumed.ss.resent),
+           (unsigned)(FILE_SIZE - first.received));
+    check(resumed.state == XFER_CLIENT_DONE && file_ok(),
+          "resume: file identical");
+    check(resumed.ss.bytes + resumed.ss.resent <= FILE_SIZE - first.received + XFER_WINDOW * XFER_CHUNK,
+          "resume: no more than one window sent twice");
+
+    // 不存在的文件
+    {
+        static XferClient c;
+        uint32_t now = 0;
+
+        memset(&h2d, 0, sizeof(h2d));
+        memset(&d2h, 0, sizeof(d2h));
+        dev_init(&dev, XFER_WINDOW, 0);
+        XferClient_Init(&c, "nope.bin", 0, 6, host_send, host_write, host_text, &now, 0);
+        for (now = 1; now < 1000 && c.state == XFER_CLIENT_OPENING; now++) {
+            uint8_t buf[256];
+            uint32_t n = link_get(&h2d, now, buf, sizeof(buf));
+
+            XferServer_Input(&dev.srv, buf, n, now);
+            XferServer_Poll(&dev.srv, now);
+            dev_uart_ms(&dev, now);
+            n = link_get(&d2h, now, buf, sizeof(buf));
+            XferClient_Input(&c, buf, n, now);
+            XferClient_Poll(&c, now);
+        }
+        check(c.state == XFER_CLIENT_FAILED && c.error == XFER_ERR_NOENT, "missing file reported");
+    }
+}
+
+// =============================================================================
+// 3. 十六进制打印
+// =============================================================================
+
+static void compare_hexdump(void)
+{
+    uint32_t hex_bytes = FILE_SIZE / 16 * (10 + 16 * 3 + 2);
+    uint32_t frame_bytes = (FILE_SIZE / XFER_CHUNK) * (XFER_HEADER + 4) + FILE_SIZE;
+
+    printf("compared with printf hex dump of the same %u KB:\n", (unsigned)(FILE_SIZE / 1024));
+    printf("  hex dump     %8u bytes on the wire, %5u ms, no integrity check, no resume\n",
+           (unsigned)hex_bytes, (unsigned)((uint64_t)hex_bytes * 1000 / LINE_BYTES_PER_S));
+    printf("  xfer frames  %8u bytes on the wire, %5u ms (%.1f%% framing overhead)\n",
+           (unsigned)frame_bytes, (unsigned)((uint64_t)frame_bytes * 1000 / LINE_BYTES_PER_S),
+           100.0 * (frame_bytes - FILE_SIZE) / FILE_SIZE);
+}
+
+int main(void)
+{
+    test_parser();
+    test_link();
+    compare_hexdump();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
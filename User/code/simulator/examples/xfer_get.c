@@ -0,0 +1,255 @@
+// xfer_get.c - 通过串口从设备下载文件或 Flash 分区（设备端见 ui/xfer_service.c，协议见 code/xfer.h）
+//
+// 用法: xfer_get [--resume] [--baud N] <串口> <名字> <输出文件>
+//   名字为设备上的 FatFs 路径（"1:" 前缀为 SD 卡），或原始分区 @flash @fatfs @kv @ts @steps @assets @tags
+//   --resume  输出文件已有的字节不再下载，从其末尾续传（上一次中断后使用）
+//   --baud N  串口波特率，默认 921600
+//
+// 先发 "xfer\r" 让设备进入传输模式，收到 "OK" 后开始下载。设备其它任务的 printf 与数据帧交错，
+// 原样输出到标准输出。没有伪终端设备时可用 xfer_loopback 代替设备。
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "xfer_client.h"
+
+#define ENTER_TIMEOUT_MS    2000
+#define STALL_TIMEOUT_MS    5000        // 这么久没有进展时放弃（之后用 --resume 续传）
+
+static int serial_fd = -1;
+static FILE *out_file;
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static speed_t baud_constant(long baud)
+{
+    switch (baud) {
+    case 9600: return B9600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return 0;
+    }
+}
+
+static int serial_open(const char *path, long baud)
+{
+    struct termios tio;
+    speed_t speed = baud_constant(baud);
+    int fd;
+
+    if (speed == 0) {
+        fprintf(stderr, "unsupported baud rate %ld\n", baud);
+        return -1;
+    }
+    fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+        tcflush(fd, TCIOFLUSH);
+    }
+    return fd;
+}
+
+static void serial_write(const uint8_t *data, uint32_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(serial_fd, data, len);
+
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            perror("write");
+            return;
+        }
+        data += n;
+        len -= (uint32_t)n;
+    }
+}
+
+// 等待数据，最多 timeout_ms
+static uint32_t serial_read(uint8_t *buf, uint32_t cap, int timeout_ms)
+{
+    struct pollfd pfd = { serial_fd, POLLIN, 0 };
+    ssize_t n;
+
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return 0;
+    }
+    n = read(serial_fd, buf, cap);
+    return n > 0 ? (uint32_t)n : 0;
+}
+
+static void client_send(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    (void)ctx;
+    serial_write(frame, len);
+}
+
+static int client_write(void *ctx, uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    (void)ctx;
+    if (fseek(out_file, (long)offset, SEEK_SET) != 0 || fwrite(data, 1, len, out_file) != len) {
+        return -1;
+    }
+    return 0;
+}
+
+static void client_text(void *ctx, const uint8_t *data, uint32_t len)
+{
+    (void)ctx;
+    fwrite(data, 1, len, stdout);
+    fflush(stdout);
+}
+
+// 进入传输模式：发命令，等命令解释器回 OK
+static int enter_transfer_mode(void)
+{
+    static const char cmd[] = "xfer\r";
+    char text[512];
+    uint32_t n = 0, start = now_ms();
+
+    serial_write((const uint8_t *)cmd, sizeof(cmd) - 1);
+    while (now_ms() - start < ENTER_TIMEOUT_MS) {
+        n += serial_read((uint8_t *)&text[n], sizeof(text) - 1 - n, 50);
+        text[n] = '\0';
+        if (strstr(text, "OK\r\n") != NULL) {
+            return 0;
+        }
+        if (strstr(text, "ERR") != NULL && strstr(text, "\r\n") != NULL) {
+            break;
+        }
+        if (n == sizeof(text) - 1) {
+            memmove(text, &text[n / 2], n - n / 2);
+            n -= n / 2;
+        }
+    }
+    fprintf(stderr, "device did not enter transfer mode: %s\n", n > 0 ? text : "(no reply)");
+    return -1;
+}
+
+static const char *error_name(int err)
+{
+    switch (err) {
+    case XFER_ERR_NOENT: return "no such file or partition";
+    case XFER_ERR_IO: return "read error";
+    case XFER_ERR_RANGE: return "resume offset beyond the end";
+    case XFER_ERR_BUSY: return "busy";
+    default: return "unknown error";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static XferClient client;
+    uint8_t buf[4096];
+    const char *dev, *name, *out_path;
+    long baud = 921600;
+    int resume = 0, argi = 1, st;
+    uint32_t start = 0, t0, last_progress, last_report, progress_at;
+
+    while (argi < argc && strncmp(argv[argi], "--", 2) == 0) {
+        if (strcmp(argv[argi], "--resume") == 0) {
+            resume = 1;
+            argi++;
+        } else if (strcmp(argv[argi], "--baud") == 0 && argi + 1 < argc) {
+            baud = strtol(argv[argi + 1], NULL, 10);
+            argi += 2;
+        } else {
+            break;
+        }
+    }
+    if (argc - argi != 3) {
+        fprintf(stderr, "usage: %s [--resume] [--baud N] <serial device> <name> <output file>\n", argv[0]);
+        return 2;
+    }
+    dev = argv[argi];
+    name = argv[argi + 1];
+    out_path = argv[argi + 2];
+
+    out_file = resume ? fopen(out_path, "r+b") : NULL;
+    if (out_file != NULL) {
+        fseek(out_file, 0, SEEK_END);
+        start = (uint32_t)ftell(out_file);
+    } else {
+        out_file = fopen(out_path, "w+b");
+    }
+    if (out_file == NULL) {
+        perror(out_path);
+        return 1;
+    }
+    serial_fd = serial_open(dev, baud);
+    if (serial_fd < 0 || enter_transfer_mode() != 0) {
+        return 1;
+    }
+
+    t0 = last_progress = last_report = now_ms();
+    progress_at = start;
+    XferClient_Init(&client, name, start, (uint16_t)getpid(), client_send, client_write, client_text, NULL, t0);
+    while (1) {
+        uint32_t n = serial_read(buf, sizeof(buf), 5), now = now_ms();
+
+        if (n > 0) {
+            XferClient_Input(&client, buf, n, now);
+        }
+        st = XferClient_Poll(&client, now);
+        if (st == XFER_CLIENT_DONE || st == XFER_CLIENT_FAILED) {
+            break;
+        }
+        if (client.expected != progress_at) {
+            progress_at = client.expected;
+            last_progress = now;
+        } else if (now - last_progress >= STALL_TIMEOUT_MS) {
+            fprintf(stderr, "\nno progress for %u ms, stopped at %u bytes (retry with --resume)\n",
+                    STALL_TIMEOUT_MS, (unsigned)client.expected);
+            break;
+        }
+        if (st == XFER_CLIENT_RECEIVING && now - last_report >= 500) {
+            fprintf(stderr, "\r%s: %u / %u bytes", name, (unsigned)client.expected, (unsigned)client.size);
+            last_report = now;
+        }
+    }
+    // 结束会话，设备回到命令模式（CLOSE 丢失时设备在空闲超时后自行退出）
+    XferClient_Close(&client);
+    fclose(out_file);
+
+    if (st == XFER_CLIENT_FAILED) {
+        fprintf(stderr, "%s: %s\n", name, error_name(client.error));
+        return 1;
+    }
+    if (st != XFER_CLIENT_DONE) {
+        return 1;
+    }
+    {
+        uint32_t ms = now_ms() - t0, bytes = client.size - start;
+
+        fprintf(stderr, "\r%s: %u bytes in %u ms (%u B/s)%s, %u frames, %u duplicate, %u out of order, "
+                "%u resyncs\n", name, (unsigned)bytes, (unsigned)ms,
+                (unsigned)(ms > 0 ? (uint64_t)bytes * 1000 / ms : 0), start > 0 ? " resumed" : "",
+                (unsigned)client.stats.frames, (unsigned)client.stats.duplicate,
+                (unsigned)client.stats.out_of_order, (unsigned)client.parser.bad);
+    }
+    return 0;
+}
@@ -0,0 +1,261 @@
+// xfer_loopback.c - Linux 伪终端上的设备替身：没有开发板时用 xfer_get 测试下载
+//
+// 用法: xfer_loopback [--loss N] <目录>
+//   创建一个伪终端并打印其路径，xfer_get 把它当作设备的串口打开：
+//     ./xfer_loopback /tmp/files &
+//     ./xfer_get /dev/pts/N log/imu.bin imu.bin
+//   命令模式下与设备的命令解释器一样回显并回复 "xfer" 命令（OK），其它命令回复 ERR；
+//   传输模式运行与固件同一份 XferServer（xfer.c），名字为 <目录> 下的相对路径。
+//   发送按 921600bps 限速：两个帧缓冲区轮流发送，与固件 Debug_SendBuffer 相同，
+//   每秒插入一行文本，模拟其它任务的 printf。
+//   --loss N  每 N 个数据帧丢弃一个（链路丢帧，检查重发）
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "xfer.h"
+
+#define LINE_BYTES_PER_S    (921600 / 10)
+#define TX_BUFFERS          2           // 与 debug.h 的 DEBUG_TX_EXT_SLOTS 相同
+#define OUT_MAX             (64u * 1024)
+
+static int master_fd;
+static const char *root_dir;
+static FILE *cur_file;
+static uint32_t loss_every, data_frames, lost_frames;
+
+// 限速发送：出口队列按经过的时间放行
+static uint8_t out_q[OUT_MAX];
+static uint32_t out_head, out_tail;     // 累计写入/发出的字节数
+static uint32_t out_credit_at;
+static uint8_t frames[TX_BUFFERS][XFER_FRAME_MAX];
+static uint32_t frame_end[TX_BUFFERS];  // 该缓冲区最后一个字节在出口队列中的位置
+static uint32_t submitted;
+
+static uint32_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static void out_put(const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len && out_head - out_tail < OUT_MAX; i++) {
+        out_q[out_head++ % OUT_MAX] = data[i];
+    }
+}
+
+static void out_text(const char *s)
+{
+    out_put((const uint8_t *)s, (uint32_t)strlen(s));
+}
+
+static void out_pump(void)
+{
+    uint32_t now = now_ms(), allowed = (now - out_credit_at) * LINE_BYTES_PER_S / 1000;
+
+    if (allowed == 0) {
+        return;
+    }
+    out_credit_at = now;
+    if (out_head == out_tail) {
+        return;
+    }
+    while (allowed > 0 && out_tail != out_head) {
+        uint32_t pos = out_tail % OUT_MAX;
+        uint32_t n = out_head - out_tail;
+        ssize_t w;
+
+        if (n > OUT_MAX - pos) {
+            n = OUT_MAX - pos;
+        }
+        if (n > allowed) {
+            n = allowed;
+        }
+        w = write(master_fd, &out_q[pos], n);
+        if (w <= 0) {
+            break;
+        }
+        out_tail += (uint32_t)w;
+        allowed -= (uint32_t)w;
+    }
+}
+
+static int port_open(void *ctx, const char *name, uint32_t *size)
+{
+    char path[512];
+    long len;
+
+    (void)ctx;
+    if (name[0] == '@' || name[0] == '/' || strstr(name, "..") != NULL) {
+        return XFER_ERR_NOENT;
+    }
+    snprintf(path, sizeof(path), "%s/%s", root_dir, name);
+    cur_file = fopen(path, "rb");
+    if (cur_file == NULL) {
+        return XFER_ERR_NOENT;
+    }
+    fseek(cur_file, 0, SEEK_END);
+    len = ftell(cur_file);
+    *size = len > 0 ? (uint32_t)len : 0;
+    fprintf(stderr, "open %s (%u bytes)\n", name, (unsigned)*size);
+    return XFER_OK;
+}
+
+static int port_read(void *ctx, uint32_t offset, uint8_t *buf, uint32_t len)
+{
+    (void)ctx;
+    if (fseek(cur_file, (long)offset, SEEK_SET) != 0 || fread(buf, 1, len, cur_file) != len) {
+        return XFER_ERR_IO;
+    }
+    return XFER_OK;
+}
+
+static void port_close(void *ctx)
+{
+    (void)ctx;
+    if (cur_file != NULL) {
+        fclose(cur_file);
+        cur_file = NULL;
+    }
+}
+
+static uint8_t *port_tx_buffer(void *ctx)
+{
+    (void)ctx;
+    if (submitted >= TX_BUFFERS && (int32_t)(out_tail - frame_end[submitted % TX_BUFFERS]) < 0) {
+        return NULL;        // 这个缓冲区还在发送
+    }
+    return frames[submitted % TX_BUFFERS];
+}
+
+static void port_tx_send(void *ctx, uint8_t *frame, uint32_t len)
+{
+    (void)ctx;
+    if (loss_every != 0 && ++data_frames % loss_every == 0) {
+        lost_frames++;
+    } else {
+        out_put(frame, len);
+    }
+    frame_end[submitted % TX_BUFFERS] = out_head;
+    submitted++;
+}
+
+static void port_tx_control(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    (void)ctx;
+    out_put(frame, len);
+}
+
+static int pty_create(void)
+{
+    struct termios tio;
+    int slave;
+
+    master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+    fcntl(master_fd, F_SETFL, fcntl(master_fd, F_GETFL) | O_NONBLOCK);     // 没有上位机读取时不阻塞
+    // 自己保持从端打开：上位机关闭串口后主端读不到 EIO，可以反复连接
+    slave = open(ptsname(master_fd), O_RDWR | O_NOCTTY);
+    if (slave >= 0 && tcgetattr(slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+    }
+    printf("device: %s\n", ptsname(master_fd));
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static XferServer server;
+    XferPort port = { port_open, port_read, port_close, port_tx_buffer, port_tx_send, port_tx_control, NULL };
+    char line[128];
+    uint32_t line_len = 0, next_text, ticks = 0;
+    int argi = 1, active = 0;
+
+    if (argi + 1 < argc && strcmp(argv[argi], "--loss") == 0) {
+        loss_every = (uint32_t)strtoul(argv[argi + 1], NULL, 10);
+        argi += 2;
+    }
+    if (argc - argi != 1) {
+        fprintf(stderr, "usage: %s [--loss N] <directory>\n", argv[0]);
+        return 2;
+    }
+    root_dir = argv[argi];
+    if (pty_create() != 0) {
+        return 1;
+    }
+    out_credit_at = now_ms();
+    next_text = out_credit_at + 1000;
+
+    while (1) {
+        struct pollfd pfd = { master_fd, POLLIN, 0 };
+        uint8_t buf[256];
+        uint32_t n = 0, now;
+
+        if (poll(&pfd, 1, 1) > 0) {
+            ssize_t r = read(master_fd, buf, sizeof(buf));
+
+            n = r > 0 ? (uint32_t)r : 0;
+        }
+        now = now_ms();
+        if (active) {
+            if (n > 0) {
+                XferServer_Input(&server, buf, n, now);
+            }
+            if (XferServer_Poll(&server, now) == XFER_FINISHED) {
+                const Xfer_Stats *st = &server.stats;
+
+                fprintf(stderr, "transfer mode left: %u sessions, %u completed, %u frames, %u bytes, %u resent, "
+                        "%u timeouts, %u rewinds, %u lost on purpose\n",
+                        (unsigned)st->sessions, (unsigned)st->completed, (unsigned)st->frames, (unsigned)st->bytes,
+                        (unsigned)st->resent, (unsigned)st->timeouts, (unsigned)st->rewinds, (unsigned)lost_frames);
+                active = 0;
+            }
+        } else {
+            // 命令模式：回显，按行执行
+            out_put(buf, n);
+            for (uint32_t i = 0; i < n; i++) {
+                if (buf[i] != '\r' && buf[i] != '\n') {
+                    if (line_len < sizeof(line) - 1) {
+                        line[line_len++] = (char)buf[i];
+                    }
+                    continue;
+                }
+                line[line_len] = '\0';
+                if (strcmp(line, "xfer") == 0) {
+                    out_text("\r\nOK\r\n");
+                    XferServer_Init(&server, &port, now);
+                    active = 1;
+                    line_len = 0;
+                    break;      // 同一块中 OK 之前不会有请求（上位机等 OK）
+                }
+                if (line_len > 0) {
+                    out_text("\r\nERR unknown command (xfer_loopback only knows xfer)\r\n");
+                }
+                line_len = 0;
+            }
+        }
+        if ((int32_t)(now - next_text) >= 0) {
+            char text[48];
+
+            snprintf(text, sizeof(text), "loopback tick %u\r\n", (unsigned)ticks++);
+            out_text(text);
+            next_text += 1000;
+        }
+        out_pump();
+    }
+}
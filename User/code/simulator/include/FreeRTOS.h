@@ -0,0 +1,34 @@
+/**
+ * @file FreeRTOS.h
+ * @brief 主机模拟构建用的 FreeRTOS 替身
+ * @details 模拟器是单线程程序，调度器永远不会启动：
+ *          xTaskGetSchedulerState() 返回 taskSCHEDULER_NOT_STARTED，
+ *          创建任务/队列失败，storage_service.c 等模块因此在调用方同步执行。
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFUL)
+#define configTICK_RATE_HZ      1000
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+
+#define taskENTER_CRITICAL()    do { } while (0)
+#define taskEXIT_CRITICAL()     do { } while (0)
+
+static inline void *pvPortMalloc(size_t size) { return malloc(size); }
+static inline void vPortFree(void *p) { free(p); }
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file binlog_decode.h
+ * @brief 二进制日志主机端解码（字符串表提取、记录解析、格式化）
+ * @details 与固件的 binlog.h 配套：
+ *          - BinlogTable_LoadElf 从固件映像（.axf/.elf，32/64 位）取出 logstr 段，编号为字符串在段内的偏移。
+ *            先找 __start_logstr/__stop_logstr（GCC）或 logstr$$Base/logstr$$Limit（armlink），
+ *            没有符号表时按段名 logstr 查找。
+ *          - BinlogTable_Save/Load 保存成文本字符串表（每行 "编号<TAB>级别|模块|格式串"），
+ *            解码时不需要映像本身。
+ *          - BinlogDecoder 按字节流解析：首字节 < 0xF8 的数据原样作为文本输出（普通 printf），
+ *            0xF8~0xFF 开始一条记录；编号不在表中或参数个数与格式串不符时丢弃 1 字节重新同步。
+ */
+
+#ifndef BINLOG_DECODE_H
+#define BINLOG_DECODE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define BINLOG_MSG_MAX      256
+
+/**
+ * @brief 字符串表中的一项
+ */
+typedef struct {
+    uint32_t    id;             ///< 段内偏移
+    char        level;          ///< E/W/I/D
+    char       *module;
+    char       *fmt;
+    uint8_t     nargs;          ///< 格式串需要的参数个数
+} BinlogEntry;
+
+typedef struct {
+    BinlogEntry *entries;       ///< 按 id 升序
+    uint32_t     count;
+} BinlogTable;
+
+/**
+ * @brief 解码出的一条记录
+ */
+typedef struct {
+    const BinlogEntry *entry;
+    uint32_t           timestamp;   ///< 毫秒
+    uint32_t           args[7];
+    uint8_t            nargs;
+    char               message[BINLOG_MSG_MAX];
+} BinlogRecord;
+
+typedef struct {
+    void (*text)(void *ctx, const uint8_t *data, size_t len);  ///< 记录之间的普通文本
+    void (*record)(void *ctx, const BinlogRecord *rec);
+    void *ctx;
+} BinlogSink;
+
+/**
+ * @brief 解码统计
+ */
+typedef struct {
+    uint32_t records;
+    uint32_t text_bytes;
+    uint32_t skipped;           ///< 重新同步丢弃的字节数
+    uint32_t unknown_ids;       ///< 其中编号不在表中的次数
+} BinlogDecode_Stats;
+
+typedef struct {
+    const BinlogTable  *table;
+    BinlogSink          sink;
+    uint8_t             pend[64];
+    uint32_t            pn;
+    BinlogDecode_Stats  stats;
+} BinlogDecoder;
+
+int BinlogTable_LoadElf(BinlogTable *table, const char *path);
+int BinlogTable_Save(const BinlogTable *table, const char *path);
+int BinlogTable_Load(BinlogTable *table, const char *path);
+void BinlogTable_Free(BinlogTable *table);
+const BinlogEntry *BinlogTable_Find(const BinlogTable *table, uint32_t id);
+
+int Binlog_Format(const char *fmt, const uint32_t *args, uint32_t nargs, char *out, size_t size);
+uint32_t Binlog_CountArgs(const char *fmt);
+
+void BinlogDecode_Init(BinlogDecoder *dec, const BinlogTable *table, const BinlogSink *sink);
+void BinlogDecode_Feed(BinlogDecoder *dec, const uint8_t *data, size_t len);
+void BinlogDecode_Flush(BinlogDecoder *dec);
+
+void BinlogRecord_Print(FILE *out, const BinlogRecord *rec);
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @file oled_replay.h
+ * @brief OLED 镜像的上位机端：按帧还原画面、统计刷新热点，以及回放文件的读写
+ * @details 与固件的 oled_mirror.h / ui/screen_mirror.c 配套。遥测接收（telem_decode.h）的 frame 回调
+ *          把通道 "oled" 的帧交给 OledScreen_Frame。序号不连续（链路丢帧）时画面标记为过期，
+ *          直到收齐 8 页关键帧记录（设备在丢帧后的下一次刷新和每隔几秒整屏重发）。
+ *
+ *          回放文件（.rpl）：8 字节 "OLEDRPL1"，之后每帧一条
+ *
+ *            时间 ms(4) 序号(1) 长度(2) 帧内容   小端
+ *
+ *          帧内容与遥测帧的数据部分相同，可用同一份 OledScreen_Frame 离线重放。
+ */
+
+#ifndef OLED_REPLAY_H
+#define OLED_REPLAY_H
+
+#include "oled_mirror.h"
+#include <stdint.h>
+#include <stdio.h>
+
+#define OLED_REPLAY_MAGIC       "OLEDRPL1"
+#define OLED_REPLAY_WIRE_EXTRA  19      ///< 每帧在串口上的额外字节：帧头 12 + CRC 4 + COBS 1 + 分隔符 2
+
+/**
+ * @brief 还原统计
+ */
+typedef struct {
+    uint32_t frames;
+    uint32_t records;
+    uint32_t bytes;             ///< 帧内容字节数
+    uint32_t changed;           ///< 实际改变的显存字节数
+    uint32_t lost;              ///< 按序号推算的丢帧数
+    uint32_t bad;               ///< 内容不合法的帧
+    uint32_t keyframes;         ///< 收齐整屏的次数
+    uint32_t t_first;
+    uint32_t t_last;
+} OledScreen_Stats;
+
+typedef struct {
+    uint8_t  gram[OLED_MIRROR_GRAM_SIZE];   ///< 与设备相同的列优先布局
+    uint8_t  stale;                         ///< 丢过帧、尚未收齐关键帧
+    uint8_t  key_pages;                     ///< 本轮已收到关键帧记录的页
+    uint8_t  have_seq;
+    uint8_t  next_seq;
+    uint32_t heat[OLED_MIRROR_PAGES][OLED_MIRROR_COLS];    ///< 每个显存字节被改变的次数
+    OledScreen_Stats stats;
+} OledScreen;
+
+void OledScreen_Init(OledScreen *s);
+int OledScreen_Frame(OledScreen *s, uint8_t seq, uint32_t t_ms, const uint8_t *data, uint32_t len);
+int OledScreen_Pixel(const OledScreen *s, uint32_t x, uint32_t y);
+int OledScreen_WritePbm(const OledScreen *s, const char *path);
+
+int OledReplay_WriteHeader(FILE *f);
+int OledReplay_Write(FILE *f, uint32_t t_ms, uint8_t seq, const uint8_t *data, uint32_t len);
+int OledReplay_ReadHeader(FILE *f);
+int OledReplay_Read(FILE *f, uint32_t *t_ms, uint8_t *seq, uint8_t *data, uint32_t cap);
+
+#endif
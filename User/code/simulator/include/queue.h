@@ -0,0 +1,37 @@
+/**
+ * @file queue.h
+ * @brief 主机模拟构建用的 FreeRTOS queue.h 替身（创建总是失败，见 FreeRTOS.h）
+ */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef void *QueueHandle_t;
+
+static inline QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t item_size)
+{
+    (void)len; (void)item_size;
+    return NULL;
+}
+
+static inline BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t timeout)
+{
+    (void)q; (void)item; (void)timeout;
+    return pdFAIL;
+}
+
+static inline BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t timeout)
+{
+    (void)q; (void)item; (void)timeout;
+    return pdFAIL;
+}
+
+static inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    (void)q;
+    return 0;
+}
+
+#endif
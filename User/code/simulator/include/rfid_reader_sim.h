@@ -0,0 +1,81 @@
+/**
+ * @file rfid_reader_sim.h
+ * @brief 串口 RFID 读卡模块的主机端替身：按 rfid.h 的帧格式应答，模拟串口速率、处理时间、卡的进出和链路故障
+ * @details 读卡模块串行处理命令：收齐一帧命令放入输入缓冲区（RFID_SIM_CMD_DEPTH 条，满时丢弃），
+ *          逐条处理 process_us 后把应答放到发送线路上。卡按时间表出现在天线场内（from_ms..to_ms），
+ *          命令执行时场内有卡就按 S50 卡应答，否则回 1 字节失败状态。
+ *          故障注入：每 drop_every 个应答丢一个，每 corrupt_every 个翻转一位，每 noise_every 个之前插入几个乱码字节。
+ *
+ *          RfidSimLine 是一个方向的串口线路：字节按波特率逐个到达，线路上还有字节时发送方看到“忙”。
+ */
+
+#ifndef RFID_READER_SIM_H
+#define RFID_READER_SIM_H
+
+#include "rfid.h"
+#include <stdint.h>
+
+#define RFID_SIM_CARDS_MAX      256
+#define RFID_SIM_CMD_DEPTH      2       ///< 读卡模块能缓存的命令数（包括正在处理的）
+#define RFID_SIM_LINE_MAX       512
+#define RFID_SIM_FAIL           0x01    ///< 无卡等失败状态
+#define RFID_SIM_UNKNOWN        0x02    ///< 不认识的命令
+
+/**
+ * @brief 一个方向的串口线路
+ */
+typedef struct {
+    uint8_t  q[RFID_SIM_LINE_MAX];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t byte_us;       ///< 一个字节（10 位）的时间
+    uint32_t next_us;       ///< 队首字节到达的时间
+} RfidSimLine;
+
+typedef struct {
+    uint32_t uid;
+    uint32_t from_ms;
+    uint32_t to_ms;
+} RfidSimCard;
+
+typedef struct {
+    uint32_t commands;      ///< 收到的完整命令
+    uint32_t overflow;      ///< 输入缓冲区满而丢弃的命令
+    uint32_t replies;
+    uint32_t dropped;
+    uint32_t corrupted;
+    uint32_t noise;         ///< 插入的乱码字节
+} RfidSim_Stats;
+
+typedef struct {
+    RfidParser    parser;
+    RfidSimLine  *out;                      ///< 应答发往的线路
+    RfidSimCard   cards[RFID_SIM_CARDS_MAX];
+    uint32_t      ncards;
+    uint8_t       cmd[RFID_SIM_CMD_DEPTH][RFID_FRAME_MAX];
+    uint32_t      cmd_head;
+    uint32_t      cmd_tail;
+    uint8_t       busy;
+    uint32_t      done_us;                  ///< 正在处理的命令完成的时间
+    uint32_t      now_us;
+    uint32_t      process_us;
+    uint32_t      drop_every;
+    uint32_t      corrupt_every;
+    uint32_t      noise_every;
+    uint32_t      rng;
+    RfidSim_Stats stats;
+} RfidReaderSim;
+
+void RfidSimLine_Init(RfidSimLine *line, uint32_t baud);
+uint32_t RfidSimLine_Put(RfidSimLine *line, uint32_t now_us, const uint8_t *data, uint32_t len);
+uint32_t RfidSimLine_Take(RfidSimLine *line, uint32_t now_us, uint8_t *buf, uint32_t cap);
+uint32_t RfidSimLine_Pending(const RfidSimLine *line);
+
+void RfidSim_Init(RfidReaderSim *sim, RfidSimLine *out, uint32_t process_us, uint32_t seed);
+int RfidSim_AddCard(RfidReaderSim *sim, uint32_t uid, uint32_t from_ms, uint32_t to_ms);
+uint32_t RfidSim_CardAt(const RfidReaderSim *sim, uint32_t t_ms);
+void RfidSim_Input(RfidReaderSim *sim, const uint8_t *data, uint32_t len, uint32_t now_us);
+void RfidSim_Run(RfidReaderSim *sim, uint32_t now_us);
+void RfidSim_BlockData(uint32_t uid, uint8_t block, uint8_t *data);
+
+#endif
@@ -0,0 +1,71 @@
+/**
+ * @file sd_card_sim.h
+ * @brief SD 卡命令协议模型（实现 sdio_sd.h 中的 SD_HW_* 接口）
+ * @details 按 SD 物理层规范 2.0 的卡状态机（idle/ready/ident/stby/tran/data/rcv/prg）响应命令，
+ *          数据保存在内存中。主机驱动的时序错误都记为违例而不是直接失败，
+ *          演示程序据此检查驱动的命令顺序：
+ *          - 当前状态下非法的命令：卡不响应，下一个 R1 置 ILLEGAL_COMMAND
+ *          - 识别阶段时钟超过 400kHz，或任何时候超过 25MHz
+ *          - 数据传输时主机与卡的总线位宽不一致
+ *          - 读命令发出前没有使能数据通道，或写命令响应前就使能了数据通道
+ *          - SDSC 卡收到非 512 字节对齐的字节地址（把扇区号当地址用）
+ *          命令、数据和卡内编程耗时累加到 W25Q128 模拟器的时钟上，可以与 Flash 直接比较。
+ */
+
+#ifndef SD_CARD_SIM_H
+#define SD_CARD_SIM_H
+
+#include <stdint.h>
+
+/**
+ * @brief 模拟卡类型
+ */
+typedef enum {
+    SD_SIM_SDHC = 0,    ///< SD 2.0 高容量（CSD 2.0，扇区地址）
+    SD_SIM_SDSC_V2,     ///< SD 2.0 标准容量（CSD 1.0，字节地址）
+    SD_SIM_SDSC_V1,     ///< SD 1.x（不响应 CMD8）
+    SD_SIM_MMC          ///< MMC（不响应 CMD55，驱动应报告不支持）
+} SD_Sim_CardType;
+
+// 时序参数（典型 Class 10 卡，默认速度模式）
+#define SD_SIM_NCR_CLOCKS       16      ///< 命令到响应的时钟数
+#define SD_SIM_READ_ACCESS_US   250     ///< 读命令到第一个数据块
+#define SD_SIM_WRITE_CMD_US     1500    ///< 每条写命令的编程开销
+#define SD_SIM_WRITE_BLOCK_US   40      ///< 每个块的编程时间（约 12MB/s）
+#define SD_SIM_POWER_UP_MS      30      ///< ACMD41 返回忙的时长
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t commands;          ///< 收到的命令（含 CMD55）
+    uint32_t single_reads;      ///< CMD17
+    uint32_t multi_reads;       ///< CMD18
+    uint32_t single_writes;     ///< CMD24
+    uint32_t multi_writes;      ///< CMD25
+    uint32_t stops;             ///< CMD12
+    uint32_t status_polls;      ///< CMD13
+    uint32_t blocks_read;
+    uint32_t blocks_written;
+    uint32_t illegal_cmds;      ///< 当前状态下非法的命令
+    uint32_t clock_violations;  ///< 时钟超出当前模式的上限
+    uint32_t width_violations;  ///< 主机与卡位宽不一致时传输数据
+    uint32_t data_violations;   ///< 数据通道使能顺序错误
+    uint32_t addr_errors;       ///< 地址未对齐或越界
+    uint32_t crc_injected;      ///< 注入的数据 CRC 错误
+    uint32_t max_clock_hz;      ///< 数据传输时用过的最高时钟
+    uint8_t  bus_width;         ///< 卡当前位宽
+    uint64_t bus_us;            ///< 命令和数据占用总线的时间
+    uint64_t busy_us;           ///< 卡内编程时间
+} SD_Sim_Stats;
+
+int  SD_Sim_Insert(SD_Sim_CardType type, uint32_t sectors);
+void SD_Sim_Eject(void);
+uint8_t *SD_Sim_Memory(void);
+void SD_Sim_FailNextData(void);
+void SD_Sim_SetTrace(int on);
+void SD_Sim_GetStats(SD_Sim_Stats *stats);
+void SD_Sim_ResetStats(void);
+uint32_t SD_Sim_Violations(void);
+
+#endif
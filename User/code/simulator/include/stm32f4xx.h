@@ -0,0 +1,35 @@
+/**
+ * @file stm32f4xx.h
+ * @brief 主机模拟构建用的 stm32f4xx.h 替身
+ * @details 只提供应用层头文件用到的基本类型，使 spi.h、alarm_all.h
+ *          等可以在 Linux 上编译。真实固件构建不会使用本文件。
+ */
+
+#ifndef STM32F4XX_SIM_H
+#define STM32F4XX_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+#define __IO volatile
+
+typedef struct {
+    uint8_t RTC_Hours;
+    uint8_t RTC_Minutes;
+    uint8_t RTC_Seconds;
+    uint8_t RTC_H12;
+} RTC_TimeTypeDef;
+
+typedef struct {
+    uint8_t RTC_WeekDay;
+    uint8_t RTC_Month;
+    uint8_t RTC_Date;
+    uint8_t RTC_Year;
+} RTC_DateTypeDef;
+
+#endif
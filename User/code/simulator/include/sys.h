@@ -0,0 +1,11 @@
+/**
+ * @file sys.h
+ * @brief 主机模拟构建用的 sys.h 替身（无引脚定义与位带操作）
+ */
+
+#ifndef _HARDWARE_DEF_H_
+#define _HARDWARE_DEF_H_
+
+#include "stm32f4xx.h"
+
+#endif
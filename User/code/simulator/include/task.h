@@ -0,0 +1,40 @@
+/**
+ * @file task.h
+ * @brief 主机模拟构建用的 FreeRTOS task.h 替身（调度器不运行，见 FreeRTOS.h）
+ */
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define taskSCHEDULER_SUSPENDED     ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED   ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING       ((BaseType_t)2)
+
+static inline BaseType_t xTaskGetSchedulerState(void) { return taskSCHEDULER_NOT_STARTED; }
+static inline TaskHandle_t xTaskGetCurrentTaskHandle(void) { return NULL; }
+
+// 节拍取模拟时钟（w25q128_sim.c，1ms/节拍），Flash 操作耗时会推进它
+uint32_t get_systick(void);
+static inline TickType_t xTaskGetTickCount(void) { return (TickType_t)get_systick(); }
+
+static inline BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint16_t stack,
+                                     void *param, UBaseType_t prio, TaskHandle_t *handle)
+{
+    (void)fn; (void)name; (void)stack; (void)param; (void)prio;
+    if (handle != NULL) {
+        *handle = NULL;
+    }
+    return pdFAIL;
+}
+
+static inline void vTaskStartScheduler(void) { }
+static inline void vTaskDelay(TickType_t ticks) { (void)ticks; }
+static inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout) { (void)clear; (void)timeout; return 0; }
+static inline BaseType_t xTaskNotifyGive(TaskHandle_t task) { (void)task; return pdPASS; }
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * @file telem_decode.h
+ * @brief 遥测数据流主机端接收（分帧、校验、按描述帧解析样本）
+ * @details 与固件的 telemetry.h 配套。串口数据按 0x00 切分成段，COBS 解码成功、长度与帧头一致
+ *          且 CRC-32 正确的段是遥测帧，其余（printf 文本、二进制日志记录）原样交给 other 回调：
+ *          遥测帧前导的 0x00 被去掉，其它 0x00 保留，因此 other 收到的字节流与没有遥测时完全相同，
+ *          可以继续交给 BinlogDecoder 解码。
+ *
+ *          通道 0 的描述帧登记通道的名字、格式串和字段名，之后该通道的样本按格式串解析成数值；
+ *          收到描述帧之前的数据帧只计数（unknown），不输出。序号不连续时累计丢帧数。
+ */
+
+#ifndef TELEM_DECODE_H
+#define TELEM_DECODE_H
+
+#include "telemetry.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define TELEM_RX_MAX_FIELDS     16
+
+/**
+ * @brief 接收端的通道（来自描述帧）
+ */
+typedef struct {
+    uint8_t  known;
+    uint8_t  id;
+    uint8_t  size;
+    uint8_t  batch;
+    uint16_t period_ms;
+    char     name[32];
+    char     fmt[TELEM_RX_MAX_FIELDS + 1];
+    char     names[128];                        ///< 字段名，field 指向这里
+    const char *field[TELEM_RX_MAX_FIELDS];
+    uint32_t nfields;
+
+    uint8_t  have_seq;
+    uint8_t  next_seq;
+    uint32_t frames;
+    uint32_t samples;
+    uint32_t lost;                              ///< 按序号推算的丢帧数
+} TelemRxChannel;
+
+/**
+ * @brief 解析出的一个样本
+ */
+typedef struct {
+    uint32_t       t_ms;                        ///< 按帧内首末时间插值
+    const uint8_t *raw;                         ///< size 字节原始数据
+    double         value[TELEM_RX_MAX_FIELDS];
+} TelemRxSample;
+
+typedef struct {
+    void (*schema)(void *ctx, const TelemRxChannel *ch);
+    void (*sample)(void *ctx, const TelemRxChannel *ch, const TelemRxSample *s);
+    void (*other)(void *ctx, const uint8_t *data, size_t len);     ///< 非遥测字节
+    void *ctx;
+    /// 可选：每个通过校验的数据帧的原始内容（未收到描述帧的通道也调用，ch->known 为 0），
+    /// 用于内容不是固定格式样本的通道（OLED 镜像的显存段，见 oled_mirror.h）
+    void (*frame)(void *ctx, const TelemRxChannel *ch, uint8_t seq, uint32_t t_ms,
+                  const uint8_t *payload, uint32_t len);
+} TelemRxSink;
+
+/**
+ * @brief 接收统计
+ */
+typedef struct {
+    uint32_t frames;            ///< 通过校验的数据帧
+    uint32_t schemas;           ///< 描述帧
+    uint32_t samples;
+    uint32_t lost;              ///< 所有通道的丢帧数
+    uint32_t unknown;           ///< 未收到描述帧的通道的数据帧
+    uint32_t bad_frames;        ///< 校验通过但内容不合法（长度与样本大小不符等）
+    uint32_t other_bytes;       ///< 交给 other 的字节数
+} TelemRx_Stats;
+
+typedef struct {
+    TelemRxChannel ch[256];
+    TelemRxSink    sink;
+    uint8_t        seg[TELEM_WIRE_MAX];
+    uint32_t       seglen;
+    uint8_t        overflow;    ///< 当前段已超过最大帧长，直接交给 other
+    uint8_t        zero;        ///< 上一段的结束符 0x00 尚未交给 other（可能是下一帧的前导）
+    TelemRx_Stats  stats;
+} TelemReceiver;
+
+void TelemRx_Init(TelemReceiver *rx, const TelemRxSink *sink);
+void TelemRx_Feed(TelemReceiver *rx, const uint8_t *data, size_t len);
+void TelemRx_Flush(TelemReceiver *rx);
+
+#endif
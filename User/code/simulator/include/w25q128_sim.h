@@ -0,0 +1,86 @@
+/**
+ * @file w25q128_sim.h
+ * @brief W25Q128 主机端模拟器（文件映像 + 时序模型）
+ * @details 在 Linux 上实现 spi.h 中的 SPI1_* 与 W25Q128_* 接口，
+ *          以 16MB 映像文件作为存储介质，并遵守 NOR Flash 语义：
+ *          - 编程只能把 1 写成 0（新值 = 旧值 & 数据）
+ *          - 擦除最小单位为 4KB 扇区（地址低 12 位被忽略）
+ *          - 页编程在 256 字节页内回绕
+ *          擦除/编程/读取耗时取自 W25Q128JV 数据手册，
+ *          累加到模拟时钟上，get_systick() 返回模拟毫秒数。
+ */
+
+#ifndef W25Q128_SIM_H
+#define W25Q128_SIM_H
+
+#include <stdint.h>
+
+// =============================================================================
+// 时序参数（W25Q128JV 数据手册 9.6 节 AC 特性，典型值）
+// =============================================================================
+#define W25Q128_SIM_T_PP_US         400       ///< tPP 页编程 0.4ms（最大 3ms）
+#define W25Q128_SIM_T_SE_US         45000     ///< tSE 4KB 扇区擦除 45ms（最大 400ms）
+#define W25Q128_SIM_T_BE1_US        120000    ///< tBE1 32KB 块擦除 120ms（最大 1.6s）
+#define W25Q128_SIM_T_BE2_US        150000    ///< tBE2 64KB 块擦除 150ms（最大 2s）
+#define W25Q128_SIM_T_CE_US         40000000  ///< tCE 整片擦除 40s（最大 200s）
+#define W25Q128_SIM_SPI_KHZ         21000     ///< SPI1 时钟：84MHz / 4（见 SPI1_Init）
+
+/**
+ * @brief 时序模型参数
+ */
+typedef struct {
+    uint32_t page_program_us;   ///< 页编程时间
+    uint32_t sector_erase_us;   ///< 4KB 扇区擦除时间
+    uint32_t block32_erase_us;  ///< 32KB 块擦除时间
+    uint32_t block64_erase_us;  ///< 64KB 块擦除时间
+    uint32_t chip_erase_us;     ///< 整片擦除时间
+    uint32_t spi_clock_khz;     ///< SPI 时钟，决定每字节传输时间
+} W25Q128_Sim_Timing;
+
+/**
+ * @brief 模拟器统计信息
+ */
+typedef struct {
+    uint64_t bytes_read;          ///< 读出字节数
+    uint64_t bytes_programmed;    ///< 编程字节数
+    uint32_t read_cmds;           ///< 读命令次数
+    uint32_t page_programs;       ///< 页编程次数
+    uint32_t sector_erases;       ///< 4KB 扇区擦除次数
+    uint32_t block_erases;        ///< 32/64KB 块擦除次数
+    uint32_t chip_erases;         ///< 整片擦除次数
+    uint32_t program_violations;  ///< 试图把 0 编程为 1 的次数（驱动漏擦除）
+    uint32_t wel_violations;      ///< 未写使能就编程/擦除（芯片忽略该命令）
+    uint32_t busy_violations;     ///< 芯片忙时发出命令
+    uint64_t busy_us;             ///< 芯片处于忙状态的累计时间
+} W25Q128_Sim_Stats;
+
+// 映像管理
+int  W25Q128_Sim_Open(const char *image_path);
+void W25Q128_Sim_Flush(void);
+void W25Q128_Sim_Close(void);
+uint8_t *W25Q128_Sim_Memory(void);
+
+// 掉电注入（崩溃一致性测试）
+void W25Q128_Sim_FailAfter(uint32_t ops);
+uint8_t W25Q128_Sim_PowerLost(void);
+void W25Q128_Sim_PowerCycle(void);
+
+// 片选（spi.h 中 SPI_NSS_L/SPI_NSS_H 在模拟模式下映射到这里）
+void W25Q128_Sim_CS(int level);
+
+// 模拟时钟
+uint64_t W25Q128_Sim_Time_us(void);
+void W25Q128_Sim_Advance_us(uint64_t us);
+
+// 时序与统计
+void W25Q128_Sim_SetTiming(const W25Q128_Sim_Timing *timing);
+void W25Q128_Sim_GetTiming(W25Q128_Sim_Timing *timing);
+void W25Q128_Sim_GetStats(W25Q128_Sim_Stats *stats);
+void W25Q128_Sim_ResetStats(void);
+uint32_t W25Q128_Sim_EraseCount(uint32_t sector_index);
+void W25Q128_Sim_PrintStats(const char *label);
+
+// 模拟系统节拍（毫秒），替代 delay.c 中的实现
+uint32_t get_systick(void);
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * @file xfer_client.h
+ * @brief 串口批量传输的上位机端（协议见 code/xfer.h）
+ * @details 发 OPEN（偏移为续传起点），收到 INFO 后按偏移写入 DATA：
+ *          按序的块写入后回 ACK（下一个期望的字节），不按序或重复的块丢弃并重复上一个 ACK，
+ *          设备据此从已确认处重发。XFER_RTO_MS 没有收到任何帧时重发 OPEN（尚未收到 INFO）或 ACK。
+ *          全部收到后状态为 DONE，之后仍回应设备超时重发的块（最后一个 ACK 丢失时设备才能结束会话）。
+ *          帧之外的字节（设备其它任务的 printf）交给 text 回调。
+ *          xfer_get（真实串口）和 xfer_bench（模拟链路）共用本模块。
+ */
+
+#ifndef XFER_CLIENT_H
+#define XFER_CLIENT_H
+
+#include "xfer.h"
+#include <stdint.h>
+
+// 状态
+#define XFER_CLIENT_OPENING     0
+#define XFER_CLIENT_RECEIVING   1
+#define XFER_CLIENT_DONE        2
+#define XFER_CLIENT_FAILED      3
+
+typedef void (*XferSend)(void *ctx, const uint8_t *frame, uint32_t len);
+typedef int  (*XferWrite)(void *ctx, uint32_t offset, const uint8_t *data, uint32_t len);    ///< 0-成功
+
+/**
+ * @brief 上位机端统计
+ */
+typedef struct {
+    uint32_t frames;        ///< 收到的 DATA 帧
+    uint32_t duplicate;     ///< 已收到过的块（设备重发）
+    uint32_t out_of_order;  ///< 前面有块丢失而丢弃的块
+    uint32_t acks;          ///< 发出的 ACK
+    uint32_t opens;         ///< 发出的 OPEN
+    uint32_t idle_acks;     ///< 长时间没有数据时重发的 ACK
+} XferClient_Stats;
+
+typedef struct {
+    const char      *name;
+    uint16_t         xid;
+    XferSend         send;
+    XferWrite        write;
+    XferTextHandler  text;
+    void            *ctx;
+
+    XferParser       parser;
+    uint8_t          rx_buf[XFER_FRAME_MAX];
+    uint8_t          state;
+    int              error;         ///< FAILED 时的 XFER_ERR_*
+    uint32_t         size;          ///< INFO 给出的总大小
+    uint32_t         expected;      ///< 下一个期望的字节（续传时从起点开始）
+    uint16_t         chunk;         ///< INFO 给出的块大小
+    uint8_t          window;        ///< INFO 给出的窗口
+    uint32_t         now;
+    uint32_t         last_rx;
+    XferClient_Stats stats;
+} XferClient;
+
+void XferClient_Init(XferClient *c, const char *name, uint32_t start, uint16_t xid, XferSend send, XferWrite write,
+                     XferTextHandler text, void *ctx, uint32_t now_ms);
+void XferClient_Input(XferClient *c, const uint8_t *data, uint32_t len, uint32_t now_ms);
+int XferClient_Poll(XferClient *c, uint32_t now_ms);
+void XferClient_Close(XferClient *c);
+
+#endif
@@ -0,0 +1,505 @@
+/**
+ * @file binlog_decode.c
+ * @brief 二进制日志主机端解码实现（见 binlog_decode.h）
+ */
+
+#include "binlog_decode.h"
+#include <elf.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REC_SYNC        0xF8
+#define REC_HEADER      7
+
+// =============================================================================
+// 字符串表
+// =============================================================================
+
+static int entry_cmp(const void *a, const void *b)
+{
+    const BinlogEntry *x = a, *y = b;
+
+    return x->id < y->id ? -1 : x->id > y->id;
+}
+
+// 解析 "级别|模块|格式串"，格式不对的字符串跳过
+static int table_add(BinlogTable *t, uint32_t *cap, uint32_t id, const char *s)
+{
+    const char *bar1, *bar2;
+    BinlogEntry *e;
+
+    if (s[0] == '\0' || s[1] != '|' || (bar1 = s + 1, (bar2 = strchr(bar1 + 1, '|')) == NULL)) {
+        return 0;
+    }
+    if (t->count == *cap) {
+        *cap = *cap ? *cap * 2 : 64;
+        t->entries = realloc(t->entries, *cap * sizeof(BinlogEntry));
+    }
+    e = &t->entries[t->count++];
+    e->id = id;
+    e->level = s[0];
+    e->module = strndup(bar1 + 1, (size_t)(bar2 - bar1 - 1));
+    e->fmt = strdup(bar2 + 1);
+    e->nargs = (uint8_t)Binlog_CountArgs(e->fmt);
+    return 1;
+}
+
+// 段内容：以 NUL 结尾的字符串首尾相接，编号是偏移
+static void table_parse(BinlogTable *t, const uint8_t *data, size_t len)
+{
+    uint32_t cap = 0;
+    size_t off = 0;
+
+    while (off < len) {
+        const uint8_t *nul = memchr(data + off, 0, len - off);
+        size_t n = nul ? (size_t)(nul - (data + off)) : len - off;
+        char *s = strndup((const char *)data + off, n);
+
+        table_add(t, &cap, (uint32_t)off, s);
+        free(s);
+        off += n + 1;
+    }
+    qsort(t->entries, t->count, sizeof(BinlogEntry), entry_cmp);
+}
+
+// 32/64 位 ELF 的段头统一成一种结构（只支持小端：ARM Cortex-M 和 x86 主机）
+typedef struct {
+    uint32_t name, type, link;
+    uint64_t addr, offset, size, entsize;
+} Shdr;
+
+static int read_shdr(const uint8_t *img, size_t size, int is64, uint32_t i, Shdr *sh)
+{
+    if (is64) {
+        const Elf64_Ehdr *eh = (const Elf64_Ehdr *)img;
+        const Elf64_Shdr *s;
+
+        if (eh->e_shoff + (uint64_t)(i + 1) * sizeof(Elf64_Shdr) > size) {
+            return -1;
+        }
+        s = (const Elf64_Shdr *)(img + eh->e_shoff) + i;
+        sh->name = s->sh_name; sh->type = s->sh_type; sh->link = s->sh_link;
+        sh->addr = s->sh_addr; sh->offset = s->sh_offset; sh->size = s->sh_size; sh->entsize = s->sh_entsize;
+    } else {
+        const Elf32_Ehdr *eh = (const Elf32_Ehdr *)img;
+        const Elf32_Shdr *s;
+
+        if (eh->e_shoff + (uint64_t)(i + 1) * sizeof(Elf32_Shdr) > size) {
+            return -1;
+        }
+        s = (const Elf32_Shdr *)(img + eh->e_shoff) + i;
+        sh->name = s->sh_name; sh->type = s->sh_type; sh->link = s->sh_link;
+        sh->addr = s->sh_addr; sh->offset = s->sh_offset; sh->size = s->sh_size; sh->entsize = s->sh_entsize;
+    }
+    if (sh->type != SHT_NOBITS && sh->offset + sh->size > size) {
+        return -1;
+    }
+    return 0;
+}
+
+// 在符号表中找符号地址，找到返回 0
+static int find_symbol(const uint8_t *img, size_t size, int is64, uint32_t shnum, const char *name, uint64_t *value)
+{
+    for (uint32_t i = 0; i < shnum; i++) {
+        Shdr sym, str;
+
+        if (read_shdr(img, size, is64, i, &sym) != 0 || sym.type != SHT_SYMTAB ||
+            read_shdr(img, size, is64, sym.link, &str) != 0) {
+            continue;
+        }
+        for (uint64_t off = 0; off + (is64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym)) <= sym.size;
+             off += is64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym)) {
+            uint32_t n;
+            uint64_t v;
+            uint16_t shndx;
+
+            if (is64) {
+                const Elf64_Sym *s = (const Elf64_Sym *)(img + sym.offset + off);
+                n = s->st_name; v = s->st_value; shndx = s->st_shndx;
+            } else {
+                const Elf32_Sym *s = (const Elf32_Sym *)(img + sym.offset + off);
+                n = s->st_name; v = s->st_value; shndx = s->st_shndx;
+            }
+            if (shndx != SHN_UNDEF && n < str.size &&
+                strncmp((const char *)img + str.offset + n, name, str.size - n) == 0) {
+                *value = v;
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 从固件映像取出 logstr 段生成字符串表
+ * @return 0-成功，-1-无法读取或不是小端 ELF，-2-映像中没有 logstr 段
+ */
+int BinlogTable_LoadElf(BinlogTable *table, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *img;
+    long size;
+    int is64, ret = -2;
+    uint32_t shnum, shstrndx;
+    uint64_t base, limit;
+    Shdr sh, names;
+
+    memset(table, 0, sizeof(*table));
+    if (f == NULL) {
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    img = malloc(size > 0 ? (size_t)size : 1);
+    if (size < (long)sizeof(Elf32_Ehdr) || fread(img, 1, (size_t)size, f) != (size_t)size ||
+        memcmp(img, ELFMAG, SELFMAG) != 0 || img[EI_DATA] != ELFDATA2LSB) {
+        fclose(f);
+        free(img);
+        return -1;
+    }
+    fclose(f);
+    is64 = img[EI_CLASS] == ELFCLASS64;
+    shnum = is64 ? ((Elf64_Ehdr *)img)->e_shnum : ((Elf32_Ehdr *)img)->e_shnum;
+    shstrndx = is64 ? ((Elf64_Ehdr *)img)->e_shstrndx : ((Elf32_Ehdr *)img)->e_shstrndx;
+
+    // 1. 链接器生成的段首/段尾符号，按地址找到所在的段换算成文件偏移
+    if ((find_symbol(img, (size_t)size, is64, shnum, "__start_logstr", &base) == 0 &&
+         find_symbol(img, (size_t)size, is64, shnum, "__stop_logstr", &limit) == 0) ||
+        (find_symbol(img, (size_t)size, is64, shnum, "logstr$$Base", &base) == 0 &&
+         find_symbol(img, (size_t)size, is64, shnum, "logstr$$Limit", &limit) == 0)) {
+        for (uint32_t i = 0; i < shnum && ret != 0; i++) {
+            if (read_shdr(img, (size_t)size, is64, i, &sh) == 0 && sh.type == SHT_PROGBITS &&
+                sh.addr <= base && limit <= sh.addr + sh.size && base <= limit) {
+                table_parse(table, img + sh.offset + (base - sh.addr), (size_t)(limit - base));
+                ret = 0;
+            }
+        }
+    }
+    // 2. 没有符号表：按段名查找
+    if (ret != 0 && read_shdr(img, (size_t)size, is64, shstrndx, &names) == 0) {
+        for (uint32_t i = 0; i < shnum && ret != 0; i++) {
+            if (read_shdr(img, (size_t)size, is64, i, &sh) == 0 && sh.type == SHT_PROGBITS &&
+                sh.name < names.size && strcmp((const char *)img + names.offset + sh.name, "logstr") == 0) {
+                table_parse(table, img + sh.offset, (size_t)sh.size);
+                ret = 0;
+            }
+        }
+    }
+    free(img);
+    return ret;
+}
+
+// 字符串表文件中格式串的 \ 和控制字符转义，保证一行一项
+static void put_escaped(FILE *f, const char *s)
+{
+    for (; *s; s++) {
+        switch (*s) {
+        case '\\': fputs("\\\\", f); break;
+        case '\n': fputs("\\n", f); break;
+        case '\r': fputs("\\r", f); break;
+        case '\t': fputs("\\t", f); break;
+        default:   fputc(*s, f); break;
+        }
+    }
+}
+
+/**
+ * @return 0-成功，-1-无法写入
+ */
+int BinlogTable_Save(const BinlogTable *table, const char *path)
+{
+    FILE *f = fopen(path, "w");
+
+    if (f == NULL) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < table->count; i++) {
+        const BinlogEntry *e = &table->entries[i];
+
+        fprintf(f, "%u\t%c|%s|", (unsigned)e->id, e->level, e->module);
+        put_escaped(f, e->fmt);
+        fputc('\n', f);
+    }
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+/**
+ * @return 0-成功，-1-无法读取
+ */
+int BinlogTable_Load(BinlogTable *table, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[1024];
+    uint32_t cap = 0;
+
+    memset(table, 0, sizeof(*table));
+    if (f == NULL) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char *tab = strchr(line, '\t');
+        char *r, *w;
+
+        if (tab == NULL || !isdigit((unsigned char)line[0])) {
+            continue;
+        }
+        for (r = w = tab + 1; *r != '\0' && *r != '\n'; r++) {
+            if (*r == '\\' && r[1] != '\0') {
+                r++;
+                *w++ = *r == 'n' ? '\n' : *r == 'r' ? '\r' : *r == 't' ? '\t' : *r;
+            } else {
+                *w++ = *r;
+            }
+        }
+        *w = '\0';
+        table_add(table, &cap, (uint32_t)strtoul(line, NULL, 10), tab + 1);
+    }
+    fclose(f);
+    qsort(table->entries, table->count, sizeof(BinlogEntry), entry_cmp);
+    return 0;
+}
+
+void BinlogTable_Free(BinlogTable *table)
+{
+    for (uint32_t i = 0; i < table->count; i++) {
+        free(table->entries[i].module);
+        free(table->entries[i].fmt);
+    }
+    free(table->entries);
+    memset(table, 0, sizeof(*table));
+}
+
+const BinlogEntry *BinlogTable_Find(const BinlogTable *table, uint32_t id)
+{
+    BinlogEntry key;
+
+    key.id = id;
+    return table->count ? bsearch(&key, table->entries, table->count, sizeof(BinlogEntry), entry_cmp) : NULL;
+}
+
+// =============================================================================
+// 格式化
+// =============================================================================
+
+// 解析一个转换说明（p 指向 % 之后），spec 得到去掉长度修饰的 printf 说明，返回说明之后的位置
+static const char *parse_spec(const char *p, char *spec, char *conv)
+{
+    size_t n = 0;
+
+    spec[n++] = '%';
+    while (*p != '\0' && strchr("-+ #0", *p) != NULL) {
+        if (n < 16) spec[n++] = *p;
+        p++;
+    }
+    while (isdigit((unsigned char)*p) || *p == '.') {
+        if (n < 24) spec[n++] = *p;
+        p++;
+    }
+    while (*p == 'l' || *p == 'h' || *p == 'z' || *p == 'j' || *p == 't') {
+        p++;            // 参数在目标板上都是 32 位
+    }
+    spec[n] = '\0';
+    *conv = *p;
+    return *p != '\0' ? p + 1 : p;
+}
+
+/**
+ * @brief 格式串需要的参数个数（%% 不算）
+ */
+uint32_t Binlog_CountArgs(const char *fmt)
+{
+    uint32_t n = 0;
+    char spec[32], conv;
+
+    while ((fmt = strchr(fmt, '%')) != NULL) {
+        if (fmt[1] == '%') {
+            fmt += 2;
+            continue;
+        }
+        fmt = parse_spec(fmt + 1, spec, &conv);
+        if (conv != '\0') {
+            n++;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief 用 32 位原始参数格式化一条记录
+ * @return 输出长度
+ */
+int Binlog_Format(const char *fmt, const uint32_t *args, uint32_t nargs, char *out, size_t size)
+{
+    size_t n = 0;
+    uint32_t a = 0;
+
+    while (*fmt != '\0' && n + 1 < size) {
+        char spec[32], conv;
+        size_t sl;
+        uint32_t v;
+        int w;
+
+        if (*fmt != '%') {
+            out[n++] = *fmt++;
+            continue;
+        }
+        if (fmt[1] == '%') {
+            out[n++] = '%';
+            fmt += 2;
+            continue;
+        }
+        fmt = parse_spec(fmt + 1, spec, &conv);
+        if (conv == '\0') {
+            break;
+        }
+        if (a >= nargs) {
+            w = snprintf(out + n, size - n, "<?>");
+        } else {
+            v = args[a];
+            sl = strlen(spec);
+            spec[sl] = conv;
+            spec[sl + 1] = '\0';
+            switch (conv) {
+            case 'd': case 'i':
+                w = snprintf(out + n, size - n, spec, (int32_t)v);
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                w = snprintf(out + n, size - n, spec, (unsigned)v);
+                break;
+            case 'c':
+                w = snprintf(out + n, size - n, spec, (int)v);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                float x;
+
+                memcpy(&x, &v, sizeof(x));
+                w = snprintf(out + n, size - n, spec, (double)x);
+                break;
+            }
+            default:
+                w = snprintf(out + n, size - n, "<%%%c?>", conv);
+                break;
+            }
+        }
+        a++;
+        if (w > 0) {
+            n += (size_t)w < size - n ? (size_t)w : size - n - 1;
+        }
+    }
+    out[n] = '\0';
+    return (int)n;
+}
+
+// =============================================================================
+// 流解码
+// =============================================================================
+
+void BinlogDecode_Init(BinlogDecoder *dec, const BinlogTable *table, const BinlogSink *sink)
+{
+    memset(dec, 0, sizeof(*dec));
+    dec->table = table;
+    dec->sink = *sink;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void drop(BinlogDecoder *dec, uint32_t n)
+{
+    memmove(dec->pend, dec->pend + n, dec->pn - n);
+    dec->pn -= n;
+}
+
+// 处理 pend 中的数据；flush 时不完整的记录也丢弃
+static void process(BinlogDecoder *dec, int flush)
+{
+    while (dec->pn > 0) {
+        uint32_t n = 0, need;
+        const BinlogEntry *e;
+
+        if (dec->pend[0] < REC_SYNC) {
+            while (n < dec->pn && dec->pend[n] < REC_SYNC) {
+                n++;
+            }
+            if (dec->sink.text != NULL) {
+                dec->sink.text(dec->sink.ctx, dec->pend, n);
+            }
+            dec->stats.text_bytes += n;
+            drop(dec, n);
+            continue;
+        }
+        need = REC_HEADER + 4 * (dec->pend[0] & 7u);
+        if (dec->pn < need) {
+            if (!flush) {
+                return;
+            }
+            dec->stats.skipped++;
+            drop(dec, 1);
+            continue;
+        }
+        e = BinlogTable_Find(dec->table, dec->pend[1] | ((uint32_t)dec->pend[2] << 8));
+        if (e == NULL || e->nargs != (dec->pend[0] & 7u)) {
+            // 传输错误或不是这一版映像的记录：丢一个字节，在后面找下一条
+            dec->stats.unknown_ids += e == NULL;
+            dec->stats.skipped++;
+            drop(dec, 1);
+            continue;
+        }
+        {
+            BinlogRecord rec;
+
+            rec.entry = e;
+            rec.timestamp = get32(&dec->pend[3]);
+            rec.nargs = e->nargs;
+            for (uint32_t i = 0; i < rec.nargs; i++) {
+                rec.args[i] = get32(&dec->pend[REC_HEADER + 4 * i]);
+            }
+            Binlog_Format(e->fmt, rec.args, rec.nargs, rec.message, sizeof(rec.message));
+            if (dec->sink.record != NULL) {
+                dec->sink.record(dec->sink.ctx, &rec);
+            }
+            dec->stats.records++;
+        }
+        drop(dec, need);
+    }
+}
+
+/**
+ * @brief 输入抓到的串口数据，可以任意分块
+ */
+void BinlogDecode_Feed(BinlogDecoder *dec, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        size_t n = sizeof(dec->pend) - dec->pn;
+
+        if (n > len) {
+            n = len;
+        }
+        memcpy(dec->pend + dec->pn, data, n);
+        dec->pn += (uint32_t)n;
+        data += n;
+        len -= n;
+        process(dec, 0);
+    }
+}
+
+/**
+ * @brief 输入结束：末尾不完整的记录按重新同步丢弃
+ */
+void BinlogDecode_Flush(BinlogDecoder *dec)
+{
+    process(dec, 1);
+}
+
+/**
+ * @brief 打印一条记录："[   12.345] I step: 格式化后的文本"
+ */
+void BinlogRecord_Print(FILE *out, const BinlogRecord *rec)
+{
+    fprintf(out, "[%5u.%03u] %c %s: %s\n", (unsigned)(rec->timestamp / 1000), (unsigned)(rec->timestamp % 1000),
+            rec->entry->level, rec->entry->module, rec->message);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file oled_replay.c
+ * @brief OLED 镜像上位机端实现（见 oled_replay.h）
+ */
+
+#include "oled_replay.h"
+#include <string.h>
+
+void OledScreen_Init(OledScreen *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->stale = 1;               // 收齐第一个关键帧之前画面不完整
+}
+
+/**
+ * @brief 处理通道 "oled" 的一帧
+ * @return 记录数，-1 表示内容不合法（画面标记为过期）
+ */
+int OledScreen_Frame(OledScreen *s, uint8_t seq, uint32_t t_ms, const uint8_t *data, uint32_t len)
+{
+    uint8_t before[OLED_MIRROR_GRAM_SIZE];
+    int records;
+
+    if (s->have_seq && seq != s->next_seq) {
+        s->stats.lost += (uint8_t)(seq - s->next_seq);
+        s->stale = 1;
+        s->key_pages = 0;
+    }
+    if (s->stats.frames == 0) {
+        s->stats.t_first = t_ms;
+    }
+    s->have_seq = 1;
+    s->next_seq = (uint8_t)(seq + 1);
+    s->stats.frames++;
+    s->stats.bytes += len;
+    s->stats.t_last = t_ms;
+
+    memcpy(before, s->gram, sizeof(before));
+    records = OledMirror_Apply(s->gram, data, len, &s->key_pages);
+    for (uint32_t i = 0; i < OLED_MIRROR_GRAM_SIZE; i++) {
+        if (s->gram[i] != before[i]) {
+            s->heat[i % OLED_MIRROR_STRIDE][i / OLED_MIRROR_STRIDE]++;
+            s->stats.changed++;
+        }
+    }
+    if (records < 0) {
+        s->stats.bad++;
+        s->stale = 1;
+        s->key_pages = 0;
+        return -1;
+    }
+    s->stats.records += (uint32_t)records;
+    if (s->key_pages == OLED_MIRROR_ALL_PAGES) {
+        s->key_pages = 0;
+        s->stale = 0;
+        s->stats.keyframes++;
+    }
+    return records;
+}
+
+/**
+ * @brief 像素 (x, y) 是否点亮（y 向下，与 OLED_DrawPoint 相同）
+ */
+int OledScreen_Pixel(const OledScreen *s, uint32_t x, uint32_t y)
+{
+    return (s->gram[x * OLED_MIRROR_STRIDE + y / 8] >> (y % 8)) & 1;
+}
+
+/**
+ * @brief 画面保存为 PBM（P4，128x64，点亮为黑）
+ */
+int OledScreen_WritePbm(const OledScreen *s, const char *path)
+{
+    FILE *f = fopen(path, "wb");
+
+    if (f == NULL) {
+        return -1;
+    }
+    fprintf(f, "P4\n%d %d\n", OLED_MIRROR_COLS, OLED_MIRROR_PAGES * 8);
+    for (uint32_t y = 0; y < OLED_MIRROR_PAGES * 8; y++) {
+        for (uint32_t x = 0; x < OLED_MIRROR_COLS; x += 8) {
+            uint8_t b = 0;
+
+            for (uint32_t k = 0; k < 8; k++) {
+                b = (uint8_t)(b << 1 | OledScreen_Pixel(s, x + k, y));
+            }
+            fputc(b, f);
+        }
+    }
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+int OledReplay_WriteHeader(FILE *f)
+{
+    return fwrite(OLED_REPLAY_MAGIC, 1, 8, f) == 8 ? 0 : -1;
+}
+
+int OledReplay_Write(FILE *f, uint32_t t_ms, uint8_t seq, const uint8_t *data, uint32_t len)
+{
+    uint8_t h[7] = { (uint8_t)t_ms, (uint8_t)(t_ms >> 8), (uint8_t)(t_ms >> 16), (uint8_t)(t_ms >> 24),
+                     seq, (uint8_t)len, (uint8_t)(len >> 8) };
+
+    if (fwrite(h, 1, sizeof(h), f) != sizeof(h) || fwrite(data, 1, len, f) != len) {
+        return -1;
+    }
+    return 0;
+}
+
+int OledReplay_ReadHeader(FILE *f)
+{
+    char magic[8];
+
+    return fread(magic, 1, 8, f) == 8 && memcmp(magic, OLED_REPLAY_MAGIC, 8) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief 读下一帧
+ * @return 帧长度，-1 表示文件结束，-2 表示文件损坏（截断或帧长超过 cap）
+ */
+int OledReplay_Read(FILE *f, uint32_t *t_ms, uint8_t *seq, uint8_t *data, uint32_t cap)
+{
+    uint8_t h[7];
+    size_t n = fread(h, 1, sizeof(h), f);
+    uint32_t len;
+
+    if (n == 0) {
+        return -1;
+    }
+    if (n != sizeof(h)) {
+        return -2;
+    }
+    *t_ms = h[0] | (uint32_t)h[1] << 8 | (uint32_t)h[2] << 16 | (uint32_t)h[3] << 24;
+    *seq = h[4];
+    len = h[5] | (uint32_t)h[6] << 8;
+    if (len > cap || fread(data, 1, len, f) != len) {
+        return -2;
+    }
+    return (int)len;
+}
@@ -0,0 +1,245 @@
+/**
+ * @file rfid_reader_sim.c
+ * @brief 串口 RFID 读卡模块的主机端替身（见 rfid_reader_sim.h）
+ */
+
+#include "rfid_reader_sim.h"
+#include <string.h>
+
+// =============================================================================
+// 线路
+// =============================================================================
+
+void RfidSimLine_Init(RfidSimLine *line, uint32_t baud)
+{
+    memset(line, 0, sizeof(*line));
+    line->byte_us = 10u * 1000000u / baud;
+}
+
+uint32_t RfidSimLine_Pending(const RfidSimLine *line)
+{
+    return line->head - line->tail;
+}
+
+/**
+ * @brief 放到线路上：空闲时第一个字节 now_us 开始发送，否则接在已有字节之后
+ * @return len，放不下时为 0
+ */
+uint32_t RfidSimLine_Put(RfidSimLine *line, uint32_t now_us, const uint8_t *data, uint32_t len)
+{
+    if (RFID_SIM_LINE_MAX - RfidSimLine_Pending(line) < len) {
+        return 0;
+    }
+    if (line->head == line->tail) {
+        line->next_us = now_us + line->byte_us;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        line->q[line->head++ % RFID_SIM_LINE_MAX] = data[i];
+    }
+    return len;
+}
+
+/**
+ * @brief 取出 now_us 之前已经到达的字节
+ */
+uint32_t RfidSimLine_Take(RfidSimLine *line, uint32_t now_us, uint8_t *buf, uint32_t cap)
+{
+    uint32_t n = 0;
+
+    while (n < cap && line->tail != line->head && (int32_t)(now_us - line->next_us) >= 0) {
+        buf[n++] = line->q[line->tail++ % RFID_SIM_LINE_MAX];
+        line->next_us += line->byte_us;
+    }
+    return n;
+}
+
+// =============================================================================
+// 读卡模块
+// =============================================================================
+
+static uint32_t sim_rnd(RfidReaderSim *sim)
+{
+    sim->rng = sim->rng * 1103515245u + 12345u;
+    return sim->rng >> 8;
+}
+
+static void sim_frame(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    RfidReaderSim *sim = (RfidReaderSim *)ctx;
+
+    sim->stats.commands++;
+    if (sim->cmd_head - sim->cmd_tail >= RFID_SIM_CMD_DEPTH) {
+        sim->stats.overflow++;
+        return;
+    }
+    memcpy(sim->cmd[sim->cmd_head++ % RFID_SIM_CMD_DEPTH], frame, len);
+}
+
+void RfidSim_Init(RfidReaderSim *sim, RfidSimLine *out, uint32_t process_us, uint32_t seed)
+{
+    memset(sim, 0, sizeof(*sim));
+    RfidParser_Init(&sim->parser, sim_frame, sim);
+    sim->out = out;
+    sim->process_us = process_us;
+    sim->rng = seed;
+}
+
+/**
+ * @brief 卡在 from_ms..to_ms（不含）期间在场内
+ * @return 0 成功，-1 表满
+ */
+int RfidSim_AddCard(RfidReaderSim *sim, uint32_t uid, uint32_t from_ms, uint32_t to_ms)
+{
+    if (sim->ncards >= RFID_SIM_CARDS_MAX) {
+        return -1;
+    }
+    sim->cards[sim->ncards].uid = uid;
+    sim->cards[sim->ncards].from_ms = from_ms;
+    sim->cards[sim->ncards].to_ms = to_ms;
+    sim->ncards++;
+    return 0;
+}
+
+/**
+ * @brief t_ms 时场内的卡
+ * @return UID，没有卡时为 0
+ */
+uint32_t RfidSim_CardAt(const RfidReaderSim *sim, uint32_t t_ms)
+{
+    for (uint32_t i = 0; i < sim->ncards; i++) {
+        if (t_ms >= sim->cards[i].from_ms && t_ms < sim->cards[i].to_ms) {
+            return sim->cards[i].uid;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 卡上一个块的内容（由 UID 和块号决定，检查读块应答用）
+ */
+void RfidSim_BlockData(uint32_t uid, uint8_t block, uint8_t *data)
+{
+    for (uint32_t i = 0; i < 16; i++) {
+        data[i] = (uint8_t)((uid >> (8 * (i % 4))) ^ (block * 17u) ^ i);
+    }
+}
+
+static void put_uid(uint8_t *p, uint32_t uid)
+{
+    p[0] = (uint8_t)uid;
+    p[1] = (uint8_t)(uid >> 8);
+    p[2] = (uint8_t)(uid >> 16);
+    p[3] = (uint8_t)(uid >> 24);
+}
+
+// 执行最早的一条命令，应答放到线路上（t_us 为处理完成的时间）
+static void sim_execute(RfidReaderSim *sim, const uint8_t *f, uint32_t t_us)
+{
+    uint8_t info[RFID_INFO_MAX], reply[RFID_FRAME_MAX];
+    uint32_t card = RfidSim_CardAt(sim, t_us / 1000), n = 0, len, k;
+    const uint8_t *arg = &f[4];
+    uint8_t argn = f[3];
+
+    info[0] = RFID_SIM_FAIL;
+    switch (f[2]) {
+    case RFID_CMD_REQUEST:
+        if (card != 0) {
+            info[0] = (uint8_t)RFID_ATQ_S50;
+            info[1] = (uint8_t)(RFID_ATQ_S50 >> 8);
+            n = 2;
+        }
+        break;
+    case RFID_CMD_ANTICOLL:
+        if (card != 0) {
+            put_uid(info, card);
+            n = 4;
+        }
+        break;
+    case RFID_CMD_SELECT:
+        if (card != 0 && argn >= 5 &&
+            ((uint32_t)arg[1] | ((uint32_t)arg[2] << 8) | ((uint32_t)arg[3] << 16) | ((uint32_t)arg[4] << 24)) == card) {
+            put_uid(info, card);
+            info[4] = RFID_SAK_S50;
+            n = 5;
+        }
+        break;
+    case RFID_CMD_READ:
+        if (card != 0 && argn >= 1) {
+            RfidSim_BlockData(card, arg[0], info);
+            n = 16;
+        }
+        break;
+    case RFID_CMD_HALT:
+    case RFID_CMD_AUTH:
+    case RFID_CMD_WRITE:
+        if (card != 0 || f[2] == RFID_CMD_HALT) {
+            info[0] = 0x00;
+        }
+        break;
+    default:
+        info[0] = RFID_SIM_UNKNOWN;
+        break;
+    }
+    if (n == 0) {
+        n = 1;
+    }
+    len = Rfid_Build(reply, f[1], f[2], info, n);
+
+    k = ++sim->stats.replies;
+    if (sim->drop_every != 0 && k % sim->drop_every == 0) {
+        sim->stats.dropped++;
+        return;
+    }
+    if (sim->noise_every != 0 && k % sim->noise_every == 0) {
+        uint8_t noise[4];
+        uint32_t nn = 1 + sim_rnd(sim) % sizeof(noise);
+
+        for (uint32_t i = 0; i < nn; i++) {
+            noise[i] = (uint8_t)sim_rnd(sim);
+        }
+        sim->stats.noise += RfidSimLine_Put(sim->out, t_us, noise, nn);
+    }
+    if (sim->corrupt_every != 0 && k % sim->corrupt_every == 0) {
+        reply[sim_rnd(sim) % len] ^= (uint8_t)(1u << (sim_rnd(sim) % 8));
+        sim->stats.corrupted++;
+    }
+    if (RfidSimLine_Put(sim->out, t_us, reply, len) == 0) {
+        sim->stats.dropped++;
+    }
+}
+
+/**
+ * @brief 推进到 now_us：处理完的命令发出应答，缓冲区中的下一条紧接着开始处理
+ */
+void RfidSim_Run(RfidReaderSim *sim, uint32_t now_us)
+{
+    sim->now_us = now_us;
+    while (1) {
+        uint32_t start = now_us;
+
+        if (sim->busy) {
+            if ((int32_t)(now_us - sim->done_us) < 0) {
+                return;
+            }
+            sim_execute(sim, sim->cmd[sim->cmd_tail % RFID_SIM_CMD_DEPTH], sim->done_us);
+            sim->cmd_tail++;
+            sim->busy = 0;
+            start = sim->done_us;
+        }
+        if (sim->cmd_head == sim->cmd_tail) {
+            return;
+        }
+        sim->busy = 1;
+        sim->done_us = start + sim->process_us;
+    }
+}
+
+/**
+ * @brief 线路上到达读卡模块的字节
+ */
+void RfidSim_Input(RfidReaderSim *sim, const uint8_t *data, uint32_t len, uint32_t now_us)
+{
+    RfidSim_Run(sim, now_us);
+    RfidParser_Feed(&sim->parser, data, len);
+    RfidSim_Run(sim, now_us);
+}
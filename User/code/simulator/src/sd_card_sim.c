@@ -0,0 +1,652 @@
+/**
+ * @file sd_card_sim.c
+ * @brief SD 卡命令协议模型，实现 sdio_sd.h 中的 SD_HW_* 接口（见 sd_card_sim.h）
+ */
+
+#include "sd_card_sim.h"
+#include "sdio_sd.h"
+#include "w25q128_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 卡状态（R1 bit12~9）
+enum {
+    ST_IDLE = 0, ST_READY, ST_IDENT, ST_STBY, ST_TRAN, ST_DATA, ST_RCV, ST_PRG, ST_DIS
+};
+
+static const char *const state_names[] = {
+    "idle", "ready", "ident", "stby", "tran", "data", "rcv", "prg", "dis"
+};
+
+#define R1_OUT_OF_RANGE     (1UL << 31)
+#define R1_ADDRESS_ERROR    (1UL << 30)
+#define R1_BLOCK_LEN_ERROR  (1UL << 29)
+#define R1_ILLEGAL_COMMAND  (1UL << 22)
+#define R1_READY_FOR_DATA   (1UL << 8)
+#define R1_APP_CMD          (1UL << 5)
+
+#define OCR_POWER_UP        (1UL << 31)
+#define OCR_CCS             (1UL << 30)
+#define OCR_VOLTAGE         0x00FF8000UL
+
+#define SIM_RCA             0xB368
+#define SIM_IDENT_MAX_HZ    400000
+#define SIM_XFER_MAX_HZ     25000000
+
+static struct {
+    uint8_t  inserted;
+    uint8_t  type;
+    uint8_t *mem;
+    uint32_t sectors;
+    uint32_t cid[4];
+    uint32_t csd[4];
+
+    uint8_t  state;
+    uint8_t  app_cmd;
+    uint8_t  cmd8_ok;           // 收到过有效的 CMD8
+    uint8_t  acmd41_started;
+    uint32_t acmd41_busy;       // ACMD41 返回忙的次数（跟踪输出只打印第一次）
+    uint8_t  width;
+    uint16_t rca;
+    uint32_t errors;            // 下一个 R1 要报告的错误位（读后清除）
+    uint64_t power_up_us;       // 第一次 ACMD41 的时间
+    uint64_t busy_until;
+
+    // 当前数据传输
+    uint8_t  multi;
+    uint32_t xfer_sector;
+    uint32_t xfer_blocks;       // 本次命令已传输的块数
+    uint8_t  read_past_end;
+
+    // 主机侧
+    uint32_t host_clock;
+    uint8_t  host_width;
+    uint8_t  armed;
+    uint8_t  arm_dir;
+    uint8_t *arm_buf;
+    uint32_t arm_blocks;
+
+    uint8_t  fail_next;
+    int      trace;
+    SD_Sim_Stats stats;
+} card;
+
+static void set_bits(uint32_t *reg, uint8_t msb, uint8_t lsb, uint32_t v)
+{
+    for (int b = lsb; b <= msb; b++, v >>= 1) {
+        uint32_t *w = &reg[3 - b / 32];
+        *w = (*w & ~(1UL << (b % 32))) | ((v & 1) << (b % 32));
+    }
+}
+
+static void build_registers(void)
+{
+    memset(card.cid, 0, sizeof(card.cid));
+    memset(card.csd, 0, sizeof(card.csd));
+
+    // CID：厂商 0x03，OEM "SD"，产品名 "SIM01"
+    set_bits(card.cid, 127, 120, 0x03);
+    set_bits(card.cid, 119, 104, ('S' << 8) | 'D');
+    set_bits(card.cid, 103, 64, 0x53494D30UL);
+    set_bits(card.cid, 71, 64, '1');
+    set_bits(card.cid, 0, 0, 1);
+
+    set_bits(card.csd, 119, 112, 0x0E);     // TAAC 1ms
+    set_bits(card.csd, 103, 96, 0x32);      // TRAN_SPEED 25MHz
+    set_bits(card.csd, 95, 84, 0x5B5);      // CCC
+    set_bits(card.csd, 83, 80, 9);          // READ_BL_LEN 512
+    set_bits(card.csd, 46, 46, 1);          // ERASE_BLK_EN
+    set_bits(card.csd, 25, 22, 9);          // WRITE_BL_LEN 512
+    set_bits(card.csd, 0, 0, 1);
+    if (card.type == SD_SIM_SDHC) {
+        set_bits(card.csd, 127, 126, 1);
+        set_bits(card.csd, 69, 48, card.sectors / 1024 - 1);
+        set_bits(card.csd, 45, 39, 0x7F);   // 擦除单元 64KB
+    } else {
+        set_bits(card.csd, 49, 47, 7);      // C_SIZE_MULT：每单元 512 个扇区
+        set_bits(card.csd, 73, 62, card.sectors / 512 - 1);
+        set_bits(card.csd, 45, 39, 0x1F);   // 擦除单元 16KB
+    }
+}
+
+static void power_on_reset(void)
+{
+    card.state = ST_IDLE;
+    card.app_cmd = 0;
+    card.cmd8_ok = 0;
+    card.acmd41_started = 0;
+    card.acmd41_busy = 0;
+    card.width = 1;
+    card.rca = 0;
+    card.errors = 0;
+    card.busy_until = 0;
+    card.armed = 0;
+}
+
+/**
+ * @brief 插入一张空白卡（SDHC 扇区数须为 1024 的倍数，SDSC 为 512 的倍数）
+ * @return 0 成功，-1 参数错误或内存不足
+ */
+int SD_Sim_Insert(SD_Sim_CardType type, uint32_t sectors)
+{
+    uint32_t unit = type == SD_SIM_SDHC ? 1024 : 512;
+
+    SD_Sim_Eject();
+    if (sectors == 0 || sectors % unit != 0 || (type != SD_SIM_SDHC && sectors / unit > 4096)) {
+        return -1;
+    }
+    card.mem = malloc((size_t)sectors * SD_BLOCK_SIZE);
+    if (card.mem == NULL) {
+        return -1;
+    }
+    memset(card.mem, 0xFF, (size_t)sectors * SD_BLOCK_SIZE);
+    card.inserted = 1;
+    card.type = (uint8_t)type;
+    card.sectors = sectors;
+    build_registers();
+    power_on_reset();
+    return 0;
+}
+
+void SD_Sim_Eject(void)
+{
+    free(card.mem);
+    card.mem = NULL;
+    card.inserted = 0;
+    card.sectors = 0;
+    power_on_reset();
+}
+
+uint8_t *SD_Sim_Memory(void)
+{
+    return card.mem;
+}
+
+/**
+ * @brief 下一次数据传输出现 CRC 错误（读：主机收到坏块；写：卡回 CRC 状态错误，数据丢弃）
+ */
+void SD_Sim_FailNextData(void)
+{
+    card.fail_next = 1;
+}
+
+/**
+ * @brief 打印每条命令和响应
+ */
+void SD_Sim_SetTrace(int on)
+{
+    card.trace = on;
+}
+
+void SD_Sim_GetStats(SD_Sim_Stats *stats)
+{
+    card.stats.bus_width = card.width;
+    *stats = card.stats;
+}
+
+void SD_Sim_ResetStats(void)
+{
+    memset(&card.stats, 0, sizeof(card.stats));
+}
+
+/**
+ * @brief 驱动时序违例总数（应为 0）
+ */
+uint32_t SD_Sim_Violations(void)
+{
+    return card.stats.illegal_cmds + card.stats.clock_violations + card.stats.width_violations +
+           card.stats.data_violations + card.stats.addr_errors;
+}
+
+// =============================================================================
+// 时序
+// =============================================================================
+
+static void bus_time(uint32_t clocks)
+{
+    uint64_t us = ((uint64_t)clocks * 1000000 + card.host_clock - 1) / card.host_clock;
+
+    card.stats.bus_us += us;
+    W25Q128_Sim_Advance_us(us);
+}
+
+static void update_busy(void)
+{
+    if (card.state == ST_PRG && W25Q128_Sim_Time_us() >= card.busy_until) {
+        card.state = ST_TRAN;
+    }
+}
+
+static void start_programming(uint32_t blocks)
+{
+    uint64_t busy = SD_SIM_WRITE_CMD_US + (uint64_t)blocks * SD_SIM_WRITE_BLOCK_US;
+
+    card.state = ST_PRG;
+    card.busy_until = W25Q128_Sim_Time_us() + busy;
+    card.stats.busy_us += busy;
+}
+
+// =============================================================================
+// 命令
+// =============================================================================
+
+static uint32_t r1_status(uint8_t state, uint8_t app)
+{
+    uint32_t r = card.errors | ((uint32_t)state << 9);
+
+    if (state == ST_TRAN) {
+        r |= R1_READY_FOR_DATA;
+    }
+    if (app) {
+        r |= R1_APP_CMD;
+    }
+    card.errors = 0;
+    return r;
+}
+
+/**
+ * @brief 检查读写命令的地址，返回起始扇区；错误时返回 UINT32_MAX 并置错误位
+ */
+static uint32_t data_address(uint32_t arg)
+{
+    uint32_t sector = arg;
+
+    if (card.type != SD_SIM_SDHC) {
+        if (arg % SD_BLOCK_SIZE != 0) {
+            card.errors |= R1_ADDRESS_ERROR;
+            card.stats.addr_errors++;
+            return UINT32_MAX;
+        }
+        sector = arg / SD_BLOCK_SIZE;
+    }
+    if (sector >= card.sectors) {
+        card.errors |= R1_OUT_OF_RANGE;
+        card.stats.addr_errors++;
+        return UINT32_MAX;
+    }
+    return sector;
+}
+
+/**
+ * @brief 卡对一条命令的处理
+ * @return 响应类型（SD_HW_RESP_*），-1 表示非法命令（不响应）
+ */
+static int card_command(uint8_t cmd, uint32_t arg, uint8_t app, uint32_t r[4])
+{
+    uint8_t state = card.state;
+    uint8_t addressed = (arg >> 16) == card.rca;
+    uint32_t sector;
+
+    if (app) {
+        switch (cmd) {
+        case 41:    // SD_SEND_OP_COND
+            if (state != ST_IDLE) {
+                return -1;
+            }
+            if (!card.acmd41_started) {
+                card.acmd41_started = 1;
+                card.power_up_us = W25Q128_Sim_Time_us();
+            }
+            r[0] = OCR_VOLTAGE;
+            // SDHC 卡必须先收到 CMD8 且主机声明 HCS，否则一直忙
+            if ((arg & OCR_VOLTAGE) != 0 &&
+                W25Q128_Sim_Time_us() - card.power_up_us >= SD_SIM_POWER_UP_MS * 1000ULL &&
+                (card.type != SD_SIM_SDHC || (card.cmd8_ok && (arg & OCR_CCS)))) {
+                r[0] |= OCR_POWER_UP | (card.type == SD_SIM_SDHC ? OCR_CCS : 0);
+                card.state = ST_READY;
+            } else {
+                card.acmd41_busy++;
+            }
+            return SD_HW_RESP_SHORT_NOCRC;
+        case 6:     // SET_BUS_WIDTH
+            if (state != ST_TRAN || (arg & 3) == 1 || (arg & 3) == 3) {
+                return -1;
+            }
+            card.width = (arg & 3) == 2 ? 4 : 1;
+            r[0] = r1_status(state, 1);
+            return SD_HW_RESP_SHORT;
+        case 23:    // SET_WR_BLK_ERASE_COUNT
+            if (state != ST_TRAN) {
+                return -1;
+            }
+            r[0] = r1_status(state, 1);
+            return SD_HW_RESP_SHORT;
+        default:
+            break;  // 其它 ACMD 按普通命令处理
+        }
+    }
+
+    switch (cmd) {
+    case 0:     // GO_IDLE_STATE
+        power_on_reset();
+        return SD_HW_RESP_NONE;
+
+    case 8:     // SEND_IF_COND
+        if (state != ST_IDLE || card.type == SD_SIM_SDSC_V1 || card.type == SD_SIM_MMC) {
+            return -1;
+        }
+        card.cmd8_ok = (arg & 0xF00) == 0x100;
+        r[0] = arg & 0xFFF;
+        return SD_HW_RESP_SHORT;
+
+    case 55:    // APP_CMD
+        if (card.type == SD_SIM_MMC || state == ST_READY || state == ST_IDENT ||
+            (state != ST_IDLE && !addressed)) {
+            return -1;
+        }
+        card.app_cmd = 1;
+        r[0] = r1_status(state, 1);
+        return SD_HW_RESP_SHORT;
+
+    case 2:     // ALL_SEND_CID
+        if (state != ST_READY) {
+            return -1;
+        }
+        card.state = ST_IDENT;
+        memcpy(r, card.cid, sizeof(card.cid));
+        return SD_HW_RESP_LONG;
+
+    case 3:     // SEND_RELATIVE_ADDR
+        if (state != ST_IDENT && state != ST_STBY) {
+            return -1;
+        }
+        card.rca = SIM_RCA;
+        card.state = ST_STBY;
+        r[0] = ((uint32_t)card.rca << 16) | ((uint32_t)state << 9);
+        return SD_HW_RESP_SHORT;
+
+    case 9:     // SEND_CSD
+        if (state != ST_STBY || !addressed) {
+            return -1;
+        }
+        memcpy(r, card.csd, sizeof(card.csd));
+        return SD_HW_RESP_LONG;
+
+    case 7:     // SELECT/DESELECT_CARD
+        if (!addressed) {
+            // 取消选中：不响应
+            if (state == ST_TRAN) {
+                card.state = ST_STBY;
+            } else if (state == ST_PRG) {
+                card.state = ST_DIS;
+            }
+            return SD_HW_RESP_NONE;
+        }
+        if (state != ST_STBY && state != ST_DIS) {
+            return -1;
+        }
+        card.state = state == ST_DIS ? ST_PRG : ST_TRAN;
+        r[0] = r1_status(state, 0);
+        return SD_HW_RESP_SHORT;
+
+    case 13:    // SEND_STATUS
+        if (state < ST_STBY || !addressed) {
+            return -1;
+        }
+        card.stats.status_polls++;
+        r[0] = r1_status(state, 0);
+        return SD_HW_RESP_SHORT;
+
+    case 16:    // SET_BLOCKLEN
+        if (state != ST_TRAN) {
+            return -1;
+        }
+        if (arg != SD_BLOCK_SIZE) {
+            card.errors |= R1_BLOCK_LEN_ERROR;
+        }
+        r[0] = r1_status(state, 0);
+        return SD_HW_RESP_SHORT;
+
+    case 17:    // READ_SINGLE_BLOCK
+    case 18:    // READ_MULTIPLE_BLOCK
+    case 24:    // WRITE_BLOCK
+    case 25:    // WRITE_MULTIPLE_BLOCK
+        if (state != ST_TRAN) {
+            return -1;
+        }
+        sector = data_address(arg);
+        if (sector != UINT32_MAX) {
+            card.multi = cmd == 18 || cmd == 25;
+            card.xfer_sector = sector;
+            card.xfer_blocks = 0;
+            card.read_past_end = 0;
+            if (cmd == 17 || cmd == 18) {
+                card.state = ST_DATA;
+                card.stats.single_reads += cmd == 17;
+                card.stats.multi_reads += cmd == 18;
+                // 读命令响应后卡立即发送数据，数据通道必须已经使能
+                if (!card.armed || card.arm_dir != SD_HW_READ) {
+                    card.stats.data_violations++;
+                }
+            } else {
+                card.state = ST_RCV;
+                card.stats.single_writes += cmd == 24;
+                card.stats.multi_writes += cmd == 25;
+            }
+        }
+        r[0] = r1_status(state, 0);
+        return SD_HW_RESP_SHORT;
+
+    case 12:    // STOP_TRANSMISSION
+        if (state == ST_DATA) {
+            card.state = ST_TRAN;
+            // 多块读到卡末尾时，卡预读越界，在 CMD12 的响应中报告
+            if (card.read_past_end) {
+                card.errors |= R1_OUT_OF_RANGE;
+            }
+        } else if (state == ST_RCV) {
+            start_programming(card.xfer_blocks);
+        } else {
+            return -1;
+        }
+        card.stats.stops++;
+        r[0] = r1_status(state, 0);
+        return SD_HW_RESP_SHORT;
+
+    default:
+        return -1;
+    }
+}
+
+static void trace_command(uint8_t cmd, uint32_t arg, uint8_t app, int resp, const uint32_t *r, uint8_t state)
+{
+    // 上电等待期间重复的 CMD55/ACMD41 只打印第一组
+    if (state == ST_IDLE && card.acmd41_busy > 0) {
+        if (cmd == 55 || (app && cmd == 41 && card.acmd41_busy > 1 && card.state != ST_READY)) {
+            return;
+        }
+        if (app && cmd == 41 && card.acmd41_busy > 1) {
+            printf("    ... %lu more CMD55/ACMD41 while the card was busy\n",
+                   (unsigned long)(card.acmd41_busy - 1));
+        }
+    }
+    printf("    %s%-2u arg=0x%08lX  %-5s", app ? "ACMD" : "CMD", cmd, (unsigned long)arg, state_names[state]);
+    if (resp < 0) {
+        printf(" -> no response (illegal)");
+    } else if (resp == SD_HW_RESP_LONG) {
+        printf(" -> %08lX %08lX %08lX %08lX", (unsigned long)r[0], (unsigned long)r[1],
+               (unsigned long)r[2], (unsigned long)r[3]);
+    } else if (resp != SD_HW_RESP_NONE) {
+        printf(" -> %08lX", (unsigned long)r[0]);
+    }
+    printf(" -> %-5s @%lukHz/%ubit\n", state_names[card.state], (unsigned long)(card.host_clock / 1000),
+           card.host_width);
+}
+
+// =============================================================================
+// SD_HW_* 接口
+// =============================================================================
+
+void SD_HW_Init(void)
+{
+    // 主机重新上电，卡也随之复位
+    card.host_clock = SD_INIT_CLOCK_HZ;
+    card.host_width = 1;
+    if (card.inserted) {
+        power_on_reset();
+    }
+    SD_HW_Delay(2);
+}
+
+void SD_HW_SetBus(uint32_t clock_hz, uint8_t width)
+{
+    card.host_clock = clock_hz;
+    card.host_width = width;
+}
+
+int SD_HW_Command(uint8_t cmd, uint32_t arg, uint8_t resp, uint32_t resp_out[4])
+{
+    uint32_t r[4] = {0};
+    uint8_t state, app;
+    int card_resp;
+
+    if (!card.inserted) {
+        bus_time(48 + 64);      // 命令 + 64 个时钟的响应超时
+        return resp == SD_HW_RESP_NONE ? SD_OK : SD_ERR_TIMEOUT;
+    }
+
+    update_busy();
+    card.stats.commands++;
+    state = card.state;
+    app = card.app_cmd;
+    card.app_cmd = 0;
+
+    if (card.host_clock > SIM_XFER_MAX_HZ || (state <= ST_IDENT && card.host_clock > SIM_IDENT_MAX_HZ)) {
+        card.stats.clock_violations++;
+    }
+
+    card_resp = card_command(cmd, arg, app, r);
+    if (card.trace) {
+        trace_command(cmd, arg, app, card_resp, r, state);
+    }
+    if (card_resp < 0) {
+        card.stats.illegal_cmds++;
+        card.errors |= R1_ILLEGAL_COMMAND;
+        bus_time(48 + 64);
+        return resp == SD_HW_RESP_NONE ? SD_OK : SD_ERR_TIMEOUT;
+    }
+    if (card_resp != resp && !(card_resp == SD_HW_RESP_NONE && resp == SD_HW_RESP_NONE)) {
+        // 主机期望的响应类型与卡不符：长度不对时 SDIO 报 CRC 错误或超时
+        card.stats.illegal_cmds++;
+        bus_time(48 + 64);
+        return card_resp == SD_HW_RESP_NONE ? SD_ERR_TIMEOUT : SD_ERR_CRC;
+    }
+
+    bus_time(48 + SD_SIM_NCR_CLOCKS + (resp == SD_HW_RESP_LONG ? 136 : resp == SD_HW_RESP_NONE ? 0 : 48));
+    memcpy(resp_out, r, resp == SD_HW_RESP_LONG ? sizeof(r) : sizeof(r[0]) * (resp != SD_HW_RESP_NONE));
+    if (resp == SD_HW_RESP_LONG) {
+        resp_out[3] &= ~1UL;    // SDIO 不保存 CRC 后的结束位
+    }
+    return SD_OK;
+}
+
+int SD_HW_DataStart(void *buf, uint32_t blocks, uint8_t dir)
+{
+    // 写：卡必须已在接收状态（命令响应之后再使能数据通道）
+    if (card.inserted && dir == SD_HW_WRITE && card.state != ST_RCV) {
+        card.stats.data_violations++;
+    }
+    card.armed = 1;
+    card.arm_dir = dir;
+    card.arm_buf = buf;
+    card.arm_blocks = blocks;
+    return SD_OK;
+}
+
+int SD_HW_DataWait(void)
+{
+    uint32_t blocks = card.arm_blocks;
+    uint8_t dir = card.arm_dir;
+    uint8_t expect = dir == SD_HW_READ ? ST_DATA : ST_RCV;
+    uint32_t clocks_per_block;
+    int fail;
+
+    if (!card.armed) {
+        return SD_ERR_DATA;
+    }
+    card.armed = 0;
+
+    if (!card.inserted || card.state != expect || blocks == 0 || (!card.multi && blocks != 1)) {
+        card.stats.data_violations += card.inserted;
+        W25Q128_Sim_Advance_us((dir == SD_HW_READ ? SD_READ_TIMEOUT_MS : SD_WRITE_TIMEOUT_MS) * 1000ULL);
+        return SD_ERR_TIMEOUT;
+    }
+    if (card.host_width != card.width) {
+        card.stats.width_violations++;
+        bus_time(blocks * 1042);
+        return SD_ERR_CRC;
+    }
+    if (card.host_clock > card.stats.max_clock_hz) {
+        card.stats.max_clock_hz = card.host_clock;
+    }
+
+    // 每块：起始位 + 数据 + 每条数据线 16 位 CRC + 结束位（写入另有 CRC 状态与忙信号）
+    clocks_per_block = SD_BLOCK_SIZE * 8 / card.width + 18 + (dir == SD_HW_WRITE ? 8 : 0);
+    fail = card.fail_next;
+    card.fail_next = 0;
+
+    if (dir == SD_HW_READ) {
+        uint32_t start = card.xfer_sector + card.xfer_blocks;
+
+        W25Q128_Sim_Advance_us(SD_SIM_READ_ACCESS_US);
+        if (start + blocks > card.sectors) {
+            card.stats.addr_errors++;
+            card.errors |= R1_OUT_OF_RANGE;
+            return SD_ERR_TIMEOUT;
+        }
+        bus_time(blocks * clocks_per_block);
+        if (fail) {
+            card.stats.crc_injected++;
+        } else {
+            memcpy(card.arm_buf, card.mem + (size_t)start * SD_BLOCK_SIZE, (size_t)blocks * SD_BLOCK_SIZE);
+            card.stats.blocks_read += blocks;
+        }
+        card.xfer_blocks += blocks;
+        if (!card.multi) {
+            card.state = ST_TRAN;
+        } else if (start + blocks == card.sectors) {
+            card.read_past_end = 1;
+        }
+    } else {
+        uint32_t start = card.xfer_sector + card.xfer_blocks;
+
+        if (start + blocks > card.sectors) {
+            card.stats.addr_errors++;
+            card.errors |= R1_OUT_OF_RANGE;
+            return SD_ERR_TIMEOUT;
+        }
+        bus_time(blocks * clocks_per_block);
+        if (fail) {
+            // CRC 状态错误：数据丢弃；单块写回到传输状态，多块写等待 CMD12
+            card.stats.crc_injected++;
+            if (!card.multi) {
+                card.state = ST_TRAN;
+            }
+            return SD_ERR_CRC;
+        }
+        memcpy(card.mem + (size_t)start * SD_BLOCK_SIZE, card.arm_buf, (size_t)blocks * SD_BLOCK_SIZE);
+        card.stats.blocks_written += blocks;
+        card.xfer_blocks += blocks;
+        if (!card.multi) {
+            start_programming(1);
+        }
+    }
+    return fail ? SD_ERR_CRC : SD_OK;
+}
+
+void SD_HW_DataAbort(void)
+{
+    card.armed = 0;
+}
+
+uint8_t SD_HW_DmaCapable(const void *buf)
+{
+    (void)buf;
+    return 1;
+}
+
+void SD_HW_Delay(uint32_t ms)
+{
+    W25Q128_Sim_Advance_us(ms * 1000ULL);
+}
@@ -0,0 +1,245 @@
+/**
+ * @file telem_decode.c
+ * @brief 遥测数据流主机端接收实现（见 telem_decode.h）
+ */
+
+#include "telem_decode.h"
+#include "crc.h"
+#include <string.h>
+
+void TelemRx_Init(TelemReceiver *rx, const TelemRxSink *sink)
+{
+    memset(rx, 0, sizeof(*rx));
+    rx->sink = *sink;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void emit_other(TelemReceiver *rx, const uint8_t *data, size_t len)
+{
+    rx->stats.other_bytes += (uint32_t)len;
+    if (rx->sink.other != NULL && len > 0) {
+        rx->sink.other(rx->sink.ctx, data, len);
+    }
+}
+
+static void flush_zero(TelemReceiver *rx)
+{
+    static const uint8_t zero = 0;
+
+    if (rx->zero) {
+        rx->zero = 0;
+        emit_other(rx, &zero, 1);
+    }
+}
+
+// =============================================================================
+// 帧内容
+// =============================================================================
+
+// 描述帧：通道号 样本长度 batch period_ms(2) 名字\0 格式串\0 字段名\0
+static void parse_schema(TelemReceiver *rx, const uint8_t *p, uint32_t len)
+{
+    const char *str[3];
+    uint32_t off = 5;
+    TelemRxChannel *ch;
+    char *save;
+
+    if (len < 5 || p[0] == TELEM_SCHEMA_ID) {
+        rx->stats.bad_frames++;
+        return;
+    }
+    for (uint32_t i = 0; i < 3; i++) {
+        const uint8_t *nul = off < len ? memchr(p + off, 0, len - off) : NULL;
+
+        if (nul == NULL) {
+            rx->stats.bad_frames++;
+            return;
+        }
+        str[i] = (const char *)p + off;
+        off = (uint32_t)(nul - p) + 1;
+    }
+    if (strlen(str[0]) >= sizeof(ch->name) || strlen(str[1]) > TELEM_RX_MAX_FIELDS ||
+        strlen(str[2]) >= sizeof(ch->names) || Telem_FmtSize(str[1]) != p[1] || p[1] == 0) {
+        rx->stats.bad_frames++;
+        return;
+    }
+
+    ch = &rx->ch[p[0]];
+    ch->known = 1;
+    ch->id = p[0];
+    ch->size = p[1];
+    ch->batch = p[2];
+    ch->period_ms = (uint16_t)(p[3] | (p[4] << 8));
+    strcpy(ch->name, str[0]);
+    strcpy(ch->fmt, str[1]);
+    strcpy(ch->names, str[2]);
+
+    // 字段名不足时用 f0、f1... 补齐（指向格式串后面的静态名字）
+    ch->nfields = (uint32_t)strlen(ch->fmt);
+    for (uint32_t i = 0; i < ch->nfields; i++) {
+        static const char *const spare[TELEM_RX_MAX_FIELDS] = {
+            "f0", "f1", "f2", "f3", "f4", "f5", "f6", "f7",
+            "f8", "f9", "f10", "f11", "f12", "f13", "f14", "f15",
+        };
+        char *tok = strtok_r(i == 0 ? ch->names : NULL, " ", &save);
+
+        ch->field[i] = tok != NULL ? tok : spare[i];
+    }
+
+    rx->stats.schemas++;
+    if (rx->sink.schema != NULL) {
+        rx->sink.schema(rx->sink.ctx, ch);
+    }
+}
+
+static uint32_t field_size(char type)
+{
+    return type == 'b' || type == 'B' ? 1 : type == 'h' || type == 'H' ? 2 : 4;
+}
+
+static double field_value(char type, const uint8_t *p)
+{
+    uint32_t v;
+    float f;
+
+    switch (type) {
+    case 'b': return (int8_t)p[0];
+    case 'B': return p[0];
+    case 'h': return (int16_t)(p[0] | (p[1] << 8));
+    case 'H': return (uint16_t)(p[0] | (p[1] << 8));
+    case 'i': return (int32_t)get32(p);
+    case 'I': return get32(p);
+    default:
+        v = get32(p);
+        memcpy(&f, &v, sizeof(f));
+        return f;
+    }
+}
+
+static void parse_data(TelemReceiver *rx, const uint8_t *f, uint32_t plen)
+{
+    TelemRxChannel *ch = &rx->ch[f[0]];
+    uint8_t seq = f[1], count = f[2], size = f[3];
+    uint32_t t_first = get32(&f[4]), t_last = get32(&f[8]);
+    const uint8_t *p = f + TELEM_HEADER;
+
+    if (count == 0 || size == 0 || (uint32_t)count * size != plen) {
+        rx->stats.bad_frames++;
+        return;
+    }
+    if (rx->sink.frame != NULL) {
+        rx->sink.frame(rx->sink.ctx, ch, seq, t_last, p, plen);
+    }
+    if (!ch->known) {
+        rx->stats.unknown++;
+        return;
+    }
+    if (size != ch->size) {
+        rx->stats.bad_frames++;
+        return;
+    }
+    if (ch->have_seq && seq != ch->next_seq) {
+        uint8_t gap = (uint8_t)(seq - ch->next_seq);
+
+        ch->lost += gap;
+        rx->stats.lost += gap;
+    }
+    ch->have_seq = 1;
+    ch->next_seq = (uint8_t)(seq + 1);
+    ch->frames++;
+    rx->stats.frames++;
+
+    for (uint32_t i = 0; i < count; i++, p += size) {
+        TelemRxSample s;
+        const uint8_t *q = p;
+
+        s.t_ms = count > 1 ? t_first + (uint32_t)((uint64_t)(t_last - t_first) * i / (count - 1)) : t_last;
+        s.raw = p;
+        for (uint32_t k = 0; k < ch->nfields; k++) {
+            s.value[k] = field_value(ch->fmt[k], q);
+            q += field_size(ch->fmt[k]);
+        }
+        ch->samples++;
+        rx->stats.samples++;
+        if (rx->sink.sample != NULL) {
+            rx->sink.sample(rx->sink.ctx, ch, &s);
+        }
+    }
+}
+
+/**
+ * @brief 当前段是不是遥测帧（COBS、长度和 CRC 都正确），是则处理
+ */
+static int try_frame(TelemReceiver *rx)
+{
+    uint8_t f[TELEM_WIRE_MAX];
+    int32_t n = Telem_CobsDecode(rx->seg, rx->seglen, f);
+    uint32_t plen;
+
+    if (n < TELEM_HEADER + 4 || get32(&f[n - 4]) != CRC32_Calc(f, (uint32_t)n - 4)) {
+        return 0;
+    }
+    plen = (uint32_t)n - TELEM_HEADER - 4;
+    if (f[0] == TELEM_SCHEMA_ID) {
+        if (f[2] != 1 || f[3] != plen) {
+            rx->stats.bad_frames++;
+        } else {
+            parse_schema(rx, f + TELEM_HEADER, plen);
+        }
+    } else {
+        parse_data(rx, f, plen);
+    }
+    return 1;
+}
+
+// 一段结束：遥测帧吞掉前导的 0x00；其它段原样交出，结束符 0x00 暂缓（它可能是下一帧的前导）
+static void end_segment(TelemReceiver *rx, int terminated)
+{
+    if (rx->overflow) {
+        rx->overflow = 0;
+    } else if (rx->seglen > 0 && try_frame(rx)) {
+        rx->zero = 0;
+        rx->seglen = 0;
+        return;
+    } else {
+        flush_zero(rx);
+        emit_other(rx, rx->seg, rx->seglen);
+    }
+    rx->seglen = 0;
+    rx->zero = (uint8_t)terminated;
+}
+
+void TelemRx_Feed(TelemReceiver *rx, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] == 0) {
+            end_segment(rx, 1);
+        } else if (rx->overflow) {
+            emit_other(rx, &data[i], 1);
+        } else if (rx->seglen == sizeof(rx->seg)) {
+            // 比最长的帧还长，不可能是遥测帧
+            flush_zero(rx);
+            emit_other(rx, rx->seg, rx->seglen);
+            emit_other(rx, &data[i], 1);
+            rx->seglen = 0;
+            rx->overflow = 1;
+        } else {
+            rx->seg[rx->seglen++] = data[i];
+        }
+    }
+}
+
+/**
+ * @brief 数据结束：处理没有结束符的最后一段
+ */
+void TelemRx_Flush(TelemReceiver *rx)
+{
+    if (rx->seglen > 0 || rx->overflow) {
+        end_segment(rx, 0);
+    }
+    flush_zero(rx);
+}
@@ -0,0 +1,649 @@
+/**
+ * @file w25q128_sim.c
+ * @brief W25Q128 主机端模拟器实现
+ * @details 两层结构：
+ *          - Flash 模型：16MB 存储阵列 + 状态寄存器(WIP/WEL) + 忙时间
+ *          - 接口层：SPI1_* 按字节解码命令（片选拉高时执行编程/擦除，与芯片一致），
+ *            W25Q128_* 直接调用模型，语义与 spi.c 中的驱动保持一致
+ */
+
+#include "spi.h"
+#include "w25q128_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_SECTOR_COUNT (W25Q128_CAPACITY / W25Q128_SECTOR_SIZE)
+
+// ====================== Flash 模型 ======================
+static uint8_t *flash_mem = NULL;
+static char image_file[256] = {0};
+static uint16_t erase_count[SIM_SECTOR_COUNT];
+
+static uint64_t sim_now_us = 0;     // 模拟时钟
+static uint64_t sim_frac_ns = 0;    // 不足 1us 的 SPI 传输时间
+static uint64_t busy_until_us = 0;  // WIP 置位截止时间
+static uint8_t  wel = 0;            // 写使能锁存
+static uint32_t fail_countdown = 0; // 掉电注入：第 N 次编程/擦除执行到一半时掉电
+static uint8_t  power_lost = 0;     // 已掉电，之后的编程/擦除命令全部无效
+
+static W25Q128_Sim_Timing timing = {
+    W25Q128_SIM_T_PP_US,
+    W25Q128_SIM_T_SE_US,
+    W25Q128_SIM_T_BE1_US,
+    W25Q128_SIM_T_BE2_US,
+    W25Q128_SIM_T_CE_US,
+    W25Q128_SIM_SPI_KHZ,
+};
+
+static W25Q128_Sim_Stats stats;
+
+static void ensure_memory(void)
+{
+    if (flash_mem == NULL) {
+        flash_mem = (uint8_t *)malloc(W25Q128_CAPACITY);
+        if (flash_mem == NULL) {
+            fprintf(stderr, "w25q128_sim: out of memory\n");
+            exit(1);
+        }
+        memset(flash_mem, 0xFF, W25Q128_CAPACITY);
+    }
+}
+
+/**
+ * @brief 按 SPI 时钟累加传输 n 字节的时间
+ */
+static void spi_transfer_time(uint32_t bytes)
+{
+    sim_frac_ns += (uint64_t)bytes * 8u * 1000000u / timing.spi_clock_khz;
+    sim_now_us += sim_frac_ns / 1000u;
+    sim_frac_ns %= 1000u;
+}
+
+static uint8_t chip_busy(void)
+{
+    return sim_now_us < busy_until_us;
+}
+
+static void start_busy(uint32_t us)
+{
+    busy_until_us = sim_now_us + us;
+    stats.busy_us += us;
+}
+
+/**
+ * @brief 命令前检查：忙时芯片忽略编程/擦除命令；未写使能同样忽略
+ * @return 1 命令可执行
+ */
+static int check_write_allowed(void)
+{
+    if (chip_busy()) {
+        stats.busy_violations++;
+        return 0;
+    }
+    if (!wel) {
+        stats.wel_violations++;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief 掉电注入计数
+ * @return 1 本次编程/擦除只执行一半，随后掉电
+ */
+static int fault_hit(void)
+{
+    if (fail_countdown == 0) {
+        return 0;
+    }
+    if (--fail_countdown > 0) {
+        return 0;
+    }
+    power_lost = 1;
+    return 1;
+}
+
+static void model_read(uint8_t *dst, uint32_t addr, uint32_t len)
+{
+    ensure_memory();
+    for (uint32_t i = 0; i < len; i++) {
+        dst[i] = flash_mem[(addr + i) % W25Q128_CAPACITY];
+    }
+    stats.read_cmds++;
+    stats.bytes_read += len;
+}
+
+/**
+ * @brief 页编程：页内回绕，只能清零位
+ */
+static void model_program(uint32_t addr, const uint8_t *src, uint32_t len)
+{
+    uint32_t page_base = addr & ~(uint32_t)(W25Q128_PAGE_SIZE - 1);
+    uint32_t offset = addr & (W25Q128_PAGE_SIZE - 1);
+
+    ensure_memory();
+    if (power_lost || !check_write_allowed()) {
+        return;
+    }
+    // 超过 256 字节时只有最后 256 字节生效（芯片行为）
+    if (len > W25Q128_PAGE_SIZE) {
+        src += len - W25Q128_PAGE_SIZE;
+        offset = (offset + len - W25Q128_PAGE_SIZE) & (W25Q128_PAGE_SIZE - 1);
+        len = W25Q128_PAGE_SIZE;
+    }
+    // 掉电时前一半字节已编程，切断处的字节只编程了低 4 位，其余保持原值
+    uint32_t done = fault_hit() ? len / 2 : len;
+    for (uint32_t i = 0; i < len && i <= done; i++) {
+        uint8_t *cell = &flash_mem[page_base + ((offset + i) & (W25Q128_PAGE_SIZE - 1))];
+        uint8_t data = (i < done) ? src[i] : (uint8_t)(src[i] | 0xF0);
+        if (data & ~*cell) {
+            stats.program_violations++;
+        }
+        *cell &= data;
+    }
+    wel = 0;
+    stats.page_programs++;
+    stats.bytes_programmed += len;
+    start_busy(timing.page_program_us);
+}
+
+static void model_erase(uint32_t addr, uint32_t size, uint32_t erase_us)
+{
+    uint32_t base = (addr % W25Q128_CAPACITY) & ~(size - 1);
+
+    ensure_memory();
+    if (power_lost || !check_write_allowed()) {
+        return;
+    }
+    // 掉电时只擦完前一半，后一半保持原内容
+    memset(&flash_mem[base], 0xFF, fault_hit() ? size / 2 : size);
+    for (uint32_t s = base / W25Q128_SECTOR_SIZE; s < (base + size) / W25Q128_SECTOR_SIZE; s++) {
+        erase_count[s]++;
+    }
+    if (size == W25Q128_SECTOR_SIZE) {
+        stats.sector_erases++;
+    } else if (size == W25Q128_CAPACITY) {
+        stats.chip_erases++;
+    } else {
+        stats.block_erases++;
+    }
+    wel = 0;
+    start_busy(erase_us);
+}
+
+static void wait_ready(void)
+{
+    if (chip_busy()) {
+        sim_now_us = busy_until_us;
+    }
+}
+
+// ====================== 映像管理 ======================
+
+/**
+ * @brief 打开（或创建）映像文件；image_path 为 NULL 时只在内存中模拟
+ * @return 0 成功，-1 失败
+ */
+int W25Q128_Sim_Open(const char *image_path)
+{
+    FILE *fp;
+
+    ensure_memory();
+    memset(flash_mem, 0xFF, W25Q128_CAPACITY);
+    memset(erase_count, 0, sizeof(erase_count));
+    image_file[0] = '\0';
+    busy_until_us = sim_now_us;
+    wel = 0;
+
+    if (image_path == NULL) {
+        return 0;
+    }
+    strncpy(image_file, image_path, sizeof(image_file) - 1);
+
+    fp = fopen(image_path, "rb");
+    if (fp != NULL) {
+        size_t n = fread(flash_mem, 1, W25Q128_CAPACITY, fp);
+        fclose(fp);
+        if (n != W25Q128_CAPACITY) {
+            // 不足 16MB 的部分视为已擦除
+            memset(flash_mem + n, 0xFF, W25Q128_CAPACITY - n);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 把存储阵列写回映像文件
+ */
+void W25Q128_Sim_Flush(void)
+{
+    FILE *fp;
+
+    if (flash_mem == NULL || image_file[0] == '\0') {
+        return;
+    }
+    fp = fopen(image_file, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "w25q128_sim: cannot write %s\n", image_file);
+        return;
+    }
+    fwrite(flash_mem, 1, W25Q128_CAPACITY, fp);
+    fclose(fp);
+}
+
+void W25Q128_Sim_Close(void)
+{
+    W25Q128_Sim_Flush();
+    free(flash_mem);
+    flash_mem = NULL;
+    image_file[0] = '\0';
+}
+
+uint8_t *W25Q128_Sim_Memory(void)
+{
+    ensure_memory();
+    return flash_mem;
+}
+
+// ====================== 掉电注入 ======================
+
+/**
+ * @brief 第 ops 次编程/擦除执行到一半时掉电（0 关闭）
+ * @details 掉电后所有编程/擦除命令都被忽略，直到 W25Q128_Sim_PowerCycle()
+ */
+void W25Q128_Sim_FailAfter(uint32_t ops)
+{
+    fail_countdown = ops;
+    power_lost = 0;
+}
+
+uint8_t W25Q128_Sim_PowerLost(void)
+{
+    return power_lost;
+}
+
+/**
+ * @brief 重新上电：清除掉电、写使能和忙状态，Flash 内容保持
+ */
+void W25Q128_Sim_PowerCycle(void)
+{
+    fail_countdown = 0;
+    power_lost = 0;
+    wel = 0;
+    busy_until_us = sim_now_us;
+}
+
+// ====================== 时钟、时序与统计 ======================
+
+uint64_t W25Q128_Sim_Time_us(void)
+{
+    return sim_now_us;
+}
+
+void W25Q128_Sim_Advance_us(uint64_t us)
+{
+    sim_now_us += us;
+}
+
+uint32_t get_systick(void)
+{
+    return (uint32_t)(sim_now_us / 1000u);
+}
+
+void W25Q128_Sim_SetTiming(const W25Q128_Sim_Timing *t)
+{
+    if (t != NULL) {
+        timing = *t;
+        if (timing.spi_clock_khz == 0) {
+            timing.spi_clock_khz = W25Q128_SIM_SPI_KHZ;
+        }
+    }
+}
+
+void W25Q128_Sim_GetTiming(W25Q128_Sim_Timing *t)
+{
+    if (t != NULL) {
+        *t = timing;
+    }
+}
+
+void W25Q128_Sim_GetStats(W25Q128_Sim_Stats *s)
+{
+    if (s != NULL) {
+        *s = stats;
+    }
+}
+
+void W25Q128_Sim_ResetStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+uint32_t W25Q128_Sim_EraseCount(uint32_t sector_index)
+{
+    return sector_index < SIM_SECTOR_COUNT ? erase_count[sector_index] : 0;
+}
+
+void W25Q128_Sim_PrintStats(const char *label)
+{
+    uint32_t max_erase = 0;
+
+    for (uint32_t i = 0; i < SIM_SECTOR_COUNT; i++) {
+        if (erase_count[i] > max_erase) {
+            max_erase = erase_count[i];
+        }
+    }
+    printf("[%s] t=%.3f ms read=%llu B (%u cmds) prog=%u pages erase=%u/%u/%u busy=%.3f ms max_wear=%u",
+           label ? label : "flash",
+           sim_now_us / 1000.0,
+           (unsigned long long)stats.bytes_read, stats.read_cmds,
+           stats.page_programs, stats.sector_erases, stats.block_erases, stats.chip_erases,
+           stats.busy_us / 1000.0, max_erase);
+    if (stats.program_violations || stats.wel_violations || stats.busy_violations) {
+        printf(" VIOLATIONS prog=%u wel=%u busy=%u",
+               stats.program_violations, stats.wel_violations, stats.busy_violations);
+    }
+    printf("\n");
+}
+
+// ====================== SPI1 字节级接口 ======================
+
+// 命令解码状态
+static uint8_t  cs_active = 0;
+static uint8_t  cmd = 0;
+static uint32_t cmd_bytes = 0;      // 本次片选内已收到的字节数
+static uint32_t cmd_addr = 0;
+static uint8_t  page_latch[W25Q128_PAGE_SIZE];
+static uint32_t page_latch_len = 0;
+
+static uint8_t status_reg1(void)
+{
+    return (chip_busy() ? 0x01 : 0x00) | (wel ? 0x02 : 0x00);
+}
+
+static uint8_t addr_len(uint8_t c)
+{
+    switch (c) {
+    case W25X_ReadData:
+    case W25X_PageProgram:
+    case W25X_SectorErase:
+    case W25X_BlockErase32:
+    case W25X_BlockErase64:
+        return 3;
+    case W25X_FastRead:
+        return 4;   // 3 字节地址 + 1 字节 dummy
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief 片选电平变化；拉高时执行已锁存的编程/擦除命令
+ */
+void W25Q128_Sim_CS(int level)
+{
+    if (level == 0) {
+        cs_active = 1;
+        cmd_bytes = 0;
+        page_latch_len = 0;
+        return;
+    }
+    if (!cs_active) {
+        return;
+    }
+    cs_active = 0;
+    if (cmd_bytes == 0) {
+        return;
+    }
+
+    switch (cmd) {
+    case W25X_WriteEnable:
+        wel = 1;
+        break;
+    case W25X_WriteDisable:
+        wel = 0;
+        break;
+    case W25X_PageProgram:
+        if (cmd_bytes > 4 && page_latch_len > 0) {
+            model_program(cmd_addr, page_latch, page_latch_len);
+        }
+        break;
+    case W25X_SectorErase:
+        if (cmd_bytes >= 4) model_erase(cmd_addr, W25Q128_SECTOR_SIZE, timing.sector_erase_us);
+        break;
+    case W25X_BlockErase32:
+        if (cmd_bytes >= 4) model_erase(cmd_addr, 32 * 1024, timing.block32_erase_us);
+        break;
+    case W25X_BlockErase64:
+        if (cmd_bytes >= 4) model_erase(cmd_addr, 64 * 1024, timing.block64_erase_us);
+        break;
+    case W25X_ChipErase:
+        model_erase(0, W25Q128_CAPACITY, timing.chip_erase_us);
+        break;
+    case W25X_WriteStatusReg1:
+        if (check_write_allowed()) {
+            wel = 0;
+            start_busy(10000);  // tW 写状态寄存器 10ms
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void SPI1_Init(void)
+{
+    static uint8_t announced = 0;
+
+    ensure_memory();
+    // KV/时序存储每次初始化都会调用，只打印一次
+    if (!announced) {
+        announced = 1;
+        printf("spi OK (simulator)\r\n");
+    }
+}
+
+uint8_t SPI1_ReadWriteByte(uint8_t txData)
+{
+    uint8_t rx = 0xFF;
+    uint32_t n;
+
+    spi_transfer_time(1);
+    if (!cs_active) {
+        return rx;
+    }
+
+    n = cmd_bytes++;
+    if (n == 0) {
+        cmd = txData;
+        if (cmd == W25X_ReadData || cmd == W25X_FastRead) {
+            stats.read_cmds++;
+        }
+        return rx;
+    }
+
+    // 地址阶段
+    if (n <= addr_len(cmd)) {
+        if (n <= 3) {
+            cmd_addr = (cmd_addr << 8) | txData;
+            if (n == 1) cmd_addr = txData;
+            cmd_addr &= 0xFFFFFF;
+        }
+        return rx;
+    }
+
+    // 数据阶段
+    switch (cmd) {
+    case W25X_JedecDeviceID: {
+        static const uint8_t jedec[3] = {0xEF, 0x40, 0x18};
+        return n <= 3 ? jedec[n - 1] : 0xFF;
+    }
+    case W25X_ReadStatusReg1:
+        return status_reg1();
+    case W25X_ReadStatusReg2:
+        return 0x00;
+    case W25X_ReadData:
+    case W25X_FastRead:
+        ensure_memory();
+        rx = flash_mem[cmd_addr];
+        cmd_addr = (cmd_addr + 1) % W25Q128_CAPACITY;
+        stats.bytes_read++;
+        return rx;
+    case W25X_PageProgram:
+        // 页内回绕锁存，最多保留最后 256 字节
+        if (page_latch_len < W25Q128_PAGE_SIZE) {
+            page_latch[page_latch_len++] = txData;
+        } else {
+            memmove(page_latch, page_latch + 1, W25Q128_PAGE_SIZE - 1);
+            page_latch[W25Q128_PAGE_SIZE - 1] = txData;
+            cmd_addr = (cmd_addr & ~(uint32_t)(W25Q128_PAGE_SIZE - 1)) |
+                       ((cmd_addr + 1) & (W25Q128_PAGE_SIZE - 1));
+        }
+        return rx;
+    default:
+        return rx;
+    }
+}
+
+void SPI1_WriteBytes(uint8_t *pData, uint16_t size)
+{
+    for (uint16_t i = 0; i < size; i++) {
+        SPI1_ReadWriteByte(pData[i]);
+    }
+}
+
+void SPI1_ReadBytes(uint8_t *pData, uint16_t size)
+{
+    for (uint16_t i = 0; i < size; i++) {
+        pData[i] = SPI1_ReadWriteByte(0xFF);
+    }
+}
+
+// ====================== W25Q128 驱动接口 ======================
+
+uint32_t W25Q128_ReadID(void)
+{
+    spi_transfer_time(4);
+    return W25X_JEDECID;
+}
+
+uint8_t W25Q128_WaitForWriteEnd(void)
+{
+    spi_transfer_time(2);
+    wait_ready();
+    return W25Q128_RESULT_OK;
+}
+
+void W25Q128_WriteEnable(void)
+{
+    spi_transfer_time(1);
+    if (!chip_busy()) {
+        wel = 1;
+    } else {
+        stats.busy_violations++;
+    }
+}
+
+uint8_t W25Q128_SectorErase(uint32_t SectorAddr)
+{
+    W25Q128_WaitForWriteEnd();
+    W25Q128_WriteEnable();
+    spi_transfer_time(4);
+    model_erase(SectorAddr, W25Q128_SECTOR_SIZE, timing.sector_erase_us);
+    return W25Q128_WaitForWriteEnd();
+}
+
+uint8_t W25Q128_WritePage(uint8_t *pBuffer, uint32_t WriteAddr, uint16_t NumByteToWrite)
+{
+    if (pBuffer == NULL || NumByteToWrite == 0 || NumByteToWrite > W25Q128_PAGE_SIZE) {
+        return W25Q128_RESULT_ERROR;
+    }
+    W25Q128_WaitForWriteEnd();
+    W25Q128_WriteEnable();
+    spi_transfer_time(4 + NumByteToWrite);
+    model_program(WriteAddr, pBuffer, NumByteToWrite);
+    return W25Q128_WaitForWriteEnd();
+}
+
+uint8_t W25Q128_WritePage_Optimized(uint8_t *pBuffer, uint32_t WriteAddr, uint16_t NumByteToWrite)
+{
+    return W25Q128_WritePage(pBuffer, WriteAddr, NumByteToWrite);
+}
+
+void W25Q128_SetHighSpeedMode(void)
+{
+    spi_transfer_time(2);
+}
+
+uint8_t W25Q128_BufferWrite(uint8_t *pBuffer, uint32_t WriteAddr, uint16_t NumByteToWrite)
+{
+    uint16_t bytes_remaining = NumByteToWrite;
+    uint32_t current_addr = WriteAddr;
+    uint8_t result;
+
+    if (pBuffer == NULL || NumByteToWrite == 0 || current_addr >= W25Q128_CAPACITY) {
+        return W25Q128_RESULT_ERROR;
+    }
+    while (bytes_remaining > 0) {
+        uint16_t page_remaining = W25Q128_PAGE_SIZE - current_addr % W25Q128_PAGE_SIZE;
+        uint16_t n = bytes_remaining <= page_remaining ? bytes_remaining : page_remaining;
+
+        result = W25Q128_WritePage(pBuffer, current_addr, n);
+        if (result != W25Q128_RESULT_OK) {
+            return result;
+        }
+        pBuffer += n;
+        current_addr += n;
+        bytes_remaining -= n;
+        if (current_addr >= W25Q128_CAPACITY) {
+            break;
+        }
+    }
+    return W25Q128_RESULT_OK;
+}
+
+void W25Q128_ReadData(uint8_t *pBuffer, uint32_t ReadAddr, uint16_t NumByteToRead)
+{
+    uint16_t bytes_to_read;
+
+    if (ReadAddr >= W25Q128_CAPACITY) {
+        return;
+    }
+    bytes_to_read = NumByteToRead + ReadAddr >= W25Q128_CAPACITY ? W25Q128_CAPACITY - ReadAddr : NumByteToRead;
+    if (pBuffer == NULL || bytes_to_read == 0) {
+        return;
+    }
+    if (chip_busy()) {
+        stats.busy_violations++;
+        wait_ready();
+    }
+    spi_transfer_time(4 + bytes_to_read);
+    model_read(pBuffer, ReadAddr, bytes_to_read);
+}
+
+// 模拟中没有 DMA：按 64KB 分段走与 W25Q128_ReadData 相同的模型，总线时间相同
+uint8_t W25Q128_ReadData_DMA(uint8_t *pBuffer, uint32_t ReadAddr, uint32_t NumByteToRead)
+{
+    if (pBuffer == NULL || NumByteToRead == 0 || ReadAddr >= W25Q128_CAPACITY) {
+        return W25Q128_RESULT_ERROR;
+    }
+    if (NumByteToRead > W25Q128_CAPACITY - ReadAddr) {
+        NumByteToRead = W25Q128_CAPACITY - ReadAddr;
+    }
+    while (NumByteToRead > 0) {
+        uint16_t n = NumByteToRead > 0xFFFF ? 0xFFFF : (uint16_t)NumByteToRead;
+        W25Q128_ReadData(pBuffer, ReadAddr, n);
+        pBuffer += n;
+        ReadAddr += n;
+        NumByteToRead -= n;
+    }
+    return W25Q128_RESULT_OK;
+}
+
+uint8_t W25Q128_IsBusy(void)
+{
+    spi_transfer_time(2);
+    wait_ready();
+    return 0;
+}
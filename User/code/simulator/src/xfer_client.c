@@ -0,0 +1,151 @@
+/**
+ * @file xfer_client.c
+ * @brief 串口批量传输的上位机端（见 xfer_client.h）
+ */
+
+#include "xfer_client.h"
+#include <string.h>
+
+static void send_request(XferClient *c, uint8_t type, uint32_t offset, const void *payload, uint32_t len)
+{
+    uint8_t frame[XFER_REQUEST_MAX];
+
+    c->send(c->ctx, frame, Xfer_Build(frame, type, c->xid, offset, payload, len));
+}
+
+static void send_open(XferClient *c)
+{
+    c->stats.opens++;
+    send_request(c, XFER_OPEN, c->expected, c->name, (uint32_t)strlen(c->name));
+}
+
+static void send_ack(XferClient *c)
+{
+    c->stats.acks++;
+    send_request(c, XFER_ACK, c->expected, 0, 0);
+}
+
+static void on_data(XferClient *c, const XferFrame *f)
+{
+    if (c->state != XFER_CLIENT_RECEIVING && c->state != XFER_CLIENT_DONE) {
+        return;
+    }
+    c->stats.frames++;
+    if (f->offset != c->expected || f->len == 0 || f->offset + f->len > c->size) {
+        if (f->offset < c->expected) {
+            c->stats.duplicate++;
+        } else {
+            c->stats.out_of_order++;
+        }
+        send_ack(c);
+        return;
+    }
+    if (c->write(c->ctx, f->offset, f->payload, f->len) != 0) {
+        c->state = XFER_CLIENT_FAILED;
+        c->error = XFER_ERR_IO;
+        return;
+    }
+    c->expected += f->len;
+    send_ack(c);
+    if (c->expected == c->size) {
+        c->state = XFER_CLIENT_DONE;
+    }
+}
+
+static void on_frame(void *ctx, const XferFrame *f)
+{
+    XferClient *c = ctx;
+
+    if (f->xid != c->xid) {
+        return;         // 上一次会话的帧
+    }
+    c->last_rx = c->now;
+    switch (f->type) {
+    case XFER_INFO:
+        if (c->state == XFER_CLIENT_OPENING && f->len >= 3) {
+            c->size = f->offset;
+            c->chunk = (uint16_t)(f->payload[0] | (f->payload[1] << 8));
+            c->window = f->payload[2];
+            c->state = c->expected >= c->size ? XFER_CLIENT_DONE : XFER_CLIENT_RECEIVING;
+        }
+        break;
+    case XFER_DATA:
+        on_data(c, f);
+        break;
+    case XFER_ERROR:
+        if (c->state == XFER_CLIENT_OPENING) {
+            c->state = XFER_CLIENT_FAILED;
+            c->error = -(int)f->offset;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void on_text(void *ctx, const uint8_t *data, uint32_t len)
+{
+    XferClient *c = ctx;
+
+    if (c->text != 0) {
+        c->text(c->ctx, data, len);
+    }
+}
+
+/**
+ * @brief 开始一次下载并发出 OPEN
+ * @param start 续传起点（已收到的字节数），从头下载为 0
+ * @param xid 会话号，与上一次会话不同，迟到的旧帧会被忽略
+ */
+void XferClient_Init(XferClient *c, const char *name, uint32_t start, uint16_t xid, XferSend send, XferWrite write,
+                     XferTextHandler text, void *ctx, uint32_t now_ms)
+{
+    memset(c, 0, sizeof(*c));
+    c->name = name;
+    c->xid = xid;
+    c->send = send;
+    c->write = write;
+    c->text = text;
+    c->ctx = ctx;
+    c->expected = start;
+    c->now = c->last_rx = now_ms;
+    c->state = XFER_CLIENT_OPENING;
+    XferParser_Init(&c->parser, c->rx_buf, sizeof(c->rx_buf), on_frame, on_text, c);
+    send_open(c);
+}
+
+/**
+ * @brief 输入从串口收到的数据块（任意切分）
+ */
+void XferClient_Input(XferClient *c, const uint8_t *data, uint32_t len, uint32_t now_ms)
+{
+    c->now = now_ms;
+    XferParser_Feed(&c->parser, data, len);
+}
+
+/**
+ * @brief 处理超时
+ * @return 状态 XFER_CLIENT_*
+ */
+int XferClient_Poll(XferClient *c, uint32_t now_ms)
+{
+    c->now = now_ms;
+    if (now_ms - c->last_rx >= XFER_RTO_MS) {
+        if (c->state == XFER_CLIENT_OPENING) {
+            send_open(c);
+        } else if (c->state == XFER_CLIENT_RECEIVING) {
+            c->stats.idle_acks++;
+            send_ack(c);
+        }
+        c->last_rx = now_ms;
+    }
+    return c->state;
+}
+
+/**
+ * @brief 结束会话，设备退出传输模式
+ */
+void XferClient_Close(XferClient *c)
+{
+    send_request(c, XFER_CLOSE, 0, 0, 0);
+}
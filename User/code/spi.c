@@ -329,6 +329,116 @@ void W25Q128_ReadData(uint8_t *pBuffer, uint32_t ReadAddr, uint16_t NumByteToRea
     SPI_NSS_H;
 }
 
+// DMA SPI1_RX Ϊ DMA2 Stream0 ͨ3SPI1_TX Ϊ DMA2 Stream3 ͨ3 dummy ֽڲʱӣ
+#define SPI_DMA_RX_STREAM   DMA2_Stream0
+#define SPI_DMA_TX_STREAM   DMA2_Stream3
+#define SPI_DMA_RX_FLAGS    (DMA_FLAG_TCIF0 | DMA_FLAG_HTIF0 | DMA_FLAG_TEIF0 | DMA_FLAG_DMEIF0 | DMA_FLAG_FEIF0)
+#define SPI_DMA_TX_FLAGS    (DMA_FLAG_TCIF3 | DMA_FLAG_HTIF3 | DMA_FLAG_TEIF3 | DMA_FLAG_DMEIF3 | DMA_FLAG_FEIF3)
+
+static void spi_dma_stream_init(DMA_Stream_TypeDef *stream, uint32_t mem, uint16_t len,
+                                uint32_t dir, uint32_t mem_inc, uint32_t prio)
+{
+    DMA_InitTypeDef dma;
+
+    DMA_Cmd(stream, DISABLE);
+    while (DMA_GetCmdStatus(stream) != DISABLE) {
+    }
+    DMA_StructInit(&dma);
+    dma.DMA_Channel = DMA_Channel_3;
+    dma.DMA_PeripheralBaseAddr = (uint32_t)&SPI1->DR;
+    dma.DMA_Memory0BaseAddr = mem;
+    dma.DMA_DIR = dir;
+    dma.DMA_BufferSize = len;
+    dma.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    dma.DMA_MemoryInc = mem_inc;
+    dma.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    dma.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    dma.DMA_Mode = DMA_Mode_Normal;
+    dma.DMA_Priority = prio;
+    dma.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_Init(stream, &dma);
+}
+
+/**
+ * @brief  DMA  Flash ֱӶĿ껺 OLED Դ棩м仺
+ * @details ͵ַ DMA շCPU ѯɱ־21MHz  1KB Լ 0.4ms
+ *          ̶Ŀ CCM RAMDMA ܷʣʱ˻ֽڶȡ
+ *           W25Q128_* һ洢ʱֻڴ洢еá
+ * @return W25Q128_RESULT_OK / W25Q128_RESULT_ERROR / W25Q128_TIMEOUT_ERROR
+ */
+uint8_t W25Q128_ReadData_DMA(uint8_t *pBuffer, uint32_t ReadAddr, uint32_t NumByteToRead)
+{
+    static const uint8_t dummy = W25X_Dummy;
+    uint8_t result = W25Q128_RESULT_OK;
+
+    if (pBuffer == NULL || NumByteToRead == 0 || ReadAddr >= W25Q128_CAPACITY) {
+        return W25Q128_RESULT_ERROR;
+    }
+    if (NumByteToRead > W25Q128_CAPACITY - ReadAddr) {
+        NumByteToRead = W25Q128_CAPACITY - ReadAddr;
+    }
+
+    if (NumByteToRead < SPI_DMA_MIN_BYTES || ((uint32_t)pBuffer & 0xFFFF0000UL) == 0x10000000UL) {
+        while (NumByteToRead > 0) {
+            uint16_t n = NumByteToRead > 0xFFFF ? 0xFFFF : (uint16_t)NumByteToRead;
+            W25Q128_ReadData(pBuffer, ReadAddr, n);
+            pBuffer += n;
+            ReadAddr += n;
+            NumByteToRead -= n;
+        }
+        return W25Q128_RESULT_OK;
+    }
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2, ENABLE);
+    SPI_NSS_L;
+    SPI1_ReadWriteByte(W25X_ReadData);
+    SPI1_ReadWriteByte((ReadAddr >> 16) & 0xFF);
+    SPI1_ReadWriteByte((ReadAddr >> 8) & 0xFF);
+    SPI1_ReadWriteByte(ReadAddr & 0xFF);
+
+    // NDTR  65535ĶȡֶνУƬѡЧ
+    while (NumByteToRead > 0 && result == W25Q128_RESULT_OK) {
+        uint16_t n = NumByteToRead > 0xFFFF ? 0xFFFF : (uint16_t)NumByteToRead;
+        uint32_t timeout = W25Q128_TIMEOUT_VALUE;
+
+        // ȼڷ֤ͣÿֽһֽǰȡ
+        spi_dma_stream_init(SPI_DMA_RX_STREAM, (uint32_t)pBuffer, n, DMA_DIR_PeripheralToMemory,
+                            DMA_MemoryInc_Enable, DMA_Priority_VeryHigh);
+        spi_dma_stream_init(SPI_DMA_TX_STREAM, (uint32_t)&dummy, n, DMA_DIR_MemoryToPeripheral,
+                            DMA_MemoryInc_Disable, DMA_Priority_High);
+        DMA_ClearFlag(SPI_DMA_RX_STREAM, SPI_DMA_RX_FLAGS);
+        DMA_ClearFlag(SPI_DMA_TX_STREAM, SPI_DMA_TX_FLAGS);
+        DMA_Cmd(SPI_DMA_RX_STREAM, ENABLE);
+        DMA_Cmd(SPI_DMA_TX_STREAM, ENABLE);
+        SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+
+        while (DMA_GetFlagStatus(SPI_DMA_RX_STREAM, DMA_FLAG_TCIF0 | DMA_FLAG_TEIF0) == RESET) {
+            if (--timeout == 0) {
+                result = W25Q128_TIMEOUT_ERROR;
+                break;
+            }
+        }
+        if (DMA_GetFlagStatus(SPI_DMA_RX_STREAM, DMA_FLAG_TEIF0) != RESET) {
+            result = W25Q128_RESULT_ERROR;
+        }
+
+        SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+        DMA_Cmd(SPI_DMA_RX_STREAM, DISABLE);
+        DMA_Cmd(SPI_DMA_TX_STREAM, DISABLE);
+        DMA_ClearFlag(SPI_DMA_RX_STREAM, SPI_DMA_RX_FLAGS);
+        DMA_ClearFlag(SPI_DMA_TX_STREAM, SPI_DMA_TX_FLAGS);
+
+        pBuffer += n;
+        ReadAddr += n;
+        NumByteToRead -= n;
+    }
+
+    while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_BSY) == SET) {
+    }
+    SPI_NSS_H;
+    return result;
+}
+
 uint8_t W25Q128_IsBusy(void)
 {
     uint8_t status = 0;
@@ -2,10 +2,17 @@
 #define  SPI_H
 
 #include "stm32f4xx.h"
-#include "sys.h"
 
+#ifdef FLASH_SIMULATOR
+// 主机模拟构建：片选由 W25Q128 模拟器处理（见 simulator/）
+#include "w25q128_sim.h"
+#define SPI_NSS_H 	W25Q128_Sim_CS(1)
+#define SPI_NSS_L 	W25Q128_Sim_CS(0)
+#else
+#include "sys.h"
 #define SPI_NSS_H 	PBout(14) = 1
 #define SPI_NSS_L 	PBout(14) = 0
+#endif
 #define W25X_Dummy  0xFF
 
 // W25Q128 参数定义
@@ -40,6 +47,9 @@
 // 超时定义
 #define W25Q128_TIMEOUT_VALUE   1000000
 
+// 少于这么多字节的 W25Q128_ReadData_DMA 直接用 CPU 读（配置 DMA 的开销不划算）
+#define SPI_DMA_MIN_BYTES       64
+
 void SPI1_Init(void);
 uint8_t SPI1_ReadWriteByte(uint8_t txData);
 void SPI1_WriteBytes(uint8_t *pData, uint16_t size);
@@ -52,6 +62,7 @@ uint8_t W25Q128_WritePage(uint8_t *pBuffer, uint32_t WriteAddr, uint16_t NumByte
 uint8_t W25Q128_WritePage_Optimized(uint8_t *pBuffer, uint32_t WriteAddr, uint16_t NumByteToWrite);
 uint8_t W25Q128_BufferWrite(uint8_t *pBuffer, uint32_t WriteAddr, uint16_t NumByteToWrite);
 void W25Q128_ReadData(uint8_t *pBuffer, uint32_t ReadAddr, uint16_t NumByteToRead);
+uint8_t W25Q128_ReadData_DMA(uint8_t *pBuffer, uint32_t ReadAddr, uint32_t NumByteToRead);
 uint8_t W25Q128_IsBusy(void);
 void W25Q128_SetHighSpeedMode(void);
 
@@ -0,0 +1,336 @@
+/**
+ * @file telemetry.c
+ * @brief 遥测数据流实现（见 telemetry.h）
+ */
+
+#include "telemetry.h"
+#include "crc.h"
+#include <string.h>
+
+static TelemOutput telem_output = 0;
+static uint32_t budget_bps = 0;         // 0-不限
+static uint32_t budget_tokens;          // 千分之一字节
+static uint32_t budget_time;
+static uint8_t budget_started = 0;
+
+static uint8_t frame_buf[TELEM_FRAME_MAX];
+static uint8_t wire_buf[TELEM_WIRE_MAX];
+
+/**
+ * @brief 设置输出函数和所有通道共享的字节预算（字节/秒，0-不限）
+ */
+void Telem_Init(TelemOutput output, uint32_t bps)
+{
+    telem_output = output;
+    budget_bps = bps;
+    budget_tokens = TELEM_BURST * 1000u;
+    budget_started = 0;
+}
+
+/**
+ * @brief 格式串描述的样本字节数，含未知字符时返回 0
+ */
+uint32_t Telem_FmtSize(const char *fmt)
+{
+    uint32_t size = 0;
+
+    for (; *fmt != '\0'; fmt++) {
+        switch (*fmt) {
+        case 'b': case 'B': size += 1; break;
+        case 'h': case 'H': size += 2; break;
+        case 'i': case 'I': case 'f': size += 4; break;
+        default: return 0;
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief 初始化通道
+ * @param fields 字段名（空格分隔，个数与 fmt 相同），写入描述帧
+ * @param size 样本字节数，必须等于 fmt 算出的大小（防止结构体填充字节混进数据）
+ * @param batch 每帧样本数，会被限制在 TELEM_MAX_PAYLOAD / size 以内
+ * @return TELEM_OK 或 TELEM_ERR_PARAM
+ */
+int Telem_ChannelInit(TelemChannel *ch, uint8_t id, const char *name, const char *fmt, const char *fields,
+                      uint8_t size, uint8_t batch, uint16_t period_ms)
+{
+    memset(ch, 0, sizeof(*ch));
+    if (id == TELEM_SCHEMA_ID || size == 0 || size > TELEM_MAX_PAYLOAD || Telem_FmtSize(fmt) != size) {
+        return TELEM_ERR_PARAM;
+    }
+    ch->name = name;
+    ch->fmt = fmt;
+    ch->fields = fields;
+    ch->id = id;
+    ch->size = size;
+    ch->batch = batch == 0 ? 1 : batch;
+    if (ch->batch > TELEM_MAX_PAYLOAD / size) {
+        ch->batch = (uint8_t)(TELEM_MAX_PAYLOAD / size);
+    }
+    ch->period_ms = period_ms;
+    return TELEM_OK;
+}
+
+/**
+ * @brief 修改采样间隔（可以在另一个任务中调用，下一个样本起生效）
+ */
+void Telem_SetPeriod(TelemChannel *ch, uint16_t period_ms)
+{
+    ch->period_ms = period_ms;
+    ch->started = 0;
+}
+
+/**
+ * @brief 此刻的样本是否会被接收：派生量（姿态角等）可以只在需要时计算
+ */
+int Telem_Due(const TelemChannel *ch, uint32_t t_ms)
+{
+    return ch->period_ms == 0 || !ch->started || (int32_t)(t_ms - ch->next_due) >= 0;
+}
+
+// =============================================================================
+// 组帧与编码
+// =============================================================================
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * @brief COBS 编码：输出不含 0x00，长度最多 len + len / 254 + 1
+ */
+uint32_t Telem_CobsEncode(const uint8_t *in, uint32_t len, uint8_t *out)
+{
+    uint32_t code_pos = 0, n = 1;
+    uint8_t code = 1;
+
+    for (uint32_t i = 0; i < len; i++) {
+        if (in[i] != 0) {
+            out[n++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF) {
+            out[code_pos] = code;
+            code_pos = n++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    return n;
+}
+
+/**
+ * @brief COBS 解码（输入不含分隔符）
+ * @return 解码后的长度，-1-编码错误（含 0x00 或长度越界）
+ */
+int32_t Telem_CobsDecode(const uint8_t *in, uint32_t len, uint8_t *out)
+{
+    uint32_t i = 0, n = 0;
+
+    while (i < len) {
+        uint8_t code = in[i++];
+
+        if (code == 0 || i + code - 1 > len) {
+            return -1;
+        }
+        for (uint8_t k = 1; k < code; k++) {
+            if (in[i] == 0) {
+                return -1;
+            }
+            out[n++] = in[i++];
+        }
+        if (code != 0xFF && i < len) {
+            out[n++] = 0;
+        }
+    }
+    return (int32_t)n;
+}
+
+// 按上一次到现在的时间补充令牌，够 len 字节就扣除
+static int budget_take(uint32_t t_ms, uint32_t len)
+{
+    uint32_t cost = len * 1000u;
+
+    if (budget_bps == 0) {
+        return 1;
+    }
+    if (budget_started) {
+        uint32_t dt = t_ms - budget_time;
+
+        if (dt > TELEM_BURST * 1000u / budget_bps + 1) {
+            budget_tokens = TELEM_BURST * 1000u;
+        } else {
+            budget_tokens += dt * budget_bps;
+            if (budget_tokens > TELEM_BURST * 1000u) {
+                budget_tokens = TELEM_BURST * 1000u;
+            }
+        }
+    }
+    budget_time = t_ms;
+    budget_started = 1;
+    if (budget_tokens < cost) {
+        return 0;
+    }
+    budget_tokens -= cost;
+    return 1;
+}
+
+/**
+ * @brief 加帧头和 CRC，COBS 编码后整帧输出
+ * @return 写出的字节数，0-被丢弃（*throttled 表示是否因为超出预算）
+ */
+static uint32_t send_frame(uint8_t id, uint8_t seq, uint8_t count, uint8_t size, uint32_t t_first, uint32_t t_last,
+                           const uint8_t *payload, uint32_t len, int budget, int *throttled)
+{
+    uint32_t n;
+
+    frame_buf[0] = id;
+    frame_buf[1] = seq;
+    frame_buf[2] = count;
+    frame_buf[3] = size;
+    put32(&frame_buf[4], t_first);
+    put32(&frame_buf[8], t_last);
+    memcpy(&frame_buf[TELEM_HEADER], payload, len);
+    len += TELEM_HEADER;
+    put32(&frame_buf[len], CRC32_Calc(frame_buf, len));
+    len += 4;
+
+    wire_buf[0] = 0;
+    n = 1 + Telem_CobsEncode(frame_buf, len, &wire_buf[1]);
+    wire_buf[n++] = 0;
+
+    *throttled = 0;
+    if (budget && !budget_take(t_last, n)) {
+        *throttled = 1;
+        return 0;
+    }
+    if (telem_output == 0 || telem_output(wire_buf, n) == 0) {
+        return 0;
+    }
+    return n;
+}
+
+/**
+ * @brief 立即发出通道中已攒下的样本（不足 batch 个时也发）
+ */
+void Telem_Flush(TelemChannel *ch)
+{
+    uint32_t n;
+    int throttled;
+
+    if (ch->count == 0) {
+        return;
+    }
+    n = send_frame(ch->id, ch->seq, ch->count, ch->size, ch->t_first, ch->t_last,
+                   ch->buf, (uint32_t)ch->count * ch->size, 1, &throttled);
+    ch->seq++;                  // 丢弃的帧也占一个序号，接收端据此统计丢帧
+    ch->count = 0;
+    if (n != 0) {
+        ch->stats.frames++;
+        ch->stats.bytes += n;
+    } else if (throttled) {
+        ch->stats.throttled++;
+    } else {
+        ch->stats.dropped++;
+    }
+}
+
+/**
+ * @brief 提交一个样本（sample 为 size 字节，按格式串的字段顺序、小端）
+ * @param t_ms 采样时刻，毫秒
+ * @return TELEM_OK-已接收，TELEM_SKIPPED-未到采样间隔
+ */
+int Telem_Push(TelemChannel *ch, uint32_t t_ms, const void *sample)
+{
+    ch->stats.offered++;
+    if (ch->period_ms != 0) {
+        if (ch->started && (int32_t)(t_ms - ch->next_due) < 0) {
+            return TELEM_SKIPPED;
+        }
+        // 按计划时刻累加，抖动不改变平均速率；落后超过一个间隔时重新对齐
+        if (ch->started && (int32_t)(t_ms - ch->next_due) < (int32_t)ch->period_ms) {
+            ch->next_due += ch->period_ms;
+        } else {
+            ch->next_due = t_ms + ch->period_ms;
+        }
+    }
+    ch->started = 1;
+    ch->stats.sampled++;
+
+    if (ch->count == 0) {
+        ch->t_first = t_ms;
+    }
+    ch->t_last = t_ms;
+    memcpy(&ch->buf[(uint32_t)ch->count * ch->size], sample, ch->size);
+    if (++ch->count >= ch->batch) {
+        Telem_Flush(ch);
+    }
+    return TELEM_OK;
+}
+
+/**
+ * @brief 把一块数据作为一帧立即发出（样本数 = len / size），通道中已攒下的样本先发出
+ * @details 用于由调用方自己组织内容的通道（如 OLED 镜像的显存段），与普通帧共用序号和字节预算。
+ * @return 写出的字节数，0-被丢弃或 len 超过 TELEM_MAX_PAYLOAD
+ */
+uint32_t Telem_SendBlock(TelemChannel *ch, uint32_t t_ms, const void *data, uint32_t len)
+{
+    uint32_t n;
+    int throttled = 0;
+
+    Telem_Flush(ch);
+    ch->stats.offered++;
+    if (len > TELEM_MAX_PAYLOAD) {
+        ch->stats.dropped++;
+        return 0;
+    }
+    ch->stats.sampled++;
+    n = send_frame(ch->id, ch->seq, (uint8_t)(len / ch->size), ch->size, t_ms, t_ms,
+                   (const uint8_t *)data, len, 1, &throttled);
+    ch->seq++;
+    if (n != 0) {
+        ch->stats.frames++;
+        ch->stats.bytes += n;
+    } else if (throttled) {
+        ch->stats.throttled++;
+    } else {
+        ch->stats.dropped++;
+    }
+    return n;
+}
+
+/**
+ * @brief 发送通道的描述帧（不受字节预算限制），接收端开始接收后或参数修改后调用
+ * @return 写出的字节数，0-发送缓冲区已满
+ */
+uint32_t Telem_Announce(const TelemChannel *ch)
+{
+    uint8_t payload[TELEM_MAX_PAYLOAD];
+    uint32_t n = 0;
+    const char *str[3];
+    int throttled;
+
+    payload[n++] = ch->id;
+    payload[n++] = ch->size;
+    payload[n++] = ch->batch;
+    payload[n++] = (uint8_t)ch->period_ms;
+    payload[n++] = (uint8_t)(ch->period_ms >> 8);
+    str[0] = ch->name;
+    str[1] = ch->fmt;
+    str[2] = ch->fields != 0 ? ch->fields : "";
+    for (uint32_t i = 0; i < 3; i++) {
+        uint32_t len = (uint32_t)strlen(str[i]) + 1;
+
+        if (n + len > sizeof(payload)) {
+            return 0;
+        }
+        memcpy(&payload[n], str[i], len);
+        n += len;
+    }
+    return send_frame(TELEM_SCHEMA_ID, 0, 1, (uint8_t)n, 0, 0, payload, n, 0, &throttled);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file telemetry.h
+ * @brief 遥测数据流：多通道采样按批组帧，CRC-32 校验，COBS 编码后整帧写入串口发送缓冲区
+ * @details 每个通道登记样本格式、每帧样本数（batch）和最小采样间隔（period_ms），
+ *          Telem_Push 按间隔抽样，攒够 batch 个样本组成一帧：
+ *
+ *            通道号(1) 序号(1) 样本数(1) 样本长度(1) 首样本时间 ms(4) 末样本时间 ms(4) 样本... CRC-32(4)   小端
+ *
+ *          CRC-32 与 crc.h 的 CRC32_Calc 相同。整帧经 COBS 编码（不含 0x00），前后各加一个 0x00 分隔，
+ *          由输出函数整帧写入（固件为 Debug_TryWriteRecord：DMA 发送，缓冲区放不下时丢弃整帧，采样循环不等待）。
+ *          文本、二进制日志和遥测帧可以共用一个串口：接收端按 0x00 切分，COBS 解码且 CRC 正确的才是遥测帧。
+ *          序号每帧加 1，接收端据此统计丢帧；样本时间按首末时间线性插值。
+ *
+ *          通道 0 保留给描述帧（Telem_Announce）：通道号、样本长度、batch、period_ms、名字、
+ *          格式串和字段名，接收端（simulator/examples/telem_recv）据此把样本写成 CSV，不需要预先知道格式。
+ *          格式串每个字符一个字段：b/B int8/uint8，h/H int16/uint16，i/I int32/uint32，f float。
+ *
+ *          所有通道共享一个字节预算（令牌桶，按 Telem_Push 的时间补充），超出预算的帧丢弃并计数，
+ *          遥测不会占满串口而让 printf 和日志等待。
+ *          同一组通道只能由一个任务调用 Telem_Push（组帧缓冲区是共用的静态数组）。
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#ifndef TELEM_MAX_PAYLOAD
+#define TELEM_MAX_PAYLOAD   240     ///< 每帧样本数据的最大字节数
+#endif
+#define TELEM_HEADER        12
+#define TELEM_FRAME_MAX     (TELEM_HEADER + TELEM_MAX_PAYLOAD + 4)
+#define TELEM_WIRE_MAX      (TELEM_FRAME_MAX + TELEM_FRAME_MAX / 254 + 1 + 2)   ///< COBS 开销 + 两个分隔符
+#define TELEM_SCHEMA_ID     0       ///< 描述帧的通道号
+#define TELEM_BURST         1024    ///< 字节预算的令牌桶容量
+
+// =============================================================================
+// 返回值
+// =============================================================================
+#define TELEM_OK            0       ///< 样本已接收
+#define TELEM_SKIPPED       1       ///< 未到采样间隔，样本丢弃（抽样）
+#define TELEM_ERR_PARAM     -1      ///< 通道参数错误（格式串长度与样本大小不符等）
+
+/**
+ * @brief 整帧写出，返回 0 表示放不下而丢弃
+ */
+typedef uint32_t (*TelemOutput)(const uint8_t *data, uint32_t len);
+
+/**
+ * @brief 通道统计
+ */
+typedef struct {
+    uint32_t offered;       ///< Telem_Push 调用次数
+    uint32_t sampled;       ///< 按间隔接收的样本数
+    uint32_t frames;        ///< 写出的帧数
+    uint32_t bytes;         ///< 写出的字节数（编码后）
+    uint32_t dropped;       ///< 发送缓冲区满丢弃的帧
+    uint32_t throttled;     ///< 超出字节预算丢弃的帧
+} Telem_Stats;
+
+typedef struct {
+    const char *name;
+    const char *fmt;        ///< 字段类型
+    const char *fields;     ///< 字段名，空格分隔
+    uint8_t     id;         ///< 1~255
+    uint8_t     size;       ///< 样本字节数
+    uint8_t     batch;      ///< 每帧样本数
+    uint16_t    period_ms;  ///< 最小采样间隔，0-每个样本都接收
+
+    // 以下为运行状态
+    uint8_t     seq;
+    uint8_t     count;
+    uint8_t     started;
+    uint32_t    t_first;
+    uint32_t    t_last;
+    uint32_t    next_due;
+    uint8_t     buf[TELEM_MAX_PAYLOAD];
+    Telem_Stats stats;
+} TelemChannel;
+
+void Telem_Init(TelemOutput output, uint32_t budget_bps);
+int Telem_ChannelInit(TelemChannel *ch, uint8_t id, const char *name, const char *fmt, const char *fields,
+                      uint8_t size, uint8_t batch, uint16_t period_ms);
+void Telem_SetPeriod(TelemChannel *ch, uint16_t period_ms);
+int Telem_Due(const TelemChannel *ch, uint32_t t_ms);
+int Telem_Push(TelemChannel *ch, uint32_t t_ms, const void *sample);
+void Telem_Flush(TelemChannel *ch);
+uint32_t Telem_SendBlock(TelemChannel *ch, uint32_t t_ms, const void *data, uint32_t len);
+uint32_t Telem_Announce(const TelemChannel *ch);
+
+uint32_t Telem_FmtSize(const char *fmt);
+uint32_t Telem_CobsEncode(const uint8_t *in, uint32_t len, uint8_t *out);
+int32_t Telem_CobsDecode(const uint8_t *in, uint32_t len, uint8_t *out);
+
+#endif
@@ -0,0 +1,774 @@
+/**
+ * @file ts_store.c
+ * @brief 时序存储实现
+ * @details 段布局（4KB，每级一个环）：
+ *          [段信息 20B][填充 4B][段摘要 TS_Summary 36B][填充 4B][记录][记录]...[0xFF...]
+ *          段信息在开段时写入；段摘要开段时保持擦除态，封存（开下一段）时写入。
+ *          分钟记录 8 字节：[dt 2B][steps 1B][dtemp 1B][dadc 2B][dhumi 1B][check 1B]，
+ *          差分值超出范围时提前开新段，以新样本作为基准。
+ *          小时/日记录就是 TS_Summary（36 字节）。
+ */
+
+#include "ts_store.h"
+#include "flash_layout.h"
+#include <string.h>
+#include <stdio.h>
+#include <stddef.h>
+
+#define TS_MAGIC            0x31535354UL    // "TSS1"
+#define TS_SEG_SIZE         W25Q128_SECTOR_SIZE
+#define TS_HDR_SIZE         64              // 段头大小，记录从这里开始
+#define TS_SUM_OFS          24              // 段摘要在段内的偏移
+#define TS_REBUILD_CHUNK    8               // 重建汇总时每次查询的桶数
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;           // 开段序号，环内连续递增
+    uint32_t base_t;        // 段起始时间，也是差分基准
+    int16_t  base_temp;
+    uint16_t base_adc;
+    uint8_t  base_humi;
+    uint8_t  level;
+    uint8_t  rec_size;
+    uint8_t  check;
+} TS_SegInfo;
+
+typedef struct {
+    uint16_t dt;            // 相对 base_t 的分钟数
+    uint8_t  steps;
+    int8_t   dtemp;
+    int16_t  dadc;
+    int8_t   dhumi;
+    uint8_t  check;
+} TS_RawRecord;
+
+/**
+ * @brief 一级数据的段环
+ */
+typedef struct {
+    uint32_t base;          // Flash 起始地址
+    uint16_t segments;      // 段数
+    uint16_t per_seg;       // 每段记录数
+    uint8_t  level;
+    uint8_t  rec_size;
+    uint8_t  sealed;        // 当前段已封存（掉电恢复后），下次写入开新段
+    uint16_t head;          // 当前段（物理序号）
+    uint16_t tail;          // 最老段（物理序号）
+    uint16_t used;          // 有效段数，0 表示空
+    uint16_t count;         // 当前段已有记录数
+    TS_SegInfo info;        // 当前段信息
+    TS_Summary sum;         // 当前段摘要（封存前在 RAM 中累积）
+    uint32_t last_t;        // 最后一条记录的时间
+} TS_Ring;
+
+typedef void (*TS_Visit)(void *ctx, const TS_Summary *rec);
+
+static TS_Ring ts_raw, ts_hour, ts_day;
+static TS_Summary hour_acc;     // 当前小时，整点后写入小时环
+static TS_Summary day_acc;      // 当天已结束的小时，零点后写入日环
+static uint8_t ts_ready = 0;
+static TS_Stats ts_stats;
+
+// 分段读取记录用的缓冲区
+static uint8_t ts_buf[504] __attribute__((aligned(4)));
+
+// =============================================================================
+// 工具函数
+// =============================================================================
+
+static uint8_t ts_check(const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint8_t c = 0x5A;
+
+    while (len--) {
+        c = (uint8_t)(((c << 1) | (c >> 7)) ^ *p++);
+    }
+    return c;
+}
+
+static uint8_t is_blank(const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    while (len--) {
+        if (*p++ != 0xFF) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void summary_reset(TS_Summary *s, uint32_t t)
+{
+    memset(s, 0, sizeof(*s));
+    s->t = t;
+    s->temp_min = INT16_MAX;
+    s->temp_max = INT16_MIN;
+    s->adc_min = 0xFFFF;
+    s->humi_min = 0xFF;
+}
+
+static void summary_add(TS_Summary *s, const TS_Sample *x)
+{
+    s->samples++;
+    s->steps += x->steps;
+    s->temp_sum += x->temp;
+    s->humi_sum += x->humi;
+    s->adc_sum += x->adc;
+    if (x->temp < s->temp_min) s->temp_min = x->temp;
+    if (x->temp > s->temp_max) s->temp_max = x->temp;
+    if (x->humi < s->humi_min) s->humi_min = x->humi;
+    if (x->humi > s->humi_max) s->humi_max = x->humi;
+    if (x->adc < s->adc_min) s->adc_min = x->adc;
+    if (x->adc > s->adc_max) s->adc_max = x->adc;
+}
+
+static void summary_merge(TS_Summary *d, const TS_Summary *s)
+{
+    if (s->samples == 0) {
+        return;
+    }
+    d->samples += s->samples;
+    d->steps += s->steps;
+    d->temp_sum += s->temp_sum;
+    d->humi_sum += s->humi_sum;
+    d->adc_sum += s->adc_sum;
+    if (s->temp_min < d->temp_min) d->temp_min = s->temp_min;
+    if (s->temp_max > d->temp_max) d->temp_max = s->temp_max;
+    if (s->humi_min < d->humi_min) d->humi_min = s->humi_min;
+    if (s->humi_max > d->humi_max) d->humi_max = s->humi_max;
+    if (s->adc_min < d->adc_min) d->adc_min = s->adc_min;
+    if (s->adc_max > d->adc_max) d->adc_max = s->adc_max;
+}
+
+/**
+ * @brief 差分编码；超出记录能表示的范围时返回 0
+ */
+static uint8_t raw_encode(const TS_SegInfo *info, const TS_Sample *x, TS_RawRecord *r)
+{
+    int32_t dtemp = (int32_t)x->temp - info->base_temp;
+    int32_t dhumi = (int32_t)x->humi - info->base_humi;
+    int32_t dadc = (int32_t)x->adc - info->base_adc;
+
+    if (x->t < info->base_t || x->t - info->base_t >= 0xFFFF ||
+        dtemp < -128 || dtemp > 127 || dhumi < -128 || dhumi > 127 ||
+        dadc < INT16_MIN || dadc > INT16_MAX) {
+        return 0;
+    }
+    r->dt = (uint16_t)(x->t - info->base_t);
+    r->steps = x->steps > 0xFF ? 0xFF : (uint8_t)x->steps;
+    r->dtemp = (int8_t)dtemp;
+    r->dadc = (int16_t)dadc;
+    r->dhumi = (int8_t)dhumi;
+    r->check = ts_check(r, offsetof(TS_RawRecord, check));
+    return 1;
+}
+
+static void raw_decode(const TS_SegInfo *info, const TS_RawRecord *r, TS_Sample *x)
+{
+    x->t = info->base_t + r->dt;
+    x->steps = r->steps;
+    x->temp = (int16_t)(info->base_temp + r->dtemp);
+    x->humi = (uint8_t)(info->base_humi + r->dhumi);
+    x->adc = (uint16_t)(info->base_adc + r->dadc);
+}
+
+// =============================================================================
+// 段访问
+// =============================================================================
+
+static uint32_t seg_addr(const TS_Ring *r, uint16_t phys)
+{
+    return r->base + (uint32_t)phys * TS_SEG_SIZE;
+}
+
+// 逻辑序号（0 = 最老段）转物理序号
+static uint16_t seg_phys(const TS_Ring *r, uint16_t k)
+{
+    return (uint16_t)((r->tail + k) % r->segments);
+}
+
+static int ts_write(uint32_t addr, const void *data, uint16_t len)
+{
+    return W25Q128_BufferWrite((uint8_t *)data, addr, len) == W25Q128_RESULT_OK ? TS_OK : TS_ERR_FLASH;
+}
+
+static uint8_t seg_info_read(const TS_Ring *r, uint16_t phys, TS_SegInfo *info)
+{
+    W25Q128_ReadData((uint8_t *)info, seg_addr(r, phys), sizeof(*info));
+    return info->magic == TS_MAGIC && info->level == r->level && info->rec_size == r->rec_size &&
+           info->check == ts_check(info, offsetof(TS_SegInfo, check));
+}
+
+static uint32_t seg_base_t(const TS_Ring *r, uint16_t k)
+{
+    uint32_t t;
+
+    W25Q128_ReadData((uint8_t *)&t, seg_addr(r, seg_phys(r, k)) + offsetof(TS_SegInfo, base_t), sizeof(t));
+    ts_stats.index_reads++;
+    return t;
+}
+
+/**
+ * @brief 读取段摘要
+ * @return 1 段已封存且摘要有效，0 需要逐条读取
+ */
+static uint8_t seg_summary(const TS_Ring *r, uint16_t phys, TS_Summary *s)
+{
+    if (phys == r->head && !r->sealed) {
+        *s = r->sum;
+        return 1;
+    }
+    W25Q128_ReadData((uint8_t *)s, seg_addr(r, phys) + TS_SUM_OFS, sizeof(*s));
+    return !is_blank(s, sizeof(*s)) && s->check == ts_check(s, offsetof(TS_Summary, check));
+}
+
+/**
+ * @brief 逐条读取段内记录，遇到擦除态结束
+ * @param torn 输出：是否遇到校验失败的记录（掉电时写了一半）
+ * @return 有效记录数
+ */
+static uint16_t seg_scan(TS_Ring *r, uint16_t phys, const TS_SegInfo *info,
+                         TS_Visit visit, void *ctx, uint8_t *torn)
+{
+    uint16_t per_chunk = sizeof(ts_buf) / r->rec_size;
+    uint32_t addr = seg_addr(r, phys) + TS_HDR_SIZE;
+    uint16_t n = 0;
+    TS_Summary rec;
+    TS_Sample x;
+
+    *torn = 0;
+    while (n < r->per_seg) {
+        uint16_t chunk = r->per_seg - n < per_chunk ? r->per_seg - n : per_chunk;
+
+        W25Q128_ReadData(ts_buf, addr, chunk * r->rec_size);
+        addr += chunk * r->rec_size;
+        for (uint16_t i = 0; i < chunk; i++) {
+            const uint8_t *p = ts_buf + i * r->rec_size;
+
+            if (is_blank(p, r->rec_size)) {
+                return n;
+            }
+            if (r->level == TS_LEVEL_RAW) {
+                const TS_RawRecord *raw = (const TS_RawRecord *)p;
+                if (raw->check != ts_check(raw, offsetof(TS_RawRecord, check))) {
+                    *torn = 1;
+                    return n;
+                }
+                raw_decode(info, raw, &x);
+                summary_reset(&rec, x.t);
+                summary_add(&rec, &x);
+            } else {
+                memcpy(&rec, p, sizeof(rec));
+                if (rec.check != ts_check(&rec, offsetof(TS_Summary, check))) {
+                    *torn = 1;
+                    return n;
+                }
+            }
+            visit(ctx, &rec);
+            ts_stats.records_read++;
+            n++;
+        }
+    }
+    return n;
+}
+
+// =============================================================================
+// 段环
+// =============================================================================
+
+static void ring_setup(TS_Ring *r, uint32_t base, uint16_t segments, uint8_t level, uint8_t rec_size)
+{
+    memset(r, 0, sizeof(*r));
+    r->base = base;
+    r->segments = segments;
+    r->level = level;
+    r->rec_size = rec_size;
+    r->per_seg = (TS_SEG_SIZE - TS_HDR_SIZE) / rec_size;
+}
+
+static int ring_seal(TS_Ring *r)
+{
+    if (r->sealed) {
+        return TS_OK;
+    }
+    r->sum.check = ts_check(&r->sum, offsetof(TS_Summary, check));
+    r->sealed = 1;
+    return ts_write(seg_addr(r, r->head) + TS_SUM_OFS, &r->sum, sizeof(r->sum));
+}
+
+/**
+ * @brief 封存当前段并开新段；环满时擦除最老段
+ * @param base 差分基准（汇总环为 NULL）
+ */
+static int ring_open(TS_Ring *r, uint32_t t, const TS_Sample *base)
+{
+    uint16_t phys = 0;
+    uint32_t seq = 1;
+
+    if (r->used > 0) {
+        if (ring_seal(r) != TS_OK) {
+            return TS_ERR_FLASH;
+        }
+        phys = (uint16_t)((r->head + 1) % r->segments);
+        seq = r->info.seq + 1;
+        if (r->used == r->segments) {
+            r->tail = (uint16_t)((r->tail + 1) % r->segments);
+            r->used--;
+            ts_stats.dropped++;
+        }
+    } else {
+        r->tail = 0;
+    }
+
+    if (W25Q128_SectorErase(seg_addr(r, phys)) != W25Q128_RESULT_OK) {
+        return TS_ERR_FLASH;
+    }
+    memset(&r->info, 0, sizeof(r->info));
+    r->info.magic = TS_MAGIC;
+    r->info.seq = seq;
+    r->info.base_t = t;
+    r->info.level = r->level;
+    r->info.rec_size = r->rec_size;
+    if (base != NULL) {
+        r->info.base_temp = base->temp;
+        r->info.base_humi = base->humi;
+        r->info.base_adc = base->adc;
+    }
+    r->info.check = ts_check(&r->info, offsetof(TS_SegInfo, check));
+
+    r->head = phys;
+    r->used++;
+    r->count = 0;
+    r->sealed = 0;
+    summary_reset(&r->sum, t);
+    ts_stats.segments++;
+
+    return ts_write(seg_addr(r, phys), &r->info, sizeof(r->info));
+}
+
+static int ring_write(TS_Ring *r, const void *rec)
+{
+    uint32_t addr = seg_addr(r, r->head) + TS_HDR_SIZE + (uint32_t)r->count * r->rec_size;
+
+    r->count++;
+    return ts_write(addr, rec, r->rec_size);
+}
+
+static int ring_append_summary(TS_Ring *r, TS_Summary *s)
+{
+    int ret;
+
+    if (r->used == 0 || r->sealed || r->count >= r->per_seg) {
+        ret = ring_open(r, s->t, NULL);
+        if (ret != TS_OK) {
+            return ret;
+        }
+    }
+    s->check = ts_check(s, offsetof(TS_Summary, check));
+    ret = ring_write(r, s);
+    summary_merge(&r->sum, s);
+    r->last_t = s->t;
+    ts_stats.rollups++;
+    return ret;
+}
+
+static void head_visit(void *ctx, const TS_Summary *rec)
+{
+    TS_Ring *r = (TS_Ring *)ctx;
+
+    summary_merge(&r->sum, rec);
+    r->last_t = rec->t;
+}
+
+/**
+ * @brief 启动时找出环的头尾并恢复当前段状态
+ * @details 头 = 序号最大的有效段，从头往前数序号连续的段即为有效段
+ */
+static void ring_mount(TS_Ring *r)
+{
+    TS_SegInfo info;
+    TS_Summary sum;
+    uint32_t best_seq = 0;
+    uint8_t torn;
+
+    r->used = 0;
+    for (uint16_t i = 0; i < r->segments; i++) {
+        if (seg_info_read(r, i, &info) && info.seq >= best_seq) {
+            best_seq = info.seq;
+            r->head = i;
+            r->used = 1;
+        }
+    }
+    if (r->used == 0) {
+        return;
+    }
+
+    seg_info_read(r, r->head, &r->info);
+    for (uint32_t seq = best_seq; r->used < r->segments && seq > 1; seq--) {
+        uint16_t prev = (uint16_t)((r->head + r->segments - r->used) % r->segments);
+        if (!seg_info_read(r, prev, &info) || info.seq != seq - 1) {
+            break;
+        }
+        r->used++;
+    }
+    r->tail = (uint16_t)((r->head + r->segments - r->used + 1) % r->segments);
+
+    // 当前段：逐条读取重建摘要；已封存或有坏记录时下次写入开新段
+    summary_reset(&r->sum, r->info.base_t);
+    r->last_t = r->info.base_t;
+    r->sealed = 0;
+    r->count = seg_scan(r, r->head, &r->info, head_visit, r, &torn);
+    if (torn) {
+        r->count = r->per_seg;
+    }
+    W25Q128_ReadData((uint8_t *)&sum, seg_addr(r, r->head) + TS_SUM_OFS, sizeof(sum));
+    r->sealed = !is_blank(&sum, sizeof(sum));
+}
+
+typedef struct {
+    uint32_t from;
+    uint32_t to;
+    uint32_t span;
+    TS_Summary *buckets;
+} TS_QueryCtx;
+
+static void bucket_visit(void *ctx, const TS_Summary *rec)
+{
+    TS_QueryCtx *q = (TS_QueryCtx *)ctx;
+
+    if (rec->t >= q->from && rec->t < q->to) {
+        summary_merge(&q->buckets[(rec->t - q->from) / q->span], rec);
+    }
+}
+
+/**
+ * @brief 在一个环上按桶汇总 [from, from + span * n)
+ * @details 二分查找起始段；整段落在一个桶内的段只读段摘要
+ */
+static void ring_query(TS_Ring *r, uint32_t from, uint32_t span, TS_Summary *buckets, uint16_t n)
+{
+    TS_QueryCtx q = {from, from + span * n, span, buckets};
+    TS_SegInfo info;
+    TS_Summary sum;
+    uint16_t k = 0;
+    uint8_t torn;
+
+    for (uint16_t i = 0; i < n; i++) {
+        summary_reset(&buckets[i], from + span * i);
+    }
+    if (r->used == 0) {
+        return;
+    }
+
+    // 最后一个起始时间不晚于 from 的段
+    for (uint16_t lo = 1, hi = r->used; lo < hi; ) {
+        uint16_t mid = (uint16_t)((lo + hi) / 2);
+        if (seg_base_t(r, mid) <= from) {
+            k = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (; k < r->used; k++) {
+        uint16_t phys = seg_phys(r, k);
+        uint32_t end;
+
+        seg_info_read(r, phys, &info);
+        ts_stats.index_reads++;
+        if (info.base_t >= q.to) {
+            break;
+        }
+        end = (k + 1 < r->used) ? seg_base_t(r, k + 1) : r->last_t + 1;
+        if (end <= from) {
+            continue;
+        }
+        if (info.base_t >= from && end <= q.to &&
+            (info.base_t - from) / span == (end - 1 - from) / span &&
+            seg_summary(r, phys, &sum)) {
+            summary_merge(&buckets[(info.base_t - from) / span], &sum);
+            ts_stats.index_hits++;
+            continue;
+        }
+        seg_scan(r, phys, &info, bucket_visit, &q, &torn);
+        ts_stats.seg_scans++;
+    }
+}
+
+// =============================================================================
+// 汇总
+// =============================================================================
+
+// 用 src 环补写 dst 环在 [from, to) 中缺失的汇总记录
+static int rollup_rebuild(TS_Ring *dst, TS_Ring *src, uint32_t from, uint32_t to, uint32_t span)
+{
+    TS_Summary b[TS_REBUILD_CHUNK];
+
+    while (from < to) {
+        uint32_t n = (to - from) / span;
+        if (n > TS_REBUILD_CHUNK) {
+            n = TS_REBUILD_CHUNK;
+        }
+        ring_query(src, from, span, b, (uint16_t)n);
+        for (uint32_t i = 0; i < n; i++) {
+            if (b[i].samples > 0 && ring_append_summary(dst, &b[i]) != TS_OK) {
+                return TS_ERR_FLASH;
+            }
+        }
+        from += n * span;
+    }
+    return TS_OK;
+}
+
+/**
+ * @brief 启动时恢复小时/日累加器，并补写掉电前没来得及写入的汇总
+ */
+static int rollup_recover(void)
+{
+    uint32_t cur_hour, cur_day, from;
+    int ret;
+
+    summary_reset(&hour_acc, 0);
+    summary_reset(&day_acc, 0);
+    if (ts_raw.used == 0) {
+        return TS_OK;
+    }
+    cur_hour = ts_raw.last_t - ts_raw.last_t % TS_MINUTES_PER_HOUR;
+    cur_day = ts_raw.last_t - ts_raw.last_t % TS_MINUTES_PER_DAY;
+
+    from = ts_hour.used ? ts_hour.last_t + TS_MINUTES_PER_HOUR : cur_day;
+    ret = rollup_rebuild(&ts_hour, &ts_raw, from, cur_hour, TS_MINUTES_PER_HOUR);
+    if (ret != TS_OK) {
+        return ret;
+    }
+    from = ts_day.used ? ts_day.last_t + TS_MINUTES_PER_DAY : cur_day;
+    ret = rollup_rebuild(&ts_day, &ts_hour, from, cur_day, TS_MINUTES_PER_DAY);
+    if (ret != TS_OK) {
+        return ret;
+    }
+
+    ring_query(&ts_raw, cur_hour, TS_MINUTES_PER_HOUR, &hour_acc, 1);
+    if (cur_hour > cur_day) {
+        ring_query(&ts_hour, cur_day, cur_hour - cur_day, &day_acc, 1);
+    } else {
+        day_acc.t = cur_day;
+    }
+    return TS_OK;
+}
+
+// 整点写小时汇总，零点写日汇总
+static int rollup_feed(const TS_Sample *x)
+{
+    uint32_t h = x->t - x->t % TS_MINUTES_PER_HOUR;
+    uint32_t d = x->t - x->t % TS_MINUTES_PER_DAY;
+    int ret = TS_OK;
+
+    if (hour_acc.samples && hour_acc.t != h) {
+        ret = ring_append_summary(&ts_hour, &hour_acc);
+        summary_merge(&day_acc, &hour_acc);
+        summary_reset(&hour_acc, h);
+    }
+    if (day_acc.samples && day_acc.t != d) {
+        if (ring_append_summary(&ts_day, &day_acc) != TS_OK) {
+            ret = TS_ERR_FLASH;
+        }
+        summary_reset(&day_acc, d);
+    }
+    if (!hour_acc.samples) {
+        hour_acc.t = h;
+    }
+    if (!day_acc.samples) {
+        day_acc.t = d;
+    }
+    summary_add(&hour_acc, x);
+    return ret;
+}
+
+// =============================================================================
+// 接口
+// =============================================================================
+
+/**
+ * @brief 挂载三个环并恢复汇总状态（首次调用 TS_Append/TS_Query 时自动执行）
+ */
+int TS_Init(void)
+{
+    SPI1_Init();
+    ring_setup(&ts_raw, FLASH_TS_RAW_BASE, FLASH_TS_RAW_SEGMENTS, TS_LEVEL_RAW, sizeof(TS_RawRecord));
+    ring_setup(&ts_hour, FLASH_TS_HOUR_BASE, FLASH_TS_HOUR_SEGMENTS, TS_LEVEL_HOUR, sizeof(TS_Summary));
+    ring_setup(&ts_day, FLASH_TS_DAY_BASE, FLASH_TS_DAY_SEGMENTS, TS_LEVEL_DAY, sizeof(TS_Summary));
+    ring_mount(&ts_raw);
+    ring_mount(&ts_hour);
+    ring_mount(&ts_day);
+    ts_ready = 1;
+    return rollup_recover();
+}
+
+static int ts_ensure_ready(void)
+{
+    return ts_ready ? TS_OK : TS_Init();
+}
+
+/**
+ * @brief 追加一分钟的采样（通常每分钟调用一次，缺失的分钟直接跳过）
+ */
+int TS_Append(const TS_Sample *sample)
+{
+    TS_RawRecord rec;
+    int ret = ts_ensure_ready();
+
+    if (ret != TS_OK) {
+        return ret;
+    }
+    if (sample == NULL) {
+        return TS_ERR_PARAM;
+    }
+    if (ts_raw.used > 0 && sample->t <= ts_raw.last_t) {
+        return TS_ERR_ORDER;
+    }
+
+    if (ts_raw.used == 0 || ts_raw.sealed || ts_raw.count >= ts_raw.per_seg ||
+        !raw_encode(&ts_raw.info, sample, &rec)) {
+        ret = ring_open(&ts_raw, sample->t, sample);
+        if (ret != TS_OK) {
+            return ret;
+        }
+        raw_encode(&ts_raw.info, sample, &rec);
+    }
+    ret = ring_write(&ts_raw, &rec);
+    summary_add(&ts_raw.sum, sample);
+    ts_raw.last_t = sample->t;
+    ts_stats.appends++;
+
+    if (rollup_feed(sample) != TS_OK) {
+        ret = TS_ERR_FLASH;
+    }
+    return ret;
+}
+
+/**
+ * @brief 按桶汇总查询
+ * @param level   TS_LEVEL_RAW/HOUR/DAY，或 TS_LEVEL_AUTO
+ * @param from    起始时间（分钟）
+ * @param span    桶宽（分钟），buckets[i] 覆盖 [from + i*span, from + (i+1)*span)
+ * @param buckets 输出，samples 为 0 的桶没有数据
+ * @param n       桶数
+ * @note 汇总级别的记录整条计入其起始时间所在的桶，span 应为该级别粒度的整数倍
+ */
+int TS_Query(uint8_t level, uint32_t from, uint32_t span, TS_Summary *buckets, uint16_t n)
+{
+    TS_Summary pending;
+    int ret = ts_ensure_ready();
+
+    if (ret != TS_OK) {
+        return ret;
+    }
+    if (buckets == NULL || n == 0 || span == 0) {
+        return TS_ERR_PARAM;
+    }
+    if (level == TS_LEVEL_AUTO) {
+        if (from % TS_MINUTES_PER_DAY == 0 && span % TS_MINUTES_PER_DAY == 0) {
+            level = TS_LEVEL_DAY;
+        } else if (from % TS_MINUTES_PER_HOUR == 0 && span % TS_MINUTES_PER_HOUR == 0) {
+            level = TS_LEVEL_HOUR;
+        } else {
+            level = TS_LEVEL_RAW;
+        }
+    }
+    ts_stats.queries++;
+
+    switch (level) {
+    case TS_LEVEL_RAW:
+        ring_query(&ts_raw, from, span, buckets, n);
+        return TS_OK;
+    case TS_LEVEL_HOUR:
+        ring_query(&ts_hour, from, span, buckets, n);
+        pending = hour_acc;
+        break;
+    case TS_LEVEL_DAY:
+        ring_query(&ts_day, from, span, buckets, n);
+        pending = day_acc;
+        if (hour_acc.samples) {
+            summary_merge(&pending, &hour_acc);
+        }
+        break;
+    default:
+        return TS_ERR_PARAM;
+    }
+
+    // 还没写入 Flash 的当前小时/当天
+    if (pending.samples && pending.t >= from && pending.t < from + span * n) {
+        summary_merge(&buckets[(pending.t - from) / span], &pending);
+    }
+    return TS_OK;
+}
+
+/**
+ * @brief 某一级别保存的时间范围（含尚未写入的汇总）；没有数据时均为 0
+ */
+void TS_Range(uint8_t level, uint32_t *first, uint32_t *last)
+{
+    TS_Ring *r = level == TS_LEVEL_DAY ? &ts_day : level == TS_LEVEL_HOUR ? &ts_hour : &ts_raw;
+    const TS_Summary *pending = level == TS_LEVEL_DAY ? &day_acc : level == TS_LEVEL_HOUR ? &hour_acc : NULL;
+
+    *first = 0;
+    *last = 0;
+    if (ts_ensure_ready() != TS_OK) {
+        return;
+    }
+    if (r->used > 0) {
+        *first = seg_base_t(r, 0);
+        *last = r->last_t;
+    }
+    if (pending != NULL && (pending->samples || (level == TS_LEVEL_DAY && hour_acc.samples))) {
+        if (r->used == 0) {
+            *first = pending->t;
+        }
+        *last = pending->t;
+    }
+}
+
+/**
+ * @brief RTC 日期时间转为分钟时间戳
+ * @param year 2000 年起的年份（0-99，与 RTC_DateTypeDef 一致）
+ */
+uint32_t TS_MakeTime(uint8_t year, uint8_t mon, uint8_t day, uint8_t hour, uint8_t min)
+{
+    static const uint16_t month_days[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+    uint32_t days;
+
+    if (mon < 1 || mon > 12 || day < 1) {
+        return 0;
+    }
+    days = (uint32_t)year * 365 + (year + 3) / 4 + month_days[mon - 1] + day - 1;
+    if (mon > 2 && year % 4 == 0) {
+        days++;
+    }
+    return days * TS_MINUTES_PER_DAY + (uint32_t)hour * TS_MINUTES_PER_HOUR + min;
+}
+
+void TS_GetStats(TS_Stats *stats)
+{
+    *stats = ts_stats;
+}
+
+void TS_ResetStats(void)
+{
+    memset(&ts_stats, 0, sizeof(ts_stats));
+}
+
+void TS_PrintStats(void)
+{
+    printf("ts: raw %u/%u segs, hour %u/%u, day %u/%u; appends %lu, rollups %lu, "
+           "segments %lu (dropped %lu)\r\n",
+           ts_raw.used, ts_raw.segments, ts_hour.used, ts_hour.segments, ts_day.used, ts_day.segments,
+           (unsigned long)ts_stats.appends, (unsigned long)ts_stats.rollups,
+           (unsigned long)ts_stats.segments, (unsigned long)ts_stats.dropped);
+    printf("ts: queries %lu, index reads %lu, index hits %lu, segment scans %lu, records read %lu\r\n",
+           (unsigned long)ts_stats.queries, (unsigned long)ts_stats.index_reads,
+           (unsigned long)ts_stats.index_hits, (unsigned long)ts_stats.seg_scans,
+           (unsigned long)ts_stats.records_read);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file ts_store.h
+ * @brief W25Q128 原始分区上的时序存储（每分钟步数、温湿度、ADC）
+ * @details 三级数据，每级是 4KB 段组成的环，写满后擦除最老的段（环形保留）：
+ *          - 分钟级：8 字节定长记录，相对段头基准值做差分编码
+ *          - 小时级/日级：TS_Summary 定长记录，由分钟数据在整点/零点自动汇总
+ *          每个段头在封存时写入整段的 TS_Summary（样本数、步数和、最小/最大值），
+ *          段头的起始时间构成按时间排序的索引：
+ *          - 查询先二分查找段头定位起点
+ *          - 整段落在一个桶内时直接合并段头摘要，不读记录
+ *          - 只有跨桶的段才逐条读取
+ *
+ *          时间单位为分钟，从 2000-01-01 00:00 起算（见 TS_MakeTime）。
+ *          样本时间必须递增。与 KV 一样共用 SPI1，存储服务运行时只能在存储任务中调用。
+ */
+
+#ifndef TS_STORE_H
+#define TS_STORE_H
+
+#include <stdint.h>
+
+// 数据级别
+#define TS_LEVEL_RAW        0       ///< 分钟
+#define TS_LEVEL_HOUR       1       ///< 小时汇总
+#define TS_LEVEL_DAY        2       ///< 日汇总
+#define TS_LEVEL_AUTO       0xFF    ///< 按查询的起点与桶宽选择最粗的可用级别
+
+#define TS_MINUTES_PER_HOUR 60
+#define TS_MINUTES_PER_DAY  1440
+
+// 返回值
+#define TS_OK               0
+#define TS_ERR_ORDER        1       ///< 样本时间不晚于上一条
+#define TS_ERR_FLASH        2
+#define TS_ERR_PARAM        3
+
+/**
+ * @brief 一分钟的采样
+ */
+typedef struct {
+    uint32_t t;         ///< 时间（分钟）
+    uint16_t steps;     ///< 本分钟步数（存储时饱和到 255）
+    int16_t  temp;      ///< 温度，0.1°C
+    uint8_t  humi;      ///< 湿度，%
+    uint16_t adc;       ///< ADC 电压，mV
+} TS_Sample;
+
+/**
+ * @brief 一段时间的汇总
+ * @details 同时用作小时/日记录、段头摘要和查询结果桶。samples 为 0 表示没有数据。
+ */
+typedef struct {
+    uint32_t t;         ///< 起始时间（分钟）
+    uint32_t samples;   ///< 分钟样本数
+    uint32_t steps;     ///< 步数和
+    int32_t  temp_sum;  ///< 温度和（平均值 = temp_sum / samples）
+    uint32_t humi_sum;
+    uint32_t adc_sum;
+    int16_t  temp_min;
+    int16_t  temp_max;
+    uint16_t adc_min;
+    uint16_t adc_max;
+    uint8_t  humi_min;
+    uint8_t  humi_max;
+    uint8_t  reserved;
+    uint8_t  check;     ///< 校验字节，发现掉电时写了一半的记录
+} TS_Summary;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t appends;       ///< 写入的分钟样本数
+    uint32_t rollups;       ///< 写入的小时/日汇总数
+    uint32_t segments;      ///< 新开的段数（每段一次擦除）
+    uint32_t dropped;       ///< 环满后丢弃的最老段数
+    uint32_t queries;       ///< 查询次数
+    uint32_t index_reads;   ///< 查询读取的段头数
+    uint32_t index_hits;    ///< 只用段头摘要、未读记录的段数
+    uint32_t seg_scans;     ///< 逐条读取记录的段数
+    uint32_t records_read;  ///< 读取的记录数
+} TS_Stats;
+
+int  TS_Init(void);
+int  TS_Append(const TS_Sample *sample);
+int  TS_Query(uint8_t level, uint32_t from, uint32_t span, TS_Summary *buckets, uint16_t n);
+void TS_Range(uint8_t level, uint32_t *first, uint32_t *last);
+
+uint32_t TS_MakeTime(uint8_t year, uint8_t mon, uint8_t day, uint8_t hour, uint8_t min);
+
+void TS_GetStats(TS_Stats *stats);
+void TS_ResetStats(void);
+void TS_PrintStats(void);
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file uart_rx_ring.c
+ * @brief 串口 DMA 循环接收的读位置跟踪实现
+ */
+
+#include "uart_rx_ring.h"
+#include <string.h>
+
+void UartRxRing_Init(UartRxRing *ring, uint8_t *buf, uint16_t size, UartRxSink sink, void *ctx)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->buf = buf;
+    ring->size = size;
+    ring->sink = sink;
+    ring->ctx = ctx;
+}
+
+static void deliver(UartRxRing *ring, uint16_t from, uint16_t to)
+{
+    uint32_t len = (uint32_t)(to - from);
+    uint32_t n = ring->sink(&ring->buf[from], len, ring->ctx);
+
+    ring->stats.bytes += len;
+    ring->stats.chunks++;
+    if (n < len) {
+        ring->stats.dropped += len - n;
+    }
+}
+
+/**
+ * @brief 取出上次位置到 DMA 当前写位置之间的数据
+ * @param ndtr DMA 剩余计数（DMA_GetCurrDataCounter），循环模式下为 size..1
+ * @return 本次取出的字节数
+ */
+uint32_t UartRxRing_Poll(UartRxRing *ring, uint16_t ndtr)
+{
+    uint16_t pos = (uint16_t)(ring->size - ndtr);
+    uint16_t last = ring->last;
+
+    // NDTR 到 0 后硬件立即重装为 size，这里 pos 不会等于 size；防御一下
+    if (pos >= ring->size) {
+        pos = 0;
+    }
+    if (pos == last) {
+        return 0;
+    }
+    ring->last = pos;
+    if (pos > last) {
+        deliver(ring, last, pos);
+        return (uint32_t)(pos - last);
+    }
+    deliver(ring, last, ring->size);
+    if (pos > 0) {
+        deliver(ring, 0, pos);
+    }
+    return (uint32_t)(ring->size - last + pos);
+}
@@ -0,0 +1,52 @@
+/**
+ * @file uart_rx_ring.h
+ * @brief 串口 DMA 循环接收的读位置跟踪
+ * @details DMA 以循环模式把串口数据写入 ring，写位置由 NDTR（剩余计数）得到：pos = size - NDTR。
+ *          在 IDLE（一帧结束）、半传输（HT）和传输完成（TC）中断里调用 UartRxRing_Poll，
+ *          把上次读位置到当前写位置之间的数据（回绕时分两段）交给 sink，一次中断交出一整块，
+ *          而不是每个字节一次中断。HT/TC 保证连续收数据时每半圈至少取一次，
+ *          只要中断在半圈时间内得到响应（256 字节 ring、921600bps 下为 1.39ms），DMA 就不会追上读位置。
+ *
+ *          sink 一般是 FreeRTOS 流缓冲区（xStreamBufferSendFromISR），返回实际接收的字节数，
+ *          没放下的部分计入 dropped。调用 UartRxRing_Poll 的中断必须是同一个优先级，
+ *          不会互相嵌套（流缓冲区只允许一个写入方）。
+ *          本模块与硬件无关，主机模拟器（uart_rx_bench.c）用同一份代码。
+ */
+
+#ifndef UART_RX_RING_H
+#define UART_RX_RING_H
+
+#include <stdint.h>
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t bytes;         ///< 从 ring 取出的字节数
+    uint32_t chunks;        ///< 交给 sink 的块数（回绕时一次取数计两块）
+    uint32_t idle;          ///< IDLE 中断次数
+    uint32_t half;          ///< 半传输中断次数
+    uint32_t full;          ///< 传输完成中断次数
+    uint32_t dropped;       ///< sink 放不下而丢弃的字节（消费者来不及取）
+    uint32_t overrun;       ///< 串口 ORE（DMA 没来得及读 DR）
+    uint32_t errors;        ///< 噪声/帧错误、DMA 传输错误
+} UartRx_Stats;
+
+/**
+ * @brief 收到的数据块交给 sink，返回实际接收的字节数
+ */
+typedef uint32_t (*UartRxSink)(const uint8_t *data, uint32_t len, void *ctx);
+
+typedef struct {
+    uint8_t     *buf;       ///< DMA 循环缓冲区
+    uint16_t     size;
+    uint16_t     last;      ///< 上次取到的位置
+    UartRxSink   sink;
+    void        *ctx;
+    UartRx_Stats stats;
+} UartRxRing;
+
+void UartRxRing_Init(UartRxRing *ring, uint8_t *buf, uint16_t size, UartRxSink sink, void *ctx);
+uint32_t UartRxRing_Poll(UartRxRing *ring, uint16_t ndtr);
+
+#endif
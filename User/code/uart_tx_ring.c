@@ -0,0 +1,90 @@
+/**
+ * @file uart_tx_ring.c
+ * @brief 串口发送环形缓冲区实现
+ */
+
+#include "uart_tx_ring.h"
+#include <string.h>
+
+// 先写数据再发布 head（先发送完再发布 tail），Cortex-M4 上是 DMB，主机上是完整屏障
+#if defined(__arm__)
+#define RING_BARRIER()  __asm volatile ("dmb" ::: "memory")
+#else
+#define RING_BARRIER()  __sync_synchronize()
+#endif
+
+/**
+ * @param size 缓冲区长度，必须是 2 的幂
+ * @return 0-成功，-1-长度不是 2 的幂
+ */
+int UartTxRing_Init(UartTxRing *ring, uint8_t *buf, uint32_t size)
+{
+    if (size == 0 || (size & (size - 1)) != 0) {
+        return -1;
+    }
+    ring->buf = buf;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    return 0;
+}
+
+uint32_t UartTxRing_Used(const UartTxRing *ring)
+{
+    return ring->head - ring->tail;
+}
+
+uint32_t UartTxRing_Free(const UartTxRing *ring)
+{
+    return ring->mask + 1 - (ring->head - ring->tail);
+}
+
+/**
+ * @brief 写入数据（生产者），放不下的部分不写
+ * @return 写入的字节数
+ */
+uint32_t UartTxRing_Write(UartTxRing *ring, const uint8_t *data, uint32_t len)
+{
+    uint32_t head = ring->head;
+    uint32_t space = ring->mask + 1 - (head - ring->tail);
+    uint32_t idx = head & ring->mask;
+    uint32_t first;
+
+    if (len > space) {
+        len = space;
+    }
+    first = ring->mask + 1 - idx;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&ring->buf[idx], data, first);
+    memcpy(ring->buf, data + first, len - first);
+    RING_BARRIER();
+    ring->head = head + len;
+    return len;
+}
+
+/**
+ * @brief tail 处可连续读取的一段（消费者），不超过缓冲区末尾
+ * @return 长度，0-缓冲区为空
+ */
+uint32_t UartTxRing_Span(const UartTxRing *ring, const uint8_t **data)
+{
+    uint32_t tail = ring->tail;
+    uint32_t used = ring->head - tail;
+    uint32_t idx = tail & ring->mask;
+    uint32_t to_end = ring->mask + 1 - idx;
+
+    RING_BARRIER();     // 读到 head 之后再读数据
+    *data = &ring->buf[idx];
+    return used < to_end ? used : to_end;
+}
+
+/**
+ * @brief 释放已发送的数据（消费者）
+ */
+void UartTxRing_Consume(UartTxRing *ring, uint32_t len)
+{
+    RING_BARRIER();
+    ring->tail += len;
+}
@@ -0,0 +1,32 @@
+/**
+ * @file uart_tx_ring.h
+ * @brief 串口发送环形缓冲区（单生产者/单消费者，无锁）
+ * @details 生产者（写 printf 数据的一方）只改 head，消费者（DMA 发送完成中断）只改 tail，
+ *          两者都是自由增长的 32 位计数，长度为 2 的幂时用 & (size-1) 取下标，不浪费判满字节。
+ *          消费者用 UartTxRing_Span 拿到 tail 处的连续一段，直接作为 DMA 源地址发送，
+ *          发送完成后 UartTxRing_Consume 释放；回绕处分两次发送，不拷贝到中转缓冲区。
+ *
+ *          多个任务同时写时生产者不再唯一，调用方要在 UartTxRing_Write 外加短临界区（debug.c）。
+ *          发布 head/tail 前有内存屏障，主机模拟器（uart_tx_bench.c）用两个线程验证同一份代码。
+ */
+
+#ifndef UART_TX_RING_H
+#define UART_TX_RING_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t          *buf;
+    uint32_t          mask;     ///< size - 1，size 为 2 的幂
+    volatile uint32_t head;     ///< 已写入的字节总数（生产者）
+    volatile uint32_t tail;     ///< 已发送的字节总数（消费者）
+} UartTxRing;
+
+int UartTxRing_Init(UartTxRing *ring, uint8_t *buf, uint32_t size);
+uint32_t UartTxRing_Write(UartTxRing *ring, const uint8_t *data, uint32_t len);
+uint32_t UartTxRing_Free(const UartTxRing *ring);
+uint32_t UartTxRing_Used(const UartTxRing *ring);
+uint32_t UartTxRing_Span(const UartTxRing *ring, const uint8_t **data);
+void UartTxRing_Consume(UartTxRing *ring, uint32_t len);
+
+#endif
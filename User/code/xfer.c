@@ -0,0 +1,355 @@
+/**
+ * @file xfer.c
+ * @brief 串口批量传输协议实现（见 xfer.h）
+ */
+
+#include "xfer.h"
+#include "crc.h"
+#include <string.h>
+
+static void put16(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint8_t header_check(const uint8_t *h)
+{
+    uint8_t sum = 0;
+
+    for (uint32_t i = 0; i < XFER_HEADER - 1; i++) {
+        sum += h[i];
+    }
+    return (uint8_t)~sum;
+}
+
+// =============================================================================
+// 组帧
+// =============================================================================
+
+/**
+ * @brief 写帧头（数据由调用方放在 frame + XFER_HEADER 处）
+ * @return XFER_HEADER
+ */
+uint32_t Xfer_Header(uint8_t *frame, uint8_t type, uint16_t xid, uint32_t offset, uint32_t len)
+{
+    frame[0] = XFER_SYNC;
+    frame[1] = type;
+    put16(&frame[2], len);
+    put32(&frame[4], offset);
+    put16(&frame[8], xid);
+    frame[10] = 0;
+    frame[11] = header_check(frame);
+    return XFER_HEADER;
+}
+
+/**
+ * @brief 在数据之后追加 CRC-32
+ * @return 整帧长度
+ */
+uint32_t Xfer_Seal(uint8_t *frame)
+{
+    uint32_t len = XFER_HEADER + (uint32_t)(frame[2] | (frame[3] << 8));
+
+    put32(&frame[len], CRC32_Calc(frame, len));
+    return len + 4;
+}
+
+uint32_t Xfer_Build(uint8_t *frame, uint8_t type, uint16_t xid, uint32_t offset, const void *payload, uint32_t len)
+{
+    Xfer_Header(frame, type, xid, offset, len);
+    if (len > 0) {
+        memcpy(&frame[XFER_HEADER], payload, len);
+    }
+    return Xfer_Seal(frame);
+}
+
+// =============================================================================
+// 解析
+// =============================================================================
+
+void XferParser_Init(XferParser *p, uint8_t *buf, uint32_t cap, XferFrameHandler on_frame, XferTextHandler on_text,
+                     void *ctx)
+{
+    memset(p, 0, sizeof(*p));
+    p->buf = buf;
+    p->cap = cap;
+    p->on_frame = on_frame;
+    p->on_text = on_text;
+    p->ctx = ctx;
+}
+
+static void emit_text(XferParser *p, const uint8_t *data, uint32_t len)
+{
+    if (p->on_text != 0 && len > 0) {
+        p->on_text(p->ctx, data, len);
+    }
+}
+
+static void shift(XferParser *p, uint32_t len)
+{
+    p->n -= len;
+    memmove(p->buf, p->buf + len, p->n);
+}
+
+// 缓冲区以同步字节开头时检查帧头和 CRC；不成立时交出一个字节，从下一个同步字节重新开始
+static void drain(XferParser *p)
+{
+    while (p->n > 0) {
+        uint32_t len, total;
+
+        if (p->buf[0] != XFER_SYNC) {
+            const uint8_t *sync = memchr(p->buf, XFER_SYNC, p->n);
+            uint32_t skip = sync != 0 ? (uint32_t)(sync - p->buf) : p->n;
+
+            emit_text(p, p->buf, skip);
+            shift(p, skip);
+            continue;
+        }
+        if (p->n < XFER_HEADER) {
+            return;
+        }
+        len = (uint32_t)(p->buf[2] | (p->buf[3] << 8));
+        total = XFER_HEADER + len + 4;
+        if (header_check(p->buf) != p->buf[11] || total > p->cap) {
+            p->bad++;
+            emit_text(p, p->buf, 1);
+            shift(p, 1);
+            continue;
+        }
+        if (p->n < total) {
+            return;
+        }
+        if (get32(&p->buf[total - 4]) != CRC32_Calc(p->buf, total - 4)) {
+            p->bad++;
+            emit_text(p, p->buf, 1);
+            shift(p, 1);
+            continue;
+        }
+        {
+            XferFrame f;
+
+            f.type = p->buf[1];
+            f.len = (uint16_t)len;
+            f.offset = get32(&p->buf[4]);
+            f.xid = (uint16_t)(p->buf[8] | (p->buf[9] << 8));
+            f.payload = &p->buf[XFER_HEADER];
+            p->frames++;
+            p->on_frame(p->ctx, &f);
+        }
+        shift(p, total);
+    }
+}
+
+/**
+ * @brief 输入收到的数据块（任意切分）
+ */
+void XferParser_Feed(XferParser *p, const uint8_t *data, uint32_t len)
+{
+    while (len > 0) {
+        uint32_t n;
+
+        // 帧之间的文本不经过缓冲区
+        if (p->n == 0 && data[0] != XFER_SYNC) {
+            const uint8_t *sync = memchr(data, XFER_SYNC, len);
+
+            n = sync != 0 ? (uint32_t)(sync - data) : len;
+            emit_text(p, data, n);
+            data += n;
+            len -= n;
+            continue;
+        }
+        n = p->cap - p->n < len ? p->cap - p->n : len;
+        memcpy(p->buf + p->n, data, n);
+        p->n += n;
+        data += n;
+        len -= n;
+        drain(p);
+    }
+}
+
+// =============================================================================
+// 设备端
+// =============================================================================
+
+static void send_control(XferServer *s, uint8_t type, uint32_t offset, const void *payload, uint32_t len)
+{
+    uint8_t frame[XFER_HEADER + 4 + 4];
+
+    s->port.tx_control(s->port.ctx, frame, Xfer_Build(frame, type, s->xid, offset, payload, len));
+}
+
+static void send_error(XferServer *s, int err)
+{
+    s->stats.errors++;
+    send_control(s, XFER_ERROR, (uint32_t)-err, 0, 0);
+}
+
+static void session_close(XferServer *s)
+{
+    if (s->open) {
+        s->port.close(s->port.ctx);
+        s->open = 0;
+    }
+}
+
+static void on_open(XferServer *s, const XferFrame *f)
+{
+    char name[XFER_NAME_MAX];
+    uint8_t info[3];
+    uint32_t size;
+    int ret;
+
+    session_close(s);
+    s->xid = f->xid;
+    if (f->len == 0 || f->len >= sizeof(name)) {
+        send_error(s, XFER_ERR_NOENT);
+        return;
+    }
+    memcpy(name, f->payload, f->len);
+    name[f->len] = '\0';
+    ret = s->port.open(s->port.ctx, name, &size);
+    if (ret != XFER_OK) {
+        send_error(s, ret);
+        return;
+    }
+    if (f->offset > size) {
+        s->port.close(s->port.ctx);
+        send_error(s, XFER_ERR_RANGE);
+        return;
+    }
+    s->open = 1;
+    s->size = size;
+    s->base = s->next = s->high = f->offset;
+    s->rewound = 0;
+    s->last_progress = s->now;
+    s->stats.sessions++;
+    put16(info, XFER_CHUNK);
+    info[2] = s->window;
+    send_control(s, XFER_INFO, size, info, sizeof(info));
+}
+
+static void on_ack(XferServer *s, const XferFrame *f)
+{
+    uint32_t a = f->offset;
+
+    if (!s->open || f->xid != s->xid) {
+        return;
+    }
+    if (a > s->base && a <= s->high) {
+        s->base = a;
+        s->last_progress = s->now;
+        s->rewound = 0;
+        if (s->next < s->base) {
+            s->next = s->base;
+        }
+        if (s->base == s->size) {
+            s->stats.completed++;
+            session_close(s);
+        }
+    } else if (a == s->base && s->next > s->base && !s->rewound) {
+        // 上位机收到了不按序的块：从已确认处重发
+        s->next = s->base;
+        s->rewound = 1;
+        s->last_progress = s->now;
+        s->stats.rewinds++;
+    }
+}
+
+static void on_request(void *ctx, const XferFrame *f)
+{
+    XferServer *s = ctx;
+
+    s->last_rx = s->now;
+    switch (f->type) {
+    case XFER_OPEN:
+        on_open(s, f);
+        break;
+    case XFER_ACK:
+        on_ack(s, f);
+        break;
+    case XFER_CLOSE:
+        session_close(s);
+        s->finished = 1;
+        break;
+    default:
+        break;
+    }
+}
+
+void XferServer_Init(XferServer *s, const XferPort *port, uint32_t now_ms)
+{
+    memset(s, 0, sizeof(*s));
+    s->port = *port;
+    s->window = XFER_WINDOW;
+    s->now = s->last_rx = now_ms;
+    XferParser_Init(&s->parser, s->rx_buf, sizeof(s->rx_buf), on_request, 0, s);
+}
+
+/**
+ * @brief 输入上位机发来的数据（传输模式下串口收到的全部字节）
+ */
+void XferServer_Input(XferServer *s, const uint8_t *data, uint32_t len, uint32_t now_ms)
+{
+    s->now = now_ms;
+    XferParser_Feed(&s->parser, data, len);
+}
+
+/**
+ * @brief 在窗口和发送缓冲区允许的范围内发送数据块，处理超时
+ * @return XFER_RUNNING 或 XFER_FINISHED
+ */
+int XferServer_Poll(XferServer *s, uint32_t now_ms)
+{
+    s->now = now_ms;
+    if (s->finished || now_ms - s->last_rx >= XFER_IDLE_MS) {
+        session_close(s);
+        return XFER_FINISHED;
+    }
+    if (!s->open) {
+        return XFER_RUNNING;
+    }
+    if (s->next > s->base && now_ms - s->last_progress >= XFER_RTO_MS) {
+        s->next = s->base;
+        s->last_progress = now_ms;
+        s->stats.timeouts++;
+    }
+    while (s->next < s->size && s->next - s->base < (uint32_t)s->window * XFER_CHUNK) {
+        uint32_t len = s->size - s->next < XFER_CHUNK ? s->size - s->next : XFER_CHUNK;
+        uint8_t *frame = s->port.tx_buffer(s->port.ctx);
+
+        if (frame == 0) {
+            break;
+        }
+        // 从存储直接读到帧缓冲区的数据区，DMA 从同一个缓冲区发送
+        if (s->port.read(s->port.ctx, s->next, frame + XFER_HEADER, len) != XFER_OK) {
+            session_close(s);
+            send_error(s, XFER_ERR_IO);
+            break;
+        }
+        Xfer_Header(frame, XFER_DATA, s->xid, s->next, len);
+        s->port.tx_send(s->port.ctx, frame, Xfer_Seal(frame));
+        if (s->next < s->high) {
+            s->stats.resent += len;
+        } else {
+            s->stats.bytes += len;
+            s->high = s->next + len;
+        }
+        s->stats.frames++;
+        s->next += len;
+    }
+    return XFER_RUNNING;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file xfer.h
+ * @brief 串口批量传输协议：把文件或 Flash 原始分区从设备下载到上位机
+ * @details 请求和应答都是同一种帧（小端）：
+ *
+ *            0xA5 类型(1) 数据长度(2) 偏移(4) 会话号(2) 保留(1) 头校验(1) 数据... CRC-32(4)
+ *
+ *          头校验为前 11 字节之和取反，CRC-32（crc.h 的 CRC32_Calc）覆盖帧头和数据。
+ *          帧之外的字节（其它任务的 printf）由 XferParser 原样交出；头校验或 CRC 不对时丢弃一个字节重新同步。
+ *
+ *          上位机发 OPEN（数据为名字，偏移为续传起点），设备回 INFO（偏移为总大小）或 ERROR，
+ *          然后按滑动窗口连续发送 DATA（每帧最多 XFER_CHUNK 字节，偏移为该块在文件中的位置）：
+ *          未确认的数据不超过 XFER_WINDOW 帧。上位机每收到按序的一块回 ACK（偏移为下一个期望的字节），
+ *          收到不按序的块时重复上一个 ACK；设备收到重复 ACK 或 XFER_RTO_MS 内没有进展时从已确认处重发
+ *          （回退 N 帧）。重发的数据重新从存储读取，设备不保留已发送的数据，窗口大小不占 RAM。
+ *          上位机中断后用已收到的字节数作为 OPEN 的偏移即可续传。CLOSE 结束会话。
+ *
+ *          本模块不依赖 FreeRTOS：存储读取和串口发送由 XferPort 提供（固件见 ui/xfer_service.c），
+ *          主机端的客户端和模拟链路（simulator/examples/xfer_*）编译同一份代码。
+ */
+
+#ifndef XFER_H
+#define XFER_H
+
+#include <stdint.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#define XFER_SYNC           0xA5
+#define XFER_HEADER         12
+#ifndef XFER_CHUNK
+#define XFER_CHUNK          1024    ///< DATA 帧最大数据字节数（921600bps 下约 11ms）
+#endif
+#define XFER_FRAME_MAX      (XFER_HEADER + XFER_CHUNK + 4)
+#ifndef XFER_WINDOW
+#define XFER_WINDOW         8       ///< 未确认的 DATA 帧数上限（8KB，可覆盖约 85ms 的往返时间）
+#endif
+#define XFER_RTO_MS         300     ///< 没有新的确认时从已确认处重发
+#define XFER_IDLE_MS        10000   ///< 这么久没有收到请求时结束传输模式
+#define XFER_NAME_MAX       64
+
+// 帧类型
+#define XFER_OPEN           0x01    ///< 上位机：打开，偏移为续传起点，数据为名字
+#define XFER_ACK            0x02    ///< 上位机：确认，偏移为下一个期望的字节
+#define XFER_CLOSE          0x03    ///< 上位机：结束会话，退出传输模式
+#define XFER_INFO           0x81    ///< 设备：OPEN 成功，偏移为总大小，数据为块大小(2) 窗口(1)
+#define XFER_DATA           0x82    ///< 设备：数据块
+#define XFER_ERROR          0x83    ///< 设备：失败，偏移为错误码（XFER_ERR_* 取反）
+
+// =============================================================================
+// 返回值
+// =============================================================================
+#define XFER_OK             0
+#define XFER_ERR_NOENT      -1      ///< 没有这个文件或分区
+#define XFER_ERR_IO         -2      ///< 读取失败
+#define XFER_ERR_RANGE      -3      ///< 续传偏移超过大小
+#define XFER_ERR_BUSY       -4      ///< 文件正被写入等
+
+#define XFER_RUNNING        0       ///< XferServer_Poll：传输模式继续
+#define XFER_FINISHED       1       ///< XferServer_Poll：收到 CLOSE 或空闲超时
+
+/**
+ * @brief 解析出的一帧（payload 指向解析器内部，回调返回后失效）
+ */
+typedef struct {
+    uint8_t        type;
+    uint16_t       len;
+    uint32_t       offset;
+    uint16_t       xid;
+    const uint8_t *payload;
+} XferFrame;
+
+typedef void (*XferFrameHandler)(void *ctx, const XferFrame *frame);
+typedef void (*XferTextHandler)(void *ctx, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief 字节流解析器
+ */
+typedef struct {
+    uint8_t         *buf;
+    uint32_t         cap;           ///< 缓冲区大小，决定能接收的最长帧
+    uint32_t         n;
+    XferFrameHandler on_frame;
+    XferTextHandler  on_text;       ///< 帧之外的字节（可为 NULL）
+    void            *ctx;
+    uint32_t         frames;
+    uint32_t         bad;           ///< 头校验或 CRC 错误（重新同步）的次数
+} XferParser;
+
+/**
+ * @brief 设备端的存储和串口接口
+ */
+typedef struct {
+    int      (*open)(void *ctx, const char *name, uint32_t *size);                  ///< XFER_OK 或 XFER_ERR_*
+    int      (*read)(void *ctx, uint32_t offset, uint8_t *buf, uint32_t len);       ///< 读满 len 字节
+    void     (*close)(void *ctx);
+    uint8_t *(*tx_buffer)(void *ctx);       ///< 空闲的帧缓冲区（XFER_FRAME_MAX 字节），都在发送中时返回 NULL
+    void     (*tx_send)(void *ctx, uint8_t *frame, uint32_t len);   ///< 直接发送 tx_buffer 的缓冲区，发完后归还
+    void     (*tx_control)(void *ctx, const uint8_t *frame, uint32_t len);  ///< 整帧发送短应答（拷贝）
+    void      *ctx;
+} XferPort;
+
+/**
+ * @brief 设备端统计
+ */
+typedef struct {
+    uint32_t sessions;      ///< OPEN 成功的次数
+    uint32_t completed;     ///< 全部确认的次数
+    uint32_t frames;        ///< 发送的 DATA 帧
+    uint32_t bytes;         ///< 第一次发送的数据字节
+    uint32_t resent;        ///< 重发的数据字节
+    uint32_t timeouts;      ///< 超时重发次数
+    uint32_t rewinds;       ///< 重复 ACK 触发的重发次数
+    uint32_t errors;        ///< 回 ERROR 的次数
+} Xfer_Stats;
+
+#define XFER_REQUEST_MAX    (XFER_HEADER + XFER_NAME_MAX + 4)  ///< 设备只接收短请求
+
+typedef struct {
+    XferPort   port;
+    XferParser parser;
+    uint8_t    rx_buf[XFER_REQUEST_MAX];
+    uint8_t    open;
+    uint8_t    rewound;     ///< 本轮已因重复 ACK 回退过，已确认处前进之前不再回退
+    uint8_t    finished;
+    uint8_t    window;      ///< 未确认帧数上限，XferServer_Init 设为 XFER_WINDOW
+    uint16_t   xid;
+    uint32_t   size;
+    uint32_t   base;        ///< 已确认
+    uint32_t   next;        ///< 下一个要发送
+    uint32_t   high;        ///< 发送过的最高位置
+    uint32_t   now;
+    uint32_t   last_progress;
+    uint32_t   last_rx;
+    Xfer_Stats stats;
+} XferServer;
+
+uint32_t Xfer_Header(uint8_t *frame, uint8_t type, uint16_t xid, uint32_t offset, uint32_t len);
+uint32_t Xfer_Seal(uint8_t *frame);
+uint32_t Xfer_Build(uint8_t *frame, uint8_t type, uint16_t xid, uint32_t offset, const void *payload, uint32_t len);
+
+void XferParser_Init(XferParser *p, uint8_t *buf, uint32_t cap, XferFrameHandler on_frame, XferTextHandler on_text,
+                     void *ctx);
+void XferParser_Feed(XferParser *p, const uint8_t *data, uint32_t len);
+
+void XferServer_Init(XferServer *s, const XferPort *port, uint32_t now_ms);
+void XferServer_Input(XferServer *s, const uint8_t *data, uint32_t len, uint32_t now_ms);
+int XferServer_Poll(XferServer *s, uint32_t now_ms);
+
+#endif
@@ -0,0 +1,502 @@
+/**
+ * @file dir_index.c
+ * @brief 目录索引实现
+ */
+
+#include "dir_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 变更记录环：序号 s 的记录在 pending[s % DIR_INDEX_PENDING]，各索引各自记录处理到的序号
+typedef struct {
+    char     path[DIR_INDEX_PATH_MAX];
+    uint32_t size;      ///< CHANGE_SIZE 时的文件大小
+    uint8_t  kind;
+} PendingChange;
+
+#define CHANGE_STAT     0       // 不知道结果，刷新时 f_stat
+#define CHANGE_SIZE     1       // 文件存在，大小已知
+#define CHANGE_REMOVED  2       // 文件已删除
+
+static PendingChange pending[DIR_INDEX_PENDING];
+static uint32_t notify_seq = 0;
+
+// =============================================================================
+// 路径与文件名
+// =============================================================================
+
+static char to_upper(char c)
+{
+    return (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+}
+
+/**
+ * @brief "NAME.EXT" 转为目录项格式 "NAME    EXT"
+ * @return 0-成功，-1-不是合法的 8.3 短文件名
+ */
+static int pack_name(const char *s, size_t len, char out[DIR_INDEX_NAME_LEN])
+{
+    size_t i = 0, n = 0;
+
+    memset(out, ' ', DIR_INDEX_NAME_LEN);
+    while (i < len && s[i] != '.') {
+        if (n >= 8) {
+            return -1;
+        }
+        out[n++] = to_upper(s[i++]);
+    }
+    if (n == 0) {
+        return -1;      // "."、".." 和空名
+    }
+    if (i < len) {
+        i++;            // 跳过 '.'
+        for (n = 8; i < len; i++) {
+            if (n >= DIR_INDEX_NAME_LEN || s[i] == '.') {
+                return -1;
+            }
+            out[n++] = to_upper(s[i]);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 规范化路径："0:/logs/a.csv"、"0:LOGS/A.CSV"、"logs/a.csv" 都得到目录 "0:/LOGS"
+ * @param dir 输出目录（DIR_INDEX_PATH_MAX 字节），根目录为 "0:"
+ * @param name 输出最后一级的短文件名；为 NULL 时整条路径都是目录
+ * @return 0-成功，-1-路径过长或文件名不合法
+ */
+static int split_path(const char *path, char *dir, char *name)
+{
+    const char *p = path, *last = NULL;
+    size_t n = 2;
+
+    dir[0] = '0';
+    if (p[0] >= '0' && p[0] <= '9' && p[1] == ':') {
+        dir[0] = p[0];
+        p += 2;
+    }
+    dir[1] = ':';
+
+    while (*p != '\0') {
+        const char *seg;
+        size_t len;
+
+        while (*p == '/') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        seg = p;
+        while (*p != '\0' && *p != '/') {
+            p++;
+        }
+        len = (size_t)(p - seg);
+        if (name != NULL) {
+            // 最后一级留给文件名，之前的一级补进目录
+            if (last != NULL) {
+                size_t l = strcspn(last, "/");
+                if (n + 1 + l >= DIR_INDEX_PATH_MAX) {
+                    return -1;
+                }
+                dir[n++] = '/';
+                for (size_t i = 0; i < l; i++) {
+                    dir[n++] = to_upper(last[i]);
+                }
+            }
+            last = seg;
+        } else {
+            if (n + 1 + len >= DIR_INDEX_PATH_MAX) {
+                return -1;
+            }
+            dir[n++] = '/';
+            for (size_t i = 0; i < len; i++) {
+                dir[n++] = to_upper(seg[i]);
+            }
+        }
+    }
+    dir[n] = '\0';
+
+    if (name != NULL) {
+        return last != NULL ? pack_name(last, strcspn(last, "/"), name) : -1;
+    }
+    return 0;
+}
+
+// '*' 匹配任意串、'?' 匹配一个字符，名字为 "NAME.EXT" 形式
+static int pattern_match(const char *pat, const char *name)
+{
+    while (*pat != '\0') {
+        if (*pat == '*') {
+            while (*pat == '*') {
+                pat++;
+            }
+            if (*pat == '\0') {
+                return 1;
+            }
+            for (; *name != '\0'; name++) {
+                if (pattern_match(pat, name)) {
+                    return 1;
+                }
+            }
+            return 0;
+        }
+        if (*name == '\0' || (*pat != '?' && to_upper(*pat) != *name)) {
+            return 0;
+        }
+        pat++;
+        name++;
+    }
+    return *name == '\0';
+}
+
+static uint32_t name_hash(const char name[DIR_INDEX_NAME_LEN])
+{
+    uint32_t h = 2166136261u;
+
+    for (int i = 0; i < DIR_INDEX_NAME_LEN; i++) {
+        h = (h ^ (uint8_t)name[i]) * 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief 表项转为显示用的 "NAME.EXT"
+ */
+void DirIndex_FormatName(const DirIndexEntry *e, char out[DIR_INDEX_DISPLAY_LEN])
+{
+    int n = 0;
+
+    for (int i = 0; i < 8 && e->name[i] != ' '; i++) {
+        out[n++] = e->name[i];
+    }
+    if (e->name[8] != ' ') {
+        out[n++] = '.';
+        for (int i = 8; i < DIR_INDEX_NAME_LEN && e->name[i] != ' '; i++) {
+            out[n++] = e->name[i];
+        }
+    }
+    out[n] = '\0';
+}
+
+// =============================================================================
+// 有序表
+// =============================================================================
+
+// 排序键：目录在前，再按目录项格式的文件名（即先主名后扩展名）
+static int key_cmp(uint8_t is_dir, const char *name, const DirIndexEntry *e)
+{
+    uint8_t e_dir = (e->attr & AM_DIR) != 0;
+
+    if (is_dir != e_dir) {
+        return is_dir ? -1 : 1;
+    }
+    return memcmp(name, e->name, DIR_INDEX_NAME_LEN);
+}
+
+static int entry_cmp(const void *a, const void *b)
+{
+    const DirIndexEntry *x = (const DirIndexEntry *)a;
+
+    return key_cmp((x->attr & AM_DIR) != 0, x->name, (const DirIndexEntry *)b);
+}
+
+/**
+ * @brief 二分查找
+ * @param pos 未找到时输出插入位置
+ * @return 找到的下标，-1-不存在
+ */
+static int locate(const DirIndex *idx, uint8_t is_dir, const char *name, uint16_t *pos)
+{
+    uint16_t lo = 0, hi = idx->count;
+
+    while (lo < hi) {
+        uint16_t mid = (uint16_t)((lo + hi) / 2);
+        int c = key_cmp(is_dir, name, &idx->entries[mid]);
+
+        if (c == 0) {
+            *pos = mid;
+            return mid;
+        }
+        if (c < 0) {
+            hi = mid;
+        } else {
+            lo = (uint16_t)(mid + 1);
+        }
+    }
+    *pos = lo;
+    return -1;
+}
+
+static int locate_any(const DirIndex *idx, const char *name, uint16_t *pos)
+{
+    int i = locate(idx, 0, name, pos);
+
+    return i >= 0 ? i : locate(idx, 1, name, pos);
+}
+
+static void remove_at(DirIndex *idx, uint16_t i)
+{
+    memmove(&idx->entries[i], &idx->entries[i + 1], (size_t)(idx->count - i - 1) * sizeof(DirIndexEntry));
+    idx->count--;
+    idx->stats.removed++;
+}
+
+static void insert_entry(DirIndex *idx, const char *name, const FILINFO *fno)
+{
+    uint16_t pos;
+    DirIndexEntry *e;
+
+    if (idx->count >= idx->capacity) {
+        idx->truncated = 1;
+        return;
+    }
+    locate(idx, (fno->fattrib & AM_DIR) != 0, name, &pos);
+    memmove(&idx->entries[pos + 1], &idx->entries[pos], (size_t)(idx->count - pos) * sizeof(DirIndexEntry));
+    e = &idx->entries[pos];
+    memcpy(e->name, name, DIR_INDEX_NAME_LEN);
+    e->hash = name_hash(name);
+    e->size = (fno->fattrib & AM_DIR) ? 0 : (uint32_t)fno->fsize;
+    e->attr = fno->fattrib;
+    idx->count++;
+    idx->stats.inserted++;
+}
+
+// =============================================================================
+// 接口
+// =============================================================================
+
+/**
+ * @brief 初始化索引（不访问存储器，第一次 DirIndex_Refresh 时扫描目录）
+ * @param path 目录，如 "0:/logs" 或根目录 "0:"
+ * @param pattern f_findfirst 模式，NULL 表示 "*"
+ * @param entries 表，capacity 个表项（每项 sizeof(DirIndexEntry) = 20 字节）
+ */
+void DirIndex_Init(DirIndex *idx, const char *path, const char *pattern,
+                   DirIndexEntry *entries, uint16_t capacity)
+{
+    memset(idx, 0, sizeof(*idx));
+    if (split_path(path, idx->path, NULL) != 0) {
+        idx->path[0] = '\0';
+    }
+    idx->pattern = pattern != NULL ? pattern : "*";
+    idx->entries = entries;
+    idx->capacity = capacity;
+}
+
+/**
+ * @brief 整目录重扫（f_findfirst/f_findnext）后排序
+ */
+FRESULT DirIndex_Rescan(DirIndex *idx)
+{
+    DIR dir;
+    FILINFO fno;
+    FRESULT fr;
+    char name[DIR_INDEX_NAME_LEN];
+
+    idx->valid = 0;
+    idx->count = 0;
+    idx->truncated = 0;
+    idx->seen = notify_seq;
+    if (idx->path[0] == '\0') {
+        return FR_INVALID_NAME;
+    }
+
+    fr = f_findfirst(&dir, &fno, idx->path, idx->pattern);
+    while (fr == FR_OK && fno.fname[0] != '\0') {
+        idx->stats.scanned++;
+        if (pack_name(fno.fname, strlen(fno.fname), name) == 0) {
+            if (idx->count < idx->capacity) {
+                DirIndexEntry *e = &idx->entries[idx->count++];
+                memcpy(e->name, name, DIR_INDEX_NAME_LEN);
+                e->hash = name_hash(name);
+                e->size = (fno.fattrib & AM_DIR) ? 0 : (uint32_t)fno.fsize;
+                e->attr = fno.fattrib;
+            } else {
+                idx->truncated = 1;
+            }
+        }
+        fr = f_findnext(&dir, &fno);
+    }
+    f_closedir(&dir);
+    if (fr != FR_OK) {
+        idx->count = 0;
+        return fr;
+    }
+
+    qsort(idx->entries, idx->count, sizeof(DirIndexEntry), entry_cmp);
+    idx->valid = 1;
+    idx->stats.full_scans++;
+    return FR_OK;
+}
+
+// 处理一条变更：更新、插入或删除表项，结果未知时先 f_stat；不在本目录的变更忽略
+static FRESULT apply_change(DirIndex *idx, const PendingChange *c)
+{
+    const char *path = c->path;
+    char dir[DIR_INDEX_PATH_MAX];
+    char name[DIR_INDEX_NAME_LEN];
+    char display[DIR_INDEX_DISPLAY_LEN];
+    DirIndexEntry key;
+    FILINFO fno;
+    FRESULT fr;
+    uint16_t pos;
+    int i;
+
+    if (split_path(path, dir, name) != 0 || strcmp(dir, idx->path) != 0) {
+        return FR_OK;
+    }
+    memcpy(key.name, name, DIR_INDEX_NAME_LEN);
+    DirIndex_FormatName(&key, display);
+    if (!pattern_match(idx->pattern, display)) {
+        return FR_OK;
+    }
+
+    idx->stats.updates++;
+    if (c->kind == CHANGE_SIZE) {
+        // 写文件的一方已给出大小，不访问存储器；新建和写过的文件 FatFs 都会置 AM_ARC
+        i = locate(idx, 0, name, &pos);
+        if (i >= 0) {
+            idx->entries[i].size = c->size;
+            idx->entries[i].attr |= AM_ARC;
+            return FR_OK;
+        }
+        fno.fsize = c->size;
+        fno.fattrib = AM_ARC;
+        insert_entry(idx, name, &fno);
+        return FR_OK;
+    }
+    if (c->kind == CHANGE_REMOVED) {
+        fr = FR_NO_FILE;
+    } else {
+        idx->stats.stat_calls++;
+        fr = f_stat(path, &fno);
+    }
+    i = locate_any(idx, name, &pos);
+    if (fr == FR_NO_FILE || fr == FR_NO_PATH) {
+        if (i >= 0) {
+            remove_at(idx, (uint16_t)i);
+        }
+        return FR_OK;
+    }
+    if (fr != FR_OK) {
+        return fr;
+    }
+    if (i >= 0 && ((idx->entries[i].attr ^ fno.fattrib) & AM_DIR) == 0) {
+        idx->entries[i].size = (fno.fattrib & AM_DIR) ? 0 : (uint32_t)fno.fsize;
+        idx->entries[i].attr = fno.fattrib;
+        return FR_OK;
+    }
+    if (i >= 0) {
+        remove_at(idx, (uint16_t)i);    // 文件变成了同名目录（或反之），换到另一组
+    }
+    insert_entry(idx, name, &fno);
+    return FR_OK;
+}
+
+/**
+ * @brief 刷新索引：处理上次刷新以来登记的变更，落后太多或从未扫描时整目录重扫
+ * @details 截断的表（truncated）增量删除后不会补回多出的文件，此时也整目录重扫
+ */
+FRESULT DirIndex_Refresh(DirIndex *idx)
+{
+    FRESULT fr = FR_OK;
+    uint8_t removed_from_full;
+
+    if (!idx->valid || notify_seq - idx->seen > DIR_INDEX_PENDING) {
+        return DirIndex_Rescan(idx);
+    }
+    removed_from_full = 0;
+    while (idx->seen != notify_seq && fr == FR_OK) {
+        uint16_t before = idx->count;
+
+        fr = apply_change(idx, &pending[idx->seen % DIR_INDEX_PENDING]);
+        idx->seen++;
+        if (idx->truncated && idx->count < before) {
+            removed_from_full = 1;
+        }
+    }
+    if (fr != FR_OK || removed_from_full) {
+        return DirIndex_Rescan(idx);
+    }
+    return FR_OK;
+}
+
+/**
+ * @brief 是否有未处理的变更（只读序号，可在任意任务中调用，决定要不要经存储任务刷新）
+ */
+uint8_t DirIndex_Stale(const DirIndex *idx)
+{
+    return !idx->valid || idx->seen != notify_seq;
+}
+
+/**
+ * @brief 按文件名查找（"NAME.EXT"，不含目录），只查 RAM 表
+ * @return 表项下标，-1-不存在
+ */
+int DirIndex_Find(DirIndex *idx, const char *name)
+{
+    char packed[DIR_INDEX_NAME_LEN];
+    uint16_t pos;
+
+    idx->stats.lookups++;
+    if (pack_name(name, strlen(name), packed) != 0) {
+        return -1;
+    }
+    return locate_any(idx, packed, &pos);
+}
+
+const DirIndexEntry *DirIndex_Get(const DirIndex *idx, uint16_t i)
+{
+    return i < idx->count ? &idx->entries[i] : NULL;
+}
+
+static void notify(const char *path, uint32_t size, uint8_t kind)
+{
+    PendingChange *c;
+
+    if (strlen(path) >= DIR_INDEX_PATH_MAX) {
+        DirIndex_NotifyAll();
+        return;
+    }
+    c = &pending[notify_seq % DIR_INDEX_PENDING];
+    strcpy(c->path, path);
+    c->size = size;
+    c->kind = kind;
+    notify_seq++;
+}
+
+/**
+ * @brief 登记文件的变更，结果未知（刷新时 f_stat，在存储任务中调用）
+ * @param path 文件路径，与 f_open 使用的相同
+ */
+void DirIndex_Notify(const char *path)
+{
+    notify(path, 0, CHANGE_STAT);
+}
+
+/**
+ * @brief 登记文件的创建或写入，大小已知（刷新时不访问存储器）
+ * @param size 关闭或同步后的文件大小，即 f_size()
+ */
+void DirIndex_NotifySize(const char *path, uint32_t size)
+{
+    notify(path, size, CHANGE_SIZE);
+}
+
+/**
+ * @brief 登记文件已删除（f_unlink 成功后调用）
+ */
+void DirIndex_NotifyRemoved(const char *path)
+{
+    notify(path, 0, CHANGE_REMOVED);
+}
+
+/**
+ * @brief 变更无法逐个登记时（格式化、批量测试）让所有索引下次刷新时整目录重扫
+ */
+void DirIndex_NotifyAll(void)
+{
+    notify_seq += DIR_INDEX_PENDING + 1;
+}
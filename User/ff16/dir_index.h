@@ -0,0 +1,88 @@
+/**
+ * @file dir_index.h
+ * @brief 目录索引：排好序的 RAM 目录表，供文件浏览界面翻页
+ * @details 每翻一页都用 f_readdir 从头扫描目录扇区，目录里有几百个日志文件时
+ *          翻到后面要读几十个扇区，而且拿到的是目录项的物理顺序。本模块：
+ *          - 用 f_findfirst/f_findnext（FF_USE_FIND）按模式扫描一次目录，
+ *            每个文件在 RAM 表中占 20 字节：短文件名哈希、大小、属性和 8.3 短文件名
+ *          - 表按“目录在前、再按文件名”排序，翻页和按名查找（二分）不再访问存储器
+ *          - 写文件的地方登记变更，刷新时只更新、插入或删除对应表项；变更多于
+ *            DIR_INDEX_PENDING 条时才整目录重扫。写入方知道结果时用 DirIndex_NotifySize
+ *            （关闭/同步后的大小）和 DirIndex_NotifyRemoved，刷新不访问存储器；
+ *            DirIndex_Notify 只给路径，刷新时要 f_stat，而 f_stat 也是从头扫描目录，
+ *            在几百个文件的目录里一次约等于半次重扫
+ *
+ *          只支持短文件名（FF_USE_LFN=0）。FILINFO 不提供首簇号，打开文件仍按名字查目录，
+ *          所以表中不存首簇；哈希 + 大小足以判断表项是否变化。
+ *          DirIndex_Refresh 会访问 FatFs，与其它文件操作一样在存储任务中执行（Storage_Call）；
+ *          登记变更的函数也只在存储任务中调用。绕过存储服务直接访问 FatFs 的测试功能
+ *          （filesystem_test.c、storage_bench.c）结束时调用 DirIndex_NotifyAll()。
+ */
+
+#ifndef DIR_INDEX_H
+#define DIR_INDEX_H
+
+#include "ff.h"
+#include <stdint.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#define DIR_INDEX_PATH_MAX      32      ///< 目录路径与变更路径的最大长度（含结尾 0）
+#define DIR_INDEX_PENDING       8       ///< 变更记录环的长度，落后更多时整目录重扫
+#define DIR_INDEX_NAME_LEN      11      ///< 8.3 短文件名，目录项格式（空格填充，不含点）
+#define DIR_INDEX_DISPLAY_LEN   13      ///< "NAME.EXT" + 结尾 0
+
+/**
+ * @brief 表项（20 字节）
+ */
+typedef struct {
+    uint32_t hash;                      ///< name 的 FNV-1a
+    uint32_t size;                      ///< 文件大小（目录为 0）
+    char     name[DIR_INDEX_NAME_LEN];  ///< 8.3 短文件名，如 "LOG00012CSV"
+    uint8_t  attr;                      ///< FILINFO.fattrib（AM_DIR 等）
+} DirIndexEntry;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t full_scans;    ///< 整目录扫描次数
+    uint32_t scanned;       ///< 整目录扫描读到的目录项数
+    uint32_t updates;       ///< 增量更新处理的变更数
+    uint32_t stat_calls;    ///< 其中需要 f_stat 的变更数
+    uint32_t inserted;      ///< 增量插入的表项
+    uint32_t removed;       ///< 增量删除的表项
+    uint32_t lookups;       ///< DirIndex_Find 次数
+} DirIndex_Stats;
+
+/**
+ * @brief 目录索引
+ */
+typedef struct {
+    char           path[DIR_INDEX_PATH_MAX];    ///< 规范化后的目录，如 "0:/LOGS"，根目录为 "0:"
+    const char    *pattern;         ///< f_findfirst 模式，如 "*.CSV"
+    DirIndexEntry *entries;         ///< 调用方提供的表
+    uint16_t       capacity;
+    uint16_t       count;
+    uint8_t        valid;           ///< 0: 下次刷新整目录重扫
+    uint8_t        truncated;       ///< 目录中匹配的文件多于 capacity，多出的没有进表
+    uint32_t       seen;            ///< 已处理到的变更序号
+    DirIndex_Stats stats;
+} DirIndex;
+
+void DirIndex_Init(DirIndex *idx, const char *path, const char *pattern,
+                   DirIndexEntry *entries, uint16_t capacity);
+FRESULT DirIndex_Refresh(DirIndex *idx);
+uint8_t DirIndex_Stale(const DirIndex *idx);
+FRESULT DirIndex_Rescan(DirIndex *idx);
+int DirIndex_Find(DirIndex *idx, const char *name);
+const DirIndexEntry *DirIndex_Get(const DirIndex *idx, uint16_t i);
+void DirIndex_FormatName(const DirIndexEntry *e, char out[DIR_INDEX_DISPLAY_LEN]);
+
+void DirIndex_Notify(const char *path);
+void DirIndex_NotifySize(const char *path, uint32_t size);
+void DirIndex_NotifyRemoved(const char *path);
+void DirIndex_NotifyAll(void);
+
+#endif
@@ -10,15 +10,45 @@
 #include "ff.h"			/* Basic definitions of FatFs */
 #include "diskio.h" /* Declarations FatFs MAI */
 #include "spi.h"		/* SPI and W25Q128 functions */
+#include "diskio_cache.h"	/* LRU sector read cache */
+#include "flash_layout.h"	/* W25Q128 partition map */
+#include "sdio_sd.h"		/* SD card over SDIO */
+#include <string.h>
 
 /* Example: Mapping of physical drive number for each drive */
 #define DEV_FLASH 0 /* Map W25Q128 to physical drive 0 */
 #define DEV_MMC 1		/* Map MMC/SD card to physical drive 1 */
 #define DEV_USB 2		/* Map USB MSD to physical drive 2 */
 
+/* FatFs 扇区大小：512（一个擦除块 8 个扇区）或 4096（与擦除块一致） */
+#define DISK_SECTOR_SIZE FF_MAX_SS
+#if DISK_SECTOR_SIZE != 512 && DISK_SECTOR_SIZE != W25Q128_SECTOR_SIZE
+#error "W25Q128 diskio supports FF_MAX_SS of 512 or 4096 only"
+#endif
+
+/* 卷只占 FatFs 分区，越界访问会破坏后面的原始分区（KV 等） */
+#define DISK_SECTOR_COUNT (FLASH_FATFS_SIZE / DISK_SECTOR_SIZE)
+#define DISK_RANGE_OK(sector, count) ((sector) < DISK_SECTOR_COUNT && (count) <= DISK_SECTOR_COUNT - (sector))
+
 /* Disk Status */
 static volatile DSTATUS Stat = STA_NOINIT; /* Physical drive status */
 
+/* SD 卡驱动返回值转换为 DRESULT */
+static DRESULT mmc_result(int rc)
+{
+	switch (rc)
+	{
+	case SD_OK:
+		return RES_OK;
+	case SD_ERR_NOT_READY:
+		return RES_NOTRDY;
+	case SD_ERR_PARAM:
+		return RES_PARERR;
+	default:
+		return RES_ERROR;
+	}
+}
+
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
 /*-----------------------------------------------------------------------*/
@@ -36,9 +66,7 @@ DSTATUS disk_status(
 		return stat;
 
 	case DEV_MMC:
-		// result = MMC_disk_status();
-		// translate the reslut code here
-		return STA_NOINIT;
+		return SD_IsReady() ? 0 : STA_NOINIT;
 
 	case DEV_USB:
 		// result = USB_disk_status();
@@ -70,6 +98,7 @@ DSTATUS disk_initialize(
 		if (jedec_id == 0xEF4018)
 		{
 			stat = 0; // Successfully initialized
+			disk_cache_init(); // 介质重新初始化，旧缓存作废
 		}
 		else
 		{
@@ -80,9 +109,8 @@ DSTATUS disk_initialize(
 		return stat;
 
 	case DEV_MMC:
-		// result = MMC_disk_initialize();
-		// translate the reslut code here
-		return STA_NOINIT;
+		// 无卡时 CMD8/CMD55 超时，很快返回
+		return SD_Init() == SD_OK ? 0 : STA_NOINIT;
 
 	case DEV_USB:
 		// result = USB_disk_initialize();
@@ -109,17 +137,29 @@ DRESULT disk_read(
 	switch (pdrv)
 	{
 	case DEV_FLASH:
-		// Convert sector to byte address (assuming 512-byte sectors)
-		bytes_to_read = count * 512;
-		W25Q128_ReadData(buff, sector * 512, bytes_to_read);
+		if (!DISK_RANGE_OK(sector, count))
+		{
+			return RES_PARERR;
+		}
+
+		// 单扇区读多为 FAT/目录访问，先查缓存
+		if (count == 1 && disk_cache_lookup(sector, buff))
+		{
+			return RES_OK;
+		}
+
+		// Convert sector to byte address
+		bytes_to_read = count * DISK_SECTOR_SIZE;
+		W25Q128_ReadData(buff, FLASH_FATFS_BASE + sector * DISK_SECTOR_SIZE, bytes_to_read);
+		if (count == 1)
+		{
+			disk_cache_fill(sector, buff);
+		}
 		res = RES_OK;
 		return res;
 
 	case DEV_MMC:
-		// translate the arguments here
-		// result = MMC_disk_read(buff, sector, count);
-		// translate the reslut code here
-		return RES_PARERR;
+		return mmc_result(SD_ReadBlocks(buff, sector, count));
 
 	case DEV_USB:
 		// translate the arguments here
@@ -137,46 +177,229 @@ DRESULT disk_read(
 
 #if FF_FS_READONLY == 0
 
+/**
+ * @brief 按页编程，跳过内容与 Flash 现有数据相同的页
+ * @param data 待写数据
+ * @param old  Flash 现有数据（擦除后为全 0xFF，传 NULL）
+ * @param addr 起始地址
+ * @param len  长度（不跨 4KB 擦除块）
+ */
+static DRESULT flash_program_pages(const BYTE *data, const BYTE *old, uint32_t addr, uint32_t len)
+{
+    while (len > 0) {
+        uint32_t n = W25Q128_PAGE_SIZE - addr % W25Q128_PAGE_SIZE;
+        uint32_t i;
+        if (n > len) n = len;
+
+        for (i = 0; i < n; i++) {
+            if (data[i] != (old ? old[i] : 0xFF)) break;
+        }
+        if (i < n && W25Q128_WritePage((uint8_t*)data, addr, (uint16_t)n) != W25Q128_RESULT_OK) {
+            return RES_ERROR;
+        }
+        data += n;
+        if (old) old += n;
+        addr += n;
+        len -= n;
+    }
+    return RES_OK;
+}
+
+#if DISK_SECTOR_SIZE == W25Q128_SECTOR_SIZE
+
+/* 逐页比较用的缓冲区，4KB 扇区模式不再需要整块缓冲 */
+static BYTE page_buf[W25Q128_PAGE_SIZE] __attribute__((aligned(4)));
+
+/**
+ * @brief 写一个完整擦除块（= 一个 FatFs 扇区）
+ * @details 逐页读出旧数据：只需把 1 变 0 时跳过擦除，只编程有变化的页；
+ *          否则擦除一次后编程 16 页（全 0xFF 的页跳过）
+ */
+static DRESULT flash_write_block(const BYTE *data, uint32_t block)
+{
+    uint16_t dirty = 0;     // 有变化的页，bit n 对应第 n 页
+    uint32_t p, i;
+
+    for (p = 0; p < W25Q128_SECTOR_SIZE / W25Q128_PAGE_SIZE; p++) {
+        const BYTE *src = data + p * W25Q128_PAGE_SIZE;
+
+        W25Q128_ReadData(page_buf, block + p * W25Q128_PAGE_SIZE, W25Q128_PAGE_SIZE);
+        for (i = 0; i < W25Q128_PAGE_SIZE; i++) {
+            if ((page_buf[i] & src[i]) != src[i]) break;
+        }
+        if (i < W25Q128_PAGE_SIZE) {
+            // 需要把 0 变 1，只能擦除整块
+            if (W25Q128_SectorErase(block) != W25Q128_RESULT_OK) {
+                return RES_ERROR;
+            }
+            return flash_program_pages(data, NULL, block, W25Q128_SECTOR_SIZE);
+        }
+        if (memcmp(page_buf, src, W25Q128_PAGE_SIZE) != 0) {
+            dirty |= (uint16_t)(1u << p);
+        }
+    }
+
+    for (p = 0; dirty != 0; p++, dirty >>= 1) {
+        if ((dirty & 1) && W25Q128_WritePage((uint8_t*)data + p * W25Q128_PAGE_SIZE,
+                                             block + p * W25Q128_PAGE_SIZE,
+                                             W25Q128_PAGE_SIZE) != W25Q128_RESULT_OK) {
+            return RES_ERROR;
+        }
+    }
+    return RES_OK;
+}
+
 DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count)
 {
+    if (pdrv == DEV_MMC) return mmc_result(SD_WriteBlocks(buff, sector, count));
     if (pdrv != DEV_FLASH) return RES_PARERR;
     if (Stat & STA_NOINIT) return RES_NOTRDY;
+    if (!DISK_RANGE_OK(sector, count)) return RES_PARERR;
 
-    uint32_t start_addr = sector * 512;
-    uint32_t end_addr = start_addr + count * 512;
-    uint32_t erase_start = start_addr & 0xFFFFF000;  // 4KB 对齐
-    uint32_t erase_end = (end_addr + 4095) & 0xFFFFF000;
+    // 扇区与擦除块一一对应，无需读-改-写
+    for (UINT n = 0; n < count; n++) {
+        if (flash_write_block(buff + n * DISK_SECTOR_SIZE, FLASH_FATFS_BASE + (sector + n) * DISK_SECTOR_SIZE) != RES_OK) {
+            return RES_ERROR;
+        }
+    }
+
+    // 写直通更新缓存
+    disk_cache_write_through(sector, count, buff);
+    return RES_OK;
+}
+
+#else
+
+/* 擦除块读-改-写缓冲区 */
+static BYTE erase_buf[W25Q128_SECTOR_SIZE] __attribute__((aligned(4)));
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count)
+{
+    if (pdrv == DEV_MMC) return mmc_result(SD_WriteBlocks(buff, sector, count));
+    if (pdrv != DEV_FLASH) return RES_PARERR;
+    if (Stat & STA_NOINIT) return RES_NOTRDY;
+    if (!DISK_RANGE_OK(sector, count)) return RES_PARERR;
+
+    uint32_t addr = FLASH_FATFS_BASE + sector * DISK_SECTOR_SIZE;
+    uint32_t remaining = count * DISK_SECTOR_SIZE;
+    const BYTE *src = buff;
 
     // printf(">>> disk_write: sector=%lu, count=%u (bytes=%u)\n", sector, count, count*512);
 
-    // 1. 先批量擦除所有涉及的 4KB 扇区
-    for (uint32_t addr = erase_start; addr < erase_end; addr += 4096) {
-        W25Q128_WriteEnable();
-        if (W25Q128_SectorErase(addr) != W25Q128_RESULT_OK) {
-            // printf("!!! Erase failed at 0x%08X\n", addr);
-            return RES_ERROR;
+    // 按 4KB 擦除块逐块处理：读出整块 → 合并新数据 → 必要时擦除 → 编程
+    // 同一擦除块内未写的扇区必须保留，否则会破坏相邻的 FAT/目录扇区
+    while (remaining > 0) {
+        uint32_t block = addr & ~(uint32_t)(W25Q128_SECTOR_SIZE - 1);
+        uint32_t offset = addr - block;
+        uint32_t n = W25Q128_SECTOR_SIZE - offset;
+        uint32_t i;
+        if (n > remaining) n = remaining;
+
+        W25Q128_ReadData(erase_buf, block, W25Q128_SECTOR_SIZE);
+
+        // 新数据只需把 1 变 0 时可直接编程，省去 45ms 的扇区擦除
+        for (i = 0; i < n; i++) {
+            if ((erase_buf[offset + i] & src[i]) != src[i]) break;
         }
-        while (W25Q128_IsBusy());  // 等待擦除完成
-    }
 
-    // 2. 再一次性写入所有数据（跨页自动处理）
-    if (W25Q128_BufferWrite((uint8_t*)buff, start_addr, count * 512) != W25Q128_RESULT_OK) {
-        // printf("!!! BufferWrite failed\n");
-        return RES_ERROR;
+        if (i == n) {
+            if (flash_program_pages(src, erase_buf + offset, addr, n) != RES_OK) {
+                return RES_ERROR;
+            }
+        } else {
+            memcpy(erase_buf + offset, src, n);
+            if (W25Q128_SectorErase(block) != W25Q128_RESULT_OK) {
+                // printf("!!! Erase failed at 0x%08X\n", block);
+                return RES_ERROR;
+            }
+            if (flash_program_pages(erase_buf, NULL, block, W25Q128_SECTOR_SIZE) != RES_OK) {
+                return RES_ERROR;
+            }
+        }
+
+        src += n;
+        addr += n;
+        remaining -= n;
     }
 
+    // 写直通更新缓存
+    disk_cache_write_through(sector, count, buff);
+
     // printf(">>> disk_write SUCCESS\n");
     return RES_OK;
 }
+#endif /* DISK_SECTOR_SIZE */
+
+/**
+ * @brief 直接编程已擦除区域（不做读-改-写，不擦除）
+ * @details 供 stream_log.c 向 f_expand 预分配的连续文件追加数据：调用方保证目标区域
+ *          已由 CTRL_TRIM 擦除，且同一字节只编程一次。页内可分多次编程（NOR 只把 1 变 0）。
+ * @param sector 起始扇区
+ * @param offset 相对起始扇区的字节偏移（可超过一个扇区）
+ * @param buff   数据
+ * @param len    字节数
+ */
+DRESULT disk_program(BYTE pdrv, LBA_t sector, UINT offset, const BYTE *buff, UINT len)
+{
+    LBA_t first, last;
+
+    if (pdrv != DEV_FLASH) return RES_PARERR;
+    if (Stat & STA_NOINIT) return RES_NOTRDY;
+    if (len == 0) return RES_OK;
+
+    first = sector + offset / DISK_SECTOR_SIZE;
+    last = sector + (offset + len - 1) / DISK_SECTOR_SIZE;
+    if (!DISK_RANGE_OK(first, last - first + 1)) return RES_PARERR;
+
+    if (flash_program_pages(buff, NULL, FLASH_FATFS_BASE + sector * DISK_SECTOR_SIZE + offset, len) != RES_OK) {
+        return RES_ERROR;
+    }
+    disk_cache_invalidate_range(first, (UINT)(last - first + 1));
+    return RES_OK;
+}
 #endif
 /*-----------------------------------------------------------------------*/
 /* Miscellaneous Functions                                               */
 /*-----------------------------------------------------------------------*/
 
+/**
+ * @brief SD 卡 ioctl：扇区固定 512 字节，扇区数与擦除单元由 CSD 计算
+ */
+static DRESULT mmc_ioctl(BYTE cmd, void *buff)
+{
+    SD_CardInfo info;
+
+    if (!SD_IsReady()) return RES_NOTRDY;
+    SD_GetCardInfo(&info);
+
+    switch (cmd)
+    {
+    case CTRL_SYNC:
+        // 写命令返回时卡可能仍在编程，这里等它完成
+        return mmc_result(SD_Sync());
+
+    case GET_SECTOR_COUNT:
+        *(LBA_t*)buff = info.sector_count;
+        return RES_OK;
+
+    case GET_SECTOR_SIZE:
+        *(WORD*)buff = SD_BLOCK_SIZE;
+        return RES_OK;
+
+    case GET_BLOCK_SIZE:
+        *(DWORD*)buff = info.erase_sectors;
+        return RES_OK;
+
+    default:
+        return RES_PARERR;
+    }
+}
+
 DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
 {
     DRESULT res = RES_PARERR;
 
+    if (pdrv == DEV_MMC) return mmc_ioctl(cmd, buff);
     if (pdrv != DEV_FLASH) return RES_PARERR;
     if (Stat & STA_NOINIT) return RES_NOTRDY;
 
@@ -188,20 +411,47 @@ DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
         break;
 
     case GET_SECTOR_COUNT:
-        *(LBA_t*)buff = W25Q128_CAPACITY / 512;  // 32768
+        *(LBA_t*)buff = DISK_SECTOR_COUNT;  // 12MB：3072（512 字节扇区时 24576）
         res = RES_OK;
         break;
 
     case GET_SECTOR_SIZE:
-        *(WORD*)buff = 512;
+        *(WORD*)buff = DISK_SECTOR_SIZE;
         res = RES_OK;
         break;
 
     case GET_BLOCK_SIZE:
-        *(DWORD*)buff = 64;     // 关键！64KB 簇 → 128 个扇区
+        // 擦除块大小（以扇区计），f_mkfs 据此对齐数据区，使簇不跨擦除块
+        *(DWORD*)buff = W25Q128_SECTOR_SIZE / DISK_SECTOR_SIZE;
         res = RES_OK;
         break;
 
+#if FF_FS_READONLY == 0
+    case CTRL_TRIM:
+        // buff = {起始扇区, 结束扇区}（含），只擦除完整落在范围内的擦除块。
+        // FF_USE_TRIM=0，FatFs 删除文件时不调用（否则每释放一簇要多 45ms），
+        // 由 stream_log.c 在追加前擦除预分配区域
+        {
+            const LBA_t *range = (const LBA_t*)buff;
+            const LBA_t per_block = W25Q128_SECTOR_SIZE / DISK_SECTOR_SIZE;
+            LBA_t s = (range[0] + per_block - 1) / per_block * per_block;
+
+            if (range[1] < range[0] || !DISK_RANGE_OK(range[0], range[1] - range[0] + 1)) {
+                res = RES_PARERR;
+                break;
+            }
+            res = RES_OK;
+            for (; s + per_block - 1 <= range[1]; s += per_block) {
+                if (W25Q128_SectorErase(FLASH_FATFS_BASE + s * DISK_SECTOR_SIZE) != W25Q128_RESULT_OK) {
+                    res = RES_ERROR;
+                    break;
+                }
+                disk_cache_invalidate_range(s, (UINT)per_block);
+            }
+        }
+        break;
+#endif
+
     default:
         res = RES_PARERR;
         break;
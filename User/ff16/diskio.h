@@ -32,6 +32,9 @@ DRESULT disk_read (BYTE pdrv, BYTE* buff, LBA_t sector, UINT count);
 DRESULT disk_write (BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count);
 DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff);
 
+/* W25Q128 extension: program bytes into an erased area (used by stream_log.c, not by FatFs) */
+DRESULT disk_program (BYTE pdrv, LBA_t sector, UINT offset, const BYTE* buff, UINT len);
+
 
 /* Disk Status Bits (DSTATUS) */
 
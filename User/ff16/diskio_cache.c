@@ -0,0 +1,263 @@
+/**
+ * @file diskio_cache.c
+ * @brief diskio 层扇区读缓存实现
+ * @details 每个缓存项保存一个完整扇区，以访问序号实现 LRU。
+ *          N 很小（默认 8），线性查找比维护链表更省 RAM 也更快。
+ */
+
+#include "diskio_cache.h"
+#include <string.h>
+#include <stdio.h>
+
+#if DISK_CACHE_SECTORS > 0
+
+// 缓存项
+typedef struct {
+    LBA_t    sector;    // 缓存的扇区号
+    uint32_t stamp;     // 最近访问序号，越小越久未用
+    uint8_t  valid;     // 是否有效
+    uint8_t  pinned;    // 是否被钉住
+} CacheEntry;
+
+static CacheEntry cache_entry[DISK_CACHE_SECTORS];
+static BYTE cache_data[DISK_CACHE_SECTORS][FF_MAX_SS] __attribute__((aligned(4)));
+static uint32_t cache_clock = 0;       // 访问序号
+static DiskCache_Stats cache_stats;
+
+// 钉住区间（通常为 FAT1）
+static LBA_t pin_start = 0;
+static DWORD pin_count = 0;
+
+static int find_entry(LBA_t sector)
+{
+    for (int i = 0; i < DISK_CACHE_SECTORS; i++) {
+        if (cache_entry[i].valid && cache_entry[i].sector == sector) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static uint8_t in_pin_range(LBA_t sector)
+{
+#if DISK_CACHE_PIN_FAT
+    return pin_count && sector >= pin_start && sector - pin_start < pin_count;
+#else
+    (void)sector;
+    return 0;
+#endif
+}
+
+/**
+ * @brief 选择一个可用缓存项：优先空项，否则淘汰最久未用的未钉住项
+ * @return 缓存项索引
+ */
+static int select_victim(void)
+{
+    int victim = -1;
+
+    for (int i = 0; i < DISK_CACHE_SECTORS; i++) {
+        if (!cache_entry[i].valid) {
+            return i;
+        }
+        if (cache_entry[i].pinned) {
+            continue;
+        }
+        if (victim < 0 || cache_entry[i].stamp < cache_entry[victim].stamp) {
+            victim = i;
+        }
+    }
+
+    // 全部被钉住（配置不当时）退化为普通 LRU
+    if (victim < 0) {
+        victim = 0;
+        for (int i = 1; i < DISK_CACHE_SECTORS; i++) {
+            if (cache_entry[i].stamp < cache_entry[victim].stamp) {
+                victim = i;
+            }
+        }
+    }
+
+    if (cache_entry[victim].pinned) {
+        cache_stats.pinned--;
+    }
+    cache_stats.evictions++;
+    return victim;
+}
+
+/**
+ * @brief 初始化缓存（清空所有缓存项和统计）
+ */
+void disk_cache_init(void)
+{
+    disk_cache_invalidate();
+    disk_cache_reset_stats();
+}
+
+/**
+ * @brief 清空所有缓存项（重新初始化介质时调用）
+ */
+void disk_cache_invalidate(void)
+{
+    memset(cache_entry, 0, sizeof(cache_entry));
+    cache_clock = 0;
+    cache_stats.pinned = 0;
+}
+
+/**
+ * @brief 查找扇区，命中时复制到 buff
+ * @return 1 命中，0 未命中
+ */
+int disk_cache_lookup(LBA_t sector, BYTE *buff)
+{
+    int i = find_entry(sector);
+
+    if (i < 0) {
+        cache_stats.misses++;
+        return 0;
+    }
+
+    memcpy(buff, cache_data[i], FF_MAX_SS);
+    cache_entry[i].stamp = ++cache_clock;
+    cache_stats.hits++;
+    return 1;
+}
+
+/**
+ * @brief 将刚从 Flash 读出的扇区放入缓存
+ */
+void disk_cache_fill(LBA_t sector, const BYTE *buff)
+{
+    int i = find_entry(sector);
+
+    if (i < 0) {
+        i = select_victim();
+        cache_entry[i].sector = sector;
+        cache_entry[i].valid = 1;
+        cache_entry[i].pinned = 0;
+        if (in_pin_range(sector) && cache_stats.pinned < DISK_CACHE_PIN_MAX) {
+            cache_entry[i].pinned = 1;
+            cache_stats.pinned++;
+        }
+    }
+
+    memcpy(cache_data[i], buff, FF_MAX_SS);
+    cache_entry[i].stamp = ++cache_clock;
+}
+
+/**
+ * @brief 写直通：写入 Flash 成功后同步更新已缓存的扇区
+ * @note 不为未缓存的扇区分配缓存项，避免大块文件写入冲掉元数据
+ */
+void disk_cache_write_through(LBA_t sector, UINT count, const BYTE *buff)
+{
+    for (UINT n = 0; n < count; n++) {
+        int i = find_entry(sector + n);
+        if (i >= 0) {
+            memcpy(cache_data[i], buff + (UINT)n * FF_MAX_SS, FF_MAX_SS);
+            cache_stats.write_updates++;
+        }
+    }
+}
+
+/**
+ * @brief 使指定扇区范围内的缓存项失效（底层擦除了未重写的扇区时调用）
+ */
+void disk_cache_invalidate_range(LBA_t sector, UINT count)
+{
+    for (int i = 0; i < DISK_CACHE_SECTORS; i++) {
+        if (cache_entry[i].valid && cache_entry[i].sector >= sector &&
+            cache_entry[i].sector - sector < count) {
+            if (cache_entry[i].pinned) {
+                cache_stats.pinned--;
+            }
+            cache_entry[i].valid = 0;
+            cache_entry[i].pinned = 0;
+            cache_stats.invalidations++;
+        }
+    }
+}
+
+/**
+ * @brief 设置钉住区间，区间内的扇区进入缓存后不会被 LRU 淘汰
+ * @param start 起始扇区
+ * @param count 扇区数，0 表示取消钉住
+ */
+void disk_cache_set_pin_range(LBA_t start, DWORD count)
+{
+    pin_start = start;
+    pin_count = count;
+
+    // 已缓存的扇区按新区间重新标记
+    cache_stats.pinned = 0;
+    for (int i = 0; i < DISK_CACHE_SECTORS; i++) {
+        cache_entry[i].pinned = 0;
+        if (cache_entry[i].valid && in_pin_range(cache_entry[i].sector) &&
+            cache_stats.pinned < DISK_CACHE_PIN_MAX) {
+            cache_entry[i].pinned = 1;
+            cache_stats.pinned++;
+        }
+    }
+}
+
+/**
+ * @brief 钉住已挂载卷的 FAT1 区（FatFs 只读取第一份 FAT）
+ * @param fs f_mount 成功后的文件系统对象；缓存只服务 W25Q128（物理驱动器 0），其它卷忽略
+ */
+void disk_cache_pin_fat(const FATFS *fs)
+{
+    if (fs != NULL && fs->pdrv != 0) {
+        return;
+    }
+    if (fs == NULL || fs->fs_type == 0) {
+        disk_cache_set_pin_range(0, 0);
+        return;
+    }
+    disk_cache_set_pin_range(fs->fatbase, fs->fsize);
+}
+
+void disk_cache_get_stats(DiskCache_Stats *stats)
+{
+    if (stats) {
+        *stats = cache_stats;
+    }
+}
+
+void disk_cache_reset_stats(void)
+{
+    uint8_t pinned = cache_stats.pinned;
+
+    memset(&cache_stats, 0, sizeof(cache_stats));
+    cache_stats.pinned = pinned;
+}
+
+/**
+ * @brief 通过串口打印缓存统计
+ */
+void disk_cache_print_stats(void)
+{
+    uint32_t total = cache_stats.hits + cache_stats.misses;
+
+    printf("disk cache: %u sectors, hit %lu / miss %lu (%lu%%), evict %lu, wt %lu, inval %lu, pinned %u\r\n",
+           (unsigned)DISK_CACHE_SECTORS,
+           (unsigned long)cache_stats.hits, (unsigned long)cache_stats.misses,
+           (unsigned long)(total ? cache_stats.hits * 100UL / total : 0),
+           (unsigned long)cache_stats.evictions, (unsigned long)cache_stats.write_updates,
+           (unsigned long)cache_stats.invalidations, (unsigned)cache_stats.pinned);
+}
+
+#else /* DISK_CACHE_SECTORS == 0 */
+
+void disk_cache_init(void) {}
+void disk_cache_invalidate(void) {}
+int  disk_cache_lookup(LBA_t sector, BYTE *buff) { (void)sector; (void)buff; return 0; }
+void disk_cache_fill(LBA_t sector, const BYTE *buff) { (void)sector; (void)buff; }
+void disk_cache_write_through(LBA_t sector, UINT count, const BYTE *buff) { (void)sector; (void)count; (void)buff; }
+void disk_cache_invalidate_range(LBA_t sector, UINT count) { (void)sector; (void)count; }
+void disk_cache_set_pin_range(LBA_t start, DWORD count) { (void)start; (void)count; }
+void disk_cache_pin_fat(const FATFS *fs) { (void)fs; }
+void disk_cache_get_stats(DiskCache_Stats *stats) { if (stats) memset(stats, 0, sizeof(*stats)); }
+void disk_cache_reset_stats(void) {}
+void disk_cache_print_stats(void) {}
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ * @file diskio_cache.h
+ * @brief diskio 层扇区读缓存（LRU，写直通）
+ * @details FatFs 每个卷只有一个窗口缓冲区（FAT 与目录共用），f_open/f_getfree/f_mkdir
+ *          会反复从 SPI Flash 读取同一批 FAT 扇区和目录扇区。
+ *          本模块在 disk_read/disk_write 之下缓存最近访问的 N 个单扇区读，
+ *          写操作同步更新缓存（写直通），并可将 FAT 区扇区钉住不被淘汰。
+ */
+
+#ifndef _DISKIO_CACHE_H
+#define _DISKIO_CACHE_H
+
+#include "ff.h"
+#include <stdint.h>
+
+// =============================================================================
+// 配置宏（可在外层定义覆盖）
+// =============================================================================
+#ifndef DISK_CACHE_SECTORS
+#if FF_MAX_SS >= 4096
+#define DISK_CACHE_SECTORS      2   ///< 4KB 扇区时每项 4KB：钉住 1 项 FAT，留 1 项给目录
+#else
+#define DISK_CACHE_SECTORS      8   ///< 缓存扇区数，0 表示关闭缓存；RAM 开销 = N * FF_MAX_SS
+#endif
+#endif
+
+#ifndef DISK_CACHE_PIN_FAT
+#define DISK_CACHE_PIN_FAT      1   ///< 1: 钉住 FAT 区扇区，不参与 LRU 淘汰
+#endif
+
+#ifndef DISK_CACHE_PIN_MAX
+#define DISK_CACHE_PIN_MAX      (DISK_CACHE_SECTORS / 2)   ///< 最多钉住的扇区数，保证目录扇区仍有空间
+#endif
+
+/**
+ * @brief 缓存统计信息
+ */
+typedef struct {
+    uint32_t hits;          ///< 命中次数
+    uint32_t misses;        ///< 未命中次数（实际读 Flash）
+    uint32_t evictions;     ///< 淘汰次数
+    uint32_t write_updates; ///< 写直通时更新的缓存扇区数
+    uint32_t invalidations; ///< 因擦除而失效的缓存扇区数
+    uint8_t  pinned;        ///< 当前被钉住的扇区数
+} DiskCache_Stats;
+
+void disk_cache_init(void);
+void disk_cache_invalidate(void);
+int  disk_cache_lookup(LBA_t sector, BYTE *buff);
+void disk_cache_fill(LBA_t sector, const BYTE *buff);
+void disk_cache_write_through(LBA_t sector, UINT count, const BYTE *buff);
+void disk_cache_invalidate_range(LBA_t sector, UINT count);
+void disk_cache_set_pin_range(LBA_t start, DWORD count);
+void disk_cache_pin_fat(const FATFS *fs);
+void disk_cache_get_stats(DiskCache_Stats *stats);
+void disk_cache_reset_stats(void);
+void disk_cache_print_stats(void);
+
+#endif
@@ -25,20 +25,21 @@
 /   3: f_lseek() function is removed in addition to 2. */
 
 
-#define FF_USE_FIND		0
+#define FF_USE_FIND		1
 /* This option switches filtered directory read functions, f_findfirst() and
 /  f_findnext(). (0:Disable, 1:Enable 2:Enable with matching altname[] too) */
+/* Used by dir_index.c to build the sorted directory table of the file browser. */
 
 
 #define FF_USE_MKFS		1
 /* This option switches f_mkfs(). (0:Disable or 1:Enable) */
 
 
-#define FF_USE_FASTSEEK	0
+#define FF_USE_FASTSEEK	1
 /* This option switches fast seek feature. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_EXPAND	0
+#define FF_USE_EXPAND	1
 /* This option switches f_expand(). (0:Disable or 1:Enable) */
 
 
@@ -178,8 +179,12 @@
 / Drive/Volume Configurations
 /---------------------------------------------------------------------------*/
 
-#define FF_VOLUMES		1
+#define FF_VOLUMES		2
 /* Number of volumes (logical drives) to be used. (1-10) */
+/* 0: = W25Q128 FAT partition (DEV_FLASH), 1: = SD card (DEV_MMC, sdio_sd.c).
+/  The asset partition at the top of the W25Q128 is a raw pack read through
+/  asset.c, not a FAT volume, so it needs no FATFS object. Each mounted volume
+/  costs sizeof(FATFS) (one window of FF_MAX_SS bytes), see Storage_PrintMemory(). */
 
 
 #define FF_STR_VOLUME_ID	0
@@ -213,6 +218,12 @@
 /  type of optical media. When FF_MAX_SS is larger than FF_MIN_SS, FatFs is
 /  configured for variable sector size mode and disk_ioctl() needs to implement
 /  GET_SECTOR_SIZE command. */
+/* W25Q128: both 512 and 4096 are supported by diskio.c. With 4096 a FatFs sector
+/  is exactly one erase block (one erase plus 16 page programs per write, no
+/  read-modify-write), at the cost of a 4KB window in FATFS and 4KB per cache
+/  entry, and with FF_FS_TINY == 0 also 4KB per open file (FIL). 512 stays the
+/  default to keep that budget small. Volumes must be re-formatted after
+/  changing this. */
 
 
 #define FF_LBA64		0
@@ -236,11 +247,18 @@
 / System Configurations
 /---------------------------------------------------------------------------*/
 
-#define FF_FS_TINY		1
+#ifndef FF_FS_TINY
+#define FF_FS_TINY		0
+#endif
 /* This option switches tiny buffer configuration. (0:Normal or 1:Tiny)
 /  At the tiny configuration, size of file object (FIL) is reduced FF_MAX_SS bytes.
 /  Instead of private sector buffer eliminated from the file object, common sector
 /  buffer in the filesystem object (FATFS) is used for the file data transfer. */
+/* Per-file buffers (0) are the default: with the shared window every switch
+/  between open files writes back a partial data sector (a read-modify-write of
+/  a whole 4KB erase block on the W25Q128) and re-reads the other file's sector.
+/  Each FIL grows by FF_MAX_SS bytes. Can be overridden with -DFF_FS_TINY=1;
+/  simulator/examples/multi_file_bench.c measures both configurations. */
 
 
 #define FF_FS_EXFAT		0
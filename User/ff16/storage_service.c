@@ -0,0 +1,568 @@
+/**
+ * @file storage_service.c
+ * @brief 存储服务任务实现
+ */
+
+#include "storage_service.h"
+#include "diskio_cache.h"
+#include "dir_index.h"
+#include "queue.h"
+#include "spi.h"
+#include "sdio_sd.h"
+#include "asset.h"
+#include "stream_log.h"
+#include <string.h>
+#include <stdio.h>
+
+#define STORAGE_PATH_MAX    32
+
+static QueueHandle_t q_interactive = NULL;
+static QueueHandle_t q_background = NULL;
+static TaskHandle_t service_task = NULL;
+static FATFS service_fs;
+static FATFS sd_fs;
+static uint8_t sd_mounted = 0;
+static StorageStats stats;
+
+// 当前打开的文件（同一文件的连续请求共用）
+static FIL fil;
+static char fil_path[STORAGE_PATH_MAX];
+static uint8_t fil_open = 0;
+static uint8_t fil_writable = 0;
+
+// 已写入但文件尚未关闭的写请求，关闭后才知道最终结果
+static StorageRequest *pending_writes[STORAGE_BATCH_MAX];
+static uint8_t pending_count = 0;
+
+// 正在执行 CALL 的 job，其中再提交的请求直接同步执行，避免自己等自己
+static uint8_t in_job = 0;
+
+// =============================================================================
+// 请求完成
+// =============================================================================
+
+static void request_complete(StorageRequest *req, FRESULT fr)
+{
+    StorageCallback cb = req->callback;
+    TaskHandle_t notify = req->notify;
+
+    req->result = fr;
+    stats.completed++;
+    req->busy = 0;
+    if (cb != NULL) {
+        cb(req);
+    }
+    if (notify != NULL) {
+        xTaskNotifyGive(notify);
+    }
+}
+
+// =============================================================================
+// 文件管理
+// =============================================================================
+
+static FRESULT file_close(void)
+{
+    FRESULT fr = FR_OK;
+
+    if (fil_open) {
+        FSIZE_t size = f_size(&fil);
+
+        fr = f_close(&fil);
+        fil_open = 0;
+        if (fil_writable) {
+            DirIndex_NotifySize(fil_path, (uint32_t)size);
+        }
+    }
+    for (uint8_t i = 0; i < pending_count; i++) {
+        StorageRequest *req = pending_writes[i];
+        request_complete(req, req->result != FR_OK ? req->result : fr);
+    }
+    pending_count = 0;
+    return fr;
+}
+
+static FRESULT file_open(const char *path, uint8_t write)
+{
+    FRESULT fr;
+
+    if (fil_open && strcmp(fil_path, path) == 0 && (fil_writable || !write)) {
+        stats.merged++;
+        return FR_OK;
+    }
+    file_close();
+
+    if (strlen(path) >= STORAGE_PATH_MAX) {
+        return FR_INVALID_NAME;
+    }
+    fr = f_open(&fil, path, write ? (FA_OPEN_ALWAYS | FA_READ | FA_WRITE) : FA_READ);
+    if (fr == FR_OK) {
+        strcpy(fil_path, path);
+        fil_open = 1;
+        fil_writable = write;
+    }
+    return fr;
+}
+
+static FRESULT file_seek(FSIZE_t offset)
+{
+    if (offset == STORAGE_OFFSET_END) {
+        offset = f_size(&fil);
+    }
+    // 顺序访问时文件指针已在目标位置，省掉 f_lseek
+    if (f_tell(&fil) == offset) {
+        return FR_OK;
+    }
+    return f_lseek(&fil, offset);
+}
+
+// =============================================================================
+// 请求执行
+// =============================================================================
+
+static void execute(StorageRequest *req)
+{
+    FRESULT fr;
+
+    switch (req->op) {
+    case STORAGE_OP_READ:
+        fr = file_open(req->path, 0);
+        if (fr == FR_OK) {
+            fr = file_seek(req->offset);
+        }
+        if (fr == FR_OK) {
+            fr = f_read(&fil, req->buf, req->len, &req->done);
+        }
+        request_complete(req, fr);
+        break;
+
+    case STORAGE_OP_WRITE:
+        fr = file_open(req->path, 1);
+        if (fr == FR_OK) {
+            fr = file_seek(req->offset);
+        }
+        if (fr == FR_OK) {
+            fr = f_write(&fil, req->buf, req->len, &req->done);
+            if (fr == FR_OK && req->done != req->len) {
+                fr = FR_DENIED;     // 卷已满
+            }
+        }
+        if (fr != FR_OK) {
+            request_complete(req, fr);
+        } else {
+            req->result = FR_OK;
+            pending_writes[pending_count++] = req;
+        }
+        break;
+
+    case STORAGE_OP_SYNC:
+        request_complete(req, file_close());
+        break;
+
+    case STORAGE_OP_CALL:
+        file_close();
+        in_job = 1;
+        fr = req->job != NULL ? req->job(req->ctx) : FR_INVALID_PARAMETER;
+        in_job = 0;
+        request_complete(req, fr);
+        break;
+
+    default:
+        request_complete(req, FR_INVALID_PARAMETER);
+        break;
+    }
+}
+
+// =============================================================================
+// 批处理：分组、排序、执行
+// =============================================================================
+
+// a 排在 b 之前时，两者能否交换顺序而不改变结果
+static uint8_t can_swap(const StorageRequest *a, const StorageRequest *b)
+{
+    if (a->op >= STORAGE_OP_SYNC || b->op >= STORAGE_OP_SYNC) {
+        return 0;   // 屏障与复合操作保持提交顺序
+    }
+    if (strcmp(a->path, b->path) != 0) {
+        return 1;
+    }
+    if (a->op == STORAGE_OP_READ && b->op == STORAGE_OP_READ) {
+        return 1;
+    }
+    if (a->offset == STORAGE_OFFSET_END || b->offset == STORAGE_OFFSET_END) {
+        return 0;
+    }
+    // 同一文件的读写只有字节区间不重叠时才可交换
+    return a->offset + a->len <= b->offset || b->offset + b->len <= a->offset;
+}
+
+/**
+ * @brief 按（文件首次出现的位置，偏移）稳定排序
+ * @details 插入排序只交换相邻且可交换的请求，因此不会改变任何有依赖的请求顺序
+ */
+static void sort_batch(StorageRequest **batch, uint8_t n)
+{
+    uint8_t group[STORAGE_BATCH_MAX];
+
+    for (uint8_t i = 0; i < n; i++) {
+        group[i] = i;
+        if (batch[i]->op < STORAGE_OP_SYNC) {
+            for (uint8_t k = 0; k < i; k++) {
+                if (batch[k]->op < STORAGE_OP_SYNC && strcmp(batch[k]->path, batch[i]->path) == 0) {
+                    group[i] = group[k];
+                    break;
+                }
+            }
+        }
+    }
+
+    for (uint8_t i = 1; i < n; i++) {
+        for (uint8_t j = i; j > 0; j--) {
+            StorageRequest *a = batch[j - 1];
+            StorageRequest *b = batch[j];
+            uint8_t before = group[j] < group[j - 1] ||
+                             (group[j] == group[j - 1] && b->offset < a->offset);
+            if (!before || !can_swap(a, b)) {
+                break;
+            }
+            batch[j - 1] = b;
+            batch[j] = a;
+            uint8_t g = group[j - 1];
+            group[j - 1] = group[j];
+            group[j] = g;
+            stats.reordered++;
+        }
+    }
+}
+
+static uint8_t take_batch(QueueHandle_t q, StorageRequest **batch)
+{
+    uint8_t n = 0;
+
+    while (n < STORAGE_BATCH_MAX && xQueueReceive(q, &batch[n], 0) == pdPASS) {
+        n++;
+    }
+    return n;
+}
+
+static void run_interactive(void);
+
+static void run_batch(StorageRequest **batch, uint8_t n, uint8_t background)
+{
+    stats.batches++;
+    if (n > stats.max_batch) {
+        stats.max_batch = n;
+    }
+    sort_batch(batch, n);
+
+    for (uint8_t i = 0; i < n; i++) {
+        // 后台批次在切换文件时让交互请求先执行
+        if (background && uxQueueMessagesWaiting(q_interactive) > 0 &&
+            (i == 0 || batch[i]->op >= STORAGE_OP_SYNC || batch[i - 1]->op >= STORAGE_OP_SYNC ||
+             strcmp(batch[i]->path, batch[i - 1]->path) != 0)) {
+            file_close();
+            stats.preempted++;
+            run_interactive();
+        }
+        execute(batch[i]);
+    }
+    file_close();
+}
+
+static void run_interactive(void)
+{
+    StorageRequest *batch[STORAGE_BATCH_MAX];
+    uint8_t n;
+
+    while ((n = take_batch(q_interactive, batch)) > 0) {
+        run_batch(batch, n, 0);
+    }
+}
+
+// =============================================================================
+// 服务任务
+// =============================================================================
+
+static void storage_mount(void)
+{
+    FRESULT fr = f_mount(&service_fs, STORAGE_VOLUME, 1);
+
+    if (fr == FR_NO_FILESYSTEM) {
+        // 16MB 卷达不到 FAT32 的最少簇数，交给 FatFs 选 FAT12/16（SFD：Flash 上不需要 MBR）。
+        // 簇 = 4KB 擦除块，一个 FAT、128 个根目录项（4KB），每次 FAT 更新只擦一个块
+        MKFS_PARM opt = {0};
+        BYTE *work = pvPortMalloc(FF_MAX_SS);
+
+        printf("storage: no filesystem, formatting...\r\n");
+        opt.fmt = FM_ANY | FM_SFD;
+        opt.au_size = W25Q128_SECTOR_SIZE;
+        opt.n_fat = 1;
+        opt.n_root = 128;
+        fr = work != NULL ? f_mkfs(STORAGE_VOLUME, &opt, work, FF_MAX_SS) : FR_NOT_ENOUGH_CORE;
+        vPortFree(work);
+        if (fr == FR_OK) {
+            fr = f_mount(&service_fs, STORAGE_VOLUME, 1);
+        }
+    }
+
+    if (fr == FR_OK) {
+        disk_cache_pin_fat(&service_fs);
+        printf("storage: %s mounted\r\n", STORAGE_VOLUME);
+    } else {
+        // 挂载失败时请求仍会被处理，f_open 返回 FR_NOT_ENABLED
+        printf("storage: mount failed (%d)\r\n", fr);
+    }
+
+    // SD 卡：f_mount 经 disk_initialize 调用 SD_Init，无卡时返回 FR_NOT_READY
+    fr = f_mount(&sd_fs, STORAGE_SD_VOLUME, 1);
+    sd_mounted = fr == FR_OK;
+    if (fr == FR_OK) {
+        printf("storage: %s mounted (SD)\r\n", STORAGE_SD_VOLUME);
+    } else if (fr == FR_NO_FILESYSTEM) {
+        printf("storage: SD card not formatted\r\n");
+    } else {
+        printf("storage: no SD card (%d)\r\n", fr);
+    }
+    if (!sd_mounted) {
+        f_mount(NULL, STORAGE_SD_VOLUME, 0);
+    }
+    Storage_PrintMemory();
+}
+
+static void storage_task(void *pvParameters)
+{
+    StorageRequest *batch[STORAGE_BATCH_MAX];
+    uint8_t n;
+
+    (void)pvParameters;
+    storage_mount();
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // 交互队列清空后才取后台请求
+        do {
+            run_interactive();
+            n = take_batch(q_background, batch);
+            if (n > 0) {
+                run_batch(batch, n, 1);
+            }
+        } while (n > 0);
+    }
+}
+
+/**
+ * @brief 创建请求队列与存储任务（在 vTaskStartScheduler 之前或之后调用均可）
+ * @return 0-成功，其他-失败
+ */
+int Storage_Service_Init(void)
+{
+    if (service_task != NULL) {
+        return 0;
+    }
+    q_interactive = xQueueCreate(STORAGE_QUEUE_LEN, sizeof(StorageRequest *));
+    q_background = xQueueCreate(STORAGE_QUEUE_LEN, sizeof(StorageRequest *));
+    if (q_interactive == NULL || q_background == NULL) {
+        return -1;
+    }
+    if (xTaskCreate(storage_task, "storage", STORAGE_TASK_STACK, NULL,
+                    STORAGE_TASK_PRIO, &service_task) != pdPASS) {
+        service_task = NULL;
+        return -2;
+    }
+    return 0;
+}
+
+/**
+ * @brief SD 卡卷（1:）是否已挂载
+ */
+uint8_t Storage_SD_Mounted(void)
+{
+    return sd_mounted;
+}
+
+uint8_t Storage_Service_Running(void)
+{
+    return service_task != NULL && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+// =============================================================================
+// 提交与等待
+// =============================================================================
+
+/**
+ * @brief 异步提交请求
+ * @return pdPASS-已入队（或已同步执行完），pdFAIL-请求仍在处理中或队列已满
+ */
+BaseType_t Storage_Submit(StorageRequest *req)
+{
+    QueueHandle_t q;
+
+    if (req == NULL) {
+        return pdFAIL;
+    }
+
+    taskENTER_CRITICAL();
+    if (req->busy) {
+        taskEXIT_CRITICAL();
+        return pdFAIL;
+    }
+    req->busy = 1;
+    stats.submitted++;
+    taskEXIT_CRITICAL();
+
+    req->done = 0;
+    req->result = FR_OK;
+
+    // 服务未运行，或在 job 内部再次访问文件：直接执行
+    if (!Storage_Service_Running() ||
+        (in_job && xTaskGetCurrentTaskHandle() == service_task)) {
+        execute(req);
+        file_close();
+        return pdPASS;
+    }
+
+    q = (req->prio == STORAGE_PRIO_INTERACTIVE && req->op != STORAGE_OP_SYNC) ? q_interactive : q_background;
+    if (xQueueSend(q, &req, 0) != pdPASS) {
+        req->busy = 0;
+        stats.queue_full++;
+        return pdFAIL;
+    }
+    xTaskNotifyGive(service_task);
+    return pdPASS;
+}
+
+/**
+ * @brief 等待请求完成（req->notify 须为当前任务）
+ * @return 请求结果；超时返回 FR_TIMEOUT
+ */
+FRESULT Storage_Wait(StorageRequest *req, TickType_t timeout)
+{
+    while (req->busy) {
+        if (ulTaskNotifyTake(pdTRUE, timeout) == 0 && req->busy) {
+            return FR_TIMEOUT;
+        }
+    }
+    return req->result;
+}
+
+// 提交并等待，队列满时稍后重试
+static FRESULT submit_and_wait(StorageRequest *req)
+{
+    if (Storage_Service_Running() && !(in_job && xTaskGetCurrentTaskHandle() == service_task)) {
+        req->notify = xTaskGetCurrentTaskHandle();
+    }
+    while (Storage_Submit(req) != pdPASS) {
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    return Storage_Wait(req, portMAX_DELAY);
+}
+
+FRESULT Storage_Read(const char *path, FSIZE_t offset, void *buf, UINT len, UINT *br)
+{
+    StorageRequest req = {0};
+    FRESULT fr;
+
+    req.op = STORAGE_OP_READ;
+    req.prio = STORAGE_PRIO_INTERACTIVE;
+    req.path = path;
+    req.offset = offset;
+    req.buf = buf;
+    req.len = len;
+    fr = submit_and_wait(&req);
+    if (br != NULL) {
+        *br = req.done;
+    }
+    return fr;
+}
+
+FRESULT Storage_Write(const char *path, FSIZE_t offset, const void *buf, UINT len, UINT *bw)
+{
+    StorageRequest req = {0};
+    FRESULT fr;
+
+    req.op = STORAGE_OP_WRITE;
+    req.prio = STORAGE_PRIO_BACKGROUND;
+    req.path = path;
+    req.offset = offset;
+    req.buf = (void *)buf;
+    req.len = len;
+    fr = submit_and_wait(&req);
+    if (bw != NULL) {
+        *bw = req.done;
+    }
+    return fr;
+}
+
+FRESULT Storage_Sync(void)
+{
+    StorageRequest req = {0};
+
+    req.op = STORAGE_OP_SYNC;
+    req.prio = STORAGE_PRIO_BACKGROUND;
+    return submit_and_wait(&req);
+}
+
+FRESULT Storage_Call(StorageJob job, void *ctx, uint8_t prio)
+{
+    StorageRequest req = {0};
+
+    req.op = STORAGE_OP_CALL;
+    req.prio = prio;
+    req.job = job;
+    req.ctx = ctx;
+    return submit_and_wait(&req);
+}
+
+// =============================================================================
+// 统计
+// =============================================================================
+
+void Storage_GetStats(StorageStats *out)
+{
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
+
+void Storage_PrintStats(void)
+{
+    StorageStats s;
+
+    Storage_GetStats(&s);
+    printf("storage: req %lu/%lu, batch %lu (max %lu), merged %lu, reordered %lu, "
+           "preempted %lu, queue full %lu\r\n",
+           (unsigned long)s.completed, (unsigned long)s.submitted,
+           (unsigned long)s.batches, (unsigned long)s.max_batch,
+           (unsigned long)s.merged, (unsigned long)s.reordered,
+           (unsigned long)s.preempted, (unsigned long)s.queue_full);
+}
+
+/**
+ * @brief 打印存储栈的 RAM 预算（字节）
+ * @details 静态部分：每个卷一个 FATFS（含 FF_MAX_SS 窗口）、服务的 FIL、扇区读缓存、
+ *          SD 中转缓冲、资源包页缓冲、流式日志页缓冲和存储任务栈。
+ *          每多打开一个文件再加一个 FIL：FF_FS_TINY=0 时含 FF_MAX_SS 字节的私有扇区缓冲，
+ *          FF_FS_TINY=1 时文件数据共用所在卷的窗口。资源包分区不是 FAT 卷，不占 FATFS。
+ */
+void Storage_PrintMemory(void)
+{
+    unsigned long fatfs = (unsigned long)sizeof(FATFS) * FF_VOLUMES;
+    unsigned long cache = (unsigned long)DISK_CACHE_SECTORS * FF_MAX_SS;
+    unsigned long asset = (unsigned long)sizeof(AssetPackHeader) + W25Q128_PAGE_SIZE;
+    unsigned long stack = (unsigned long)STORAGE_TASK_STACK * 4;   // 栈以 32 位字为单位
+    unsigned long total = fatfs + sizeof(FIL) + cache + SD_BLOCK_SIZE + asset +
+                          STREAM_LOG_PAGE_SIZE + stack;
+
+    printf("storage: RAM budget (FF_FS_TINY=%d, FF_MAX_SS=%d)\r\n", FF_FS_TINY, FF_MAX_SS);
+    printf("  FATFS x%d (0: flash, 1: SD)  %6lu\r\n", FF_VOLUMES, fatfs);
+    printf("  service FIL                 %6lu\r\n", (unsigned long)sizeof(FIL));
+    printf("  sector cache (%2d x %4d)    %6lu\r\n", DISK_CACHE_SECTORS, FF_MAX_SS, cache);
+    printf("  SD bounce buffer            %6lu\r\n", (unsigned long)SD_BLOCK_SIZE);
+    printf("  asset header + page         %6lu\r\n", asset);
+    printf("  stream log page             %6lu\r\n", (unsigned long)STREAM_LOG_PAGE_SIZE);
+    printf("  storage task stack          %6lu\r\n", stack);
+    printf("  total                       %6lu\r\n", total);
+    printf("  + per open file: FIL %lu, StreamLog %lu\r\n",
+           (unsigned long)sizeof(FIL), (unsigned long)sizeof(StreamLog));
+}
@@ -0,0 +1,119 @@
+/**
+ * @file storage_service.h
+ * @brief 存储服务任务：独占 FatFs 卷，通过请求队列串行化所有文件访问
+ * @details FatFs 以 FF_FS_REENTRANT=0 编译，多个任务直接调用 f_open/f_write 并不安全，
+ *          且 4KB 扇区擦除（45ms）会让 UI 循环卡住数百毫秒。本模块：
+ *          - 由一个低优先级任务独占 0: 卷，其它任务只提交请求
+ *          - 请求分交互（读）与后台（保存）两个队列，后台请求只在交互队列为空时执行，
+ *            且每处理完一个文件就检查一次交互队列
+ *          - 一批请求内按文件分组、按偏移排序（仅交换互不影响的请求），
+ *            同一文件的连续请求共用一次 f_open/f_close
+ *          - 完成后调用回调（在存储任务中执行）或给提交任务发任务通知
+ *
+ *          请求结构体由调用方提供并在完成前保持有效，队列里只传指针。
+ *          交互读不会等待仍排在后台队列里的写，需要读到刚提交的写时先调用 Storage_Sync()。
+ *          服务未启动（调度器未运行或未调用 Storage_Service_Init）时请求在调用方同步执行。
+ *
+ *          卷：0: 为 W25Q128 的 FAT 分区（无文件系统时自动格式化），1: 为 SD 卡
+ *          （有卡且已格式化时挂载，不自动格式化用户的卡）。路径带 "1:" 前缀即访问 SD 卡。
+ *          FatFs 以 FF_FS_TINY=0 编译，每个打开的文件有自己的扇区缓冲，
+ *          RAM 预算见 Storage_PrintMemory()。
+ */
+
+#ifndef STORAGE_SERVICE_H
+#define STORAGE_SERVICE_H
+
+#include "ff.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#define STORAGE_QUEUE_LEN       8       ///< 每个优先级队列的长度
+#define STORAGE_BATCH_MAX       8       ///< 每批最多处理的请求数
+#define STORAGE_TASK_PRIO       1       ///< 低于菜单任务(3)，避免擦除期间抢占 UI
+#define STORAGE_TASK_STACK      768     ///< 任务栈（字）；job 里的栈上 FIL 含 FF_MAX_SS 字节扇区缓冲
+#define STORAGE_VOLUME          "0:"    ///< W25Q128 FAT 分区
+#define STORAGE_SD_VOLUME       "1:"    ///< SD 卡（DEV_MMC）
+
+#define STORAGE_OFFSET_END      ((FSIZE_t)-1)   ///< 写到文件末尾（追加）
+
+/**
+ * @brief 请求类型
+ */
+typedef enum {
+    STORAGE_OP_READ = 0,    ///< 从 offset 读 len 字节
+    STORAGE_OP_WRITE,       ///< 在 offset 写 len 字节（文件不存在则创建；STORAGE_OFFSET_END 表示追加）
+    STORAGE_OP_SYNC,        ///< 屏障：之前提交的请求全部落盘后完成（总是进后台队列）
+    STORAGE_OP_CALL         ///< 在存储任务中执行 job(ctx)，用于整文件保存等复合操作
+} StorageOp;
+
+/**
+ * @brief 请求优先级
+ */
+typedef enum {
+    STORAGE_PRIO_INTERACTIVE = 0,   ///< UI 等待结果的读取
+    STORAGE_PRIO_BACKGROUND         ///< 保存等可以延后的写入
+} StoragePrio;
+
+struct StorageRequest;
+typedef void (*StorageCallback)(struct StorageRequest *req);
+typedef FRESULT (*StorageJob)(void *ctx);
+
+/**
+ * @brief 存储请求
+ */
+typedef struct StorageRequest {
+    // 输入
+    uint8_t         op;         ///< StorageOp
+    uint8_t         prio;       ///< StoragePrio
+    const char     *path;       ///< 文件路径（READ/WRITE）
+    FSIZE_t         offset;     ///< 文件偏移（READ/WRITE）
+    void           *buf;        ///< 数据缓冲区（READ/WRITE）
+    UINT            len;        ///< 字节数（READ/WRITE）
+    StorageJob      job;        ///< CALL 执行的函数
+    void           *ctx;        ///< 回调/job 的参数
+    StorageCallback callback;   ///< 完成回调，在存储任务中执行，不要阻塞（可为 NULL）；busy 已清 0，可重新提交
+    TaskHandle_t    notify;     ///< 完成后 xTaskNotifyGive 的任务（可为 NULL）
+
+    // 输出
+    volatile uint8_t busy;      ///< 提交后为 1，完成后清 0
+    FRESULT         result;     ///< 结果（写请求在文件关闭后才确定）
+    UINT            done;       ///< 实际读写的字节数
+} StorageRequest;
+
+/**
+ * @brief 服务统计
+ */
+typedef struct {
+    uint32_t submitted;     ///< 提交的请求数
+    uint32_t completed;     ///< 完成的请求数
+    uint32_t batches;       ///< 处理的批次数
+    uint32_t merged;        ///< 复用已打开文件、省掉 f_open/f_close 的请求数
+    uint32_t reordered;     ///< 为顺序访问而交换的请求对数
+    uint32_t preempted;     ///< 后台批次被交互请求打断的次数
+    uint32_t queue_full;    ///< 因队列满被拒绝的提交
+    uint32_t max_batch;     ///< 最大批次大小
+} StorageStats;
+
+int  Storage_Service_Init(void);
+uint8_t Storage_Service_Running(void);
+
+BaseType_t Storage_Submit(StorageRequest *req);
+FRESULT Storage_Wait(StorageRequest *req, TickType_t timeout);
+
+// 同步便捷接口：提交后等待完成
+FRESULT Storage_Read(const char *path, FSIZE_t offset, void *buf, UINT len, UINT *br);
+FRESULT Storage_Write(const char *path, FSIZE_t offset, const void *buf, UINT len, UINT *bw);
+FRESULT Storage_Sync(void);
+FRESULT Storage_Call(StorageJob job, void *ctx, uint8_t prio);
+
+uint8_t Storage_SD_Mounted(void);
+
+void Storage_GetStats(StorageStats *stats);
+void Storage_PrintStats(void);
+void Storage_PrintMemory(void);
+
+#endif
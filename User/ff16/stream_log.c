@@ -0,0 +1,431 @@
+/**
+ * @file stream_log.c
+ * @brief 高速率日志文件实现
+ */
+
+#include "stream_log.h"
+#include "diskio.h"
+#include "dir_index.h"
+#include <string.h>
+#include <stdio.h>
+
+#ifndef FLASH_SIMULATOR
+#include "stm32f4xx.h"
+#define STREAM_BARRIER()    __DMB()
+#else
+#define STREAM_BARRIER()    __asm volatile ("" ::: "memory")
+#endif
+
+#define TICKS_TO_MS(t)      ((uint32_t)((uint64_t)(t) * 1000 / configTICK_RATE_HZ))
+#define BLOCK_SECTORS       (STREAM_LOG_BLOCK_SIZE / FF_MAX_SS)
+
+// 刷写用的页缓冲，只在存储任务中使用
+static BYTE page_buf[STREAM_LOG_PAGE_SIZE] __attribute__((aligned(4)));
+
+static LBA_t cluster_to_sector(const FATFS *fs, DWORD clst)
+{
+    return fs->database + (LBA_t)fs->csize * (clst - 2);
+}
+
+// =============================================================================
+// Flash 访问（在存储任务中执行）
+// =============================================================================
+
+/**
+ * @brief 保证 [0, end) 以及它之后的一个擦除块已擦除
+ * @details 多擦一块：某块写入第一个字节时下一块已是全 0xFF，
+ *          掉电后恢复扫描总会在自己擦过的区域里停下，不会把簇里的旧数据当成日志
+ */
+static FRESULT stream_erase_ahead(StreamLog *log, FSIZE_t end)
+{
+    FSIZE_t need = ((end + STREAM_LOG_BLOCK_SIZE - 1) / STREAM_LOG_BLOCK_SIZE + 1) * STREAM_LOG_BLOCK_SIZE;
+    LBA_t range[2];
+
+    if (need > log->capacity) {
+        need = log->capacity;
+    }
+    while (log->erased < need) {
+        range[0] = log->start + log->erased / FF_MAX_SS;
+        range[1] = range[0] + BLOCK_SECTORS - 1;
+        if (disk_ioctl(log->fil.obj.fs->pdrv, CTRL_TRIM, range) != RES_OK) {
+            return FR_DISK_ERR;
+        }
+        log->erased += STREAM_LOG_BLOCK_SIZE;
+        log->stats.erases++;
+    }
+    return FR_OK;
+}
+
+/**
+ * @brief 把缓冲区中的数据按页编程到 Flash
+ * @param all 0-只写满整页的部分，1-连同不足一页的尾部全部写入
+ */
+static FRESULT stream_drain(StreamLog *log, uint8_t all)
+{
+    BYTE pdrv = log->fil.obj.fs->pdrv;
+    FRESULT fr;
+
+    while (1) {
+        uint32_t avail = log->head - log->tail;
+        uint32_t n = STREAM_LOG_PAGE_SIZE - (uint32_t)(log->written % STREAM_LOG_PAGE_SIZE);
+        uint32_t i = log->tail & (log->ring_size - 1);
+        uint32_t first;
+
+        if (avail == 0 || (avail < n && !all)) {
+            break;
+        }
+        if (n > avail) {
+            n = avail;
+        }
+        // StreamLog_Write 保证缓冲区里的数据不会超出预分配区域
+        fr = stream_erase_ahead(log, log->written + n);
+        if (fr != FR_OK) {
+            return fr;
+        }
+
+        first = log->ring_size - i;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(page_buf, log->ring + i, first);
+        memcpy(page_buf + first, log->ring, n - first);
+        if (disk_program(pdrv, log->start, (UINT)log->written, page_buf, n) != RES_OK) {
+            return FR_DISK_ERR;
+        }
+        log->written += n;
+        STREAM_BARRIER();       // 数据取走后才让出缓冲区
+        log->tail += n;
+        log->stats.programs++;
+    }
+    return FR_OK;
+}
+
+/**
+ * @brief 检查点：把已编程的字节数写入目录项
+ * @details 写模式下 f_lseek 越过文件大小时沿已分配的簇链扩大文件并置修改标志，
+ *          簇链由 f_expand 一次建好，这里不会分配新簇，f_sync 只改写目录项
+ */
+static FRESULT stream_commit(StreamLog *log)
+{
+    FRESULT fr = FR_OK;
+
+    if (log->written != log->committed) {
+        fr = f_lseek(&log->fil, log->written);
+        if (fr == FR_OK) {
+            fr = f_sync(&log->fil);
+        }
+        if (fr == FR_OK) {
+            log->committed = log->written;
+            log->stats.checkpoints++;
+            DirIndex_NotifySize(log->path, (uint32_t)f_size(&log->fil));
+        }
+    }
+    log->checkpoint_tick = xTaskGetTickCount();
+    return fr;
+}
+
+/**
+ * @brief 未正常关闭时，从检查点往后逐页扫描已编程的数据
+ * @details 遇到整页全 0xFF 即停止，结尾按记录长度向上对齐（记录尾部可能恰好是 0xFF）
+ */
+static FRESULT stream_recover(StreamLog *log)
+{
+    BYTE *buf = pvPortMalloc(FF_MAX_SS);
+    FSIZE_t pos = log->committed, end = log->committed;
+    LBA_t loaded = 0;
+    uint8_t have = 0;
+
+    if (buf == NULL) {
+        return FR_NOT_ENOUGH_CORE;
+    }
+    while (pos < log->capacity) {
+        LBA_t sect = log->start + pos / FF_MAX_SS;
+        UINT off = (UINT)(pos % FF_MAX_SS);
+        UINT stop = off - off % STREAM_LOG_PAGE_SIZE + STREAM_LOG_PAGE_SIZE;
+        UINT last = stop;
+
+        if (!have || sect != loaded) {
+            if (disk_read(log->fil.obj.fs->pdrv, buf, sect, 1) != RES_OK) {
+                vPortFree(buf);
+                return FR_DISK_ERR;
+            }
+            loaded = sect;
+            have = 1;
+        }
+        for (UINT i = off; i < stop; i++) {
+            if (buf[i] != 0xFF) {
+                last = i;
+            }
+        }
+        if (last == stop) {
+            break;
+        }
+        end = pos - off + last + 1;
+        pos += stop - off;
+    }
+    vPortFree(buf);
+
+    end = (end + log->align - 1) / log->align * log->align;
+    if (end > log->capacity) {
+        end = log->capacity;
+    }
+    log->written = end;
+    log->erased = (end / STREAM_LOG_BLOCK_SIZE + 1) * STREAM_LOG_BLOCK_SIZE;
+    if (log->erased > log->capacity) {
+        log->erased = log->capacity;
+    }
+    log->stats.recovered = (uint32_t)(end - log->committed);
+    return stream_commit(log);
+}
+
+// =============================================================================
+// 存储任务中执行的 job
+// =============================================================================
+
+static FRESULT stream_open_job(void *ctx)
+{
+    StreamLog *log = (StreamLog *)ctx;
+    FIL *fp = &log->fil;
+    DWORD clmt[4];          // 一个片段的链接表：{长度, 簇数, 起始簇, 0}
+    FSIZE_t cluster;
+    FRESULT fr;
+
+    fr = f_open(fp, log->path, FA_OPEN_ALWAYS | FA_READ | FA_WRITE);
+    if (fr != FR_OK) {
+        return fr;
+    }
+    cluster = (FSIZE_t)fp->obj.fs->csize * FF_MAX_SS;
+    if (cluster % STREAM_LOG_BLOCK_SIZE != 0) {
+        f_close(fp);
+        return FR_DENIED;
+    }
+
+    if (fp->obj.sclust == 0) {
+        // 新文件：一次分配整段连续簇，找不到足够大的连续空间时返回 FR_DENIED
+        fr = f_expand(fp, log->capacity, 1);
+        if (fr == FR_OK) {
+            log->capacity = (log->capacity + cluster - 1) / cluster * cluster;
+            log->start = cluster_to_sector(fp->obj.fs, fp->obj.sclust);
+            // 先擦第一块再写目录项，掉电后恢复扫描不会读到簇里的旧数据
+            fr = stream_erase_ahead(log, 0);
+        }
+        if (fr == FR_OK) {
+            // f_expand 把文件大小设成了整段容量（并已置修改标志），改回 0，数据在检查点计入
+            fp->obj.objsize = 0;
+            fr = f_sync(fp);
+        }
+    } else {
+        // 已有文件：须是一段连续簇，且簇数多于文件大小所需（上次没有正常关闭）
+        clmt[0] = sizeof(clmt) / sizeof(clmt[0]);
+        fp->cltbl = clmt;
+        fr = f_lseek(fp, CREATE_LINKMAP);
+        fp->cltbl = NULL;
+        if (fr == FR_NOT_ENOUGH_CORE) {
+            fr = FR_DENIED;         // 不连续，不是本模块写的文件
+        } else if (fr == FR_OK && (f_size(fp) + cluster - 1) / cluster >= clmt[1]) {
+            fr = FR_EXIST;          // 已正常关闭，没有预留空间
+        }
+        if (fr == FR_OK) {
+            log->capacity = (FSIZE_t)clmt[1] * cluster;
+            log->start = cluster_to_sector(fp->obj.fs, clmt[2]);
+            log->committed = f_size(fp);
+            fr = stream_recover(log);
+        }
+    }
+
+    if (fr == FR_OK && log->start % BLOCK_SECTORS != 0) {
+        fr = FR_DENIED;             // 数据区没有按擦除块对齐
+    }
+    if (fr != FR_OK) {
+        f_close(fp);
+    } else {
+        DirIndex_Notify(log->path);
+    }
+    return fr;
+}
+
+static FRESULT stream_flush_job(void *ctx)
+{
+    StreamLog *log = (StreamLog *)ctx;
+    TickType_t start = xTaskGetTickCount();
+    uint32_t ms;
+    FRESULT fr;
+
+    if (!log->open) {
+        return FR_INVALID_OBJECT;   // 排队期间日志已关闭
+    }
+    fr = stream_drain(log, 0);
+    if (fr == FR_OK && (log->written - log->committed >= STREAM_LOG_CHECKPOINT_BYTES ||
+                        start - log->checkpoint_tick >= pdMS_TO_TICKS(STREAM_LOG_CHECKPOINT_MS))) {
+        fr = stream_commit(log);
+    }
+    ms = TICKS_TO_MS(xTaskGetTickCount() - start);
+    log->stats.flushes++;
+    if (ms > log->stats.flush_max_ms) {
+        log->stats.flush_max_ms = ms;
+    }
+    return fr;
+}
+
+static FRESULT stream_checkpoint_job(void *ctx)
+{
+    StreamLog *log = (StreamLog *)ctx;
+    FRESULT fr;
+
+    if (!log->open) {
+        return FR_INVALID_OBJECT;
+    }
+    fr = stream_drain(log, 1);
+    return fr == FR_OK ? stream_commit(log) : fr;
+}
+
+static FRESULT stream_close_job(void *ctx)
+{
+    StreamLog *log = (StreamLog *)ctx;
+    FIL *fp = &log->fil;
+    FSIZE_t size;
+    FRESULT fr, res;
+
+    if (!log->open) {
+        return FR_INVALID_OBJECT;
+    }
+    fr = stream_drain(log, 1);
+    if (fr == FR_OK) {
+        fr = stream_commit(log);
+    }
+    // 释放没用到的簇：先把文件扩到整段容量，再截断到实际长度
+    if (fr == FR_OK) {
+        fr = f_lseek(fp, log->capacity);
+    }
+    if (fr == FR_OK) {
+        fr = f_lseek(fp, log->written);
+    }
+    if (fr == FR_OK) {
+        fr = f_truncate(fp);
+    }
+    log->open = 0;
+    size = f_size(fp);
+    res = f_close(fp);
+    if (fr == FR_OK && res == FR_OK) {
+        DirIndex_NotifySize(log->path, (uint32_t)size);
+    } else {
+        DirIndex_Notify(log->path);
+    }
+    return fr != FR_OK ? fr : res;
+}
+
+// =============================================================================
+// 接口
+// =============================================================================
+
+/**
+ * @brief 打开日志：新建并预分配 capacity 字节，或续写上次未正常关闭的日志
+ * @param capacity  预分配字节数（向上取整到簇）；续写时以原有簇链为准
+ * @param align     记录长度，掉电恢复时按它对齐（字节流传 1）
+ * @param ring      环形缓冲区，大小为 2 的幂，至少容纳一次擦除（45ms）期间的数据
+ * @return FR_OK；FR_DENIED-没有足够大的连续空间或文件不连续；FR_EXIST-该文件已正常关闭
+ */
+FRESULT StreamLog_Open(StreamLog *log, const char *path, FSIZE_t capacity, uint16_t align,
+                       uint8_t *ring, uint32_t ring_size)
+{
+    FRESULT fr;
+
+    if (capacity == 0 || ring == NULL || ring_size < STREAM_LOG_PAGE_SIZE ||
+        (ring_size & (ring_size - 1)) != 0) {
+        return FR_INVALID_PARAMETER;
+    }
+    memset(log, 0, sizeof(*log));
+    log->path = path;
+    log->align = align ? align : 1;
+    log->capacity = capacity;
+    log->ring = ring;
+    log->ring_size = ring_size;
+
+    fr = Storage_Call(stream_open_job, log, STORAGE_PRIO_INTERACTIVE);
+    if (fr == FR_OK) {
+        log->flush_req.op = STORAGE_OP_CALL;
+        log->flush_req.prio = STORAGE_PRIO_BACKGROUND;
+        log->flush_req.job = stream_flush_job;
+        log->flush_req.ctx = log;
+        log->checkpoint_tick = xTaskGetTickCount();
+        log->open = 1;
+    }
+    return fr;
+}
+
+/**
+ * @brief 追加一条记录（采样任务调用，只拷贝不等待 Flash）
+ * @details 整条记录要么全部写入要么丢弃。缓冲区攒够一页时提交后台刷写请求；
+ *          单生产者，多个任务写同一个日志时需要调用方加锁。
+ * @return 0-成功，-1-缓冲区或预分配区域已满，记录被丢弃
+ */
+int StreamLog_Write(StreamLog *log, const void *data, uint32_t len)
+{
+    uint32_t head = log->head;
+    uint32_t used = head - log->tail;
+    uint32_t i = head & (log->ring_size - 1);
+    uint32_t first;
+
+    if (!log->open || len > log->ring_size - used || log->written + used + len > log->capacity) {
+        log->stats.dropped++;
+        return -1;
+    }
+
+    first = log->ring_size - i;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(log->ring + i, data, first);
+    memcpy(log->ring, (const uint8_t *)data + first, len - first);
+    STREAM_BARRIER();           // 数据写完后才发布新的写入位置
+    log->head = head + len;
+
+    used += len;
+    log->stats.records++;
+    log->stats.bytes += len;
+    if (used > log->stats.ring_max) {
+        log->stats.ring_max = used;
+    }
+    if (used >= STREAM_LOG_PAGE_SIZE && !log->flush_req.busy) {
+        Storage_Submit(&log->flush_req);    // 队列满时下一条记录再试
+    }
+    return 0;
+}
+
+/**
+ * @brief 立即写入缓冲区中的全部数据并提交文件大小（等待完成）
+ */
+FRESULT StreamLog_Checkpoint(StreamLog *log)
+{
+    return Storage_Call(stream_checkpoint_job, log, STORAGE_PRIO_BACKGROUND);
+}
+
+/**
+ * @brief 写入剩余数据、截断到实际长度并关闭（等待完成）
+ */
+FRESULT StreamLog_Close(StreamLog *log)
+{
+    return Storage_Call(stream_close_job, log, STORAGE_PRIO_BACKGROUND);
+}
+
+// =============================================================================
+// 统计
+// =============================================================================
+
+void StreamLog_GetStats(const StreamLog *log, StreamLog_Stats *out)
+{
+    *out = log->stats;
+}
+
+void StreamLog_PrintStats(const StreamLog *log)
+{
+    const StreamLog_Stats *s = &log->stats;
+
+    printf("stream_log: %lu records %lu B (dropped %lu), ring max %lu/%lu B, written %lu/%lu B\r\n",
+           (unsigned long)s->records, (unsigned long)s->bytes, (unsigned long)s->dropped,
+           (unsigned long)s->ring_max, (unsigned long)log->ring_size,
+           (unsigned long)log->written, (unsigned long)log->capacity);
+    printf("stream_log: flushes %lu (max %lu ms), programs %lu, erases %lu, checkpoints %lu, recovered %lu B\r\n",
+           (unsigned long)s->flushes, (unsigned long)s->flush_max_ms, (unsigned long)s->programs,
+           (unsigned long)s->erases, (unsigned long)s->checkpoints, (unsigned long)s->recovered);
+}
@@ -0,0 +1,83 @@
+/**
+ * @file stream_log.h
+ * @brief 高速率日志文件：f_expand 预分配连续区域，数据经 diskio 直接追加到 Flash 页
+ * @details 用 f_write 追加传感器数据时，每次写满一个扇区都要读-改-写所在的 4KB 擦除块，
+ *          每次 f_sync 还要改写 FAT 和目录项，MPU6050 原始数据（每秒数百个样本）跟不上。
+ *          本模块：
+ *          - 打开时用 f_expand 一次分配整段连续簇，之后不再修改 FAT
+ *          - 采样任务只把记录拷入环形缓冲区（不等 Flash），攒够一页后提交后台刷写请求
+ *          - 存储任务按页用 disk_program 直接编程，提前一个擦除块用 CTRL_TRIM 擦除
+ *          - 目录项中的文件大小只在检查点（STREAM_LOG_CHECKPOINT_MS / _BYTES）或关闭时更新
+ *          - 关闭时释放未用的簇；未正常关闭时下次打开从检查点往后扫描，恢复已编程的数据
+ *
+ *          检查点之后、掉电之前写入的数据靠扫描恢复：遇到整页全 0xFF 即认为数据结束，
+ *          因此记录中不应出现整页 0xFF（原始传感器数据和带时间戳的记录不会）。
+ *          日志打开期间不要再用 f_read 读同一个文件（FIL 或卷窗口里的扇区缓冲可能是旧数据）。
+ *          要求簇大小是 4KB 擦除块的整数倍（storage_service.c 的 f_mkfs 参数满足）。
+ */
+
+#ifndef STREAM_LOG_H
+#define STREAM_LOG_H
+
+#include "ff.h"
+#include "storage_service.h"
+#include <stdint.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#define STREAM_LOG_PAGE_SIZE        256             ///< Flash 页大小，缓冲区攒够一页才提交刷写
+#define STREAM_LOG_BLOCK_SIZE       4096            ///< 擦除块大小
+#define STREAM_LOG_CHECKPOINT_MS    5000            ///< 最长多久提交一次文件大小
+#define STREAM_LOG_CHECKPOINT_BYTES (64 * 1024)     ///< 最多写多少字节提交一次文件大小
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t records;       ///< 写入缓冲区的记录数
+    uint32_t bytes;         ///< 写入缓冲区的字节数
+    uint32_t dropped;       ///< 缓冲区满或预分配区域已满而丢弃的记录数
+    uint32_t ring_max;      ///< 缓冲区最高占用（字节）
+    uint32_t flushes;       ///< 执行的刷写次数
+    uint32_t programs;      ///< 页编程次数
+    uint32_t erases;        ///< 擦除的块数
+    uint32_t checkpoints;   ///< 提交文件大小的次数
+    uint32_t flush_max_ms;  ///< 单次刷写最长耗时（缓冲区至少要容纳这段时间的数据）
+    uint32_t recovered;     ///< 打开时从检查点之后恢复的字节数
+} StreamLog_Stats;
+
+/**
+ * @brief 日志对象（调用方提供，打开到关闭期间保持有效）
+ */
+typedef struct {
+    FIL         fil;
+    const char *path;           ///< 打开时的路径
+    uint16_t    align;          ///< 记录长度，恢复时按它对齐
+    LBA_t       start;          ///< 预分配区域起始扇区
+    FSIZE_t     capacity;       ///< 预分配字节数（整簇）
+    volatile FSIZE_t written;   ///< 已编程到 Flash 的字节数
+    FSIZE_t     erased;         ///< 已擦除区域的结尾（擦除块对齐）
+    FSIZE_t     committed;      ///< 目录项中的文件大小
+    TickType_t  checkpoint_tick;///< 上次检查点的时刻
+
+    uint8_t    *ring;           ///< 环形缓冲区
+    uint32_t    ring_size;      ///< 缓冲区大小（2 的幂）
+    volatile uint32_t head;     ///< 写入位置（采样任务，自由增长）
+    volatile uint32_t tail;     ///< 读出位置（存储任务，自由增长）
+    volatile uint8_t open;
+
+    StorageRequest flush_req;   ///< 后台刷写请求
+    StreamLog_Stats stats;
+} StreamLog;
+
+FRESULT StreamLog_Open(StreamLog *log, const char *path, FSIZE_t capacity, uint16_t align,
+                       uint8_t *ring, uint32_t ring_size);
+int StreamLog_Write(StreamLog *log, const void *data, uint32_t len);
+FRESULT StreamLog_Checkpoint(StreamLog *log);
+FRESULT StreamLog_Close(StreamLog *log);
+
+void StreamLog_GetStats(const StreamLog *log, StreamLog_Stats *stats);
+void StreamLog_PrintStats(const StreamLog *log);
+
+#endif
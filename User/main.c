@@ -3,6 +3,8 @@
 #include "task.h"
 #include "semphr.h"
 #include "debug.h"
+#include "binlog.h"
+#include "shell.h"
 #include "led.h"
 #include "sys.h"
 #include "event_groups.h"
@@ -10,9 +12,22 @@
 #include "hooks.h"
 #include <string.h>
 #include "oled_print.h"
+#include "ff16/storage_service.h"
+#include "ui/persist.h"
+#include "kv_store.h"
+#include "ui/step.h"
+#include "ui/alarm_all.h"
+#include "rtc_date.h"
+#include "MPU6050/simple_pedometer.h"
+#include "ui/filesystem_test.h"
+#include "ui/imu_stream.h"
+#include "ui/xfer_service.h"
+#include "ui/screen_mirror.h"
+#include "rfid/rfid_service.h"
+#include "rfid/rfid_access.h"
+#include "ui/ts_sampler.h"
+#include "telemetry.h"
 
-QueueHandle_t xDataQueue;
-QueueHandle_t xSendQueue;
 static TaskHandle_t app_task_handle = NULL;
 static TaskHandle_t LED_handle = NULL;
 
@@ -30,40 +45,191 @@ void vTimerCallback(TimerHandle_t pxTimer); // 定时器回调函数
 
 /*   === 收发uart的数据的任务===*/
 static void data_task(void *pvParameters);
-static void send_task(void *pvParameters);
 TaskHandle_t Handle_data;
-TaskHandle_t Handle_send;
 
 /*  ===*/
 
 
 
+// =============================================================================
+// 串口命令（其余模块的命令在各自文件中登记）
+// =============================================================================
+
+// led <0-3> [on|off]：省略状态时切换
+static int cmd_led(uint32_t argc, const Shell_Arg *argv)
+{
+    int8_t ret = argc > 1 ? LED_Set((uint8_t)argv[0].u, argv[1].u ? 0 : 1) : LED_Toggle((uint8_t)argv[0].u);
+
+    return ret == LED_OK ? SHELL_OK : SHELL_ERR_USAGE;
+}
+
+// 原来的 hello/world 切换 LED1/LED2 并显示
+static int cmd_hello(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    (void)argv;
+    LED1 = !LED1;
+    OLED_Printf_Line(1," LED1 = %s;",LED1?"off":"on");
+    OLED_Refresh_Dirty();
+    return SHELL_OK;
+}
+
+static int cmd_world(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    (void)argv;
+    LED2 = !LED2;
+    OLED_Printf_Line(2," LED2 = %s",LED2?"off":"on");
+    OLED_Refresh_Dirty();
+    return SHELL_OK;
+}
+
+static int cmd_uartstat(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    (void)argv;
+    Debug_PrintStats();
+    return SHELL_OK;
+}
+
+static int cmd_logstat(uint32_t argc, const Shell_Arg *argv)
+{
+    Log_Stats ls;
+    Shell_Stats ss;
+
+    (void)argc;
+    (void)argv;
+    Log_GetStats(&ls);
+    Shell_GetStats(&ss);
+    printf("log: %lu records, %lu bytes, %lu dropped\r\n",
+           (unsigned long)ls.records, (unsigned long)ls.bytes, (unsigned long)ls.dropped);
+    printf("shell: %lu lines, %lu ok, %lu unknown, %lu usage, %lu failed, %lu too long\r\n",
+           (unsigned long)ss.lines, (unsigned long)ss.ok, (unsigned long)ss.unknown,
+           (unsigned long)ss.usage, (unsigned long)ss.failed, (unsigned long)ss.overflow);
+    return SHELL_OK;
+}
+
+static int cmd_persist(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    (void)argv;
+    Persist_PrintStats();
+    return SHELL_OK;
+}
+
+// KV 的状态只由存储任务修改，在存储任务中打印
+static FRESULT kv_stats_job(void *ctx)
+{
+    (void)ctx;
+    KV_PrintStats();
+    return FR_OK;
+}
+
+static int cmd_kv(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    (void)argv;
+    return Storage_Call(kv_stats_job, NULL, STORAGE_PRIO_INTERACTIVE) == FR_OK ? SHELL_OK : SHELL_ERR_FAIL;
+}
+
+// 任务列表：状态、优先级、栈剩余（字节）
+static int cmd_tasks(uint32_t argc, const Shell_Arg *argv)
+{
+    static const char states[] = "XRBSD?";     // eRunning eReady eBlocked eSuspended eDeleted eInvalid
+    UBaseType_t n = uxTaskGetNumberOfTasks();
+    TaskStatus_t *st = pvPortMalloc(n * sizeof(TaskStatus_t));
+
+    (void)argc;
+    (void)argv;
+    if (st == NULL)
+    {
+        return SHELL_ERR_FAIL;
+    }
+    n = uxTaskGetSystemState(st, n, NULL);
+    printf("  %-12s %5s %5s %10s\r\n", "name", "state", "prio", "stack free");
+    for (UBaseType_t i = 0; i < n; i++)
+    {
+        printf("  %-12s %5c %5lu %10lu\r\n", st[i].pcTaskName, states[st[i].eCurrentState],
+               (unsigned long)st[i].uxCurrentPriority, (unsigned long)st[i].usStackHighWaterMark * sizeof(StackType_t));
+    }
+    vPortFree(st);
+    printf("  heap free %lu B\r\n", (unsigned long)xPortGetFreeHeapSize());
+    return SHELL_OK;
+}
+
+static const Shell_Cmd sys_cmds[] = {
+    { "led",      "u|b", cmd_led,      "led <0-3> [on|off], toggle if omitted" },
+    { "hello",    "",    cmd_hello,    "toggle LED1" },
+    { "world",    "",    cmd_world,    "toggle LED2" },
+    { "uartstat", "",    cmd_uartstat, "USART1 rx/tx statistics" },
+    { "logstat",  "",    cmd_logstat,  "binary log and shell statistics" },
+    { "tasks",    "",    cmd_tasks,    "task state, priority, stack free" },
+    { "persist",  "",    cmd_persist,  "coalesced save counts and latency" },
+    { "kv",       "",    cmd_kv,       "KV store sector usage and statistics" },
+};
+
+static uint32_t log_clock(void)
+{
+    return (uint32_t)xTaskGetTickCount(); // 1 节拍 = 1ms
+}
+
 int main(void)
 {
     BaseType_t xReturn;
     // NVIC 分组4
     NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4); // 优先级分组,freeRTOS中优先级分组不能在任务创建后修改
     debug_init();
+    Log_Init(Debug_WriteRecord, log_clock);
+    Telem_Init(Debug_TryWriteRecord, 0); // imu_stream 进入时设置字节预算
     LED_Init();
     LED_Set_All(1); // 全部熄灭
     OLED_Init();
 
-    xDataQueue = xQueueCreate(10, sizeof(uint8_t));
-    xSendQueue = xQueueCreate(20, sizeof(uint8_t));  // 创建发送队列
-    printf("main:%p", xDataQueue);
+    if (Storage_Service_Init() != 0)
+    {
+        printf("create storage service failed!\r\n");
+    }
+    // 步数：计步之前从 A/B 记录恢复，之后每一步只标记脏对象
+    Steps_LoadSync();
+    // 门禁登记表：启动时从 Flash 载入到 RAM，刷卡后只在 RAM 中查找
+    if (RFID_Access_Init() != 0)
+    {
+        printf("load tag table failed!\r\n");
+    }
+    // 时序存储：启动时恢复各级数据环，之后每分钟由定时器在存储任务中追加一条采样
+    if (TS_Sampler_Init() != 0)
+    {
+        printf("init time-series sampler failed!\r\n");
+    }
+    // 后台读卡：RFID 任务在 USART2 上寻卡，界面从队列取卡
+    if (RFID_Service_Start() != 0)
+    {
+        printf("create rfid service failed!\r\n");
+    }
+    // 延迟合并保存的对象：各模块只标记修改，空闲钩子中批量保存
+    Persist_Register(PERSIST_OBJ_STEPS, "steps", Steps_Save);
+    Persist_Register(PERSIST_OBJ_ALARMS, "alarms", Alarms_Save);
+    Persist_Register(PERSIST_OBJ_RTC, "rtc", RTC_Settings_Save);
+    Persist_Register(PERSIST_OBJ_TAGS, "tags", RFID_Access_SaveSeen);
+    // 串口命令：各模块登记自己的命令表，data_task 按行执行
+    Shell_Init();
+    Shell_Register(sys_cmds, sizeof(sys_cmds) / sizeof(sys_cmds[0]));
+    Alarms_RegisterCommands();
+    RTC_RegisterCommands();
+    simple_pedometer_register_commands();
+    filesystem_register_commands();
+    imu_stream_register_commands();
+    xfer_service_register_commands();
+    screen_mirror_register_commands();
+    rfid_service_register_commands();
+    rfid_access_register_commands();
+    ts_sampler_register_commands();
     xTaskCreate(data_task,
                 "data_task",
                 512,
-                (void *)&xDataQueue,
+                NULL,
                 1,
                 &Handle_data);
-    xTaskCreate(send_task,
-                "send_task",
-                512,
-                (void *)&xSendQueue,
-                2,  // 优先级比接收任务稍高，确保及时发送
-                &Handle_send);
-
         /* 创建app_task任务 */
         xReturn = xTaskCreate((TaskFunction_t)app_task,          /* 任务入口函数 */
                               (const char *)"app_task",          /* 任务名字 */
@@ -109,6 +275,7 @@ static void app_task(void *pvParameters)
                 (void *)NULL,                 /* 任务入口函数参数 */
                 (UBaseType_t)4,               /* 任务的优先级 */
                 (TaskHandle_t *)&LED_handle); /* 任务控制块指针 */
+    Debug_ConsoleRelease();                   // 交还本任务的控制台通道
     vTaskDelete(NULL);                        // 删除自身
     taskEXIT_CRITICAL();
 }
@@ -156,60 +323,27 @@ void vTimerCallback(TimerHandle_t pxTimer)
         break;
     }
 }
+// 串口数据由 DMA 接收，IDLE/半满/全满时整块送到流缓冲区，这里一次取一块
+// 传输模式（xfer 命令）下数据交给传输服务，每个节拍至少运行一次以继续发送
 static void data_task(void *pvParameters)
 {
-    uint8_t buffer[50] = {0};
-
-    while (1)
-    {
-        uint8_t ch;
-        uint8_t index = 0;
-
-        while (1)
-        {
-            xQueueReceive(xDataQueue, &ch, portMAX_DELAY);
-
-            printf("%c", ch);
-            if (index < sizeof(buffer) - 1)
-            {
-                buffer[index++] = ch;
-                buffer[index] = '\0';//保证无论何时都是一个完整的字符串
-            }
-            if (ch == '\n')
-            {
-                break;
-            }
-        }
-
-        if (strstr((char *)buffer, "hello"))
-        {
-            LED1 = !LED1;
-            OLED_Printf_Line(1," LED1 = %s;",LED1?"off":"on");
-        }
-        if (strstr((char *)buffer, "world"))
-        {
-            LED2 = !LED2;
-            OLED_Printf_Line(2," LED2 = %s",LED2?"off":"on");
-        }
-        OLED_Refresh_Dirty();
+    static Shell_Line line;
+    uint8_t chunk[64];
 
-        delay_ms(10);
-    }
-}
+    Shell_LineInit(&line);
 
-static void send_task(void *pvParameters)
-{
-    uint8_t ch;
-    
     while (1)
     {
-        // 从发送队列中获取数据
-        if (xQueueReceive(xSendQueue, &ch, portMAX_DELAY) == pdPASS)
+        uint32_t n;
+
+        if (Xfer_Service_Active())
         {
-            // 实际发送数据
-            USART_SendData(USART1, ch);
-            // 等待发送数据寄存器为空
-            while (USART_GetFlagStatus(USART1, USART_FLAG_TXE) == RESET);
+            n = Debug_Receive(chunk, sizeof(chunk), 1);
+            Xfer_Service_Run(chunk, n);
+            continue;
         }
+        n = Debug_Receive(chunk, sizeof(chunk), portMAX_DELAY);
+        Usart1_send_bytes(chunk, n); // 回显
+        Shell_Input(&line, chunk, n);
     }
 }
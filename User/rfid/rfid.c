@@ -1,401 +1,429 @@
-// #include "rfid.h"
-// #include "uart_dma.h"
-// #include <stdio.h>
-// #include <string.h>
-
-// unsigned char *rfid_rx_buffer = NULL;
-// unsigned char tx_buffer[RFID_FRAME_MAX_LEN] = {0};
-
-// /**
-//  * @brief RFIDʼ
-//  *
-//  * @param rx_buffer  ջ
-//  * @param len        
-//  */
-// void RFID_dev_init(unsigned char *rx_buffer, unsigned short len)
-// {
-//     RFID_Init(rx_buffer, len);
-//     rfid_rx_buffer = rx_buffer;
-// }
-
-// // BBCУ
-// unsigned char BBC_Check(unsigned char *data, unsigned short len)
-// {
-//     unsigned char i, sum = 0;
-//     for (i = 0; i < len; i++)
-//     {
-//         sum ^= data[i];
-//     }
-//     return ~sum;
-// }
-
-// /**
-//  * @brief һ֡
-//  *
-//  * @param ctype  
-//  * @param cmd    
-//  * @param data  
-//  * @param len   ݳ
-//  */
-// void RFID_SendFrame(unsigned char ctype, unsigned char cmd, unsigned char *data, unsigned char len)
-// {
-//     unsigned char i;
-//     unsigned short tx_len = 0;
-//     tx_buffer[tx_len++] = 6 + len;
-//     tx_buffer[tx_len++] = ctype;
-//     tx_buffer[tx_len++] = cmd;
-//     tx_buffer[tx_len++] = len;
-//     for (i = 0; i < len; i++)
-//     {
-//         tx_buffer[tx_len++] = data[i];
-//     }
-//     tx_buffer[tx_len++] = BBC_Check(tx_buffer, tx_len);
-//     tx_buffer[tx_len++] = RFID_ETX;
-
-//     RFID_SendBytes(tx_buffer, tx_len);
-//     printf_array(tx_buffer, tx_len);
-// }
-
-// /**
-//  * @brief 
-//  *
-//  * @return unsigned short  ATQ
-//  */
-// unsigned short RFID_Request(void)
-// {
-//     unsigned short len = 0;
-//     unsigned char info = 0x52;
-//     unsigned short ATQ = 0;
-//     unsigned char timeout = RFID_TIMEOUT;
-//     RFID_SendFrame(0x02, 0x41, &info, 0x01); // 
-//     while (timeout--)
-//     {
-//         // ȴд
-//         len = RFID_GetFrame_len();
-//         if (len)
-//         {
-//             if (BBC_Check(rfid_rx_buffer, len - 2) == rfid_rx_buffer[len - 2]) // ճɹ
-//             {
-//                 ATQ = rfid_rx_buffer[4] | (rfid_rx_buffer[5] << 8);
-//                 break;
-//             }
-//         }
-//         IWDG_ReloadCounter(); // ιֹŹλ
-//         RFID_delay_ms(1000);
-//     }
-//     return ATQ;
-// }
-
-// /**
-//  * @brief һײ
-//  *
-//  * @return unsigned int  uid
-//  */
-// unsigned int RFID_Anticollision(void)
-// {
-//     unsigned short len = 0;
-//     unsigned short info = 0x0093;
-//     unsigned int UID = 0;
-//     unsigned char timeout = RFID_TIMEOUT;
-//     RFID_SendFrame(0x02, 0x42, (unsigned char *)&info, 0x02); // ײ
-//     while (timeout--)
-//     {
-//         // ȴд
-//         len = RFID_GetFrame_len();
-//         if (len)
-//         {
-//             if (BBC_Check(rfid_rx_buffer, len - 2) == rfid_rx_buffer[len - 2]) // ճɹ
-//             {
-//                 UID = rfid_rx_buffer[4] | (rfid_rx_buffer[5] << 8) | (rfid_rx_buffer[6] << 16) | (rfid_rx_buffer[7] << 24);
-//                 break;
-//             }
-//         }
-//         IWDG_ReloadCounter(); // ιֹŹλ
-//         RFID_delay_ms(1000);
-//     }
-//     return UID;
-// }
-
-// // ͣ
-// unsigned char RFID_PiccHalt(void)
-// {
-//     unsigned char ret = 0;
-//     unsigned short len = 0;
-//     unsigned short info = 0;
-//     unsigned char timeout = RFID_TIMEOUT;
-//     RFID_SendFrame(0x02, 0x04, (unsigned char *)&info, 0x00); // ײ
-//     while (timeout--)
-//     {
-//         // ȴд
-//         len = RFID_GetFrame_len();
-//         if (len)
-//         {
-//             if (BBC_Check(rfid_rx_buffer, len - 2) == rfid_rx_buffer[len - 2]) // ճɹ
-//             {
-//                 ret = 1;
-//                 break;
-//             }
-//         }
-//         IWDG_ReloadCounter(); // ιֹŹλ
-//         RFID_delay_ms(1000);
-//     }
-//     return ret;
-// }
-
-// /**
-//  * @brief һײѡ
-//  *
-//  * @param UID  
-//  * @return unsigned short  SAK
-//  */
-// unsigned short RFID_SelectCard(unsigned int UID)
-// {
-//     unsigned short len = 0;
-//     unsigned char timeout = RFID_TIMEOUT;
-//     unsigned char info[0x05] = {0};
-//     unsigned char SAK = 0;
-
-//     info[0] = 0x93;
-//     // ֽǰ
-//     info[1] = UID & 0xFF;
-//     info[2] = (UID >> 8) & 0xFF;
-//     info[3] = (UID >> 16) & 0xFF;
-//     info[4] = (UID >> 24) & 0xFF;
-//     RFID_SendFrame(0x02, 0x43, info, 0x05);
-
-//     while (timeout--)
-//     {
-//         len = RFID_GetFrame_len();
-//         if (len)
-//         {
-//             printf("ѡӡ");
-//             printf_array(rfid_rx_buffer, len);
-//             // Ӧʽ
-//             if (BBC_Check(rfid_rx_buffer, len - 2) == rfid_rx_buffer[len - 2])
-//             {
-//                 SAK = rfid_rx_buffer[8]; // SAKλãӦǵ9ֽڣ8
-//                 break;
-//             }
-//         }
-//         IWDG_ReloadCounter(); // ιֹŹλ
-//         RFID_delay_ms(1000);
-//     }
-//     return SAK;
-// }
-
-// /**
-//  * @brief ֤
-//  *
-//  * @param keyAB ԿA-0x60 / ԿB-0x61
-//  * @param UID   
-//  * @param key    Կ (6ֽ,ĬԿΪ0xFFFFFFFFFFFF)
-//  * @param block   (S50: 0-63)
-//  * @return unsigned char
-//  */
-// unsigned char RFID_Authentication(unsigned char keyAB, unsigned int UID, unsigned char *key, unsigned char block)
-// {
-//     unsigned short len = 0;
-//     unsigned char timeout = RFID_TIMEOUT;
-//     unsigned char info[0x0C] = {0};
-//     unsigned char status = 0;
-
-//     info[0] = keyAB;
-//     info[1] = UID & 0xFF;
-//     info[2] = (UID >> 8) & 0xFF;
-//     info[3] = (UID >> 16) & 0xFF;
-//     info[4] = (UID >> 24) & 0xFF;
-//     memcpy(&info[5], key, 6);
-//     info[11] = block;
-
-//     RFID_SendFrame(0x02, 0x46, info, 0x0C);
-
-//     while (timeout--)
-//     {
-//         len = RFID_GetFrame_len();
-//         if (len)
-//         {
-//             printf("֤Ӧ");
-//             printf_array(rfid_rx_buffer, len);
-
-//             if (BBC_Check(rfid_rx_buffer, len - 2) == rfid_rx_buffer[len - 2])
-//             {
-//                 // ֤״̬ͨ0x00ʾɹ0x0eʾ֤ʧ
-//                 if (rfid_rx_buffer[4] == 0x00) {
-//                     status = 1;
-//                     printf("֤ɹ\n");
-//                 } else {
-//                     printf("֤ʧܣ״̬: 0x%x\n", rfid_rx_buffer[4]);
-//                 }
-//                 break;
-//             }
-//         }
-//         IWDG_ReloadCounter(); // ιֹŹλ
-//         RFID_delay_ms(1000);
-//     }
-//     return status;
-// }
-
-// /**
-//  * @brief 
-//  *
-//  * @param block  (S50: 0-63)
-//  * @param recv  
-//  * @param recvlen  ݳ(16ֽ)
-//  * @return unsigned char
-//  */
-// unsigned char RFID_ReadCard(unsigned char block, unsigned char *recv, unsigned short recvlen)
-// {
-//     unsigned short len = 0;
-//     unsigned char timeout = RFID_TIMEOUT;
-//     unsigned char info = block;
-//     unsigned char status = 0;
-//     RFID_SendFrame(0x02, 0x47, &info, 0x01); // 
-//     while (timeout--)
-//     {
-//         len = RFID_GetFrame_len();
-//         if (len)
-//         {
-//             if (BBC_Check(rfid_rx_buffer, len - 2) == rfid_rx_buffer[len - 2]) // ճɹ
-//             {
-//                 memcpy(recv, rfid_rx_buffer + 4, recvlen);
-//                 status = 1; // ֤ɹ
-//                 break;
-//             }
-//         }
-//         IWDG_ReloadCounter(); // ιֹŹλ
-//         RFID_delay_ms(1000);
-//     }
-//     return status;
-// }
-
-// /**
-//  * @brief д
-//  *
-//  * @param block  (S50: 0-63)
-//  * @param send  
-//  * @param sendlen  ݳ(16ֽ)
-//  * @return unsigned short
-//  */
-// unsigned char RFID_WriteCard(unsigned char block, unsigned char *send, unsigned short sendlen)
-// {
-//     unsigned short len = 0;
-//     unsigned char timeout = RFID_TIMEOUT;
-//     unsigned char info[0x11] = {0};
-//     unsigned char status = 0;
-
-//     info[0] = block;
-//     memcpy(info + 1, send, sendlen);
-
-//     RFID_SendFrame(0x02, 0x48, info, 0x11);
-//     while (timeout--)
-//     {
-//         len = RFID_GetFrame_len();
-//         if (len)
-//         {
-//             printf("дӦ");
-//             printf_array(rfid_rx_buffer, len);
-
-//             if (len >= 5 && rfid_rx_buffer[1] == 0x02 && rfid_rx_buffer[2] == 0x48)
-//             {
-//                 if (BBC_Check(rfid_rx_buffer, len - 2) == rfid_rx_buffer[len - 2])
-//                 {
-//                     // д
-//                     if (rfid_rx_buffer[4] == 0x00)
-//                     { // ͨ0x00ʾɹ
-//                         status = 1;
-//                         printf("дɹ\n");
-//                     }
-//                     else
-//                     {
-//                         printf("дʧܣ: 0x%x\n", rfid_rx_buffer[4]);
-//                     }
-//                     break;
-//                 }
-//             }
-//         }
-//         IWDG_ReloadCounter(); // ιֹŹλ
-//         RFID_delay_ms(1000);
-//     }
-//     return status;
-// }
-// void RFID_demo(void)
-// {
-//     unsigned char rx_buffer[50];
-//     RFID_dev_init(rx_buffer, sizeof(rx_buffer));
-
-//     printf("=== RFIDԿʼ ===\n");
-//     IWDG_ReloadCounter(); // ιֹŹλ
-    
-//     // 
-//     printf("1. ...\n");
-//     IWDG_ReloadCounter(); // ڳʱǰι
-//     unsigned short ATQ = RFID_Request();
-//     if (ATQ != S50_ATQ)
-//     {
-//         printf("ʧ, ATQ=%#x\n", ATQ);
-//         return;
-//     }
-//     printf("ATQ=%#x\n", ATQ);
-//     delay_ms(500);
-//     IWDG_ReloadCounter(); // ιֹŹλ
-//     // ײ
-//     printf("2. ײ...\n");
-//     IWDG_ReloadCounter(); // ڳʱǰι
-//     unsigned int UID = RFID_Anticollision();
-//     if (!UID)
-//     {
-//         printf("ײʧ\n");
-//         return;
-//     }
-//     printf("UID=%#x\n", UID);
-//     delay_ms(500);
-//     IWDG_ReloadCounter(); // ιֹŹλ
-//     // ѡ
-//     printf("3. ѡ...\n");
-//     IWDG_ReloadCounter(); // ڳʱǰι
-//     unsigned short SAK = RFID_SelectCard(UID);
-//     printf("SAK=%#x\n", SAK);
-//     if (SAK != S50_SAK)
-//     {
-//         printf("ѡʧܣSAK=%#xʵSAK=%#x\n", S50_SAK, SAK);
-//         // ԣЩƬSAKͬ
-//     }
-//     delay_ms(500);
-//     IWDG_ReloadCounter(); // ιֹŹλ
-//     // ֤
-//     printf("4. ֤...\n");
-//     IWDG_ReloadCounter(); // ڳʱǰι
-//     unsigned char key[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-//     if (!RFID_Authentication(0x61, UID, key, 62))
-//     {
-//         printf("֤ʧ\n");
-//         return;
-//     }
-//     delay_ms(500);
-//     IWDG_ReloadCounter(); // ιֹŹλ
-//     // д
-//     printf("5. д...\n");
-//     IWDG_ReloadCounter(); // ڳʱǰι
-//     unsigned char send[16] = {0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8,
-//                               0x9, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16};
-//     if (!RFID_WriteCard(62, send, 16))
-//     {
-//         printf("дʧ\n");
-//         // Զ
-//     }
-//     delay_ms(500);
-//     IWDG_ReloadCounter(); // ιֹŹλ
-//     // 
-//     printf("6. ...\n");
-//     IWDG_ReloadCounter(); // ڳʱǰι
-//     unsigned char recv[16] = {0};
-//     if (!RFID_ReadCard(62, recv, 16))
-//     {
-//         printf("ʧ\n");
-//         return;
-//     }
-//     printf("ɹ:\n");
-//     printf_array(recv, 16);
-//     IWDG_ReloadCounter(); // ιֹŹλ
-//     printf("=== RFIDԽ ===\n");
-// }
+/**
+ * @file rfid.c
+ * @brief 串口 RFID 读卡模块的协议引擎实现（见 rfid.h）
+ */
+
+#include "rfid.h"
+#include <string.h>
+
+// =============================================================================
+// 组帧
+// =============================================================================
+
+uint8_t Rfid_Bcc(const uint8_t *data, uint32_t len)
+{
+    uint8_t x = 0;
+
+    for (uint32_t i = 0; i < len; i++) {
+        x ^= data[i];
+    }
+    return (uint8_t)~x;
+}
+
+/**
+ * @brief 组一帧
+ * @return 帧长，信息过长时为 0
+ */
+uint32_t Rfid_Build(uint8_t *frame, uint8_t type, uint8_t cmd, const uint8_t *info, uint32_t n)
+{
+    uint32_t len = n + RFID_FRAME_MIN;
+
+    if (n > RFID_INFO_MAX) {
+        return 0;
+    }
+    frame[0] = (uint8_t)len;
+    frame[1] = type;
+    frame[2] = cmd;
+    frame[3] = (uint8_t)n;
+    if (n > 0) {
+        memcpy(&frame[4], info, n);
+    }
+    frame[len - 2] = Rfid_Bcc(frame, len - 2);
+    frame[len - 1] = RFID_ETX;
+    return len;
+}
+
+// =============================================================================
+// 解析
+// =============================================================================
+
+void RfidParser_Init(RfidParser *p, RfidFrameHandler on_frame, void *ctx)
+{
+    memset(p, 0, sizeof(*p));
+    p->on_frame = on_frame;
+    p->ctx = ctx;
+}
+
+#define CHECK_MORE      0
+#define CHECK_DONE      1
+#define CHECK_BAD       2
+
+// 检查第 pos 个字节（之前的字节已经通过检查，p->bcc 为它们的异或）
+static int check_byte(RfidParser *p, uint32_t pos, uint8_t b)
+{
+    uint32_t len = p->buf[0];
+    uint8_t bcc = (uint8_t)~p->bcc;
+
+    if (pos == 0) {
+        return (b < RFID_FRAME_MIN || b > RFID_FRAME_MAX) ? CHECK_BAD : CHECK_MORE;
+    }
+    if (pos == 3 && b != len - RFID_FRAME_MIN) {
+        p->stats.bad_len++;
+        return CHECK_BAD;
+    }
+    if (pos == len - 2 && b != bcc) {
+        p->stats.bad_bcc++;
+        return CHECK_BAD;
+    }
+    if (pos == len - 1) {
+        if (b != RFID_ETX) {
+            p->stats.bad_etx++;
+            return CHECK_BAD;
+        }
+        return CHECK_DONE;
+    }
+    return CHECK_MORE;
+}
+
+/**
+ * @brief 送入收到的字节，每收到一帧调用一次 on_frame
+ * @details buf[0..n-1] 为已通过检查的帧头部分，之后到 end 为还没检查的字节。
+ *          某个字节检查不通过时丢弃候选帧的第一个字节，其余字节从头重新检查（帧可能从中间开始），
+ *          所以 buf 里的字节从不超过一帧。
+ */
+void RfidParser_Feed(RfidParser *p, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t k = 0; k < len; k++) {
+        uint32_t end = p->n;
+
+        p->buf[end++] = data[k];
+        while (p->n < end) {
+            uint8_t b = p->buf[p->n];
+            int r = check_byte(p, p->n, b);
+
+            if (r == CHECK_MORE) {
+                p->bcc ^= b;
+                p->n++;
+                continue;
+            }
+            if (r == CHECK_DONE) {
+                uint32_t flen = p->n + 1;
+
+                p->stats.frames++;
+                if (p->on_frame != 0) {
+                    p->on_frame(p->ctx, p->buf, flen);
+                }
+                end -= flen;
+                memmove(p->buf, p->buf + flen, end);
+            } else {
+                p->stats.skipped++;
+                end--;
+                memmove(p->buf, p->buf + 1, end);
+            }
+            p->n = 0;
+            p->bcc = 0;
+        }
+    }
+}
+
+// =============================================================================
+// 请求引擎
+// =============================================================================
+
+static void engine_frame(void *ctx, const uint8_t *frame, uint32_t len);
+
+void RfidEngine_Init(RfidEngine *e, const RfidPort *port, uint32_t now_ms)
+{
+    memset(e, 0, sizeof(*e));
+    e->port = *port;
+    e->pipeline = RFID_PIPELINE;
+    e->now = now_ms;
+    RfidParser_Init(&e->parser, engine_frame, e);
+}
+
+uint32_t RfidEngine_Pending(const RfidEngine *e)
+{
+    return e->head - e->tail;
+}
+
+static uint8_t in_flight(const RfidEngine *e, uint8_t cmd)
+{
+    for (uint32_t i = e->tail; i != e->sent; i++) {
+        if (e->q[i % RFID_QUEUE].cmd == cmd) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 在途不满时按顺序发出排队的请求；在途请求的截止时间从前一个的截止时间算起（读卡模块串行处理）。
+// 应答只能按命令码区分，同一命令码不同时在途：否则前一个的应答丢失时后一个的应答会被当成前一个的
+static void kick(RfidEngine *e)
+{
+    while (e->sent != e->head && e->sent - e->tail < e->pipeline) {
+        RfidRequest *r = &e->q[e->sent % RFID_QUEUE];
+        uint32_t base = e->now;
+
+        if (in_flight(e, r->cmd)) {
+            return;
+        }
+        if (e->port.send(e->port.ctx, r->frame, r->len) == 0) {
+            e->stats.tx_busy++;
+            return;
+        }
+        if (e->sent != e->tail) {
+            uint32_t prev = e->q[(e->sent - 1) % RFID_QUEUE].deadline;
+
+            if ((int32_t)(prev - base) > 0) {
+                base = prev;
+            }
+        }
+        r->sent_at = e->now;
+        r->deadline = base + RFID_TIMEOUT_MS;
+        e->sent++;
+    }
+}
+
+// 结束最早的在途请求：先出队再回调，回调中可以提交新请求
+static void complete(RfidEngine *e, int status, const uint8_t *info, uint32_t len)
+{
+    RfidRequest *r = &e->q[e->tail % RFID_QUEUE];
+    RfidDoneFn done = r->done;
+    void *ctx = r->ctx;
+    uint8_t cmd = r->cmd;
+
+    if (status == RFID_OK) {
+        uint32_t rtt = e->now - r->sent_at;
+
+        e->stats.completed++;
+        if (rtt > e->stats.max_rtt) {
+            e->stats.max_rtt = rtt;
+        }
+    } else if (status == RFID_ERR_TIMEOUT) {
+        e->stats.timeouts++;
+    } else {
+        e->stats.lost++;
+    }
+    e->tail++;
+    if (e->tail != e->sent) {
+        // 读卡模块开始处理下一条：它的应答最迟在 RFID_TIMEOUT_MS 内到达
+        RfidRequest *next = &e->q[e->tail % RFID_QUEUE];
+        uint32_t limit = e->now + RFID_TIMEOUT_MS;
+
+        if ((int32_t)(next->deadline - limit) > 0) {
+            next->deadline = limit;
+        }
+    }
+    if (done != 0) {
+        done(ctx, cmd, status, info, len);
+    }
+}
+
+// 应答与最早的同命令码在途请求匹配，之前的在途请求的应答已经丢失
+static void engine_frame(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    RfidEngine *e = (RfidEngine *)ctx;
+    uint32_t m;
+
+    for (m = e->tail; m != e->sent; m++) {
+        if (e->q[m % RFID_QUEUE].cmd == frame[2]) {
+            break;
+        }
+    }
+    if (m == e->sent) {
+        e->stats.unmatched++;
+        return;
+    }
+    while (e->tail != m) {
+        complete(e, RFID_ERR_LOST, 0, 0);
+    }
+    complete(e, RFID_OK, &frame[4], len - RFID_FRAME_MIN);
+}
+
+/**
+ * @brief 提交一个请求，发送器空闲且在途不满时立即发出
+ * @param done 完成回调（在 RfidEngine_Input/Poll 中调用），可为 NULL
+ * @return RFID_OK，RFID_ERR_FULL 或 RFID_ERR_PARAM
+ */
+int RfidEngine_Submit(RfidEngine *e, uint8_t cmd, const uint8_t *info, uint32_t n, RfidDoneFn done, void *ctx)
+{
+    RfidRequest *r;
+
+    if (n > RFID_INFO_MAX) {
+        return RFID_ERR_PARAM;
+    }
+    if (e->head - e->tail >= RFID_QUEUE) {
+        e->stats.full++;
+        return RFID_ERR_FULL;
+    }
+    r = &e->q[e->head % RFID_QUEUE];
+    r->len = (uint8_t)Rfid_Build(r->frame, RFID_TYPE_ISO14443A, cmd, info, n);
+    r->cmd = cmd;
+    r->done = done;
+    r->ctx = ctx;
+    e->head++;
+    e->stats.submitted++;
+    kick(e);
+    return RFID_OK;
+}
+
+/**
+ * @brief 送入串口收到的字节：完成匹配的请求，空出的在途位置立即发出下一个
+ */
+void RfidEngine_Input(RfidEngine *e, const uint8_t *data, uint32_t len, uint32_t now_ms)
+{
+    e->now = now_ms;
+    RfidParser_Feed(&e->parser, data, len);
+    kick(e);
+}
+
+/**
+ * @brief 超时检查与发送，至少每个节拍调用一次
+ */
+void RfidEngine_Poll(RfidEngine *e, uint32_t now_ms)
+{
+    e->now = now_ms;
+    while (e->tail != e->sent && (int32_t)(now_ms - e->q[e->tail % RFID_QUEUE].deadline) >= 0) {
+        complete(e, RFID_ERR_TIMEOUT, 0, 0);
+    }
+    kick(e);
+}
+
+// =============================================================================
+// 寻卡
+// =============================================================================
+
+void RfidScan_Init(RfidScan *s, RfidEngine *engine, RfidCardFn on_card, void *ctx)
+{
+    memset(s, 0, sizeof(*s));
+    s->engine = engine;
+    s->on_card = on_card;
+    s->ctx = ctx;
+    s->absent = RFID_SCAN_GONE;     // 开机时已经放着的卡也上报
+    s->enabled = 1;
+    s->next_at = engine->now;
+}
+
+void RfidScan_Enable(RfidScan *s, uint8_t on)
+{
+    if (on && !s->enabled) {
+        s->next_at = s->engine->now;
+    }
+    s->enabled = on;
+}
+
+static void scan_done(void *ctx, uint8_t cmd, int status, const uint8_t *info, uint32_t len);
+
+static uint32_t get_uid(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void scan_submit(RfidScan *s, uint8_t cmd, const uint8_t *info, uint32_t n)
+{
+    if (RfidEngine_Submit(s->engine, cmd, info, n, scan_done, s) == RFID_OK) {
+        s->pending++;
+    } else {
+        s->failed = 1;
+    }
+}
+
+static void scan_end(RfidScan *s)
+{
+    uint32_t now = s->engine->now, took = now - s->started;
+
+    s->stats.cycles++;
+    if (took > s->stats.max_cycle) {
+        s->stats.max_cycle = took;
+    }
+    if (s->got) {
+        s->stats.reads++;
+        if (s->absent >= RFID_SCAN_GONE || s->cur.uid != s->last_uid) {
+            s->stats.reported++;
+            if (s->on_card != 0) {
+                s->on_card(s->ctx, &s->cur);
+            }
+        }
+        s->last_uid = s->cur.uid;
+        s->absent = 0;
+    } else if (s->failed && !s->no_card) {
+        s->stats.errors++;              // 说不清有没有卡，不计入离开，立即再读一轮
+        s->next_at = now;
+        return;
+    } else {
+        s->stats.empty++;
+        if (s->absent < RFID_SCAN_GONE) {
+            s->absent++;
+        }
+    }
+    s->next_at = now + RFID_SCAN_PERIOD_MS;
+}
+
+// 流水线时 REQUEST 与 ANTICOLL 一起在途：无卡时两者都回失败状态；一问一答时 REQUEST 见到卡才发 ANTICOLL
+static void scan_done(void *ctx, uint8_t cmd, int status, const uint8_t *info, uint32_t len)
+{
+    RfidScan *s = (RfidScan *)ctx;
+
+    s->pending--;
+    if (status != RFID_OK) {
+        s->failed = 1;
+    } else if (cmd == RFID_CMD_REQUEST) {
+        if (len < 2) {
+            s->no_card = 1;
+        } else {
+            s->cur.atq = (uint16_t)(info[0] | (info[1] << 8));
+            if (s->engine->pipeline < 2) {
+                static const uint8_t anticoll[2] = { RFID_SEL_CODE, 0x00 };
+
+                scan_submit(s, RFID_CMD_ANTICOLL, anticoll, sizeof(anticoll));
+            }
+        }
+    } else if (cmd == RFID_CMD_ANTICOLL) {
+        if (len >= 4 && s->cur.atq == 0) {
+            s->failed = 1;              // 卡在 REQUEST 之后才进入（或 REQUEST 的应答丢失），下一轮再读
+        } else if (len >= 4) {
+            uint8_t sel[5];
+
+            s->cur.uid = get_uid(info);
+            sel[0] = RFID_SEL_CODE;
+            memcpy(&sel[1], info, 4);
+            scan_submit(s, RFID_CMD_SELECT, sel, sizeof(sel));
+        }
+    } else if (cmd == RFID_CMD_SELECT) {
+        if (len >= 5 && get_uid(info) == s->cur.uid) {
+            s->cur.sak = info[4];
+            s->cur.t_ms = s->engine->now;
+            s->got = 1;
+        } else {
+            s->failed = 1;              // 选卡失败：卡在两条命令之间离开
+        }
+    }
+    if (s->pending == 0) {
+        scan_end(s);
+    }
+}
+
+/**
+ * @brief 到时间时开始新的一轮，至少每个节拍调用一次（在 RfidEngine_Poll 之前或之后都可以）
+ */
+void RfidScan_Poll(RfidScan *s, uint32_t now_ms)
+{
+    static const uint8_t req = RFID_REQ_ALL;
+    static const uint8_t anticoll[2] = { RFID_SEL_CODE, 0x00 };
+
+    if (!s->enabled || s->pending != 0 || (int32_t)(now_ms - s->next_at) < 0) {
+        return;
+    }
+    memset(&s->cur, 0, sizeof(s->cur));
+    s->failed = 0;
+    s->got = 0;
+    s->no_card = 0;
+    s->started = now_ms;
+    scan_submit(s, RFID_CMD_REQUEST, &req, 1);
+    if (s->engine->pipeline >= 2) {
+        scan_submit(s, RFID_CMD_ANTICOLL, anticoll, sizeof(anticoll));
+    }
+    if (s->pending == 0) {
+        s->next_at = now_ms + RFID_SCAN_PERIOD_MS;      // 队列满（其它请求占用），下一轮再试
+    }
+}
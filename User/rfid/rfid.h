@@ -1,28 +1,212 @@
-// #ifndef RFID_H
-// #define RFID_H
+/**
+ * @file rfid.h
+ * @brief 串口 RFID 读卡模块的协议引擎：增量帧解析、请求/应答匹配与超时、流水线、寻卡流程
+ * @details 命令和应答都是同一种帧：
+ *
+ *            帧长(1) 命令类型(1) 命令(1) 信息长度 n(1) 信息(n) BCC(1) 0x03
+ *
+ *          帧长 = n + 6，BCC 为 BCC 之前所有字节的异或取反。应答的第 3 字节回显命令码
+ *          （原来写卡的代码检查 rx[2] == 0x48），成功时信息为结果（ATQ、UID、SAK、块数据），
+ *          失败（无卡、认证失败）时信息为 1 字节非 0 状态。
+ *
+ *          RfidParser 逐字节检查：帧长在第 1 字节、信息长度在第 4 字节、BCC 在倒数第 2 字节、
+ *          ETX 在最后 1 字节，任何一项不对立即丢弃一个字节重新同步，不等整帧收完，也不依赖 IDLE 分帧。
+ *
+ *          RfidEngine 维护请求队列：最多 RFID_PIPELINE 个请求同时在途，前一个还没有应答时下一个已经发出
+ *          （读卡模块串行处理，命令在它的接收缓冲区里排队），应答按命令码与在途请求匹配
+ *          （同一命令码不同时在途，匹配没有歧义）；
+ *          被跳过的更早请求（应答丢失）立即失败，没有应答的请求在截止时间到时超时。
+ *          RfidScan 在引擎之上循环寻卡：REQUEST 与 ANTICOLL 一起发出，得到 UID 后 SELECT，
+ *          新卡（或离开后重新放上的卡）的 UID、ATQ、SAK 通过回调交出。
+ *
+ *          本模块不依赖 FreeRTOS 和硬件：发送由 RfidPort 提供，时间由调用方传入
+ *          （固件见 rfid_service.c，主机端的读卡模块模拟见 simulator/src/rfid_reader_sim.c）。
+ */
 
-// /********************ЩҪ************************* */
-// #include "rfid_uart.h"
-// #include "delay.h"
-// // ýյݻ
-// #define RFID_Init(rx_buffer, len)   RFID_Uart2_Rx_DMA_Init(rx_buffer, len)
+#ifndef RFID_H
+#define RFID_H
 
-// // ָȵrfid
-// #define RFID_SendBytes(data, len)   RFID_Uart2_SendBytes(data, len)
+#include <stdint.h>
 
-// // ݺյrfidصݳ
-// #define RFID_GetFrame_len()          RFID_Uart2_Recv_Len() 
+// =============================================================================
+// 协议常量
+// =============================================================================
+#define RFID_FRAME_MIN      6       ///< 没有信息字节的帧长
+#define RFID_INFO_MAX       24      ///< 最长信息（写块：块号 + 16 字节）
+#define RFID_FRAME_MAX      (RFID_FRAME_MIN + RFID_INFO_MAX)
+#define RFID_ETX            0x03
 
-// // ʱ
-// #define RFID_delay_ms(ms) 			 delay_ms(ms)
-// /***************************end************************** */
+#define RFID_TYPE_ISO14443A 0x02    ///< 命令类型：ISO14443A（Mifare）命令
 
-// #define RFID_FRAME_MAX_LEN		128		// rfid֡󳤶
-// #define RFID_TIMEOUT			3		// rfid֡ճʱʱ3S
-// #define RFID_ETX				0X03	// 
-// #define S50_ATQ					0x0004	// ʱS50ATQ
-// #define S50_SAK					0x08	// һײѡʱS50SAK
+// 命令码
+#define RFID_CMD_REQUEST    0x41    ///< 请求，信息 0x52（所有卡），应答 ATQ(2)
+#define RFID_CMD_ANTICOLL   0x42    ///< 防碰撞，信息 0x93 0x00，应答 UID(4)
+#define RFID_CMD_SELECT     0x43    ///< 选卡，信息 0x93 UID(4)，应答 UID(4) SAK(1)
+#define RFID_CMD_HALT       0x44    ///< 挂起
+#define RFID_CMD_AUTH       0x46    ///< 认证，信息 密钥类型(1) UID(4) 密钥(6) 块号(1)，应答 状态(1)
+#define RFID_CMD_READ       0x47    ///< 读块，信息 块号(1)，应答 数据(16)
+#define RFID_CMD_WRITE      0x48    ///< 写块，信息 块号(1) 数据(16)，应答 状态(1)
 
-// void RFID_demo(void);
+#define RFID_REQ_ALL        0x52    ///< 请求所有卡（包括挂起的）
+#define RFID_SEL_CODE       0x93    ///< 一级级联
+#define RFID_ATQ_S50        0x0004
+#define RFID_SAK_S50        0x08
 
-// #endif
+// =============================================================================
+// 配置参数
+// =============================================================================
+#ifndef RFID_QUEUE
+#define RFID_QUEUE          8       ///< 请求队列（包括在途的），2 的幂
+#endif
+#ifndef RFID_PIPELINE
+#define RFID_PIPELINE       2       ///< 同时在途的请求数，1 为一问一答
+#endif
+#define RFID_TIMEOUT_MS     100     ///< 每个在途请求的应答时间（9600bps 下最长的帧约 31ms）
+#define RFID_SCAN_PERIOD_MS 50      ///< 一轮寻卡结束到下一轮开始（说不清有没有卡的一轮之后立即再读）
+#define RFID_SCAN_GONE      3       ///< 连续这么多轮没有卡，认为卡已离开，再放上时重新上报
+
+// =============================================================================
+// 返回值
+// =============================================================================
+#define RFID_OK             0
+#define RFID_ERR_TIMEOUT    -1      ///< 截止时间内没有应答
+#define RFID_ERR_LOST       -2      ///< 后发的请求先得到应答，这个请求的应答丢失
+#define RFID_ERR_FULL       -3      ///< 请求队列满
+#define RFID_ERR_PARAM      -4      ///< 信息过长
+
+/**
+ * @brief 帧解析器统计
+ */
+typedef struct {
+    uint32_t frames;        ///< 完整有效的帧
+    uint32_t bad_len;       ///< 帧长或信息长度不对
+    uint32_t bad_bcc;
+    uint32_t bad_etx;
+    uint32_t skipped;       ///< 重新同步时丢弃的字节
+} RfidParser_Stats;
+
+typedef void (*RfidFrameHandler)(void *ctx, const uint8_t *frame, uint32_t len);
+
+/**
+ * @brief 增量帧解析器
+ */
+typedef struct {
+    uint8_t          buf[RFID_FRAME_MAX];
+    uint32_t         n;
+    uint8_t          bcc;       ///< buf[0..n-1] 的异或
+    RfidFrameHandler on_frame;
+    void            *ctx;
+    RfidParser_Stats stats;
+} RfidParser;
+
+/**
+ * @brief 请求完成回调
+ * @param status RFID_OK 时 info/len 为应答的信息字段（回调返回后失效），否则为 RFID_ERR_*
+ */
+typedef void (*RfidDoneFn)(void *ctx, uint8_t cmd, int status, const uint8_t *info, uint32_t len);
+
+/**
+ * @brief 串口发送接口：整帧发送，发送器忙时返回 0（引擎下次 Poll 再试），不阻塞
+ */
+typedef struct {
+    uint32_t (*send)(void *ctx, const uint8_t *frame, uint32_t len);
+    void      *ctx;
+} RfidPort;
+
+/**
+ * @brief 引擎统计
+ */
+typedef struct {
+    uint32_t submitted;
+    uint32_t completed;     ///< 得到应答的请求
+    uint32_t timeouts;
+    uint32_t lost;
+    uint32_t full;          ///< 队列满而拒绝的请求
+    uint32_t unmatched;     ///< 没有对应在途请求的应答（超时之后才到达等）
+    uint32_t tx_busy;       ///< 发送器忙而推迟的次数
+    uint32_t max_rtt;       ///< 最长的发出到应答时间（ms）
+} RfidEngine_Stats;
+
+/**
+ * @brief 队列中的一个请求
+ */
+typedef struct {
+    uint8_t    frame[RFID_FRAME_MAX];
+    uint8_t    len;
+    uint8_t    cmd;
+    uint32_t   sent_at;
+    uint32_t   deadline;
+    RfidDoneFn done;
+    void      *ctx;
+} RfidRequest;
+
+typedef struct {
+    RfidPort         port;
+    RfidParser       parser;
+    RfidRequest      q[RFID_QUEUE];
+    uint32_t         head;      ///< 下一个空位（自由计数）
+    uint32_t         sent;      ///< 下一个要发送的
+    uint32_t         tail;      ///< 最早的在途请求，tail..sent-1 在途
+    uint8_t          pipeline;  ///< 同时在途的请求数，RfidEngine_Init 设为 RFID_PIPELINE
+    uint32_t         now;
+    RfidEngine_Stats stats;
+} RfidEngine;
+
+/**
+ * @brief 读到的卡
+ */
+typedef struct {
+    uint32_t uid;           ///< 防碰撞应答的 4 字节，小端
+    uint16_t atq;
+    uint8_t  sak;
+    uint32_t t_ms;          ///< 读到的时间
+} RfidCard;
+
+typedef void (*RfidCardFn)(void *ctx, const RfidCard *card);
+
+/**
+ * @brief 寻卡统计
+ */
+typedef struct {
+    uint32_t cycles;
+    uint32_t empty;         ///< 没有卡的轮数
+    uint32_t reads;         ///< 读到 UID 的轮数
+    uint32_t reported;      ///< 上报的卡（新卡或重新放上的卡）
+    uint32_t errors;        ///< 超时、应答丢失或选卡失败的轮数
+    uint32_t max_cycle;     ///< 最长的一轮（ms）
+} RfidScan_Stats;
+
+typedef struct {
+    RfidEngine    *engine;
+    RfidCardFn     on_card;
+    void          *ctx;
+    uint8_t        enabled;
+    uint8_t        pending;     ///< 本轮在途的请求数，为 0 时本轮结束
+    uint8_t        failed;
+    uint8_t        got;         ///< 本轮选卡成功
+    uint8_t        no_card;     ///< 本轮 REQUEST 应答无卡
+    uint8_t        absent;      ///< 连续没有卡的轮数
+    uint32_t       next_at;
+    uint32_t       started;
+    RfidCard       cur;
+    uint32_t       last_uid;
+    RfidScan_Stats stats;
+} RfidScan;
+
+uint8_t Rfid_Bcc(const uint8_t *data, uint32_t len);
+uint32_t Rfid_Build(uint8_t *frame, uint8_t type, uint8_t cmd, const uint8_t *info, uint32_t n);
+
+void RfidParser_Init(RfidParser *p, RfidFrameHandler on_frame, void *ctx);
+void RfidParser_Feed(RfidParser *p, const uint8_t *data, uint32_t len);
+
+void RfidEngine_Init(RfidEngine *e, const RfidPort *port, uint32_t now_ms);
+int RfidEngine_Submit(RfidEngine *e, uint8_t cmd, const uint8_t *info, uint32_t n, RfidDoneFn done, void *ctx);
+void RfidEngine_Input(RfidEngine *e, const uint8_t *data, uint32_t len, uint32_t now_ms);
+void RfidEngine_Poll(RfidEngine *e, uint32_t now_ms);
+uint32_t RfidEngine_Pending(const RfidEngine *e);
+
+void RfidScan_Init(RfidScan *s, RfidEngine *engine, RfidCardFn on_card, void *ctx);
+void RfidScan_Enable(RfidScan *s, uint8_t on);
+void RfidScan_Poll(RfidScan *s, uint32_t now_ms);
+
+#endif
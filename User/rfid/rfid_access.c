@@ -0,0 +1,264 @@
+/**
+ * @file rfid_access.c
+ * @brief 门禁：卡片登记表的固件端（RAM 表、Flash 分区、存储任务与串口命令）
+ */
+
+#include "rfid_access.h"
+#include "../code/flash_layout.h"
+#include "../code/shell.h"
+#include "../ff16/storage_service.h"
+#include "../ui/persist.h"
+#include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+
+// 满表的快照之外至少留 4 个扇区（512 条记录）给日志，否则压缩过于频繁
+#if (TAG_DB_MAX + 1) * TAG_RECORD_SIZE + 4 * W25Q128_SECTOR_SIZE > FLASH_TAG_AREA_SIZE
+#error "rfid_access.h: TAG_DB_MAX too large for FLASH_TAG_AREA_SIZE"
+#endif
+
+static TagEntry tag_entries[TAG_DB_MAX];
+// 哈希槽只由 CPU 访问，放在 CCM RAM
+__attribute__((section(".ccmram")))
+static uint16_t tag_slots[TAG_DB_SLOTS];
+static TagTable tag_table;
+static TagStore tag_store = TAG_STORE_INIT(FLASH_TAG_BASE, FLASH_TAG_AREA_SIZE);
+static Access_Stats access_stats;
+
+// =============================================================================
+// 存储任务中执行
+// =============================================================================
+
+/**
+ * @brief 登记/删除请求，同时作为 job 的参数
+ */
+typedef struct {
+    uint32_t    uid;
+    uint16_t    perm;
+    const char *name;       ///< NULL 表示删除
+    int         rc;         ///< 输出：TAG_OK / TAG_ERR_*
+} AccessEdit;
+
+static FRESULT access_load_job(void *ctx)
+{
+    int rc;
+
+    (void)ctx;
+    taskENTER_CRITICAL();
+    TagTable_Init(&tag_table, tag_entries, TAG_DB_MAX, tag_slots, TAG_DB_SLOTS);
+    taskEXIT_CRITICAL();
+    // 启动时调用，此时还没有其它任务查找；之后表只在存储任务中增删
+    rc = TagStore_Load(&tag_store, &tag_table);
+    return rc == TAG_OK ? FR_OK : FR_DISK_ERR;
+}
+
+static FRESULT access_edit_job(void *ctx)
+{
+    AccessEdit *ed = (AccessEdit *)ctx;
+    TagEntry copy;
+
+    taskENTER_CRITICAL();
+    if (ed->name != NULL) {
+        ed->rc = TagTable_Put(&tag_table, ed->uid, ed->perm, ed->name);
+        if (ed->rc == TAG_OK) {
+            copy = *TagTable_Find(&tag_table, ed->uid);
+        }
+    } else {
+        ed->rc = TagTable_Remove(&tag_table, ed->uid);
+    }
+    taskEXIT_CRITICAL();
+    if (ed->rc != TAG_OK) {
+        return FR_OK;
+    }
+    ed->rc = ed->name != NULL ? TagStore_Put(&tag_store, &copy) : TagStore_Delete(&tag_store, ed->uid);
+    return FR_OK;
+}
+
+/**
+ * @brief 把标记为脏的最后刷卡时间追加到日志（persist.c 在存储任务中调用）
+ * @return 0 成功，-1 有记录写入失败（已重新标记为脏）
+ */
+int RFID_Access_SaveSeen(void)
+{
+    int ret = 0;
+
+    for (uint32_t i = 0; i < tag_table.count; i++) {
+        uint32_t uid = 0, seen = 0;
+
+        taskENTER_CRITICAL();
+        if (tag_entries[i].flags & TAG_FLAG_SEEN_DIRTY) {
+            tag_entries[i].flags &= ~TAG_FLAG_SEEN_DIRTY;
+            uid = tag_entries[i].uid;
+            seen = tag_entries[i].last_seen;
+        }
+        taskEXIT_CRITICAL();
+        if (uid != 0 && TagStore_Seen(&tag_store, uid, seen) != TAG_OK) {
+            taskENTER_CRITICAL();
+            tag_entries[i].flags |= TAG_FLAG_SEEN_DIRTY;
+            taskEXIT_CRITICAL();
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+// =============================================================================
+// 接口
+// =============================================================================
+
+/**
+ * @brief 从 Flash 载入登记表（main 中调用，调度器启动前在调用方同步执行）
+ * @return 0 成功，-1 失败（表为空，仍可使用）
+ */
+int RFID_Access_Init(void)
+{
+    return Storage_Call(access_load_job, NULL, STORAGE_PRIO_INTERACTIVE) == FR_OK ? 0 : -1;
+}
+
+/**
+ * @brief 当前时间：2000-01-01 起的秒数（RTC）
+ */
+uint32_t RFID_Access_Now(void)
+{
+    static const uint16_t month_days[12] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+    RTC_TimeTypeDef time;
+    RTC_DateTypeDef date;
+    uint32_t days;
+
+    RTC_GetTime(RTC_Format_BIN, &time);
+    RTC_GetDate(RTC_Format_BIN, &date);
+    if (date.RTC_Month < 1 || date.RTC_Month > 12) {
+        return 0;
+    }
+    days = date.RTC_Year * 365u + (date.RTC_Year + 3u) / 4u + month_days[date.RTC_Month - 1] + date.RTC_Date - 1u;
+    if (date.RTC_Year % 4 == 0 && date.RTC_Month > 2) {
+        days++;
+    }
+    return days * 86400u + time.RTC_Hours * 3600u + time.RTC_Minutes * 60u + time.RTC_Seconds;
+}
+
+/**
+ * @brief 刷卡：查找 UID 并记下刷卡时间，只访问 RAM
+ * @param tag 输出：登记的条目，last_seen 为这次之前的刷卡时间（未登记时不修改）
+ */
+AccessResult RFID_Access_Swipe(uint32_t uid, TagEntry *tag)
+{
+    uint32_t now = RFID_Access_Now();
+    AccessResult r = ACCESS_UNKNOWN;
+    TagEntry *e;
+
+    taskENTER_CRITICAL();
+    access_stats.swipes++;
+    e = tag_table.entries != NULL ? TagTable_Find(&tag_table, uid) : NULL;
+    if (e != NULL) {
+        *tag = *e;
+        e->last_seen = now;
+        e->flags |= TAG_FLAG_SEEN_DIRTY;
+        r = (e->perm & ACCESS_PERM_DOOR) ? ACCESS_GRANTED : ACCESS_DENIED;
+    }
+    if (r == ACCESS_GRANTED) {
+        access_stats.granted++;
+    } else if (r == ACCESS_DENIED) {
+        access_stats.denied++;
+    } else {
+        access_stats.unknown++;
+    }
+    taskEXIT_CRITICAL();
+    if (e != NULL) {
+        Persist_MarkDirty(PERSIST_OBJ_TAGS);
+    }
+    return r;
+}
+
+void RFID_Access_GetStats(Access_Stats *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = access_stats;
+    taskEXIT_CRITICAL();
+}
+
+// =============================================================================
+// 串口命令
+// =============================================================================
+
+static int access_edit(AccessEdit *ed)
+{
+    if (Storage_Call(access_edit_job, ed, STORAGE_PRIO_INTERACTIVE) != FR_OK) {
+        return SHELL_ERR_FAIL;
+    }
+    if (ed->rc == TAG_ERR_FULL) {
+        printf("tag table full (%u)\r\n", TAG_DB_MAX);
+    } else if (ed->rc == TAG_ERR_NOT_FOUND) {
+        printf("no such tag\r\n");
+    } else if (ed->rc == TAG_ERR_PARAM) {
+        return SHELL_ERR_USAGE;
+    }
+    return ed->rc == TAG_OK ? SHELL_OK : SHELL_ERR_FAIL;
+}
+
+// tag_add <uid> <perm> <name>：已登记时修改权限和名字
+static int cmd_tag_add(uint32_t argc, const Shell_Arg *argv)
+{
+    AccessEdit ed = { argv[0].u, (uint16_t)argv[1].u, argv[2].s, TAG_OK };
+
+    (void)argc;
+    if (argv[1].u > 0xFFFF) {
+        return SHELL_ERR_USAGE;
+    }
+    return access_edit(&ed);
+}
+
+static int cmd_tag_del(uint32_t argc, const Shell_Arg *argv)
+{
+    AccessEdit ed = { argv[0].u, 0, NULL, TAG_OK };
+
+    (void)argc;
+    return access_edit(&ed);
+}
+
+// tag_list：列出登记的卡（列表期间存储任务可能增删，只作显示）和统计
+static int cmd_tag_list(uint32_t argc, const Shell_Arg *argv)
+{
+    const TagTable_Stats *ts = &tag_table.stats;
+    const TagStore_Stats *ss = &tag_store.stats;
+    Access_Stats as;
+
+    (void)argc;
+    (void)argv;
+    for (uint32_t i = 0; i < tag_table.count; i++) {
+        TagEntry e;
+
+        taskENTER_CRITICAL();
+        e = tag_entries[i];
+        taskEXIT_CRITICAL();
+        printf("%08lX perm %04X seen %10lu %s\r\n", (unsigned long)e.uid, e.perm,
+               (unsigned long)e.last_seen, e.name);
+    }
+    RFID_Access_GetStats(&as);
+    printf("tags %lu/%u, swipes %lu (granted %lu, denied %lu, unknown %lu), "
+           "lookups %lu avg probe %lu.%02lu max %lu\r\n",
+           (unsigned long)tag_table.count, TAG_DB_MAX, (unsigned long)as.swipes,
+           (unsigned long)as.granted, (unsigned long)as.denied, (unsigned long)as.unknown,
+           (unsigned long)ts->lookups, (unsigned long)(ts->lookups ? ts->probes / ts->lookups : 0),
+           (unsigned long)(ts->lookups ? ts->probes * 100u / ts->lookups % 100u : 0),
+           (unsigned long)ts->max_probe);
+    printf("tag log: area %u gen %lu used %lu/%lu, replayed %lu, appends %lu, compactions %lu, "
+           "erases %lu, written %lu B, crc errors %lu\r\n",
+           tag_store.active, (unsigned long)tag_store.generation, (unsigned long)tag_store.write_ofs,
+           (unsigned long)tag_store.area_size, (unsigned long)ss->replayed, (unsigned long)ss->appends,
+           (unsigned long)ss->compactions, (unsigned long)ss->erases, (unsigned long)ss->bytes_written,
+           (unsigned long)ss->crc_errors);
+    return SHELL_OK;
+}
+
+static const Shell_Cmd access_cmds[] = {
+    { "tag_add",  "uus", cmd_tag_add,  "tag_add <uid> <perm> <name> register / update a card" },
+    { "tag_del",  "u",   cmd_tag_del,  "tag_del <uid>" },
+    { "tag_list", "",    cmd_tag_list, "list registered cards and statistics" },
+};
+
+void rfid_access_register_commands(void)
+{
+    Shell_Register(access_cmds, sizeof(access_cmds) / sizeof(access_cmds[0]));
+}
@@ -0,0 +1,41 @@
+/**
+ * @file rfid_access.h
+ * @brief 门禁：刷卡后在卡片登记表中查找 UID，立即给出放行/拒绝（登记表见 tag_db.h）
+ * @details 登记表整个放在 RAM 中，启动时从 Flash 分区（FLASH_TAG_BASE）载入，之后：
+ *          - 查找和更新最后刷卡时间只访问 RAM，可以在任何任务中调用，不等存储任务
+ *          - 最后刷卡时间只标记为脏，由 persist.c 在空闲时批量追加到登记表日志
+ *          - 登记/删除在存储任务中修改表并追加一条记录（串口命令 tag_add/tag_del 同步等待结果）
+ *          表的增删只在存储任务中进行，其它任务的查找与之用短临界区互斥。
+ */
+
+#ifndef _RFID_ACCESS_H_
+#define _RFID_ACCESS_H_
+
+#include <stdint.h>
+#include "tag_db.h"
+
+#define TAG_DB_MAX          1024    ///< 最多登记的卡数（每张 24 字节）
+#define TAG_DB_SLOTS        2048    ///< 哈希槽数（2 的幂，每槽 2 字节）
+#define ACCESS_PERM_DOOR    0x0001  ///< 本机放行需要的权限位
+
+typedef enum {
+    ACCESS_UNKNOWN = 0,     ///< 没有登记
+    ACCESS_DENIED,          ///< 已登记，没有 ACCESS_PERM_DOOR
+    ACCESS_GRANTED
+} AccessResult;
+
+typedef struct {
+    uint32_t swipes;
+    uint32_t granted;
+    uint32_t denied;
+    uint32_t unknown;
+} Access_Stats;
+
+int RFID_Access_Init(void);
+AccessResult RFID_Access_Swipe(uint32_t uid, TagEntry *tag);
+uint32_t RFID_Access_Now(void);
+int RFID_Access_SaveSeen(void);
+void RFID_Access_GetStats(Access_Stats *stats);
+void rfid_access_register_commands(void);      // 串口命令 tag_add/tag_del/tag_list
+
+#endif
@@ -0,0 +1,161 @@
+/**
+ * @file rfid_service.c
+ * @brief 后台读卡任务
+ */
+
+#include "rfid_service.h"
+#include "rfid_uart.h"
+#include "../code/shell.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include <stdio.h>
+
+static RfidEngine engine;
+static RfidScan scan;
+static QueueHandle_t card_queue = NULL;
+static TaskHandle_t rfid_task_handle = NULL;
+static uint32_t cards_dropped = 0;
+static volatile uint8_t scan_request = 0;      // 1-打开 2-关闭，由 RFID 任务执行（寻卡状态只在该任务中修改）
+
+static uint32_t port_send(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    (void)ctx;
+    return RFID_Uart2_Send(frame, len);
+}
+
+// 在 RFID 任务中调用：队列满时丢弃最旧的一张
+static void on_card(void *ctx, const RfidCard *card)
+{
+    RfidCard old;
+
+    (void)ctx;
+    if (xQueueSend(card_queue, card, 0) != pdPASS) {
+        xQueueReceive(card_queue, &old, 0);
+        xQueueSend(card_queue, card, 0);
+        cards_dropped++;
+    }
+}
+
+static void rfid_task(void *pvParameters)
+{
+    uint8_t chunk[32];
+
+    (void)pvParameters;
+    while (1) {
+        // 最多等 1 个节拍：没有应答时也要按时检查超时和开始下一轮
+        uint32_t n = RFID_Uart2_Receive(chunk, sizeof(chunk), 1);
+        uint32_t now = (uint32_t)xTaskGetTickCount();
+
+        if (scan_request != 0) {
+            RfidScan_Enable(&scan, scan_request == 1);
+            scan_request = 0;
+        }
+        if (n > 0) {
+            RfidEngine_Input(&engine, chunk, n, now);
+        }
+        RfidEngine_Poll(&engine, now);
+        RfidScan_Poll(&scan, now);
+    }
+}
+
+/**
+ * @brief 初始化 USART2，创建卡队列和 RFID 任务（默认开始寻卡）
+ * @return 0 成功，-1 失败
+ */
+int RFID_Service_Start(void)
+{
+    RfidPort port = { port_send, 0 };
+
+    if (rfid_task_handle != NULL) {
+        return 0;
+    }
+    card_queue = xQueueCreate(RFID_CARD_QUEUE, sizeof(RfidCard));
+    if (card_queue == NULL) {
+        return -1;
+    }
+    RFID_Uart2_Init();
+    RfidEngine_Init(&engine, &port, (uint32_t)xTaskGetTickCount());
+    RfidScan_Init(&scan, &engine, on_card, 0);
+    if (xTaskCreate(rfid_task, "rfid", RFID_TASK_STACK, NULL, RFID_TASK_PRIO, &rfid_task_handle) != pdPASS) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 取出一张新读到的卡，没有时最多等 ticks 个节拍
+ * @return 1 取到，0 没有
+ */
+uint8_t RFID_GetCard(RfidCard *card, uint32_t ticks)
+{
+    if (card_queue == NULL) {
+        return 0;
+    }
+    return xQueueReceive(card_queue, card, ticks) == pdPASS;
+}
+
+/**
+ * @brief 丢弃队列中还没取出的卡（界面进入时调用，不显示进入之前刷的卡）
+ */
+void RFID_FlushCards(void)
+{
+    if (card_queue != NULL) {
+        xQueueReset(card_queue);
+    }
+}
+
+void RFID_Scan_Enable(uint8_t on)
+{
+    scan_request = on ? 1 : 2;
+}
+
+void RFID_GetScanStats(RfidScan_Stats *stats)
+{
+    *stats = scan.stats;    // 各字段单独递增，读到新旧混合的值也只影响显示
+}
+
+// =============================================================================
+// 串口命令
+// =============================================================================
+
+// rfid：打印统计；rfid on|off：开关寻卡
+static int cmd_rfid(uint32_t argc, const Shell_Arg *argv)
+{
+    const RfidScan_Stats *ss = &scan.stats;
+    const RfidEngine_Stats *es = &engine.stats;
+    const RfidParser_Stats *ps = &engine.parser.stats;
+    UartRx_Stats rs;
+
+    if (rfid_task_handle == NULL) {
+        return SHELL_ERR_FAIL;
+    }
+    if (argc > 0) {
+        RFID_Scan_Enable((uint8_t)argv[0].u);
+        return SHELL_OK;
+    }
+    RFID_Uart2_GetRxStats(&rs);
+    printf("scan %s: %lu cycles, %lu empty, %lu reads, %lu cards (%lu dropped), %lu errors, max %lu ms\r\n",
+           scan.enabled ? "on" : "off", (unsigned long)ss->cycles, (unsigned long)ss->empty,
+           (unsigned long)ss->reads, (unsigned long)ss->reported, (unsigned long)cards_dropped,
+           (unsigned long)ss->errors, (unsigned long)ss->max_cycle);
+    printf("requests: %lu sent, %lu replied, %lu timeouts, %lu lost, %lu unmatched, %lu tx busy, max rtt %lu ms\r\n",
+           (unsigned long)es->submitted, (unsigned long)es->completed, (unsigned long)es->timeouts,
+           (unsigned long)es->lost, (unsigned long)es->unmatched, (unsigned long)es->tx_busy,
+           (unsigned long)es->max_rtt);
+    printf("frames: %lu ok, %lu bad len, %lu bad bcc, %lu bad etx, %lu bytes skipped\r\n",
+           (unsigned long)ps->frames, (unsigned long)ps->bad_len, (unsigned long)ps->bad_bcc,
+           (unsigned long)ps->bad_etx, (unsigned long)ps->skipped);
+    printf("usart2 rx: %lu bytes, %lu overrun, %lu errors, %lu dropped\r\n",
+           (unsigned long)rs.bytes, (unsigned long)rs.overrun, (unsigned long)rs.errors, (unsigned long)rs.dropped);
+    return SHELL_OK;
+}
+
+static const Shell_Cmd rfid_cmds[] = {
+    { "rfid", "|b", cmd_rfid, "rfid [on|off] card scanning / stats" },
+};
+
+void rfid_service_register_commands(void)
+{
+    Shell_Register(rfid_cmds, sizeof(rfid_cmds) / sizeof(rfid_cmds[0]));
+}
@@ -0,0 +1,27 @@
+/**
+ * @file rfid_service.h
+ * @brief 后台读卡：RFID 任务在 USART2 上循环寻卡，读到的卡放入队列（协议见 rfid.h）
+ * @details RFID 任务从流缓冲区取出 DMA 收到的字节交给 RfidEngine，每个节拍检查超时、推进寻卡，
+ *          寻卡的请求在引擎中流水线发送，任务本身不为等应答而阻塞。
+ *          新卡通过 RFID_GetCard 取出，队列满时丢弃最旧的；界面（菜单任务）不参与读卡，读卡期间照常刷新和响应按键。
+ *          串口命令 rfid [on|off] 开关寻卡并打印统计。主机端用 simulator 中的读卡模块模拟（rfid_bench）测试。
+ */
+
+#ifndef _RFID_SERVICE_H_
+#define _RFID_SERVICE_H_
+
+#include <stdint.h>
+#include "rfid.h"
+
+#define RFID_TASK_PRIO      2
+#define RFID_TASK_STACK     256     ///< 字
+#define RFID_CARD_QUEUE     4
+
+int RFID_Service_Start(void);
+uint8_t RFID_GetCard(RfidCard *card, uint32_t ticks);
+void RFID_FlushCards(void);
+void RFID_Scan_Enable(uint8_t on);
+void RFID_GetScanStats(RfidScan_Stats *stats);
+void rfid_service_register_commands(void);     // 串口命令 rfid
+
+#endif
@@ -1,145 +1,259 @@
 #include "rfid_uart.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include <string.h>
 
-static uint32_t rx_flag = 0; // 17λ1:յݣ0δյݡ16λյ
-static uint16_t dma_len = 0; // dmaһ
+// 接收：DMA1 Stream5 通道4 循环写入 rx_dma_buf，IDLE/HT/TC 中断把新数据整块送入流缓冲区
+static uint8_t rx_dma_buf[RFID_RX_DMA_SIZE];
+static UartRxRing rx_ring;
+static StreamBufferHandle_t rx_stream = NULL;
+static BaseType_t rx_woken;
 
-void USART2_IRQHandler(void)
+// 发送：DMA1 Stream6 通道4，一次一帧
+static uint8_t tx_buf[RFID_TX_MAX];
+static volatile uint8_t tx_busy = 0;
+
+// USART2 与 DMA1_Stream5 中断优先级相同、不会嵌套，流缓冲区只有这一个写入方
+static uint32_t rx_sink(const uint8_t *data, uint32_t len, void *ctx)
 {
-    uint16_t len = 0; // dmaʵʰlen
-    // жϽձ־λǷ1
-    if (USART_GetITStatus(USART2, USART_IT_IDLE) == SET)
+    (void)ctx;
+    if (rx_stream == NULL)
     {
-        // ȷIDLEжʽȶSRٶDR
-        volatile uint16_t temp;
-        temp = USART2->SR; // ״̬Ĵ
-        temp = USART2->DR; // ݼĴ - IDLE־Ĺؼ
+        return 0;
+    }
+    return xStreamBufferSendFromISR(rx_stream, data, len, &rx_woken);
+}
 
-        // ͣDMA
-        DMA_Cmd(DMA1_Stream5, DISABLE);
+static void rx_dma_start(void)
+{
+    DMA_Cmd(DMA1_Stream5, DISABLE);
+    while (DMA1_Stream5->CR & DMA_SxCR_EN);
+    DMA_ClearFlag(DMA1_Stream5, DMA_FLAG_HTIF5 | DMA_FLAG_TCIF5 | DMA_FLAG_TEIF5 | DMA_FLAG_DMEIF5 | DMA_FLAG_FEIF5);
+    DMA_SetCurrDataCounter(DMA1_Stream5, RFID_RX_DMA_SIZE);
+    rx_ring.last = 0;
+    DMA_Cmd(DMA1_Stream5, ENABLE);
+}
 
-        // DMA_GetCurrDataCounter(DMA1_Stream5) ʣδ
-        len = dma_len - DMA_GetCurrDataCounter(DMA1_Stream5); // ˶ٸ
-        len = len ? len : dma_len;                            // len=0֤յǸպô
+// 一帧结束（总线空闲一个字节时间）：取出不满半圈的尾部数据
+void USART2_IRQHandler(void)
+{
+    uint16_t sr = USART2->SR;
 
-        // DMA
-        DMA_SetCurrDataCounter(DMA1_Stream5, dma_len);                                                                  // 
-        DMA_ClearITPendingBit(DMA1_Stream5, DMA_IT_TCIF5 | DMA_IT_HTIF5 | DMA_IT_TEIF5 | DMA_IT_DMEIF5 | DMA_IT_FEIF5); // пܵжϱ־(dmaжϣ
-        DMA_Cmd(DMA1_Stream5, ENABLE);
+    rx_woken = pdFALSE;
+    if (sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_NE | USART_SR_FE))
+    {
+        (void)USART2->DR; // 先读 SR 再读 DR，清除 IDLE 和错误标志
+        if (sr & USART_SR_ORE)
+        {
+            rx_ring.stats.overrun++;
+        }
+        if (sr & (USART_SR_NE | USART_SR_FE))
+        {
+            rx_ring.stats.errors++;
+        }
+        if (sr & USART_SR_IDLE)
+        {
+            rx_ring.stats.idle++;
+            UartRxRing_Poll(&rx_ring, DMA_GetCurrDataCounter(DMA1_Stream5));
+        }
+    }
+    portYIELD_FROM_ISR(rx_woken);
+}
 
-        rx_flag = (1 << 17) | len;
+// 读卡模块的应答都比半圈短，半满/全满中断只在应答跨过半圈边界时起作用
+void DMA1_Stream5_IRQHandler(void)
+{
+    rx_woken = pdFALSE;
+    if (DMA_GetITStatus(DMA1_Stream5, DMA_IT_HTIF5) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_Stream5, DMA_IT_HTIF5);
+        rx_ring.stats.half++;
+        UartRxRing_Poll(&rx_ring, DMA_GetCurrDataCounter(DMA1_Stream5));
+    }
+    if (DMA_GetITStatus(DMA1_Stream5, DMA_IT_TCIF5) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_Stream5, DMA_IT_TCIF5);
+        rx_ring.stats.full++;
+        UartRxRing_Poll(&rx_ring, DMA_GetCurrDataCounter(DMA1_Stream5));
+    }
+    if (DMA_GetITStatus(DMA1_Stream5, DMA_IT_TEIF5) != RESET)
+    {
+        // 传输错误时硬件关闭数据流：取出已收到的数据后从头重新开始
+        DMA_ClearITPendingBit(DMA1_Stream5, DMA_IT_TEIF5);
+        rx_ring.stats.errors++;
+        UartRxRing_Poll(&rx_ring, DMA_GetCurrDataCounter(DMA1_Stream5));
+        rx_dma_start();
+    }
+    portYIELD_FROM_ISR(rx_woken);
+}
+
+void DMA1_Stream6_IRQHandler(void)
+{
+    if (DMA_GetITStatus(DMA1_Stream6, DMA_IT_TCIF6) != RESET ||
+        DMA_GetITStatus(DMA1_Stream6, DMA_IT_TEIF6) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_Stream6, DMA_IT_TCIF6 | DMA_IT_TEIF6);
+        tx_busy = 0;
     }
 }
 
 // PA2-UART2_TX, PA3-UART2_RX
-static void RFID_Uart2_Init(void)
+static void rfid_uart2_gpio_init(void)
 {
     GPIO_InitTypeDef GPIO_InitStruct;
     USART_InitTypeDef USART_InitStruct;
     NVIC_InitTypeDef NVIC_InitStruct;
 
-    // 1ʹRXTXGPIOʱӺUSARTʱӣ
     RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOA, ENABLE);
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART2, ENABLE);
 
-    // 2ʼGPIOGPIOõUSART
     GPIO_InitStruct.GPIO_Pin = GPIO_Pin_2 | GPIO_Pin_3;
-    GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF;     // ģʽ
-    GPIO_InitStruct.GPIO_Speed = GPIO_High_Speed; // 
-    GPIO_InitStruct.GPIO_OType = GPIO_OType_PP;   // ģʽʱ
-    GPIO_InitStruct.GPIO_PuPd = GPIO_PuPd_NOPULL; // 
+    GPIO_InitStruct.GPIO_Mode = GPIO_Mode_AF;
+    GPIO_InitStruct.GPIO_Speed = GPIO_High_Speed;
+    GPIO_InitStruct.GPIO_OType = GPIO_OType_PP;
+    GPIO_InitStruct.GPIO_PuPd = GPIO_PuPd_NOPULL;
     GPIO_Init(GPIOA, &GPIO_InitStruct);
 
     GPIO_PinAFConfig(GPIOA, GPIO_PinSource2, GPIO_AF_USART2);
     GPIO_PinAFConfig(GPIOA, GPIO_PinSource3, GPIO_AF_USART2);
 
-    // 3USART
-    USART_InitStruct.USART_BaudRate = 9600;                                      // 
-    USART_InitStruct.USART_WordLength = USART_WordLength_8b;                     // 8λЧλ
-    USART_InitStruct.USART_StopBits = USART_StopBits_1;                          // 1λֹͣλ
-    USART_InitStruct.USART_Parity = USART_Parity_No;                             // У
-    USART_InitStruct.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;                 // պͷģʽ
-    USART_InitStruct.USART_HardwareFlowControl = USART_HardwareFlowControl_None; // Ӳ
+    USART_InitStruct.USART_BaudRate = RFID_UART_BAUD;
+    USART_InitStruct.USART_WordLength = USART_WordLength_8b;
+    USART_InitStruct.USART_StopBits = USART_StopBits_1;
+    USART_InitStruct.USART_Parity = USART_Parity_No;
+    USART_InitStruct.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
+    USART_InitStruct.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
     USART_Init(USART2, &USART_InitStruct);
 
-    // 4жϿʹUSARTж
     USART_ITConfig(USART2, USART_IT_IDLE, ENABLE);
 
-    // 5жȼҪжϲҪ裩
-    NVIC_InitStruct.NVIC_IRQChannel = USART2_IRQn; // жͨ(жԴ)
-    NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 1;
-    NVIC_InitStruct.NVIC_IRQChannelSubPriority = 1;
+    // 中断中调用 FromISR 函数，优先级不能高于 configMAX_SYSCALL_INTERRUPT_PRIORITY
+    NVIC_InitStruct.NVIC_IRQChannel = USART2_IRQn;
+    NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 7;
+    NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
     NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStruct);
 
-    // 6ʹUSART
     USART_Cmd(USART2, ENABLE);
 }
 
-// usartt2_rx ӦDMA1ͨ45, rx_bufferڴַlen
-void RFID_Uart2_Rx_DMA_Init(uint8_t *rx_buffer, uint16_t len)
+static void rfid_rx_dma_init(void)
 {
     DMA_InitTypeDef DMA_InitStruct;
-    dma_len = len;
-    // 1DMAʱʹ
-    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+    NVIC_InitTypeDef NVIC_InitStruct;
+
+    rx_stream = xStreamBufferCreate(RFID_RX_STREAM_SIZE, 1);
+    UartRxRing_Init(&rx_ring, rx_dma_buf, RFID_RX_DMA_SIZE, rx_sink, NULL);
+
+    DMA_DeInit(DMA1_Stream5);
+    DMA_StructInit(&DMA_InitStruct);
+    DMA_InitStruct.DMA_Channel = DMA_Channel_4;                       // USART2_RX：DMA1 Stream5 通道4
+    DMA_InitStruct.DMA_PeripheralBaseAddr = (uint32_t)&USART2->DR;
+    DMA_InitStruct.DMA_Memory0BaseAddr = (uint32_t)rx_dma_buf;
+    DMA_InitStruct.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStruct.DMA_BufferSize = RFID_RX_DMA_SIZE;
+    DMA_InitStruct.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStruct.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStruct.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStruct.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStruct.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStruct.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStruct.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_Init(DMA1_Stream5, &DMA_InitStruct);
+    DMA_ITConfig(DMA1_Stream5, DMA_IT_HT | DMA_IT_TC | DMA_IT_TE, ENABLE);
 
-    // 2òӵDMA
-    RFID_Uart2_Init();
-
-    // 3DMA
-    DMA_StructInit(&DMA_InitStruct); // ʼDMAýṹΪĬֵ(ѡƼ)
-
-    DMA_InitStruct.DMA_Channel = DMA_Channel_4;                          // ͨ4
-    DMA_InitStruct.DMA_PeripheralBaseAddr = (uint32_t)&USART2->DR;       // ַ
-    DMA_InitStruct.DMA_Memory0BaseAddr = (uint32_t)rx_buffer;            // ڴַ
-    DMA_InitStruct.DMA_DIR = DMA_DIR_PeripheralToMemory;                 // 赽ڴ
-    DMA_InitStruct.DMA_BufferSize = len;                                 // 
-    DMA_InitStruct.DMA_PeripheralInc = DMA_PeripheralInc_Disable;        // ַ
-    DMA_InitStruct.DMA_MemoryInc = DMA_MemoryInc_Enable;                 // ڴַ
-    DMA_InitStruct.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte; // ݿ8λ
-    DMA_InitStruct.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;         // ڴݿ8λ
-    DMA_InitStruct.DMA_Mode = DMA_Mode_Normal;                           // ģʽֻһ
-    DMA_InitStruct.DMA_Priority = DMA_Priority_Medium;                   // ȼ
-    DMA_InitStruct.DMA_FIFOMode = DMA_FIFOMode_Disable;                  // fifoݿһ˽ã
-    DMA_InitStruct.DMA_FIFOThreshold = DMA_FIFOThreshold_HalfFull;       // fifoֵ
-    DMA_InitStruct.DMA_MemoryBurst = DMA_MemoryBurst_Single;             // ͻδ
-    DMA_InitStruct.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;     // ͻδ
-    DMA_Init(DMA1_Stream5, &DMA_InitStruct);                             // DMA
-
-    // 6ʹDMA
-   DMA_Cmd(DMA1_Stream5, ENABLE); // dma
-
-    // 7ڲSRAM / FLASH洢⣩
+    NVIC_InitStruct.NVIC_IRQChannel = DMA1_Stream5_IRQn;
+    NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 7;
+    NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStruct);
+
+    rx_dma_start();
     USART_DMACmd(USART2, USART_DMAReq_Rx, ENABLE);
 }
 
-// ͨ2Ƭָ
-void RFID_Uart2_SendBytes(uint8_t *data, uint16_t len)
+static void rfid_tx_dma_init(void)
 {
-    while (len--)
-    {
-        USART_SendData(USART2, *data++); // ⺯
-        // ȴݼĴ
-        while (USART_GetFlagStatus(USART2, USART_FLAG_TXE) == RESET)
-            ;
-    }
-    // ȴ
-    while (USART_GetFlagStatus(USART2, USART_FLAG_TC) == RESET)
-        ;
+    DMA_InitTypeDef DMA_InitStruct;
+    NVIC_InitTypeDef NVIC_InitStruct;
+
+    DMA_DeInit(DMA1_Stream6);
+    DMA_StructInit(&DMA_InitStruct);
+    DMA_InitStruct.DMA_Channel = DMA_Channel_4;                       // USART2_TX：DMA1 Stream6 通道4
+    DMA_InitStruct.DMA_PeripheralBaseAddr = (uint32_t)&USART2->DR;
+    DMA_InitStruct.DMA_Memory0BaseAddr = (uint32_t)tx_buf;
+    DMA_InitStruct.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    DMA_InitStruct.DMA_BufferSize = 1;
+    DMA_InitStruct.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStruct.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStruct.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStruct.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStruct.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStruct.DMA_Priority = DMA_Priority_Low;
+    DMA_InitStruct.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_Init(DMA1_Stream6, &DMA_InitStruct);
+    DMA_ITConfig(DMA1_Stream6, DMA_IT_TC | DMA_IT_TE, ENABLE);
+
+    NVIC_InitStruct.NVIC_IRQChannel = DMA1_Stream6_IRQn;
+    NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = 7;
+    NVIC_InitStruct.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStruct);
+
+    USART_DMACmd(USART2, USART_DMAReq_Tx, ENABLE);
+}
+
+/**
+ * @brief 初始化 USART2 与收发 DMA（流缓冲区从 FreeRTOS 堆分配，调度器启动前后都可以调用）
+ */
+void RFID_Uart2_Init(void)
+{
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+    rfid_uart2_gpio_init();
+    rfid_rx_dma_init();
+    rfid_tx_dma_init();
 }
 
-//  жǷݣسɹݸ
-uint16_t RFID_Uart2_Recv_Len(void)
+/**
+ * @brief 取出收到的数据，没有数据时最多等 ticks 个节拍
+ * @return 取出的字节数
+ */
+uint32_t RFID_Uart2_Receive(uint8_t *buf, uint32_t len, uint32_t ticks)
 {
-    uint16_t ret = 0;
-    if (rx_flag & (1 << 17))
+    if (rx_stream == NULL)
     {
-        ret = rx_flag & 0xFFFF; // 16λݸ
-        rx_flag = 0;            // ¼´νǷ
-        return ret;
+        return 0;
     }
-    else
+    return xStreamBufferReceive(rx_stream, buf, len, ticks);
+}
+
+/**
+ * @brief 整帧发送：拷贝到发送缓冲区后启动 DMA 立即返回
+ * @return len，上一帧还在发送或帧过长时为 0
+ */
+uint32_t RFID_Uart2_Send(const uint8_t *data, uint32_t len)
+{
+    if (tx_busy || len == 0 || len > RFID_TX_MAX)
     {
         return 0;
     }
+    memcpy(tx_buf, data, len);
+    tx_busy = 1;
+    DMA_ClearFlag(DMA1_Stream6, DMA_FLAG_TCIF6 | DMA_FLAG_TEIF6 | DMA_FLAG_FEIF6 | DMA_FLAG_DMEIF6 | DMA_FLAG_HTIF6);
+    DMA_SetCurrDataCounter(DMA1_Stream6, (uint16_t)len);
+    DMA_Cmd(DMA1_Stream6, ENABLE);
+    return len;
+}
+
+uint8_t RFID_Uart2_TxBusy(void)
+{
+    return tx_busy;
+}
+
+void RFID_Uart2_GetRxStats(UartRx_Stats *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = rx_ring.stats;
+    taskEXIT_CRITICAL();
 }
@@ -1,10 +1,25 @@
+/**
+ * @file rfid_uart.h
+ * @brief 读卡模块串口（USART2，PA2-TX PA3-RX，9600bps）
+ * @details 接收：DMA1 Stream5 循环写入，IDLE/半满/全满中断把新数据整块送入流缓冲区（与 USART1 相同，见 uart_rx_ring.h），
+ *          RFID_Uart2_Receive 阻塞等待；发送：整帧拷贝到发送缓冲区由 DMA1 Stream6 发出，不等待发送完成。
+ */
+
 #ifndef RFID_UART_H
 #define RFID_UART_H
 
 #include "stm32f4xx.h"
+#include "uart_rx_ring.h"
+
+#define RFID_UART_BAUD          9600
+#define RFID_RX_DMA_SIZE        64      ///< DMA 环形缓冲区，半圈 32 字节（9600bps 下约 33ms）
+#define RFID_RX_STREAM_SIZE     128
+#define RFID_TX_MAX             32      ///< 最长的命令帧（RFID_FRAME_MAX）
 
-void RFID_Uart2_Rx_DMA_Init(uint8_t *rx_buffer, uint16_t len);
-void RFID_Uart2_SendBytes(uint8_t *data, uint16_t len);
-uint16_t RFID_Uart2_Recv_Len(void);
+void RFID_Uart2_Init(void);
+uint32_t RFID_Uart2_Receive(uint8_t *buf, uint32_t len, uint32_t ticks);
+uint32_t RFID_Uart2_Send(const uint8_t *data, uint32_t len);
+uint8_t RFID_Uart2_TxBusy(void);
+void RFID_Uart2_GetRxStats(UartRx_Stats *stats);
 
 #endif
@@ -0,0 +1,471 @@
+/**
+ * @file tag_db.c
+ * @brief 卡片登记表实现（见 tag_db.h）
+ * @details 记录布局（32 字节）：
+ *          [op 1B][0xFF][perm 2B][uid 4B][last_seen 4B][name 13B][0xFF x3][crc32 4B]
+ *          CRC32 以区的 generation 为前缀，覆盖 crc 之前的 28 字节。
+ *          区头占第一个槽：[magic 4B][generation 4B][count 4B][0xFF x16][crc32 4B]。
+ */
+
+#include "tag_db.h"
+#include "../code/spi.h"
+#include "../code/crc.h"
+#include <stddef.h>
+#include <string.h>
+
+#define TAG_MAGIC           0x31474154UL    // "TAG1"
+#define TAG_OP_PUT          0x01
+#define TAG_OP_SEEN         0x02
+#define TAG_OP_DEL          0x03
+#define TAG_PAGE            256
+
+typedef struct {
+    uint8_t  op;
+    uint8_t  rsv;
+    uint16_t perm;
+    uint32_t uid;
+    uint32_t last_seen;
+    char     name[TAG_NAME_MAX + 1];
+    uint8_t  pad[3];
+    uint32_t crc;
+} TagRecord;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t generation;
+    uint32_t count;         // 快照中的条目数（只用于显示）
+    uint8_t  pad[16];
+    uint32_t crc;
+} TagAreaHeader;
+
+// 重放时的读缓冲区和压缩时的页缓冲区（只在存储任务中使用）
+static uint8_t tag_page[TAG_PAGE] __attribute__((aligned(4)));
+
+// =============================================================================
+// 哈希表
+// =============================================================================
+
+static uint32_t tag_home(const TagTable *t, uint32_t uid)
+{
+    return (uint32_t)(uid * 2654435761u) >> t->shift;
+}
+
+/**
+ * @brief 从 uid 的起始槽线性探测
+ * @return uid 所在的槽，不存在时为遇到的第一个空槽
+ */
+static uint32_t tag_probe(const TagTable *t, uint32_t uid, uint32_t *probes)
+{
+    uint32_t i = tag_home(t, uid), n = 1;
+
+    while (t->slots[i] != TAG_SLOT_EMPTY && t->entries[t->slots[i]].uid != uid) {
+        i = (i + 1) & t->mask;
+        n++;
+    }
+    *probes = n;
+    return i;
+}
+
+/**
+ * @param nslots 槽数，2 的幂，大于 cap（取 2 倍以上时平均探测长度在 1.5 以内）
+ */
+void TagTable_Init(TagTable *t, TagEntry *entries, uint32_t cap, uint16_t *slots, uint32_t nslots)
+{
+    uint8_t bits = 0;
+
+    while ((1UL << bits) < nslots) {
+        bits++;
+    }
+    t->entries = entries;
+    t->slots = slots;
+    t->cap = cap < TAG_SLOT_EMPTY ? cap : TAG_SLOT_EMPTY;
+    t->mask = nslots - 1;
+    t->shift = (uint8_t)(32 - bits);
+    TagTable_Clear(t);
+}
+
+void TagTable_Clear(TagTable *t)
+{
+    memset(t->slots, 0xFF, (t->mask + 1) * sizeof(t->slots[0]));
+    memset(&t->stats, 0, sizeof(t->stats));
+    t->count = 0;
+}
+
+/**
+ * @brief 按 UID 查找，只访问 RAM
+ * @return 条目，没有登记时为 NULL
+ */
+TagEntry *TagTable_Find(TagTable *t, uint32_t uid)
+{
+    uint32_t n, i = tag_probe(t, uid, &n);
+
+    t->stats.lookups++;
+    t->stats.probes += n;
+    if (n > t->stats.max_probe) {
+        t->stats.max_probe = n;
+    }
+    return t->slots[i] == TAG_SLOT_EMPTY ? NULL : &t->entries[t->slots[i]];
+}
+
+/**
+ * @brief 登记一张卡，已登记时更新权限和名字（保留 last_seen）
+ * @param name 超过 TAG_NAME_MAX 的部分截断
+ */
+int TagTable_Put(TagTable *t, uint32_t uid, uint16_t perm, const char *name)
+{
+    uint32_t n, i;
+    TagEntry *e;
+
+    if (uid == 0 || name == NULL) {
+        return TAG_ERR_PARAM;
+    }
+    i = tag_probe(t, uid, &n);
+    if (t->slots[i] != TAG_SLOT_EMPTY) {
+        e = &t->entries[t->slots[i]];
+    } else {
+        if (t->count >= t->cap) {
+            return TAG_ERR_FULL;
+        }
+        e = &t->entries[t->count];
+        e->uid = uid;
+        e->last_seen = 0;
+        e->flags = 0;
+        t->slots[i] = (uint16_t)t->count++;
+    }
+    e->perm = perm;
+    strncpy(e->name, name, TAG_NAME_MAX);
+    e->name[TAG_NAME_MAX] = '\0';
+    return TAG_OK;
+}
+
+/**
+ * @brief 删除：同一簇中后面的槽往回移（不留删除标记），最后一个条目移到空出的位置
+ */
+int TagTable_Remove(TagTable *t, uint32_t uid)
+{
+    uint32_t n, i = tag_probe(t, uid, &n), j = i, idx, last;
+
+    if (t->slots[i] == TAG_SLOT_EMPTY) {
+        return TAG_ERR_NOT_FOUND;
+    }
+    idx = t->slots[i];
+
+    while (1) {
+        uint32_t k;
+
+        j = (j + 1) & t->mask;
+        if (t->slots[j] == TAG_SLOT_EMPTY) {
+            break;
+        }
+        // 起始槽 k 在 (i, j] 之间的条目不能移到 i 之前
+        k = tag_home(t, t->entries[t->slots[j]].uid);
+        if (i <= j ? (k > i && k <= j) : (k > i || k <= j)) {
+            continue;
+        }
+        t->slots[i] = t->slots[j];
+        i = j;
+    }
+    t->slots[i] = TAG_SLOT_EMPTY;
+
+    last = t->count - 1;
+    if (idx != last) {
+        t->entries[idx] = t->entries[last];
+        t->slots[tag_probe(t, t->entries[idx].uid, &n)] = (uint16_t)idx;
+    }
+    t->count--;
+    return TAG_OK;
+}
+
+// =============================================================================
+// Flash 访问
+// =============================================================================
+
+static uint32_t area_addr(const TagStore *s, uint8_t area, uint32_t ofs)
+{
+    return s->base + (uint32_t)area * s->area_size + ofs;
+}
+
+// 编程后回读比较（同 kv_store.c）
+static int flash_write(TagStore *s, uint32_t addr, const uint8_t *data, uint16_t len)
+{
+    uint8_t verify[32];
+
+    if (W25Q128_BufferWrite((uint8_t *)data, addr, len) != W25Q128_RESULT_OK) {
+        return TAG_ERR_FLASH;
+    }
+    s->stats.bytes_written += len;
+
+    for (uint32_t done = 0; done < len; done += sizeof(verify)) {
+        uint32_t n = len - done < sizeof(verify) ? len - done : sizeof(verify);
+        W25Q128_ReadData(verify, addr + done, (uint16_t)n);
+        if (memcmp(verify, data + done, n) != 0) {
+            return TAG_ERR_FLASH;
+        }
+    }
+    return TAG_OK;
+}
+
+static int sector_erase(TagStore *s, uint8_t area, uint32_t ofs)
+{
+    s->stats.erases++;
+    return W25Q128_SectorErase(area_addr(s, area, ofs)) == W25Q128_RESULT_OK ? TAG_OK : TAG_ERR_FLASH;
+}
+
+static uint32_t record_crc(uint32_t generation, const TagRecord *r)
+{
+    uint32_t crc = CRC32_Update(0, &generation, sizeof(generation));
+    return CRC32_Update(crc, r, offsetof(TagRecord, crc));
+}
+
+static uint32_t next_sector(uint32_t ofs)
+{
+    return (ofs + W25Q128_SECTOR_SIZE) & ~(uint32_t)(W25Q128_SECTOR_SIZE - 1);
+}
+
+static void record_fill(TagRecord *r, uint8_t op, const TagEntry *e)
+{
+    memset(r, 0xFF, sizeof(*r));
+    r->op = op;
+    r->perm = e->perm;
+    r->uid = e->uid;
+    r->last_seen = e->last_seen;
+    memcpy(r->name, e->name, sizeof(r->name));
+}
+
+// =============================================================================
+// 重放与压缩
+// =============================================================================
+
+static uint8_t header_valid(const TagAreaHeader *h)
+{
+    return h->magic == TAG_MAGIC && h->generation != 0 && h->generation != 0xFFFFFFFFUL &&
+           CRC32_Update(0, h, offsetof(TagAreaHeader, crc)) == h->crc;
+}
+
+static uint8_t slot_blank(const uint8_t *p)
+{
+    for (uint32_t i = 0; i < TAG_RECORD_SIZE; i++) {
+        if (p[i] != 0xFF) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void replay(TagStore *s, const TagRecord *r)
+{
+    TagTable *t = s->table;
+    TagEntry *e;
+
+    s->stats.replayed++;
+    switch (r->op) {
+    case TAG_OP_PUT:
+        if (TagTable_Put(t, r->uid, r->perm, r->name) != TAG_OK) {
+            s->stats.dropped++;
+            break;
+        }
+        TagTable_Find(t, r->uid)->last_seen = r->last_seen;
+        break;
+    case TAG_OP_SEEN:
+        e = TagTable_Find(t, r->uid);
+        if (e != NULL) {
+            e->last_seen = r->last_seen;
+        }
+        break;
+    case TAG_OP_DEL:
+        TagTable_Remove(t, r->uid);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief 重放当前区的日志，定位写指针
+ * @details 扇区开头的槽校验不过（空白、上一轮的旧数据、擦除了一半）就是日志结尾；
+ *          扇区中间的非空坏槽是掉电写了一半的记录，跳到下一个扇区继续，写指针也从那里继续
+ */
+static void area_replay(TagStore *s)
+{
+    uint32_t ofs = TAG_RECORD_SIZE;
+
+    while (ofs < s->area_size) {
+        const uint8_t *p;
+        TagRecord r;
+
+        if (ofs % TAG_PAGE == 0 || ofs == TAG_RECORD_SIZE) {
+            W25Q128_ReadData(tag_page, area_addr(s, s->active, ofs & ~(uint32_t)(TAG_PAGE - 1)), TAG_PAGE);
+        }
+        p = &tag_page[ofs % TAG_PAGE];
+        memcpy(&r, p, sizeof(r));
+        if (record_crc(s->generation, &r) == r.crc) {
+            replay(s, &r);
+            ofs += TAG_RECORD_SIZE;
+            continue;
+        }
+        if (ofs % W25Q128_SECTOR_SIZE == 0 || slot_blank(p)) {
+            break;
+        }
+        s->stats.crc_errors++;
+        ofs = next_sector(ofs);
+    }
+    s->write_ofs = ofs;
+}
+
+/**
+ * @brief 选择当前区并重放日志，重建哈希表
+ * @details 两个区都无效（全新分区）时表为空，第一次写入时压缩出第一个区，启动时不写 Flash
+ */
+int TagStore_Load(TagStore *s, TagTable *t)
+{
+    TagAreaHeader h[2];
+    uint8_t valid[2];
+
+    if (s->area_size < 2 * TAG_RECORD_SIZE || s->area_size % W25Q128_SECTOR_SIZE != 0) {
+        return TAG_ERR_PARAM;
+    }
+    SPI1_Init();
+    memset(&s->stats, 0, sizeof(s->stats));
+    s->table = t;
+    TagTable_Clear(t);
+    for (uint8_t i = 0; i < 2; i++) {
+        W25Q128_ReadData((uint8_t *)&h[i], area_addr(s, i, 0), sizeof(h[i]));
+        valid[i] = header_valid(&h[i]);
+    }
+
+    if (!valid[0] && !valid[1]) {
+        s->active = 0;
+        s->generation = 0;
+        s->write_ofs = s->area_size;
+        return TAG_OK;
+    }
+    s->active = (valid[1] && (!valid[0] || h[1].generation > h[0].generation)) ? 1 : 0;
+    s->generation = h[s->active].generation;
+    area_replay(s);
+    memset(&t->stats, 0, sizeof(t->stats));
+    return TAG_OK;
+}
+
+/**
+ * @brief 把表中所有条目写成快照放进另一区
+ * @details 顺序：擦除快照要用的扇区（区头所在扇区最先）→ 按页写入条目 → 写区头（提交点）。
+ *          旧区不擦除，下次轮到它时再擦；启动时按 generation 选择，旧区里的数据不会被重放。
+ */
+int TagStore_Compact(TagStore *s)
+{
+    TagTable *t = s->table;
+    uint8_t spare = s->active ^ 1;
+    uint32_t size, ofs, fill;
+    TagAreaHeader h;
+
+    if (t == NULL) {
+        return TAG_ERR_PARAM;
+    }
+    size = (t->count + 1) * TAG_RECORD_SIZE;
+    if (size > s->area_size) {
+        return TAG_ERR_FULL;
+    }
+    for (ofs = 0; ofs < size; ofs += W25Q128_SECTOR_SIZE) {
+        if (sector_erase(s, spare, ofs) != TAG_OK) {
+            return TAG_ERR_FLASH;
+        }
+    }
+
+    // 第一页的第一个槽留给区头
+    ofs = 0;
+    fill = TAG_RECORD_SIZE;
+    memset(tag_page, 0xFF, TAG_PAGE);
+    for (uint32_t i = 0; i < t->count; i++) {
+        TagRecord r;
+
+        record_fill(&r, TAG_OP_PUT, &t->entries[i]);
+        r.crc = record_crc(s->generation + 1, &r);
+        memcpy(&tag_page[fill], &r, sizeof(r));
+        fill += TAG_RECORD_SIZE;
+        if (fill == TAG_PAGE || i == t->count - 1) {
+            uint32_t from = ofs == 0 ? TAG_RECORD_SIZE : 0;
+
+            if (flash_write(s, area_addr(s, spare, ofs + from), &tag_page[from], (uint16_t)(fill - from)) != TAG_OK) {
+                return TAG_ERR_FLASH;
+            }
+            ofs += TAG_PAGE;
+            fill = 0;
+            memset(tag_page, 0xFF, TAG_PAGE);
+        }
+    }
+
+    memset(&h, 0xFF, sizeof(h));
+    h.magic = TAG_MAGIC;
+    h.generation = s->generation + 1;
+    h.count = t->count;
+    h.crc = CRC32_Update(0, &h, offsetof(TagAreaHeader, crc));
+    if (flash_write(s, area_addr(s, spare, 0), (const uint8_t *)&h, sizeof(h)) != TAG_OK) {
+        return TAG_ERR_FLASH;
+    }
+
+    s->active = spare;
+    s->generation = h.generation;
+    s->write_ofs = size;
+    s->stats.compactions++;
+    return TAG_OK;
+}
+
+/**
+ * @brief 追加一条记录；区满时改为压缩（快照已包含这次修改，不再追加）
+ * @details 写指针到达扇区开头时先擦除该扇区，擦除分摊到每 128 条记录一次
+ */
+static int store_append(TagStore *s, TagRecord *r)
+{
+    if (s->table == NULL) {
+        return TAG_ERR_PARAM;
+    }
+    if (s->generation == 0 || s->write_ofs + TAG_RECORD_SIZE > s->area_size) {
+        return TagStore_Compact(s);
+    }
+    if (s->write_ofs % W25Q128_SECTOR_SIZE == 0 && sector_erase(s, s->active, s->write_ofs) != TAG_OK) {
+        return TAG_ERR_FLASH;
+    }
+    r->crc = record_crc(s->generation, r);
+    if (flash_write(s, area_addr(s, s->active, s->write_ofs), (const uint8_t *)r, sizeof(*r)) != TAG_OK) {
+        s->write_ofs = next_sector(s->write_ofs);     // 该槽状态未知，从下一个扇区继续
+        return TAG_ERR_FLASH;
+    }
+    s->write_ofs += TAG_RECORD_SIZE;
+    s->stats.appends++;
+    return TAG_OK;
+}
+
+/**
+ * @brief 记录登记或修改（调用方先更新表）
+ */
+int TagStore_Put(TagStore *s, const TagEntry *e)
+{
+    TagRecord r;
+
+    record_fill(&r, TAG_OP_PUT, e);
+    return store_append(s, &r);
+}
+
+int TagStore_Seen(TagStore *s, uint32_t uid, uint32_t last_seen)
+{
+    TagRecord r;
+
+    memset(&r, 0xFF, sizeof(r));
+    r.op = TAG_OP_SEEN;
+    r.uid = uid;
+    r.last_seen = last_seen;
+    return store_append(s, &r);
+}
+
+/**
+ * @brief 记录删除（调用方先从表中删除）
+ */
+int TagStore_Delete(TagStore *s, uint32_t uid)
+{
+    TagRecord r;
+
+    memset(&r, 0xFF, sizeof(r));
+    r.op = TAG_OP_DEL;
+    r.uid = uid;
+    return store_append(s, &r);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file tag_db.h
+ * @brief 卡片登记表：UID → 名字、权限位、最后刷卡时间，RAM 中开放寻址哈希表 + Flash 日志持久化
+ * @details TagTable：条目连续存放在 entries[]（删除时用最后一条填补空位），
+ *          slots[] 是 UID 的哈希索引（线性探测，存条目下标），删除时把后面同一簇的槽往回移，
+ *          不留删除标记，探测长度不会随增删累积变长。查找只访问 RAM，与登记的卡数无关。
+ *          两个数组由调用方提供（固件放在静态区，主机端可以建更大的表），槽数为 2 的幂，取容量的 2 倍以上。
+ *
+ *          TagStore：Flash 上两个区（A/B）轮流使用，每条记录 32 字节，一次页编程：
+ *          - 区头 [magic, generation, count, crc32]，写在区的第一个槽，最后写入（提交点）
+ *          - 启动时取区头有效且 generation 较大的区，依次重放记录（PUT/SEEN/DEL）重建哈希表
+ *          - 每次修改追加一条记录；区写满时把表中所有条目写成快照放进另一区（压缩）
+ *          - 扇区在写到它时才擦除，旧数据留在未擦除的扇区里；记录的 CRC 以 generation 为初值，
+ *            上一轮留下的记录校验不过，当作日志结尾
+ *          - 掉电写了一半的记录校验不过，之后从下一个扇区继续写；压缩在区头写入之前掉电，旧区仍完整
+ *
+ *          本模块不加锁、不依赖 FreeRTOS，Flash 只能在存储任务中访问（固件端见 rfid_access.c）。
+ *          主机端 tag_db_bench 编译同一份代码。
+ */
+
+#ifndef _TAG_DB_H_
+#define _TAG_DB_H_
+
+#include <stdint.h>
+
+#define TAG_NAME_MAX        12      ///< 名字最长字符数
+#define TAG_RECORD_SIZE     32      ///< Flash 记录大小
+#define TAG_SLOT_EMPTY      0xFFFF
+
+#define TAG_FLAG_SEEN_DIRTY 0x01    ///< last_seen 还没写入 Flash
+
+// 返回值
+#define TAG_OK              0
+#define TAG_ERR_NOT_FOUND   1
+#define TAG_ERR_FULL        2       ///< 表满，或快照放不进一个区
+#define TAG_ERR_FLASH       3       ///< 编程/擦除失败或回读不一致
+#define TAG_ERR_PARAM       4
+
+/**
+ * @brief 一张登记的卡（24 字节）
+ */
+typedef struct {
+    uint32_t uid;
+    uint32_t last_seen;                 ///< 最后刷卡时间（秒），0 表示没刷过
+    uint16_t perm;                      ///< 权限位
+    uint8_t  flags;                     ///< TAG_FLAG_*，只在 RAM 中
+    char     name[TAG_NAME_MAX + 1];
+} TagEntry;
+
+typedef struct {
+    uint32_t lookups;
+    uint32_t probes;        ///< 查找访问的槽数之和
+    uint32_t max_probe;
+} TagTable_Stats;
+
+typedef struct {
+    TagEntry      *entries;
+    uint16_t      *slots;
+    uint32_t       cap;         ///< 条目数上限
+    uint32_t       mask;        ///< 槽数 - 1
+    uint8_t        shift;       ///< 32 - log2(槽数)
+    uint32_t       count;
+    TagTable_Stats stats;
+} TagTable;
+
+typedef struct {
+    uint32_t appends;       ///< 追加的记录数
+    uint32_t compactions;
+    uint32_t erases;        ///< 扇区擦除次数
+    uint32_t bytes_written;
+    uint32_t replayed;      ///< 启动时重放的记录数
+    uint32_t crc_errors;    ///< 重放时遇到的坏记录（掉电写了一半）
+    uint32_t dropped;       ///< 重放时表满而丢弃的 PUT
+} TagStore_Stats;
+
+/**
+ * @brief Flash 上的一对区（前两项为配置，其余为运行状态）
+ */
+typedef struct {
+    uint32_t       base;        ///< 起始地址（4KB 对齐，占 2 个区）
+    uint32_t       area_size;   ///< 每个区的字节数（4KB 的倍数）
+
+    TagTable      *table;       ///< TagStore_Load 时绑定，压缩时从这里取快照
+    uint8_t        active;      ///< 当前区（0/1）
+    uint32_t       generation;
+    uint32_t       write_ofs;   ///< 下一条记录在当前区内的偏移
+    TagStore_Stats stats;
+} TagStore;
+
+#define TAG_STORE_INIT(base, area_size)     { (base), (area_size), 0, 0, 0, 0, { 0, 0, 0, 0, 0, 0, 0 } }
+
+void TagTable_Init(TagTable *t, TagEntry *entries, uint32_t cap, uint16_t *slots, uint32_t nslots);
+void TagTable_Clear(TagTable *t);
+TagEntry *TagTable_Find(TagTable *t, uint32_t uid);
+int TagTable_Put(TagTable *t, uint32_t uid, uint16_t perm, const char *name);
+int TagTable_Remove(TagTable *t, uint32_t uid);
+
+int TagStore_Load(TagStore *s, TagTable *t);
+int TagStore_Put(TagStore *s, const TagEntry *e);
+int TagStore_Seen(TagStore *s, uint32_t uid, uint32_t last_seen);
+int TagStore_Delete(TagStore *s, uint32_t uid);
+int TagStore_Compact(TagStore *s);
+
+#endif
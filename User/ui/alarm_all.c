@@ -1,3 +1,5 @@
+#define LOG_MODULE  alarm
+#include "code/binlog.h"
 #include "stm32f4xx.h"
 #include "rtc_date.h"
 #include "oled.h"
@@ -10,6 +12,9 @@
 #include "stm32f4xx_rtc.h"
 #include "stm32f4xx_pwr.h"
 #include "alarm_file.h"
+#include "code/shell.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -29,6 +34,24 @@ static void Alarm_SetRTCAlarm(void);
 static void Display_Alarm_Alert(Alarm_TypeDef* alarm);
 static void Update_Alarm_Alert_Display(Alarm_TypeDef* alarm);
 
+// 菜单任务和串口命令（data_task）都会修改闹钟表，增删改和遍历都在临界区内进行，
+// 临界区内只访问数组，不打印、不保存
+
+/**
+ * @brief 在临界区内复制整个闹钟表
+ * @return 闹钟数量
+ */
+static uint8_t Alarm_Snapshot(Alarm_TypeDef *out)
+{
+    uint8_t count;
+
+    taskENTER_CRITICAL();
+    count = g_alarm_count;
+    memcpy(out, g_alarms, count * sizeof(Alarm_TypeDef));
+    taskEXIT_CRITICAL();
+    return count;
+}
+
 // 全局函数声明（在头文件中已有，但这里重复声明以避免编译器警告）
 extern uint32_t get_systick(void);
 
@@ -45,7 +68,7 @@ void Alarms_Init(void)
     Alarm_RTC_Config();
     
     // 加载已保存的闹钟（函数内部会处理SPI初始化和W25Q128检测）
-    Alarms_Load();
+    Alarms_LoadSync();
 }
 
 /**
@@ -62,7 +85,7 @@ static void Alarm_RTC_Config(void)
     // 暂时不配置RTC闹钟中断，改用纯软件检查
     // 因为硬件闹钟可能干扰RTC时间更新
     
-    printf("RTC Alarm config initialized (software mode)\r\n");
+    LOG_INFO("RTC Alarm config initialized (software mode)");
 }
 
 // 闹钟数据在W25Q128中的存储地址
@@ -75,19 +98,26 @@ static void Alarm_RTC_Config(void)
 /**
  * @brief 添加新闹钟
  * @param alarm 指向闹钟结构体的指针
+ * @param index 输出新闹钟的索引（可为 NULL）
  * @return 0成功，其他值失败
  */
-uint8_t Alarm_Add(Alarm_TypeDef* alarm)
+uint8_t Alarm_Add(Alarm_TypeDef* alarm, uint8_t *index)
 {
+    taskENTER_CRITICAL();
     if (g_alarm_count >= MAX_ALARMS) {
+        taskEXIT_CRITICAL();
         return 1; // 闹钟数量已达上限
     }
     
     g_alarms[g_alarm_count] = *alarm;
+    if (index != NULL) {
+        *index = g_alarm_count;
+    }
     g_alarm_count++;
+    taskEXIT_CRITICAL();
     
-    // 保存闹钟
-    Alarms_Save();
+    // 保存闹钟（后台执行，不等待 Flash 擦写）
+    Alarms_RequestSave();
     
     // 更新RTC闹钟
     Alarm_SetRTCAlarm();
@@ -98,11 +128,14 @@ uint8_t Alarm_Add(Alarm_TypeDef* alarm)
 /**
  * @brief 删除指定索引的闹钟
  * @param index 闹钟索引
+ * @return 0成功，1没有该闹钟
  */
-void Alarm_Delete(uint8_t index)
+uint8_t Alarm_Delete(uint8_t index)
 {
+    taskENTER_CRITICAL();
     if (index >= g_alarm_count) {
-        return;
+        taskEXIT_CRITICAL();
+        return 1;
     }
     
     // 将后面的元素向前移动
@@ -111,50 +144,65 @@ void Alarm_Delete(uint8_t index)
     }
     
     g_alarm_count--;
+    taskEXIT_CRITICAL();
     
-    // 保存闹钟
-    Alarms_Save();
+    // 保存闹钟（后台执行，不等待 Flash 擦写）
+    Alarms_RequestSave();
     
     // 更新RTC闹钟
     Alarm_SetRTCAlarm();
+    
+    return 0;
 }
 
 /**
  * @brief 启用指定索引的闹钟
  * @param index 闹钟索引
+ * @return 0成功，1没有该闹钟
  */
-void Alarm_Enable(uint8_t index)
+uint8_t Alarm_Enable(uint8_t index)
 {
+    taskENTER_CRITICAL();
     if (index >= g_alarm_count) {
-        return;
+        taskEXIT_CRITICAL();
+        return 1;
     }
     
     g_alarms[index].enabled = 1;
+    taskEXIT_CRITICAL();
     
-    // 保存闹钟
-    Alarms_Save();
+    // 保存闹钟（后台执行，不等待 Flash 擦写）
+    Alarms_RequestSave();
     
     // 更新RTC闹钟
     Alarm_SetRTCAlarm();
+    
+    return 0;
 }
 
 /**
  * @brief 禁用指定索引的闹钟
  * @param index 闹钟索引
+ * @return 0成功，1没有该闹钟
  */
-void Alarm_Disable(uint8_t index)
+uint8_t Alarm_Disable(uint8_t index)
 {
+    taskENTER_CRITICAL();
     if (index >= g_alarm_count) {
-        return;
+        taskEXIT_CRITICAL();
+        return 1;
     }
     
     g_alarms[index].enabled = 0;
+    taskEXIT_CRITICAL();
     
-    // 保存闹钟
-    Alarms_Save();
+    // 保存闹钟（后台执行，不等待 Flash 擦写）
+    Alarms_RequestSave();
     
     // 更新RTC闹钟
     Alarm_SetRTCAlarm();
+    
+    return 0;
 }
 
 /**
@@ -181,7 +229,9 @@ void Alarm_Check(void)
     //     last_second = currentTime.RTC_Seconds;
     // }
     
-    // 检查每个闹钟
+    // 检查每个闹钟（一次性闹钟在同一个临界区内禁用）
+    uint8_t hit = 0xFF;
+    taskENTER_CRITICAL();
     for (uint8_t i = 0; i < g_alarm_count; i++) {
         if (!g_alarms[i].enabled) {
             continue;
@@ -192,27 +242,31 @@ void Alarm_Check(void)
             g_alarms[i].minute == currentTime.RTC_Minutes &&
             g_alarms[i].second == currentTime.RTC_Seconds) {
             
-            // 触发闹钟
-            printf("Alarm triggered! Time: %02d:%02d:%02d, Index: %d\n", 
-                   currentTime.RTC_Hours, currentTime.RTC_Minutes, currentTime.RTC_Seconds, i);
-            
-            // 点亮LED2
-            LED_Set(2, 0);  // 点亮LED2
-            
-            // 设置闹钟提醒状态为激活
-            alarm_alert_active = 1;
-            // 记录触发的闹钟索引
-            g_triggered_alarm_index = i;
-            
             // 如果是一次性闹钟，则禁用它
             if (!g_alarms[i].repeat) {
                 g_alarms[i].enabled = 0;
             }
+            hit = i;
             
             // 一旦找到匹配的闹钟就退出循环
             break;
         }
     }
+    taskEXIT_CRITICAL();
+    
+    if (hit != 0xFF) {
+        // 触发闹钟
+        LOG_INFO("Alarm triggered! Time: %02d:%02d:%02d, Index: %d", 
+               currentTime.RTC_Hours, currentTime.RTC_Minutes, currentTime.RTC_Seconds, hit);
+        
+        // 点亮LED2
+        LED_Set(2, 0);  // 点亮LED2
+        
+        // 设置闹钟提醒状态为激活
+        alarm_alert_active = 1;
+        // 记录触发的闹钟索引
+        g_triggered_alarm_index = hit;
+    }
 }
 
 /**
@@ -224,10 +278,13 @@ void Alarm_SetRTCAlarm(void)
     // 暂时禁用硬件RTC闹钟，完全使用软件检查
     // 这样可以避免RTC闹钟配置影响RTC时间更新
     
-    for (uint8_t i = 0; i < g_alarm_count; i++) {
-        if (g_alarms[i].enabled) {
-            printf("Software alarm set for %02d:%02d:%02d\r\n", 
-                   g_alarms[i].hour, g_alarms[i].minute, g_alarms[i].second);
+    Alarm_TypeDef alarms[MAX_ALARMS];
+    uint8_t count = Alarm_Snapshot(alarms);
+    
+    for (uint8_t i = 0; i < count; i++) {
+        if (alarms[i].enabled) {
+            LOG_INFO("Software alarm set for %02d:%02d:%02d", 
+                   alarms[i].hour, alarms[i].minute, alarms[i].second);
         }
     }
 }
@@ -237,7 +294,7 @@ void Alarm_SetRTCAlarm(void)
  */
 void Display_Alarm_Alert(Alarm_TypeDef* alarm)
 {
-    printf("=== Display_Alarm_Alert called ===\r\n");
+    LOG_DEBUG("=== Display_Alarm_Alert called ===");
     
     OLED_Clear(); // 完全清除屏幕，而不是只清除几行
     
@@ -249,7 +306,7 @@ void Display_Alarm_Alert(Alarm_TypeDef* alarm)
     OLED_Printf_Line(2, "  %02d:%02d:%02d", alarm->hour, alarm->minute, alarm->second);
     OLED_Printf_Line(3, "Press KEY3 to stop");
     
-    printf("Displaying alarm alert for %02d:%02d:%02d\r\n", 
+    LOG_DEBUG("Displaying alarm alert for %02d:%02d:%02d", 
            alarm->hour, alarm->minute, alarm->second);
     
     OLED_Refresh();
@@ -258,7 +315,7 @@ void Display_Alarm_Alert(Alarm_TypeDef* alarm)
     delay_ms(10);
     OLED_Refresh_Dirty();
     
-    printf("=== Alarm display completed ===\r\n");
+    LOG_DEBUG("=== Alarm display completed ===");
 }
 
 /**
@@ -294,7 +351,7 @@ void Update_Alarm_Alert_Display(Alarm_TypeDef* alarm)
  */
 void Alarm_ForceTrigger(void)
 {
-    printf("Force triggering alarm test...\r\n");
+    LOG_INFO("Force triggering alarm test...");
     
     // 点亮LED2
     LED_Set(2, 0);  
@@ -309,7 +366,7 @@ void Alarm_ForceTrigger(void)
         .enabled = 1, .repeat = 0, .daysOfWeek = 0
     };
     Display_Alarm_Alert(&test_alarm);
-    printf("Test alarm display activated\r\n");
+    LOG_INFO("Test alarm display activated");
     
     // 强制刷新显示
     delay_ms(10);
@@ -326,33 +383,42 @@ uint8_t Alarm_GlobalHandler(void)
     // 如果处于闹钟提醒状态
     if (alarm_alert_active) {
         // 更新闹钟提醒显示
+        Alarm_TypeDef triggered;
+        uint8_t found = 0;
+        
+        taskENTER_CRITICAL();
         if (g_triggered_alarm_index != 0xFF && g_triggered_alarm_index < g_alarm_count) {
-            Update_Alarm_Alert_Display(&g_alarms[g_triggered_alarm_index]);
-            printf("Updating alarm display for index %d\r\n", g_triggered_alarm_index);
+            triggered = g_alarms[g_triggered_alarm_index];
+            found = 1;
+        }
+        taskEXIT_CRITICAL();
+        if (found) {
+            Update_Alarm_Alert_Display(&triggered);
+            LOG_DEBUG("Updating alarm display for index %d", g_triggered_alarm_index);
         } else if (g_triggered_alarm_index == 0xFF) {
             // 这是测试闹钟，创建默认显示
             static Alarm_TypeDef test_alarm = {
                 .hour = 0, .minute = 0, .second = 0,
                 .enabled = 1, .repeat = 0, .daysOfWeek = 0
             };
-            printf("Updating test alarm display\r\n");
+            LOG_DEBUG("Updating test alarm display");
             Display_Alarm_Alert(&test_alarm);
         }
         
         // 处理闹钟提醒界面的按键输入
         uint8_t key = KEY_Get();
         if (key == KEY3_PRES) {
-            printf("KEY3 pressed - dismissing alarm\r\n");
+            LOG_INFO("KEY3 pressed - dismissing alarm");
             // 关闭LED2
             LED_Set(2, 1);  // 熄灭LED2
             alarm_alert_active = 0;  // 退出提醒状态
             g_triggered_alarm_index = 0xFF; // 重置触发索引
             
             OLED_Clear(); // 清除显示，返回原界面
-            printf("Alarm dismissed, returning to normal mode\r\n");
+            LOG_INFO("Alarm dismissed, returning to normal mode");
             return 0; // 闹钟处理完毕
         } else if (key != 0) {
-            printf("Other key pressed: %d\r\n", key);
+            LOG_DEBUG("Other key pressed: %d", key);
         }
         
         return 1; // 仍在处理闹钟提醒
@@ -360,3 +426,84 @@ uint8_t Alarm_GlobalHandler(void)
     
     return 0; // 无闹钟提醒
 }
+
+// =============================================================================
+// 串口命令
+// =============================================================================
+
+// alarm_add hh:mm[:ss] [on|off]：第二个参数为每天重复，默认重复
+static int cmd_alarm_add(uint32_t argc, const Shell_Arg *argv)
+{
+    Alarm_TypeDef alarm;
+    uint8_t index;
+
+    alarm.hour = SHELL_TIME_H(argv[0].u);
+    alarm.minute = SHELL_TIME_M(argv[0].u);
+    alarm.second = SHELL_TIME_S(argv[0].u);
+    alarm.enabled = 1;
+    alarm.repeat = argc > 1 ? (uint8_t)argv[1].u : 1;
+    alarm.daysOfWeek = 0x7F;
+    if (Alarm_Add(&alarm, &index) != 0) {
+        printf("alarm table full (%d)\r\n", MAX_ALARMS);
+        return SHELL_ERR_FAIL;
+    }
+    printf("alarm %d: %02d:%02d:%02d\r\n", index, alarm.hour, alarm.minute, alarm.second);
+    return SHELL_OK;
+}
+
+static int cmd_alarm_list(uint32_t argc, const Shell_Arg *argv)
+{
+    Alarm_TypeDef alarms[MAX_ALARMS];
+    uint8_t count = Alarm_Snapshot(alarms);
+
+    (void)argc;
+    (void)argv;
+    for (uint8_t i = 0; i < count; i++) {
+        printf("  %d  %02d:%02d:%02d  %s  %s\r\n", i, alarms[i].hour, alarms[i].minute, alarms[i].second,
+               alarms[i].enabled ? "on " : "off", alarms[i].repeat ? "daily" : "once");
+    }
+    printf("%d/%d alarms\r\n", count, MAX_ALARMS);
+    return SHELL_OK;
+}
+
+static int cmd_alarm_del(uint32_t argc, const Shell_Arg *argv)
+{
+    (void)argc;
+    // 范围检查在 Alarm_Delete 的临界区内，不先读 g_alarm_count
+    if (argv[0].u >= MAX_ALARMS || Alarm_Delete((uint8_t)argv[0].u) != 0) {
+        printf("no alarm %lu\r\n", (unsigned long)argv[0].u);
+        return SHELL_ERR_FAIL;
+    }
+    return SHELL_OK;
+}
+
+static int cmd_alarm_en(uint32_t argc, const Shell_Arg *argv)
+{
+    uint8_t ret;
+
+    (void)argc;
+    if (argv[0].u >= MAX_ALARMS) {
+        ret = 1;
+    } else if (argv[1].u) {
+        ret = Alarm_Enable((uint8_t)argv[0].u);
+    } else {
+        ret = Alarm_Disable((uint8_t)argv[0].u);
+    }
+    if (ret != 0) {
+        printf("no alarm %lu\r\n", (unsigned long)argv[0].u);
+        return SHELL_ERR_FAIL;
+    }
+    return SHELL_OK;
+}
+
+static const Shell_Cmd alarm_cmds[] = {
+    { "alarm_add",  "t|b", cmd_alarm_add,  "alarm_add hh:mm[:ss] [daily on|off]" },
+    { "alarm_list", "",    cmd_alarm_list, "list alarms" },
+    { "alarm_del",  "u",   cmd_alarm_del,  "alarm_del <index>" },
+    { "alarm_en",   "ub",  cmd_alarm_en,   "alarm_en <index> <on|off>" },
+};
+
+void Alarms_RegisterCommands(void)
+{
+    Shell_Register(alarm_cmds, sizeof(alarm_cmds) / sizeof(alarm_cmds[0]));
+}
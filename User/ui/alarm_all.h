@@ -28,12 +28,12 @@ extern uint8_t alarm_alert_active;
 
 // 闹钟系统函数
 void Alarms_Init(void);
-void Alarms_Save(void);
+int  Alarms_Save(void);
 void Alarms_Load(void);
-uint8_t Alarm_Add(Alarm_TypeDef* alarm);
-void Alarm_Delete(uint8_t index);
-void Alarm_Enable(uint8_t index);
-void Alarm_Disable(uint8_t index);
+uint8_t Alarm_Add(Alarm_TypeDef* alarm, uint8_t *index);
+uint8_t Alarm_Delete(uint8_t index);
+uint8_t Alarm_Enable(uint8_t index);
+uint8_t Alarm_Disable(uint8_t index);
 void Alarm_Check(void);
 void Alarm_SetRTCAlarm(void);
 
@@ -48,4 +48,7 @@ uint8_t Alarm_GlobalHandler(void);
 // 测试函数
 void Alarm_ForceTrigger(void);
 
+// 串口命令 alarm_add/alarm_list/alarm_del/alarm_en
+void Alarms_RegisterCommands(void);
+
 #endif
@@ -9,15 +9,20 @@
 #include "alarm_file.h"
 #include "alarm_all.h"
 #include "../ff16/ff.h"
+#include "../ff16/storage_service.h"
+#include "../ff16/dir_index.h"
+#include "kv_store.h"
+#include "persist.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef STM32F4XX
 #include "stm32f4xx.h"
 #endif
 
-// 闹钟数据文件路径
+// 旧版闹钟数据文件路径（仅用于迁移到 KV 存储）
 #define ALARM_DATA_FILE "0:alarms.dat"
 
 // 定义基本类型
@@ -34,46 +39,55 @@ typedef uint32_t        DWORD;
 extern Alarm_TypeDef g_alarms[MAX_ALARMS];
 extern uint8_t g_alarm_count;
 
+// KV 中的闹钟表：数量 + 闹钟数组
+typedef struct {
+    uint8_t count;
+    Alarm_TypeDef alarms[MAX_ALARMS];
+} AlarmBlob_TypeDef;
+
 /**
- * @brief 保存闹钟到文件
+ * @brief 检查闹钟表是否合理（简单的边界检查）
  */
-void Alarms_Save(void)
+static uint8_t Alarms_Validate(const Alarm_TypeDef *alarms, uint8_t count)
 {
-    FIL file;
-    FRESULT fr;
-    UINT bw;
-    
-    // 打开文件用于写入（如果不存在则创建，存在则覆盖）
-    fr = f_open(&file, ALARM_DATA_FILE, FA_CREATE_ALWAYS | FA_WRITE);
-    if (fr != FR_OK) {
-        return;
+    if (count > MAX_ALARMS) {
+        return 0;
     }
-    
-    // 写入闹钟数量
-    fr = f_write(&file, &g_alarm_count, sizeof(g_alarm_count), &bw);
-    if (fr != FR_OK || bw != sizeof(g_alarm_count)) {
-        f_close(&file);
-        return;
-    }
-    
-    // 如果有闹钟，写入闹钟数据
-    if (g_alarm_count > 0) {
-        WORD alarm_data_size = g_alarm_count * sizeof(Alarm_TypeDef);
-        fr = f_write(&file, g_alarms, alarm_data_size, &bw);
-        if (fr != FR_OK || bw != alarm_data_size) {
-            f_close(&file);
-            return;
+    for (uint8_t i = 0; i < count; i++) {
+        if (alarms[i].hour > 23 || alarms[i].minute > 59 || alarms[i].second > 59) {
+            return 0;
         }
     }
+    return 1;
+}
+
+static int Alarms_Store(const AlarmBlob_TypeDef *blob)
+{
+    return KV_Set(KV_KEY_ALARMS, KV_TYPE_BLOB, blob,
+                  offsetof(AlarmBlob_TypeDef, alarms) + blob->count * sizeof(Alarm_TypeDef));
+}
+
+/**
+ * @brief 保存闹钟到 KV 存储
+ * @return KV_OK-成功，其他-失败
+ */
+int Alarms_Save(void)
+{
+    static AlarmBlob_TypeDef blob;
     
-    // 关闭文件
-    f_close(&file);
+    // 在存储任务中执行，菜单和串口命令可能同时增删闹钟：数量和数组在同一个临界区内取
+    taskENTER_CRITICAL();
+    blob.count = g_alarm_count;
+    memcpy(blob.alarms, g_alarms, g_alarm_count * sizeof(Alarm_TypeDef));
+    taskEXIT_CRITICAL();
+    return Alarms_Store(&blob);
 }
 
 /**
- * @brief 从文件加载闹钟
+ * @brief 从旧版 alarms.dat 读取闹钟
+ * @return 1 读取成功且数据合理，0 失败
  */
-void Alarms_Load(void)
+static uint8_t Alarms_LoadLegacy(AlarmBlob_TypeDef *blob)
 {
     FIL file;
     FRESULT fr;
@@ -82,46 +96,95 @@ void Alarms_Load(void)
     // 打开文件用于读取
     fr = f_open(&file, ALARM_DATA_FILE, FA_READ);
     if (fr != FR_OK) {
-        // 文件不存在或其他错误，初始化为空的闹钟列表
-        g_alarm_count = 0;
-        return;
+        return 0;
     }
     
     // 读取闹钟数量
-    fr = f_read(&file, &g_alarm_count, sizeof(g_alarm_count), &br);
-    if (fr != FR_OK || br != sizeof(g_alarm_count)) {
+    fr = f_read(&file, &blob->count, sizeof(blob->count), &br);
+    if (fr != FR_OK || br != sizeof(blob->count) || blob->count > MAX_ALARMS) {
         f_close(&file);
-        g_alarm_count = 0;
-        return;
-    }
-    
-    // 检查数据有效性
-    if (g_alarm_count > MAX_ALARMS) {
-        g_alarm_count = 0;
-        f_close(&file);
-        return;
+        return 0;
     }
     
     // 如果有闹钟，读取闹钟数据
-    if (g_alarm_count > 0) {
-        WORD alarm_data_size = g_alarm_count * sizeof(Alarm_TypeDef);
-        fr = f_read(&file, g_alarms, alarm_data_size, &br);
+    if (blob->count > 0) {
+        WORD alarm_data_size = blob->count * sizeof(Alarm_TypeDef);
+        fr = f_read(&file, blob->alarms, alarm_data_size, &br);
         if (fr != FR_OK || br != alarm_data_size) {
-            g_alarm_count = 0;
             f_close(&file);
-            return;
-        }
-        
-        // 验证读取的数据是否合理（简单的边界检查）
-        for (uint8_t i = 0; i < g_alarm_count; i++) {
-            if (g_alarms[i].hour > 23 || g_alarms[i].minute > 59 || g_alarms[i].second > 59) {
-                g_alarm_count = 0;
-                f_close(&file);
-                return;
-            }
+            return 0;
         }
     }
     
     // 关闭文件
     f_close(&file);
+    return Alarms_Validate(blob->alarms, blob->count);
+}
+
+/**
+ * @brief 加载闹钟
+ * @details 优先读 KV 存储；没有时读旧版 alarms.dat，成功后写入 KV 并删除旧文件
+ */
+void Alarms_Load(void)
+{
+    static AlarmBlob_TypeDef blob;
+    uint16_t len;
+    
+    if (KV_Get(KV_KEY_ALARMS, KV_TYPE_BLOB, &blob, sizeof(blob), &len) == KV_OK) {
+        if (len >= offsetof(AlarmBlob_TypeDef, alarms) &&
+            len == offsetof(AlarmBlob_TypeDef, alarms) + blob.count * sizeof(Alarm_TypeDef) &&
+            Alarms_Validate(blob.alarms, blob.count)) {
+            taskENTER_CRITICAL();
+            g_alarm_count = blob.count;
+            memcpy(g_alarms, blob.alarms, blob.count * sizeof(Alarm_TypeDef));
+            taskEXIT_CRITICAL();
+        } else {
+            g_alarm_count = 0;
+        }
+        return;
+    }
+    
+    if (Alarms_LoadLegacy(&blob)) {
+        taskENTER_CRITICAL();
+        g_alarm_count = blob.count;
+        memcpy(g_alarms, blob.alarms, blob.count * sizeof(Alarm_TypeDef));
+        taskEXIT_CRITICAL();
+        if (Alarms_Store(&blob) == KV_OK) {
+            if (f_unlink(ALARM_DATA_FILE) == FR_OK) {
+                DirIndex_NotifyRemoved(ALARM_DATA_FILE);
+            }
+        }
+    } else {
+        // 没有保存过或数据损坏，初始化为空的闹钟列表
+        g_alarm_count = 0;
+    }
+}
+
+// =============================================================================
+// 通过存储服务访问（UI 任务不再等待 Flash 擦除）
+// =============================================================================
+
+static FRESULT alarms_load_job(void *ctx)
+{
+    (void)ctx;
+    Alarms_Load();
+    return FR_OK;
+}
+
+/**
+ * @brief 请求后台保存闹钟，立即返回
+ * @details 只标记闹钟表已修改，由 persist.c 在菜单操作停下来后与其它脏对象一起保存，
+ *          连续的增删/开关合并为一次写入
+ */
+void Alarms_RequestSave(void)
+{
+    Persist_MarkDirty(PERSIST_OBJ_ALARMS);
+}
+
+/**
+ * @brief 经存储服务加载闹钟（服务未运行时直接加载）
+ */
+void Alarms_LoadSync(void)
+{
+    Storage_Call(alarms_load_job, NULL, STORAGE_PRIO_INTERACTIVE);
 }
@@ -5,7 +5,11 @@
 #include <stdint.h>
 
 // 闹钟文件操作函数
-void Alarms_Save(void);
+int  Alarms_Save(void);
 void Alarms_Load(void);
 
+// 经存储服务访问
+void Alarms_RequestSave(void);
+void Alarms_LoadSync(void);
+
 #endif
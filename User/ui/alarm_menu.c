@@ -195,7 +195,7 @@ void alarm_create(void)
     Process_Set_Alarm(NULL);
 
     // 保存新闹钟
-    if (Alarm_Add(&temp_alarm) == 0)
+    if (Alarm_Add(&temp_alarm, NULL) == 0)
     {
         OLED_Clear();
         OLED_Printf_Line(1, " ALARM SET ");
@@ -276,7 +276,7 @@ void Process_Alarm_Detail(u8 alarm_index)
 
                     // 更新闹钟时间
                     Alarm_Delete(alarm_index);
-                    Alarm_Add(&temp_alarm);
+                    Alarm_Add(&temp_alarm, NULL);
 
                     // 重新显示详情界面
                     Display_Alarm_Detail(alarm_index, selected_option);
@@ -0,0 +1,225 @@
+/**
+ * @file asset_view.c
+ * @brief 资源包图片显示与旋律播放
+ */
+
+#include "asset_view.h"
+#include "asset.h"
+#include "../ff16/storage_service.h"
+#include "oled.h"
+#include "oled_print.h"
+#include "music.h"
+#include "key.h"
+#include "iwdg.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+
+#define ASSET_FRAME_BYTES   (128 * 8)
+
+/**
+ * @brief 在存储任务中查找并读取一段资源
+ */
+typedef struct {
+    const char *name;
+    uint8_t     type;       ///< 期望的 AssetType
+    uint32_t    offset;     ///< 读取起点
+    void       *dst;
+    uint32_t    cap;        ///< dst 大小；读取 min(资源剩余, cap) 字节
+    uint32_t    len;        ///< 输出：实际读取的字节数
+    AssetInfo   info;       ///< 输出
+    int         rc;         ///< 输出：ASSET_OK / ASSET_ERR_*
+} AssetLoad;
+
+static uint8_t pic_buf[ASSET_VIEW_PICTURE_MAX] __attribute__((aligned(4)));
+static NumberedNote note_buf[ASSET_VIEW_NOTE_CHUNK];
+
+static FRESULT asset_load_job(void *ctx)
+{
+    AssetLoad *a = (AssetLoad *)ctx;
+
+    a->len = 0;
+    a->rc = Asset_Find(a->name, &a->info);
+    if (a->rc == ASSET_OK && a->info.type != a->type) {
+        a->rc = ASSET_ERR_PARAM;
+    }
+    if (a->rc == ASSET_OK && a->offset < a->info.length) {
+        a->len = a->info.length - a->offset;
+        if (a->len > a->cap) {
+            a->len = a->cap;
+        }
+        a->rc = Asset_Read(&a->info, a->offset, a->dst, a->len);
+    }
+    return FR_OK;
+}
+
+static int asset_load(AssetLoad *a)
+{
+    if (Storage_Call(asset_load_job, a, STORAGE_PRIO_INTERACTIVE) != FR_OK) {
+        return ASSET_ERR_FLASH;
+    }
+    return a->rc;
+}
+
+/**
+ * @brief 整屏图片直接读入显存并刷新
+ * @details 读入期间菜单任务在 Storage_Call 中等待，不会同时改写显存。
+ */
+int Asset_ShowFrame(const char *name)
+{
+    AssetLoad a = {0};
+
+    a.name = name;
+    a.type = ASSET_TYPE_FRAME;
+    a.dst = OLED_GetGRAM();
+    a.cap = ASSET_FRAME_BYTES;
+    if (asset_load(&a) != ASSET_OK) {
+        return a.rc;
+    }
+    if (a.info.length != ASSET_FRAME_BYTES) {
+        return ASSET_ERR_PARAM;     // 显存已被部分覆盖，调用方重绘
+    }
+    OLED_Refresh();
+    return ASSET_OK;
+}
+
+/**
+ * @brief 在 (x, y) 画资源包中的位图（OLED_ShowPicture 格式）
+ * @param mode 同 OLED_ShowPicture：1 正常，0 反色
+ */
+int Asset_ShowPicture(uint8_t x, uint8_t y, const char *name, uint8_t mode)
+{
+    AssetLoad a = {0};
+
+    a.name = name;
+    a.type = ASSET_TYPE_BITMAP;
+    a.dst = pic_buf;
+    a.cap = sizeof(pic_buf);
+    if (asset_load(&a) != ASSET_OK) {
+        return a.rc;
+    }
+    if (a.len != a.info.length) {
+        return ASSET_ERR_PARAM;     // 位图超过 ASSET_VIEW_PICTURE_MAX
+    }
+    OLED_ShowPicture(x, y, (uint8_t)a.info.w, (uint8_t)a.info.h, pic_buf, mode);
+    return ASSET_OK;
+}
+
+/**
+ * @brief 播放资源包中的旋律（拍号和速度取自资源参数）
+ */
+int Asset_PlayMelody(const char *name)
+{
+    AssetLoad a = {0};
+    uint16_t played = 0;
+
+    a.name = name;
+    a.type = ASSET_TYPE_MELODY;
+    a.dst = note_buf;
+    a.cap = sizeof(note_buf);
+    do {
+        if (asset_load(&a) != ASSET_OK) {
+            break;
+        }
+        for (uint32_t i = 0; i < a.len / sizeof(NumberedNote); i++) {
+            const NumberedNote *n = &note_buf[i];
+            Play_Note(get_frequency_from_numbered_note(n),
+                      get_duration_from_note_value(n, (TimeSignature)a.info.w, (uint8_t)a.info.h));
+            played++;
+        }
+        a.offset += a.len;
+    } while (a.len == sizeof(note_buf));
+    Play_Note(NOTE_REST, 0);
+
+    printf("asset: %s played %u/%u notes (%d)\r\n", name, played, a.info.count, a.rc);
+    return a.rc;
+}
+
+static FRESULT asset_install_job(void *ctx)
+{
+    return Asset_Install((const char *)ctx) == ASSET_OK ? FR_OK : FR_INT_ERR;
+}
+
+/**
+ * @brief 把文件系统中的映像文件写入资源包分区（相同映像不重写）
+ */
+int Asset_InstallFile(const char *path)
+{
+    return Storage_Call(asset_install_job, (void *)path, STORAGE_PRIO_BACKGROUND) == FR_OK ? ASSET_OK
+                                                                                           : ASSET_ERR_FILE;
+}
+
+static FRESULT asset_list_job(void *ctx)
+{
+    *(uint8_t *)ctx = Asset_Available();
+    Asset_PrintList();
+    return FR_OK;
+}
+
+// =============================================================================
+// 测试菜单
+// =============================================================================
+
+static const char *const asset_icons[] = {
+    "gImage_calendar", "gImage_clock", "gImage_flashlight", "gImage_stopwatch",
+    "gImage_setting", "gImage_TandH", "gImage_bell", "gImage_step"
+};
+#define ASSET_ICON_COUNT    (sizeof(asset_icons) / sizeof(asset_icons[0]))
+
+static void asset_test_icons(uint8_t page)
+{
+    OLED_Clear();
+    for (uint8_t i = 0; i < 3; i++) {
+        Asset_ShowPicture(i * 48, 16, asset_icons[(page + i) % ASSET_ICON_COUNT], 1);
+    }
+    OLED_Printf_Line(0, "%s", asset_icons[page % ASSET_ICON_COUNT]);
+    OLED_Refresh();
+}
+
+/**
+ * @brief 资源包测试：0:/assets.bin 存在时先安装；KEY0 切换图标，KEY1 播放旋律，KEY2 退出
+ */
+void asset_test(void)
+{
+    Asset_Stats st;
+    uint8_t available = 0;
+    uint8_t page = 0;
+    u8 key;
+
+    OLED_Clear();
+    OLED_Printf_Line(0, "Asset pack");
+    OLED_Printf_Line(1, "Checking...");
+    OLED_Refresh();
+
+    Asset_InstallFile(ASSET_VIEW_INSTALL_PATH);
+    Storage_Call(asset_list_job, &available, STORAGE_PRIO_INTERACTIVE);
+    if (!available || Asset_ShowFrame("logo") != ASSET_OK) {
+        OLED_Printf_Line(1, available ? "No logo frame" : "No asset pack");
+        OLED_Printf_Line(3, "KEY2 to exit");
+        OLED_Refresh();
+        while (KEY_Get() != KEY2_PRES) {
+            IWDG_ReloadCounter();
+            vTaskDelay(pdMS_TO_TICKS(20));
+        }
+        OLED_Clear();
+        return;
+    }
+
+    while (1) {
+        IWDG_ReloadCounter();
+        vTaskDelay(pdMS_TO_TICKS(20));
+        key = KEY_Get();
+        if (key == KEY0_PRES) {
+            asset_test_icons(page++);
+        } else if (key == KEY1_PRES) {
+            Asset_PlayMelody("haruhi_correct");
+        } else if (key == KEY2_PRES) {
+            break;
+        }
+    }
+
+    Asset_GetStats(&st);
+    printf("asset: %lu lookups, %lu probes, %lu reads, %lu bytes\r\n", (unsigned long)st.lookups,
+           (unsigned long)st.probes, (unsigned long)st.reads, (unsigned long)st.bytes_read);
+    OLED_Clear();
+}
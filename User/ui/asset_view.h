@@ -0,0 +1,29 @@
+/**
+ * @file asset_view.h
+ * @brief 从 W25Q128 资源包显示图片、播放旋律（asset.c 的 UI 封装）
+ * @details Flash 访问通过 Storage_Call 在存储任务中执行，调用方等待完成：
+ *          - Asset_ShowFrame：整屏图片由 SPI1 DMA 直接读入 OLED 显存，没有中间缓冲区
+ *          - Asset_ShowPicture：图标读入一个小缓冲区后交给 OLED_ShowPicture（要按坐标移位合成）
+ *          - Asset_PlayMelody：每次读取 ASSET_VIEW_NOTE_CHUNK 个音符边读边播，
+ *            不受 Play_Numbered_Melody 200 个音符的限制
+ *          OLED 使用软件 I2C，TIM13（蜂鸣器 PWM）没有 DMA 请求，所以这两段仍由 CPU 完成。
+ *          资源包不可用时返回错误码，调用方可退回编译进固件的数组。
+ */
+
+#ifndef _ASSET_VIEW_H_
+#define _ASSET_VIEW_H_
+
+#include <stdint.h>
+
+#define ASSET_VIEW_PICTURE_MAX  512     ///< Asset_ShowPicture 的最大位图（64x64）
+#define ASSET_VIEW_NOTE_CHUNK   32      ///< 每次读取的音符数
+#define ASSET_VIEW_INSTALL_PATH "0:/assets.bin"
+
+int Asset_ShowFrame(const char *name);
+int Asset_ShowPicture(uint8_t x, uint8_t y, const char *name, uint8_t mode);
+int Asset_PlayMelody(const char *name);
+int Asset_InstallFile(const char *path);
+
+void asset_test(void);
+
+#endif
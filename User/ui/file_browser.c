@@ -0,0 +1,209 @@
+/**
+ * @file file_browser.c
+ * @brief 文件浏览界面
+ */
+
+#include "file_browser.h"
+#include "../ff16/dir_index.h"
+#include "../ff16/storage_service.h"
+#include "oled.h"
+#include "oled_print.h"
+#include "key.h"
+#include "iwdg.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+// 索引表 10KB，只由 CPU 访问，放在 CCM RAM
+__attribute__((section(".ccmram")))
+static DirIndexEntry browser_entries[FILE_BROWSER_MAX_FILES];
+static DirIndex browser_idx;
+static uint8_t browser_ready = 0;
+
+static FRESULT browser_refresh_job(void *ctx)
+{
+    return DirIndex_Refresh((DirIndex *)ctx);
+}
+
+/**
+ * @brief 有变更时经存储任务刷新索引，没有变更时不访问存储器
+ */
+static FRESULT browser_refresh(void)
+{
+    if (!DirIndex_Stale(&browser_idx)) {
+        return FR_OK;
+    }
+    if (!browser_idx.valid) {
+        OLED_Printf_Line(1, "Scanning...");
+        OLED_Refresh_Dirty();
+    }
+    return Storage_Call(browser_refresh_job, &browser_idx, STORAGE_PRIO_INTERACTIVE);
+}
+
+static void format_size(uint32_t size, char *out, size_t len)
+{
+    if (size < 10000) {
+        snprintf(out, len, "%lu", (unsigned long)size);
+    } else if (size < 10000UL * 1024) {
+        snprintf(out, len, "%luK", (unsigned long)(size / 1024));
+    } else {
+        snprintf(out, len, "%luM", (unsigned long)(size / (1024UL * 1024)));
+    }
+}
+
+static void browser_show(uint16_t sel, FRESULT fr)
+{
+    uint16_t top = (uint16_t)(sel / FILE_BROWSER_ROWS * FILE_BROWSER_ROWS);
+    char name[DIR_INDEX_DISPLAY_LEN];
+    char size[8];
+
+    OLED_Printf_Line(0, "%.10s %u/%u%s", browser_idx.path, browser_idx.count ? sel + 1 : 0,
+                     browser_idx.count, browser_idx.truncated ? "+" : "");
+    for (uint8_t r = 0; r < FILE_BROWSER_ROWS; r++) {
+        const DirIndexEntry *e = DirIndex_Get(&browser_idx, (uint16_t)(top + r));
+
+        if (e == NULL) {
+            if (r == 0 && fr != FR_OK) {
+                OLED_Printf_Line(1, "Error %d", fr);
+            } else if (r == 0) {
+                OLED_Printf_Line(1, "(empty)");
+            } else {
+                OLED_Clear_Line(r + 1);
+            }
+            continue;
+        }
+        DirIndex_FormatName(e, name);
+        if (e->attr & AM_DIR) {
+            strcpy(size, "<DIR>");
+        } else {
+            format_size(e->size, size, sizeof(size));
+        }
+        OLED_Printf_Line(r + 1, "%c%-12s %6s", top + r == sel ? '>' : ' ', name, size);
+    }
+    OLED_Refresh_Dirty();
+}
+
+static void browser_info(const DirIndexEntry *e)
+{
+    char name[DIR_INDEX_DISPLAY_LEN];
+
+    DirIndex_FormatName(e, name);
+    OLED_Clear();
+    OLED_Printf_Line(0, "%s", name);
+    OLED_Printf_Line(1, "%lu bytes", (unsigned long)e->size);
+    OLED_Printf_Line(2, "attr %c%c%c%c", (e->attr & AM_RDO) ? 'R' : '-', (e->attr & AM_HID) ? 'H' : '-',
+                     (e->attr & AM_SYS) ? 'S' : '-', (e->attr & AM_ARC) ? 'A' : '-');
+    OLED_Printf_Line(3, "KEY2 back");
+    OLED_Refresh();
+    while (KEY_Get() != KEY2_PRES) {
+        IWDG_ReloadCounter();
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    OLED_Clear();
+}
+
+/**
+ * @brief 进入子目录
+ * @return 0-成功，-1-路径过长
+ */
+static int browser_enter(const char *name)
+{
+    char path[DIR_INDEX_PATH_MAX];
+
+    if (snprintf(path, sizeof(path), "%s/%s", browser_idx.path, name) >= (int)sizeof(path)) {
+        return -1;
+    }
+    DirIndex_Init(&browser_idx, path, "*", browser_entries, FILE_BROWSER_MAX_FILES);
+    return 0;
+}
+
+/**
+ * @brief 返回上一级，光标停在刚离开的目录上
+ * @return 光标位置，-1-已在根目录
+ */
+static int browser_up(FRESULT *fr)
+{
+    char path[DIR_INDEX_PATH_MAX];
+    char child[DIR_INDEX_DISPLAY_LEN];
+    char *slash = strrchr(browser_idx.path, '/');
+    int i;
+
+    if (slash == NULL) {
+        return -1;
+    }
+    strncpy(child, slash + 1, sizeof(child) - 1);
+    child[sizeof(child) - 1] = '\0';
+    *slash = '\0';
+    strcpy(path, browser_idx.path);
+    DirIndex_Init(&browser_idx, path, "*", browser_entries, FILE_BROWSER_MAX_FILES);
+    *fr = browser_refresh();
+    i = DirIndex_Find(&browser_idx, child);
+    return i >= 0 ? i : 0;
+}
+
+/**
+ * @brief 文件浏览：KEY0/KEY1 移动，KEY3 进入目录或查看文件，KEY2 返回上一级/退出
+ */
+void file_browser(void)
+{
+    uint16_t sel = 0;
+    FRESULT fr;
+    u8 key;
+
+    if (!browser_ready) {
+        DirIndex_Init(&browser_idx, FILE_BROWSER_ROOT, "*", browser_entries, FILE_BROWSER_MAX_FILES);
+        browser_ready = 1;
+    }
+    OLED_Clear();
+    fr = browser_refresh();
+    browser_show(sel, fr);
+
+    while (1) {
+        IWDG_ReloadCounter();
+        vTaskDelay(pdMS_TO_TICKS(20));
+        key = KEY_Get();
+        if (key == 0) {
+            continue;
+        }
+
+        // 浏览期间其它任务（持久化、日志）可能写过文件：只处理登记的变更
+        fr = browser_refresh();
+        if (key == KEY0_PRES) {
+            sel = sel > 0 ? sel - 1 : (browser_idx.count > 0 ? browser_idx.count - 1 : 0);
+        } else if (key == KEY1_PRES) {
+            sel = sel + 1 < browser_idx.count ? sel + 1 : 0;
+        } else if (key == KEY3_PRES) {
+            const DirIndexEntry *e = DirIndex_Get(&browser_idx, sel);
+            char name[DIR_INDEX_DISPLAY_LEN];
+
+            if (e != NULL && (e->attr & AM_DIR)) {
+                DirIndex_FormatName(e, name);
+                if (browser_enter(name) == 0) {
+                    OLED_Clear();
+                    fr = browser_refresh();
+                    sel = 0;
+                }
+            } else if (e != NULL) {
+                browser_info(e);
+            }
+        } else if (key == KEY2_PRES) {
+            int up = browser_up(&fr);
+
+            if (up < 0) {
+                break;
+            }
+            OLED_Clear();
+            sel = (uint16_t)up;
+        }
+        if (sel >= browser_idx.count) {
+            sel = browser_idx.count > 0 ? browser_idx.count - 1 : 0;
+        }
+        browser_show(sel, fr);
+    }
+
+    printf("file_browser: %lu scans (%lu entries), %lu updates, %lu lookups\r\n",
+           (unsigned long)browser_idx.stats.full_scans, (unsigned long)browser_idx.stats.scanned,
+           (unsigned long)browser_idx.stats.updates, (unsigned long)browser_idx.stats.lookups);
+    OLED_Clear();
+}
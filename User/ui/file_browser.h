@@ -0,0 +1,21 @@
+/**
+ * @file file_browser.h
+ * @brief 文件浏览界面（W25Q128 的 0: 卷）
+ * @details 目录内容来自 dir_index.c 的排序索引：进入目录时扫描一次，之后翻页只读 RAM 表，
+ *          其它功能写过的文件在下次按键时增量刷新。每屏第 0 行显示路径和位置，1~3 行显示文件。
+ *          KEY0/KEY1 上下移动，KEY3 进入目录或查看文件信息，KEY2 返回上一级（根目录时退出）。
+ *          索引表放在 CCM RAM（不经过 DMA），退出后保留，再次进入时只处理期间的变更。
+ */
+
+#ifndef _FILE_BROWSER_H_
+#define _FILE_BROWSER_H_
+
+#include <stdint.h>
+
+#define FILE_BROWSER_MAX_FILES  512     ///< 每个目录最多索引的文件数（每项 20 字节）
+#define FILE_BROWSER_ROOT       "0:"
+#define FILE_BROWSER_ROWS       3       ///< 每屏显示的文件行数
+
+void file_browser(void);
+
+#endif
@@ -1,4 +1,10 @@
 #include "filesystem_test.h"
+#include "../ff16/diskio_cache.h"
+#include "../ff16/dir_index.h"
+#include "storage_bench.h"
+#include "../ff16/storage_service.h"
+#include "code/shell.h"
+#include "code/spi.h"
 #ifndef FM_LFN
 /* FM_LFN may not be defined in some FatFs versions; define as 0 to keep compatibility
    (no LFN flag) so code that ORs FM_LFN compiles. */
@@ -21,16 +27,15 @@ extern uint32_t get_systick(void); // 你的 systick 获取函数
 char lfn_buffer[FF_MAX_LFN + 1]; // +1 for '\0'
 #endif
 
-FATFS fs;
 FIL file;
 FRESULT fr;
 DIR dir;
 FILINFO fno;
 
 UINT bw, br;
-BYTE work[FF_MAX_SS]; // 格式化用的工作缓冲区
 
-/* 32KB 缓冲区放在 CCMRAM（F4 只有 64KB，32KB 很安全） */
+/* 32KB 缓冲区放在 CCMRAM（F4 只有 64KB，32KB 很安全）
+ * 只在存储任务的 job 中使用（文件系统测试、菜单基准、bench 命令），三者串行执行，不需要加锁 */
 #if defined(__CC_ARM) || defined(__ARMCC_VERSION)
 __attribute__((section(".ccmram")))
 #elif defined(__GNUC__)
@@ -108,65 +113,40 @@ void print_fresult(FRESULT fr)
     }
 }
 
-void filesystem_test(void)
+/**
+ * @brief 功能测试的结果，由 job 填写，菜单任务显示
+ */
+typedef struct {
+    uint32_t written;       // 1MB 测试写入的字节数
+    uint32_t elapsed;       // 1MB 测试耗时（ms）
+    uint32_t entries;       // 根目录项数
+} FsTestResult;
+
+/**
+ * @brief 功能测试：在存储任务中对已挂载的 0: 卷执行
+ * @details 卷由 storage_service.c 挂载（无文件系统时格式化）并钉住 FAT 扇区，这里不再挂载/卸载；
+ *          FatFs 以 FF_FS_REENTRANT=0 编译，只能在存储任务中调用。
+ */
+static FRESULT filesystem_test_job(void *ctx)
 {
+    FsTestResult *res = (FsTestResult *)ctx;
+    DWORD fre_clust, tot_sect, fre_sect;
+    FATFS *fsp;
 
-    IWDG_Init();
-    printf("========== W25Q128 FatFs Test Start ==========");
     W25Q128_SetHighSpeedMode();
-    /* 1. 挂载 */
-    printf("Mounting filesystem...");
-    OLED_Printf_Line(0, "W25Q128 FatFs Test Start ");
-
-    OLED_Refresh();
     IWDG_ReloadCounter();
-    // Try mount first
-    fr = f_mount(&fs, "0:", 1);
-    if (fr != FR_OK)
-    {
-        OLED_Printf_Line(1, "Formatting...");
-        OLED_Refresh();
-        printf("No valid filesystem or mount failed (%d). Formatting...", fr);
-
-        MKFS_PARM opt = {0};
-        opt.fmt = FM_FAT32 | FM_SFD; // SFD = Super Floppy (MBR not needed for flash)
-        opt.au_size = 32 * 1024;     // 32KB cluster (optimal for 16MB; max FAT32 cluster = 32KB)
-        opt.align = 0;
-        opt.n_fat = 2;  // 2 FATs for safety (default)
-        opt.n_root = 0; // FAT32: root is a dir, not fixed entry count
-
-        fr = f_mkfs("0:", &opt, work, sizeof(work));
-        if (fr != FR_OK)
-        {
-            printf("f_mkfs failed: ");
-            print_fresult(fr);
-            return;
-        }
-        printf("Format OK! Remounting...");
-        f_mount(NULL, "0:", 0);
-        fr = f_mount(&fs, "0:", 1);
-        IWDG_ReloadCounter();
-    }
 
+    /* 1. 显示容量（挂载失败时返回 FR_NOT_ENABLED） */
+    fr = f_getfree(STORAGE_VOLUME, &fre_clust, &fsp);
     if (fr != FR_OK)
     {
-        printf("Mount failed: ");
-        print_fresult(fr);
-        return;
-    }
-    printf("Mount success!");
-
-    /* 2. 显示容量 */
-    DWORD fre_clust, tot_sect, fre_sect;
-    FATFS *fsp;
-    if (f_getfree("0:", &fre_clust, &fsp) == FR_OK)
-    {
-        tot_sect = (fsp->n_fatent - 2) * fsp->csize;
-        fre_sect = fre_clust * fsp->csize;
-        printf("Total: %lu KB, Free: %lu KB", tot_sect / 2, fre_sect / 2);
+        return fr;
     }
+    tot_sect = (fsp->n_fatent - 2) * fsp->csize;
+    fre_sect = fre_clust * fsp->csize;
+    printf("Total: %lu KB, Free: %lu KB", (unsigned long)tot_sect / 2, (unsigned long)fre_sect / 2);
 
-    /* 3. 创建目录 */
+    /* 2. 创建目录 */
     printf("Creating directory...");
     fr = f_mkdir(TEST_DIR);
     printf((fr == FR_OK || fr == FR_EXIST) ? "OK" : "Failed: ");
@@ -174,7 +154,7 @@ void filesystem_test(void)
         print_fresult(fr);
 
     IWDG_ReloadCounter();
-    /* 4. 写小文件 */
+    /* 3. 写小文件 */
     printf("Writing small file %s...", TEST_FILE_1);
     fr = f_open(&file, TEST_FILE_1, FA_CREATE_ALWAYS | FA_WRITE);
     if (fr == FR_OK)
@@ -191,10 +171,8 @@ void filesystem_test(void)
     }
     IWDG_ReloadCounter();
 
-    /* 4b. 测试长文件名 */
+    /* 3b. 测试长文件名 */
     printf("Testing long filename %s...", TEST_LFN_FILE);
-    OLED_Printf_Line(0, "Testing long filename %s...", TEST_LFN_FILE);
-    OLED_Refresh();
     fr = f_open(&file, TEST_LFN_FILE, FA_CREATE_ALWAYS | FA_WRITE);
     if (fr == FR_OK)
     {
@@ -210,10 +188,12 @@ void filesystem_test(void)
     }
 
     IWDG_ReloadCounter();
-    /* 5. 读回小文件 */
+    /* 4. 读回小文件 */
     printf("Reading back %s...", TEST_FILE_1);
+    uint32_t open_start = get_systick();
     if (f_open(&file, TEST_FILE_1, FA_READ) == FR_OK)
     {
+        printf("(open %lu ms) ", (unsigned long)(get_systick() - open_start));
         char rbuf[128] = {0};
         f_read(&file, rbuf, sizeof(rbuf) - 1, &br);
         f_close(&file);
@@ -221,9 +201,8 @@ void filesystem_test(void)
     }
 
     IWDG_ReloadCounter();
-    /* 6. 1MB 性能测试 */
+    /* 5. 1MB 性能测试 */
     printf("Writing 1MB benchmark file...");
-    OLED_Printf_Line(0, "Writing 1MB benchmark file...");
     fr = f_open(&file, TEST_FILE_2, FA_CREATE_ALWAYS | FA_WRITE);
     if (fr != FR_OK)
     {
@@ -233,7 +212,6 @@ void filesystem_test(void)
 
     memset(g_buffer, 0xA5, sizeof(g_buffer));
     uint32_t start = get_systick();
-    int total_written = 0;
 
     for (int i = 0; i < 32; i++)
     { // 32 × 32KB = 1MB
@@ -243,48 +221,70 @@ void filesystem_test(void)
             printf("Write error at block %d", i);
             break;
         }
-        total_written += bw;
+        res->written += bw;
         IWDG_ReloadCounter();
     }
     f_close(&file);
+    res->elapsed = get_systick() - start;
 
-    uint32_t elapsed = get_systick() - start;
-    float seconds = elapsed / 1000.0f;
-    if (seconds < 0.001f)
-        seconds = 0.001f;
-    float speed = total_written / 1024.0f / seconds;
-    printf("1MB written in %.2f s -> %.1f KB/s\n", seconds, speed);
-    OLED_Printf_Line(1, "1MB written in %.2f s -> %.1f KB/s", seconds, speed);
-    OLED_Refresh();
-    /* 7. 目录列表 */
+    /* 6. 目录列表 */
     printf("\nDirectory listing:\n");
-    if (f_opendir(&dir, "0:") == FR_OK)
+    if (f_opendir(&dir, STORAGE_VOLUME) == FR_OK)
     {
-        int file_count = 0;
         while (f_readdir(&dir, &fno) == FR_OK && fno.fname[0])
         {
             if (fno.fattrib & AM_DIR)
-               { printf(" <DIR>   %s\n", fno.fname);
-                OLED_Printf_Line(3," <DIR>   %s\n", fno.fname);
-            
-                   }    else
+                printf(" <DIR>   %s\n", fno.fname);
+            else
                 printf("        %lu  %s\n", (unsigned long)fno.fsize, fno.fname);
-            OLED_Printf_Line(2, " %lu  %s\n", (unsigned long)fno.fsize, fno.fname);
             // 每处理10个文件喂一次狗，防止目录项过多导致超时
-            file_count++;
-            if (file_count % 10 == 0)
+            res->entries++;
+            if (res->entries % 10 == 0)
             {
                 IWDG_ReloadCounter();
             }
-            OLED_Refresh_Dirty();
         }
         f_closedir(&dir);
     }
-    IWDG_ReloadCounter();
 
 end:
     IWDG_ReloadCounter();
-    f_mount(NULL, "0:", 0);
+    DirIndex_NotifyAll();   // 建了测试文件和目录
+    disk_cache_print_stats();
+    return FR_OK;
+}
+
+void filesystem_test(void)
+{
+    FsTestResult res = {0, 0, 0};
+
+    IWDG_Init();
+    printf("========== W25Q128 FatFs Test Start ==========");
+    OLED_Clear();
+    OLED_Printf_Line(0, "W25Q128 FatFs Test");
+    OLED_Printf_Line(1, "Running... see UART");
+    OLED_Refresh();
+    IWDG_ReloadCounter();
+
+    fr = Storage_Call(filesystem_test_job, &res, STORAGE_PRIO_BACKGROUND);
+    if (fr != FR_OK)
+    {
+        printf("Test failed: ");
+        print_fresult(fr);
+        OLED_Printf_Line(1, "Failed %d", fr);
+    }
+    else
+    {
+        float seconds = res.elapsed / 1000.0f;
+        if (seconds < 0.001f)
+            seconds = 0.001f;
+        float speed = res.written / 1024.0f / seconds;
+        printf("1MB written in %.2f s -> %.1f KB/s\n", seconds, speed);
+        OLED_Printf_Line(1, "1MB %.2fs %.1fKB/s", seconds, speed);
+        OLED_Printf_Line(2, "%lu entries in 0:", (unsigned long)res.entries);
+    }
+    OLED_Printf_Line(3, "KEY2 to exit");
+    OLED_Refresh();
     printf("========== W25Q128 FatFs Test End ==========");
 
     u8 key;
@@ -307,3 +307,79 @@ end:
         }
     }
 }
+
+// 基准测试：在存储任务中对已挂载的卷执行（菜单和 bench 命令共用）
+static FRESULT bench_job(void *ctx)
+{
+    FRESULT res;
+
+    W25Q128_SetHighSpeedMode();
+    IWDG_ReloadCounter();
+    disk_cache_reset_stats();
+    res = StorageBench_Run((const char *)ctx, g_buffer, sizeof(g_buffer));
+    disk_cache_print_stats();
+    return res;
+}
+
+/**
+ * @brief 存储基准测试模式
+ * @details 顺序/随机读写、小文件创建删除、追加日志，结果（吞吐量与
+ *          p50/p99/max 延迟）从串口输出。同一份 storage_bench.c 也在
+ *          主机 Flash 模拟器中编译，便于对比存储层改动前后的数据。
+ *          测试在存储任务中对已挂载的卷运行，菜单任务只等待结果。
+ */
+void filesystem_bench(void)
+{
+    IWDG_Init();
+    printf("========== W25Q128 FatFs Benchmark Start ==========\r\n");
+    OLED_Clear();
+    OLED_Printf_Line(0, "FatFs Benchmark");
+    OLED_Printf_Line(1, "Running... see UART");
+    OLED_Refresh();
+    IWDG_ReloadCounter();
+
+    fr = Storage_Call(bench_job, (void *)STORAGE_VOLUME, STORAGE_PRIO_BACKGROUND);
+    if (fr != FR_OK)
+    {
+        printf("Benchmark failed: ");
+        print_fresult(fr);
+    }
+    OLED_Printf_Line(1, fr == FR_OK ? "Done" : "Failed %d", fr);
+    OLED_Printf_Line(3, "KEY2 to exit");
+    OLED_Refresh();
+    printf("========== W25Q128 FatFs Benchmark End ==========\r\n");
+
+    u8 key;
+    while (1)
+    {
+        IWDG_ReloadCounter();
+
+        key = KEY_Get();
+        if (key == KEY2_PRES)
+        {
+            OLED_Clear();
+            return;
+        }
+    }
+}
+
+// =============================================================================
+// 串口命令：在存储任务中对已挂载的卷运行基准，可以选 SD 卡卷
+// =============================================================================
+
+// bench [卷]，默认 "0:"；结果由 StorageBench_Run 打印
+static int cmd_bench(uint32_t argc, const Shell_Arg *argv)
+{
+    const char *dir = argc > 0 ? argv[0].s : "0:";
+
+    return Storage_Call(bench_job, (void *)dir, STORAGE_PRIO_BACKGROUND) == FR_OK ? SHELL_OK : SHELL_ERR_FAIL;
+}
+
+static const Shell_Cmd fs_cmds[] = {
+    { "bench", "|s", cmd_bench, "bench [0:|1:] storage benchmark" },
+};
+
+void filesystem_register_commands(void)
+{
+    Shell_Register(fs_cmds, sizeof(fs_cmds) / sizeof(fs_cmds[0]));
+}
@@ -16,5 +16,7 @@
 
 
 void filesystem_test(void);
+void filesystem_bench(void);
+void filesystem_register_commands(void);    // 串口命令 bench
 
 #endif
@@ -1,41 +1,96 @@
-// #include "frid_test.h"
-
-// void frid_test()
-// {
-// IWDG_ReloadCounter();
-// 	SysTick_Init();
-// 	debug_init();
-//   OLED_Clear();
-//    OLED_Printf_Line(0,"RFID_demo_begin");
-//     OLED_Refresh_Dirty();
- 
-
-//   OLED_Printf_Line(0,"RFID_demo_end");
-
-
-//   OLED_Refresh_Dirty();
-//   u8 key;
-//   while (1)
-//   {
-// IWDG_ReloadCounter(); // 在每个循环中喂狗，防止看门狗复位
-//     delay_ms(1000);
-// 		LED0=0;
-// 		delay_ms(1000);
-// 		LED0=1;
-// IWDG_ReloadCounter(); // 再次喂狗，确保不会超时
-// 		printf("helloworld");
-//     key = KEY_Get();
-//     if (key)
-//     {
-//       switch (key)
-//       {
-//       case KEY2_PRES:
-
-//         OLED_Clear();
-//         return;
-//       default:
-//         break;
-//       }
-//     }
-//   }
-// }
+/**
+ * @file frid_test.c
+ * @brief 刷卡测试界面
+ */
+
+#include "frid_test.h"
+#include "../rfid/rfid_service.h"
+#include "../rfid/rfid_access.h"
+#include "key.h"
+#include "oled.h"
+#include "oled_print.h"
+#include "iwdg.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+
+#define FRID_TEST_WAIT_MS   20      ///< 每次等卡的时间，同时是按键查询周期
+
+static void frid_test_show_stats(void)
+{
+    RfidScan_Stats st;
+
+    RFID_GetScanStats(&st);
+    OLED_Printf_Line(3, "cyc:%lu err:%lu", (unsigned long)st.cycles, (unsigned long)st.errors);
+}
+
+// 上次刷卡距今多久
+static void frid_test_format_ago(char *buf, uint32_t size, uint32_t seen, uint32_t now)
+{
+    uint32_t d = now - seen;
+
+    if (seen == 0 || seen > now) {
+        snprintf(buf, size, "first");
+    } else if (d < 60) {
+        snprintf(buf, size, "%lus ago", (unsigned long)d);
+    } else if (d < 3600) {
+        snprintf(buf, size, "%lum ago", (unsigned long)(d / 60));
+    } else if (d < 86400) {
+        snprintf(buf, size, "%luh ago", (unsigned long)(d / 3600));
+    } else {
+        snprintf(buf, size, "%lud ago", (unsigned long)(d / 86400));
+    }
+}
+
+/**
+ * @brief 显示一次刷卡：UID、登记的名字、放行/拒绝和上次刷卡时间
+ */
+static void frid_test_show_card(const RfidCard *card)
+{
+    TagEntry tag;
+    AccessResult r = RFID_Access_Swipe(card->uid, &tag);
+    char ago[12];
+
+    OLED_Printf_Line(0, "UID:%08lX%s", (unsigned long)card->uid,
+                     card->atq == RFID_ATQ_S50 && card->sak == RFID_SAK_S50 ? " S50" : "");
+    if (r == ACCESS_UNKNOWN) {
+        OLED_Printf_Line(1, "unknown card");
+        OLED_Printf_Line(2, "DENY");
+        return;
+    }
+    frid_test_format_ago(ago, sizeof(ago), tag.last_seen, RFID_Access_Now());
+    OLED_Printf_Line(1, "%s", tag.name);
+    OLED_Printf_Line(2, "%s %s", r == ACCESS_GRANTED ? "GRANT" : "DENY ", ago);
+}
+
+/**
+ * @brief 刷卡测试：KEY2 退出
+ */
+void frid_test(void)
+{
+    RfidCard card;
+    uint32_t n = 0;
+
+    OLED_Clear();
+    OLED_Printf_Line(0, "RFID access");
+    OLED_Printf_Line(1, "waiting card...");
+    frid_test_show_stats();
+    OLED_Refresh();
+    RFID_FlushCards();
+
+    while (1) {
+        IWDG_ReloadCounter();
+        if (RFID_GetCard(&card, pdMS_TO_TICKS(FRID_TEST_WAIT_MS))) {
+            frid_test_show_card(&card);
+            OLED_Refresh_Dirty();
+        }
+        if (++n % (1000 / FRID_TEST_WAIT_MS) == 0) {
+            frid_test_show_stats();
+            OLED_Refresh_Dirty();
+        }
+        if (KEY_Get() == KEY2_PRES) {
+            break;
+        }
+    }
+    OLED_Clear();
+}
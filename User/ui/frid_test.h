@@ -1,10 +1,13 @@
-// #ifndef _FRID_TEST_
-// #define _FRID_TEST_
-// #include "key.h"
-// #include "oled.h"
-// #include "oled_print.h"
-// #include "uart_dma.h"
-// #include "delay.h"
-// void frid_test(void);
+/**
+ * @file frid_test.h
+ * @brief 刷卡测试界面：显示后台 RFID 任务读到的卡和门禁结果（rfid/rfid_service.h、rfid/rfid_access.h）
+ * @details 界面只从卡队列取卡并刷新屏幕，读卡在 RFID 任务中进行；
+ *          取到卡后在 RAM 中的登记表里查找，立即显示名字、放行/拒绝和上次刷卡时间。KEY2 退出。
+ */
 
-// #endif 
+#ifndef _FRID_TEST_
+#define _FRID_TEST_
+
+void frid_test(void);
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * @file imu_capture.c
+ * @brief MPU6050 原始数据高速采集
+ */
+
+#include "imu_capture.h"
+#include "../ff16/stream_log.h"
+#include "../ff16/dir_index.h"
+#include "MPU6050.h"
+#include "key.h"
+#include "oled.h"
+#include "oled_print.h"
+#include "iwdg.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+
+static StreamLog imu_log;
+static uint8_t imu_ring[IMU_CAPTURE_RING] __attribute__((aligned(4)));
+
+// 已正常关闭的旧采集文件没有预留空间，删除后重新分配
+static FRESULT imu_remove_job(void *ctx)
+{
+    FRESULT fr;
+
+    (void)ctx;
+    fr = f_unlink(IMU_CAPTURE_PATH);
+    if (fr == FR_OK) {
+        DirIndex_NotifyRemoved(IMU_CAPTURE_PATH);
+    }
+    return fr;
+}
+
+static void imu_capture_show(const char *state)
+{
+    OLED_Printf_Line(1, "%s", state);
+    OLED_Printf_Line(2, "N:%lu D:%lu", (unsigned long)imu_log.stats.records,
+                     (unsigned long)imu_log.stats.dropped);
+    OLED_Printf_Line(3, "%luK/%luK", (unsigned long)(imu_log.written / 1024),
+                     (unsigned long)(imu_log.capacity / 1024));
+    OLED_Refresh_Dirty();
+}
+
+/**
+ * @brief 采集模式：KEY0 检查点，KEY2 结束
+ */
+void imu_capture(void)
+{
+    ImuRawRecord rec;
+    TickType_t wake;
+    uint32_t n = 0;
+    FRESULT fr;
+    u8 key;
+
+    OLED_Clear();
+    OLED_Printf_Line(0, "IMU raw capture");
+    OLED_Printf_Line(1, "Opening...");
+    OLED_Refresh();
+
+    fr = StreamLog_Open(&imu_log, IMU_CAPTURE_PATH, IMU_CAPTURE_BYTES, sizeof(ImuRawRecord),
+                        imu_ring, sizeof(imu_ring));
+    if (fr == FR_EXIST && Storage_Call(imu_remove_job, NULL, STORAGE_PRIO_INTERACTIVE) == FR_OK) {
+        fr = StreamLog_Open(&imu_log, IMU_CAPTURE_PATH, IMU_CAPTURE_BYTES, sizeof(ImuRawRecord),
+                            imu_ring, sizeof(imu_ring));
+    }
+    if (fr != FR_OK) {
+        printf("imu_capture: open failed (%d)\r\n", fr);
+        OLED_Printf_Line(1, "Open failed %d", fr);
+        OLED_Printf_Line(3, "KEY2 to exit");
+        OLED_Refresh();
+        while (KEY_Get() != KEY2_PRES) {
+            IWDG_ReloadCounter();
+            vTaskDelay(pdMS_TO_TICKS(20));
+        }
+        OLED_Clear();
+        return;
+    }
+    if (imu_log.stats.recovered) {
+        printf("imu_capture: resumed, recovered %lu B after last checkpoint\r\n",
+               (unsigned long)imu_log.stats.recovered);
+    }
+
+    MPU_Set_Rate(IMU_CAPTURE_RATE_HZ);
+    wake = xTaskGetTickCount();
+    while (1) {
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(1000 / IMU_CAPTURE_RATE_HZ));
+        IWDG_ReloadCounter();
+
+        rec.t_ms = (uint32_t)xTaskGetTickCount();
+        MPU_Get_Accelerometer(&rec.ax, &rec.ay, &rec.az);
+        MPU_Get_Gyroscope(&rec.gx, &rec.gy, &rec.gz);
+        StreamLog_Write(&imu_log, &rec, sizeof(rec));
+
+        // 每秒刷新一次屏幕，OLED 传输不占用采样节拍
+        if (++n % IMU_CAPTURE_RATE_HZ == 0) {
+            imu_capture_show(imu_log.written + sizeof(rec) > imu_log.capacity ? "Full" : "Recording");
+        }
+
+        key = KEY_Get();
+        if (key == KEY0_PRES) {
+            StreamLog_Checkpoint(&imu_log);
+        } else if (key == KEY2_PRES) {
+            break;
+        }
+    }
+
+    imu_capture_show("Closing...");
+    fr = StreamLog_Close(&imu_log);
+    MPU_Set_Rate(50);   // 恢复 MPU_Init 的采样率
+    StreamLog_PrintStats(&imu_log);
+    printf("imu_capture: closed (%d)\r\n", fr);
+    OLED_Clear();
+}
@@ -0,0 +1,31 @@
+/**
+ * @file imu_capture.h
+ * @brief MPU6050 原始数据高速采集到文件（stream_log.c）
+ * @details 以 IMU_CAPTURE_RATE_HZ 读取加速度计和陀螺仪原始值，每个样本一条 16 字节记录。
+ *          采样循环只把记录拷入缓冲区，擦除和编程在存储任务中进行，不会拖慢采样。
+ *          KEY0 立即提交检查点，KEY2 结束采集并关闭文件。
+ *          采集中途复位后重新进入会接着上次的数据续写。
+ */
+
+#ifndef _IMU_CAPTURE_H_
+#define _IMU_CAPTURE_H_
+
+#include <stdint.h>
+
+#define IMU_CAPTURE_PATH        "0:/imu_raw.bin"
+#define IMU_CAPTURE_RATE_HZ     200                 ///< 采样率（MPU6050 采样率同时设为该值）
+#define IMU_CAPTURE_BYTES       (1024UL * 1024)     ///< 预分配大小，200Hz 约 5.5 分钟
+#define IMU_CAPTURE_RING        2048                ///< 缓冲区大小，200Hz 下约 640ms 的数据
+
+/**
+ * @brief 文件中的一条记录（小端）
+ */
+typedef struct {
+    uint32_t t_ms;          ///< 系统节拍（ms）
+    int16_t  ax, ay, az;    ///< 加速度原始值
+    int16_t  gx, gy, gz;    ///< 陀螺仪原始值
+} ImuRawRecord;
+
+void imu_capture(void);
+
+#endif
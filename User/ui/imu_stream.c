@@ -0,0 +1,181 @@
+/**
+ * @file imu_stream.c
+ * @brief MPU6050 数据实时遥测
+ */
+
+#include "imu_stream.h"
+#include "../code/telemetry.h"
+#include "../code/shell.h"
+#include "air_level.h"
+#include "simple_pedometer.h"
+#include "MPU6050.h"
+#include "key.h"
+#include "oled.h"
+#include "oled_print.h"
+#include "iwdg.h"
+#include "debug.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <math.h>
+#include <stdio.h>
+
+static TelemChannel imu_ch;
+static TelemChannel motion_ch;
+static uint8_t stream_running = 0;
+static volatile uint8_t announce_pending = 0;   // 串口命令修改了参数，由采样循环重发描述帧（组帧缓冲区不可重入）
+
+static void imu_stream_show(uint32_t bytes_per_s)
+{
+    OLED_Printf_Line(1, "F:%lu D:%lu T:%lu", (unsigned long)(imu_ch.stats.frames + motion_ch.stats.frames),
+                     (unsigned long)(imu_ch.stats.dropped + motion_ch.stats.dropped),
+                     (unsigned long)(imu_ch.stats.throttled + motion_ch.stats.throttled));
+    OLED_Printf_Line(2, "%luB/s", (unsigned long)bytes_per_s);
+    OLED_Printf_Line(3, "Steps:%lu", simple_pedometer_get_steps());
+    OLED_Refresh_Dirty();
+}
+
+static void announce_all(void)
+{
+    Telem_Announce(&imu_ch);
+    Telem_Announce(&motion_ch);
+}
+
+/**
+ * @brief 遥测模式：KEY2 结束
+ */
+void imu_stream(void)
+{
+    int16_t imu[6];
+    ImuMotionSample motion;
+    unsigned long steps, last_steps;
+    uint32_t t, n = 0, bytes_last = 0;
+    uint8_t step_pending = 0;
+    TickType_t wake;
+
+    OLED_Clear();
+    OLED_Printf_Line(0, "IMU telemetry");
+    OLED_Refresh();
+
+    Telem_Init(Debug_TryWriteRecord, IMU_STREAM_BUDGET);
+    Telem_ChannelInit(&imu_ch, IMU_STREAM_CH_IMU, "imu", "hhhhhh", "ax ay az gx gy gz",
+                      sizeof(imu), IMU_STREAM_BATCH, 0);
+    Telem_ChannelInit(&motion_ch, IMU_STREAM_CH_MOTION, "motion", "IhhHH", "steps pitch roll amag step",
+                      sizeof(motion), IMU_STREAM_BATCH, IMU_STREAM_MOTION_MS);
+    announce_all();
+    announce_pending = 0;
+    stream_running = 1;
+    last_steps = simple_pedometer_get_steps();
+
+    MPU_Set_Rate(IMU_STREAM_RATE_HZ);
+    wake = xTaskGetTickCount();
+    while (1) {
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(1000 / IMU_STREAM_RATE_HZ));
+        IWDG_ReloadCounter();
+
+        t = (uint32_t)xTaskGetTickCount();
+        MPU_Get_Accelerometer(&imu[0], &imu[1], &imu[2]);
+        MPU_Get_Gyroscope(&imu[3], &imu[4], &imu[5]);
+        Telem_Push(&imu_ch, t, imu);
+
+        // 计步算法按 100ms 一次调用设计
+        if (n % (IMU_STREAM_RATE_HZ / 10) == 0) {
+            steps = simple_pedometer_update(imu[0], imu[1], imu[2]);
+            if (steps != last_steps) {
+                step_pending = 1;
+                last_steps = steps;
+            }
+        }
+
+        // 姿态角只在 motion 通道需要样本时计算
+        if (Telem_Due(&motion_ch, t)) {
+            float pitch, roll;
+
+            calculate_tilt_angles(imu[0], imu[1], imu[2], &pitch, &roll);
+            motion.steps = (uint32_t)last_steps;
+            motion.pitch = (int16_t)(pitch * 100.0f);
+            motion.roll = (int16_t)(roll * 100.0f);
+            motion.amag = (uint16_t)sqrtf((float)imu[0] * imu[0] + (float)imu[1] * imu[1] + (float)imu[2] * imu[2]);
+            motion.step = step_pending;
+            if (Telem_Push(&motion_ch, t, &motion) == TELEM_OK) {
+                step_pending = 0;
+            }
+        }
+
+        if (++n % IMU_STREAM_RATE_HZ == 0) {
+            uint32_t bytes = imu_ch.stats.bytes + motion_ch.stats.bytes;
+
+            imu_stream_show(bytes - bytes_last);
+            bytes_last = bytes;
+            if (n % (IMU_STREAM_RATE_HZ * IMU_STREAM_ANNOUNCE_S) == 0) {
+                announce_pending = 1;
+            }
+        }
+        if (announce_pending) {
+            announce_pending = 0;
+            announce_all();
+        }
+
+        if (KEY_Get() == KEY2_PRES) {
+            break;
+        }
+    }
+
+    stream_running = 0;
+    Telem_Flush(&imu_ch);
+    Telem_Flush(&motion_ch);
+    MPU_Set_Rate(50);   // 恢复 MPU_Init 的采样率
+    printf("imu_stream: imu %lu frames, motion %lu frames\r\n",
+           (unsigned long)imu_ch.stats.frames, (unsigned long)motion_ch.stats.frames);
+    OLED_Clear();
+}
+
+// =============================================================================
+// 串口命令
+// =============================================================================
+
+static void print_channel(const TelemChannel *ch)
+{
+    if (ch->name == 0) {
+        return;         // 还没有进入过遥测界面
+    }
+    printf("  %u %-7s %3ums batch %2u: offered %lu sampled %lu frames %lu bytes %lu dropped %lu throttled %lu\r\n",
+           ch->id, ch->name, ch->period_ms, ch->batch, (unsigned long)ch->stats.offered,
+           (unsigned long)ch->stats.sampled, (unsigned long)ch->stats.frames, (unsigned long)ch->stats.bytes,
+           (unsigned long)ch->stats.dropped, (unsigned long)ch->stats.throttled);
+}
+
+// telem：打印统计；telem <通道> <间隔ms>：修改采样间隔（0-每个样本），随后重发描述帧
+static int cmd_telem(uint32_t argc, const Shell_Arg *argv)
+{
+    TelemChannel *ch;
+
+    if (argc == 0) {
+        printf("telemetry %s\r\n", stream_running ? "running" : "stopped");
+        print_channel(&imu_ch);
+        print_channel(&motion_ch);
+        return SHELL_OK;
+    }
+    if (argc != 2 || argv[1].u > 60000) {
+        return SHELL_ERR_USAGE;
+    }
+    if (argv[0].u == IMU_STREAM_CH_IMU) {
+        ch = &imu_ch;
+    } else if (argv[0].u == IMU_STREAM_CH_MOTION) {
+        ch = &motion_ch;
+    } else {
+        printf("no channel %lu\r\n", (unsigned long)argv[0].u);
+        return SHELL_ERR_FAIL;
+    }
+    Telem_SetPeriod(ch, (uint16_t)argv[1].u);
+    announce_pending = 1;
+    return SHELL_OK;
+}
+
+static const Shell_Cmd telem_cmds[] = {
+    { "telem", "|uu", cmd_telem, "telem [ch ms] stats / set period" },
+};
+
+void imu_stream_register_commands(void)
+{
+    Shell_Register(telem_cmds, sizeof(telem_cmds) / sizeof(telem_cmds[0]));
+}
@@ -0,0 +1,39 @@
+/**
+ * @file imu_stream.h
+ * @brief MPU6050 数据实时遥测到串口（telemetry.c）
+ * @details 以 IMU_STREAM_RATE_HZ 读取加速度计和陀螺仪原始值，分两个通道发出：
+ *          通道 1 "imu" 为原始六轴，通道 2 "motion" 为步数、俯仰/横滚角、加速度模和计步标志。
+ *          每帧攒 IMU_STREAM_BATCH 个样本，整帧写入 DMA 发送缓冲区，缓冲区满时丢弃整帧、采样不等待。
+ *          上位机 simulator/examples/telem_recv 接收并写成 CSV（或与 imu_capture 相同格式的二进制文件）。
+ *          串口命令 telem 查看统计、修改各通道的采样间隔；KEY2 退出。
+ */
+
+#ifndef _IMU_STREAM_H_
+#define _IMU_STREAM_H_
+
+#include <stdint.h>
+
+#define IMU_STREAM_RATE_HZ      200     ///< 采样率（MPU6050 采样率同时设为该值）
+#define IMU_STREAM_BATCH        10      ///< 每帧样本数
+#define IMU_STREAM_MOTION_MS    20      ///< motion 通道的默认采样间隔
+#define IMU_STREAM_BUDGET       30000   ///< 遥测字节预算（字节/秒），约为 921600bps 的三分之一
+#define IMU_STREAM_ANNOUNCE_S   5       ///< 描述帧重发间隔（秒），上位机中途接入也能识别格式
+
+#define IMU_STREAM_CH_IMU       1
+#define IMU_STREAM_CH_MOTION    2
+
+/**
+ * @brief motion 通道的样本（小端，无填充）
+ */
+typedef struct {
+    uint32_t steps;         ///< 累计步数
+    int16_t  pitch;         ///< 俯仰角，0.01 度
+    int16_t  roll;          ///< 横滚角，0.01 度
+    uint16_t amag;          ///< 加速度模（原始值单位）
+    uint16_t step;          ///< 本样本期间检测到新的一步
+} ImuMotionSample;
+
+void imu_stream(void);
+void imu_stream_register_commands(void);   // 串口命令 telem
+
+#endif
@@ -1,4 +1,5 @@
 #include "iwdg_test.h"
+#include "persist.h"
 
 void iwdg_test(void)
 {
@@ -45,6 +46,11 @@ int count =0;
       {
         IWDG_ReloadCounter();
       }
+      else if (count == 5)
+      {
+        // 即将停止喂狗，复位前保存未落盘的数据
+        Persist_Flush(PERSIST_REASON_WATCHDOG);
+      }
       
       feed_last_time = current_time;
       printf("Feed dog\r\n");
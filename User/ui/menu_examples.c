@@ -25,6 +25,11 @@ extern void menu_2048_oled(void);
 extern void frid_test(void);
 extern void iwdg_test(void);
 extern void air_level_test(void);
+extern void filesystem_bench(void);
+extern void imu_capture(void);
+extern void asset_test(void);
+extern void file_browser(void);
+extern void imu_stream(void);
 
 // ==================================
 // 主菜单功能回调函数
@@ -106,6 +111,36 @@ static void air_level_test_on_select(menu_item_t *item)
     air_level_test();
 }
 
+static void fs_bench_on_select(menu_item_t *item)
+{
+    printf("Starting storage benchmark\r\n");
+    filesystem_bench();
+}
+
+static void imu_log_on_select(menu_item_t *item)
+{
+    printf("Starting IMU raw capture\r\n");
+    imu_capture();
+}
+
+static void assets_on_select(menu_item_t *item)
+{
+    printf("Starting asset pack test\r\n");
+    asset_test();
+}
+
+static void files_on_select(menu_item_t *item)
+{
+    printf("Starting file browser\r\n");
+    file_browser();
+}
+
+static void imu_stream_on_select(menu_item_t *item)
+{
+    printf("Starting IMU telemetry\r\n");
+    imu_stream();
+}
+
 // ==================================
 // 菜单进入和退出回调
 // ==================================
@@ -207,6 +242,11 @@ menu_item_t* create_test_menu(void)
     menu_item_t *frid_test_item = MENU_ITEM_TEXT("frid_test", "frid_test", 20);
     menu_item_t *iwdg_test_item = MENU_ITEM_TEXT("iwdg_test", "iwdg_test", 20);
     menu_item_t *air_level_item = MENU_ITEM_TEXT("air_level", "air_level", 20);
+    menu_item_t *fs_bench_item = MENU_ITEM_TEXT("fs_bench", "fs_bench", 20);
+    menu_item_t *imu_log_item = MENU_ITEM_TEXT("imu_log", "imu_log", 20);
+    menu_item_t *assets_item = MENU_ITEM_TEXT("assets", "assets", 20);
+    menu_item_t *files_item = MENU_ITEM_TEXT("files", "files", 20);
+    menu_item_t *imu_stream_item = MENU_ITEM_TEXT("imu_stream", "imu_stream", 20);
     
     // 设置子菜单回调
     menu_item_set_callbacks(spi_test_item, NULL, NULL, spi_test_on_select, NULL);
@@ -214,6 +254,11 @@ menu_item_t* create_test_menu(void)
     menu_item_set_callbacks(frid_test_item, NULL, NULL, frid_test_on_select, NULL);
     menu_item_set_callbacks(iwdg_test_item, NULL, NULL, iwdg_test_on_select, NULL);
     menu_item_set_callbacks(air_level_item, NULL, NULL, air_level_test_on_select, NULL);
+    menu_item_set_callbacks(fs_bench_item, NULL, NULL, fs_bench_on_select, NULL);
+    menu_item_set_callbacks(imu_log_item, NULL, NULL, imu_log_on_select, NULL);
+    menu_item_set_callbacks(assets_item, NULL, NULL, assets_on_select, NULL);
+    menu_item_set_callbacks(files_item, NULL, NULL, files_on_select, NULL);
+    menu_item_set_callbacks(imu_stream_item, NULL, NULL, imu_stream_on_select, NULL);
     
     // 添加子菜单项
     menu_add_child(test_menu, spi_test_item);
@@ -221,6 +266,11 @@ menu_item_t* create_test_menu(void)
     menu_add_child(test_menu, frid_test_item);
     menu_add_child(test_menu, iwdg_test_item);
     menu_add_child(test_menu, air_level_item);
+    menu_add_child(test_menu, fs_bench_item);
+    menu_add_child(test_menu, imu_log_item);
+    menu_add_child(test_menu, assets_item);
+    menu_add_child(test_menu, files_item);
+    menu_add_child(test_menu, imu_stream_item);
     
     return test_menu;
 }
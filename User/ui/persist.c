@@ -0,0 +1,236 @@
+/**
+ * @file persist.c
+ * @brief 延迟合并的状态持久化实现
+ */
+
+#include "persist.h"
+#include "../ff16/storage_service.h"
+#include <string.h>
+#include <stdio.h>
+
+#define TICKS_TO_MS(t)      ((uint32_t)((uint64_t)(t) * 1000 / configTICK_RATE_HZ))
+
+typedef struct {
+    const char   *name;
+    PersistSaveFn save;
+} PersistEntry;
+
+static PersistEntry objects[PERSIST_OBJ_COUNT];
+static volatile uint8_t dirty_mask = 0;
+static TickType_t dirty_since[PERSIST_OBJ_COUNT];   // 每个对象首次修改（变脏）的时刻
+static TickType_t last_mark = 0;                    // 最后一次修改的时刻
+static StorageRequest flush_req;                    // 空闲/截止触发的后台保存请求
+static PersistStats stats;
+
+// =============================================================================
+// 批量保存（在存储任务中执行）
+// =============================================================================
+
+/**
+ * @brief 取走当前所有脏对象并依次保存
+ * @param ctx 触发原因（PersistReason）
+ */
+static FRESULT persist_flush_job(void *ctx)
+{
+    uint8_t reason = (uint8_t)(uintptr_t)ctx;
+    TickType_t since[PERSIST_OBJ_COUNT];
+    TickType_t start = xTaskGetTickCount();
+    uint32_t written = 0, errors = 0, dirty_ms = 0, dirty_max = 0, flush_ms;
+    uint8_t mask, failed = 0;
+
+    taskENTER_CRITICAL();
+    mask = dirty_mask;
+    dirty_mask = 0;
+    memcpy(since, dirty_since, sizeof(since));
+    taskEXIT_CRITICAL();
+    if (mask == 0) {
+        return FR_OK;
+    }
+
+    for (uint8_t i = 0; i < PERSIST_OBJ_COUNT; i++) {
+        if (!(mask & (1u << i))) {
+            continue;
+        }
+        if (objects[i].save() == 0) {
+            uint32_t ms = TICKS_TO_MS(xTaskGetTickCount() - since[i]);
+            written++;
+            dirty_ms += ms;
+            if (ms > dirty_max) {
+                dirty_max = ms;
+            }
+        } else {
+            failed |= 1u << i;
+            errors++;
+        }
+    }
+    flush_ms = TICKS_TO_MS(xTaskGetTickCount() - start);
+
+    taskENTER_CRITICAL();
+    if (failed) {
+        // 保存期间又被修改的对象以新的时刻为准，否则保留原来的首次修改时刻
+        for (uint8_t i = 0; i < PERSIST_OBJ_COUNT; i++) {
+            if ((failed & (1u << i)) && !(dirty_mask & (1u << i))) {
+                dirty_since[i] = since[i];
+            }
+        }
+        dirty_mask |= failed;
+        last_mark = xTaskGetTickCount();    // 过一个空闲期再重试，避免在空闲钩子里反复失败
+    }
+    stats.flushes[reason < PERSIST_REASON_COUNT ? reason : PERSIST_REASON_EXPLICIT]++;
+    stats.objects_written += written;
+    stats.save_errors += errors;
+    stats.flush_total_ms += flush_ms;
+    if (flush_ms > stats.flush_max_ms) {
+        stats.flush_max_ms = flush_ms;
+    }
+    stats.dirty_total_ms += dirty_ms;
+    if (dirty_max > stats.dirty_max_ms) {
+        stats.dirty_max_ms = dirty_max;
+    }
+    taskEXIT_CRITICAL();
+    return failed ? FR_DISK_ERR : FR_OK;
+}
+
+// =============================================================================
+// 接口
+// =============================================================================
+
+/**
+ * @brief 登记对象的保存函数（在任务开始标记之前调用）
+ */
+void Persist_Register(uint8_t obj, const char *name, PersistSaveFn save)
+{
+    if (obj < PERSIST_OBJ_COUNT) {
+        objects[obj].name = name;
+        objects[obj].save = save;
+    }
+}
+
+/**
+ * @brief 标记对象已修改，立即返回（任务中调用，不能在中断中调用）
+ */
+void Persist_MarkDirty(uint8_t obj)
+{
+    TickType_t now;
+
+    if (obj >= PERSIST_OBJ_COUNT || objects[obj].save == NULL) {
+        return;
+    }
+    now = xTaskGetTickCount();
+    taskENTER_CRITICAL();
+    stats.marks++;
+    if (dirty_mask & (1u << obj)) {
+        stats.coalesced++;
+    } else {
+        dirty_mask |= 1u << obj;
+        dirty_since[obj] = now;
+    }
+    last_mark = now;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief 是否还有未保存的修改
+ */
+uint8_t Persist_Pending(void)
+{
+    return dirty_mask != 0;
+}
+
+/**
+ * @brief 检查空闲/截止条件，满足时提交后台保存请求
+ * @details 由 vApplicationIdleHook 调用，不阻塞：请求只入队，在存储任务中执行。
+ *          已有保存请求在排队时不重复提交。
+ */
+void Persist_Poll(void)
+{
+    TickType_t now, oldest;
+    uint8_t reason;
+
+    if (dirty_mask == 0 || flush_req.busy) {
+        return;
+    }
+    // 调度器已运行但存储服务不可用时，不在空闲任务里直接擦写 Flash
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING && !Storage_Service_Running()) {
+        return;
+    }
+
+    now = xTaskGetTickCount();
+    taskENTER_CRITICAL();
+    oldest = now;
+    for (uint8_t i = 0; i < PERSIST_OBJ_COUNT; i++) {
+        if ((dirty_mask & (1u << i)) && now - dirty_since[i] > now - oldest) {
+            oldest = dirty_since[i];
+        }
+    }
+    if (now - last_mark >= pdMS_TO_TICKS(PERSIST_IDLE_MS)) {
+        reason = PERSIST_REASON_IDLE;
+    } else if (now - oldest >= pdMS_TO_TICKS(PERSIST_MAX_DELAY_MS)) {
+        reason = PERSIST_REASON_DEADLINE;
+    } else {
+        reason = PERSIST_REASON_COUNT;
+    }
+    taskEXIT_CRITICAL();
+    if (reason == PERSIST_REASON_COUNT) {
+        return;
+    }
+
+    flush_req.op = STORAGE_OP_CALL;
+    flush_req.prio = STORAGE_PRIO_BACKGROUND;
+    flush_req.job = persist_flush_job;
+    flush_req.ctx = (void *)(uintptr_t)reason;
+    Storage_Submit(&flush_req);
+}
+
+/**
+ * @brief 立即保存所有脏对象并等待完成（看门狗复位、进入低功耗前调用）
+ * @return 0-全部保存成功（或没有脏对象），其他-有对象保存失败
+ */
+int Persist_Flush(uint8_t reason)
+{
+    if (dirty_mask == 0) {
+        return 0;
+    }
+    return Storage_Call(persist_flush_job, (void *)(uintptr_t)reason, STORAGE_PRIO_INTERACTIVE) == FR_OK ? 0 : -1;
+}
+
+// =============================================================================
+// 统计
+// =============================================================================
+
+void Persist_GetStats(PersistStats *out)
+{
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
+
+void Persist_ResetStats(void)
+{
+    taskENTER_CRITICAL();
+    memset(&stats, 0, sizeof(stats));
+    taskEXIT_CRITICAL();
+}
+
+void Persist_PrintStats(void)
+{
+    PersistStats s;
+    uint32_t flushes = 0;
+
+    Persist_GetStats(&s);
+    for (uint8_t i = 0; i < PERSIST_REASON_COUNT; i++) {
+        flushes += s.flushes[i];
+    }
+    printf("persist: marks %lu (coalesced %lu), flushes %lu "
+           "(idle %lu, deadline %lu, wdg %lu, lowpower %lu, explicit %lu)\r\n",
+           (unsigned long)s.marks, (unsigned long)s.coalesced, (unsigned long)flushes,
+           (unsigned long)s.flushes[PERSIST_REASON_IDLE], (unsigned long)s.flushes[PERSIST_REASON_DEADLINE],
+           (unsigned long)s.flushes[PERSIST_REASON_WATCHDOG], (unsigned long)s.flushes[PERSIST_REASON_LOWPOWER],
+           (unsigned long)s.flushes[PERSIST_REASON_EXPLICIT]);
+    printf("persist: objects %lu, errors %lu, flush avg %lu ms max %lu ms, "
+           "dirty avg %lu ms max %lu ms\r\n",
+           (unsigned long)s.objects_written, (unsigned long)s.save_errors,
+           (unsigned long)(flushes ? s.flush_total_ms / flushes : 0), (unsigned long)s.flush_max_ms,
+           (unsigned long)(s.objects_written ? s.dirty_total_ms / s.objects_written : 0),
+           (unsigned long)s.dirty_max_ms);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file persist.h
+ * @brief 延迟合并的状态持久化：记录脏对象，攒够时机后在一次存储事务中批量保存
+ * @details 步数每走一步都会变化，闹钟和时间设置在菜单里往往连续修改几次。
+ *          各模块只调用 Persist_MarkDirty() 标记对象已修改（不访问 Flash），
+ *          本模块在以下时机把所有脏对象放进同一个 STORAGE_OP_CALL 请求依次保存：
+ *          - 空闲：最后一次修改之后安静了 PERSIST_IDLE_MS（由空闲钩子调用 Persist_Poll 检查）
+ *          - 截止：最早的未保存修改已等待 PERSIST_MAX_DELAY_MS（持续走路时不会空闲）
+ *          - 看门狗/低功耗：即将停止喂狗或进入 STOP/STANDBY 前调用 Persist_Flush() 同步保存
+ *
+ *          期间对同一对象的多次修改合并为一次写入；保存失败的对象保持为脏，
+ *          过 PERSIST_IDLE_MS 后重试。对象及其保存函数由 Persist_Register() 登记。
+ */
+
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <stdint.h>
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#define PERSIST_IDLE_MS         2000    ///< 最后一次修改后安静这么久即保存
+#define PERSIST_MAX_DELAY_MS    60000   ///< 最早的未保存修改最多等待这么久
+
+/**
+ * @brief 持久化对象
+ */
+typedef enum {
+    PERSIST_OBJ_STEPS = 0,  ///< 步数（A/B 记录）
+    PERSIST_OBJ_ALARMS,     ///< 闹钟表（KV）
+    PERSIST_OBJ_RTC,        ///< 时间设置（KV，备份域掉电后恢复用）
+    PERSIST_OBJ_TAGS,       ///< 卡片最后刷卡时间（rfid_access.c，登记表日志）
+    PERSIST_OBJ_COUNT
+} PersistObj;
+
+/**
+ * @brief 触发保存的原因
+ */
+typedef enum {
+    PERSIST_REASON_IDLE = 0,    ///< 修改停止后的空闲期
+    PERSIST_REASON_DEADLINE,    ///< 最长延迟到期
+    PERSIST_REASON_WATCHDOG,    ///< 即将停止喂狗（看门狗复位）
+    PERSIST_REASON_LOWPOWER,    ///< 进入低功耗模式前
+    PERSIST_REASON_EXPLICIT,    ///< 调用方要求立即保存
+    PERSIST_REASON_COUNT
+} PersistReason;
+
+/**
+ * @brief 保存函数，在存储任务中执行，返回 0 表示成功
+ */
+typedef int (*PersistSaveFn)(void);
+
+/**
+ * @brief 统计信息（时间单位为毫秒）
+ */
+typedef struct {
+    uint32_t marks;                         ///< Persist_MarkDirty 调用次数
+    uint32_t coalesced;                     ///< 对象已脏时的再次标记（被合并掉的写入）
+    uint32_t flushes[PERSIST_REASON_COUNT]; ///< 按原因统计的批量保存次数（有脏对象的）
+    uint32_t objects_written;               ///< 成功保存的对象数
+    uint32_t save_errors;                   ///< 保存失败的对象数
+    uint32_t flush_max_ms;                  ///< 单次批量保存的最长耗时
+    uint32_t flush_total_ms;                ///< 批量保存累计耗时
+    uint32_t dirty_max_ms;                  ///< 从首次修改到落盘的最长延迟
+    uint32_t dirty_total_ms;                ///< 从首次修改到落盘的累计延迟（按对象）
+} PersistStats;
+
+void Persist_Register(uint8_t obj, const char *name, PersistSaveFn save);
+void Persist_MarkDirty(uint8_t obj);
+uint8_t Persist_Pending(void);
+
+void Persist_Poll(void);
+int  Persist_Flush(uint8_t reason);
+
+void Persist_GetStats(PersistStats *stats);
+void Persist_ResetStats(void);
+void Persist_PrintStats(void);
+
+#endif
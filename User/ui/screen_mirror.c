@@ -0,0 +1,107 @@
+/**
+ * @file screen_mirror.c
+ * @brief OLED 画面镜像到串口
+ */
+
+#include "screen_mirror.h"
+#include "../code/oled_mirror.h"
+#include "../code/telemetry.h"
+#include "../code/shell.h"
+#include "oled.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+
+// 显存副本和组帧缓冲区只由 CPU 访问（发送时拷入串口缓冲区），放在 CCM RAM
+__attribute__((section(".ccmram")))
+static OledMirror mirror;
+static TelemChannel mirror_ch;
+static uint8_t mirror_on = 0;
+static uint32_t last_key;
+
+static uint32_t mirror_send(void *ctx, const uint8_t *data, uint32_t len)
+{
+    (void)ctx;
+    return Telem_SendBlock(&mirror_ch, (uint32_t)xTaskGetTickCount(), data, len);
+}
+
+/**
+ * @brief OLED 刷新回调（在刷新屏幕的任务中执行）
+ * @details 菜单任务和 data_task（串口命令）都会刷新屏幕，这里挂起调度器，副本和遥测组帧缓冲区
+ *          不会被另一个任务打断；输出用 Debug_TryWriteRecord，放不下时丢弃，不会在挂起期间等待。
+ *          imu_stream 在菜单任务中 Telem_Push，优先级更低的 data_task 不会打断它组帧。
+ */
+static void mirror_hook(uint8_t x1, uint8_t page1, uint8_t x2, uint8_t page2)
+{
+    uint32_t now = (uint32_t)xTaskGetTickCount();
+
+    vTaskSuspendAll();
+    if (now - last_key >= SCREEN_MIRROR_KEY_MS) {
+        last_key = now;
+        Telem_Announce(&mirror_ch);
+        OledMirror_Key(&mirror, OLED_GetGRAM());
+    } else {
+        OledMirror_Update(&mirror, OLED_GetGRAM(), x1, page1, x2, page2);
+    }
+    xTaskResumeAll();
+}
+
+/**
+ * @brief 打开/关闭镜像，打开时立即发送描述帧和整屏
+ */
+void Screen_Mirror_Enable(uint8_t on)
+{
+    if (on == mirror_on) {
+        return;
+    }
+    if (!on) {
+        OLED_SetRefreshHook(0);
+        mirror_on = 0;
+        return;
+    }
+    if (mirror_ch.name == 0) {
+        Telem_ChannelInit(&mirror_ch, SCREEN_MIRROR_CH, "oled", "B", "rec", 1, 1, 0);
+        OledMirror_Init(&mirror, mirror_send, 0);
+    }
+    mirror_on = 1;
+    // 立即发整屏：只读显存，不写屏幕（I2C 由刷新屏幕的任务使用）
+    last_key = (uint32_t)xTaskGetTickCount() - SCREEN_MIRROR_KEY_MS;
+    mirror_hook(0, 0, OLED_MIRROR_COLS - 1, OLED_MIRROR_PAGES - 1);
+    OLED_SetRefreshHook(mirror_hook);
+}
+
+uint8_t Screen_Mirror_Enabled(void)
+{
+    return mirror_on;
+}
+
+// =============================================================================
+// 串口命令
+// =============================================================================
+
+// mirror：打印统计；mirror on|off：开关
+static int cmd_mirror(uint32_t argc, const Shell_Arg *argv)
+{
+    const OledMirror_Stats *st = &mirror.stats;
+
+    if (argc > 0) {
+        Screen_Mirror_Enable((uint8_t)argv[0].u);
+        return SHELL_OK;
+    }
+    printf("mirror %s: %lu refreshes (%lu unchanged), %lu spans, %lu frames, %lu bytes of %lu raw, "
+           "%lu dropped, %lu keyframes, %lu throttled\r\n",
+           mirror_on ? "on" : "off", (unsigned long)st->refreshes, (unsigned long)st->unchanged,
+           (unsigned long)st->spans, (unsigned long)st->frames, (unsigned long)st->bytes,
+           (unsigned long)st->raw_bytes, (unsigned long)st->dropped, (unsigned long)st->keyframes,
+           (unsigned long)mirror_ch.stats.throttled);
+    return SHELL_OK;
+}
+
+static const Shell_Cmd mirror_cmds[] = {
+    { "mirror", "|b", cmd_mirror, "mirror [on|off] OLED to USART1 / stats" },
+};
+
+void screen_mirror_register_commands(void)
+{
+    Shell_Register(mirror_cmds, sizeof(mirror_cmds) / sizeof(mirror_cmds[0]));
+}
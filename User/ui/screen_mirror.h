@@ -0,0 +1,25 @@
+/**
+ * @file screen_mirror.h
+ * @brief OLED 画面镜像到串口（code/oled_mirror.c）
+ * @details 打开后每次 OLED_Refresh / OLED_Refresh_Area 写完屏幕，把刷新区域内变化的显存段
+ *          RLE 压缩后作为遥测通道 SCREEN_MIRROR_CH（"oled"）的帧发出，与 printf、日志和其它遥测通道共用 USART1。
+ *          上位机 OLED/simulator 的 oled_remote 实时显示，或录成回放文件离线查看、统计
+ *          （simulator/examples/oled_replay）。
+ *          帧被丢弃后下一次刷新整屏重发；另外每 SCREEN_MIRROR_KEY_MS 整屏重发一次并重发描述帧，
+ *          上位机中途接入也能在几秒内显示完整画面。
+ *          串口命令 mirror [on|off] 开关（默认关闭）并打印统计。
+ */
+
+#ifndef _SCREEN_MIRROR_H_
+#define _SCREEN_MIRROR_H_
+
+#include <stdint.h>
+
+#define SCREEN_MIRROR_CH        3       ///< 遥测通道号（1、2 为 imu_stream）
+#define SCREEN_MIRROR_KEY_MS    5000    ///< 整屏重发间隔
+
+void Screen_Mirror_Enable(uint8_t on);
+uint8_t Screen_Mirror_Enabled(void);
+void screen_mirror_register_commands(void);    // 串口命令 mirror
+
+#endif
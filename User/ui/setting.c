@@ -1,5 +1,6 @@
 #include "setting.h"
 #include "ui/alarm_all.h"
+#include "ui/persist.h"
 
 // 设置步骤和临时变量
 static u8 set_time_step = 0;
@@ -206,6 +207,7 @@ void Process_Set_Time(void)
                 // 保存时间设置
                 printf("Saving time: %02d:%02d:%02d\n", temp_hours, temp_minutes, temp_seconds);
                 RTC_SetTime_Manual(temp_hours, temp_minutes, temp_seconds);
+                Persist_MarkDirty(PERSIST_OBJ_RTC);
                 set_time_step = 0;
                 return;
 
@@ -353,6 +355,7 @@ void Process_Set_Date(void)
                 // 保存日期设置
                 printf("Saving date: %04d-%02d-%02d (Week: %s)\n", temp_year + 2000, temp_month, temp_day, get_weekday_name(temp_weekday));
                 RTC_SetDate_Manual(temp_year, temp_month, temp_day, temp_weekday);
+                Persist_MarkDirty(PERSIST_OBJ_RTC);
                 set_date_step = 0;
                 return;
 
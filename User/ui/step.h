@@ -7,7 +7,8 @@
 void step(void);
 
 // 步数存储函数
-void Steps_Save(void);
+int  Steps_Save(void);
 void Steps_Load(void);
+void Steps_LoadSync(void);
 
 #endif
@@ -9,15 +9,20 @@
 #include "step_file.h"
 #include "step.h"
 #include "../ff16/ff.h"
+#include "../ff16/storage_service.h"
+#include "../ff16/dir_index.h"
+#include "ab_record.h"
+#include "flash_layout.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef STM32F4XX
 #include "stm32f4xx.h"
 #endif
 
-// 步数数据文件路径
+// 旧版步数数据文件路径（仅用于迁移）
 #define STEP_DATA_FILE "0:steps.dat"
 
 // 定义基本类型
@@ -38,6 +43,15 @@ typedef struct {
     uint16_t checksum;             // 数据校验和
 } StepData_TypeDef;
 
+// A/B 记录中的步数（CRC32 在槽头中）
+typedef struct {
+    uint32_t step_count;           // 步数
+    uint32_t last_update_time;     // 最后更新时间戳（秒）
+    uint32_t total_active_seconds; // 累计活跃时间（秒）
+} StepRecord_TypeDef;
+
+static AB_Region step_region = AB_REGION_INIT(FLASH_AB_STEPS_BASE, sizeof(StepRecord_TypeDef));
+
 // 声明全局变量
 extern unsigned long g_step_count;
 extern uint32_t get_systick(void);
@@ -57,46 +71,33 @@ static uint16_t Calculate_Checksum(uint8_t *data, uint16_t length)
     return checksum;
 }
 
+static int Steps_Store(void)
+{
+    StepRecord_TypeDef rec;
+    
+    rec.step_count = (uint32_t)g_step_count;
+    rec.last_update_time = get_systick() / 1000;  // 转换为秒
+    rec.total_active_seconds = rec.last_update_time;  // 简化处理
+    return AB_Save(&step_region, &rec);
+}
+
 /**
- * @brief 保存步数数据到文件
+ * @brief 保存步数
+ * @details 写入 A/B 记录区的下一个空槽，一次页编程；当前有效记录不被改写，
+ *          掉电时加载到的是上一次或这一次保存的值。
+ *          由 persist.c 在存储任务中调用，计步时只标记 PERSIST_OBJ_STEPS
+ * @return AB_OK-成功，其他-失败
  */
-void Steps_Save(void)
+int Steps_Save(void)
 {
-    FIL file;
-    FRESULT fr;
-    UINT bw;
-    StepData_TypeDef step_data;
-    
-    // 准备步数数据
-    step_data.step_count = g_step_count;
-    step_data.last_update_time = get_systick() / 1000;  // 转换为秒
-    step_data.total_active_seconds = step_data.last_update_time;  // 简化处理
-    
-    // 计算校验和（不包括checksum字段）
-    uint8_t *data_ptr = (uint8_t*)&step_data;
-    step_data.checksum = Calculate_Checksum(data_ptr, sizeof(StepData_TypeDef) - sizeof(uint16_t));
-    
-    // 打开文件用于写入（如果不存在则创建，存在则覆盖）
-    fr = f_open(&file, STEP_DATA_FILE, FA_CREATE_ALWAYS | FA_WRITE);
-    if (fr != FR_OK) {
-        return;
-    }
-    
-    // 写入步数数据
-    fr = f_write(&file, &step_data, sizeof(StepData_TypeDef), &bw);
-    if (fr != FR_OK || bw != sizeof(StepData_TypeDef)) {
-        f_close(&file);
-        return;
-    }
-    
-    // 关闭文件
-    f_close(&file);
+    return Steps_Store();
 }
 
 /**
- * @brief 从文件加载步数数据
+ * @brief 从旧版 steps.dat 读取步数
+ * @return 1 读取成功且校验通过，0 失败
  */
-void Steps_Load(void)
+static uint8_t Steps_LoadLegacy(unsigned long *step_count)
 {
     FIL file;
     FRESULT fr;
@@ -106,31 +107,66 @@ void Steps_Load(void)
     // 打开文件用于读取
     fr = f_open(&file, STEP_DATA_FILE, FA_READ);
     if (fr != FR_OK) {
-        // 文件不存在或其他错误，初始化为0步数
-        g_step_count = 0;
-        return;
+        return 0;
     }
     
     // 读取步数数据
     fr = f_read(&file, &step_data, sizeof(StepData_TypeDef), &br);
+    f_close(&file);
     if (fr != FR_OK || br != sizeof(StepData_TypeDef)) {
-        f_close(&file);
-        g_step_count = 0;
-        return;
+        return 0;
     }
     
-    // 关闭文件
-    f_close(&file);
-    
     // 计算并验证校验和
     uint8_t *data_ptr = (uint8_t*)&step_data;
-    uint16_t calculated_checksum = Calculate_Checksum(data_ptr, sizeof(StepData_TypeDef) - sizeof(uint16_t));
+    uint16_t calculated_checksum = Calculate_Checksum(data_ptr, offsetof(StepData_TypeDef, checksum));
+    if (step_data.checksum != calculated_checksum) {
+        return 0;
+    }
     
-    if (step_data.checksum == calculated_checksum) {
-        // 校验通过，使用保存的数据
-        g_step_count = step_data.step_count;
+    *step_count = step_data.step_count;
+    return 1;
+}
+
+/**
+ * @brief 加载步数
+ * @details 优先读 A/B 记录；没有时尝试旧版 steps.dat，读到后写入 A/B 记录并删除旧文件
+ */
+void Steps_Load(void)
+{
+    StepRecord_TypeDef rec;
+    unsigned long legacy;
+    
+    if (AB_Load(&step_region, &rec) == AB_OK) {
+        g_step_count = rec.step_count;
+        return;
+    }
+    
+    if (Steps_LoadLegacy(&legacy)) {
+        g_step_count = legacy;
+        if (Steps_Store() == AB_OK) {
+            if (f_unlink(STEP_DATA_FILE) == FR_OK) {
+                DirIndex_NotifyRemoved(STEP_DATA_FILE);
+            }
+        }
     } else {
-        // 校验失败，使用默认值
+        // 没有保存过或数据损坏，初始化为0步数
         g_step_count = 0;
     }
 }
+
+static FRESULT steps_load_job(void *ctx)
+{
+    (void)ctx;
+    Steps_Load();
+    return FR_OK;
+}
+
+/**
+ * @brief 经存储服务加载步数（服务未运行时直接加载）
+ * @details 启动时在任何一步被标记为脏之前调用，否则第一次保存会用 0 起算的步数覆盖已保存的值
+ */
+void Steps_LoadSync(void)
+{
+    Storage_Call(steps_load_job, NULL, STORAGE_PRIO_INTERACTIVE);
+}
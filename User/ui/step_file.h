@@ -4,7 +4,8 @@
 #include "sys.h"
 
 // 步数文件操作函数
-void Steps_Save(void);
+int  Steps_Save(void);
 void Steps_Load(void);
+void Steps_LoadSync(void);
 
 #endif
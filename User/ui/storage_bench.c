@@ -0,0 +1,460 @@
+/**
+ * @file storage_bench.c
+ * @brief FatFs 存储性能基准测试实现
+ */
+
+#include "storage_bench.h"
+#include "../ff16/dir_index.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef FLASH_SIMULATOR
+#include "w25q128_sim.h"
+#define BENCH_FEED()    ((void)0)
+#else
+#include "stm32f4xx.h"
+#define BENCH_FEED()    IWDG_ReloadCounter()
+#endif
+
+#define BENCH_PATH_MAX  32
+
+static StorageBench_Hist g_hist;    // 各工作负载轮流使用，避免占用栈
+static uint32_t g_rand_state;
+
+// =============================================================================
+// 计时
+// =============================================================================
+
+#ifdef FLASH_SIMULATOR
+
+static void bench_timer_init(void)
+{
+}
+
+uint32_t StorageBench_Now_us(void)
+{
+    return (uint32_t)W25Q128_Sim_Time_us();
+}
+
+#else
+
+// DWT 周期计数器 168MHz 下约 25s 回绕一次，这里按差值累加成 32 位微秒计数，
+// 只要两次调用间隔小于 25s 就不会丢失时间
+static uint32_t g_last_cyc;
+static uint32_t g_rem_cyc;
+static uint32_t g_now_us;
+
+static void bench_timer_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    g_last_cyc = 0;
+    g_rem_cyc = 0;
+}
+
+uint32_t StorageBench_Now_us(void)
+{
+    uint32_t cyc = DWT->CYCCNT;
+    uint32_t per_us = SystemCoreClock / 1000000;
+
+    g_rem_cyc += cyc - g_last_cyc;
+    g_last_cyc = cyc;
+    g_now_us += g_rem_cyc / per_us;
+    g_rem_cyc %= per_us;
+    return g_now_us;
+}
+
+#endif
+
+// =============================================================================
+// 延迟直方图
+// =============================================================================
+
+static uint32_t hist_bucket(uint32_t us)
+{
+    uint32_t msb = 0;
+
+    if (us < STORAGE_BENCH_HIST_SUB) {
+        return us;
+    }
+    while ((us >> msb) > 1) {
+        msb++;
+    }
+    // msb >= 3：取最高位后的 3 位作为子桶
+    return (msb - 2) * STORAGE_BENCH_HIST_SUB + ((us >> (msb - 3)) & (STORAGE_BENCH_HIST_SUB - 1));
+}
+
+// 桶的上界（百分位按上界报告，偏保守）
+static uint32_t hist_bucket_upper(uint32_t bucket)
+{
+    uint32_t msb, sub, shift;
+
+    if (bucket < STORAGE_BENCH_HIST_SUB) {
+        return bucket;
+    }
+    msb = bucket / STORAGE_BENCH_HIST_SUB + 2;
+    sub = bucket % STORAGE_BENCH_HIST_SUB;
+    shift = msb - 3;
+    return ((STORAGE_BENCH_HIST_SUB + sub) << shift) + ((1u << shift) - 1);
+}
+
+void StorageBench_Hist_Reset(StorageBench_Hist *h)
+{
+    memset(h, 0, sizeof(*h));
+}
+
+void StorageBench_Hist_Add(StorageBench_Hist *h, uint32_t us)
+{
+    uint32_t b = hist_bucket(us);
+
+    if (h->count[b] != 0xFFFF) {
+        h->count[b]++;
+    }
+    h->samples++;
+    if (us > h->max_us) {
+        h->max_us = us;
+    }
+}
+
+/**
+ * @brief 求百分位延迟
+ * @param permille 千分位（500 = p50，990 = p99）
+ */
+uint32_t StorageBench_Hist_Percentile(const StorageBench_Hist *h, uint32_t permille)
+{
+    uint32_t target, seen = 0;
+
+    if (h->samples == 0) {
+        return 0;
+    }
+    target = (uint32_t)(((uint64_t)h->samples * permille + 999) / 1000);
+    if (target == 0) {
+        target = 1;
+    }
+    for (uint32_t b = 0; b < STORAGE_BENCH_HIST_BUCKETS; b++) {
+        seen += h->count[b];
+        if (seen >= target) {
+            uint32_t upper = hist_bucket_upper(b);
+            return upper < h->max_us ? upper : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+// =============================================================================
+// 结果输出
+// =============================================================================
+
+void StorageBench_PrintHeader(void)
+{
+    printf("%-18s %6s %9s %9s %7s %7s %8s %8s %8s\r\n",
+           "workload", "ops", "bytes", "time_ms", "KB/s", "ops/s",
+           "p50_us", "p99_us", "max_us");
+}
+
+void StorageBench_PrintResult(const StorageBench_Result *r)
+{
+    uint32_t elapsed = r->elapsed_us ? r->elapsed_us : 1;
+    unsigned long kbps = (unsigned long)((uint64_t)r->bytes * 1000000u / 1024u / elapsed);
+    unsigned long opsps = (unsigned long)((uint64_t)r->ops * 1000000u / elapsed);
+
+    printf("%-18s %6lu %9lu %9lu %7lu %7lu %8lu %8lu %8lu",
+           r->name, (unsigned long)r->ops, (unsigned long)r->bytes,
+           (unsigned long)(r->elapsed_us / 1000), kbps, opsps,
+           (unsigned long)r->p50_us, (unsigned long)r->p99_us,
+           (unsigned long)r->max_us);
+    if (r->fr != FR_OK) {
+        printf("  (FRESULT %d)", r->fr);
+    }
+    printf("\r\n");
+}
+
+// 从直方图填入延迟字段并打印
+static void bench_finish(StorageBench_Result *r, uint32_t start_us)
+{
+    r->elapsed_us = StorageBench_Now_us() - start_us;
+    r->p50_us = StorageBench_Hist_Percentile(&g_hist, 500);
+    r->p99_us = StorageBench_Hist_Percentile(&g_hist, 990);
+    r->max_us = g_hist.max_us;
+    StorageBench_PrintResult(r);
+}
+
+static void bench_begin(StorageBench_Result *r, const char *name)
+{
+    memset(r, 0, sizeof(*r));
+    r->name = name;
+    StorageBench_Hist_Reset(&g_hist);
+}
+
+// =============================================================================
+// 工作负载
+// =============================================================================
+
+// xorshift32，固定种子保证每次运行的访问序列相同
+static uint32_t bench_rand(void)
+{
+    uint32_t x = g_rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_rand_state = x;
+    return x;
+}
+
+// 每次写入前改写缓冲区开头的序号，避免重复写入相同内容时底层跳过擦除
+static void bench_stamp(uint8_t *buf, uint32_t seq)
+{
+    seq += g_rand_state;
+    memcpy(buf, &seq, sizeof(seq));
+}
+
+static void bench_path(char *out, const char *dir, const char *name)
+{
+    snprintf(out, BENCH_PATH_MAX, "%s/%s", dir, name);
+}
+
+static FRESULT bench_seq(const char *path, uint8_t *buf, uint32_t req, int write)
+{
+    static char name[32];
+    StorageBench_Result r;
+    FIL f;
+    UINT done;
+    uint32_t start, t0;
+
+    snprintf(name, sizeof(name), "seq %s %luB", write ? "write" : "read", (unsigned long)req);
+    bench_begin(&r, name);
+
+    start = StorageBench_Now_us();
+    r.fr = f_open(&f, path, write ? (FA_CREATE_ALWAYS | FA_WRITE) : FA_READ);
+    if (r.fr == FR_OK) {
+        for (uint32_t off = 0; off < STORAGE_BENCH_SEQ_BYTES; off += req) {
+            if (write) {
+                bench_stamp(buf, r.ops);
+            }
+            t0 = StorageBench_Now_us();
+            r.fr = write ? f_write(&f, buf, req, &done) : f_read(&f, buf, req, &done);
+            StorageBench_Hist_Add(&g_hist, StorageBench_Now_us() - t0);
+            if (r.fr == FR_OK && done != req) {
+                r.fr = FR_DENIED;   // 卷已满或文件比预期短
+            }
+            if (r.fr != FR_OK) {
+                break;
+            }
+            r.ops++;
+            r.bytes += done;
+            BENCH_FEED();
+        }
+        if (f_close(&f) != FR_OK && r.fr == FR_OK) {
+            r.fr = FR_DISK_ERR;
+        }
+    }
+    bench_finish(&r, start);
+    return r.fr;
+}
+
+static FRESULT bench_random(const char *path, uint8_t *buf, int write)
+{
+    StorageBench_Result r;
+    FIL f;
+    UINT done;
+    uint32_t start, t0;
+    const uint32_t blocks = STORAGE_BENCH_SEQ_BYTES / 512;
+
+    bench_begin(&r, write ? "random write 512B" : "random read 512B");
+    g_rand_state = 0x12345678;
+
+    start = StorageBench_Now_us();
+    r.fr = f_open(&f, path, write ? (FA_OPEN_EXISTING | FA_WRITE) : FA_READ);
+    if (r.fr == FR_OK) {
+        for (uint32_t i = 0; i < STORAGE_BENCH_RANDOM_OPS; i++) {
+            FSIZE_t ofs = (FSIZE_t)(bench_rand() % blocks) * 512;
+            if (write) {
+                bench_stamp(buf, i);
+            }
+            t0 = StorageBench_Now_us();
+            r.fr = f_lseek(&f, ofs);
+            if (r.fr == FR_OK) {
+                r.fr = write ? f_write(&f, buf, 512, &done) : f_read(&f, buf, 512, &done);
+            }
+            StorageBench_Hist_Add(&g_hist, StorageBench_Now_us() - t0);
+            if (r.fr != FR_OK) {
+                break;
+            }
+            r.ops++;
+            r.bytes += done;
+            BENCH_FEED();
+        }
+        if (f_close(&f) != FR_OK && r.fr == FR_OK) {
+            r.fr = FR_DISK_ERR;
+        }
+    }
+    bench_finish(&r, start);
+    return r.fr;
+}
+
+static FRESULT bench_churn(const char *dir, uint8_t *buf)
+{
+    StorageBench_Result r;
+    char path[BENCH_PATH_MAX];
+    char name[16];
+    FIL f;
+    UINT done;
+    uint32_t start, t0;
+    FRESULT fr = FR_OK;
+
+    // 创建：open + write + close 计为一次操作
+    bench_begin(&r, "churn create");
+    start = StorageBench_Now_us();
+    for (uint32_t i = 0; i < STORAGE_BENCH_CHURN_FILES; i++) {
+        snprintf(name, sizeof(name), "bc%03lu.dat", (unsigned long)i);
+        bench_path(path, dir, name);
+        t0 = StorageBench_Now_us();
+        r.fr = f_open(&f, path, FA_CREATE_ALWAYS | FA_WRITE);
+        if (r.fr == FR_OK) {
+            r.fr = f_write(&f, buf, STORAGE_BENCH_CHURN_SIZE, &done);
+            if (f_close(&f) != FR_OK && r.fr == FR_OK) {
+                r.fr = FR_DISK_ERR;
+            }
+        }
+        StorageBench_Hist_Add(&g_hist, StorageBench_Now_us() - t0);
+        if (r.fr != FR_OK) {
+            break;
+        }
+        r.ops++;
+        r.bytes += done;
+        BENCH_FEED();
+    }
+    bench_finish(&r, start);
+    fr = r.fr;
+
+    bench_begin(&r, "churn delete");
+    start = StorageBench_Now_us();
+    for (uint32_t i = 0; i < STORAGE_BENCH_CHURN_FILES; i++) {
+        snprintf(name, sizeof(name), "bc%03lu.dat", (unsigned long)i);
+        bench_path(path, dir, name);
+        t0 = StorageBench_Now_us();
+        r.fr = f_unlink(path);
+        StorageBench_Hist_Add(&g_hist, StorageBench_Now_us() - t0);
+        if (r.fr == FR_NO_FILE) {
+            r.fr = FR_OK;   // 创建阶段中途失败时后面的文件本就不存在
+            continue;
+        }
+        if (r.fr != FR_OK) {
+            break;
+        }
+        r.ops++;
+        BENCH_FEED();
+    }
+    bench_finish(&r, start);
+    return fr != FR_OK ? fr : r.fr;
+}
+
+static FRESULT bench_append_log(const char *path)
+{
+    StorageBench_Result r;
+    char record[STORAGE_BENCH_LOG_RECORD];
+    FIL f;
+    UINT done;
+    uint32_t start, t0;
+
+    bench_begin(&r, "append log+sync");
+
+    start = StorageBench_Now_us();
+    r.fr = f_open(&f, path, FA_CREATE_ALWAYS | FA_WRITE);
+    if (r.fr == FR_OK) {
+        for (uint32_t i = 0; i < STORAGE_BENCH_LOG_RECORDS; i++) {
+            // 定长文本记录，模拟计步/温湿度日志
+            memset(record, ' ', sizeof(record));
+            snprintf(record, sizeof(record), "%08lu,%lu,step=%lu",
+                     (unsigned long)StorageBench_Now_us(), (unsigned long)i,
+                     (unsigned long)(i * 7));
+            record[strlen(record)] = ' ';
+            record[sizeof(record) - 1] = '\n';
+
+            t0 = StorageBench_Now_us();
+            r.fr = f_write(&f, record, sizeof(record), &done);
+            if (r.fr == FR_OK) {
+                r.fr = f_sync(&f);
+            }
+            StorageBench_Hist_Add(&g_hist, StorageBench_Now_us() - t0);
+            if (r.fr != FR_OK) {
+                break;
+            }
+            r.ops++;
+            r.bytes += done;
+            BENCH_FEED();
+        }
+        if (f_close(&f) != FR_OK && r.fr == FR_OK) {
+            r.fr = FR_DISK_ERR;
+        }
+    }
+    bench_finish(&r, start);
+    return r.fr;
+}
+
+// =============================================================================
+// 入口
+// =============================================================================
+
+FRESULT StorageBench_Run(const char *dir, uint8_t *buf, uint32_t buf_size)
+{
+    static const uint32_t req_sizes[] = {512, 1024, 2048, 4096, 8192, 16384, 32768};
+    char seq_path[BENCH_PATH_MAX];
+    char log_path[BENCH_PATH_MAX];
+    FRESULT fr, first = FR_OK;
+
+    if (buf == NULL || buf_size < 512) {
+        return FR_INVALID_PARAMETER;
+    }
+
+    bench_timer_init();
+    bench_path(seq_path, dir, "bseq.dat");
+    bench_path(log_path, dir, "blog.txt");
+    for (uint32_t i = 0; i < buf_size; i++) {
+        buf[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    printf("\r\n===== Storage benchmark (%s, seq %lu KB) =====\r\n",
+           dir, (unsigned long)(STORAGE_BENCH_SEQ_BYTES / 1024));
+    StorageBench_PrintHeader();
+
+    for (uint32_t i = 0; i < sizeof(req_sizes) / sizeof(req_sizes[0]); i++) {
+        if (req_sizes[i] > buf_size) {
+            break;
+        }
+        fr = bench_seq(seq_path, buf, req_sizes[i], 1);
+        if (fr == FR_OK) {
+            fr = bench_seq(seq_path, buf, req_sizes[i], 0);
+        }
+        if (fr != FR_OK && first == FR_OK) {
+            first = fr;
+        }
+    }
+
+    // 随机读写复用最后一次顺序写留下的文件
+    fr = bench_random(seq_path, buf, 0);
+    if (fr != FR_OK && first == FR_OK) {
+        first = fr;
+    }
+    fr = bench_random(seq_path, buf, 1);
+    if (fr != FR_OK && first == FR_OK) {
+        first = fr;
+    }
+
+    fr = bench_churn(dir, buf);
+    if (fr != FR_OK && first == FR_OK) {
+        first = fr;
+    }
+
+    fr = bench_append_log(log_path);
+    if (fr != FR_OK && first == FR_OK) {
+        first = fr;
+    }
+
+    f_unlink(seq_path);
+    f_unlink(log_path);
+    DirIndex_NotifyAll();
+    printf("===== Storage benchmark end =====\r\n");
+    return first;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file storage_bench.h
+ * @brief FatFs 存储性能基准测试（吞吐量 + 延迟直方图）
+ * @details 只依赖 ff.h、printf 和一个微秒计时源，固件和主机 Flash 模拟器
+ *          （User/code/simulator）编译同一份代码，存储层改动前后的数字可直接对比。
+ *
+ *          工作负载：
+ *          - 顺序写/读：请求大小 512B ~ 32KB（受缓冲区大小限制）
+ *          - 随机 512B 读/写
+ *          - 小文件创建/删除循环
+ *          - 追加日志（每条记录后 f_sync）
+ *
+ *          每个工作负载输出一行：次数、字节数、耗时、KB/s、ops/s、p50/p99/max 延迟(us)
+ */
+
+#ifndef STORAGE_BENCH_H
+#define STORAGE_BENCH_H
+
+#include <stdint.h>
+#include "../ff16/ff.h"
+
+// =============================================================================
+// 配置参数
+// =============================================================================
+#ifndef STORAGE_BENCH_SEQ_BYTES
+#define STORAGE_BENCH_SEQ_BYTES     (256 * 1024)  ///< 每种请求大小顺序读写的总量
+#endif
+
+#ifndef STORAGE_BENCH_RANDOM_OPS
+#define STORAGE_BENCH_RANDOM_OPS    200           ///< 随机读、随机写各执行的次数
+#endif
+
+#ifndef STORAGE_BENCH_CHURN_FILES
+#define STORAGE_BENCH_CHURN_FILES   32            ///< 小文件创建/删除循环次数
+#endif
+
+#ifndef STORAGE_BENCH_CHURN_SIZE
+#define STORAGE_BENCH_CHURN_SIZE    100           ///< 每个小文件的大小
+#endif
+
+#ifndef STORAGE_BENCH_LOG_RECORDS
+#define STORAGE_BENCH_LOG_RECORDS   200           ///< 追加日志的记录条数
+#endif
+
+#ifndef STORAGE_BENCH_LOG_RECORD
+#define STORAGE_BENCH_LOG_RECORD    64            ///< 每条日志记录的字节数
+#endif
+
+/**
+ * @brief 对数分桶的延迟直方图
+ * @details 每个 2 的幂区间再分 8 个子桶，相对误差不超过 12.5%，
+ *          覆盖 0 ~ 2^32 us 只需 240 个 16 位计数（480 字节）
+ */
+#define STORAGE_BENCH_HIST_SUB      8
+#define STORAGE_BENCH_HIST_BUCKETS  240
+
+typedef struct {
+    uint16_t count[STORAGE_BENCH_HIST_BUCKETS];
+    uint32_t samples;
+    uint32_t max_us;
+} StorageBench_Hist;
+
+/**
+ * @brief 单个工作负载的结果
+ */
+typedef struct {
+    const char *name;
+    uint32_t ops;          ///< 操作次数
+    uint32_t bytes;        ///< 读写的数据量
+    uint32_t elapsed_us;   ///< 总耗时
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+    FRESULT  fr;           ///< 第一个失败的 FatFs 返回值（FR_OK 表示全部成功）
+} StorageBench_Result;
+
+/**
+ * @brief 运行全部工作负载，结果通过 printf 输出
+ * @param dir      测试文件所在目录（如 "0:"），目录须已挂载
+ * @param buf      数据缓冲区，大小决定顺序读写的最大请求（32KB 可覆盖全部大小）
+ * @param buf_size 缓冲区字节数，至少 512
+ * @return 第一个失败的 FatFs 返回值，全部成功返回 FR_OK
+ */
+FRESULT StorageBench_Run(const char *dir, uint8_t *buf, uint32_t buf_size);
+
+// 计时与直方图（供其它测试复用）
+uint32_t StorageBench_Now_us(void);
+void StorageBench_Hist_Reset(StorageBench_Hist *h);
+void StorageBench_Hist_Add(StorageBench_Hist *h, uint32_t us);
+uint32_t StorageBench_Hist_Percentile(const StorageBench_Hist *h, uint32_t permille);
+void StorageBench_PrintHeader(void);
+void StorageBench_PrintResult(const StorageBench_Result *r);
+
+#endif
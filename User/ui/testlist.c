@@ -6,7 +6,12 @@ char *test_opt[] = {
     "2048_oled",
     "frid_test",
     "iwdg_test",
-    "air_level"
+    "air_level",
+    "fs_bench",
+    "imu_log",
+    "assets",
+    "files",
+    "imu_stream"
   };
 
 #define TOTAL_ITEMS (sizeof(test_opt) / sizeof(test_opt[0]))
@@ -65,7 +70,7 @@ void test_enter_select(u8 selected)
     menu_2048_oled();
     break;
   case 2:
-    // frid_test();
+    frid_test();
     break;
   case 3:
     iwdg_test();
@@ -73,6 +78,21 @@ void test_enter_select(u8 selected)
   case 4:
     air_level_test();
     break;
+  case 5:
+    filesystem_bench();
+    break;
+  case 6:
+    imu_capture();
+    break;
+  case 7:
+    asset_test();
+    break;
+  case 8:
+    file_browser();
+    break;
+  case 9:
+    imu_stream();
+    break;
   default:
     break;
   }
@@ -8,6 +8,11 @@
 #include "spi.h"
 #include "2048_oled.h"
 #include "filesystem_test.h"
+#include "imu_capture.h"
+#include "asset_view.h"
+#include "file_browser.h"
+#include "imu_stream.h"
+#include "frid_test.h"
 #include "ui.h"
 
 
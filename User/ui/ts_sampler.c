@@ -0,0 +1,153 @@
+/**
+ * @file ts_sampler.c
+ * @brief 每分钟采样实现
+ */
+
+#include "ts_sampler.h"
+#include "../code/ts_store.h"
+#include "../code/dht11.h"
+#include "../code/adc.h"
+#include "../MPU6050/simple_pedometer.h"
+#include "../ff16/storage_service.h"
+#include "../code/shell.h"
+#include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include <string.h>
+#include <stdio.h>
+
+static TimerHandle_t sample_timer;
+static StorageRequest sample_req;                   // 定时器提交的后台采样请求
+static unsigned long last_steps;                    // 上一次采样时的累计步数
+static int16_t last_temp;                           // DHT11 读取失败时沿用
+static uint8_t last_humi;
+static TS_SamplerStats stats;
+
+// 存储任务中执行：读传感器并追加一条分钟记录
+static FRESULT sample_job(void *ctx)
+{
+    RTC_TimeTypeDef time;
+    RTC_DateTypeDef date;
+    DHT11_Data_TypeDef dht;
+    TS_Sample s;
+    unsigned long steps, delta;
+    float volt;
+
+    (void)ctx;
+    RTC_GetTime(RTC_Format_BIN, &time);
+    RTC_GetDate(RTC_Format_BIN, &date);
+    s.t = TS_MakeTime(date.RTC_Year, date.RTC_Month, date.RTC_Date, time.RTC_Hours, time.RTC_Minutes);
+    if (s.t == 0) {
+        stats.no_time++;
+        return FR_OK;
+    }
+
+    // 累计步数被清零（step_reset、跨天）时，把当前值当作本分钟的增量
+    steps = simple_pedometer_get_steps();
+    delta = steps >= last_steps ? steps - last_steps : steps;
+    s.steps = delta > 0xFFFF ? 0xFFFF : (uint16_t)delta;
+    last_steps = steps;
+
+    // 温湿度界面也在读 DHT11，两边撞上时校验失败，沿用上一次的值
+    if (Read_DHT11(&dht) == 0) {
+        last_temp = (int16_t)(dht.temp_int * 10 + dht.temp_deci);
+        last_humi = dht.humi_int;
+    } else {
+        stats.dht_fail++;
+    }
+    s.temp = last_temp;
+    s.humi = last_humi;
+
+    volt = ADC3_ReadVoltage(3.3f);
+    s.adc = volt > 0.0f ? (uint16_t)(volt * 1000.0f) : 0;
+
+    if (TS_Append(&s) == TS_OK) {
+        stats.samples++;
+    } else {
+        stats.errors++;
+    }
+    return FR_OK;
+}
+
+// 定时器服务任务中执行，只提交请求，不阻塞
+static void sample_timer_cb(TimerHandle_t timer)
+{
+    (void)timer;
+    if (!Storage_Service_Running()) {
+        return;
+    }
+    // 请求还在排队或执行时不动它的字段，本分钟跳过
+    if (sample_req.busy || Storage_Submit(&sample_req) != pdPASS) {
+        stats.skipped++;
+    }
+}
+
+static FRESULT ts_init_job(void *ctx)
+{
+    (void)ctx;
+    return TS_Init() == TS_OK ? FR_OK : FR_DISK_ERR;
+}
+
+/**
+ * @brief 初始化传感器和时序存储，启动采样定时器（main 中、存储服务之后调用）
+ * @return 0 成功，-1 时序存储初始化失败或定时器创建失败（仍会尝试采样）
+ */
+int TS_Sampler_Init(void)
+{
+    int ret = 0;
+
+    DHT11_Init();
+    ADC3_Init();
+    last_steps = simple_pedometer_get_steps();
+    memset(&stats, 0, sizeof(stats));
+    sample_req.op = STORAGE_OP_CALL;
+    sample_req.prio = STORAGE_PRIO_BACKGROUND;
+    sample_req.job = sample_job;
+    sample_req.ctx = NULL;
+
+    // 调度器启动前在调用方同步执行；失败时 TS_Append 会再次尝试初始化
+    if (Storage_Call(ts_init_job, NULL, STORAGE_PRIO_INTERACTIVE) != FR_OK) {
+        ret = -1;
+    }
+
+    sample_timer = xTimerCreate("ts_sample", pdMS_TO_TICKS(TS_SAMPLE_PERIOD_MS), pdTRUE, NULL, sample_timer_cb);
+    if (sample_timer == NULL || xTimerStart(sample_timer, 0) != pdPASS) {
+        ret = -1;
+    }
+    return ret;
+}
+
+void TS_Sampler_GetStats(TS_SamplerStats *out)
+{
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
+
+// =============================================================================
+// 串口命令
+// =============================================================================
+
+static int cmd_ts_stat(uint32_t argc, const Shell_Arg *argv)
+{
+    TS_SamplerStats s;
+
+    (void)argc;
+    (void)argv;
+    TS_Sampler_GetStats(&s);
+    printf("sampler: %lu samples, %lu skipped, %lu no_time, %lu dht_fail, %lu errors\r\n",
+           (unsigned long)s.samples, (unsigned long)s.skipped, (unsigned long)s.no_time,
+           (unsigned long)s.dht_fail, (unsigned long)s.errors);
+    TS_PrintStats();
+    return SHELL_OK;
+}
+
+static const Shell_Cmd sampler_cmds[] = {
+    { "ts_stat", "", cmd_ts_stat, "per-minute sampler and time-series statistics" },
+};
+
+void ts_sampler_register_commands(void)
+{
+    Shell_Register(sampler_cmds, sizeof(sampler_cmds) / sizeof(sampler_cmds[0]));
+}
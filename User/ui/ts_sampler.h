@@ -0,0 +1,31 @@
+/**
+ * @file ts_sampler.h
+ * @brief 每分钟采样一次步数、温湿度和 ADC，写入时序存储（ts_store.h）
+ * @details 软件定时器每 TS_SAMPLE_PERIOD_MS 提交一个后台 STORAGE_OP_CALL 请求，
+ *          采样和 TS_Append 都在存储任务中执行（TS 与 KV 共用 SPI1，只能在存储任务中访问）。
+ *          定时器回调不阻塞：上一次请求还在排队时本次跳过。
+ */
+
+#ifndef TS_SAMPLER_H
+#define TS_SAMPLER_H
+
+#include <stdint.h>
+
+#define TS_SAMPLE_PERIOD_MS     60000   ///< 采样周期（TS 的时间单位是分钟）
+
+/**
+ * @brief 采样统计
+ */
+typedef struct {
+    uint32_t samples;   ///< 写入成功的样本数
+    uint32_t skipped;   ///< 上一次请求未完成而跳过的次数
+    uint32_t no_time;   ///< RTC 未设置而丢弃的样本数
+    uint32_t dht_fail;  ///< DHT11 读取失败（沿用上一次的温湿度）
+    uint32_t errors;    ///< TS_Append 失败次数（含同一分钟内重复采样）
+} TS_SamplerStats;
+
+int  TS_Sampler_Init(void);
+void TS_Sampler_GetStats(TS_SamplerStats *stats);
+void ts_sampler_register_commands(void);       // 串口命令 ts_stat
+
+#endif
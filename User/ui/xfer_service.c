@@ -0,0 +1,275 @@
+/**
+ * @file xfer_service.c
+ * @brief 串口批量下载的设备端
+ */
+
+#include "xfer_service.h"
+#include "../code/xfer.h"
+#include "../code/shell.h"
+#include "../code/flash_layout.h"
+#include "../ff16/storage_service.h"
+#include "debug.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+#define XFER_TX_BUFFERS     DEBUG_TX_EXT_SLOTS
+
+/**
+ * @brief 原始分区
+ */
+typedef struct {
+    const char *name;
+    uint32_t    base;
+    uint32_t    size;
+} XferPartition;
+
+static const XferPartition xfer_parts[] = {
+    { "@flash",  0,                   W25Q128_CAPACITY },
+    { "@fatfs",  FLASH_FATFS_BASE,    FLASH_FATFS_SIZE },
+    { "@kv",     FLASH_KV_BASE,       FLASH_KV_SIZE },
+    { "@ts",     FLASH_TS_RAW_BASE,   FLASH_AB_STEPS_BASE - FLASH_TS_RAW_BASE },
+    { "@steps",  FLASH_AB_STEPS_BASE, FLASH_AB_SIZE },
+    { "@assets", FLASH_ASSET_BASE,    FLASH_ASSET_SIZE },
+    { "@tags",   FLASH_TAG_BASE,      FLASH_TAG_SIZE },
+};
+
+/**
+ * @brief 当前会话的数据源，同时作为存储任务中各个 job 的参数
+ */
+typedef struct {
+    FIL        *fil;        ///< 打开的文件，NULL 表示原始分区
+    uint32_t    base;       ///< 原始分区起始地址
+    const char *name;
+    uint32_t    size;       ///< 输出：文件或分区大小
+    uint32_t    offset;
+    uint8_t    *buf;
+    uint32_t    len;
+    int         rc;         ///< 输出：XFER_OK / XFER_ERR_*
+} XferSource;
+
+static XferServer server;
+static XferSource source;
+static uint8_t *tx_bufs[XFER_TX_BUFFERS];
+static uint32_t tx_submitted;           // 交给 Debug_SendBuffer 的个数（自由计数）
+static volatile uint8_t xfer_active = 0;
+
+// =============================================================================
+// 存储任务中执行的 job
+// =============================================================================
+
+static FRESULT xfer_open_job(void *ctx)
+{
+    XferSource *src = (XferSource *)ctx;
+    FRESULT fr = f_open(src->fil, src->name, FA_READ);
+
+    if (fr == FR_OK) {
+        src->size = (uint32_t)f_size(src->fil);
+        src->rc = XFER_OK;
+    } else {
+        src->rc = (fr == FR_NO_FILE || fr == FR_NO_PATH || fr == FR_INVALID_NAME) ? XFER_ERR_NOENT
+                : (fr == FR_LOCKED ? XFER_ERR_BUSY : XFER_ERR_IO);
+    }
+    return FR_OK;
+}
+
+static FRESULT xfer_read_job(void *ctx)
+{
+    XferSource *src = (XferSource *)ctx;
+    UINT br = 0;
+
+    src->rc = XFER_ERR_IO;
+    if (src->fil == NULL) {
+        if (W25Q128_ReadData_DMA(src->buf, src->base + src->offset, src->len) == W25Q128_RESULT_OK) {
+            src->rc = XFER_OK;
+        }
+    } else if (f_lseek(src->fil, src->offset) == FR_OK && f_read(src->fil, src->buf, src->len, &br) == FR_OK &&
+               br == src->len) {
+        src->rc = XFER_OK;
+    }
+    return FR_OK;
+}
+
+static FRESULT xfer_close_job(void *ctx)
+{
+    return f_close(((XferSource *)ctx)->fil);
+}
+
+// =============================================================================
+// XferPort
+// =============================================================================
+
+static int port_open(void *ctx, const char *name, uint32_t *size)
+{
+    XferSource *src = (XferSource *)ctx;
+
+    memset(src, 0, sizeof(*src));
+    if (name[0] == '@') {
+        for (uint32_t i = 0; i < sizeof(xfer_parts) / sizeof(xfer_parts[0]); i++) {
+            if (strcmp(name, xfer_parts[i].name) == 0) {
+                src->base = xfer_parts[i].base;
+                *size = xfer_parts[i].size;
+                return XFER_OK;
+            }
+        }
+        return XFER_ERR_NOENT;
+    }
+    src->fil = pvPortMalloc(sizeof(FIL));
+    if (src->fil == NULL) {
+        return XFER_ERR_BUSY;
+    }
+    src->name = name;
+    if (Storage_Call(xfer_open_job, src, STORAGE_PRIO_INTERACTIVE) != FR_OK) {
+        src->rc = XFER_ERR_IO;
+    }
+    if (src->rc != XFER_OK) {
+        vPortFree(src->fil);
+        src->fil = NULL;
+        return src->rc;
+    }
+    *size = src->size;
+    return XFER_OK;
+}
+
+static int port_read(void *ctx, uint32_t offset, uint8_t *buf, uint32_t len)
+{
+    XferSource *src = (XferSource *)ctx;
+
+    src->offset = offset;
+    src->buf = buf;
+    src->len = len;
+    if (Storage_Call(xfer_read_job, src, STORAGE_PRIO_INTERACTIVE) != FR_OK) {
+        return XFER_ERR_IO;
+    }
+    return src->rc;
+}
+
+static void port_close(void *ctx)
+{
+    XferSource *src = (XferSource *)ctx;
+
+    if (src->fil != NULL) {
+        Storage_Call(xfer_close_job, src, STORAGE_PRIO_INTERACTIVE);
+        vPortFree(src->fil);
+        src->fil = NULL;
+    }
+}
+
+// 外部缓冲区按提交顺序发完，发送中的不超过 XFER_TX_BUFFERS 个时下一个要用的一定空闲
+static uint8_t *port_tx_buffer(void *ctx)
+{
+    (void)ctx;
+    if (tx_submitted - Debug_BuffersDone() >= XFER_TX_BUFFERS) {
+        return NULL;
+    }
+    return tx_bufs[tx_submitted % XFER_TX_BUFFERS];
+}
+
+static void port_tx_send(void *ctx, uint8_t *frame, uint32_t len)
+{
+    (void)ctx;
+    if (Debug_SendBuffer(frame, len)) {
+        tx_submitted++;
+    }
+    // 排不上队的帧当作在链路上丢失，由超时重发
+}
+
+static void port_tx_control(void *ctx, const uint8_t *frame, uint32_t len)
+{
+    (void)ctx;
+    Debug_WriteRecord(frame, len);
+}
+
+// =============================================================================
+// 传输模式
+// =============================================================================
+
+static void xfer_leave(void)
+{
+    // 等 DMA 发完最后的帧再释放缓冲区
+    while (tx_submitted != Debug_BuffersDone()) {
+        vTaskDelay(1);
+    }
+    for (uint32_t i = 0; i < XFER_TX_BUFFERS; i++) {
+        vPortFree(tx_bufs[i]);
+        tx_bufs[i] = NULL;
+    }
+    xfer_active = 0;
+}
+
+/**
+ * @brief 是否处于传输模式（data_task 据此决定把收到的字节交给谁）
+ */
+uint8_t Xfer_Service_Active(void)
+{
+    return xfer_active;
+}
+
+/**
+ * @brief 传输模式下 data_task 每收到一块数据（或等待 1 个节拍超时，len 为 0）调用一次
+ */
+void Xfer_Service_Run(const uint8_t *data, uint32_t len)
+{
+    uint32_t now = (uint32_t)xTaskGetTickCount();     // 1 节拍 = 1ms
+
+    if (len > 0) {
+        XferServer_Input(&server, data, len, now);
+    }
+    if (XferServer_Poll(&server, now) == XFER_FINISHED) {
+        xfer_leave();
+    }
+}
+
+// xfer：进入传输模式，上位机收到 OK 后开始发请求
+static int cmd_xfer(uint32_t argc, const Shell_Arg *argv)
+{
+    // 帧缓冲区在 FreeRTOS 堆（SRAM）中分配，DMA 可以访问
+    XferPort port = {
+        port_open, port_read, port_close, port_tx_buffer, port_tx_send, port_tx_control, &source,
+    };
+    Xfer_Stats stats = server.stats;
+
+    (void)argc;
+    (void)argv;
+    for (uint32_t i = 0; i < XFER_TX_BUFFERS; i++) {
+        tx_bufs[i] = pvPortMalloc(XFER_FRAME_MAX);
+        if (tx_bufs[i] == NULL) {
+            while (i-- > 0) {
+                vPortFree(tx_bufs[i]);
+                tx_bufs[i] = NULL;
+            }
+            return SHELL_ERR_FAIL;
+        }
+    }
+    tx_submitted = Debug_BuffersDone();
+    XferServer_Init(&server, &port, (uint32_t)xTaskGetTickCount());
+    server.stats = stats;                   // 统计跨会话累计
+    xfer_active = 1;
+    return SHELL_OK;
+}
+
+static int cmd_xferstat(uint32_t argc, const Shell_Arg *argv)
+{
+    const Xfer_Stats *st = &server.stats;
+
+    (void)argc;
+    (void)argv;
+    printf("xfer: %lu sessions, %lu completed, %lu frames, %lu bytes, %lu resent\r\n",
+           (unsigned long)st->sessions, (unsigned long)st->completed, (unsigned long)st->frames,
+           (unsigned long)st->bytes, (unsigned long)st->resent);
+    printf("xfer: %lu timeouts, %lu rewinds, %lu errors, %lu bad request frames\r\n",
+           (unsigned long)st->timeouts, (unsigned long)st->rewinds, (unsigned long)st->errors,
+           (unsigned long)server.parser.bad);
+    return SHELL_OK;
+}
+
+static const Shell_Cmd xfer_cmds[] = {
+    { "xfer",     "", cmd_xfer,     "enter bulk transfer mode (host: xfer_get)" },
+    { "xferstat", "", cmd_xferstat, "bulk transfer statistics" },
+};
+
+void xfer_service_register_commands(void)
+{
+    Shell_Register(xfer_cmds, sizeof(xfer_cmds) / sizeof(xfer_cmds[0]));
+}
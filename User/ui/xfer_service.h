@@ -0,0 +1,22 @@
+/**
+ * @file xfer_service.h
+ * @brief 串口批量下载：文件和 Flash 原始分区传到上位机（协议见 code/xfer.h）
+ * @details 串口命令 xfer 让 data_task 进入传输模式：收到的字节不再回显、不再交给命令解释器，
+ *          而是交给 XferServer，直到上位机发 CLOSE 或 XFER_IDLE_MS 没有请求。
+ *          名字以 '@' 开头的是原始分区（@flash @fatfs @kv @ts @steps @assets @tags，见 flash_layout.h），
+ *          其它按 FatFs 路径打开（"1:" 前缀为 SD 卡）。
+ *          读取在存储任务中进行（Storage_Call），数据直接读到两个帧缓冲区之一的数据区，
+ *          由 Debug_SendBuffer 交给 DMA 从同一个缓冲区发送：一个在发送时读下一个，中间没有拷贝。
+ *          上位机为 simulator/examples/xfer_get。
+ */
+
+#ifndef _XFER_SERVICE_H_
+#define _XFER_SERVICE_H_
+
+#include <stdint.h>
+
+uint8_t Xfer_Service_Active(void);
+void Xfer_Service_Run(const uint8_t *data, uint32_t len);
+void xfer_service_register_commands(void);     // 串口命令 xfer、xferstat
+
+#endif